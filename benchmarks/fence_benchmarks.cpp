@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+// Microbenchmarks for the Fence wrapper lifecycle. A frame retires several fences (release,
+// retire, input), so the create/dup/destroy path runs tens of times per frame process-wide.
+// Backing fds are plain /dev/null dups: the wrapper cost being measured is identical, and the
+// benchmark stays runnable without a sync timeline from the kernel.
+
+#include <benchmark/benchmark.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utils/fence.h>
+
+namespace {
+
+using sdm::Fence;
+
+int DupNullFd() {
+  static int null_fd = open("/dev/null", O_RDONLY);
+  return dup(null_fd);
+}
+
+void BM_FenceCreateDestroy(benchmark::State &state) {
+  for (auto _ : state) {
+    std::shared_ptr<Fence> fence = Fence::Create(DupNullFd(), "bench");
+    benchmark::DoNotOptimize(fence);
+  }
+}
+BENCHMARK(BM_FenceCreateDestroy);
+
+void BM_FenceSharedPtrCopy(benchmark::State &state) {
+  std::shared_ptr<Fence> fence = Fence::Create(DupNullFd(), "bench");
+  for (auto _ : state) {
+    std::shared_ptr<Fence> copy = fence;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_FenceSharedPtrCopy);
+
+void BM_FenceDup(benchmark::State &state) {
+  std::shared_ptr<Fence> fence = Fence::Create(DupNullFd(), "bench");
+  for (auto _ : state) {
+    int fd = Fence::Dup(fence);
+    benchmark::DoNotOptimize(fd);
+    close(fd);
+  }
+}
+BENCHMARK(BM_FenceDup);
+
+void BM_FenceGetStr(benchmark::State &state) {
+  std::shared_ptr<Fence> fence = Fence::Create(DupNullFd(), "bench");
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Fence::GetStr(fence));
+  }
+}
+BENCHMARK(BM_FenceGetStr);
+
+}  // namespace
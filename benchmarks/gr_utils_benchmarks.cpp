@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+// Microbenchmarks for the gralloc size/alignment calculations. These run on every allocation
+// and on the BufferDescriptor fast path, so they gate allocation-heavy use cases like camera
+// burst and video transcode.
+
+#include <benchmark/benchmark.h>
+#include <gr_utils.h>
+
+namespace {
+
+using gralloc::BufferInfo;
+
+void BM_GetBufferSizeAndDimensionsRGBA(benchmark::State &state) {
+  BufferInfo info(INT(state.range(0)), INT(state.range(1)), HAL_PIXEL_FORMAT_RGBA_8888,
+                  static_cast<uint64_t>(BufferUsage::GPU_TEXTURE));
+  unsigned int size = 0;
+  unsigned int aligned_w = 0;
+  unsigned int aligned_h = 0;
+  for (auto _ : state) {
+    gralloc::GetBufferSizeAndDimensions(info, &size, &aligned_w, &aligned_h);
+    benchmark::DoNotOptimize(size);
+  }
+}
+BENCHMARK(BM_GetBufferSizeAndDimensionsRGBA)->Args({1080, 2400})->Args({3840, 2160});
+
+void BM_GetBufferSizeAndDimensionsNV12(benchmark::State &state) {
+  BufferInfo info(INT(state.range(0)), INT(state.range(1)),
+                  HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS,
+                  static_cast<uint64_t>(BufferUsage::VIDEO_DECODER));
+  unsigned int size = 0;
+  unsigned int aligned_w = 0;
+  unsigned int aligned_h = 0;
+  for (auto _ : state) {
+    gralloc::GetBufferSizeAndDimensions(info, &size, &aligned_w, &aligned_h);
+    benchmark::DoNotOptimize(size);
+  }
+}
+BENCHMARK(BM_GetBufferSizeAndDimensionsNV12)->Args({1920, 1080})->Args({3840, 2160});
+
+void BM_GetAlignedWidthAndHeight(benchmark::State &state) {
+  BufferInfo info(1080, 2400, HAL_PIXEL_FORMAT_RGBA_8888,
+                  static_cast<uint64_t>(BufferUsage::COMPOSER_OVERLAY));
+  unsigned int aligned_w = 0;
+  unsigned int aligned_h = 0;
+  for (auto _ : state) {
+    gralloc::GetAlignedWidthAndHeight(info, &aligned_w, &aligned_h);
+    benchmark::DoNotOptimize(aligned_w);
+  }
+}
+BENCHMARK(BM_GetAlignedWidthAndHeight);
+
+void BM_GetMetaDataSize(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gralloc::GetMetaDataSize(0, 0));
+  }
+}
+BENCHMARK(BM_GetMetaDataSize);
+
+void BM_IsUBwcEnabled(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        gralloc::IsUBwcEnabled(HAL_PIXEL_FORMAT_RGBA_8888,
+                               static_cast<uint64_t>(BufferUsage::COMPOSER_OVERLAY)));
+  }
+}
+BENCHMARK(BM_IsUBwcEnabled);
+
+}  // namespace
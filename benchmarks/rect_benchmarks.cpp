@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+// Microbenchmarks for the LayerRect helpers in libsdmutils. These run per layer per frame in
+// strategy and resource manager loops, so regressions here scale with layer count.
+// Run on target with: display_microbenchmarks --benchmark_format=json
+
+#include <benchmark/benchmark.h>
+#include <utils/rect.h>
+
+namespace {
+
+using sdm::LayerRect;
+
+const LayerRect kFullScreen = {0.0f, 0.0f, 1080.0f, 2400.0f};
+const LayerRect kOverlapping = {200.0f, 400.0f, 900.0f, 1800.0f};
+const LayerRect kDisjoint = {1100.0f, 2500.0f, 1200.0f, 2600.0f};
+
+void BM_RectIntersection(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sdm::Intersection(kFullScreen, kOverlapping));
+  }
+}
+BENCHMARK(BM_RectIntersection);
+
+void BM_RectIntersectionDisjoint(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sdm::Intersection(kFullScreen, kDisjoint));
+  }
+}
+BENCHMARK(BM_RectIntersectionDisjoint);
+
+void BM_RectUnion(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sdm::Union(kFullScreen, kOverlapping));
+  }
+}
+BENCHMARK(BM_RectUnion);
+
+void BM_RectSubtract(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sdm::Subtract(kFullScreen, kOverlapping));
+  }
+}
+BENCHMARK(BM_RectSubtract);
+
+void BM_RectIsCongruent(benchmark::State &state) {
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sdm::IsCongruent(kFullScreen, kOverlapping));
+  }
+}
+BENCHMARK(BM_RectIsCongruent);
+
+void BM_RectNormalize(benchmark::State &state) {
+  for (auto _ : state) {
+    LayerRect rect = kOverlapping;
+    sdm::Normalize(32, 8, &rect);
+    benchmark::DoNotOptimize(rect);
+  }
+}
+BENCHMARK(BM_RectNormalize);
+
+void BM_RectSplitLeftRight(benchmark::State &state) {
+  LayerRect out[2] = {};
+  for (auto _ : state) {
+    sdm::SplitLeftRight(kFullScreen, 2, 32, out);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_RectSplitLeftRight);
+
+void BM_RectMapRect(benchmark::State &state) {
+  LayerRect out = {};
+  const LayerRect src_domain = {0.0f, 0.0f, 1920.0f, 1080.0f};
+  for (auto _ : state) {
+    sdm::MapRect(src_domain, kFullScreen, kOverlapping, &out);
+    benchmark::DoNotOptimize(out);
+  }
+}
+BENCHMARK(BM_RectMapRect);
+
+}  // namespace
+
+BENCHMARK_MAIN();
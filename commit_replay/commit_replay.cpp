@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+/*
+ * Standalone replay harness for HWDeviceDRM commit recordings.
+ *
+ * Feeds a property stream recorded with the enable_commit_replay_record display property
+ * (see sdm/libs/dal/hw_commit_recorder.h for the log format) back to the DRM device, frame
+ * by frame, and reports the kernel time spent per commit phase. The default mode runs the
+ * atomic check only (DRM_MODE_ATOMIC_TEST_ONLY), which exercises the full kernel validation
+ * path without flipping anything on screen; --real performs the actual commits as well.
+ *
+ * Values that reference per-session kernel objects (framebuffer ids, blob ids, fence fds)
+ * replay as recorded; a stream is therefore only fully valid against the session that
+ * produced it or a kernel that re-creates the same ids. For atomic check profiling of
+ * property-stream-shaped regressions this is sufficient; frames whose check fails are
+ * counted and reported separately.
+ *
+ * Usage: sdm_commit_replay <log file> [--real] [--loops <n>] [--verbose]
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+const uint32_t kFileMagic = 0x524D4453;   // "SDMR"
+const uint32_t kFrameMagic = 0x4D524653;  // "SFRM"
+const uint32_t kFileVersion = 1;
+
+struct PropEntry {
+  uint32_t object_id;
+  uint32_t prop_id;
+  uint64_t value;
+};
+
+struct Frame {
+  uint64_t timestamp_ns;
+  uint64_t commit_duration_ns;  // as measured in the recording session
+  std::vector<PropEntry> props;
+};
+
+struct PhaseStats {
+  uint64_t total_ns = 0;
+  uint64_t max_ns = 0;
+  uint64_t min_ns = UINT64_MAX;
+  uint32_t count = 0;
+
+  void Add(uint64_t ns) {
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+    min_ns = std::min(min_ns, ns);
+    count++;
+  }
+
+  void Print(const char *name) const {
+    if (!count) {
+      printf("  %-12s no samples\n", name);
+      return;
+    }
+    printf("  %-12s frames: %u  avg: %" PRIu64 " us  min: %" PRIu64 " us  max: %" PRIu64 " us\n",
+           name, count, total_ns / count / 1000, min_ns / 1000, max_ns / 1000);
+  }
+};
+
+uint64_t NowNs() {
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (uint64_t)t.tv_sec * 1000000000ULL + (uint64_t)t.tv_nsec;
+}
+
+template <typename T>
+bool ReadValue(FILE *file, T *value) {
+  return fread(value, sizeof(T), 1, file) == 1;
+}
+
+bool ReadFrame(FILE *file, Frame *frame) {
+  uint32_t magic = 0;
+  if (!ReadValue(file, &magic)) {
+    return false;  // clean end of stream
+  }
+  if (magic != kFrameMagic) {
+    fprintf(stderr, "Corrupt frame marker 0x%x\n", magic);
+    return false;
+  }
+
+  uint32_t object_count = 0;
+  if (!ReadValue(file, &frame->timestamp_ns) || !ReadValue(file, &frame->commit_duration_ns) ||
+      !ReadValue(file, &object_count)) {
+    fprintf(stderr, "Truncated frame header\n");
+    return false;
+  }
+
+  frame->props.clear();
+  for (uint32_t i = 0; i < object_count; i++) {
+    uint32_t object_id = 0;
+    uint32_t object_type = 0;
+    uint32_t prop_count = 0;
+    if (!ReadValue(file, &object_id) || !ReadValue(file, &object_type) ||
+        !ReadValue(file, &prop_count)) {
+      fprintf(stderr, "Truncated object header\n");
+      return false;
+    }
+    for (uint32_t p = 0; p < prop_count; p++) {
+      PropEntry entry = {object_id, 0, 0};
+      if (!ReadValue(file, &entry.prop_id) || !ReadValue(file, &entry.value)) {
+        fprintf(stderr, "Truncated property entry\n");
+        return false;
+      }
+      frame->props.push_back(entry);
+    }
+  }
+
+  return true;
+}
+
+int ReplayFrame(int dev_fd, const Frame &frame, bool real_commit, bool verbose,
+                PhaseStats *check_stats, PhaseStats *commit_stats, uint32_t *failed) {
+  drmModeAtomicReq *req = drmModeAtomicAlloc();
+  if (!req) {
+    fprintf(stderr, "drmModeAtomicAlloc failed\n");
+    return -ENOMEM;
+  }
+
+  for (const PropEntry &entry : frame.props) {
+    if (drmModeAtomicAddProperty(req, entry.object_id, entry.prop_id, entry.value) < 0) {
+      fprintf(stderr, "Failed to stage prop %u on object %u\n", entry.prop_id, entry.object_id);
+    }
+  }
+
+  uint64_t start = NowNs();
+  int ret = drmModeAtomicCommit(dev_fd, req,
+                                DRM_MODE_ATOMIC_TEST_ONLY | DRM_MODE_ATOMIC_ALLOW_MODESET,
+                                nullptr);
+  uint64_t check_ns = NowNs() - start;
+  check_stats->Add(check_ns);
+  if (ret) {
+    (*failed)++;
+  }
+
+  uint64_t commit_ns = 0;
+  if (real_commit && !ret) {
+    start = NowNs();
+    ret = drmModeAtomicCommit(dev_fd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+    commit_ns = NowNs() - start;
+    if (!ret) {
+      commit_stats->Add(commit_ns);
+    } else {
+      (*failed)++;
+    }
+  }
+
+  if (verbose) {
+    printf("frame: check %" PRIu64 " us, commit %" PRIu64 " us, recorded %" PRIu64
+           " us, ret %d\n",
+           check_ns / 1000, commit_ns / 1000, frame.commit_duration_ns / 1000, ret);
+  }
+
+  drmModeAtomicFree(req);
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <log file> [--real] [--loops <n>] [--verbose]\n", argv[0]);
+    return 1;
+  }
+
+  const char *log_path = argv[1];
+  bool real_commit = false;
+  bool verbose = false;
+  int loops = 1;
+  for (int i = 2; i < argc; i++) {
+    if (!strcmp(argv[i], "--real")) {
+      real_commit = true;
+    } else if (!strcmp(argv[i], "--verbose")) {
+      verbose = true;
+    } else if (!strcmp(argv[i], "--loops") && (i + 1) < argc) {
+      loops = atoi(argv[++i]);
+    } else {
+      fprintf(stderr, "Unknown argument %s\n", argv[i]);
+      return 1;
+    }
+  }
+
+  FILE *file = fopen(log_path, "rb");
+  if (!file) {
+    fprintf(stderr, "Cannot open %s: %s\n", log_path, strerror(errno));
+    return 1;
+  }
+
+  uint32_t magic = 0, version = 0, crtc_id = 0, conn_id = 0;
+  if (!ReadValue(file, &magic) || !ReadValue(file, &version) || !ReadValue(file, &crtc_id) ||
+      !ReadValue(file, &conn_id) || magic != kFileMagic || version != kFileVersion) {
+    fprintf(stderr, "%s is not a version %u commit recording\n", log_path, kFileVersion);
+    fclose(file);
+    return 1;
+  }
+
+  // Load the whole stream up front so file IO never lands inside the timed phases.
+  std::vector<Frame> frames;
+  Frame frame;
+  while (ReadFrame(file, &frame)) {
+    frames.push_back(frame);
+  }
+  fclose(file);
+
+  if (frames.empty()) {
+    fprintf(stderr, "No frames in %s\n", log_path);
+    return 1;
+  }
+  printf("Loaded %zu frames for CRTC %u connector %u from %s\n", frames.size(), crtc_id, conn_id,
+         log_path);
+
+  int dev_fd = drmOpen("msm_drm", nullptr);
+  if (dev_fd < 0) {
+    fprintf(stderr, "drmOpen failed: %s\n", strerror(errno));
+    return 1;
+  }
+  drmSetClientCap(dev_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+  drmSetClientCap(dev_fd, DRM_CLIENT_CAP_ATOMIC, 1);
+
+  PhaseStats check_stats;
+  PhaseStats commit_stats;
+  uint32_t failed = 0;
+  for (int loop = 0; loop < loops; loop++) {
+    for (const Frame &f : frames) {
+      if (ReplayFrame(dev_fd, f, real_commit, verbose, &check_stats, &commit_stats, &failed)) {
+        drmClose(dev_fd);
+        return 1;
+      }
+    }
+  }
+
+  printf("Replay complete, %u frame(s) failed\n", failed);
+  check_stats.Print("atomic check");
+  if (real_commit) {
+    commit_stats.Print("commit");
+  }
+
+  drmClose(dev_fd);
+  return 0;
+}
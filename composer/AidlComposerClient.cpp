@@ -798,6 +798,8 @@ Error AidlComposerClient::CommandEngine::execute(const std::vector<DisplayComman
   // std::set<int64_t> displaysPendingBrightnessChange;
   mCommandIndex = 0;
 
+  prefetchBuffers(commands);
+
   for (const auto &displayCmd : commands) {
     ExecuteCommand(displayCmd.brightness, &CommandEngine::executeSetDisplayBrightness,
                    displayCmd.display, *displayCmd.brightness);
@@ -872,6 +874,8 @@ Error AidlComposerClient::CommandEngine::execute(const std::vector<DisplayComman
     // }
   }
 
+  finishBufferPrefetch();
+
   if (!mCommandIndex) {
     ALOGW("%s: No command found", __FUNCTION__);
   }
@@ -882,6 +886,84 @@ Error AidlComposerClient::CommandEngine::execute(const std::vector<DisplayComman
   return (mCommandIndex) ? Error::None : Error::BadParameter;
 }
 
+void AidlComposerClient::CommandEngine::prefetchBuffers(
+    const std::vector<DisplayCommand> &commands) {
+  // Collect the fresh (non cache hit) buffers of the batch up front and run their gralloc
+  // imports on a worker, overlapped with the rest of the command walk. By the time the
+  // execute handler reaches each buffer the import has typically finished, so the hot
+  // loop no longer stalls behind the mapper. This covers layer buffers, the client
+  // target and the virtual display output buffer; the client target in particular is a
+  // full-screen allocation whose import used to land right before validate.
+  for (const auto &displayCmd : commands) {
+    for (const auto &layerCmd : displayCmd.layers) {
+      if (layerCmd.buffer && layerCmd.buffer->handle) {
+        mPrefetchedBuffers.emplace(&(*layerCmd.buffer), PrefetchedBuffer());
+      }
+    }
+    if (displayCmd.clientTarget && displayCmd.clientTarget->buffer.handle) {
+      mPrefetchedBuffers.emplace(&displayCmd.clientTarget->buffer, PrefetchedBuffer());
+    }
+    if (displayCmd.virtualDisplayOutputBuffer && displayCmd.virtualDisplayOutputBuffer->handle) {
+      mPrefetchedBuffers.emplace(&(*displayCmd.virtualDisplayOutputBuffer), PrefetchedBuffer());
+    }
+  }
+
+  if (mPrefetchedBuffers.empty()) {
+    return;
+  }
+
+  // The worker only writes the mapped values; the map itself is not mutated until the
+  // task has been joined, so consumers can run find() concurrently.
+  mPrefetchTask = std::async(std::launch::async, [this]() {
+    for (auto &item : mPrefetchedBuffers) {
+      buffer_handle_t handle = ::android::makeFromAidl(*item.first->handle);
+      item.second.clone = const_cast<native_handle_t *>(handle);
+      item.second.success = mHandleImporter.importBuffer(handle);
+      item.second.imported = item.second.success ? handle : nullptr;
+    }
+  });
+}
+
+bool AidlComposerClient::CommandEngine::takePrefetchedBuffer(const Buffer &buffer,
+                                                             buffer_handle_t *outHandle,
+                                                             native_handle_t **outClone,
+                                                             Error *outError) {
+  auto item = mPrefetchedBuffers.find(&buffer);
+  if (item == mPrefetchedBuffers.end()) {
+    return false;
+  }
+
+  // The first consumer joins the worker; later entries find their import already done.
+  if (mPrefetchTask.valid()) {
+    mPrefetchTask.wait();
+    mPrefetchTask = {};
+  }
+
+  *outHandle = item->second.imported;
+  *outClone = item->second.clone;
+  *outError = item->second.success ? Error::None : Error::NoResources;
+  mPrefetchedBuffers.erase(item);
+
+  return true;
+}
+
+void AidlComposerClient::CommandEngine::finishBufferPrefetch() {
+  if (mPrefetchTask.valid()) {
+    mPrefetchTask.wait();
+    mPrefetchTask = {};
+  }
+
+  // Entries are left behind only if a command errored out before consuming its buffer;
+  // release those imports so they do not leak.
+  for (auto &item : mPrefetchedBuffers) {
+    if (item.second.imported) {
+      mHandleImporter.freeBuffer(item.second.imported);
+    }
+    native_handle_delete(item.second.clone);
+  }
+  mPrefetchedBuffers.clear();
+}
+
 Error AidlComposerClient::CommandEngine::qtiExecute(const std::vector<QtiDisplayCommand> &commands,
                                                     std::vector<CommandResultPayload> *result) {
   for (const auto &displayCmd : commands) {
@@ -920,9 +1002,18 @@ void AidlComposerClient::CommandEngine::executeSetColorTransform(int64_t display
 void AidlComposerClient::CommandEngine::executeSetClientTarget(int64_t display,
                                                                const ClientTarget &command) {
   bool useCache = !command.buffer.handle;
-  buffer_handle_t clientTarget =
-      useCache ? nullptr : ::android::makeFromAidl(*command.buffer.handle);
-  native_handle_t *clientTargetClone = const_cast<native_handle_t *>(clientTarget);
+  buffer_handle_t clientTarget = nullptr;
+  native_handle_t *clientTargetClone = nullptr;
+  Error prefetchError = Error::None;
+  bool prefetched = false;
+  if (!useCache) {
+    prefetched =
+        takePrefetchedBuffer(command.buffer, &clientTarget, &clientTargetClone, &prefetchError);
+    if (!prefetched) {
+      clientTarget = ::android::makeFromAidl(*command.buffer.handle);
+      clientTargetClone = const_cast<native_handle_t *>(clientTarget);
+    }
+  }
   shared_ptr<Fence> fence = nullptr;
   auto &sfd = const_cast<::ndk::ScopedFileDescriptor &>(command.buffer.fence);
   auto fd = sfd.get();
@@ -936,8 +1027,9 @@ void AidlComposerClient::CommandEngine::executeSetClientTarget(int64_t display,
 
   sdm::Region region = {command.damage.size(),
                         reinterpret_cast<Rect const *>(command.damage.data())};
-  auto err = lookupBuffer(display, -1, BufferCache::CLIENT_TARGETS, command.buffer.slot, useCache,
-                          clientTarget, &clientTarget);
+  auto err = prefetched ? prefetchError
+                        : lookupBuffer(display, -1, BufferCache::CLIENT_TARGETS,
+                                       command.buffer.slot, useCache, clientTarget, &clientTarget);
   if (err == Error::None) {
     err = mClient.hwc_session_->SetClientTarget(display, clientTarget, fence,
                                                 INT32(command.dataspace), region);
@@ -972,8 +1064,17 @@ void AidlComposerClient::CommandEngine::executeSetDisplayBrightness(
 void AidlComposerClient::CommandEngine::executeSetOutputBuffer(uint64_t display,
                                                                const Buffer &buffer) {
   bool useCache = !buffer.handle;
-  buffer_handle_t outputBuffer = useCache ? nullptr : ::android::makeFromAidl(*buffer.handle);
-  native_handle_t *outputBufferClone = const_cast<native_handle_t *>(outputBuffer);
+  buffer_handle_t outputBuffer = nullptr;
+  native_handle_t *outputBufferClone = nullptr;
+  Error prefetchError = Error::None;
+  bool prefetched = false;
+  if (!useCache) {
+    prefetched = takePrefetchedBuffer(buffer, &outputBuffer, &outputBufferClone, &prefetchError);
+    if (!prefetched) {
+      outputBuffer = ::android::makeFromAidl(*buffer.handle);
+      outputBufferClone = const_cast<native_handle_t *>(outputBuffer);
+    }
+  }
   shared_ptr<Fence> fence = nullptr;
   auto &sfd = const_cast<::ndk::ScopedFileDescriptor &>(buffer.fence);
   auto fd = sfd.get();
@@ -985,8 +1086,9 @@ void AidlComposerClient::CommandEngine::executeSetOutputBuffer(uint64_t display,
     sync_wait(fd, -1);
   }
 
-  auto err = lookupBuffer(display, -1, BufferCache::OUTPUT_BUFFERS, buffer.slot, useCache,
-                          outputBuffer, &outputBuffer);
+  auto err = prefetched ? prefetchError
+                        : lookupBuffer(display, -1, BufferCache::OUTPUT_BUFFERS, buffer.slot,
+                                       useCache, outputBuffer, &outputBuffer);
   if (err == Error::None) {
     err = mClient.hwc_session_->SetOutputBuffer(display, outputBuffer, fence);
     auto updateBufErr =
@@ -1091,8 +1193,17 @@ void AidlComposerClient::CommandEngine::executeSetLayerCursorPosition(int64_t di
 void AidlComposerClient::CommandEngine::executeSetLayerBuffer(int64_t display, int64_t layer,
                                                               const Buffer &buffer) {
   bool useCache = !buffer.handle;
-  buffer_handle_t layerBuffer = useCache ? nullptr : ::android::makeFromAidl(*buffer.handle);
-  native_handle_t *layerBufferClone = const_cast<native_handle_t *>(layerBuffer);
+  buffer_handle_t layerBuffer = nullptr;
+  native_handle_t *layerBufferClone = nullptr;
+  Error prefetchError = Error::None;
+  bool prefetched = false;
+  if (!useCache) {
+    prefetched = takePrefetchedBuffer(buffer, &layerBuffer, &layerBufferClone, &prefetchError);
+    if (!prefetched) {
+      layerBuffer = ::android::makeFromAidl(*buffer.handle);
+      layerBufferClone = const_cast<native_handle_t *>(layerBuffer);
+    }
+  }
   shared_ptr<Fence> fence = nullptr;
   auto &sfd = const_cast<::ndk::ScopedFileDescriptor &>(buffer.fence);
   auto fd = sfd.get();
@@ -1104,8 +1215,11 @@ void AidlComposerClient::CommandEngine::executeSetLayerBuffer(int64_t display, i
     sync_wait(fd, -1);
   }
 
-  auto error = lookupBuffer(display, layer, BufferCache::LAYER_BUFFERS, buffer.slot, useCache,
-                            layerBuffer, &layerBuffer);
+  // Prefetched buffers were already imported on the worker; only the cache lookup or a
+  // non prefetched fresh handle goes through lookupBuffer here.
+  auto error = prefetched ? prefetchError
+                          : lookupBuffer(display, layer, BufferCache::LAYER_BUFFERS, buffer.slot,
+                                         useCache, layerBuffer, &layerBuffer);
   if (error == Error::None) {
     error = mClient.hwc_session_->SetLayerBuffer(display, layer, layerBuffer, fence);
     auto updateBufErr = updateBuffer(display, layer, BufferCache::LAYER_BUFFERS, buffer.slot,
@@ -1237,16 +1351,16 @@ void AidlComposerClient::CommandEngine::executeSetLayerZOrder(int64_t display, i
 void AidlComposerClient::CommandEngine::executeSetLayerPerFrameMetadata(
     int64_t display, int64_t layer,
     const std::vector<std::optional<PerFrameMetadata>> &perFrameMetadata) {
-  std::vector<int32_t> keys;
-  std::vector<float> values;
+  mScratchKeys.clear();
+  mScratchValues.clear();
 
   for (const auto &m : perFrameMetadata) {
-    keys.push_back(INT32(m->key));
-    values.push_back(static_cast<float>(m->value));
+    mScratchKeys.push_back(INT32(m->key));
+    mScratchValues.push_back(static_cast<float>(m->value));
   }
 
-  auto err = mClient.hwc_session_->SetLayerPerFrameMetadata(display, layer, perFrameMetadata.size(),
-                                                            keys.data(), values.data());
+  auto err = mClient.hwc_session_->SetLayerPerFrameMetadata(
+      display, layer, perFrameMetadata.size(), mScratchKeys.data(), mScratchValues.data());
   if (err != Error::None) {
     writeError(__FUNCTION__, err);
   }
@@ -1263,19 +1377,19 @@ void AidlComposerClient::CommandEngine::executeSetLayerColorTransform(
 void AidlComposerClient::CommandEngine::executeSetLayerPerFrameMetadataBlobs(
     int64_t display, int64_t layer,
     const std::vector<std::optional<PerFrameMetadataBlob>> &perFrameMetadataBlob) {
-  std::vector<int32_t> keys;
-  std::vector<uint32_t> sizes_of_metablob_;
-  std::vector<uint8_t> blob_of_data_;
+  mScratchKeys.clear();
+  mScratchBlobSizes.clear();
+  mScratchBlobData.clear();
 
   for (const auto &m : perFrameMetadataBlob) {
-    keys.push_back(INT32(m->key));
-    sizes_of_metablob_.push_back(UINT32(m->blob.size()));
-    blob_of_data_.insert(blob_of_data_.end(), m->blob.begin(), m->blob.end());
+    mScratchKeys.push_back(INT32(m->key));
+    mScratchBlobSizes.push_back(UINT32(m->blob.size()));
+    mScratchBlobData.insert(mScratchBlobData.end(), m->blob.begin(), m->blob.end());
   }
 
   auto err = mClient.hwc_session_->SetLayerPerFrameMetadataBlobs(
-      display, layer, perFrameMetadataBlob.size(), keys.data(), sizes_of_metablob_.data(),
-      blob_of_data_.data());
+      display, layer, perFrameMetadataBlob.size(), mScratchKeys.data(), mScratchBlobSizes.data(),
+      mScratchBlobData.data());
   if (err != Error::None) {
     writeError(__FUNCTION__, err);
   }
@@ -1341,38 +1455,51 @@ Error AidlComposerClient::CommandEngine::postPresentDisplay(int64_t display,
     return Error::None;
   }
 
-  std::vector<sdm::LayerId> layers;
-  std::vector<shared_ptr<Fence>> releaseFences;
-  std::vector<::ndk::ScopedFileDescriptor> aidlReleaseFences;
-  layers.resize(count);
-  releaseFences.resize(count);
-  err = mClient.hwc_session_->GetReleaseFences(display, &count, layers.data(), &releaseFences);
+  mScratchReleaseLayers.clear();
+  mScratchReleaseFences.clear();
+  mScratchAidlReleaseFences.clear();
+  mScratchReleaseLayers.resize(count);
+  mScratchReleaseFences.resize(count);
+  err = mClient.hwc_session_->GetReleaseFences(display, &count, mScratchReleaseLayers.data(),
+                                               &mScratchReleaseFences);
   if (err != Error::None) {
     ALOGW("%s: Failed to get release fences", __FUNCTION__);
-    layers.clear();
-    releaseFences.clear();
+    mScratchReleaseLayers.clear();
+    mScratchReleaseFences.clear();
     return Error::None;
   }
 
-  // Convert from Fence to ScopedFileDescriptor
-  for (auto const &fd : releaseFences) {
-    aidlReleaseFences.emplace_back(::ndk::ScopedFileDescriptor(Fence::Dup(fd)));
+  // Convert from Fence to ScopedFileDescriptor. Layers whose release fence is the retire
+  // fence object itself (release-fence speculation, see HWCDisplay::RetrieveFences) still
+  // get an entry — clients treat a missing entry as "no fence" and release the previous
+  // buffer immediately. The dup is of the single per-frame present fence, so the per-layer
+  // sync merges stay eliminated.
+  for (size_t i = 0; i < mScratchReleaseFences.size(); i++) {
+    mScratchAidlReleaseFences.emplace_back(
+        ::ndk::ScopedFileDescriptor(Fence::Dup(mScratchReleaseFences[i])));
   }
 
   mWriter->setPresentFence(display,
                            std::move(::ndk::ScopedFileDescriptor(Fence::Dup(*presentFence))));
-  mWriter->setReleaseFences(display, layers, std::move(aidlReleaseFences));
+  mWriter->setReleaseFences(display, mScratchReleaseLayers, std::move(mScratchAidlReleaseFences));
+
+  // Drop fence references right away instead of holding them until the next frame.
+  mScratchReleaseFences.clear();
 
   return Error::None;
 }
 
 Error AidlComposerClient::CommandEngine::postValidateDisplay(int64_t display, uint32_t &types_count,
                                                              uint32_t &reqs_count) {
-  std::vector<sdm::LayerId> changedLayers;
-  std::vector<Composition> compositionTypes;
-  std::vector<sdm::LayerId> requestedLayers;
-  std::vector<int32_t> requestMasks;
+  std::vector<sdm::LayerId> &changedLayers = mScratchChangedLayers;
+  std::vector<Composition> &compositionTypes = mScratchCompositionTypes;
+  std::vector<sdm::LayerId> &requestedLayers = mScratchRequestedLayers;
+  std::vector<int32_t> &requestMasks = mScratchRequestMasks;
   ClientTargetProperty clientTargetProperty;
+  changedLayers.clear();
+  compositionTypes.clear();
+  requestedLayers.clear();
+  requestMasks.clear();
   changedLayers.resize(types_count);
   compositionTypes.resize(types_count);
   auto err =
@@ -1418,10 +1545,8 @@ Error AidlComposerClient::CommandEngine::postValidateDisplay(int64_t display, ui
     return err;
   }
 
-  mWriter->setChangedCompositionTypes(display, static_cast<std::vector<int64_t>>(changedLayers),
-                                      compositionTypes);
-  mWriter->setDisplayRequests(display, display_reqs,
-                              static_cast<std::vector<int64_t>>(requestedLayers), requestMasks);
+  mWriter->setChangedCompositionTypes(display, changedLayers, compositionTypes);
+  mWriter->setDisplayRequests(display, display_reqs, requestedLayers, requestMasks);
   static constexpr float kBrightness = 1.f;
   DimmingStage dimmingStage = DimmingStage::NONE;
   mWriter->setClientTargetProperty(display, clientTargetProperty, kBrightness, dimmingStage);
@@ -22,6 +22,8 @@
 #pragma once
 
 #include <log/log.h>
+#include <future>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <string>
@@ -78,6 +80,7 @@ using aidl::android::hardware::graphics::composer3::IComposerCallback;
 using aidl::android::hardware::graphics::composer3::LayerBrightness;
 using aidl::android::hardware::graphics::composer3::OverlayProperties;
 using aidl::android::hardware::graphics::composer3::ParcelableBlendMode;
+using aidl::android::hardware::graphics::composer3::Composition;
 using aidl::android::hardware::graphics::composer3::ParcelableComposition;
 using aidl::android::hardware::graphics::composer3::ParcelableDataspace;
 using aidl::android::hardware::graphics::composer3::ParcelableTransform;
@@ -348,6 +351,20 @@ class AidlComposerClient : public BnComposerClient {
       LAYER_SIDEBAND_STREAMS,
     };
 
+    // Async prefill of fresh buffer imports (layer buffers, client targets, virtual
+    // output buffers), keyed by the address of the Buffer command inside the batch being
+    // executed; see prefetchBuffers().
+    struct PrefetchedBuffer {
+      native_handle_t *clone = nullptr;
+      buffer_handle_t imported = nullptr;
+      bool success = false;
+    };
+
+    void prefetchBuffers(const std::vector<DisplayCommand> &commands);
+    bool takePrefetchedBuffer(const Buffer &buffer, buffer_handle_t *outHandle,
+                              native_handle_t **outClone, Error *outError);
+    void finishBufferPrefetch();
+
     Error lookupBufferCacheEntryLocked(int64_t display, int64_t layer, BufferCache cache,
                                        uint32_t slot, BufferCacheEntry **outEntry);
     Error lookupBuffer(int64_t display, int64_t layer, BufferCache cache, uint32_t slot,
@@ -365,6 +382,24 @@ class AidlComposerClient : public BnComposerClient {
     }
     Error postPresentDisplay(int64_t display, shared_ptr<Fence> *presentFence);
     Error postValidateDisplay(int64_t display, uint32_t &types_count, uint32_t &reqs_count);
+
+    // Scratch vectors reused across frames. They are cleared before each use so the
+    // capacity from earlier frames is retained and steady-state command batches execute
+    // without heap allocation.
+    std::vector<int32_t> mScratchKeys;
+    std::vector<float> mScratchValues;
+    std::vector<uint32_t> mScratchBlobSizes;
+    std::vector<uint8_t> mScratchBlobData;
+    std::vector<sdm::LayerId> mScratchChangedLayers;
+    std::vector<Composition> mScratchCompositionTypes;
+    std::vector<sdm::LayerId> mScratchRequestedLayers;
+    std::vector<int32_t> mScratchRequestMasks;
+    std::vector<sdm::LayerId> mScratchReleaseLayers;
+    std::vector<shared_ptr<Fence>> mScratchReleaseFences;
+    std::vector<::ndk::ScopedFileDescriptor> mScratchAidlReleaseFences;
+
+    std::unordered_map<const Buffer *, PrefetchedBuffer> mPrefetchedBuffers;
+    std::future<void> mPrefetchTask;
   };
 
   HWCSession *hwc_session_ = nullptr;
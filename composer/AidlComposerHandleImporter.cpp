@@ -62,10 +62,32 @@ void ComposerHandleImporter::initialize() {
 }
 
 void ComposerHandleImporter::cleanup() {
+  if (!import_cache_.empty()) {
+    ALOGW("%s: %zu imported buffers still cached", __FUNCTION__, import_cache_.size());
+    import_cache_.clear();
+    imported_keys_.clear();
+  }
   mMapper.clear();
   mInitialized = false;
 }
 
+// Identity of the underlying allocation. The raw handles SurfaceFlinger sends are fresh clones
+// every frame, but their buffer fd always resolves to the same dma-buf inode, which is the same
+// identity InoFdMapInsert tracks. Returns 0 when the identity cannot be established; such
+// handles bypass the cache.
+uint64_t ComposerHandleImporter::BufferKey(buffer_handle_t handle) {
+  if (!handle->numFds) {
+    return 0;
+  }
+
+  struct stat buf1;
+  if (fstat(handle->data[0], &buf1)) {
+    return 0;
+  }
+
+  return (uint64_t)buf1.st_ino;
+}
+
 void ComposerHandleImporter::InoFdMapInsert(int fd) {
   struct stat buf1;
   if (fstat(fd, &buf1)) {
@@ -126,6 +148,17 @@ bool ComposerHandleImporter::importBuffer(buffer_handle_t &handle) {
     return false;
   }
 
+  uint64_t key = BufferKey(handle);
+  if (key) {
+    auto it = import_cache_.find(key);
+    if (it != import_cache_.end()) {
+      // Same underlying buffer as an earlier import; skip the mapper round trip.
+      it->second.refcount++;
+      handle = it->second.handle;
+      return true;
+    }
+  }
+
   Error error;
   buffer_handle_t importedHandle;
 
@@ -146,6 +179,11 @@ bool ComposerHandleImporter::importBuffer(buffer_handle_t &handle) {
 
   handle = importedHandle;
 
+  if (key) {
+    import_cache_[key] = {handle, 1};
+    imported_keys_[handle] = key;
+  }
+
   if (enable_memory_mapping_) {
     for (int i = 0; i < handle->numFds; i++) {
       // handle->data is the int array of fds. run insert on all fds.
@@ -168,6 +206,17 @@ void ComposerHandleImporter::freeBuffer(buffer_handle_t handle) {
     return;
   }
 
+  auto key_it = imported_keys_.find(handle);
+  if (key_it != imported_keys_.end()) {
+    ImportCacheEntry &entry = import_cache_[key_it->second];
+    if (--entry.refcount) {
+      // Other owners still hold this import; defer the mapper free until the last one.
+      return;
+    }
+    import_cache_.erase(key_it->second);
+    imported_keys_.erase(key_it);
+  }
+
   if (enable_memory_mapping_) {
     for (int i = 0; i < handle->numFds; i++) {
       // handle->data is the int array of fds. run remove on all fds.
@@ -62,10 +62,22 @@ class ComposerHandleImporter {
   void InoFdMapRemove(int fd);
 
  private:
+  // Imported handles memoized on the underlying dma-buf identity. SurfaceFlinger resends the
+  // same client target and output buffers every frame as fresh raw handles; a cache hit reuses
+  // the already imported handle and bumps a refcount instead of running another mapper import.
+  struct ImportCacheEntry {
+    buffer_handle_t handle = nullptr;
+    uint32_t refcount = 0;
+  };
+
+  uint64_t BufferKey(buffer_handle_t handle);
+
   Mutex mLock;
   bool mInitialized = false;
   bool enable_memory_mapping_ = false;
   std::map<uint64_t, std::vector<uint32_t>> ino_fds_map_;
+  std::map<uint64_t, ImportCacheEntry> import_cache_;   // dma-buf inode -> imported handle
+  std::map<buffer_handle_t, uint64_t> imported_keys_;   // reverse lookup for freeBuffer
   sp<IMapper> mMapper;
 };
 
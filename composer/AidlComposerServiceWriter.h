@@ -58,7 +58,12 @@ class ComposerServiceWriter {
 
   virtual ~ComposerServiceWriter() { reset(); }
 
-  void reset() { mCommandsResults.clear(); }
+  void reset() {
+    mCommandsResults.clear();
+    // Results are moved out each frame; reserving what the last frame produced lets
+    // steady-state frames fill the vector without growth reallocations.
+    mCommandsResults.reserve(mLastResultCount);
+  }
 
   void setError(int32_t index, int32_t errorCode) {
     CommandError error;
@@ -140,11 +145,13 @@ class ComposerServiceWriter {
   }
 
   std::vector<CommandResultPayload> getPendingCommandResults() {
+    mLastResultCount = mCommandsResults.size();
     return std::move(mCommandsResults);
   }
 
  private:
   std::vector<CommandResultPayload> mCommandsResults;
+  size_t mLastResultCount = 0;
 };
 
 }  // namespace composer3
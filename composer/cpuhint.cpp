@@ -36,7 +36,13 @@
 
 #include <cutils/properties.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
 #include <thread>
+#include <vector>
 #include <utils/debug.h>
 
 #include "cpuhint.h"
@@ -46,11 +52,38 @@
 
 namespace sdm {
 
+namespace {
+
+// Local copy of the sched_setattr uapi; the ndk sysroot does not export it.
+struct SchedAttr {
+  uint32_t size;
+  uint32_t sched_policy;
+  uint64_t sched_flags;
+  int32_t sched_nice;
+  uint32_t sched_priority;
+  uint64_t sched_runtime;
+  uint64_t sched_deadline;
+  uint64_t sched_period;
+  uint32_t sched_util_min;
+  uint32_t sched_util_max;
+};
+
+constexpr uint64_t kSchedFlagKeepAll = 0x18;       // SCHED_FLAG_KEEP_POLICY | KEEP_PARAMS
+constexpr uint64_t kSchedFlagUtilClampMin = 0x20;  // SCHED_FLAG_UTIL_CLAMP_MIN
+constexpr uint32_t kUclampMax = 1024;
+constexpr uint32_t kUclampFloor = 128;        // boost floor while actively drawing
+constexpr uint32_t kUclampApplyDelta = 64;    // skip syscall for smaller changes
+
+}  // namespace
+
 DisplayError CPUHint::Init(HWCDebugHandler *debug_handler) {
+  // Scheduling hints talk to the kernel directly and work without the perf HAL.
+  InitSchedulingHints(debug_handler);
+
   char path[PROPERTY_VALUE_MAX];
   if (debug_handler->GetProperty("ro.vendor.extension_library", path) != kErrorNone) {
     DLOGI("Vendor Extension Library not enabled");
-    return kErrorNotSupported;
+    return sched_hints_enabled_ ? kErrorNone : kErrorNotSupported;
   }
 
   if (vendor_ext_lib_.Open(path)) {
@@ -62,7 +95,7 @@ DisplayError CPUHint::Init(HWCDebugHandler *debug_handler) {
                              reinterpret_cast<void **>(&fn_perf_hint_offload_)) ||
         !vendor_ext_lib_.Sym("perf_event", reinterpret_cast<void **>(&fn_perf_event_))) {
       DLOGW("Failed to load symbols for Vendor Extension Library");
-      return kErrorNotSupported;
+      return sched_hints_enabled_ ? kErrorNone : kErrorNotSupported;
     }
     DLOGI("Successfully Loaded Vendor Extension Library symbols");
     enabled_ = (fn_perf_hint_acq_rel_offload_ != NULL && fn_perf_lock_rel_offload_ != NULL &&
@@ -71,7 +104,143 @@ DisplayError CPUHint::Init(HWCDebugHandler *debug_handler) {
     DLOGW("Failed to open %s : %s", path, vendor_ext_lib_.Error());
   }
 
-  return enabled_ ? kErrorNone : kErrorNotSupported;
+  return (enabled_ || sched_hints_enabled_) ? kErrorNone : kErrorNotSupported;
+}
+
+void CPUHint::InitSchedulingHints(HWCDebugHandler *debug_handler) {
+  int disable_sched_hints = 0;
+  debug_handler->GetProperty(DISABLE_CPU_SCHED_HINTS, &disable_sched_hints);
+  if (disable_sched_hints) {
+    DLOGI("CPU scheduling hints disabled by property");
+    return;
+  }
+
+  // The big cluster is the set of CPUs reporting the highest capacity. On
+  // symmetric parts every CPU qualifies and affinity pinning is skipped.
+  long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+  uint32_t max_capacity = 0;
+  std::vector<uint32_t> capacities;
+  for (long cpu = 0; cpu < num_cpus; cpu++) {
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/cpu_capacity", cpu);
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+      return;
+    }
+    uint32_t capacity = 0;
+    int matched = fscanf(fp, "%u", &capacity);
+    fclose(fp);
+    if (matched != 1) {
+      return;
+    }
+    capacities.push_back(capacity);
+    max_capacity = std::max(max_capacity, capacity);
+  }
+
+  CPU_ZERO(&big_cores_);
+  uint32_t big_core_count = 0;
+  for (size_t cpu = 0; cpu < capacities.size(); cpu++) {
+    if (capacities[cpu] == max_capacity) {
+      CPU_SET(cpu, &big_cores_);
+      big_core_count++;
+    }
+  }
+  have_big_cores_ = (big_core_count > 0 && big_core_count < capacities.size());
+
+  sched_hints_enabled_ = true;
+  DLOGI("CPU scheduling hints enabled: %u of %zu cpus in big cluster", big_core_count,
+        capacities.size());
+}
+
+bool CPUHint::SetUclampMin(int tid, uint32_t min) {
+  SchedAttr attr = {};
+  attr.size = sizeof(attr);
+  attr.sched_flags = kSchedFlagKeepAll | kSchedFlagUtilClampMin;
+  attr.sched_util_min = min;
+  attr.sched_util_max = kUclampMax;
+
+  if (syscall(SYS_sched_setattr, tid, &attr, 0)) {
+    DLOGW_IF(kTagCpuHint, "sched_setattr(uclamp.min=%u) failed for tid %d errno %d", min, tid,
+             errno);
+    return false;
+  }
+
+  return true;
+}
+
+void CPUHint::ApplySchedulingHints(int tid) {
+  if (have_big_cores_) {
+    if (sched_setaffinity(tid, sizeof(big_cores_), &big_cores_)) {
+      DLOGW_IF(kTagCpuHint, "Failed to pin tid %d to big cluster errno %d", tid, errno);
+    }
+  }
+
+  if (SetUclampMin(tid, current_uclamp_min_)) {
+    sched_hints_active_ = true;
+    sched_hints_tid_ = tid;
+  }
+}
+
+void CPUHint::BeginFrame() {
+  if (!sched_hints_enabled_) {
+    return;
+  }
+
+  int tid = gettid();
+  if (!sched_hints_active_ || sched_hints_tid_ != tid) {
+    current_uclamp_min_ = std::max(current_uclamp_min_, kUclampFloor);
+    ApplySchedulingHints(tid);
+  }
+
+  frame_cpu_start_ = systemTime(SYSTEM_TIME_THREAD);
+}
+
+void CPUHint::EndFrame(nsecs_t frame_period_ns) {
+  if (!sched_hints_enabled_ || !frame_cpu_start_ || frame_period_ns <= 0) {
+    return;
+  }
+
+  nsecs_t frame_cpu_ns = systemTime(SYSTEM_TIME_THREAD) - frame_cpu_start_;
+  frame_cpu_start_ = 0;
+
+  // EMA over ~8 frames keeps the boost stable across per-frame noise.
+  avg_frame_cpu_ns_ = (avg_frame_cpu_ns_ * 7 + frame_cpu_ns) / 8;
+
+  // Size the boost from the fraction of the frame period spent on the CPU,
+  // with headroom so the commit thread does not run at the ragged edge.
+  uint64_t util = (UINT64(avg_frame_cpu_ns_) * kUclampMax * 2) / UINT64(frame_period_ns);
+  uint32_t target = std::max(kUclampFloor, UINT32(std::min<uint64_t>(util, kUclampMax)));
+
+  uint32_t delta = (target > current_uclamp_min_) ? (target - current_uclamp_min_)
+                                                  : (current_uclamp_min_ - target);
+  if (sched_hints_active_ && delta >= kUclampApplyDelta) {
+    if (SetUclampMin(sched_hints_tid_, target)) {
+      current_uclamp_min_ = target;
+    }
+  }
+}
+
+void CPUHint::ReleaseSchedulingHints() {
+  if (!sched_hints_enabled_ || !sched_hints_active_) {
+    return;
+  }
+
+  // Reset affinity to all CPUs and drop the boost until drawing resumes.
+  if (have_big_cores_) {
+    cpu_set_t all_cpus;
+    CPU_ZERO(&all_cpus);
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < num_cpus; cpu++) {
+      CPU_SET(cpu, &all_cpus);
+    }
+    sched_setaffinity(sched_hints_tid_, sizeof(all_cpus), &all_cpus);
+  }
+
+  SetUclampMin(sched_hints_tid_, 0);
+  current_uclamp_min_ = 0;
+  avg_frame_cpu_ns_ = 0;
+  sched_hints_active_ = false;
+  sched_hints_tid_ = 0;
 }
 
 int CPUHint::ReqHintsOffload(int hint, int tid) {
@@ -140,6 +309,10 @@ int CPUHint::ReqHintRelease() {
 }
 
 int CPUHint::ReqTidChangeOffload(PerfHintThreadType type, int tid) {
+  if (!enabled_) {
+    return -1;
+  }
+
   std::lock_guard<std::mutex> lock(tid_lock_);
 
   int handle = fn_perf_hint_offload_(kHintPassPid, nullptr, tid, type, 0, nullptr);
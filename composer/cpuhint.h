@@ -38,6 +38,7 @@
 #define __CPUHINT_H__
 
 #include <core/sdm_types.h>
+#include <sched.h>
 #include <utils/sys.h>
 #include <utils/Timers.h>
 
@@ -73,7 +74,18 @@ class CPUHint {
   int ReqTidChangeOffload(PerfHintThreadType type, int tid);
   void ReqEvent(int event);
 
+  // Adaptive scheduling hints for the commit thread. BeginFrame()/EndFrame()
+  // bracket the commit path and measure its CPU time; while active the thread
+  // is pinned to the big cluster with a uclamp.min boost sized from the
+  // measured load. ReleaseSchedulingHints() drops both at idle.
+  void BeginFrame();
+  void EndFrame(nsecs_t frame_period_ns);
+  void ReleaseSchedulingHints();
+
  private:
+  void InitSchedulingHints(HWCDebugHandler *debug_handler);
+  void ApplySchedulingHints(int tid);
+  bool SetUclampMin(int tid, uint32_t min);
   const int kLargeComposition = 0x00001097;
   const int kHintPassPid = 0x0000109C;  // Inform mpctl about the TID
 
@@ -88,6 +100,17 @@ class CPUHint {
   std::mutex tid_lock_;
 
   LongTermHintInfo large_comp_cycle_{};
+
+  // Scheduling hint engine state. Only touched from the commit thread except
+  // ReleaseSchedulingHints(), which idle/power paths may call.
+  bool sched_hints_enabled_ = false;
+  bool sched_hints_active_ = false;
+  bool have_big_cores_ = false;
+  cpu_set_t big_cores_ {};
+  int sched_hints_tid_ = 0;
+  nsecs_t frame_cpu_start_ = 0;
+  nsecs_t avg_frame_cpu_ns_ = 0;  // exponential moving average of commit CPU time
+  uint32_t current_uclamp_min_ = 0;
 };
 
 }  // namespace sdm
@@ -37,6 +37,8 @@
 #ifndef __GL_COLOR_CONVERT_H__
 #define __GL_COLOR_CONVERT_H__
 
+#include <vector>
+
 #include "gl_common.h"
 
 namespace sdm {
@@ -46,6 +48,26 @@ enum GLRenderTarget {
   kTargetYUV,
 };
 
+enum GLYuvConvStandard {
+  kYuvConv601,  // limited range BT.601, used by 8-bit NV12 style outputs
+  kYuvConv709,  // BT.709, typically paired with 10-bit (P010) outputs
+};
+
+// One source/destination pair of a batched conversion. The YUV plane layout of the
+// output (NV12, P010, AYUV etc.) follows the destination buffer format; only the
+// conversion standard needs to be picked per item. release_fence is populated per
+// item so consumers can wait on exactly the conversion they depend on.
+struct GLBlitItem {
+  const native_handle_t *src_hnd = nullptr;
+  const native_handle_t *dst_hnd = nullptr;
+  GLRect src_rect = {};
+  GLRect dst_rect = {};
+  GLYuvConvStandard standard = kYuvConv601;
+  shared_ptr<Fence> src_acquire_fence = nullptr;
+  shared_ptr<Fence> dst_acquire_fence = nullptr;
+  shared_ptr<Fence> release_fence = nullptr;
+};
+
 class GLColorConvert {
  public:
   static GLColorConvert *GetInstance(GLRenderTarget target, bool secure);
@@ -56,6 +78,7 @@ class GLColorConvert {
                    const shared_ptr<Fence> &src_acquire_fence,
                    const shared_ptr<Fence> &dst_acquire_fence,
                    shared_ptr<Fence> *release_fence) = 0;
+  virtual int BlitBatch(std::vector<GLBlitItem> *items) = 0;
   virtual void Reset() = 0;
 
  protected:
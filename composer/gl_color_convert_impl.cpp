@@ -77,6 +77,22 @@ const char *kConvertRgbToYuvShader =
     "    color = vec4(rgb_2_yuv(rgbColor, itu_601), 1.0);                  \n"
     "}                                                                     \n";
 
+const char *kConvertRgbToYuv709Shader =
+    ""
+    "#extension GL_EXT_YUV_target : require                                \n"
+    "precision highp float;                                                \n"
+    "                                                                      \n"
+    "layout(binding = 0) uniform sampler2D u_sTexture;                     \n"
+    "                                                                      \n"
+    "in vec2 uv;                                                           \n"
+    "layout (yuv) out vec4 color;                                          \n"
+    "                                                                      \n"
+    "void main()                                                           \n"
+    "{                                                                     \n"
+    "    vec3 rgbColor = texture(u_sTexture, uv).rgb;                      \n"
+    "    color = vec4(rgb_2_yuv(rgbColor, itu_709), 1.0);                  \n"
+    "}                                                                     \n";
+
 int GLColorConvertImpl::CreateContext(GLRenderTarget target, bool secure) {
   if (target != kTargetRGBA && target != kTargetYUV) {
     DLOGE("Invalid GLRenderTarget: %d", target);
@@ -161,6 +177,11 @@ int GLColorConvertImpl::CreateContext(GLRenderTarget target, bool secure) {
 
   ctx_.program_id = LoadProgram(1, &kVertexShader, count, fragment_shaders);
 
+  // BT.709 variant of the same kernel; the output plane layout (NV12, P010, AYUV)
+  // is taken from the destination EGL image, so only the standard differs.
+  const char *fragment_shaders_709[2] = {version, kConvertRgbToYuv709Shader};
+  program_709_id_ = LoadProgram(1, &kVertexShader, 2, fragment_shaders_709);
+
   SetRealTimePriority();
 
   return 0;
@@ -196,12 +217,49 @@ int GLColorConvertImpl::Blit(const native_handle_t *src_hnd, const native_handle
   return 0;
 }
 
+int GLColorConvertImpl::BlitBatch(std::vector<GLBlitItem> *items) {
+  DTRACE_SCOPED();
+  if (!items || items->empty()) {
+    return -1;
+  }
+
+  // Bind the rendering context and vertex state once; per item cost is then only the
+  // source/destination rebind and a draw, so the whole batch goes down in one submission.
+  MakeCurrent(&ctx_);
+
+  glEnableVertexAttribArray(0);
+  glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, kFullScreenVertices);
+  glEnableVertexAttribArray(1);
+  glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, kFullScreenTexCoords);
+
+  // Queue GPU side waits for every source and destination up front.
+  std::vector<shared_ptr<Fence>> in_fences;
+  for (GLBlitItem &item : *items) {
+    in_fences.push_back(Fence::Merge(item.src_acquire_fence, item.dst_acquire_fence));
+  }
+  WaitOnInputFence(in_fences);
+
+  for (GLBlitItem &item : *items) {
+    SetProgram((item.standard == kYuvConv709) ? program_709_id_ : ctx_.program_id);
+    SetSourceBuffer(item.src_hnd);
+    SetDestinationBuffer(item.dst_hnd);
+    SetViewport(item.dst_rect);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+
+    // Per item fence so each consumer waits on exactly the conversion it needs.
+    CreateOutputFence(&item.release_fence);
+  }
+
+  return 0;
+}
+
 int GLColorConvertImpl::Init() {
   return CreateContext(target_, secure_);
 }
 
 int GLColorConvertImpl::Deinit() {
   MakeCurrent(&ctx_);
+  DeleteProgram(program_709_id_);
   DestroyContext(&ctx_);
 
   return 0;
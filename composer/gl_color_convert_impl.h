@@ -53,6 +53,7 @@ class GLColorConvertImpl : public GLColorConvert, public GLCommon {
                    const GLRect &src_rect, const GLRect &dst_rect,
                    const shared_ptr<Fence> &src_acquire_fence,
                    const shared_ptr<Fence> &dst_acquire_fence, shared_ptr<Fence> *release_fence);
+  virtual int BlitBatch(std::vector<GLBlitItem> *items);
   virtual int CreateContext(GLRenderTarget target, bool secure);
   virtual int Init();
   virtual int Deinit();
@@ -62,6 +63,7 @@ class GLColorConvertImpl : public GLColorConvert, public GLCommon {
   GLRenderTarget target_ = kTargetRGBA;
   bool secure_ = false;
   GLContext ctx_;
+  uint32_t program_709_id_ = 0;
 };
 
 }  // namespace sdm
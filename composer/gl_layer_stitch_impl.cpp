@@ -145,48 +145,38 @@ int GLLayerStitchImpl::Blit(const std::vector<StitchParams> &stitch_params,
                             shared_ptr<Fence> *release_fence) {
   DTRACE_SCOPED();
 
+  // Queue one GPU-side wait on all input fences before any draw is issued, so every
+  // rect of the batch is covered without per-rect sync points.
   std::vector<shared_ptr<Fence>> acquire_fences;
-  std::vector<shared_ptr<Fence>> release_fences;
-  bool can_batch = !NeedsGLScissor(stitch_params);
+  acquire_fences.reserve(stitch_params.size());
   for (auto &info : stitch_params) {
-    SetSourceBuffer(info.src_hnd);
-    SetDestinationBuffer(info.dst_hnd);
-    SetViewport(info.dst_rect);
-    ClearWithTransparency(info.scissor_rect);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-
     acquire_fences.push_back(info.src_acquire_fence);
-
-    if (!can_batch) {
-      // Trigger flush and cache release fence.
-      WaitOnInputFence(acquire_fences);
-      shared_ptr<Fence> temp_release_fence = nullptr;
-      CreateOutputFence(&temp_release_fence);
-      release_fences.push_back(temp_release_fence);
-      acquire_fences = {};
-    }
-  }
-
-  if (can_batch) {
-    // Create output fence for client to wait on.
-    WaitOnInputFence(acquire_fences);
-    CreateOutputFence(release_fence);
-  } else {
-    // Merge all fd's and return one.
-    *release_fence = Fence::Merge(release_fences, false);
   }
+  WaitOnInputFence(acquire_fences);
 
-  return 0;
-}
-
-int GLLayerStitchImpl::NeedsGLScissor(const std::vector<StitchParams> &stitch_params) {
+  // All rects render into the same client target and often repeat sources; rebind the
+  // texture/FBO attachments (cached per handle in image_wrapper_) only when they change.
+  const native_handle_t *current_src = nullptr;
+  const native_handle_t *current_dst = nullptr;
   for (auto &info : stitch_params) {
-    if (IsValid(info.scissor_rect)) {
-      return true;
+    if (info.src_hnd != current_src) {
+      SetSourceBuffer(info.src_hnd);
+      current_src = info.src_hnd;
     }
+    if (info.dst_hnd != current_dst) {
+      SetDestinationBuffer(info.dst_hnd);
+      current_dst = info.dst_hnd;
+    }
+    SetViewport(info.dst_rect);
+    ClearWithTransparency(info.scissor_rect);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
   }
 
-  return false;
+  // Draws execute in order on this context, so one output fence covers the whole batch,
+  // scissored or not.
+  CreateOutputFence(release_fence);
+
+  return 0;
 }
 
 int GLLayerStitchImpl::Init() {
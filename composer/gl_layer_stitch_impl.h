@@ -62,7 +62,6 @@ class GLLayerStitchImpl : public GLLayerStitch, public GLCommon {
 
   void InitContext();
   void ClearWithTransparency(const GLRect &scissor_rect);
-  int NeedsGLScissor(const std::vector<StitchParams> &stitch_params);
 };
 
 }  // namespace sdm
@@ -761,6 +761,14 @@ int HWCBufferAllocator::GetBufferLayout(const AllocatedBufferInfo &buf_info, uin
   return kErrorNone;
 }
 
+int HWCBufferAllocator::ClearBufferContents(void *buf, void *base_ptr) {
+  if (!buf || !base_ptr) {
+    return -EINVAL;
+  }
+  auto hnd = static_cast<private_handle_t *>(buf);
+  return gralloc::ClearBufferContents(hnd, base_ptr);
+}
+
 int HWCBufferAllocator::MapBuffer(const native_handle_t *handle, shared_ptr<Fence> acquire_fence,
                                   void **base_ptr) {
   auto err = GetGrallocInstance();
@@ -84,6 +84,7 @@ class HWCBufferAllocator : public BufferAllocator {
                              AllocatedBufferInfo *allocated_buffer_info);
   int GetBufferLayout(const AllocatedBufferInfo &buf_info, uint32_t stride[4], uint32_t offset[4],
                       uint32_t *num_planes);
+  int ClearBufferContents(void *buf, void *base_ptr);
   int SetBufferInfo(LayerBufferFormat format, int *target, uint64_t *flags);
   int MapBuffer(const native_handle_t *handle, shared_ptr<Fence> acquire_fence, void **base_ptr);
   int UnmapBuffer(const native_handle_t *handle, int *release_fence);
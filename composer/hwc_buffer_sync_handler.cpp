@@ -35,10 +35,14 @@
  */
 
 #include <errno.h>
+#include <poll.h>
 #include <sync/sync.h>
+#include <time.h>
 #include <utils/constants.h>
 #include <utils/debug.h>
 #include <utils/fence.h>
+#include <algorithm>
+#include <vector>
 
 #include "hwc_debugger.h"
 #include "hwc_buffer_sync_handler.h"
@@ -74,6 +78,105 @@ int HWCBufferSyncHandler::SyncWait(int fd, int timeout) {
   return 0;
 }
 
+int HWCBufferSyncHandler::SyncTryWait(int fd) {
+  // Assume invalid fd as signaled.
+  if (fd < 0) {
+    return 0;
+  }
+
+  // Query fence state via SYNC_IOC_FILE_INFO instead of arming a wait.
+  struct sync_file_info *file_info = sync_file_info(fd);
+  if (!file_info) {
+    // Driver without file info support; a zero-timeout wait never sleeps either.
+    return SyncWait(fd, 0);
+  }
+
+  int status = file_info->status;
+  sync_file_info_free(file_info);
+
+  return (status > 0) ? 0 : -ETIME;
+}
+
+int HWCBufferSyncHandler::SyncWaitBatch(const std::vector<int> &fds, int timeout) {
+  // Weed out already signaled fences without blocking, then wait on the rest with one
+  // poll per wakeup and a deadline shared across the whole group.
+  std::vector<struct pollfd> poll_fds;
+  poll_fds.reserve(fds.size());
+  for (const int &fd : fds) {
+    if (fd < 0 || SyncTryWait(fd) == 0) {
+      continue;
+    }
+    poll_fds.push_back({fd, POLLIN, 0});
+  }
+
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  int64_t deadline_ms = (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000) + timeout;
+
+  size_t remaining = poll_fds.size();
+  while (remaining) {
+    int wait_ms = -1;
+    if (timeout >= 0) {
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      int64_t now_ms = (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+      wait_ms = (deadline_ms > now_ms) ? INT32(deadline_ms - now_ms) : 0;
+    }
+
+    int ret = poll(poll_fds.data(), poll_fds.size(), wait_ms);
+    if (ret < 0) {
+      if (errno == EINTR || errno == EAGAIN) {
+        continue;
+      }
+      DLOGW("poll failed err = %d : %s", errno, strerror(errno));
+      return -errno;
+    }
+    if (ret == 0) {
+      DLOGW("Batched sync wait timed out, %zu of %zu fences pending, timeout = %d ms",
+            remaining, fds.size(), timeout);
+      return -ETIME;
+    }
+
+    for (auto &poll_fd : poll_fds) {
+      if (poll_fd.fd < 0) {
+        continue;  // already retired from the group
+      }
+      if (poll_fd.revents & (POLLERR | POLLNVAL)) {
+        DLOGW("poll error on fd = %d, revents = 0x%x", poll_fd.fd, poll_fd.revents);
+        return -EINVAL;
+      }
+      if (poll_fd.revents & POLLIN) {
+        poll_fd.fd = ~poll_fd.fd;  // negative fds are skipped by poll
+        remaining--;
+      }
+    }
+  }
+
+  return 0;
+}
+
+uint64_t HWCBufferSyncHandler::SyncGetSignalTime(int fd) {
+  if (fd < 0) {
+    return 0;
+  }
+
+  struct sync_file_info *file_info = sync_file_info(fd);
+  if (!file_info) {
+    return 0;
+  }
+
+  uint64_t signal_time = 0;
+  if (file_info->status > 0) {
+    // A merged fence signals when its last child does.
+    struct sync_fence_info *fence_info = sync_get_fence_info(file_info);
+    for (size_t i = 0; fence_info && i < file_info->num_fences; i++) {
+      signal_time = std::max(signal_time, fence_info[i].timestamp_ns);
+    }
+  }
+  sync_file_info_free(file_info);
+
+  return signal_time;
+}
+
 int HWCBufferSyncHandler::SyncMerge(int fd1, int fd2, int *merged_fd) {
   // Caller owns fds, hence, if
   //  one of the fence fd is invalid, create dup of valid fd and set to merged fd.
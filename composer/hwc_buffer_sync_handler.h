@@ -46,6 +46,9 @@ namespace sdm {
 class HWCBufferSyncHandler : public BufferSyncHandler {
  public:
   virtual int SyncWait(int fd, int timeout);
+  virtual int SyncWaitBatch(const std::vector<int> &fds, int timeout);
+  virtual int SyncTryWait(int fd);
+  virtual uint64_t SyncGetSignalTime(int fd);
   virtual int SyncMerge(int fd1, int fd2, int *merged_fd);
   virtual void GetSyncInfo(int fd, std::ostringstream *os);
 
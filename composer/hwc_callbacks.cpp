@@ -34,7 +34,11 @@
  * SPDX-License-Identifier: BSD-3-Clause-Clear
  */
 
+#include <time.h>
+
+#include <chrono>
 #include <thread>
+#include <vector>
 
 #include <utils/constants.h>
 #include <utils/debug.h>
@@ -76,7 +80,21 @@ HWC3::Error HWCCallbacks::Hotplug(Display display, bool state) {
   return HWC3::Error::None;
 }
 
-HWC3::Error HWCCallbacks::Refresh(Display display) {
+namespace {
+
+// A deferrable vote with no explicit deadline forces a frame after this long without one.
+constexpr int64_t kDefaultRefreshDeadlineNs = 100000000;  // 100 ms
+
+int64_t RefreshClockNs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+}
+
+}  // namespace
+
+HWC3::Error HWCCallbacks::Refresh(Display display, RefreshPriority priority,
+                                  int64_t deadline_ns) {
   SCOPE_LOCK(refresh_lock_);
   // Do not lock, will cause hotplug deadlock
   DTRACE_SCOPED();
@@ -85,24 +103,142 @@ HWC3::Error HWCCallbacks::Refresh(Display display) {
     return HWC3::Error::NoResources;
   }
 
+  {
+    std::lock_guard<std::mutex> guard(refresh_vote_mutex_);
+    if (refresh_queued_.test(UINT32(display))) {
+      // A refresh callback for this display is queued but not delivered yet; its frame will
+      // pick up whatever state this vote just changed.
+      return HWC3::Error::None;
+    }
+    if (priority == kRefreshDeferrable) {
+      deferred_refresh_.set(UINT32(display));
+      deferred_deadline_ns_[display] =
+          RefreshClockNs() + (deadline_ns > 0 ? deadline_ns : kDefaultRefreshDeadlineNs);
+      has_deferred_refresh_.store(true, std::memory_order_relaxed);
+      return HWC3::Error::None;
+    }
+    refresh_queued_.set(UINT32(display));
+    deferred_refresh_.reset(UINT32(display));  // the forced frame satisfies deferred votes
+  }
+
   HWCCallbackParams param{CALLBACK_REFRESH, static_cast<long>(display)};
   callback_queue_.push(param);
 
   return HWC3::Error::None;
 }
 
+void HWCCallbacks::OnFrameCommitted(Display display) {
+  if (!has_deferred_refresh_.load(std::memory_order_relaxed)) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(refresh_vote_mutex_);
+  deferred_refresh_.reset(UINT32(display));
+  if (deferred_refresh_.none()) {
+    has_deferred_refresh_.store(false, std::memory_order_relaxed);
+  }
+}
+
+void HWCCallbacks::FlushDeferredRefresh(int64_t now_ns) {
+  std::lock_guard<std::mutex> guard(refresh_vote_mutex_);
+  for (uint32_t i = 0; i < kNumDisplays; i++) {
+    if (!deferred_refresh_.test(i) || now_ns < deferred_deadline_ns_[i]) {
+      continue;
+    }
+    // Deadline passed without a natural frame; force one now.
+    deferred_refresh_.reset(i);
+    refresh_queued_.set(i);
+    HWCCallbackParams param{CALLBACK_REFRESH, static_cast<long>(i)};
+    callback_queue_.push(param);
+  }
+  if (deferred_refresh_.none()) {
+    has_deferred_refresh_.store(false, std::memory_order_relaxed);
+  }
+}
+
 HWC3::Error HWCCallbacks::Vsync(Display display, int64_t timestamp, uint32_t period) {
-  SCOPE_LOCK(vsync_lock_);
-  // Do not lock, may cause hotplug deadlock
   DTRACE_SCOPED();
+  // Lock-free dispatch: Register() publishes callback_data_ before the function pointer,
+  // so one acquire load here is enough and the per-frame path never contends with
+  // registration or a slow hotplug callback.
+  onVsync_func_t *vsync = vsync_.load(std::memory_order_acquire);
   // If client has not registered vsync, drop it
-  if (!vsync_) {
+  if (!vsync) {
     return HWC3::Error::NoResources;
   }
-  (*vsync_)(callback_data_, static_cast<long>(display), timestamp, static_cast<int>(period));
+  if (has_deferred_refresh_.load(std::memory_order_relaxed)) {
+    // Cheap periodic tick for deferred refresh deadlines; one relaxed load otherwise.
+    FlushDeferredRefresh(timestamp);
+  }
+  if (vsync_coalesce_window_ns_.load(std::memory_order_relaxed) > 0) {
+    // Hand the event to the dispatch thread so vsyncs of epoch-aligned displays go out
+    // from a single wakeup instead of one per display.
+    {
+      std::lock_guard<std::mutex> lock(vsync_batch_mutex_);
+      if (vsync_batch_running_) {
+        pending_vsyncs_.push_back({display, timestamp, period});
+        vsync_batch_cv_.notify_one();
+        return HWC3::Error::None;
+      }
+    }
+    // Dispatch thread already stopped; fall through to direct delivery.
+  }
+  (*vsync)(callback_data_.load(std::memory_order_relaxed), static_cast<long>(display), timestamp,
+           static_cast<int>(period));
   return HWC3::Error::None;
 }
 
+void HWCCallbacks::SetVsyncCoalesceWindow(uint32_t window_ns) {
+  std::unique_lock<std::mutex> lock(vsync_batch_mutex_);
+  vsync_coalesce_window_ns_.store(window_ns, std::memory_order_relaxed);
+  if (window_ns && !vsync_batch_thread_.joinable()) {
+    vsync_batch_running_ = true;
+    vsync_batch_thread_ = std::thread(&HWCCallbacks::VsyncDispatchThread, this);
+  } else if (!window_ns && vsync_batch_thread_.joinable()) {
+    vsync_batch_running_ = false;
+    vsync_batch_cv_.notify_one();
+    lock.unlock();
+    vsync_batch_thread_.join();
+  }
+}
+
+void HWCCallbacks::VsyncDispatchThread() {
+  std::vector<PendingVsync> batch;
+  std::unique_lock<std::mutex> lock(vsync_batch_mutex_);
+  while (vsync_batch_running_) {
+    vsync_batch_cv_.wait(lock, [this] { return !pending_vsyncs_.empty() || !vsync_batch_running_; });
+    if (!vsync_batch_running_) {
+      break;
+    }
+
+    // First vsync of the epoch arrived; give peer displays up to the window to land so
+    // their events ride the same wakeup. Late vsyncs simply start the next batch.
+    int64_t window_ns = vsync_coalesce_window_ns_.load(std::memory_order_relaxed);
+    if (window_ns > 0) {
+      vsync_batch_cv_.wait_for(lock, std::chrono::nanoseconds(window_ns),
+                               [this] { return !vsync_batch_running_; });
+    }
+
+    batch.swap(pending_vsyncs_);
+    lock.unlock();
+
+    onVsync_func_t *vsync = vsync_.load(std::memory_order_acquire);
+    if (vsync) {
+      for (auto &event : batch) {
+        (*vsync)(callback_data_.load(std::memory_order_relaxed),
+                 static_cast<long>(event.display), event.timestamp,
+                 static_cast<int>(event.period));
+      }
+    }
+    batch.clear();
+    lock.lock();
+  }
+}
+
+HWCCallbacks::~HWCCallbacks() {
+  SetVsyncCoalesceWindow(0);
+}
+
 HWC3::Error HWCCallbacks::VsyncIdle(Display display) {
   SCOPE_LOCK(vsync_idle_lock_);
   // Do not lock, may cause hotplug deadlock
@@ -139,37 +275,43 @@ HWC3::Error HWCCallbacks::SeamlessPossible(Display display) {
 }
 
 HWC3::Error HWCCallbacks::Register(CallbackCommand descriptor, void *callback_data, void *pointer) {
+  // In every recognized case, store the data before the callback pointer becomes visible to
+  // lock-free readers; an unrecognized descriptor must leave both untouched.
   switch (descriptor) {
     case CALLBACK_HOTPLUG: {
       SCOPE_LOCK(hotplug_lock_);
+      callback_data_.store(callback_data, std::memory_order_release);
       hotplug_ = static_cast<onHotplug_func_t *>(pointer);
       client_connected_ = true;
       hotplug_lock_.Broadcast();
     } break;
     case CALLBACK_REFRESH: {
       SCOPE_LOCK(refresh_lock_);
+      callback_data_.store(callback_data, std::memory_order_release);
       refresh_ = static_cast<onRefresh_func_t *>(pointer);
     } break;
-    case CALLBACK_VSYNC: {
-      SCOPE_LOCK(vsync_lock_);
-      vsync_ = static_cast<onVsync_func_t *>(pointer);
-    } break;
+    case CALLBACK_VSYNC:
+      callback_data_.store(callback_data, std::memory_order_release);
+      vsync_.store(static_cast<onVsync_func_t *>(pointer), std::memory_order_release);
+      break;
     case CALLBACK_VSYNC_IDLE: {
       SCOPE_LOCK(vsync_idle_lock_);
+      callback_data_.store(callback_data, std::memory_order_release);
       vsync_idle_ = static_cast<onVsyncIdle_func_t *>(pointer);
     } break;
     case CALLBACK_VSYNC_PERIOD_TIMING_CHANGED: {
       SCOPE_LOCK(vsync_changed_lock_);
+      callback_data_.store(callback_data, std::memory_order_release);
       vsync_changed_ = static_cast<onVsyncPeriodTimingChanged_func_t *>(pointer);
     } break;
     case CALLBACK_SEAMLESS_POSSIBLE: {
       SCOPE_LOCK(seamless_possible_lock_);
+      callback_data_.store(callback_data, std::memory_order_release);
       seamless_possible_ = static_cast<onSeamlessPossible_func_t *>(pointer);
     } break;
     default:
       return HWC3::Error::BadParameter;
   }
-  callback_data_ = callback_data;
 
   // handle Register callback events in single callback thread
   if (!callback_thread_.joinable()) {
@@ -199,6 +341,11 @@ HWC3::Error HWCCallbacks::PerformHWCCallback() {
     switch (param.cmd) {
       case CALLBACK_REFRESH: {
         SCOPE_LOCK(refresh_lock_);
+        {
+          // Callback is about to be delivered; later votes need a fresh one.
+          std::lock_guard<std::mutex> guard(refresh_vote_mutex_);
+          refresh_queued_.reset(param.display);
+        }
         if (refresh_) {
           (*refresh_)(callback_data_, param.display);
           pending_refresh_.reset(param.display);
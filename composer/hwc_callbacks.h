@@ -37,9 +37,11 @@
 #ifndef __HWC_CALLBACKS_H__
 #define __HWC_CALLBACKS_H__
 
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <vector>
 #include <utils/locker.h>
 #include "hwc_common.h"
 
@@ -96,14 +98,28 @@ class HWCCallbacks {
   static const int kNumDisplays =
       1 + kNumBuiltIn + kNumPluggable + kNumVirtual + 1 + kNumBuiltIn + kNumPluggable;
 
+  // Priority of a refresh vote. Forced votes must produce a frame (content or config
+  // changed); deferrable votes (histogram/stats reconfigure) ride along with the next
+  // natural frame and only force one themselves if none arrives before their deadline.
+  enum RefreshPriority {
+    kRefreshForced = 0,
+    kRefreshDeferrable,
+  };
+
   HWC3::Error Hotplug(Display display, bool state);
-  HWC3::Error Refresh(Display display);
+  HWC3::Error Refresh(Display display) { return Refresh(display, kRefreshForced, 0); }
+  HWC3::Error Refresh(Display display, RefreshPriority priority, int64_t deadline_ns);
+  // A frame got presented on this display; deferrable votes it satisfies are dropped.
+  void OnFrameCommitted(Display display);
   HWC3::Error Vsync(Display display, int64_t timestamp, uint32_t period);
   HWC3::Error VsyncIdle(Display display);
   HWC3::Error VsyncPeriodTimingChanged(Display display,
                                        VsyncPeriodChangeTimeline *updated_timeline);
   HWC3::Error SeamlessPossible(Display display);
   HWC3::Error Register(CallbackCommand descriptor, void *callback_data, void *pointer);
+  // Coalesce vsyncs from displays sharing an epoch: events arriving within window_ns of the
+  // first are delivered consecutively from one dispatcher wakeup. 0 disables (default).
+  void SetVsyncCoalesceWindow(uint32_t window_ns);
   void UpdateVsyncSource(Display from) { vsync_source_ = from; }
   Display GetVsyncSource() { return vsync_source_; }
 
@@ -115,6 +131,7 @@ class HWCCallbacks {
     return client_connected_;
   }
   HWC3::Error PerformHWCCallback();
+  ~HWCCallbacks();
 
  private:
   struct HWCCallbackParams {
@@ -123,11 +140,15 @@ class HWCCallbacks {
     int32_t state;
   };
 
-  void *callback_data_ = nullptr;
+  // callback_data_ and vsync_ are atomics so Vsync() can dispatch with plain loads;
+  // Register() publishes the data before the function pointer, so a reader that sees
+  // the new pointer also sees its data. Everything else stays behind the per-callback
+  // lockers.
+  std::atomic<void *> callback_data_ {nullptr};
 
   onHotplug_func_t *hotplug_ = nullptr;
   onRefresh_func_t *refresh_ = nullptr;
-  onVsync_func_t *vsync_ = nullptr;
+  std::atomic<onVsync_func_t *> vsync_ {nullptr};
   onSeamlessPossible_func_t *seamless_possible_ = nullptr;
   onVsyncPeriodTimingChanged_func_t *vsync_changed_ = nullptr;
   onVsyncIdle_func_t *vsync_idle_ = nullptr;
@@ -137,7 +158,6 @@ class HWCCallbacks {
 
   Locker hotplug_lock_;
   Locker refresh_lock_;
-  Locker vsync_lock_;
   Locker vsync_idle_lock_;
   Locker vsync_changed_lock_;
   Locker seamless_possible_lock_;
@@ -145,6 +165,31 @@ class HWCCallbacks {
   std::thread callback_thread_;
   CallbackQueue<HWCCallbackParams> callback_queue_;
   bool callback_running_ = false;
+
+  // Vsync coalescing state; see SetVsyncCoalesceWindow().
+  struct PendingVsync {
+    Display display;
+    int64_t timestamp;
+    uint32_t period;
+  };
+  // Refresh vote aggregation. A forced vote is dropped while an undelivered refresh callback
+  // for the same display sits in the queue - that callback's frame will validate whatever
+  // state the voter just set. Deferrable votes wait in deferred_refresh_ until a natural
+  // frame clears them or a vsync tick finds their deadline expired.
+  void FlushDeferredRefresh(int64_t now_ns);
+  std::mutex refresh_vote_mutex_;
+  std::bitset<kNumDisplays> refresh_queued_;    // GUARDED_BY(refresh_vote_mutex_)
+  std::bitset<kNumDisplays> deferred_refresh_;  // GUARDED_BY(refresh_vote_mutex_)
+  int64_t deferred_deadline_ns_[kNumDisplays] = {};
+  std::atomic<bool> has_deferred_refresh_ {false};
+
+  void VsyncDispatchThread();
+  std::mutex vsync_batch_mutex_;
+  std::condition_variable vsync_batch_cv_;
+  std::vector<PendingVsync> pending_vsyncs_;  // GUARDED_BY(vsync_batch_mutex_)
+  std::thread vsync_batch_thread_;
+  bool vsync_batch_running_ = false;          // GUARDED_BY(vsync_batch_mutex_)
+  std::atomic<int64_t> vsync_coalesce_window_ns_ {0};
 };
 
 }  // namespace sdm
@@ -159,6 +159,7 @@ void HWCColorManager::DestroyColorManager() {
   if (qdcm_diag_deinit_) {
     qdcm_diag_deinit_();
   }
+  FreeCwbPool();
   delete this;
 }
 
@@ -231,7 +232,7 @@ int HWCColorManager::SetFrameCapture(void *params, bool enable, HWCDisplay *hwc_
   PPFrameCaptureData *frame_capture_data = reinterpret_cast<PPFrameCaptureData *>(params);
 
   if (enable) {
-    std::memset(&buffer_info, 0x00, sizeof(buffer_info));
+    BufferConfig buffer_config = {};
 
     CwbTapPoint cwb_tappoint = CwbTapPoint::kLmTapPoint;
     // frame_capture_data->input_params.flags == 0x0 => DSPP tappoint
@@ -261,58 +262,47 @@ int HWCColorManager::SetFrameCapture(void *params, bool enable, HWCDisplay *hwc_
     cwb_config.cwb_roi.bottom =
         cwb_config.cwb_roi.top + FLOAT(frame_capture_data->input_params.rect.height);
 
-    ret = hwc_display->GetCwbBufferResolution(&cwb_config, &buffer_info.buffer_config.width,
-                                              &buffer_info.buffer_config.height);
+    ret = hwc_display->GetCwbBufferResolution(&cwb_config, &buffer_config.width,
+                                              &buffer_config.height);
     if (ret != 0) {
       DLOGE("Buffer Resolution setting failed. ret: %d", ret);
       return -EINVAL;
     }
 
     if (frame_capture_data->input_params.out_pix_format == PP_PIXEL_FORMAT_RGB_888) {
-      buffer_info.buffer_config.format = kFormatRGB888;
+      buffer_config.format = kFormatRGB888;
     } else if (frame_capture_data->input_params.out_pix_format == PP_PIXEL_FORMAT_RGB_2101010) {
-      buffer_info.buffer_config.format = kFormatRGBA1010102;
+      buffer_config.format = kFormatRGBA1010102;
     } else {
       DLOGE("Pixel-format: %d NOT support.", frame_capture_data->input_params.out_pix_format);
       return -EFAULT;
     }
 
-    buffer_info.buffer_config.buffer_count = 1;
-    buffer_info.alloc_buffer_info.fd = -1;
-    buffer_info.alloc_buffer_info.stride = 0;
-    buffer_info.alloc_buffer_info.size = 0;
+    buffer_config.buffer_count = 1;
 
-    ret = buffer_allocator_->AllocateBuffer(&buffer_info);
-    if (ret != 0) {
-      DLOGE("Buffer allocation failed. ret: %d", ret);
+    CwbPoolEntry *entry = AcquireCwbBuffer(buffer_config);
+    if (!entry) {
+      frame_capture_data->buffer = NULL;
       return -ENOMEM;
-    } else {
-      void *buffer = mmap(NULL, buffer_info.alloc_buffer_info.size, PROT_READ | PROT_WRITE,
-                          MAP_SHARED, buffer_info.alloc_buffer_info.fd, 0);
+    }
 
-      if (buffer == MAP_FAILED) {
-        DLOGE("mmap failed. err = %d", errno);
-        frame_capture_data->buffer = NULL;
-        ret = buffer_allocator_->FreeBuffer(&buffer_info);
-        return -EFAULT;
-      } else {
-        frame_capture_data->buffer = reinterpret_cast<uint8_t *>(buffer);
-        frame_capture_data->buffer_stride = buffer_info.alloc_buffer_info.stride;
-        frame_capture_data->buffer_size = buffer_info.alloc_buffer_info.size;
-      }
+    frame_capture_data->buffer = entry->mapped;
+    frame_capture_data->buffer_stride = entry->buffer_info.alloc_buffer_info.stride;
+    frame_capture_data->buffer_size = entry->buffer_info.alloc_buffer_info.size;
 
-      ret = hwc_display->FrameCaptureAsync(buffer_info, cwb_config);
-      if (ret < 0) {
-        DLOGE("FrameCaptureAsync failed. ret = %d", ret);
-      }
+    ret = hwc_display->FrameCaptureAsync(entry->buffer_info, cwb_config);
+    if (ret < 0) {
+      DLOGE("FrameCaptureAsync failed. ret = %d", ret);
+      entry->in_use = false;
     }
   } else {
     ret = hwc_display->GetFrameCaptureStatus();
     if (!ret) {
-      if (frame_capture_data->buffer != NULL) {
-        if (munmap(frame_capture_data->buffer, buffer_info.alloc_buffer_info.size) != 0) {
-          DLOGE("munmap failed. err = %d", errno);
-        }
+      // The capture release fence has signaled by the time the status turns
+      // zero, so the buffer can go back to the pool for the next capture.
+      CwbPoolEntry *entry = FindCwbBuffer(frame_capture_data->buffer);
+      if (entry) {
+        entry->in_use = false;
       }
 
       if (frame_capture_data->input_params.dither_payload) {
@@ -322,13 +312,7 @@ int HWCColorManager::SetFrameCapture(void *params, bool enable, HWCDisplay *hwc_
       }
       frame_capture_data->input_params.dither_flags = 0x0;
 
-      if (buffer_allocator_ != NULL) {
-        std::memset(frame_capture_data, 0x00, sizeof(PPFrameCaptureData));
-        ret = buffer_allocator_->FreeBuffer(&buffer_info);
-        if (ret != 0) {
-          DLOGE("FreeBuffer failed. ret = %d", ret);
-        }
-      }
+      std::memset(frame_capture_data, 0x00, sizeof(PPFrameCaptureData));
     } else {
       DLOGE("GetFrameCaptureStatus failed. ret = %d", ret);
     }
@@ -336,6 +320,93 @@ int HWCColorManager::SetFrameCapture(void *params, bool enable, HWCDisplay *hwc_
   return ret;
 }
 
+HWCColorManager::CwbPoolEntry *HWCColorManager::AcquireCwbBuffer(const BufferConfig &config) {
+  // Reuse a free buffer that already matches the requested geometry; during
+  // steady-state capture every request lands here without an allocation.
+  for (auto &entry : cwb_pool_) {
+    if (!entry.in_use && entry.mapped && (entry.buffer_info.buffer_config.width == config.width) &&
+        (entry.buffer_info.buffer_config.height == config.height) &&
+        (entry.buffer_info.buffer_config.format == config.format)) {
+      entry.in_use = true;
+      return &entry;
+    }
+  }
+
+  // Otherwise take a free slot, dropping any stale buffer of a different
+  // geometry it may still hold.
+  for (auto &entry : cwb_pool_) {
+    if (entry.in_use) {
+      continue;
+    }
+
+    if (entry.mapped) {
+      if (munmap(entry.mapped, entry.buffer_info.alloc_buffer_info.size) != 0) {
+        DLOGE("munmap failed. err = %d", errno);
+      }
+      if (buffer_allocator_->FreeBuffer(&entry.buffer_info) != 0) {
+        DLOGE("FreeBuffer failed.");
+      }
+      entry = {};
+    }
+
+    entry.buffer_info.buffer_config = config;
+    entry.buffer_info.alloc_buffer_info.fd = -1;
+    entry.buffer_info.alloc_buffer_info.stride = 0;
+    entry.buffer_info.alloc_buffer_info.size = 0;
+
+    int ret = buffer_allocator_->AllocateBuffer(&entry.buffer_info);
+    if (ret != 0) {
+      DLOGE("Buffer allocation failed. ret: %d", ret);
+      return nullptr;
+    }
+
+    void *buffer = mmap(NULL, entry.buffer_info.alloc_buffer_info.size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, entry.buffer_info.alloc_buffer_info.fd, 0);
+    if (buffer == MAP_FAILED) {
+      DLOGE("mmap failed. err = %d", errno);
+      buffer_allocator_->FreeBuffer(&entry.buffer_info);
+      entry = {};
+      return nullptr;
+    }
+
+    entry.mapped = reinterpret_cast<uint8_t *>(buffer);
+    entry.in_use = true;
+    return &entry;
+  }
+
+  DLOGE("All %d CWB pool buffers are in use.", kCwbPoolSize);
+  return nullptr;
+}
+
+HWCColorManager::CwbPoolEntry *HWCColorManager::FindCwbBuffer(const uint8_t *mapped) {
+  if (!mapped) {
+    return nullptr;
+  }
+
+  for (auto &entry : cwb_pool_) {
+    if (entry.mapped == mapped) {
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+void HWCColorManager::FreeCwbPool() {
+  for (auto &entry : cwb_pool_) {
+    if (!entry.mapped) {
+      continue;
+    }
+    if (munmap(entry.mapped, entry.buffer_info.alloc_buffer_info.size) != 0) {
+      DLOGE("munmap failed. err = %d", errno);
+    }
+    if (buffer_allocator_->FreeBuffer(&entry.buffer_info) != 0) {
+      DLOGE("FreeBuffer failed.");
+    }
+    entry = {};
+  }
+}
+
 int HWCColorManager::SetHWDetailedEnhancerConfig(void *params, HWCDisplay *hwc_display) {
   int err = 0;
   if (hwc_display) {
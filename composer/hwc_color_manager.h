@@ -131,6 +131,21 @@ class HWCColorManager {
   static uint32_t Get8BitsARGBColorValue(const PPColorFillParams &params);
 
  private:
+  // Rotating CWB output buffers reused across captures, so steady-state
+  // capture runs without per-frame gralloc allocations. An entry is recycled
+  // once the capture release fence has signaled and the client read it out.
+  struct CwbPoolEntry {
+    BufferInfo buffer_info = {};
+    uint8_t *mapped = nullptr;
+    bool in_use = false;
+  };
+
+  CwbPoolEntry *AcquireCwbBuffer(const BufferConfig &config);
+  CwbPoolEntry *FindCwbBuffer(const uint8_t *mapped);
+  void FreeCwbPool();
+
+  static const uint32_t kCwbPoolSize = 3;
+
   DynLib color_apis_lib_;
   DynLib diag_client_lib_;
   void *color_apis_ = NULL;
@@ -140,7 +155,7 @@ class HWCColorManager {
 
   PPColorFillParams solid_fill_params_;
   HWCBufferAllocator *buffer_allocator_ = NULL;
-  BufferInfo buffer_info;
+  CwbPoolEntry cwb_pool_[kCwbPoolSize];
   Locker locker_;
 };
 
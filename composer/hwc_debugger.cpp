@@ -37,6 +37,9 @@
 #include <utils/constants.h>
 #include <cutils/properties.h>
 #include <display_properties.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
 
 #include "hwc_debugger.h"
 
@@ -244,6 +247,10 @@ void HWCDebugHandler::Verbose(const char *fmt, ...) {
 
 void HWCDebugHandler::BeginTrace(const char *class_name, const char *function_name,
                                  const char *custom_string) {
+  if (HWCAllocAudit::Enabled()) {
+    HWCAllocAudit::OnScopeBegin(function_name);
+  }
+
   if (atrace_is_tag_enabled(ATRACE_TAG)) {
     char name[PATH_MAX] = {0};
     snprintf(name, sizeof(name), "%s::%s::%s", class_name, function_name, custom_string);
@@ -252,6 +259,10 @@ void HWCDebugHandler::BeginTrace(const char *class_name, const char *function_na
 }
 
 void HWCDebugHandler::EndTrace() {
+  if (HWCAllocAudit::Enabled()) {
+    HWCAllocAudit::OnScopeEnd();
+  }
+
   atrace_end(ATRACE_TAG);
 }
 
@@ -281,4 +292,332 @@ int HWCDebugHandler::GetProperty(const char *property_name, char *value) {
   return kErrorNotSupported;
 }
 
+static const char *kFrameLatencyPhaseNames[kPhaseCount] = {"validate", "commit", "post_commit"};
+
+uint32_t HWCFrameLatencyStats::GetBucket(int64_t duration_ns) {
+  uint64_t duration_us = UINT64(duration_ns) / 1000;
+  uint32_t bucket = 0;
+  while ((bucket < (kNumBuckets - 1)) && (duration_us >= (UINT64(1) << (bucket + 1)))) {
+    bucket++;
+  }
+
+  return bucket;
+}
+
+void HWCFrameLatencyStats::RecordPhase(FrameLatencyPhase phase, int64_t duration_ns) {
+  if (phase < 0 || phase >= kPhaseCount || duration_ns < 0) {
+    return;
+  }
+
+  buckets_[phase][GetBucket(duration_ns)].fetch_add(1, std::memory_order_relaxed);
+  total_ns_[phase].fetch_add(UINT64(duration_ns), std::memory_order_relaxed);
+
+  uint64_t prev_max = max_ns_[phase].load(std::memory_order_relaxed);
+  while (UINT64(duration_ns) > prev_max &&
+         !max_ns_[phase].compare_exchange_weak(prev_max, UINT64(duration_ns),
+                                               std::memory_order_relaxed)) {
+  }
+
+  // Validate opens a new frame slot in the timeline ring; later phases fill the same slot.
+  uint64_t frame = frame_index_.load(std::memory_order_relaxed);
+  if (phase == kPhaseValidate) {
+    frame++;
+    frame_index_.store(frame, std::memory_order_relaxed);
+    for (uint32_t i = 0; i < kPhaseCount; i++) {
+      frame_ring_[frame % kRingSize][i].store(0, std::memory_order_relaxed);
+    }
+  }
+  frame_ring_[frame % kRingSize][phase].store(UINT64(duration_ns), std::memory_order_relaxed);
+}
+
+uint64_t HWCFrameLatencyStats::PercentileUs(const uint64_t *buckets, uint64_t count,
+                                            uint32_t percent) {
+  if (!count) {
+    return 0;
+  }
+
+  uint64_t target = ((count * percent) + 99) / 100;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < kNumBuckets; i++) {
+    seen += buckets[i];
+    if (seen >= target) {
+      // Report the bucket's upper bound in microseconds.
+      return UINT64(1) << (i + 1);
+    }
+  }
+
+  return UINT64(1) << kNumBuckets;
+}
+
+void HWCFrameLatencyStats::Dump(std::ostringstream *os) {
+  *os << "\n-------Frame Latency (us)------\n";
+  *os << "phase        frames   avg    p50    p95    p99    max\n";
+  for (uint32_t phase = 0; phase < kPhaseCount; phase++) {
+    uint64_t buckets[kNumBuckets];
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < kNumBuckets; i++) {
+      buckets[i] = buckets_[phase][i].load(std::memory_order_relaxed);
+      count += buckets[i];
+    }
+
+    uint64_t total_us = total_ns_[phase].load(std::memory_order_relaxed) / 1000;
+    *os << std::left << std::setw(13) << kFrameLatencyPhaseNames[phase] << std::right;
+    *os << std::setw(6) << count;
+    *os << std::setw(7) << (count ? (total_us / count) : 0);
+    *os << std::setw(7) << PercentileUs(buckets, count, 50);
+    *os << std::setw(7) << PercentileUs(buckets, count, 95);
+    *os << std::setw(7) << PercentileUs(buckets, count, 99);
+    *os << std::setw(7) << (max_ns_[phase].load(std::memory_order_relaxed) / 1000) << "\n";
+  }
+
+  *os << "last frames (validate/commit/post_commit):";
+  uint64_t frame = frame_index_.load(std::memory_order_relaxed);
+  uint64_t frames_to_dump = std::min(frame, UINT64(kRingSize));
+  for (uint64_t i = 0; i < frames_to_dump; i++) {
+    uint32_t slot = UINT32((frame - i) % kRingSize);
+    *os << " ";
+    for (uint32_t phase = 0; phase < kPhaseCount; phase++) {
+      *os << frame_ring_[slot][phase].load(std::memory_order_relaxed) / 1000;
+      *os << ((phase < (kPhaseCount - 1)) ? "/" : "");
+    }
+  }
+  *os << "\n";
+}
+
+void HWCFrameLatencyStats::Reset() {
+  for (uint32_t phase = 0; phase < kPhaseCount; phase++) {
+    for (uint32_t i = 0; i < kNumBuckets; i++) {
+      buckets_[phase][i].store(0, std::memory_order_relaxed);
+    }
+    total_ns_[phase].store(0, std::memory_order_relaxed);
+    max_ns_[phase].store(0, std::memory_order_relaxed);
+  }
+}
+
+static const char *kFrameDropCauseNames[kDropCauseCount] = {
+  "gpu_ahead", "commit_overrun", "validate_overrun", "strategy_fallback", "scheduling",
+};
+
+void HWCFrameDropClassifier::RecordFrame(const FrameSignals &signals) {
+  uint64_t frame = total_frames_.fetch_add(1, std::memory_order_relaxed) + 1;
+  if (!signals.period_ns || !signals.frame_gap_ns) {
+    return;
+  }
+
+  if (signals.frame_gap_ns <= (signals.period_ns + (signals.period_ns / 2))) {
+    return;
+  }
+
+  // First matching cause wins; display-side overruns outrank client-side suspicion.
+  uint32_t cause = kDropScheduling;
+  if (signals.acquire_pending) {
+    cause = kDropGpuAhead;
+  } else if (signals.commit_ns > signals.period_ns) {
+    cause = kDropCommitOverrun;
+  } else if (signals.validate_ns > signals.period_ns) {
+    cause = kDropValidateOverrun;
+  } else if (signals.gpu_fallback) {
+    cause = kDropStrategyFallback;
+  }
+
+  late_frames_.fetch_add(1, std::memory_order_relaxed);
+  cause_counts_[cause].fetch_add(1, std::memory_order_relaxed);
+
+  uint32_t slot = UINT32(event_index_.fetch_add(1, std::memory_order_relaxed) % kEventRingSize);
+  event_frame_[slot].store(frame, std::memory_order_relaxed);
+  event_cause_[slot].store(cause, std::memory_order_relaxed);
+  event_gap_us_[slot].store(INT32(signals.frame_gap_ns / 1000), std::memory_order_relaxed);
+  event_validate_us_[slot].store(INT32(signals.validate_ns / 1000), std::memory_order_relaxed);
+  event_commit_us_[slot].store(INT32(signals.commit_ns / 1000), std::memory_order_relaxed);
+}
+
+uint64_t HWCFrameDropClassifier::GetCauseCount(uint32_t cause) {
+  return (cause < kDropCauseCount) ? cause_counts_[cause].load(std::memory_order_relaxed) : 0;
+}
+
+void HWCFrameDropClassifier::Dump(std::ostringstream *os) {
+  uint64_t total = total_frames_.load(std::memory_order_relaxed);
+  uint64_t late = late_frames_.load(std::memory_order_relaxed);
+  *os << "\n--------Frame Drop Causes------\n";
+  *os << "late frames: " << late << " of " << total << "\n";
+  for (uint32_t cause = 0; cause < kDropCauseCount; cause++) {
+    *os << "  " << std::left << std::setw(18) << kFrameDropCauseNames[cause] << std::right
+        << cause_counts_[cause].load(std::memory_order_relaxed) << "\n";
+  }
+
+  uint64_t events = event_index_.load(std::memory_order_relaxed);
+  uint64_t events_to_dump = std::min(events, UINT64(kEventRingSize));
+  if (events_to_dump) {
+    *os << "recent late frames (frame cause gap/validate/commit us, newest first):\n";
+  }
+  for (uint64_t i = 0; i < events_to_dump; i++) {
+    uint32_t slot = UINT32((events - 1 - i) % kEventRingSize);
+    uint32_t cause = event_cause_[slot].load(std::memory_order_relaxed);
+    *os << "  #" << event_frame_[slot].load(std::memory_order_relaxed);
+    *os << " " << kFrameDropCauseNames[cause % kDropCauseCount];
+    *os << " " << event_gap_us_[slot].load(std::memory_order_relaxed);
+    *os << "/" << event_validate_us_[slot].load(std::memory_order_relaxed);
+    *os << "/" << event_commit_us_[slot].load(std::memory_order_relaxed) << "\n";
+  }
+}
+
+std::atomic<bool> HWCAllocAudit::enabled_ = {};
+std::atomic<int> HWCAllocAudit::budget_ = {};
+HWCAllocAudit::ScopeSlot HWCAllocAudit::slots_[kMaxScopes];
+
+// Per-thread scope stack. Slot index and allocation count of each live scope; trivially
+// destructible so access from operator new during thread teardown stays safe.
+struct AllocAuditThreadState {
+  uint32_t depth = 0;
+  int32_t slot[HWCAllocAudit::kMaxDepth];
+  uint64_t instance_allocs[HWCAllocAudit::kMaxDepth];
+};
+
+static thread_local AllocAuditThreadState g_alloc_audit_tls;
+
+void HWCAllocAudit::Enable(int budget) {
+  budget_.store(budget, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_release);
+}
+
+int HWCAllocAudit::FindSlot(const char *function_name) {
+  for (uint32_t i = 0; i < kMaxScopes; i++) {
+    const char *name = slots_[i].name.load(std::memory_order_acquire);
+    if (name == function_name) {
+      return INT32(i);
+    }
+    if (!name) {
+      if (slots_[i].name.compare_exchange_strong(name, function_name,
+                                                 std::memory_order_acq_rel)) {
+        return INT32(i);
+      }
+      // Lost the claim; recheck this slot for our name.
+      if (slots_[i].name.load(std::memory_order_acquire) == function_name) {
+        return INT32(i);
+      }
+    }
+  }
+
+  return -1;  // table full, scope goes unattributed
+}
+
+void HWCAllocAudit::OnScopeBegin(const char *function_name) {
+  AllocAuditThreadState &tls = g_alloc_audit_tls;
+  if (tls.depth >= kMaxDepth) {
+    tls.depth++;
+    return;
+  }
+
+  int slot = FindSlot(function_name);
+  tls.slot[tls.depth] = slot;
+  tls.instance_allocs[tls.depth] = 0;
+  tls.depth++;
+
+  if (slot >= 0) {
+    slots_[slot].entries.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void HWCAllocAudit::OnScopeEnd() {
+  AllocAuditThreadState &tls = g_alloc_audit_tls;
+  if (!tls.depth) {
+    return;  // scope was entered before the audit got enabled
+  }
+
+  tls.depth--;
+  if (tls.depth >= kMaxDepth) {
+    return;
+  }
+
+  int slot = tls.slot[tls.depth];
+  if (slot < 0) {
+    return;
+  }
+
+  // Keep the worst single-instance count for the dump.
+  uint64_t instance = tls.instance_allocs[tls.depth];
+  uint64_t max = slots_[slot].max_allocs.load(std::memory_order_relaxed);
+  while (instance > max &&
+         !slots_[slot].max_allocs.compare_exchange_weak(max, instance,
+                                                        std::memory_order_relaxed)) {
+  }
+}
+
+void HWCAllocAudit::OnAlloc(size_t size) {
+  AllocAuditThreadState &tls = g_alloc_audit_tls;
+  if (!tls.depth) {
+    return;  // allocation outside any traced scope
+  }
+
+  uint32_t level = std::min(tls.depth, kMaxDepth) - 1;
+  int slot = tls.slot[level];
+  if (slot < 0) {
+    return;
+  }
+
+  slots_[slot].allocs.fetch_add(1, std::memory_order_relaxed);
+  slots_[slot].bytes.fetch_add(size, std::memory_order_relaxed);
+  tls.instance_allocs[level]++;
+
+  int budget = budget_.load(std::memory_order_relaxed);
+  if (budget > 0 && tls.instance_allocs[level] > UINT64(budget)) {
+    // Disarm before logging; the log call itself may allocate.
+    budget_.store(0, std::memory_order_relaxed);
+    ALOGE("Allocation budget of %d exceeded in scope %s", budget,
+          slots_[slot].name.load(std::memory_order_relaxed));
+    abort();
+  }
+}
+
+void HWCAllocAudit::Dump(std::ostringstream *os) {
+  if (!Enabled()) {
+    return;
+  }
+
+  *os << "\n---------Alloc Audit-----------\n";
+  *os << "scope                          entries     allocs  allocs/entry  max/entry      bytes\n";
+  for (uint32_t i = 0; i < kMaxScopes; i++) {
+    const char *name = slots_[i].name.load(std::memory_order_acquire);
+    if (!name) {
+      break;
+    }
+
+    uint64_t entries = slots_[i].entries.load(std::memory_order_relaxed);
+    uint64_t allocs = slots_[i].allocs.load(std::memory_order_relaxed);
+    *os << std::left << std::setw(30) << name << std::right;
+    *os << std::setw(8) << entries;
+    *os << std::setw(11) << allocs;
+    *os << std::setw(14) << (entries ? (allocs / entries) : 0);
+    *os << std::setw(11) << slots_[i].max_allocs.load(std::memory_order_relaxed);
+    *os << std::setw(11) << slots_[i].bytes.load(std::memory_order_relaxed) << "\n";
+  }
+}
+
 }  // namespace sdm
+
+// Replace the throwing global operators so the audit can count hotpath allocations without
+// an external malloc debug config. Allocation still goes through malloc/free, so the default
+// nothrow and sized variants, which forward here, remain consistent.
+void *operator new(size_t size) {
+  void *ptr = malloc(size ? size : 1);
+  if (!ptr) {
+    abort();  // match bionic's default behavior on allocation failure
+  }
+  if (sdm::HWCAllocAudit::Enabled()) {
+    sdm::HWCAllocAudit::OnAlloc(size);
+  }
+
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  free(ptr);
+}
@@ -43,7 +43,9 @@
 #include <debug_handler.h>
 #include <log/log.h>
 #include <utils/Trace.h>
+#include <atomic>
 #include <bitset>
+#include <sstream>
 
 namespace sdm {
 
@@ -87,6 +89,128 @@ class HWCDebugHandler : public DebugHandler {
   int32_t verbose_level_;
 };
 
+// Commit-path phases measured by HWCFrameLatencyStats.
+enum FrameLatencyPhase {
+  kPhaseValidate = 0,   // Layer stack build + SDM prepare (strategy/resource validation)
+  kPhaseCommit,         // Tone map blits + SDM commit (atomic check and commit ioctl)
+  kPhasePostCommit,     // Fence retrieval and post-frame bookkeeping
+  kPhaseCount,
+};
+
+// Per-display latency histograms for the commit path. The only writer is the display's own
+// validate/commit thread; Dump() may race with it and needs only approximate counts, so all
+// state is relaxed atomics and the record path takes no lock.
+class HWCFrameLatencyStats {
+ public:
+  void RecordPhase(FrameLatencyPhase phase, int64_t duration_ns);
+  void Dump(std::ostringstream *os);
+  void Reset();
+
+ private:
+  // Bucket i counts durations in [2^i, 2^(i+1)) microseconds; the last bucket is open ended.
+  static const uint32_t kNumBuckets = 16;
+  // Most recent frames kept for the per-phase timeline in dumpsys.
+  static const uint32_t kRingSize = 8;
+
+  static uint32_t GetBucket(int64_t duration_ns);
+  static uint64_t PercentileUs(const uint64_t *buckets, uint64_t count, uint32_t percent);
+
+  std::atomic<uint64_t> buckets_[kPhaseCount][kNumBuckets] = {};
+  std::atomic<uint64_t> total_ns_[kPhaseCount] = {};
+  std::atomic<uint64_t> max_ns_[kPhaseCount] = {};
+  std::atomic<uint64_t> frame_ring_[kRingSize][kPhaseCount] = {};
+  std::atomic<uint64_t> frame_index_ = {};
+};
+
+// Root causes HWCFrameDropClassifier assigns to late frames, in precedence order.
+enum FrameDropCause {
+  kDropGpuAhead = 0,      // an input acquire fence was still pending at retire time
+  kDropCommitOverrun,     // the atomic commit itself ran longer than a vsync period
+  kDropValidateOverrun,   // strategy/resource validation ran longer than a vsync period
+  kDropStrategyFallback,  // layers were demoted to client (GPU) composition this frame
+  kDropScheduling,        // nothing display-side was slow; the frame simply arrived late
+  kDropCauseCount,
+};
+
+// Attributes each late frame to a cause category from signals already on hand at retire
+// time, so jank triage starts from counters instead of traces. A frame is late when the
+// commit-to-commit gap exceeds 1.5x the active vsync period. Same locking story as
+// HWCFrameLatencyStats: the display's commit thread is the only writer and Dump() needs
+// only approximate values, so everything is relaxed atomics.
+class HWCFrameDropClassifier {
+ public:
+  struct FrameSignals {
+    int64_t period_ns = 0;     // active vsync period
+    int64_t frame_gap_ns = 0;  // time since the previous presented frame, 0 on the first
+    int64_t validate_ns = 0;
+    int64_t commit_ns = 0;
+    bool acquire_pending = false;
+    bool gpu_fallback = false;
+  };
+
+  void RecordFrame(const FrameSignals &signals);
+  uint64_t GetTotalFrames() { return total_frames_.load(std::memory_order_relaxed); }
+  uint64_t GetLateFrames() { return late_frames_.load(std::memory_order_relaxed); }
+  uint64_t GetCauseCount(uint32_t cause);
+  void Dump(std::ostringstream *os);
+
+ private:
+  // Most recent late frames kept for the event timeline in dumpsys.
+  static const uint32_t kEventRingSize = 16;
+
+  std::atomic<uint64_t> total_frames_ = {};
+  std::atomic<uint64_t> late_frames_ = {};
+  std::atomic<uint64_t> cause_counts_[kDropCauseCount] = {};
+  std::atomic<uint64_t> event_frame_[kEventRingSize] = {};
+  std::atomic<uint32_t> event_cause_[kEventRingSize] = {};
+  std::atomic<int32_t> event_gap_us_[kEventRingSize] = {};
+  std::atomic<int32_t> event_validate_us_[kEventRingSize] = {};
+  std::atomic<int32_t> event_commit_us_[kEventRingSize] = {};
+  std::atomic<uint64_t> event_index_ = {};
+};
+
+// Heap allocation audit for the commit path. When enabled via property, the global operator
+// new replacements in this process attribute every allocation to the innermost DTRACE scope
+// active on the allocating thread, and dumpsys reports per-scope totals so allocation
+// regressions on the Present path are caught mechanically. An optional budget aborts the
+// process when a single scope instance allocates more than the budget - meant for CI runs.
+// Disabled (the default), the only added cost is one relaxed atomic load per allocation.
+class HWCAllocAudit {
+ public:
+  static void Enable(int budget);
+  static inline bool Enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Called from the HWCDebugHandler trace hooks on every DTRACE scope.
+  static void OnScopeBegin(const char *function_name);
+  static void OnScopeEnd();
+
+  // Called from operator new; must not allocate.
+  static void OnAlloc(size_t size);
+
+  static void Dump(std::ostringstream *os);
+
+  // Scope slots are keyed by the address of the __FUNCTION__ literal, which is stable per
+  // call site. A full table drops new scopes rather than allocating; nesting beyond
+  // kMaxDepth is attributed to the deepest tracked scope.
+  static const uint32_t kMaxScopes = 64;
+  static const uint32_t kMaxDepth = 16;
+
+ private:
+  struct ScopeSlot {
+    std::atomic<const char *> name {nullptr};
+    std::atomic<uint64_t> entries {0};
+    std::atomic<uint64_t> allocs {0};
+    std::atomic<uint64_t> bytes {0};
+    std::atomic<uint64_t> max_allocs {0};  // most allocations seen in one scope instance
+  };
+
+  static int FindSlot(const char *function_name);
+
+  static std::atomic<bool> enabled_;
+  static std::atomic<int> budget_;
+  static ScopeSlot slots_[kMaxScopes];
+};
+
 }  // namespace sdm
 
 #endif  // __HWC_DEBUGGER_H__
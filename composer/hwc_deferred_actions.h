@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HWC_DEFERRED_ACTIONS_H__
+#define __HWC_DEFERRED_ACTIONS_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace sdm {
+
+// Tagged POD action deferred from an arbitrary thread to the present cycle.
+enum DeferredActionType : uint32_t {
+  kDeferredRefresh,  // request one refresh of the given display
+};
+
+struct DeferredAction {
+  DeferredActionType type;
+  uint64_t display;
+};
+
+// Lock-free MPSC queue for deferred actions. Producers (binder threads, event threads) push
+// without taking any lock the present thread could be blocked on; the present thread drains
+// at a single defined point per cycle. Push order is preserved. Internally a Treiber stack
+// that the consumer detaches in one exchange and reverses, so a producer never spins on
+// anything but its own CAS.
+class DeferredActionQueue {
+ public:
+  ~DeferredActionQueue() {
+    Drain([](const DeferredAction & /* action */) {});
+  }
+
+  void Push(const DeferredAction &action) {
+    Node *node = new Node{action, nullptr};
+    Node *old_head = head_.load(std::memory_order_relaxed);
+    do {
+      node->next = old_head;
+    } while (!head_.compare_exchange_weak(old_head, node, std::memory_order_release,
+                                          std::memory_order_relaxed));
+  }
+
+  template <typename Fn>
+  void Drain(Fn &&fn) {
+    Node *list = head_.exchange(nullptr, std::memory_order_acquire);
+
+    // Reverse the detached stack so actions run in push order.
+    Node *ordered = nullptr;
+    while (list) {
+      Node *next = list->next;
+      list->next = ordered;
+      ordered = list;
+      list = next;
+    }
+
+    while (ordered) {
+      Node *next = ordered->next;
+      fn(static_cast<const DeferredAction &>(ordered->action));
+      delete ordered;
+      ordered = next;
+    }
+  }
+
+ private:
+  struct Node {
+    DeferredAction action;
+    Node *next;
+  };
+
+  std::atomic<Node *> head_ = {nullptr};
+};
+
+}  // namespace sdm
+
+#endif  // __HWC_DEFERRED_ACTIONS_H__
@@ -40,6 +40,7 @@
 #include <algorithm>
 #include <iomanip>
 #include <map>
+#include <new>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -47,6 +48,7 @@
 
 #include "hwc_display.h"
 #include "hwc_debugger.h"
+#include "hwc_frame_dumper.h"
 #include "hwc_tonemapper.h"
 #include "hwc_session.h"
 
@@ -518,6 +520,17 @@ int HWCDisplay::Init() {
     swap_interval_zero_ = true;
   }
 
+  int release_fence_speculation = 0;
+  HWCDebugHandler::Get()->GetProperty(ENABLE_RELEASE_FENCE_SPECULATION,
+                                      &release_fence_speculation);
+  speculate_retire_release_ = (release_fence_speculation == 1);
+
+  int vsync_disable_linger_ms = 0;
+  HWCDebugHandler::Get()->GetProperty(VSYNC_DISABLE_LINGER_MS, &vsync_disable_linger_ms);
+  if (vsync_disable_linger_ms > 0) {
+    vsync_disable_linger_ms_ = UINT32(vsync_disable_linger_ms);
+  }
+
   idle_active_ms_ = HWCDebugHandler::GetIdleTimeoutMs();
 
   client_target_ = new HWCLayer(id_, buffer_allocator_);
@@ -602,6 +615,7 @@ int HWCDisplay::Deinit() {
   for (auto hwc_layer : layer_set_) {
     delete hwc_layer;
   }
+  DrainLayerPool();
 
   if (color_mode_) {
     color_mode_->DeInit();
@@ -613,12 +627,59 @@ int HWCDisplay::Deinit() {
     tone_mapper_ = nullptr;
   }
 
+  if (frame_dumper_) {
+    delete frame_dumper_;
+    frame_dumper_ = nullptr;
+  }
+
   return 0;
 }
 
 // LayerStack operations
+HWCLayer *HWCDisplay::AllocateLayer() {
+  if (layer_pool_.empty()) {
+    return new HWCLayer(id_, buffer_allocator_);
+  }
+
+  void *slab = layer_pool_.back();
+  layer_pool_.pop_back();
+  Layer *recycled_layer = nullptr;
+  if (!sdm_layer_pool_.empty()) {
+    recycled_layer = sdm_layer_pool_.back();
+    sdm_layer_pool_.pop_back();
+  }
+
+  return new (slab) HWCLayer(id_, buffer_allocator_, recycled_layer);
+}
+
+void HWCDisplay::RecycleLayer(HWCLayer *layer) {
+  if (layer_pool_.size() >= kLayerPoolMaxSize) {
+    delete layer;
+    return;
+  }
+
+  Layer *sdm_layer = layer->DetachSDMLayer();
+  layer->~HWCLayer();
+  layer_pool_.push_back(layer);
+  if (sdm_layer) {
+    sdm_layer_pool_.push_back(sdm_layer);
+  }
+}
+
+void HWCDisplay::DrainLayerPool() {
+  for (void *slab : layer_pool_) {
+    ::operator delete(slab);
+  }
+  layer_pool_.clear();
+
+  for (Layer *sdm_layer : sdm_layer_pool_) {
+    delete sdm_layer;
+  }
+  sdm_layer_pool_.clear();
+}
+
 HWC3::Error HWCDisplay::CreateLayer(LayerId *out_layer_id) {
-  HWCLayer *layer = *layer_set_.emplace(new HWCLayer(id_, buffer_allocator_));
+  HWCLayer *layer = *layer_set_.emplace(AllocateLayer());
   if (disable_sdr_histogram_)
     layer->IgnoreSdrHistogramMetadata(true);
 
@@ -655,7 +716,7 @@ HWC3::Error HWCDisplay::DestroyLayer(LayerId layer_id) {
   for (auto current = z_range.first; current != z_range.second; ++current) {
     if (*current == layer) {
       current = layer_set_.erase(current);
-      delete layer;
+      RecycleLayer(layer);
       break;
     }
   }
@@ -678,155 +739,192 @@ static bool IsHDRLayerPresent(Layer *layer) {
   return false;
 }
 
-void HWCDisplay::BuildLayerStack() {
-  layer_stack_ = LayerStack();
-  display_rect_ = LayerRect();
-  layer_stack_.flags.use_metadata_refresh_rate = false;
-  layer_stack_.flags.animating = animating_;
-  layer_stack_.flags.layer_id_support = true;
-  layer_stack_.solid_fill_enabled = solid_fill_enable_;
-  layer_stack_.tonemapper_active = tone_mapper_ && tone_mapper_->IsActive();
-
-  DTRACE_SCOPED();
-  // Add one layer for fb target
-  for (auto hwc_layer : layer_set_) {
-    // Reset layer data which SDM may change
-    hwc_layer->ResetPerFrameData();
+void HWCDisplay::BuildLayer(HWCLayer *hwc_layer) {
+  Layer *layer = hwc_layer->GetSDMLayer();
+  LayerStackFlags contribution = {};
 
-    Layer *layer = hwc_layer->GetSDMLayer();
-    layer->flags = {};  // Reset earlier flags
-    // Mark all layers to skip, when client target handle is NULL
-    if (hwc_layer->GetClientRequestedCompositionType() == Composition::CLIENT ||
-        !client_target_->GetSDMLayer()->input_buffer.buffer_id) {
-      layer->flags.skip = true;
-    } else if (hwc_layer->GetClientRequestedCompositionType() == Composition::SOLID_COLOR) {
-      layer->flags.solid_fill = true;
-    }
+  layer->flags = {};  // Reset earlier flags
+  // Mark all layers to skip, when client target handle is NULL
+  if (hwc_layer->GetClientRequestedCompositionType() == Composition::CLIENT ||
+      !client_target_->GetSDMLayer()->input_buffer.buffer_id) {
+    layer->flags.skip = true;
+  } else if (hwc_layer->GetClientRequestedCompositionType() == Composition::SOLID_COLOR) {
+    layer->flags.solid_fill = true;
+  }
 
 #ifdef UDFPS_ZPOS
-    if (hwc_layer->IsFodPressed()) {
-      layer->flags.fod_pressed = true;
-    }
+  if (hwc_layer->IsFodPressed()) {
+    layer->flags.fod_pressed = true;
+  }
 #endif
 
-    if (!hwc_layer->IsDataSpaceSupported()) {
-      layer->flags.skip = true;
-    }
+  if (!hwc_layer->IsDataSpaceSupported()) {
+    layer->flags.skip = true;
+  }
 
-    if (swap_interval_zero_) {
-      layer->input_buffer.acquire_fence = nullptr;
-    }
+  if (swap_interval_zero_) {
+    layer->input_buffer.acquire_fence = nullptr;
+  }
 
-    bool is_secure = false;
-    bool is_video = false;
-    void *hdl = reinterpret_cast<native_handle_t *>(layer->input_buffer.buffer_id);
-    if (hdl) {
-      int buffer_type;
-      gralloc::GetMetaDataValue(hdl, QTI_BUFFER_TYPE, &buffer_type);
-      if (buffer_type == BUFFER_TYPE_VIDEO) {
-        layer_stack_.flags.video_present = true;
-        is_video = true;
-      }
-      // TZ Protected Buffer - L1
-      // Gralloc Usage Protected Buffer - L3 - which needs to be treated as Secure & avoid fallback
-      int32_t handle_flags;
-      gralloc::GetMetaDataValue(hdl, QTI_PRIVATE_FLAGS, &handle_flags);
-      if (handle_flags & qtigralloc::PRIV_FLAGS_SECURE_BUFFER) {
-        layer_stack_.flags.secure_present = true;
-        is_secure = true;
-      }
-      // UBWC PI format
-      if (handle_flags & qtigralloc::PRIV_FLAGS_UBWC_ALIGNED_PI) {
-        layer->input_buffer.flags.ubwc_pi = true;
-      }
+  bool is_secure = false;
+  bool is_video = false;
+  void *hdl = reinterpret_cast<native_handle_t *>(layer->input_buffer.buffer_id);
+  if (hdl) {
+    int buffer_type;
+    gralloc::GetMetaDataValue(hdl, QTI_BUFFER_TYPE, &buffer_type);
+    if (buffer_type == BUFFER_TYPE_VIDEO) {
+      contribution.video_present = true;
+      is_video = true;
     }
-
-    if (layer->input_buffer.flags.secure_display) {
-      layer_stack_.flags.secure_present = true;
+    // TZ Protected Buffer - L1
+    // Gralloc Usage Protected Buffer - L3 - which needs to be treated as Secure & avoid fallback
+    int32_t handle_flags;
+    gralloc::GetMetaDataValue(hdl, QTI_PRIVATE_FLAGS, &handle_flags);
+    if (handle_flags & qtigralloc::PRIV_FLAGS_SECURE_BUFFER) {
+      contribution.secure_present = true;
       is_secure = true;
     }
-
-    if (IS_RGB_FORMAT(layer->input_buffer.format) && hwc_layer->IsScalingPresent()) {
-      layer_stack_.flags.scaling_rgb_layer_present = true;
+    // UBWC PI format
+    if (handle_flags & qtigralloc::PRIV_FLAGS_UBWC_ALIGNED_PI) {
+      layer->input_buffer.flags.ubwc_pi = true;
     }
+  }
 
-    if (layer->input_buffer.usage &
-        static_cast<uint64_t>(
-            ::aidl::android::hardware::graphics::common::BufferUsage::FRONT_BUFFER)) {
-      layer->flags.front_buffer = true;
-      layer_stack_.flags.front_buffer_layer_present = true;
-    }
+  if (layer->input_buffer.flags.secure_display) {
+    contribution.secure_present = true;
+    is_secure = true;
+  }
 
-    if (hwc_layer->IsSingleBuffered() &&
-        !(hwc_layer->IsRotationPresent() || hwc_layer->IsScalingPresent())) {
-      layer->flags.single_buffer = true;
-      layer_stack_.flags.single_buffered_layer_present = true;
-    }
+  if (IS_RGB_FORMAT(layer->input_buffer.format) && hwc_layer->IsScalingPresent()) {
+    contribution.scaling_rgb_layer_present = true;
+  }
 
-    bool hdr_layer = IsHDRLayerPresent(layer);
-    if (hdr_layer && !disable_hdr_handling_) {
-      // Dont honor HDR when its handling is disabled
-      layer->input_buffer.flags.hdr = true;
-      layer_stack_.flags.hdr_present = true;
-    } else {
-      layer->input_buffer.flags.hdr = false;
-    }
+  if (layer->input_buffer.usage &
+      static_cast<uint64_t>(
+          ::aidl::android::hardware::graphics::common::BufferUsage::FRONT_BUFFER)) {
+    layer->flags.front_buffer = true;
+    contribution.front_buffer_layer_present = true;
+  }
 
-    if (game_supported_ && (hwc_layer->GetType() == kLayerGame) && !hdr_layer) {
-      layer->flags.is_game = true;
-      layer->input_buffer.flags.game = true;
-    }
+  if (hwc_layer->IsSingleBuffered() &&
+      !(hwc_layer->IsRotationPresent() || hwc_layer->IsScalingPresent())) {
+    layer->flags.single_buffer = true;
+    contribution.single_buffered_layer_present = true;
+  }
 
-    if (hwc_layer->IsNonIntegralSourceCrop() && !is_secure && !hdr_layer &&
-        !layer->flags.single_buffer && !layer->flags.solid_fill && !is_video &&
-        !layer->flags.is_game) {
-      layer->flags.skip = true;
-    }
+  bool hdr_layer = IsHDRLayerPresent(layer);
+  if (hdr_layer && !disable_hdr_handling_) {
+    // Dont honor HDR when its handling is disabled
+    layer->input_buffer.flags.hdr = true;
+    contribution.hdr_present = true;
+  } else {
+    layer->input_buffer.flags.hdr = false;
+  }
 
-    if (!layer->flags.skip &&
-        (hwc_layer->GetClientRequestedCompositionType() == Composition::CURSOR)) {
-      // Currently we support only one HWCursor & only at top most z-order
-      if ((*layer_set_.rbegin())->GetId() == hwc_layer->GetId()) {
-        layer->flags.cursor = true;
-        layer_stack_.flags.cursor_present = true;
-      }
-    }
+  if (game_supported_ && (hwc_layer->GetType() == kLayerGame) && !hdr_layer) {
+    layer->flags.is_game = true;
+    layer->input_buffer.flags.game = true;
+  }
 
-    // VTS case failure with solid layer dimming due to no support on pipe
-    // TODO(user): Remove this when we add support for solid_fill in pipe
-    if (layer->flags.solid_fill && layer->layer_brightness != 1.0f) {
-      layer->flags.skip = true;
-      layer->flags.solid_fill = false;
-    }
+  if (hwc_layer->IsNonIntegralSourceCrop() && !is_secure && !hdr_layer &&
+      !layer->flags.single_buffer && !layer->flags.solid_fill && !is_video &&
+      !layer->flags.is_game) {
+    layer->flags.skip = true;
+  }
 
-    if (layer->flags.skip) {
-      layer_stack_.flags.skip_present = true;
+  if (!layer->flags.skip &&
+      (hwc_layer->GetClientRequestedCompositionType() == Composition::CURSOR)) {
+    // Currently we support only one HWCursor & only at top most z-order
+    if ((*layer_set_.rbegin())->GetId() == hwc_layer->GetId()) {
+      layer->flags.cursor = true;
+      contribution.cursor_present = true;
     }
+  }
 
-    // TODO(user): Move to a getter if this is needed at other places
-    Rect scaled_display_frame = {INT(layer->dst_rect.left), INT(layer->dst_rect.top),
-                                 INT(layer->dst_rect.right), INT(layer->dst_rect.bottom)};
-    if (hwc_layer->GetGeometryChanges() & kDisplayFrame) {
-      ApplyScanAdjustment(&scaled_display_frame);
+  // VTS case failure with solid layer dimming due to no support on pipe
+  // TODO(user): Remove this when we add support for solid_fill in pipe
+  if (layer->flags.solid_fill && layer->layer_brightness != 1.0f) {
+    layer->flags.skip = true;
+    layer->flags.solid_fill = false;
+  }
+
+  if (layer->flags.skip) {
+    contribution.skip_present = true;
+  }
+
+  // TODO(user): Move to a getter if this is needed at other places
+  Rect scaled_display_frame = {INT(layer->dst_rect.left), INT(layer->dst_rect.top),
+                               INT(layer->dst_rect.right), INT(layer->dst_rect.bottom)};
+  if (hwc_layer->GetGeometryChanges() & kDisplayFrame) {
+    ApplyScanAdjustment(&scaled_display_frame);
+  }
+  hwc_layer->SetLayerDisplayFrame(scaled_display_frame);
+  hwc_layer->ResetPerFrameData();
+  // SDM requires these details even for solid fill
+  if (layer->flags.solid_fill) {
+    LayerBuffer *layer_buffer = &layer->input_buffer;
+    layer_buffer->width = UINT32(layer->dst_rect.right - layer->dst_rect.left);
+    layer_buffer->height = UINT32(layer->dst_rect.bottom - layer->dst_rect.top);
+    layer_buffer->unaligned_width = layer_buffer->width;
+    layer_buffer->unaligned_height = layer_buffer->height;
+    layer->src_rect.left = 0;
+    layer->src_rect.top = 0;
+    layer->src_rect.right = layer_buffer->width;
+    layer->src_rect.bottom = layer_buffer->height;
+  }
+
+  if (hwc_layer->HasMetaDataRefreshRate()) {
+    layer->flags.has_metadata_refresh_rate = true;
+  }
+
+  if (hwc_layer->GetOrigClientRequestedCompositionType() == Composition::DISPLAY_DECORATION) {
+    layer->input_buffer.flags.mask_layer = true;
+  }
+  contribution.mask_present = layer->input_buffer.flags.mask_layer;
+
+  hwc_layer->SetStackFlagsContribution(contribution);
+}
+
+void HWCDisplay::BuildLayerStack() {
+  DTRACE_SCOPED();
+  // Frame-level inputs that feed per-layer flag derivation; when any of them changed since the
+  // last build, every layer must be re-derived even if it is clean.
+  bool client_target_null = !client_target_->GetSDMLayer()->input_buffer.buffer_id;
+  bool rebuild_all_layers = layer_stack_invalid_ || layer_stack_.layers.empty() ||
+                            force_full_stack_rebuild_ ||
+                            (client_target_null != built_client_target_null_) ||
+                            (swap_interval_zero_ != built_swap_interval_zero_);
+  force_full_stack_rebuild_ = false;
+  // A z-order move can promote a clean layer to top-most, which feeds the cursor derivation.
+  for (auto hwc_layer : layer_set_) {
+    if (hwc_layer->GetGeometryChanges() & kZOrder) {
+      rebuild_all_layers = true;
+      break;
     }
-    hwc_layer->SetLayerDisplayFrame(scaled_display_frame);
+  }
+  built_client_target_null_ = client_target_null;
+  built_swap_interval_zero_ = swap_interval_zero_;
+
+  layer_stack_.Reset();
+  display_rect_ = LayerRect();
+  layer_stack_.flags.use_metadata_refresh_rate = false;
+  layer_stack_.flags.animating = animating_;
+  layer_stack_.flags.layer_id_support = true;
+  layer_stack_.solid_fill_enabled = solid_fill_enable_;
+  layer_stack_.tonemapper_active = tone_mapper_ && tone_mapper_->IsActive();
+
+  // Add one layer for fb target
+  for (auto hwc_layer : layer_set_) {
+    // Reset layer data which SDM may change
     hwc_layer->ResetPerFrameData();
-    // SDM requires these details even for solid fill
-    if (layer->flags.solid_fill) {
-      LayerBuffer *layer_buffer = &layer->input_buffer;
-      layer_buffer->width = UINT32(layer->dst_rect.right - layer->dst_rect.left);
-      layer_buffer->height = UINT32(layer->dst_rect.bottom - layer->dst_rect.top);
-      layer_buffer->unaligned_width = layer_buffer->width;
-      layer_buffer->unaligned_height = layer_buffer->height;
-      layer->src_rect.left = 0;
-      layer->src_rect.top = 0;
-      layer->src_rect.right = layer_buffer->width;
-      layer->src_rect.bottom = layer_buffer->height;
-    }
 
-    if (hwc_layer->HasMetaDataRefreshRate()) {
-      layer->flags.has_metadata_refresh_rate = true;
+    Layer *layer = hwc_layer->GetSDMLayer();
+    // Re-derive flags only for layers that changed since the last build; clean layers keep
+    // their flags and cached stack contribution, only the per-frame state below is refreshed.
+    if (rebuild_all_layers || hwc_layer->NeedsValidation()) {
+      BuildLayer(hwc_layer);
     }
+    layer_stack_.flags.flags |= hwc_layer->GetStackFlagsContribution().flags;
 
     display_rect_ = Union(display_rect_, layer->dst_rect);
     geometry_changes_ |= hwc_layer->GetGeometryChanges();
@@ -839,10 +937,6 @@ void HWCDisplay::BuildLayerStack() {
     if (hwc_layer->IsColorTransformSet()) {
       layer->flags.color_transform = true;
     }
-    if (hwc_layer->GetOrigClientRequestedCompositionType() == Composition::DISPLAY_DECORATION) {
-      layer->input_buffer.flags.mask_layer = true;
-    }
-    layer_stack_.flags.mask_present |= layer->input_buffer.flags.mask_layer;
 
     layer->flags.compatible = hwc_layer->IsLayerCompatible();
 
@@ -880,7 +974,7 @@ void HWCDisplay::BuildLayerStack() {
 }
 
 void HWCDisplay::BuildSolidFillStack() {
-  layer_stack_ = LayerStack();
+  layer_stack_.Reset();
   display_rect_ = LayerRect();
 
   layer_stack_.layers.push_back(solid_fill_layer_);
@@ -947,6 +1041,23 @@ HWC3::Error HWCDisplay::SetVsyncEnabled(bool enabled) {
     return HWC3::Error::None;
   }
 
+  if (vsync_disable_linger_ms_) {
+    std::lock_guard<std::mutex> lock(vsync_linger_mutex_);
+    if (!enabled) {
+      // Leave the kernel event on for the linger window; VSync() stops forwarding right away
+      // and applies the disable from the event thread once the window expires.
+      vsync_disable_pending_ = true;
+      vsync_disable_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+      return HWC3::Error::None;
+    }
+    if (vsync_disable_pending_) {
+      // Re-enabled within the linger window. The kernel event never went off, so the usual
+      // idle exit re-registration round-trip is skipped entirely.
+      vsync_disable_pending_ = false;
+      return HWC3::Error::None;
+    }
+  }
+
   error = display_intf_->SetVSyncState(enabled);
 
   if (error != kErrorNone) {
@@ -980,6 +1091,20 @@ HWC3::Error HWCDisplay::SetPowerMode(PowerMode mode, bool teardown) {
     return HWC3::Error::None;
   }
 
+  if (vsync_disable_linger_ms_) {
+    // Power transitions manage vsync internally in the core; flush any lingering disable so the
+    // next client enable is forwarded instead of being treated as a cancellation.
+    bool flush_vsync_disable = false;
+    {
+      std::lock_guard<std::mutex> lock(vsync_linger_mutex_);
+      flush_vsync_disable = vsync_disable_pending_;
+      vsync_disable_pending_ = false;
+    }
+    if (flush_vsync_disable) {
+      display_intf_->SetVSyncState(false);
+    }
+  }
+
   switch (mode) {
     case PowerMode::OFF:
       // During power off, all of the buffers are released.
@@ -1301,7 +1426,66 @@ HWC3::Error HWCDisplay::SetClientTarget(buffer_handle_t target, shared_ptr<Fence
   sdm_layer->frame_rate = std::min(current_refresh_rate_, HWCDisplay::GetThrottlingRefreshRate());
 
   SetClientTargetDataSpace(dataspace);
-  client_target_->SetLayerSurfaceDamage(damage);
+
+  // Surface damage is relative to the previously presented frame, but this buffer is one of a
+  // ring and its stale content dates back to its own last trip through here. Widen the dirty
+  // region by the damage of every frame the buffer missed so partial update fetches all changed
+  // pixels; an unknown buffer or one older than the history keeps the framework damage as is.
+  uint64_t buffer_key = reinterpret_cast<uint64_t>(target);
+  LayerRect frame_damage = {};
+  bool damage_known = (damage.num_rects > 0);
+  if (damage.num_rects == 1 && damage.rects[0].bottom == 0 && damage.rects[0].right == 0) {
+    damage_known = false;  // explicit empty-damage sentinel, same as HWCLayer treats it
+  }
+  if (damage_known) {
+    for (size_t i = 0; i < damage.num_rects; i++) {
+      LayerRect rect = {FLOAT(damage.rects[i].left), FLOAT(damage.rects[i].top),
+                        FLOAT(damage.rects[i].right), FLOAT(damage.rects[i].bottom)};
+      frame_damage = Union(frame_damage, rect);
+    }
+  } else {
+    // Unspecified damage means the full frame may have changed; record it as such so a later
+    // reuse of the ring does not under-damage.
+    frame_damage = LayerRect(0.0f, 0.0f, FLOAT(fb_width_), FLOAT(fb_height_));
+  }
+
+  bool aged_damage_set = false;
+  LayerRect aged_damage = frame_damage;
+  auto buffer_seq = client_target_buffer_seq_.find(buffer_key);
+  if (damage_known && buffer_seq != client_target_buffer_seq_.end()) {
+    uint64_t age = client_target_frame_seq_ - buffer_seq->second;
+    if (age >= 1 && age <= kClientTargetDamageHistory) {
+      // Union in the frames presented since this buffer's last trip, newest first. Age 1 means
+      // consecutive use, for which the framework damage is already exact.
+      for (uint64_t past = 1; past < age; past++) {
+        uint32_t slot = UINT32((client_target_frame_seq_ - past) % kClientTargetDamageHistory);
+        aged_damage = Union(aged_damage, client_target_damage_ring_[slot]);
+      }
+      aged_damage_set = true;
+    }
+  }
+
+  if (aged_damage_set) {
+    Rect aged_rect = {INT32(aged_damage.left), INT32(aged_damage.top), INT32(aged_damage.right),
+                      INT32(aged_damage.bottom)};
+    Region aged_region = {1, &aged_rect};
+    client_target_->SetLayerSurfaceDamage(aged_region);
+  } else {
+    client_target_->SetLayerSurfaceDamage(damage);
+  }
+
+  client_target_damage_ring_[UINT32(client_target_frame_seq_ % kClientTargetDamageHistory)] =
+      frame_damage;
+  client_target_buffer_seq_[buffer_key] = client_target_frame_seq_;
+  client_target_frame_seq_++;
+  if (client_target_buffer_seq_.size() > 2 * kClientTargetDamageHistory) {
+    // Drop buffers the framework has stopped cycling; their age exceeds the history anyway.
+    for (auto it = client_target_buffer_seq_.begin(); it != client_target_buffer_seq_.end();) {
+      bool expired = (client_target_frame_seq_ - it->second) > kClientTargetDamageHistory;
+      it = expired ? client_target_buffer_seq_.erase(it) : std::next(it);
+    }
+  }
+
   client_target_->SetLayerBuffer(target, acquire_fence);
   client_target_handle_ = target;
   client_acquire_fence_ = acquire_fence;
@@ -1371,6 +1555,9 @@ HWC3::Error HWCDisplay::SetActiveConfig(Config config) {
   pending_config_ = true;
   pending_config_index_ = config;
 
+  // Warm the target config's cached state now so the designated switch frame only swaps it in.
+  display_intf_->PrefetchActiveConfig(UINT32(config));
+
   // Trigger refresh. This config gets applied on next commit.
   callbacks_->Refresh(id_);
 
@@ -1489,6 +1676,29 @@ PowerMode HWCDisplay::GetCurrentPowerMode() {
 }
 
 DisplayError HWCDisplay::VSync(const DisplayEventVSync &vsync) {
+  if (vsync_disable_linger_ms_) {
+    bool lingering = false;
+    bool disable_now = false;
+    {
+      std::lock_guard<std::mutex> lock(vsync_linger_mutex_);
+      lingering = vsync_disable_pending_;
+      if (lingering) {
+        disable_now = (systemTime(SYSTEM_TIME_MONOTONIC) - vsync_disable_time_) >=
+                      ms2ns(INT32(vsync_disable_linger_ms_));
+        vsync_disable_pending_ = !disable_now;
+      }
+    }
+    if (disable_now) {
+      // Linger window expired without a re-enable; turn the kernel event off for real. The
+      // event thread holds no display locks here, so this mirrors the client call.
+      display_intf_->SetVSyncState(false);
+    }
+    if (lingering) {
+      // Client asked vsync off; do not forward events during the linger window.
+      return kErrorNone;
+    }
+  }
+
   VsyncPeriodNanos vsync_period;
   if (GetDisplayVsyncPeriod(&vsync_period) != HWC3::Error::None) {
     vsync_period = 0;
@@ -1524,7 +1734,7 @@ DisplayError HWCDisplay::HandleEvent(DisplayEvent event) {
       // Prepare or commit could operate on the display since locker_[id_] is free and most likely
       // result in a failure since ESD/HWR has been requested during this time period.
       if (event_handler_) {
-        event_handler_->DisplayPowerReset();
+        event_handler_->DisplayPowerReset(id_);
       } else {
         DLOGW("Cannot execute DisplayPowerReset (client_id = %" PRId64 "), event_handler_ is null",
               id_);
@@ -1574,6 +1784,8 @@ HWC3::Error HWCDisplay::PrepareLayerStack(uint32_t *out_num_types, uint32_t *out
     return ((*out_num_types > 0) ? HWC3::Error::HasChanges : HWC3::Error::None);
   }
 
+  frame_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+  nsecs_t start_time = frame_time_;
   UpdateRefreshRate();
   UpdateActiveConfig();
   DisplayError error = display_intf_->Prepare(&layer_stack_);
@@ -1582,7 +1794,11 @@ HWC3::Error HWCDisplay::PrepareLayerStack(uint32_t *out_num_types, uint32_t *out
     return status;
   }
 
-  return PostPrepareLayerStack(out_num_types, out_num_requests);
+  status = PostPrepareLayerStack(out_num_types, out_num_requests);
+  last_validate_ns_ = systemTime(SYSTEM_TIME_MONOTONIC) - start_time;
+  latency_stats_.RecordPhase(kPhaseValidate, last_validate_ns_);
+
+  return status;
 }
 
 HWC3::Error HWCDisplay::HandlePrepareError(DisplayError error) {
@@ -1856,6 +2072,21 @@ HWC3::Error HWCDisplay::CommitOrPrepare(bool validate_only, shared_ptr<Fence> *o
   return PostPrepareLayerStack(out_num_types, out_num_requests);
 }
 
+void HWCDisplay::SpeculatePrepare() {
+  DTRACE_SCOPED();
+
+  if (shutdown_pending_ || layer_set_.empty() || !display_intf_) {
+    return;
+  }
+
+  // Warm-up only: build the pending stack and run the prepare stage so the
+  // validate that follows finds most of its work done. No client-visible state
+  // changes here; any layer command arriving after this ran marks the frame
+  // dirty again and the real validate recomputes the delta.
+  BuildLayerStack();
+  display_intf_->PrePrepare(&layer_stack_);
+}
+
 HWC3::Error HWCDisplay::CommitLayerStack(void) {
   if (flush_) {
     return HWC3::Error::None;
@@ -1877,6 +2108,8 @@ HWC3::Error HWCDisplay::CommitLayerStack(void) {
     return HWC3::Error::None;
   }
 
+  frame_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+  nsecs_t start_time = frame_time_;
   DisplayError error = kErrorUndefined;
   int status = 0;
   if (tone_mapper_) {
@@ -1910,11 +2143,16 @@ HWC3::Error HWCDisplay::CommitLayerStack(void) {
     return HWC3::Error::Unsupported;
   }
 
+  last_commit_ns_ = systemTime(SYSTEM_TIME_MONOTONIC) - start_time;
+  latency_stats_.RecordPhase(kPhaseCommit, last_commit_ns_);
+
   return HWC3::Error::None;
 }
 
 HWC3::Error HWCDisplay::PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence) {
   DTRACE_SCOPED();
+  frame_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+  nsecs_t start_time = frame_time_;
   auto status = HWC3::Error::None;
 
   // Do no call flush on errors, if a successful buffer is never submitted.
@@ -1928,6 +2166,11 @@ HWC3::Error HWCDisplay::PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence
 
   DumpInputBuffers();
 
+  // Classify before the acquire fences are cleared below.
+  if (!flush_ && !skip_commit_) {
+    RecordFrameDropSignals();
+  }
+
   RetrieveFences(out_retire_fence);
   client_target_->ResetGeometryChanges();
 
@@ -1968,6 +2211,12 @@ HWC3::Error HWCDisplay::PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence
     SetActiveConfig(pending_first_commit_config_index_);
   }
 
+  // Memoized merge results pin their source fds; drop them now that this frame's
+  // fences have all been handed out.
+  Fence::ResetMergeCache();
+
+  latency_stats_.RecordPhase(kPhasePostCommit, systemTime(SYSTEM_TIME_MONOTONIC) - start_time);
+
   return status;
 }
 
@@ -1981,10 +2230,19 @@ void HWCDisplay::RetrieveFences(shared_ptr<Fence> *out_retire_fence) {
       // If swapinterval property is set to 0 or for single buffer layers, do not update f/w
       // release fences and discard fences from driver
       if (!swap_interval_zero_ && !layer->flags.single_buffer) {
-        // It may so happen that layer gets marked to GPU & app layer gets queued
-        // to MDP for composition. In those scenarios, release fence of buffer should
-        // have mdp and gpu sync points merged.
-        hwc_layer->SetReleaseFence(layer_buffer->release_fence);
+        if (speculate_retire_release_ && layer->composition == kCompositionSDE &&
+            layer_stack_.retire_fence != nullptr) {
+          // A device-composed buffer is scanned out until the commit that replaces it retires,
+          // so its release fence and the retire fence signal together. Handing back the retire
+          // fence object itself lets the AIDL layer serve these entries with dups of the one
+          // per-frame present fence instead of per-layer merged fences.
+          hwc_layer->SetReleaseFence(layer_stack_.retire_fence);
+        } else {
+          // It may so happen that layer gets marked to GPU & app layer gets queued
+          // to MDP for composition. In those scenarios, release fence of buffer should
+          // have mdp and gpu sync points merged.
+          hwc_layer->SetReleaseFence(layer_buffer->release_fence);
+        }
       }
     } else {
       // In case of flush or display paused, we don't return an error to f/w, so it will
@@ -2002,6 +2260,51 @@ void HWCDisplay::RetrieveFences(shared_ptr<Fence> *out_retire_fence) {
   }
 }
 
+void HWCDisplay::RecordFrameDropSignals() {
+  nsecs_t now = frame_time_;
+  nsecs_t gap = last_present_time_ ? (now - last_present_time_) : 0;
+  last_present_time_ = now;
+
+  VsyncPeriodNanos vsync_period = 0;
+  if (GetDisplayVsyncPeriod(&vsync_period) != HWC3::Error::None || !vsync_period) {
+    return;
+  }
+
+  HWCFrameDropClassifier::FrameSignals signals = {};
+  signals.period_ns = static_cast<int64_t>(vsync_period);
+  signals.frame_gap_ns = gap;
+  signals.validate_ns = last_validate_ns_;
+  signals.commit_ns = last_commit_ns_;
+  signals.gpu_fallback = has_client_composition_;
+
+  // An input still waiting on its producer after the commit returned means the
+  // kernel had to block on the GPU (or another writer) to latch this frame.
+  for (auto hwc_layer : layer_set_) {
+    Layer *layer = hwc_layer->GetSDMLayer();
+    shared_ptr<Fence> &acquire_fence = layer->input_buffer.acquire_fence;
+    if (acquire_fence && (Fence::GetStatus(acquire_fence) == Fence::Status::kPending)) {
+      signals.acquire_pending = true;
+      break;
+    }
+  }
+  if (!signals.acquire_pending && has_client_composition_ && client_target_) {
+    shared_ptr<Fence> &fb_acquire = client_target_->GetSDMLayer()->input_buffer.acquire_fence;
+    signals.acquire_pending =
+        fb_acquire && (Fence::GetStatus(fb_acquire) == Fence::Status::kPending);
+  }
+
+  frame_drop_stats_.RecordFrame(signals);
+}
+
+void HWCDisplay::GetFrameDropStats(uint64_t *total_frames, uint64_t *late_frames,
+                                   uint64_t *cause_counts) {
+  *total_frames = frame_drop_stats_.GetTotalFrames();
+  *late_frames = frame_drop_stats_.GetLateFrames();
+  for (uint32_t cause = 0; cause < kDropCauseCount; cause++) {
+    cause_counts[cause] = frame_drop_stats_.GetCauseCount(cause);
+  }
+}
+
 void HWCDisplay::SetIdleTimeoutMs(uint32_t timeout_ms, uint32_t inactive_ms) {
   return;
 }
@@ -2055,7 +2358,6 @@ void HWCDisplay::DumpInputBuffers() {
 
     const native_handle_t *handle =
         reinterpret_cast<const native_handle_t *>(layer->input_buffer.buffer_id);
-    Fence::Wait(layer->input_buffer.acquire_fence);
 
     if (!handle) {
       DLOGW(
@@ -2067,15 +2369,7 @@ void HWCDisplay::DumpInputBuffers() {
 
     DLOGI("Dump layer[%d] of %lu handle %p", i, layer_stack_.layers.size(), handle);
 
-    void *base_ptr = NULL;
-    int error = buffer_allocator_->MapBuffer(handle, nullptr, &base_ptr);
-    if (error != kErrorNone) {
-      DLOGE("Failed to map buffer, error = %d", error);
-      continue;
-    }
-
     char dump_file_name[PATH_MAX];
-    size_t result = 0;
 
     uint32_t width = 0, height = 0, alloc_size = 0;
 
@@ -2083,45 +2377,39 @@ void HWCDisplay::DumpInputBuffers() {
     buffer_allocator_->GetHeight((void *)handle, height);
     buffer_allocator_->GetAllocationSize((void *)handle, alloc_size);
 
-    snprintf(dump_file_name, sizeof(dump_file_name), "%s/input_layer%d_%dx%d_%s_frame%d.raw",
-             dir_path, i, width, height, GetFormatString(layer->input_buffer.format),
-             dump_input_frame_index_);
-
-    if (base_ptr != nullptr) {
-      FILE *fp = fopen(dump_file_name, "w+");
-      if (fp) {
-        result = fwrite(base_ptr, alloc_size, 1, fp);
-        fclose(fp);
-      }
-    }
-
-    int release_fence = -1;
-    error = buffer_allocator_->UnmapBuffer(handle, &release_fence);
-    if (error != 0) {
-      DLOGE("Failed to unmap buffer, error = %d", error);
+    // Defer fence wait, mapping and file I/O to the dump worker. The cloned
+    // handle holds buffer references on behalf of the job.
+    FrameDumpJob job;
+    job.handle = native_handle_clone(handle);
+    if (!job.handle) {
+      DLOGE("Failed to clone handle for layer %d, errno = %d", i, errno);
       continue;
     }
+    job.acquire_fence = layer->input_buffer.acquire_fence;
+    job.alloc_size = alloc_size;
 
-    DLOGI("Frame Dump %s: is %s", dump_file_name, result ? "Successful" : "Failed");
+    snprintf(dump_file_name, sizeof(dump_file_name), "%s/input_layer%d_%dx%d_%s_frame%d.raw",
+             dir_path, i, width, height, GetFormatString(layer->input_buffer.format),
+             dump_input_frame_index_);
+    job.file_path = dump_file_name;
 
     HWCDebugHandler::Get()->GetProperty(ENABLE_METADATA_DUMPING, &dump_metadata);
     if (dump_metadata) {
       // Dump only extended content metadata for now. Property named generically for future extension
       std::shared_ptr<CustomContentMetadata> c_md = layer->input_buffer.extended_content_metadata;
       if (c_md) {
-        result = 0;
         snprintf(dump_file_name, sizeof(dump_file_name), "%s/input_layer%d_content_md_frame%d.raw",
                  dir_path, i, dump_frame_index_);
-        FILE *fp = fopen(dump_file_name, "w+");
-        if (fp) {
-          result = fwrite(&c_md->metadataPayload, c_md->size, 1, fp);
-          fclose(fp);
-        }
-
-        DLOGI("Frame Metadata Dump %s: is %s", dump_file_name, result ? "Successful" : "Failed");
+        job.metadata = c_md;
+        job.metadata_path = dump_file_name;
       }
     }
 
+    if (!frame_dumper_) {
+      frame_dumper_ = new HWCFrameDumper(buffer_allocator_);
+    }
+    frame_dumper_->Enqueue(&job);
+
     if (layer->composition == kCompositionGPUTarget) {  // Skip dumping the layers that follow
       // follow GPU Target layer in layers list (i.e. stitch layers, noise layer, demura layer).
       break;
@@ -2132,7 +2420,7 @@ void HWCDisplay::DumpInputBuffers() {
 }
 
 void HWCDisplay::DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
-                                  shared_ptr<Fence> &retire_fence) {
+                                  shared_ptr<Fence> &buffer_fence) {
   char dir_path[PATH_MAX];
   int status;
 
@@ -2155,7 +2443,7 @@ void HWCDisplay::DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
     char dump_file_name[PATH_MAX];
     size_t result = 0;
 
-    if (Fence::Wait(retire_fence) != kErrorNone) {
+    if (Fence::Wait(buffer_fence) != kErrorNone) {
       DLOGW("sync_wait error errno = %d, desc = %s", errno, strerror(errno));
       return;
     }
@@ -2174,7 +2462,11 @@ void HWCDisplay::DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
     // But avoid this in case of virtual display frame dump, else it would provide empty buffer
     // to virtual display client, because it uses client buffer for dumping output.
     if (type_ != kVirtual) {
-      memset(base, 0, buffer_info.alloc_buffer_info.size);
+      // Plane-aware clear: skips meta planes and inter-plane padding and yields between
+      // chunks, so emptying a large output buffer does not stall this thread.
+      if (buffer_allocator_->ClearBufferContents(buffer_info.private_data, base) != 0) {
+        memset(base, 0, buffer_info.alloc_buffer_info.size);
+      }
     }
     DLOGI("Frame Dump of %s is %s", dump_file_name, result ? "Successful" : "Failed");
   }
@@ -2430,6 +2722,8 @@ void HWCDisplay::MarkLayersForClientComposition() {
     layer->flags.skip = true;
   }
   layer_stack_.flags.skip_present = true;
+  // Skip flags were forced outside of BuildLayer(); re-derive all layers on the next build.
+  force_full_stack_rebuild_ = true;
 }
 
 void HWCDisplay::ApplyScanAdjustment(Rect *display_frame) {}
@@ -2459,34 +2753,53 @@ int HWCDisplay::ColorSVCRequestRoute(const PPDisplayAPIPayload &in_payload,
 
 void HWCDisplay::SolidFillPrepare() {
   if (solid_fill_enable_) {
+    uint32_t primary_width = 0, primary_height = 0;
+    GetMixerResolution(&primary_width, &primary_height);
+
+    // Dim layers and solid fills persist across many consecutive frames, so
+    // reuse the prebuilt layer unless the color, rect or mixer resolution
+    // changed since it was last populated.
+    bool reuse_layer = false;
     if (solid_fill_layer_ == NULL) {
       // Create a dummy layer here
       solid_fill_layer_ = new Layer();
+    } else {
+      const LayerBuffer &layer_buffer = solid_fill_layer_->input_buffer;
+      const LayerSolidFill &fill_info = solid_fill_layer_->solid_fill_info;
+      reuse_layer = (layer_buffer.width == primary_width) &&
+                    (layer_buffer.height == primary_height) &&
+                    IsCongruent(solid_fill_layer_->src_rect, solid_fill_rect_) &&
+                    (fill_info.bit_depth == solid_fill_color_.bit_depth) &&
+                    (fill_info.red == solid_fill_color_.red) &&
+                    (fill_info.green == solid_fill_color_.green) &&
+                    (fill_info.blue == solid_fill_color_.blue) &&
+                    (fill_info.alpha == solid_fill_color_.alpha);
     }
-    uint32_t primary_width = 0, primary_height = 0;
-    GetMixerResolution(&primary_width, &primary_height);
 
-    LayerBuffer *layer_buffer = &solid_fill_layer_->input_buffer;
-    layer_buffer->width = primary_width;
-    layer_buffer->height = primary_height;
-    layer_buffer->unaligned_width = primary_width;
-    layer_buffer->unaligned_height = primary_height;
-
-    solid_fill_layer_->composition = kCompositionGPU;
-    solid_fill_layer_->src_rect = solid_fill_rect_;
-    solid_fill_layer_->dst_rect = solid_fill_rect_;
-
-    solid_fill_layer_->blending = kBlendingPremultiplied;
-    solid_fill_layer_->solid_fill_color = 0;
-    solid_fill_layer_->solid_fill_info.bit_depth = solid_fill_color_.bit_depth;
-    solid_fill_layer_->solid_fill_info.red = solid_fill_color_.red;
-    solid_fill_layer_->solid_fill_info.blue = solid_fill_color_.blue;
-    solid_fill_layer_->solid_fill_info.green = solid_fill_color_.green;
-    solid_fill_layer_->solid_fill_info.alpha = solid_fill_color_.alpha;
-    solid_fill_layer_->frame_rate = 60;
-    solid_fill_layer_->visible_regions.push_back(solid_fill_layer_->dst_rect);
-    solid_fill_layer_->flags.updating = 1;
-    solid_fill_layer_->flags.solid_fill = true;
+    if (!reuse_layer) {
+      LayerBuffer *layer_buffer = &solid_fill_layer_->input_buffer;
+      layer_buffer->width = primary_width;
+      layer_buffer->height = primary_height;
+      layer_buffer->unaligned_width = primary_width;
+      layer_buffer->unaligned_height = primary_height;
+
+      solid_fill_layer_->composition = kCompositionGPU;
+      solid_fill_layer_->src_rect = solid_fill_rect_;
+      solid_fill_layer_->dst_rect = solid_fill_rect_;
+
+      solid_fill_layer_->blending = kBlendingPremultiplied;
+      solid_fill_layer_->solid_fill_color = 0;
+      solid_fill_layer_->solid_fill_info.bit_depth = solid_fill_color_.bit_depth;
+      solid_fill_layer_->solid_fill_info.red = solid_fill_color_.red;
+      solid_fill_layer_->solid_fill_info.blue = solid_fill_color_.blue;
+      solid_fill_layer_->solid_fill_info.green = solid_fill_color_.green;
+      solid_fill_layer_->solid_fill_info.alpha = solid_fill_color_.alpha;
+      solid_fill_layer_->frame_rate = 60;
+      solid_fill_layer_->visible_regions.clear();
+      solid_fill_layer_->visible_regions.push_back(solid_fill_layer_->dst_rect);
+      solid_fill_layer_->flags.updating = 1;
+      solid_fill_layer_->flags.solid_fill = true;
+    }
   } else {
     // delete the dummy layer
     delete solid_fill_layer_;
@@ -2684,6 +2997,16 @@ void HWCDisplay::Dump(std::ostringstream *os) {
     return;
   }
 
+  latency_stats_.Dump(os);
+  frame_drop_stats_.Dump(os);
+  // With vendor.display.reset_latency_stats set, each dump covers only the interval since the
+  // previous one, which makes p99 regressions easy to bisect on production devices.
+  int reset_latency_stats = 0;
+  HWCDebugHandler::Get()->GetProperty(RESET_LATENCY_STATS_PROP, &reset_latency_stats);
+  if (reset_latency_stats) {
+    latency_stats_.Reset();
+  }
+
   if (color_mode_) {
     *os << "\n----------Color Modes---------\n";
     color_mode_->Dump(os);
@@ -2943,7 +3266,8 @@ HWC3::Error HWCDisplay::SetActiveConfigWithConstraints(
 }
 
 void HWCDisplay::ProcessActiveConfigChange() {
-  if (!IsActiveConfigReadyToSubmit(systemTime(SYSTEM_TIME_MONOTONIC))) {
+  frame_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+  if (!IsActiveConfigReadyToSubmit(frame_time_)) {
     return;
   }
 
@@ -3001,6 +3325,9 @@ std::tuple<int64_t, int64_t> HWCDisplay::RequestActiveConfigChange(
   pending_refresh_rate_refresh_time_ = refresh_time;
   pending_refresh_rate_applied_time_ = applied_time;
 
+  // Warm the target config's cached state now so the designated switch frame only swaps it in.
+  display_intf_->PrefetchActiveConfig(UINT32(config));
+
   return std::make_tuple(refresh_time, applied_time);
 }
 
@@ -3325,6 +3652,20 @@ void HWCDisplay::SetDrawMethod() {
   display_intf_->SetDrawMethod(draw_method_);
 
   draw_method_set_ = true;
+  ApplyCommitQueueDepth();
+}
+
+void HWCDisplay::ApplyCommitQueueDepth() {
+  int depth = 0;
+  HWCDebugHandler::Get()->GetProperty(COMMIT_QUEUE_DEPTH, &depth);
+  if (depth <= 1) {
+    return;
+  }
+
+  // Must follow SetDrawMethod(): the display rejects deep queues under default draw.
+  if (display_intf_->SetCommitQueueDepth(UINT32(depth)) != kErrorNone) {
+    DLOGW("Commit queue depth %d not supported on display %" PRIu64, depth, id_);
+  }
 }
 
 HWC3::Error HWCDisplay::TryDrawMethod(DrawMethod client_drawMethod) {
@@ -3354,6 +3695,7 @@ HWC3::Error HWCDisplay::TryDrawMethod(DrawMethod client_drawMethod) {
   display_intf_->SetDrawMethod(draw_method_);
 
   draw_method_set_ = true;
+  ApplyCommitQueueDepth();
 
   return status;
 }
@@ -3646,6 +3988,7 @@ void HWCDisplay::HandleFrameDump() {
   }
 
   auto ret = kCWBReleaseFenceErrorNone;
+  shared_ptr<Fence> wb_done_fence = nullptr;
   {
     std::unique_lock<std::mutex> lock(cwb_mutex_);
     auto &cwb_resp = cwb_capture_status_map_[kCWBClientFrameDump];
@@ -3660,6 +4003,7 @@ void HWCDisplay::HandleFrameDump() {
       }
     }
     ret = cwb_resp.status;
+    wb_done_fence = cwb_resp.release_fence;
     cwb_capture_status_map_.erase(kCWBClientFrameDump);
   }
 
@@ -3668,7 +4012,13 @@ void HWCDisplay::HandleFrameDump() {
     // one second for signal, and which might got delayed due to some flushing and resource
     // releasing operations during certain power glitch event. So, we can assume that buffer
     // writing operation is over after timeout.
-    DumpOutputBuffer(output_buffer_info_, output_buffer_base_, layer_stack_.retire_fence);
+    // Gate the dump on the writeback connector's fence: it signals when writeback DMA
+    // completes, up to half a frame ahead of the frame retire fence the buffer read used
+    // to wait on. Fall back to the retire fence if the notification carried no fence.
+    if (wb_done_fence == nullptr) {
+      wb_done_fence = layer_stack_.retire_fence;
+    }
+    DumpOutputBuffer(output_buffer_info_, output_buffer_base_, wb_done_fence);
     if (ret == kCWBReleaseFenceWaitTimedOut) {
       DLOGW("CWB frame-%d dump may be empty due to fence timeout on any unexpected event!",
             dump_frame_index_);
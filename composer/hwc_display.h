@@ -44,6 +44,7 @@
 #include "histogram_collector.h"
 #include "hwc_buffer_allocator.h"
 #include "hwc_callbacks.h"
+#include "hwc_debugger.h"
 #include "hwc_display_event_handler.h"
 #include "hwc_layers.h"
 #include "hwc_buffer_sync_handler.h"
@@ -64,6 +65,7 @@ typedef uint32_t VsyncPeriodNanos;
 namespace sdm {
 
 class HWCToneMapper;
+class HWCFrameDumper;
 
 // Subclasses set this to their type. This has to be different from DisplayType.
 // This is to avoid RTTI and dynamic_cast
@@ -188,7 +190,7 @@ class HWCDisplay : public DisplayEventHandler {
   struct HWCLayerStack {
     HWCLayer *client_target = nullptr;                   // Also known as framebuffer target
     std::map<LayerId, HWCLayer *> layer_map;             // Look up by Id - TODO
-    std::multiset<HWCLayer *, SortLayersByZ> layer_set;  // Maintain a set sorted by Z
+    SortedLayerSet layer_set;                             // Maintain a set sorted by Z
   };
 
   virtual ~HWCDisplay() {}
@@ -272,6 +274,7 @@ class HWCDisplay : public DisplayEventHandler {
   virtual int GetDisplayAttributesForConfig(int config,
                                             DisplayConfigVariableInfo *display_attributes);
   virtual int GetSupportedDisplayRefreshRates(std::vector<uint32_t> *supported_refresh_rates);
+  uint32_t GetActiveRefreshRate() { return active_refresh_rate_; }
   bool IsModeSwitchAllowed(uint32_t config);
 
   virtual DisplayError Flush() { return kErrorNotSupported; }
@@ -284,6 +287,7 @@ class HWCDisplay : public DisplayEventHandler {
   DisplayClass GetDisplayClass();
   int GetVisibleDisplayRect(Rect *rect);
   void BuildLayerStack(void);
+  void BuildLayer(HWCLayer *hwc_layer);
   void BuildSolidFillStack(void);
   HWCLayer *GetHWCLayer(LayerId layer_id);
   uint32_t GetGeometryChanges() { return geometry_changes_; }
@@ -342,6 +346,12 @@ class HWCDisplay : public DisplayEventHandler {
   virtual HWC3::Error UpdateDisplayId(Display id) { return HWC3::Error::Unsupported; }
   virtual HWC3::Error SetPendingRefresh() { return HWC3::Error::Unsupported; }
   virtual HWC3::Error SetPanelBrightness(float brightness) { return HWC3::Error::Unsupported; }
+  // Ramp brightness to the target over duration_ms, one step per commit on the commit
+  // thread, instead of one client call per step. Curve: 0 = linear, 1 = ease-in-out.
+  virtual HWC3::Error SetPanelBrightnessAnimated(float brightness, uint32_t duration_ms,
+                                                 uint32_t curve) {
+    return HWC3::Error::Unsupported;
+  }
   virtual HWC3::Error GetPanelBrightness(float *brightness) { return HWC3::Error::Unsupported; }
   virtual HWC3::Error GetPanelMaxBrightness(uint32_t *max_brightness_level) {
     return HWC3::Error::Unsupported;
@@ -384,6 +394,7 @@ class HWCDisplay : public DisplayEventHandler {
   virtual DisplayError ControlIdlePowerCollapse(bool enable, bool synchronous) {
     return kErrorNone;
   }
+  virtual DisplayError HandleAppLaunchHint() { return kErrorNotSupported; }
   virtual HWC3::Error GetDisplayIdentificationData(uint8_t *out_port, uint32_t *out_data_size,
                                                    uint8_t *out_data);
   virtual HWC3::Error SetBLScale(uint32_t level) { return HWC3::Error::Unsupported; }
@@ -420,6 +431,8 @@ class HWCDisplay : public DisplayEventHandler {
   virtual HWC3::Error CommitOrPrepare(bool validate_only, shared_ptr<Fence> *out_retire_fence,
                                       uint32_t *out_num_types, uint32_t *out_num_requests,
                                       bool *needs_commit);
+  // Warms the composition strategy for the pending frame; see HWCSession::KickSpeculativePrepare.
+  void SpeculatePrepare();
   virtual HWC3::Error PreValidateDisplay(bool *exit_validate) { return HWC3::Error::None; }
   HWC3::Error TryDrawMethod(DrawMethod client_drawMethod);
   virtual HWC3::Error SetAlternateDisplayConfig(bool set) { return HWC3::Error::Unsupported; }
@@ -457,12 +470,14 @@ class HWCDisplay : public DisplayEventHandler {
   virtual DisplayError HandleQsyncState(const QsyncEventData &qsync_data);
   virtual void NotifyCwbDone(int32_t status, const LayerBuffer &buffer);
   virtual void DumpOutputBuffer(const BufferInfo &buffer_info, void *base,
-                                shared_ptr<Fence> &retire_fence);
+                                shared_ptr<Fence> &buffer_fence);
   virtual HWC3::Error PrepareLayerStack(uint32_t *out_num_types, uint32_t *out_num_requests);
   virtual HWC3::Error CommitLayerStack(void);
   virtual HWC3::Error PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence);
   virtual DisplayError DisablePartialUpdateOneFrame() { return kErrorNotSupported; }
   virtual void ReqPerfHintRelease() { return; }
+  // Frame-drop cause counters; cause_counts must hold kDropCauseCount entries.
+  void GetFrameDropStats(uint64_t *total_frames, uint64_t *late_frames, uint64_t *cause_counts);
   const char *GetDisplayString();
   void MarkLayersForGPUBypass(void);
   void MarkLayersForClientComposition(void);
@@ -499,13 +514,40 @@ class HWCDisplay : public DisplayEventHandler {
   void DumpInputBuffers(void);
   void RetrieveFences(shared_ptr<Fence> *out_retire_fence);
   void SetDrawMethod();
+  void ApplyCommitQueueDepth();
+  void RecordFrameDropSignals();
 
   // CWB related methods
   void HandleFrameOutput();
   void HandleFrameDump();
   virtual void HandleFrameCapture(){};
 
+  // Layer pool methods. Destroyed layers are kept as raw slabs and reconstructed in place on
+  // the next CreateLayer, so layer churn recycles memory instead of hitting the allocator.
+  HWCLayer *AllocateLayer();
+  void RecycleLayer(HWCLayer *layer);
+  void DrainLayerPool();
+
   bool layer_stack_invalid_ = true;
+  // Frame-level inputs captured at the last stack build; a change forces every layer to be
+  // re-derived instead of only the dirty ones.
+  bool built_client_target_null_ = true;
+  bool built_swap_interval_zero_ = false;
+  // Set when layer flags are overridden outside of BuildLayer(), e.g. when layers are marked
+  // for client composition after the stack was built.
+  bool force_full_stack_rebuild_ = false;
+  // Validate/commit/post-commit latency histograms, surfaced through Dump().
+  HWCFrameLatencyStats latency_stats_;
+  // Late-frame cause attribution, surfaced through Dump() and GET_FRAME_DROP_STATS.
+  HWCFrameDropClassifier frame_drop_stats_;
+  nsecs_t last_validate_ns_ = 0;      // duration of this frame's prepare
+  nsecs_t last_commit_ns_ = 0;        // duration of this frame's commit
+  nsecs_t last_present_time_ = 0;     // post-commit timestamp of the previous presented frame
+  // Monotonic timestamp sampled once at the entry of each frame phase (active-config check,
+  // prepare, commit, post-commit). In-frame consumers reuse it instead of issuing their own
+  // clock reads. Not valid outside the frame path - binder-callable paths must read the clock
+  // directly, as the snapshot can be arbitrarily stale on an idle display.
+  nsecs_t frame_time_ = 0;
   CoreInterface *core_intf_ = nullptr;
   HWCBufferAllocator *buffer_allocator_ = NULL;
   HWCCallbacks *callbacks_ = nullptr;
@@ -517,7 +559,10 @@ class HWCDisplay : public DisplayEventHandler {
   LayerStack layer_stack_;
   HWCLayer *client_target_ = nullptr;                   // Also known as framebuffer target
   std::map<LayerId, HWCLayer *> layer_map_;             // Look up by Id - TODO
-  std::multiset<HWCLayer *, SortLayersByZ> layer_set_;  // Maintain a set sorted by Z
+  SortedLayerSet layer_set_;                            // Maintain a set sorted by Z
+  static const uint32_t kLayerPoolMaxSize = 32;
+  std::vector<void *> layer_pool_;       // Recycled HWCLayer slabs, reconstructed on reuse
+  std::vector<Layer *> sdm_layer_pool_;  // Recycled SDM layers detached from pooled slabs
   std::map<LayerId, Composition> layer_changes_;
   std::map<LayerId, int32_t> layer_requests_;
   bool flush_on_error_ = false;
@@ -525,6 +570,17 @@ class HWCDisplay : public DisplayEventHandler {
   PowerMode current_power_mode_ = PowerMode::OFF;
   PowerMode pending_power_mode_ = PowerMode::OFF;
   bool swap_interval_zero_ = false;
+  // Return the frame retire fence as the release fence of device-composed layers, so the AIDL
+  // layer hands those entries a dup of the single per-frame present fence instead of creating
+  // a merged sync fence per layer.
+  bool speculate_retire_release_ = false;
+  // Lazy vsync gating: a disable request leaves the kernel vsync event on for the linger window
+  // and is cancelled outright if the client re-enables within it, so an idle exit skips the
+  // event re-registration latency. Guarded by vsync_linger_mutex_ against the event thread.
+  uint32_t vsync_disable_linger_ms_ = 0;  // VSYNC_DISABLE_LINGER_MS property, 0 disables eagerly
+  bool vsync_disable_pending_ = false;
+  nsecs_t vsync_disable_time_ = 0;
+  std::mutex vsync_linger_mutex_;
   bool display_paused_ = false;
   uint32_t min_refresh_rate_ = 0;
   uint32_t max_refresh_rate_ = 0;
@@ -581,6 +637,7 @@ class HWCDisplay : public DisplayEventHandler {
   uint32_t dump_input_frame_count_ = 0;  // tracks input frames count which to be dump
   uint32_t dump_input_frame_index_ = 0;  // tracks current input frame index which to be dump
   bool dump_input_layers_ = false;
+  HWCFrameDumper *frame_dumper_ = nullptr;  // async input buffer dump worker, created on demand
   BufferInfo output_buffer_info_ = {};
   void *output_buffer_base_ = nullptr;  // points to base address of output_buffer_info_
   CwbConfig output_buffer_cwb_config_ = {};
@@ -594,6 +651,16 @@ class HWCDisplay : public DisplayEventHandler {
   shared_ptr<Fence> client_acquire_fence_ = nullptr;
   int32_t client_dataspace_ = 0;
   Region client_damage_region_ = {};
+  // Client target buffer-age tracking: surface damage from the framework is relative to the
+  // previously presented frame, but the client target buffer cycles through a ring and its stale
+  // content dates back to when that same buffer was last presented. The ring below keeps the
+  // per-frame damage union so the dirty region programmed for a reused buffer can be widened to
+  // cover every frame it missed; when a buffer's age exceeds the history the framework damage is
+  // passed through untouched.
+  static const uint32_t kClientTargetDamageHistory = 8;
+  LayerRect client_target_damage_ring_[kClientTargetDamageHistory] = {};
+  uint64_t client_target_frame_seq_ = 0;  // frames seen through SetClientTarget()
+  std::map<uint64_t, uint64_t> client_target_buffer_seq_ = {};  // buffer id -> last frame seq
   std::map<uint64_t, CWBClient> cwb_buffer_map_ = {};
   std::mutex cwb_mutex_;
   std::condition_variable cwb_cv_;
@@ -41,6 +41,7 @@
 #include <utils/utils.h>
 #include <stdarg.h>
 #include <sys/mman.h>
+#include <cmath>
 
 #include <map>
 #include <string>
@@ -142,6 +143,14 @@ int HWCDisplayBuiltIn::Init() {
     DLOGI("Drop redundant drawcycles %" PRIu64, id_);
   }
 
+  value = 0;
+  HWCDebugHandler::Get()->GetProperty(IDLE_FLATTEN_FRAME_THRESHOLD, &value);
+  if (value > 0) {
+    idle_flatten_frame_threshold_ = UINT32(value);
+    DLOGI("Flatten static stack after %u stable frames %" PRIu64, idle_flatten_frame_threshold_,
+          id_);
+  }
+
   int vsyncs = 0;
   HWCDebugHandler::Get()->GetProperty(TRANSIENT_FPS_CYCLE_COUNT, &vsyncs);
   if (vsyncs > 0) {
@@ -193,6 +202,20 @@ int HWCDisplayBuiltIn::Init() {
   enhance_idle_time_ = (enhance_idle_time == 1);
   DLOGI("enhance_idle_time: %d", enhance_idle_time);
 
+  value = 0;
+  HWCDebugHandler::Get()->GetProperty(ENABLE_COMMIT_WINDOW_SCHEDULING, &value);
+  commit_window_scheduling_ = (value == 1);
+  if (commit_window_scheduling_) {
+    DLOGI("Commit window scheduling enabled %" PRIu64, id_);
+  }
+
+  value = 0;
+  HWCDebugHandler::Get()->GetProperty(HISTOGRAM_SAMPLING_RATE, &value);
+  if (value > 0) {
+    histogram.setSamplingRate(UINT32(value));
+    DLOGI("Histogram sampling decimated to %d samples/sec", value);
+  }
+
   LoadMixedModePerfHintThreshold();
 
   HWCDisplay::TryDrawMethod(DrawMethod::UNIFIED_DRAW);
@@ -281,10 +304,50 @@ HWC3::Error HWCDisplayBuiltIn::PreValidateDisplay(bool *exit_validate) {
 }
 
 HWC3::Error HWCDisplayBuiltIn::CommitLayerStack() {
+  StepBrightnessRamp();
   skip_commit_ = CanSkipCommit();
+  if (commit_window_scheduling_ && is_cmd_mode_ && !skip_commit_) {
+    WaitForCommitWindow();
+  }
   return HWCDisplay::CommitLayerStack();
 }
 
+DisplayError HWCDisplayBuiltIn::VSync(const DisplayEventVSync &vsync) {
+  last_vsync_timestamp_.store(vsync.timestamp);
+  return HWCDisplay::VSync(vsync);
+}
+
+void HWCDisplayBuiltIn::WaitForCommitWindow() {
+  // A command mode commit racing the TE it targets may miss latching and slip a full frame.
+  // If the commit is about to start just ahead of the predicted TE, hold it until the TE
+  // passes so the atomic commit lands at the start of the next window with the whole
+  // period available to latch.
+  VsyncPeriodNanos vsync_period = 0;
+  if (GetDisplayVsyncPeriod(&vsync_period) != HWC3::Error::None || !vsync_period) {
+    return;
+  }
+
+  nsecs_t last_vsync = last_vsync_timestamp_.load();
+  if (last_vsync <= 0) {
+    return;
+  }
+
+  nsecs_t period = static_cast<nsecs_t>(vsync_period);
+  nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - last_vsync;
+  // Vsync callbacks stop when the client disables them; don't extrapolate from a stale TE.
+  if (elapsed < 0 || elapsed > kMaxTePredictionPeriods * period) {
+    return;
+  }
+
+  nsecs_t time_to_te = period - (elapsed % period);
+  if (time_to_te > period / 10) {
+    return;
+  }
+
+  DTRACE_SCOPED();
+  usleep(UINT32((time_to_te + kTeGuardNs) / 1000));
+}
+
 bool HWCDisplayBuiltIn::CanSkipCommit() {
   if (layer_stack_invalid_) {
     return false;
@@ -378,12 +441,14 @@ HWC3::Error HWCDisplayBuiltIn::SetPowerMode(PowerMode mode, bool teardown) {
       case PowerMode::DOZE_SUSPEND:
         // Perf hal doesn't differentiate b/w doze and doze-suspend, so send doze hint for both.
         cpu_hint_->ReqEvent(kPerfHintDisplayDoze);
+        cpu_hint_->ReleaseSchedulingHints();
         break;
       case PowerMode::ON:
         cpu_hint_->ReqEvent(kPerfHintDisplayOn);
         break;
       case PowerMode::OFF:
         cpu_hint_->ReqEvent(kPerfHintDisplayOff);
+        cpu_hint_->ReleaseSchedulingHints();
         break;
       default:
         break;
@@ -450,6 +515,9 @@ void HWCDisplayBuiltIn::PostCommitStitchLayers() {
     LayerBuffer &input_buffer = layer->input_buffer;
     input_buffer.release_fence = output_buffer.acquire_fence;
   }
+
+  stitch_frame_count_++;
+  TrimStitchCache();
 }
 
 HWC3::Error HWCDisplayBuiltIn::GetColorModes(uint32_t *out_num_modes, ColorMode *out_modes) {
@@ -949,6 +1017,9 @@ HWC3::Error HWCDisplayBuiltIn::SetDisplayedContentSamplingEnabledVndService(bool
     display_intf_->colorSamplingOff();
     histogram.stop();
   }
+  // The sampling config takes effect on the next commit; ride along with the next natural
+  // frame rather than forcing one, but do not wait forever on an idle screen.
+  callbacks_->Refresh(id_, HWCCallbacks::kRefreshDeferrable, 0);
   return HWC3::Error::None;
 }
 
@@ -973,6 +1044,7 @@ HWC3::Error HWCDisplayBuiltIn::SetDisplayedContentSamplingEnabled(bool enabled,
     display_intf_->colorSamplingOff();
     histogram.stop();
   }
+  callbacks_->Refresh(id_, HWCCallbacks::kRefreshDeferrable, 0);
   return HWC3::Error::None;
 }
 
@@ -1025,6 +1097,15 @@ DisplayError HWCDisplayBuiltIn::ControlIdlePowerCollapse(bool enable, bool synch
   return error;
 }
 
+DisplayError HWCDisplayBuiltIn::HandleAppLaunchHint() {
+  DisplayError error = kErrorNotSupported;
+
+  if (display_intf_) {
+    error = display_intf_->HandleAppLaunchHint();
+  }
+  return error;
+}
+
 DisplayError HWCDisplayBuiltIn::SetJitterConfig(uint32_t jitter_type, float value, uint32_t time) {
   DisplayError error = display_intf_->SetJitterConfig(jitter_type, value, time);
   if (error != kErrorNone) {
@@ -1077,7 +1158,17 @@ HWC3::Error HWCDisplayBuiltIn::SetPendingRefresh() {
 }
 
 HWC3::Error HWCDisplayBuiltIn::SetPanelBrightness(float brightness) {
-  DisplayError ret = display_intf_->SetPanelBrightness(brightness);
+  {
+    // An explicit set overrides a running ramp.
+    std::lock_guard<std::mutex> lock(brightness_ramp_lock_);
+    brightness_ramp_active_ = false;
+  }
+
+  // Remember the client-requested level so the content-adaptive scale from the histogram
+  // consumer can be applied on top of it (and re-applied when the decision changes).
+  user_brightness_ = brightness;
+  float target = (brightness < 0.0f) ? brightness : brightness * histogram_backlight_scale_;
+  DisplayError ret = display_intf_->SetPanelBrightness(target);
   if (ret != kErrorNone) {
     return HWC3::Error::NoResources;
   }
@@ -1085,6 +1176,68 @@ HWC3::Error HWCDisplayBuiltIn::SetPanelBrightness(float brightness) {
   return HWC3::Error::None;
 }
 
+HWC3::Error HWCDisplayBuiltIn::SetPanelBrightnessAnimated(float brightness, uint32_t duration_ms,
+                                                          uint32_t curve) {
+  // Ramping to or from off makes no sense; treat those as an immediate set.
+  if (!duration_ms || brightness < 0.0f || user_brightness_ < 0.0f) {
+    return SetPanelBrightness(brightness);
+  }
+
+  if (brightness > 1.0f) {
+    DLOGE("Bad brightness value = %f", brightness);
+    return HWC3::Error::BadParameter;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(brightness_ramp_lock_);
+    brightness_ramp_start_ = user_brightness_;
+    brightness_ramp_target_ = brightness;
+    brightness_ramp_start_time_ = systemTime(SYSTEM_TIME_MONOTONIC);
+    brightness_ramp_duration_ = ms2ns(static_cast<nsecs_t>(duration_ms));
+    brightness_ramp_curve_ = curve;
+    brightness_ramp_active_ = true;
+  }
+
+  // First step lands with the next commit.
+  callbacks_->Refresh(id_);
+
+  return HWC3::Error::None;
+}
+
+void HWCDisplayBuiltIn::StepBrightnessRamp() {
+  float value = 0.0f;
+  bool done = false;
+  {
+    std::lock_guard<std::mutex> lock(brightness_ramp_lock_);
+    if (!brightness_ramp_active_) {
+      return;
+    }
+
+    nsecs_t elapsed = systemTime(SYSTEM_TIME_MONOTONIC) - brightness_ramp_start_time_;
+    float pos = 1.0f;
+    if (elapsed >= brightness_ramp_duration_) {
+      brightness_ramp_active_ = false;
+      done = true;
+    } else {
+      pos = static_cast<float>(elapsed) / static_cast<float>(brightness_ramp_duration_);
+      if (brightness_ramp_curve_ == 1) {
+        pos = pos * pos * (3.0f - (2.0f * pos));  // smoothstep ease-in-out
+      }
+    }
+    value = brightness_ramp_start_ + ((brightness_ramp_target_ - brightness_ramp_start_) * pos);
+  }
+
+  // The dal layer caches the level into the connector property, so the write below
+  // is carried by the atomic commit this step runs ahead of.
+  user_brightness_ = value;
+  display_intf_->SetPanelBrightness(value * histogram_backlight_scale_);
+
+  if (!done) {
+    // Keep draw cycles coming until the ramp lands, even on an otherwise idle screen.
+    callbacks_->Refresh(id_);
+  }
+}
+
 HWC3::Error HWCDisplayBuiltIn::GetPanelBrightness(float *brightness) {
   DisplayError ret = display_intf_->GetPanelBrightness(brightness);
   if (ret != kErrorNone) {
@@ -1146,6 +1299,9 @@ HWC3::Error HWCDisplayBuiltIn::SetClientTarget(buffer_handle_t target,
                              sdm_layer->input_buffer.unaligned_height)) {
       return HWC3::Error::BadParameter;
     }
+    // Follow the new geometry with a matching stitch target; a cached orientation is revived
+    // without hitting the allocator.
+    ReconfigureStitchTarget();
   }
 
   return HWC3::Error::None;
@@ -1191,6 +1347,13 @@ int HWCDisplayBuiltIn::Deinit() {
     layer_stitch_task_.PerformTask(LayerStitchTaskCode::kCodeDestroyInstance, nullptr);
   }
 
+  for (uint32_t i = 0; i < kStitchCacheSize; i++) {
+    if (stitch_cache_[i].valid) {
+      buffer_allocator_->FreeBuffer(&stitch_cache_[i].info);
+      stitch_cache_[i] = {};
+    }
+  }
+
   histogram.stop();
   return HWCDisplay::Deinit();
 }
@@ -1309,6 +1472,79 @@ void HWCDisplayBuiltIn::InitStitchTarget() {
   sdm_stitch_target->input_buffer.buffer_id = reinterpret_cast<uint64_t>(buffer_info_.private_data);
 }
 
+bool HWCDisplayBuiltIn::ReconfigureStitchTarget() {
+  if (disable_layer_stitch_ || !stitch_target_) {
+    return true;
+  }
+
+  DisplayError error = display_intf_->GetFrameBufferConfig(&fb_config_);
+  if (error != kErrorNone) {
+    DLOGE("Get frame buffer config failed. Error = %d", error);
+    return false;
+  }
+
+  uint32_t width = fb_config_.x_pixels;
+  uint32_t height = fb_config_.y_pixels * kBufferHeightFactor;
+  BufferConfig &config = buffer_info_.buffer_config;
+  if (config.width == width && config.height == height) {
+    return true;
+  }
+
+  DTRACE_SCOPED();
+
+  // Retire the current buffer into the cache instead of freeing it; the other orientation of
+  // a rotation animation will come right back asking for it.
+  StitchBufferSlot *retire_slot = &stitch_cache_[0];
+  for (uint32_t i = 0; i < kStitchCacheSize; i++) {
+    if (!stitch_cache_[i].valid) {
+      retire_slot = &stitch_cache_[i];
+      break;
+    }
+    if (stitch_cache_[i].retire_frame < retire_slot->retire_frame) {
+      retire_slot = &stitch_cache_[i];
+    }
+  }
+  if (retire_slot->valid) {
+    buffer_allocator_->FreeBuffer(&retire_slot->info);
+  }
+  retire_slot->info = buffer_info_;
+  retire_slot->valid = true;
+  retire_slot->retire_frame = stitch_frame_count_;
+
+  // Revive a cached buffer with the new dimensions, or allocate on first sight of them.
+  bool revived = false;
+  for (uint32_t i = 0; i < kStitchCacheSize; i++) {
+    StitchBufferSlot &slot = stitch_cache_[i];
+    if (slot.valid && slot.info.buffer_config.width == width &&
+        slot.info.buffer_config.height == height) {
+      buffer_info_ = slot.info;
+      slot = {};
+      revived = true;
+      break;
+    }
+  }
+  if (!revived) {
+    buffer_info_ = {};
+    if (!AllocateStitchBuffer()) {
+      return false;
+    }
+  }
+
+  InitStitchTarget();
+  return true;
+}
+
+void HWCDisplayBuiltIn::TrimStitchCache() {
+  for (uint32_t i = 0; i < kStitchCacheSize; i++) {
+    StitchBufferSlot &slot = stitch_cache_[i];
+    if (slot.valid && (stitch_frame_count_ - slot.retire_frame) > kStitchTrimFrames) {
+      // Geometry settled long ago; give the unused orientation back.
+      buffer_allocator_->FreeBuffer(&slot.info);
+      slot = {};
+    }
+  }
+}
+
 void HWCDisplayBuiltIn::AppendStitchLayer() {
   if (disable_layer_stitch_) {
     return;
@@ -1409,6 +1645,17 @@ HWC3::Error HWCDisplayBuiltIn::PostCommitLayerStack(shared_ptr<Fence> *out_retir
   HandleFrameOutput();
   PostCommitStitchLayers();
 
+  // Apply the histogram consumer's dimming decision. One backlight step is ~1/255, so smaller
+  // moves are not worth reprogramming the panel for.
+  float scale = 1.0f;
+  if (histogram.getBacklightScale(&scale) &&
+      std::fabs(scale - histogram_backlight_scale_) > (1.0f / 255.0f)) {
+    histogram_backlight_scale_ = scale;
+    if (user_brightness_ >= 0.0f) {
+      display_intf_->SetPanelBrightness(user_brightness_ * histogram_backlight_scale_);
+    }
+  }
+
   auto status = HWCDisplay::PostCommitLayerStack(out_retire_fence);
   /*  display_intf_->GetConfig(&fixed_info);
     is_cmd_mode_ = fixed_info.is_cmdmode;
@@ -1424,6 +1671,10 @@ HWC3::Error HWCDisplayBuiltIn::PostCommitLayerStack(shared_ptr<Fence> *out_retir
 
   pending_commit_ = false;
 
+  if (idle_flatten_frame_threshold_) {
+    HandleIdleFlattening();
+  }
+
   if (layer_stack_.request_flags.trigger_refresh) {
     callbacks_->Refresh(id_);
   }
@@ -1431,6 +1682,29 @@ HWC3::Error HWCDisplayBuiltIn::PostCommitLayerStack(shared_ptr<Fence> *out_retir
   return status;
 }
 
+void HWCDisplayBuiltIn::HandleIdleFlattening() {
+  bool stack_static = !layer_stack_.flags.geometry_changed && !GetUpdatingAppLayersCount();
+  if (!stack_static) {
+    stable_frame_count_ = 0;
+    idle_flattening_triggered_ = false;
+    return;
+  }
+
+  if (idle_flattening_triggered_) {
+    return;
+  }
+
+  if (++stable_frame_count_ < idle_flatten_frame_threshold_) {
+    return;
+  }
+
+  // Stack has been stable for the configured run of frames. Flatten it through the idle
+  // fallback path now rather than waiting out the idle timer.
+  if (display_intf_->TriggerIdleFlattening() == kErrorNone) {
+    idle_flattening_triggered_ = true;
+  }
+}
+
 bool HWCDisplayBuiltIn::IsDisplayIdle() {
   // Notify only if this display is source of vsync.
   bool vsync_source = (callbacks_->GetVsyncSource() == id_);
@@ -1476,9 +1750,18 @@ HWC3::Error HWCDisplayBuiltIn::CommitOrPrepare(bool validate_only,
                                                bool *needs_commit) {
   DTRACE_SCOPED();
 
+  if (cpu_hint_) {
+    cpu_hint_->BeginFrame();
+  }
+
   auto status = HWCDisplay::CommitOrPrepare(validate_only, out_retire_fence, out_num_types,
                                             out_num_requests, needs_commit);
 
+  if (cpu_hint_) {
+    uint32_t fps = active_refresh_rate_ ? active_refresh_rate_ : 60;
+    cpu_hint_->EndFrame(s2ns(1) / fps);
+  }
+
   if (perf_hint_large_comp_cycle_) {
     bool needs_hint = NeedsLargeCompPerfHint();
     HandleLargeCompositionHint(!needs_hint);
@@ -1657,6 +1940,7 @@ void HWCDisplayBuiltIn::ReqPerfHintRelease() {
     return;
   }
   cpu_hint_->ReqHintRelease();
+  cpu_hint_->ReleaseSchedulingHints();
 }
 
 }  // namespace sdm
@@ -37,6 +37,7 @@
 #ifndef __HWC_DISPLAY_BUILTIN_H__
 #define __HWC_DISPLAY_BUILTIN_H__
 
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -111,6 +112,7 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   virtual DisplayError SetBppMode(uint32_t bpp);
   virtual HWC3::Error SetQSyncMode(QSyncMode qsync_mode);
   virtual DisplayError ControlIdlePowerCollapse(bool enable, bool synchronous);
+  virtual DisplayError HandleAppLaunchHint();
   virtual HWC3::Error SetDisplayDppsAdROI(uint32_t h_start, uint32_t h_end, uint32_t v_start,
                                           uint32_t v_end, uint32_t factor_in, uint32_t factor_out);
   virtual DisplayError SetJitterConfig(uint32_t jitter_type, float value, uint32_t time);
@@ -120,6 +122,8 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   virtual HWC3::Error UpdateDisplayId(Display id);
   virtual HWC3::Error SetPendingRefresh();
   virtual HWC3::Error SetPanelBrightness(float brightness);
+  virtual HWC3::Error SetPanelBrightnessAnimated(float brightness, uint32_t duration_ms,
+                                                 uint32_t curve);
   virtual HWC3::Error GetPanelBrightness(float *brightness);
   virtual HWC3::Error GetPanelMaxBrightness(uint32_t *max_brightness_level);
   virtual HWC3::Error SetFrameTriggerMode(uint32_t mode);
@@ -171,6 +175,8 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   uint32_t GetOptimalRefreshRate(bool one_updating_layer);
   virtual void HandleFrameCapture();
   bool CanSkipCommit();
+  virtual DisplayError VSync(const DisplayEventVSync &vsync);
+  void WaitForCommitWindow();
   DisplayError SetMixerResolution(uint32_t width, uint32_t height);
   DisplayError GetMixerResolution(uint32_t *width, uint32_t *height);
   HWC3::Error CommitStitchLayers();
@@ -178,6 +184,8 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   bool InitLayerStitch();
   void InitStitchTarget();
   bool AllocateStitchBuffer();
+  bool ReconfigureStitchTarget();
+  void TrimStitchCache();
   void PostCommitStitchLayers();
   bool NeedsLargeCompPerfHint();
   void ValidateUiScaling();
@@ -186,6 +194,8 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   void LoadMixedModePerfHintThreshold();
   void HandleLargeCompositionHint(bool release);
   void ReqPerfHintRelease();
+  void HandleIdleFlattening();
+  void StepBrightnessRamp();
 
   // SyncTask methods.
   void OnTask(const LayerStitchTaskCode &task_code,
@@ -200,6 +210,11 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
 
   bool pending_refresh_ = true;
   bool enable_optimize_refresh_ = false;
+  // Members for TE aligned commit scheduling in command mode
+  static const nsecs_t kMaxTePredictionPeriods = 4;  // beyond this the TE estimate is stale
+  static const nsecs_t kTeGuardNs = 200000;  // land commits this far past the predicted TE
+  bool commit_window_scheduling_ = false;
+  std::atomic<nsecs_t> last_vsync_timestamp_ = {0};
   bool enable_poms_during_doze_ = false;
 
   bool is_primary_ = false;
@@ -209,12 +224,36 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   GLLayerStitch *gl_layer_stitch_ = nullptr;
   BufferInfo buffer_info_ = {};
   DisplayConfigVariableInfo fb_config_ = {};
+  // Retired stitch buffers kept alive across geometry flips. Rotation animations swap the
+  // framebuffer dimensions every few frames; a cached buffer with matching dimensions is
+  // revived without touching the allocator, and unused orientations are trimmed once the
+  // animation has settled.
+  static const uint32_t kStitchCacheSize = 2;
+  static const uint32_t kStitchTrimFrames = 600;
+  struct StitchBufferSlot {
+    BufferInfo info = {};
+    bool valid = false;
+    uint64_t retire_frame = 0;
+  };
+  StitchBufferSlot stitch_cache_[kStitchCacheSize];
+  uint64_t stitch_frame_count_ = 0;
 
   bool qsync_enabled_ = false;
   bool qsync_reconfigured_ = false;
   // Members for Color sampling feature
   DisplayError HistogramEvent(int fd, uint32_t blob_id) override;
   histogram::HistogramCollector histogram;
+  // Content-adaptive dimming from the in-process histogram consumer plug-in.
+  float user_brightness_ = -1.0f;          // last client-requested level, before scaling
+  float histogram_backlight_scale_ = 1.0f;
+  // Commit-synchronized brightness ramp; see SetPanelBrightnessAnimated().
+  std::mutex brightness_ramp_lock_;
+  bool brightness_ramp_active_ = false;
+  float brightness_ramp_start_ = 0.0f;
+  float brightness_ramp_target_ = 0.0f;
+  nsecs_t brightness_ramp_start_time_ = 0;
+  nsecs_t brightness_ramp_duration_ = 0;
+  uint32_t brightness_ramp_curve_ = 0;
   std::mutex sampling_mutex;
   bool api_sampling_vote = false;
   bool vndservice_sampling_vote = false;
@@ -224,6 +263,10 @@ class HWCDisplayBuiltIn : public HWCDisplay, public SyncTask<LayerStitchTaskCode
   bool disable_dyn_fps_ = false;
   bool enable_round_corner_ = false;
   bool enhance_idle_time_ = false;
+  // Members for idle flattening via CWB
+  uint32_t idle_flatten_frame_threshold_ = 0;
+  uint32_t stable_frame_count_ = 0;
+  bool idle_flattening_triggered_ = false;
   shared_ptr<Fence> retire_fence_ = nullptr;
   std::unordered_map<int32_t, int32_t> mixed_mode_threshold_;
   int alternate_config_ = -1;
@@ -41,7 +41,7 @@ namespace sdm {
 
 class HWCDisplayEventHandler {
  public:
-  virtual void DisplayPowerReset() = 0;
+  virtual void DisplayPowerReset(Display display) = 0;
   virtual void PerformQsyncCallback(Display display, bool qsync_enabled, uint32_t refresh_rate,
                                     uint32_t qsync_refresh_rate) = 0;
   virtual void VmReleaseDone(Display display) = 0;
@@ -101,13 +101,90 @@ int HWCDisplayPluggable::Init() {
     return status;
   }
   color_mode_ = new HWCColorMode(display_intf_);
-  color_mode_->Init();
+
+  // Phase two of hotplug handling. Color capability probing takes one round trip to the
+  // color manager per mode and is not needed to announce the display, so run it in the
+  // background and let the hotplug callback go out immediately. Every entry point that
+  // consumes color_mode_ joins the probe first via WaitForColorModesProbe().
+  color_modes_probe_ = std::async(std::launch::async, [this]() { color_mode_->Init(); });
+
+  // Negotiate HDR capabilities once per hotplug; this object is recreated on every connect.
+  CacheHdrCapabilities();
 
   HWCDisplay::TryDrawMethod(DrawMethod::UNIFIED_DRAW);
 
   return status;
 }
 
+void HWCDisplayPluggable::CacheHdrCapabilities() {
+  DisplayConfigFixedInfo fixed_info = {};
+  display_intf_->GetConfig(&fixed_info);
+
+  hdr_caps_.hdr_supported = fixed_info.hdr_supported;
+  if (!fixed_info.hdr_supported) {
+    DLOGI("HDR is not supported");
+    return;
+  }
+
+  uint32_t num_types = 0;
+  if (fixed_info.hdr_plus_supported) {
+    hdr_caps_.types[num_types++] = static_cast<int32_t>(Hdr::HDR10_PLUS);
+  }
+  if (fixed_info.dolby_vision_supported) {
+    hdr_caps_.types[num_types++] = static_cast<int32_t>(Hdr::DOLBY_VISION);
+  }
+  hdr_caps_.types[num_types++] = static_cast<int32_t>(Hdr::HDR10);
+  hdr_caps_.types[num_types++] = static_cast<int32_t>(Hdr::HLG);
+  hdr_caps_.num_types = num_types;
+
+  hdr_caps_.max_luminance = fixed_info.max_luminance;
+  hdr_caps_.max_average_luminance = fixed_info.average_luminance;
+  hdr_caps_.min_luminance = fixed_info.min_luminance;
+}
+
+HWC3::Error HWCDisplayPluggable::GetHdrCapabilities(uint32_t *out_num_types, int32_t *out_types,
+                                                    float *out_max_luminance,
+                                                    float *out_max_average_luminance,
+                                                    float *out_min_luminance) {
+  if (out_num_types == nullptr || out_max_luminance == nullptr ||
+      out_max_average_luminance == nullptr || out_min_luminance == nullptr) {
+    return HWC3::Error::BadParameter;
+  }
+
+  // Served from the hotplug-time snapshot; the framework re-queries this during mode
+  // transitions and must not contend with the commit path.
+  if (!hdr_caps_.hdr_supported) {
+    *out_num_types = 0;
+    return HWC3::Error::None;
+  }
+
+  if (out_types == nullptr) {
+    *out_num_types = hdr_caps_.num_types;
+  } else {
+    uint32_t max_out_types = std::min(*out_num_types, hdr_caps_.num_types);
+    for (uint32_t i = 0; i < max_out_types; i++) {
+      out_types[i] = hdr_caps_.types[i];
+    }
+    *out_max_luminance = hdr_caps_.max_luminance;
+    *out_max_average_luminance = hdr_caps_.max_average_luminance;
+    *out_min_luminance = hdr_caps_.min_luminance;
+  }
+
+  return HWC3::Error::None;
+}
+
+int HWCDisplayPluggable::Deinit() {
+  WaitForColorModesProbe();
+  return HWCDisplay::Deinit();
+}
+
+void HWCDisplayPluggable::WaitForColorModesProbe() {
+  if (color_modes_probe_.valid()) {
+    color_modes_probe_.wait();
+    color_modes_probe_ = {};
+  }
+}
+
 void HWCDisplayPluggable::Destroy(HWCDisplay *hwc_display) {
   // Flush the display to have outstanding fences signaled.
   hwc_display->Flush();
@@ -151,6 +228,7 @@ HWC3::Error HWCDisplayPluggable::PreValidateDisplay(bool *exit_validate) {
   }
 
   // Apply current Color Mode and Render Intent.
+  WaitForColorModesProbe();
   status = color_mode_->ApplyCurrentColorModeWithRenderIntent(
       static_cast<bool>(layer_stack_.flags.hdr_present));
   if (status != HWC3::Error::None || has_color_tranform_) {
@@ -274,6 +352,7 @@ DisplayError HWCDisplayPluggable::Flush() {
 }
 
 HWC3::Error HWCDisplayPluggable::GetColorModes(uint32_t *out_num_modes, ColorMode *out_modes) {
+  WaitForColorModesProbe();
   if (out_modes == nullptr) {
     *out_num_modes = color_mode_->GetColorModeCount();
   } else {
@@ -284,6 +363,7 @@ HWC3::Error HWCDisplayPluggable::GetColorModes(uint32_t *out_num_modes, ColorMod
 
 HWC3::Error HWCDisplayPluggable::GetRenderIntents(ColorMode mode, uint32_t *out_num_intents,
                                                   RenderIntent *out_intents) {
+  WaitForColorModesProbe();
   if (out_intents == nullptr) {
     *out_num_intents = color_mode_->GetRenderIntentCount(mode);
   } else {
@@ -297,6 +377,7 @@ HWC3::Error HWCDisplayPluggable::SetColorMode(ColorMode mode) {
 }
 
 HWC3::Error HWCDisplayPluggable::SetColorModeWithRenderIntent(ColorMode mode, RenderIntent intent) {
+  WaitForColorModesProbe();
   auto status = color_mode_->CacheColorModeWithRenderIntent(mode, intent);
   if (status != HWC3::Error::None) {
     DLOGE("failed for mode = %d intent = %d", mode, intent);
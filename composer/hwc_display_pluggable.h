@@ -37,6 +37,8 @@
 #ifndef __HWC_DISPLAY_PLUGGABLE_H__
 #define __HWC_DISPLAY_PLUGGABLE_H__
 
+#include <future>
+
 #include "hwc_display.h"
 #include "hwc_display_event_handler.h"
 
@@ -51,6 +53,7 @@ class HWCDisplayPluggable : public HWCDisplay {
                     HWCDisplay **hwc_display);
   static void Destroy(HWCDisplay *hwc_display);
   virtual int Init();
+  virtual int Deinit();
   virtual HWC3::Error Validate(uint32_t *out_num_types, uint32_t *out_num_requests);
   virtual HWC3::Error Present(shared_ptr<Fence> *out_retire_fence);
   virtual DisplayError Flush();
@@ -62,6 +65,10 @@ class HWCDisplayPluggable : public HWCDisplay {
   virtual HWC3::Error SetColorTransform(const float *matrix, android_color_transform_t hint);
   virtual HWC3::Error PreValidateDisplay(bool *exit_validate);
   virtual HWC3::Error PostCommitLayerStack(shared_ptr<Fence> *out_retire_fence);
+  virtual HWC3::Error GetHdrCapabilities(uint32_t *out_num_types, int32_t *out_types,
+                                         float *out_max_luminance,
+                                         float *out_max_average_luminance,
+                                         float *out_min_luminance);
 
  private:
   HWCDisplayPluggable(CoreInterface *core_intf, HWCBufferAllocator *buffer_allocator,
@@ -69,12 +76,29 @@ class HWCDisplayPluggable : public HWCDisplay {
                       qService::QService *qservice, Display id, int32_t sdm_id);
   void ApplyScanAdjustment(Rect *display_frame);
   void GetUnderScanConfig();
+  void WaitForColorModesProbe();
+  void CacheHdrCapabilities();
   static void GetDownscaleResolution(uint32_t primary_width, uint32_t primary_height,
                                      uint32_t *virtual_width, uint32_t *virtual_height);
 
+  // HDR capabilities negotiated once at hotplug. A pluggable display object lives exactly from
+  // connect to disconnect, so the snapshot stays immutable for the object's lifetime and
+  // GetHdrCapabilities() is served from it without a connector query or the display lock.
+  struct HdrCapabilities {
+    bool hdr_supported = false;
+    uint32_t num_types = 0;
+    int32_t types[4] = {};
+    float max_luminance = 0.0f;
+    float max_average_luminance = 0.0f;
+    float min_luminance = 0.0f;
+  };
+
   int underscan_width_ = 0;
   int underscan_height_ = 0;
   bool has_color_tranform_ = false;
+  HdrCapabilities hdr_caps_ = {};
+  // Phase two of hotplug handling; see Init().
+  std::future<void> color_modes_probe_ = {};
 };
 
 }  // namespace sdm
@@ -163,6 +163,8 @@ HWC3::Error HWCDisplayVirtualDPU::PreValidateDisplay(bool *exit_validate) {
       if (layer->input_buffer.flags.secure) {
         layer_stack_.flags.skip_present = true;
         layer->flags.skip = true;
+        // Skip flag was forced outside of BuildLayer(); re-derive all layers on the next build.
+        force_full_stack_rebuild_ = true;
       }
     }
   }
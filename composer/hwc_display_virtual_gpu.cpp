@@ -191,6 +191,17 @@ HWC3::Error HWCDisplayVirtualGPU::Present(shared_ptr<Fence> *out_retire_fence) {
     }
   }
 
+  // Skip-to-latest under backlog: if the previous frame's blit is still executing on the GPU,
+  // queueing another one would make the driver throttle this thread once its queue is deep —
+  // and this thread also serves the builtin display. Drop this frame instead; the sink keeps
+  // showing its previous frame and the next present composes the latest content.
+  if (prev_blit_release_fence_ && !Fence::TryWait(prev_blit_release_fence_)) {
+    blit_drop_count_++;
+    DLOGV_IF(kTagDisplay, "Blit backlog, dropping frame (%u dropped so far)", blit_drop_count_);
+    *out_retire_fence = prev_blit_release_fence_;
+    return status;
+  }
+
   ColorConvertBlitContext ctx = {};
 
   Layer *sdm_layer = client_target_->GetSDMLayer();
@@ -207,6 +218,7 @@ HWC3::Error HWCDisplayVirtualGPU::Present(shared_ptr<Fence> *out_retire_fence) {
   // todo blit
   DumpVDSBuffer();
 
+  prev_blit_release_fence_ = ctx.release_fence;
   *out_retire_fence = ctx.release_fence;
 
   return status;
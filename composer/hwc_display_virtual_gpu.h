@@ -93,6 +93,12 @@ class HWCDisplayVirtualGPU : public HWCDisplayVirtual,
 
   bool disable_animation_ = false;
   bool animation_in_progress_ = false;
+
+  // Bounded-latency policy for slow sinks: at most one blit may be pending on the GPU. If the
+  // previous frame's blit has not signaled when the next frame arrives, that frame is skipped
+  // so a backlogged sink can never queue GPU work behind the builtin display's composition.
+  shared_ptr<Fence> prev_blit_release_fence_ = nullptr;
+  uint32_t blit_drop_count_ = 0;
 };
 
 }  // namespace sdm
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <sys/prctl.h>
+#include <utils/debug.h>
+
+#include <utility>
+
+#include "hwc_frame_dumper.h"
+
+#define __CLASS__ "HWCFrameDumper"
+
+namespace sdm {
+
+HWCFrameDumper::HWCFrameDumper(HWCBufferAllocator *buffer_allocator)
+    : buffer_allocator_(buffer_allocator) {
+  dump_thread_ = std::thread(&HWCFrameDumper::DumpLoop, this);
+}
+
+HWCFrameDumper::~HWCFrameDumper() {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    exit_ = true;
+  }
+  cv_.notify_one();
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+
+  // Jobs still pending at teardown are dropped; release their buffer refs.
+  while (!queue_.empty()) {
+    ReleaseJob(&queue_.front());
+    queue_.pop();
+  }
+}
+
+bool HWCFrameDumper::Enqueue(FrameDumpJob *job) {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (queue_.size() >= kMaxPendingJobs) {
+      DLOGW("Dump queue full (%u pending), dropping frame %s", kMaxPendingJobs,
+            job->file_path.c_str());
+      ReleaseJob(job);
+      return false;
+    }
+    queue_.push(std::move(*job));
+  }
+  cv_.notify_one();
+  return true;
+}
+
+void HWCFrameDumper::DumpLoop() {
+  prctl(PR_SET_NAME, "frame_dump", 0, 0, 0);
+
+  while (true) {
+    FrameDumpJob job;
+    {
+      std::unique_lock<std::mutex> guard(lock_);
+      cv_.wait(guard, [this]() { return exit_ || !queue_.empty(); });
+      if (exit_) {
+        break;
+      }
+      job = std::move(queue_.front());
+      queue_.pop();
+    }
+
+    WriteJob(job);
+    ReleaseJob(&job);
+  }
+}
+
+void HWCFrameDumper::WriteJob(const FrameDumpJob &job) {
+  if (Fence::Wait(job.acquire_fence) != kErrorNone) {
+    DLOGW("sync_wait error errno = %d, desc = %s", errno, strerror(errno));
+    return;
+  }
+
+  void *base_ptr = NULL;
+  int error = buffer_allocator_->MapBuffer(job.handle, nullptr, &base_ptr);
+  if (error != 0) {
+    DLOGE("Failed to map buffer, error = %d", error);
+    return;
+  }
+
+  size_t result = 0;
+  if (base_ptr != nullptr) {
+    FILE *fp = fopen(job.file_path.c_str(), "w+");
+    if (fp) {
+      result = fwrite(base_ptr, job.alloc_size, 1, fp);
+      fclose(fp);
+    }
+  }
+
+  int release_fence = -1;
+  error = buffer_allocator_->UnmapBuffer(job.handle, &release_fence);
+  if (error != 0) {
+    DLOGE("Failed to unmap buffer, error = %d", error);
+  }
+
+  DLOGI("Frame Dump %s: is %s", job.file_path.c_str(), result ? "Successful" : "Failed");
+
+  if (job.metadata) {
+    result = 0;
+    FILE *fp = fopen(job.metadata_path.c_str(), "w+");
+    if (fp) {
+      result = fwrite(&job.metadata->metadataPayload, job.metadata->size, 1, fp);
+      fclose(fp);
+    }
+
+    DLOGI("Frame Metadata Dump %s: is %s", job.metadata_path.c_str(),
+          result ? "Successful" : "Failed");
+  }
+}
+
+void HWCFrameDumper::ReleaseJob(FrameDumpJob *job) {
+  if (job->handle) {
+    native_handle_close(job->handle);
+    native_handle_delete(job->handle);
+    job->handle = nullptr;
+  }
+}
+
+}  // namespace sdm
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HWC_FRAME_DUMPER_H__
+#define __HWC_FRAME_DUMPER_H__
+
+#include <cutils/native_handle.h>
+#include <core/layer_buffer.h>
+#include <utils/fence.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+
+#include "hwc_buffer_allocator.h"
+
+namespace sdm {
+
+// Deferred file dump of a single layer buffer. The handle is a clone owned by
+// the job; its dup'ed fds keep the underlying buffer alive until the worker
+// has written it out.
+struct FrameDumpJob {
+  native_handle_t *handle = nullptr;
+  shared_ptr<Fence> acquire_fence = nullptr;
+  uint32_t alloc_size = 0;
+  std::string file_path = "";
+  std::shared_ptr<CustomContentMetadata> metadata = nullptr;
+  std::string metadata_path = "";
+};
+
+// Performs fence wait, buffer mapping and file I/O for frame dumps on a
+// background thread so that enabling dumps does not stall the commit path.
+// The queue is bounded; when the worker falls behind, new frames are dropped
+// with a log rather than blocking composition.
+class HWCFrameDumper {
+ public:
+  explicit HWCFrameDumper(HWCBufferAllocator *buffer_allocator);
+  ~HWCFrameDumper();
+
+  // Takes ownership of job.handle. Returns false if the job was dropped
+  // because the queue is full.
+  bool Enqueue(FrameDumpJob *job);
+
+ private:
+  static const uint32_t kMaxPendingJobs = 16;
+
+  void DumpLoop();
+  void WriteJob(const FrameDumpJob &job);
+  static void ReleaseJob(FrameDumpJob *job);
+
+  HWCBufferAllocator *buffer_allocator_ = nullptr;
+  std::thread dump_thread_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  std::queue<FrameDumpJob> queue_;
+  bool exit_ = false;
+};
+
+}  // namespace sdm
+
+#endif  // __HWC_FRAME_DUMPER_H__
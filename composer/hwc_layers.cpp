@@ -28,6 +28,8 @@
 #include "hwc_debugger.h"
 #include <utils/debug.h>
 #include <stdint.h>
+#include <algorithm>
+#include <array>
 #include <utility>
 #include <cmath>
 #include <gr_utils.h>
@@ -43,6 +45,118 @@ namespace sdm {
 
 std::atomic<LayerId> HWCLayer::next_id_(1);
 
+namespace {
+
+inline void HashBytes(const void *data, uint32_t size, uint64_t *hash) {
+  const uint8_t *bytes = static_cast<const uint8_t *>(data);
+  for (uint32_t i = 0; i < size; i++) {
+    *hash = (*hash ^ bytes[i]) * 0x100000001B3ULL;  // FNV-1a
+  }
+}
+
+// Content hash over the fields ValidateAndSetCSC() compares, so an unchanged fetch can skip
+// the compare-and-copy cascade.
+uint64_t GetColorMetadataHash(const ColorMetaData &metadata) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  HashBytes(&metadata.colorPrimaries, sizeof(metadata.colorPrimaries), &hash);
+  HashBytes(&metadata.transfer, sizeof(metadata.transfer), &hash);
+  HashBytes(&metadata.range, sizeof(metadata.range), &hash);
+  HashBytes(&metadata.matrixCoefficients, sizeof(metadata.matrixCoefficients), &hash);
+  HashBytes(&metadata.masteringDisplayInfo, sizeof(MasteringDisplay), &hash);
+  HashBytes(&metadata.contentLightLevel, sizeof(ContentLightLevel), &hash);
+  HashBytes(&metadata.cRI, sizeof(ColorRemappingInfo), &hash);
+  if (metadata.dynamicMetaDataValid && metadata.dynamicMetaDataLen <= HDR_DYNAMIC_META_DATA_SZ) {
+    HashBytes(&metadata.dynamicMetaDataLen, sizeof(metadata.dynamicMetaDataLen), &hash);
+    HashBytes(metadata.dynamicMetaDataPayload, metadata.dynamicMetaDataLen, &hash);
+  }
+  return hash;
+}
+
+// A video ring holds a handful of buffers; anything beyond this is churn, not a session.
+constexpr uint32_t kMaxColorMetadataCacheSize = 32;
+constexpr uint32_t kMaxBufferSnapshotCacheSize = 32;
+
+// Compile-time HAL to SDM pixel format map replacing the old switch chains in GetSDMFormat().
+// One entry per HAL format carries both the linear and the UBWC-aligned translation;
+// kFormatInvalid marks a pairing the hardware has no layout for. Key uniqueness is checked
+// when this file builds.
+struct HalFormatMapEntry {
+  int32_t hal_format;
+  LayerBufferFormat linear;
+  LayerBufferFormat ubwc;
+};
+
+constexpr HalFormatMapEntry kHalFormatMap[] = {
+    {static_cast<int32_t>(PixelFormat::RGBA_8888), kFormatRGBA8888, kFormatRGBA8888Ubwc},
+    {HAL_PIXEL_FORMAT_RGBA_5551, kFormatRGBA5551, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_RGBA_4444, kFormatRGBA4444, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::BGRA_8888), kFormatBGRA8888, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::RGBX_8888), kFormatRGBX8888, kFormatRGBX8888Ubwc},
+    {HAL_PIXEL_FORMAT_BGRX_8888, kFormatBGRX8888, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::RGB_888), kFormatRGB888, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_BGR_888, kFormatBGR888, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::RGB_565), kFormatRGB565, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_BGR_565, kFormatBGR565, kFormatBGR565Ubwc},
+    {HAL_PIXEL_FORMAT_NV12_ENCODEABLE, kFormatYCbCr420SemiPlanarVenus, kFormatYCbCr420SPVenusUbwc},
+    {HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS, kFormatYCbCr420SemiPlanarVenus,
+     kFormatYCbCr420SPVenusUbwc},
+    {HAL_PIXEL_FORMAT_YCrCb_420_SP_VENUS, kFormatYCrCb420SemiPlanarVenus, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS_UBWC, kFormatYCbCr420SPVenusUbwc,
+     kFormatYCbCr420SPVenusUbwc},
+    {static_cast<int32_t>(PixelFormat::YV12), kFormatYCrCb420PlanarStride16, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::YCRCB_420_SP), kFormatYCrCb420SemiPlanar, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_YCbCr_420_SP, kFormatYCbCr420SemiPlanar, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::YCBCR_422_SP), kFormatYCbCr422H2V1SemiPlanar,
+     kFormatInvalid},
+    {HAL_PIXEL_FORMAT_YCbCr_422_I, kFormatYCbCr422H2V1Packed, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_CbYCrY_422_I, kFormatCbYCrY422H2V1Packed, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::RGBA_1010102), kFormatRGBA1010102, kFormatRGBA1010102Ubwc},
+    {HAL_PIXEL_FORMAT_ARGB_2101010, kFormatARGB2101010, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_RGBX_1010102, kFormatRGBX1010102, kFormatRGBX1010102Ubwc},
+    {HAL_PIXEL_FORMAT_XRGB_2101010, kFormatXRGB2101010, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_BGRA_1010102, kFormatBGRA1010102, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_ABGR_2101010, kFormatABGR2101010, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_BGRX_1010102, kFormatBGRX1010102, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_XBGR_2101010, kFormatXBGR2101010, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_YCbCr_420_P010, kFormatYCbCr420P010, kFormatInvalid},
+    {HAL_PIXEL_FORMAT_YCbCr_420_TP10_UBWC, kFormatYCbCr420TP10Ubwc, kFormatYCbCr420TP10Ubwc},
+    {HAL_PIXEL_FORMAT_YCbCr_420_P010_UBWC, kFormatYCbCr420P010Ubwc, kFormatYCbCr420P010Ubwc},
+    {HAL_PIXEL_FORMAT_YCbCr_420_P010_VENUS, kFormatYCbCr420P010Venus, kFormatInvalid},
+    {static_cast<int32_t>(PixelFormat::RGBA_FP16), kFormatRGBA16161616F, kFormatRGBA16161616FUbwc},
+    {static_cast<int32_t>(PixelFormat_V3::R_8), kFormatA8, kFormatInvalid},
+};
+
+constexpr uint32_t kHalFormatMapSize = sizeof(kHalFormatMap) / sizeof(kHalFormatMap[0]);
+
+constexpr bool HalFormatMapKeysUnique() {
+  for (uint32_t i = 0; i < kHalFormatMapSize; i++) {
+    for (uint32_t j = i + 1; j < kHalFormatMapSize; j++) {
+      if (kHalFormatMap[i].hal_format == kHalFormatMap[j].hal_format) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+static_assert(HalFormatMapKeysUnique(), "kHalFormatMap must have one entry per HAL format");
+
+// Sorted once on first use so the per-frame lookup is a binary search over table loads; the
+// build-time uniqueness check above guarantees the sort order is total.
+const std::array<HalFormatMapEntry, kHalFormatMapSize> &GetSortedHalFormatMap() {
+  static const std::array<HalFormatMapEntry, kHalFormatMapSize> sorted_map = []() {
+    std::array<HalFormatMapEntry, kHalFormatMapSize> sorted = {};
+    std::copy(kHalFormatMap, kHalFormatMap + kHalFormatMapSize, sorted.begin());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const HalFormatMapEntry &a, const HalFormatMapEntry &b) {
+                return a.hal_format < b.hal_format;
+              });
+    return sorted;
+  }();
+  return sorted_map;
+}
+
+}  // namespace
+
 DisplayError SetCSC(const native_handle_t *handle, ColorMetaData *color_metadata) {
   void *hnd = const_cast<native_handle_t *>(handle);
 
@@ -335,19 +449,37 @@ static bool IsSdrDimmingDisabled() {
 }
 
 // Layer operations
-HWCLayer::HWCLayer(Display display_id, HWCBufferAllocator *buf_allocator)
+HWCLayer::HWCLayer(Display display_id, HWCBufferAllocator *buf_allocator, Layer *recycled_layer)
     : id_(next_id_++), display_id_(display_id), buffer_allocator_(buf_allocator) {
-  layer_ = new Layer();
+  if (recycled_layer) {
+    // Reset the recycled layer in place, retaining the region vector allocations.
+    std::vector<LayerRect> visible_regions = std::move(recycled_layer->visible_regions);
+    std::vector<LayerRect> dirty_regions = std::move(recycled_layer->dirty_regions);
+    visible_regions.clear();
+    dirty_regions.clear();
+    *recycled_layer = Layer();
+    recycled_layer->visible_regions = std::move(visible_regions);
+    recycled_layer->dirty_regions = std::move(dirty_regions);
+    layer_ = recycled_layer;
+  } else {
+    layer_ = new Layer();
+  }
   geometry_changes_ |= kAdded;
 }
 
+Layer *HWCLayer::DetachSDMLayer() {
+  Layer *layer = layer_;
+  layer_ = nullptr;
+  return layer;
+}
+
 HWCLayer::~HWCLayer() {
   // Close any fences left for this layer
   release_fence_ = nullptr;
+  if (buffer_fd_ >= 0) {
+    ::close(buffer_fd_);
+  }
   if (layer_) {
-    if (buffer_fd_ >= 0) {
-      ::close(buffer_fd_);
-    }
     delete layer_;
   }
 }
@@ -365,53 +497,95 @@ HWC3::Error HWCLayer::SetLayerBuffer(buffer_handle_t buffer, shared_ptr<Fence> a
 
   const native_handle_t *handle = reinterpret_cast<const native_handle_t *>(buffer);
   void *hnd = const_cast<native_handle_t *>(handle);
-  int fd;
-  gralloc::GetMetaDataValue(hnd, qtigralloc::MetadataType_FD.value, &fd);
+  LayerBuffer *layer_buffer = &layer_->input_buffer;
 
-  if (fd < 0) {
-    return HWC3::Error::BadParameter;
+  // Allocation attributes are immutable, so query gralloc only on first sight of a handle;
+  // buffers cycling through SurfaceFlinger's ring are then served from the snapshot. Mutable
+  // metadata is still refreshed below through SetMetaData() on every call.
+  const uint64_t cache_key = reinterpret_cast<uint64_t>(handle);
+  auto snap_iter = buffer_snapshot_cache_.find(cache_key);
+  if (snap_iter == buffer_snapshot_cache_.end()) {
+    BufferSnapshot snap;
+    // Fetch all per-buffer metadata fields in one call to avoid repeated per-field lookups.
+    const int64_t metadata_types[] = {qtigralloc::MetadataType_FD.value,
+                                      (int64_t)StandardMetadataType::PIXEL_FORMAT_REQUESTED,
+                                      (int64_t)qtigralloc::MetadataType_PrivateFlags.value,
+                                      (int64_t)StandardMetadataType::WIDTH,
+                                      (int64_t)StandardMetadataType::HEIGHT,
+                                      (int64_t)qtigralloc::MetadataType_BufferType.value};
+    void *const metadata_values[] = {&snap.fd,
+                                     &snap.format,
+                                     &snap.flags,
+                                     &snap.unaligned_width,
+                                     &snap.unaligned_height,
+                                     &snap.buffer_type};
+    const uint32_t metadata_count = UINT32(sizeof(metadata_types) / sizeof(metadata_types[0]));
+    gralloc::Error metadata_errors[metadata_count] = {};
+    gralloc::GetMetaDataValueBatch(hnd, metadata_count, metadata_types, metadata_values,
+                                   metadata_errors);
+
+    if (snap.fd < 0) {
+      // Not cached: a bad handle must not poison a later valid allocation at this address.
+      return HWC3::Error::BadParameter;
+    }
+
+    buffer_allocator_->GetCustomWidthAndHeight(handle, &snap.aligned_width, &snap.aligned_height);
+
+    if (metadata_errors[3] != gralloc::Error::NONE) {
+      DLOGE("Failed to retrieve unaligned width");
+    }
+    if (metadata_errors[4] != gralloc::Error::NONE) {
+      DLOGE("Failed to retrieve unaligned height");
+    }
+
+    auto err = gralloc::GetMetaDataValue(hnd, QTI_ALIGNED_WIDTH_IN_PIXELS, &snap.stride);
+    if (err != gralloc::Error::NONE) {
+      DLOGW("Failed to retrieve aligned width");
+    }
+    err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::ALLOCATION_SIZE,
+                                    &snap.size);
+    if (err != gralloc::Error::NONE) {
+      DLOGW("Failed to retrieve allocation size");
+    }
+    err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::BUFFER_ID,
+                                    &snap.handle_id);
+    if (err != gralloc::Error::NONE) {
+      DLOGW("Failed to retrieve buffer id");
+    }
+    err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::USAGE, &snap.usage);
+    if (err != gralloc::Error::NONE) {
+      DLOGW("Failed to retrieve handle usage");
+    }
+
+    if (buffer_snapshot_cache_.size() >= kMaxBufferSnapshotCacheSize) {
+      buffer_snapshot_cache_.clear();
+    }
+    snap_iter = buffer_snapshot_cache_.emplace(cache_key, snap).first;
   }
 
-  LayerBuffer *layer_buffer = &layer_->input_buffer;
-  int aligned_width, aligned_height;
-  buffer_allocator_->GetCustomWidthAndHeight(reinterpret_cast<const native_handle_t *>(buffer),
-                                             &aligned_width, &aligned_height);
-  int fmt, flag;
-  gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::PIXEL_FORMAT_REQUESTED, &fmt);
-  gralloc::GetMetaDataValue(hnd, (int64_t)qtigralloc::MetadataType_PrivateFlags.value, &flag);
-  LayerBufferFormat format = GetSDMFormat(fmt, flag);
-  if ((format != layer_buffer->format) || (UINT32(aligned_width) != layer_buffer->width) ||
-      (UINT32(aligned_height) != layer_buffer->height)) {
+  const BufferSnapshot &snap = snap_iter->second;
+  LayerBufferFormat format = GetSDMFormat(snap.format, snap.flags);
+  if ((format != layer_buffer->format) || (UINT32(snap.aligned_width) != layer_buffer->width) ||
+      (UINT32(snap.aligned_height) != layer_buffer->height)) {
     // Layer buffer geometry has changed.
     geometry_changes_ |= kBufferGeometry;
   }
 
   layer_buffer->format = format;
-  layer_buffer->width = UINT32(aligned_width);
-  layer_buffer->height = UINT32(aligned_height);
-
-  auto err_w = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::WIDTH,
-                                         &layer_buffer->unaligned_width);
-  if (err_w != gralloc::Error::NONE) {
-    DLOGE("Failed to retrieve unaligned width");
-  }
-  auto err_h = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::HEIGHT,
-                                         &layer_buffer->unaligned_height);
-  if (err_h != gralloc::Error::NONE) {
-    DLOGE("Failed to retrieve unaligned height");
-  }
-  int32_t buffer_type;
-  gralloc::GetMetaDataValue(hnd, (int64_t)qtigralloc::MetadataType_BufferType.value, &buffer_type);
+  layer_buffer->width = UINT32(snap.aligned_width);
+  layer_buffer->height = UINT32(snap.aligned_height);
+  layer_buffer->unaligned_width = snap.unaligned_width;
+  layer_buffer->unaligned_height = snap.unaligned_height;
 
-  layer_buffer->flags.video = (buffer_type == BUFFER_TYPE_VIDEO) ? true : false;
+  layer_buffer->flags.video = (snap.buffer_type == BUFFER_TYPE_VIDEO) ? true : false;
   if (SetMetaData(handle, layer_) != kErrorNone) {
     return HWC3::Error::BadLayer;
   }
 
   // TZ Protected Buffer - L1
-  secure_ = (flag & qtigralloc::PRIV_FLAGS_SECURE_BUFFER);
-  bool secure_camera = secure_ && (flag & qtigralloc::PRIV_FLAGS_CAMERA_WRITE);
-  bool secure_display = (flag & qtigralloc::PRIV_FLAGS_SECURE_DISPLAY);
+  secure_ = (snap.flags & qtigralloc::PRIV_FLAGS_SECURE_BUFFER);
+  bool secure_camera = secure_ && (snap.flags & qtigralloc::PRIV_FLAGS_CAMERA_WRITE);
+  bool secure_display = (snap.flags & qtigralloc::PRIV_FLAGS_SECURE_DISPLAY);
   if (secure_ != layer_buffer->flags.secure || secure_camera != layer_buffer->flags.secure_camera ||
       secure_display != layer_buffer->flags.secure_display) {
     // Secure attribute of layer buffer has changed.
@@ -425,37 +599,19 @@ HWC3::Error HWCLayer::SetLayerBuffer(buffer_handle_t buffer, shared_ptr<Fence> a
   layer_buffer->acquire_fence = acquire_fence;
 
   int buffer_fd = buffer_fd_;
-  buffer_fd_ = ::dup(fd);
+  buffer_fd_ = ::dup(snap.fd);
   if (buffer_fd >= 0) {
     ::close(buffer_fd);
   }
 
   layer_buffer->planes[0].fd = buffer_fd_;
   layer_buffer->planes[0].offset = 0;
-  auto err =
-      gralloc::GetMetaDataValue(hnd, QTI_ALIGNED_WIDTH_IN_PIXELS, &layer_buffer->planes[0].stride);
-  if (err != gralloc::Error::NONE) {
-    DLOGW("Failed to retrieve aligned width");
-  }
-
-  err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::ALLOCATION_SIZE,
-                                  &layer_buffer->size);
-
-  if (err != gralloc::Error::NONE) {
-    DLOGW("Failed to retrieve allocation size");
-  }
+  layer_buffer->planes[0].stride = snap.stride;
+  layer_buffer->size = snap.size;
   buffer_flipped_ = reinterpret_cast<uint64_t>(handle) != layer_buffer->buffer_id;
   layer_buffer->buffer_id = reinterpret_cast<uint64_t>(handle);
-  [[maybe_unused]] int64_t hd_id, hd_usage;
-  err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::BUFFER_ID,
-                                  &layer_buffer->handle_id);
-  if (err != gralloc::Error::NONE) {
-    DLOGW("Failed to retrieve buffer id");
-  }
-  err = gralloc::GetMetaDataValue(hnd, (int64_t)StandardMetadataType::USAGE, &layer_buffer->usage);
-  if (err != gralloc::Error::NONE) {
-    DLOGW("Failed to retrieve handle usage");
-  }
+  layer_buffer->handle_id = snap.handle_id;
+  layer_buffer->usage = snap.usage;
   return HWC3::Error::None;
 }
 
@@ -529,8 +685,11 @@ HWC3::Error HWCLayer::SetLayerColor(Color color) {
 }
 
 HWC3::Error HWCLayer::SetLayerCompositionType(Composition type) {
-  // Validation is required when the client changes the composition type
-  if ((type != client_requested_) || (type != device_selected_) || (type == Composition::CLIENT)) {
+  // Validation is required when the client changes the composition type. Re-requesting
+  // CLIENT for a layer the accepted plan already composes as CLIENT is not a change: the
+  // accepted plan stays binding until some other layer command invalidates the frame, so
+  // mixed-mode stacks can keep taking the validate-skip path.
+  if ((type != client_requested_) || (type != device_selected_)) {
     layer_->update_mask.set(kClientCompRequest);
   }
   client_requested_ = type;
@@ -900,151 +1059,23 @@ uint32_t HWCLayer::GetUint32Color(const Color &source) {
 }
 
 LayerBufferFormat HWCLayer::GetSDMFormat(const int32_t &source, const int flags) {
+  bool ubwc = (flags & qtigralloc::PRIV_FLAGS_UBWC_ALIGNED);
+  const std::array<HalFormatMapEntry, kHalFormatMapSize> &format_map = GetSortedHalFormatMap();
+  auto entry = std::lower_bound(format_map.begin(), format_map.end(), source,
+                                [](const HalFormatMapEntry &e, const int32_t &fmt) {
+                                  return e.hal_format < fmt;
+                                });
   LayerBufferFormat format = kFormatInvalid;
-  if (flags & qtigralloc::PRIV_FLAGS_UBWC_ALIGNED) {
-    switch (source) {
-      case static_cast<int>(PixelFormat::RGBA_8888):
-        format = kFormatRGBA8888Ubwc;
-        break;
-      case static_cast<int>(PixelFormat::RGBX_8888):
-        format = kFormatRGBX8888Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_BGR_565:
-        format = kFormatBGR565Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS:
-      case HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS_UBWC:
-      case HAL_PIXEL_FORMAT_NV12_ENCODEABLE:
-        format = kFormatYCbCr420SPVenusUbwc;
-        break;
-      case static_cast<int>(PixelFormat::RGBA_1010102):
-        format = kFormatRGBA1010102Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_RGBX_1010102:
-        format = kFormatRGBX1010102Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_YCbCr_420_TP10_UBWC:
-        format = kFormatYCbCr420TP10Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_YCbCr_420_P010_UBWC:
-        format = kFormatYCbCr420P010Ubwc;
-        break;
-      case HAL_PIXEL_FORMAT_RGBA_FP16:
-        format = kFormatRGBA16161616FUbwc;
-        break;
-      default:
-        DLOGW("Unsupported format type for UBWC: %d", source);
-        return kFormatInvalid;
-    }
-    return format;
+  if (entry != format_map.end() && entry->hal_format == source) {
+    format = ubwc ? entry->ubwc : entry->linear;
   }
-
-  switch (source) {
-    case static_cast<int>(PixelFormat::RGBA_8888):
-      format = kFormatRGBA8888;
-      break;
-    case HAL_PIXEL_FORMAT_RGBA_5551:
-      format = kFormatRGBA5551;
-      break;
-    case HAL_PIXEL_FORMAT_RGBA_4444:
-      format = kFormatRGBA4444;
-      break;
-    case static_cast<int>(PixelFormat::BGRA_8888):
-      format = kFormatBGRA8888;
-      break;
-    case static_cast<int>(PixelFormat::RGBX_8888):
-      format = kFormatRGBX8888;
-      break;
-    case HAL_PIXEL_FORMAT_BGRX_8888:
-      format = kFormatBGRX8888;
-      break;
-    case static_cast<int>(PixelFormat::RGB_888):
-      format = kFormatRGB888;
-      break;
-    case HAL_PIXEL_FORMAT_BGR_888:
-      format = kFormatBGR888;
-      break;
-    case static_cast<int>(PixelFormat::RGB_565):
-      format = kFormatRGB565;
-      break;
-    case HAL_PIXEL_FORMAT_BGR_565:
-      format = kFormatBGR565;
-      break;
-    case HAL_PIXEL_FORMAT_NV12_ENCODEABLE:
-    case HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS:
-      format = kFormatYCbCr420SemiPlanarVenus;
-      break;
-    case HAL_PIXEL_FORMAT_YCrCb_420_SP_VENUS:
-      format = kFormatYCrCb420SemiPlanarVenus;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_SP_VENUS_UBWC:
-      format = kFormatYCbCr420SPVenusUbwc;
-      break;
-    case static_cast<int>(PixelFormat::YV12):
-      format = kFormatYCrCb420PlanarStride16;
-      break;
-    case static_cast<int>(PixelFormat::YCRCB_420_SP):
-      format = kFormatYCrCb420SemiPlanar;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_SP:
-      format = kFormatYCbCr420SemiPlanar;
-      break;
-    case static_cast<int>(PixelFormat::YCBCR_422_SP):
-      format = kFormatYCbCr422H2V1SemiPlanar;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_422_I:
-      format = kFormatYCbCr422H2V1Packed;
-      break;
-    case HAL_PIXEL_FORMAT_CbYCrY_422_I:
-      format = kFormatCbYCrY422H2V1Packed;
-      break;
-    case static_cast<int>(PixelFormat::RGBA_1010102):
-      format = kFormatRGBA1010102;
-      break;
-    case HAL_PIXEL_FORMAT_ARGB_2101010:
-      format = kFormatARGB2101010;
-      break;
-    case HAL_PIXEL_FORMAT_RGBX_1010102:
-      format = kFormatRGBX1010102;
-      break;
-    case HAL_PIXEL_FORMAT_XRGB_2101010:
-      format = kFormatXRGB2101010;
-      break;
-    case HAL_PIXEL_FORMAT_BGRA_1010102:
-      format = kFormatBGRA1010102;
-      break;
-    case HAL_PIXEL_FORMAT_ABGR_2101010:
-      format = kFormatABGR2101010;
-      break;
-    case HAL_PIXEL_FORMAT_BGRX_1010102:
-      format = kFormatBGRX1010102;
-      break;
-    case HAL_PIXEL_FORMAT_XBGR_2101010:
-      format = kFormatXBGR2101010;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_P010:
-      format = kFormatYCbCr420P010;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_TP10_UBWC:
-      format = kFormatYCbCr420TP10Ubwc;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_P010_UBWC:
-      format = kFormatYCbCr420P010Ubwc;
-      break;
-    case HAL_PIXEL_FORMAT_YCbCr_420_P010_VENUS:
-      format = kFormatYCbCr420P010Venus;
-      break;
-    case static_cast<int>(PixelFormat::RGBA_FP16):
-      format = kFormatRGBA16161616F;
-      break;
-    case static_cast<int>(PixelFormat_V3::R_8):
-      format = kFormatA8;
-      break;
-    default:
+  if (format == kFormatInvalid) {
+    if (ubwc) {
+      DLOGW("Unsupported format type for UBWC: %d", source);
+    } else {
       DLOGW("Unsupported format type = %d", source);
-      return kFormatInvalid;
+    }
   }
-
   return format;
 }
 
@@ -1230,6 +1261,16 @@ void HWCLayer::ValidateAndSetCSC(const native_handle_t *handle) {
   }
 
   if (use_color_metadata) {
+    const uint64_t cache_key = reinterpret_cast<uint64_t>(handle);
+    auto cache_it = color_metadata_cache_.find(cache_key);
+    if (cache_it != color_metadata_cache_.end() && !cache_it->second.has_dynamic_metadata) {
+      // Static HDR metadata travels with the buffer and is written once per playback session;
+      // a handle cycling back through the video ring cannot carry new content unless it also
+      // has per-frame dynamic metadata, so skip the gralloc round trip entirely.
+      dataspace_supported_ = cache_it->second.dataspace_supported;
+      return;
+    }
+
     ColorMetaData new_metadata = layer_buffer->color_metadata;
     if (sdm::SetCSC(handle, &new_metadata) == kErrorNone) {
       // If dataspace is KNOWN, overwrite the gralloc metadata CSC using the previously derived CSC
@@ -1239,6 +1280,15 @@ void HWCLayer::ValidateAndSetCSC(const native_handle_t *handle) {
         new_metadata.transfer = layer_buffer->color_metadata.transfer;
         new_metadata.range = layer_buffer->color_metadata.range;
       }
+
+      uint64_t content_hash = GetColorMetadataHash(new_metadata);
+      if (cache_it != color_metadata_cache_.end() &&
+          cache_it->second.content_hash == content_hash) {
+        // Same dynamic metadata blob as the last time this handle was queued; everything below
+        // would compare equal, so the layer keeps its applied state untouched.
+        dataspace_supported_ = cache_it->second.dataspace_supported;
+        return;
+      }
       if ((layer_buffer->color_metadata.colorPrimaries != new_metadata.colorPrimaries) ||
           (layer_buffer->color_metadata.transfer != new_metadata.transfer) ||
           (layer_buffer->color_metadata.range != new_metadata.range)) {
@@ -1289,7 +1339,21 @@ void HWCLayer::ValidateAndSetCSC(const native_handle_t *handle) {
                     new_metadata.dynamicMetaDataPayload, new_metadata.dynamicMetaDataLen);
         layer_->update_mask.set(kContentMetadata);
       }
+
+      if (color_metadata_cache_.size() >= kMaxColorMetadataCacheSize) {
+        color_metadata_cache_.clear();
+      }
+      ColorMetadataCache &cache = color_metadata_cache_[cache_key];
+      cache.content_hash = content_hash;
+      cache.has_dynamic_metadata =
+          new_metadata.dynamicMetaDataValid && new_metadata.dynamicMetaDataLen;
+      cache.dataspace_supported = true;
     } else {
+      if (color_metadata_cache_.size() >= kMaxColorMetadataCacheSize) {
+        color_metadata_cache_.clear();
+      }
+      // Negative result is just as cacheable; the same handle keeps failing the same way.
+      color_metadata_cache_[cache_key] = {};
       dataspace_supported_ = false;
       return;
     }
@@ -1380,6 +1444,8 @@ void HWCLayer::SetDirtyRegions(Region surface_damage) {
 
 void HWCLayer::SetLayerAsMask() {
   layer_->input_buffer.flags.mask_layer = true;
+  // Mark the layer dirty so the next stack build re-derives its flags and mask contribution.
+  layer_->update_mask.set(kMetadataUpdate);
   DLOGV_IF(kTagClient,
            " Layer Id: "
            "[%" PRIu64 "]",
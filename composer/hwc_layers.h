@@ -36,8 +36,11 @@
 #include <core/layer_buffer.h>
 #include <utils/utils.h>
 
+#include <algorithm>
 #include <map>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "core/buffer_allocator.h"
 #include "hwc_buffer_allocator.h"
@@ -66,8 +69,10 @@ enum LayerTypes {
 
 class HWCLayer {
  public:
-  explicit HWCLayer(Display display_id, HWCBufferAllocator *buf_allocator);
+  explicit HWCLayer(Display display_id, HWCBufferAllocator *buf_allocator,
+                    Layer *recycled_layer = nullptr);
   ~HWCLayer();
+  Layer *DetachSDMLayer();
   uint32_t GetZ() const { return z_; }
   LayerId GetId() const { return id_; }
   std::string GetName() const { return name_; }
@@ -123,6 +128,10 @@ class HWCLayer {
   void SetReleaseFence(const shared_ptr<Fence> &release_fence);
   bool IsLayerCompatible() { return compatible_; }
   void IgnoreSdrHistogramMetadata(bool disable) { ignore_sdr_histogram_md_ = disable; }
+  // Stack flag bits this layer contributed when its flags were last derived; lets the display
+  // fold aggregates without re-deriving clean layers.
+  void SetStackFlagsContribution(const LayerStackFlags &flags) { stack_flags_contribution_ = flags; }
+  LayerStackFlags GetStackFlagsContribution() { return stack_flags_contribution_; }
 #ifdef UDFPS_ZPOS
   bool IsFodPressed() { return fod_pressed_; }
 #endif
@@ -140,6 +149,7 @@ class HWCLayer {
   int32_t dataspace_ = INT32(Dataspace::UNKNOWN);
   LayerTransform layer_transform_ = {};
   LayerRect dst_rect_ = {};
+  LayerStackFlags stack_flags_contribution_ = {};
   bool single_buffer_ = false;
   int buffer_fd_ = -1;
   bool dataspace_supported_ = false;
@@ -163,6 +173,35 @@ class HWCLayer {
   Composition device_selected_ = Composition::DEVICE;
   uint32_t geometry_changes_ = GeometryChanges::kNone;
 
+  // Cached result of color metadata validation, keyed by gralloc handle; avoids re-fetching
+  // and re-comparing HDR metadata for buffers cycling through a video ring. See
+  // ValidateAndSetCSC().
+  struct ColorMetadataCache {
+    uint64_t content_hash = 0;
+    bool has_dynamic_metadata = false;
+    bool dataspace_supported = false;
+  };
+  std::map<uint64_t, ColorMetadataCache> color_metadata_cache_;
+
+  // Immutable allocation attributes snapshotted on first sight of a handle, keyed by gralloc
+  // handle; buffers in SurfaceFlinger's fixed ring then skip the gralloc queries entirely in
+  // SetLayerBuffer(). Mutable metadata still goes through SetMetaData() every frame.
+  struct BufferSnapshot {
+    int fd = -1;
+    int format = 0;
+    int flags = 0;
+    int32_t buffer_type = 0;
+    int aligned_width = 0;
+    int aligned_height = 0;
+    uint32_t unaligned_width = 0;
+    uint32_t unaligned_height = 0;
+    uint32_t stride = 0;
+    uint32_t size = 0;
+    uint64_t handle_id = 0;
+    uint64_t usage = 0;
+  };
+  std::map<uint64_t, BufferSnapshot> buffer_snapshot_cache_;
+
   void SetRect(const Rect &source, LayerRect *target);
   void SetRect(const FRect &source, LayerRect *target);
   uint32_t GetUint32Color(const Color &source);
@@ -179,5 +218,42 @@ struct SortLayersByZ {
   }
 };
 
+// Z-sorted layer container with the slice of the std::multiset interface the
+// display code uses. Layer counts are small and bounded, so a flat sorted
+// vector beats node-based containers here: iteration each frame is a linear
+// walk over contiguous pointers instead of tree chasing, and insert/erase move
+// a few pointers without touching the allocator once capacity is warm.
+class SortedLayerSet {
+ public:
+  using iterator = std::vector<HWCLayer *>::iterator;
+  using const_iterator = std::vector<HWCLayer *>::const_iterator;
+
+  iterator begin() { return layers_.begin(); }
+  iterator end() { return layers_.end(); }
+  const_iterator begin() const { return layers_.begin(); }
+  const_iterator end() const { return layers_.end(); }
+  std::vector<HWCLayer *>::reverse_iterator rbegin() { return layers_.rbegin(); }
+
+  bool empty() const { return layers_.empty(); }
+  size_t size() const { return layers_.size(); }
+  void clear() { layers_.clear(); }
+
+  // Insert keeping Z order; equal Z keeps insertion order (matches multiset).
+  iterator emplace(HWCLayer *layer) {
+    auto it = std::upper_bound(layers_.begin(), layers_.end(), layer, SortLayersByZ());
+    return layers_.insert(it, layer);
+  }
+
+  iterator erase(iterator it) { return layers_.erase(it); }
+
+  // Range of layers whose Z compares equal to the given layer's.
+  std::pair<iterator, iterator> equal_range(const HWCLayer *layer) {
+    return std::equal_range(layers_.begin(), layers_.end(), layer, SortLayersByZ());
+  }
+
+ private:
+  std::vector<HWCLayer *> layers_;
+};
+
 }  // namespace sdm
 #endif  // __HWC_LAYERS_H__
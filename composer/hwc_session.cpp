@@ -39,6 +39,7 @@
 #include <QService.h>
 #include <utils/utils.h>
 #include <algorithm>
+#include <array>
 #include <utility>
 #include <bitset>
 #include <iterator>
@@ -234,6 +235,8 @@ int HWCSession::Init() {
   SCOPE_LOCK(locker_[HWC_DISPLAY_PRIMARY]);
   DLOGI("Initializing HWCSession");
 
+  boot_timeline_.init_start = systemTime(SYSTEM_TIME_MONOTONIC);
+
   int status = -EINVAL;
   const char *qservice_name = "display.qservice";
 
@@ -275,15 +278,67 @@ int HWCSession::Init() {
   async_vds_creation_ = (value == 1);
   DLOGI("async_vds_creation: %d", async_vds_creation_);
 
+  value = 0;
+  Debug::Get()->GetProperty(ENABLE_SPECULATIVE_PREPARE, &value);
+  speculative_prepare_enabled_ = (value == 1);
+  DLOGI("speculative_prepare_enabled: %d", speculative_prepare_enabled_);
+
   value = 0;
   Debug::Get()->GetProperty(DISABLE_GET_SCREEN_DECORATOR_SUPPORT, &value);
   disable_get_screen_decorator_support_ = (value == 1);
   DLOGI("disable_get_screen_decorator_support: %d", disable_get_screen_decorator_support_);
 
+  value = 0;
+  Debug::Get()->GetProperty(VSYNC_COALESCE_WINDOW_NS, &value);
+  if (value > 0) {
+    callbacks_.SetVsyncCoalesceWindow(UINT32(value));
+    DLOGI("vsync_coalesce_window_ns: %d", value);
+  }
+
+  value = 0;
+  Debug::Get()->GetProperty(ENABLE_ALLOC_AUDIT, &value);
+  if (value == 1) {
+    int budget = 0;
+    Debug::Get()->GetProperty(ALLOC_AUDIT_BUDGET, &budget);
+    HWCAllocAudit::Enable(budget);
+    DLOGI("alloc audit enabled, budget: %d", budget);
+  }
+
+  value = 0;
+  Debug::Get()->GetProperty(FENCE_WAIT_STATS_MS, &value);
+  if (value > 0) {
+    Fence::EnableWaitStats(value);
+    DLOGI("fence wait stats enabled, threshold: %d ms", value);
+  }
+
+  value = 0;
+  Debug::Get()->GetProperty(ENABLE_STATE_JOURNAL, &value);
+  if (value == 1) {
+    // Mapped before display creation so a crash-restart can restore state
+    // from the previous instance's journal.
+    enable_state_journal_ = (state_journal_.Init() == 0);
+  }
+
+  // Make the first gralloc allocation in parallel with display core bring-up. The first call
+  // into the allocator loads its library and opens the dma-buf heap; doing it here takes that
+  // cost off the framebuffer-target allocation of the first frame.
+  gralloc_warmup_thread_ = std::thread([this]() {
+    BufferInfo buffer_info;
+    buffer_info.buffer_config.width = 64;
+    buffer_info.buffer_config.height = 64;
+    buffer_info.buffer_config.format = kFormatRGBA8888;
+    buffer_info.buffer_config.buffer_count = 1;
+    if (!buffer_allocator_.AllocateBuffer(&buffer_info)) {
+      buffer_allocator_.FreeBuffer(&buffer_info);
+    }
+  });
+
   DLOGI("Initializing supported display slots");
   InitSupportedDisplaySlots();
   DLOGI("Initializing supported display slots...done!");
 
+  boot_timeline_.core_created = systemTime(SYSTEM_TIME_MONOTONIC);
+
   // Create primary display here. Remaining builtin displays will be created after client has set
   // display indexes which may happen sometime before callback is registered.
   DLOGI("Creating the Primary display");
@@ -301,18 +356,26 @@ int HWCSession::Init() {
       DLOGE("Display core de-initialization failed. Error = %d", error);
     }
 
+    if (gralloc_warmup_thread_.joinable()) {
+      gralloc_warmup_thread_.join();
+    }
+
     return status;
   } else {
     DLOGI("Creating the Primary display...done!");
   }
 
+  boot_timeline_.primary_created = systemTime(SYSTEM_TIME_MONOTONIC);
+
   is_composer_up_ = true;
 
   PostInit();
   GetVirtualDisplayList();
   HpdInit();
 
-  DLOGI("Initializing HWCSession...done!");
+  boot_timeline_.init_done = systemTime(SYSTEM_TIME_MONOTONIC);
+  DLOGI("Initializing HWCSession...done! %" PRId64 " ms",
+        nanoseconds_to_milliseconds(boot_timeline_.init_done - boot_timeline_.init_start));
   return 0;
 }
 
@@ -342,6 +405,22 @@ void HWCSession::PostInit() {
 int HWCSession::Deinit() {
   HpdDeinit();
 
+  if (pluggable_probe_thread_.joinable()) {
+    pluggable_probe_thread_.join();
+  }
+
+  if (gralloc_warmup_thread_.joinable()) {
+    gralloc_warmup_thread_.join();
+  }
+
+  // Drain and stop per-display present workers before displays are destroyed.
+  {
+    std::lock_guard<std::mutex> lock(present_worker_lock_);
+    for (auto &worker : present_worker_) {
+      worker.reset();
+    }
+  }
+
   // Destroy all connected displays
   DestroyDisplay(&map_info_primary_);
 
@@ -357,6 +436,8 @@ int HWCSession::Deinit() {
     DestroyDisplay(&map_info);
   }
 
+  state_journal_.Deinit();
+
   if (color_mgr_) {
     color_mgr_->DestroyColorManager();
   }
@@ -609,6 +690,22 @@ void HWCSession::Dump(uint32_t *out_size, char *out_buffer) {
       }
     }
     Fence::Dump(&os);
+    HWCAllocAudit::Dump(&os);
+
+    // Milestones of the current composer instance, in ms since Init() entry.
+    if (boot_timeline_.init_start) {
+      nsecs_t start = boot_timeline_.init_start;
+      os << "\nbootstat:";
+      os << " core_created=" << nanoseconds_to_milliseconds(boot_timeline_.core_created - start);
+      os << "ms primary_created="
+         << nanoseconds_to_milliseconds(boot_timeline_.primary_created - start);
+      os << "ms init_done=" << nanoseconds_to_milliseconds(boot_timeline_.init_done - start);
+      if (boot_timeline_.first_commit) {
+        os << "ms first_commit="
+           << nanoseconds_to_milliseconds(boot_timeline_.first_commit - start);
+      }
+      os << "ms\n";
+    }
 
     std::string s = os.str();
     auto copied = s.copy(out_buffer, std::min(s.size(), max_dump_size), 0);
@@ -757,6 +854,22 @@ HWC3::Error HWCSession::GetDisplayConfigs(Display display, uint32_t *out_num_con
 
 HWC3::Error HWCSession::GetDisplayConfigurations(Display display,
                                                  std::vector<DisplayConfiguration> *out_configs) {
+  if (display >= HWCCallbacks::kNumDisplays || !out_configs) {
+    return HWC3::Error::BadDisplay;
+  }
+
+  // Serve the immutable list published at display create time; the framework queries this
+  // for every display and config during boot while the first frames hold locker_[display].
+  std::shared_ptr<const std::vector<DisplayConfiguration>> configs;
+  {
+    std::lock_guard<std::mutex> lock(display_configs_lock_);
+    configs = display_configs_snapshot_[display];
+  }
+  if (configs) {
+    *out_configs = *configs;
+    return HWC3::Error::None;
+  }
+
   return CallDisplayFunction(display, &HWCDisplay::GetDisplayConfigurations, out_configs);
 }
 
@@ -826,15 +939,75 @@ void HWCSession::PerformIdleStatusCallback(Display display) {
   }
 }
 
-HWC3::Error HWCSession::PresentDisplay(Display display, shared_ptr<Fence> *out_retire_fence) {
-  auto status = HWC3::Error::BadDisplay;
-  DTRACE_SCOPED();
+HWCSession::PresentWorker::PresentWorker(Display display) : display_(display) {
+  worker_thread_ = std::thread(&PresentWorker::ProcessTasks, this);
+}
+
+HWCSession::PresentWorker::~PresentWorker() {
+  {
+    std::lock_guard<std::mutex> lock(task_lock_);
+    exit_ = true;
+  }
+  task_cv_.notify_one();
+  if (worker_thread_.joinable()) {
+    worker_thread_.join();
+  }
+}
+
+std::future<HWC3::Error> HWCSession::PresentWorker::Post(std::function<HWC3::Error()> task) {
+  std::packaged_task<HWC3::Error()> packaged_task(std::move(task));
+  auto future = packaged_task.get_future();
+  {
+    std::lock_guard<std::mutex> lock(task_lock_);
+    task_queue_.push_back(std::move(packaged_task));
+  }
+  task_cv_.notify_one();
+  return future;
+}
+
+void HWCSession::PresentWorker::ProcessTasks() {
+  char thread_name[64] = {};
+  snprintf(thread_name, sizeof(thread_name), "present_worker_%d", UINT32(display_));
+  prctl(PR_SET_NAME, thread_name, 0, 0, 0);
 
+  std::unique_lock<std::mutex> lock(task_lock_);
+  while (true) {
+    task_cv_.wait(lock, [this]() { return exit_ || !task_queue_.empty(); });
+    if (exit_ && task_queue_.empty()) {
+      break;
+    }
+    std::packaged_task<HWC3::Error()> task(std::move(task_queue_.front()));
+    task_queue_.pop_front();
+    lock.unlock();
+    task();
+    lock.lock();
+  }
+}
+
+HWCSession::PresentWorker *HWCSession::GetPresentWorker(Display display) {
+  std::lock_guard<std::mutex> lock(present_worker_lock_);
+  if (!present_worker_[display]) {
+    present_worker_[display] = std::make_unique<PresentWorker>(display);
+  }
+  return present_worker_[display].get();
+}
+
+HWC3::Error HWCSession::PresentDisplay(Display display, shared_ptr<Fence> *out_retire_fence) {
   if (display >= HWCCallbacks::kNumDisplays) {
     DLOGW("Invalid Display : display = %" PRIu64, display);
     return HWC3::Error::BadDisplay;
   }
 
+  return PresentDisplayInternal(display, out_retire_fence);
+}
+
+HWC3::Error HWCSession::PresentDisplayInternal(Display display,
+                                               shared_ptr<Fence> *out_retire_fence) {
+  auto status = HWC3::Error::BadDisplay;
+  DTRACE_SCOPED();
+
+  speculative_prepare_kicked_[display].store(false);
+
   HandleSecureSession();
 
   {
@@ -854,9 +1027,13 @@ HWC3::Error HWCSession::PresentDisplay(Display display, shared_ptr<Fence> *out_r
     } else {
       status = hwc_display_[display]->Present(out_retire_fence);
       if (status == HWC3::Error::None) {
+        if (!boot_timeline_.first_commit && display == HWC_DISPLAY_PRIMARY) {
+          boot_timeline_.first_commit = systemTime(SYSTEM_TIME_MONOTONIC);
+        }
         PostCommitLocked(display, *out_retire_fence);
       }
     }
+    PublishDisplayState(display);
   }
 
   if (status != HWC3::Error::None && status != HWC3::Error::NotValidated) {
@@ -873,14 +1050,98 @@ HWC3::Error HWCSession::PresentDisplay(Display display, shared_ptr<Fence> *out_r
   return status;
 }
 
+void HWCSession::PublishDisplayState(Display display) {
+  DisplayStateSnapshot &snapshot = display_state_snapshot_[display];
+  uint32_t seq = snapshot.seq.load(std::memory_order_relaxed);
+
+  // Odd sequence marks a write in progress; readers retry or fall back.
+  snapshot.seq.store(seq + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  HWCDisplay *hwc_display = hwc_display_[display];
+  if (hwc_display) {
+    uint32_t active_config = 0;
+    snapshot.valid = (hwc_display->GetActiveDisplayConfig(&active_config) == 0);
+    snapshot.active_config = active_config;
+    snapshot.refresh_rate = hwc_display->GetActiveRefreshRate();
+    PowerMode mode = hwc_display->GetCurrentPowerMode();
+    snapshot.doze = (mode == PowerMode::DOZE || mode == PowerMode::DOZE_SUSPEND);
+  } else {
+    snapshot.valid = false;
+  }
+
+  snapshot.seq.store(seq + 2, std::memory_order_release);
+}
+
+bool HWCSession::ReadDisplayState(int disp_idx, uint32_t *active_config, uint32_t *refresh_rate,
+                                  bool *doze) {
+  DisplayStateSnapshot &snapshot = display_state_snapshot_[disp_idx];
+
+  for (int attempt = 0; attempt < 3; attempt++) {
+    uint32_t seq_begin = snapshot.seq.load(std::memory_order_acquire);
+    if (seq_begin & 1) {
+      continue;
+    }
+
+    bool valid = snapshot.valid;
+    uint32_t config = snapshot.active_config;
+    uint32_t fps = snapshot.refresh_rate;
+    bool doze_state = snapshot.doze;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (snapshot.seq.load(std::memory_order_relaxed) != seq_begin) {
+      continue;
+    }
+
+    if (!valid) {
+      return false;
+    }
+    if (active_config) {
+      *active_config = config;
+    }
+    if (refresh_rate) {
+      *refresh_rate = fps;
+    }
+    if (doze) {
+      *doze = doze_state;
+    }
+    return true;
+  }
+
+  // Writer kept the snapshot busy; let the caller take the locked path.
+  return false;
+}
+
+void HWCSession::PublishDisplayConfigs(Display display) {
+  // Runs only from the display create/destroy paths, while the display slot is still
+  // serialized; the config set cannot change in between.
+  std::shared_ptr<const std::vector<DisplayConfiguration>> configs;
+  HWCDisplay *hwc_display = hwc_display_[display];
+  if (hwc_display) {
+    auto built = std::make_shared<std::vector<DisplayConfiguration>>();
+    if (hwc_display->GetDisplayConfigurations(built.get()) == HWC3::Error::None) {
+      configs = std::move(built);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(display_configs_lock_);
+  display_configs_snapshot_[display] = configs;
+}
+
 void HWCSession::PostCommitLocked(Display display, shared_ptr<Fence> &retire_fence) {
   // Check if hwc's refresh trigger is getting exercised.
   if (callbacks_.NeedsRefresh(display)) {
     hwc_display_[display]->SetPendingRefresh();
     callbacks_.ResetRefresh(display);
   }
+  // This frame satisfies any deferrable refresh votes for the display.
+  callbacks_.OnFrameCommitted(display);
   PerformIdleStatusCallback(display);
 
+  if (enable_state_journal_) {
+    JournalDisplayState(display);
+  }
+
   if (clients_waiting_for_commit_[display].any()) {
     retire_fence_[display] = retire_fence;
     commit_error_[display] = 0;
@@ -888,6 +1149,64 @@ void HWCSession::PostCommitLocked(Display display, shared_ptr<Fence> &retire_fen
   }
 }
 
+void HWCSession::JournalDisplayState(Display display) {
+  HWCDisplay *hwc_display = hwc_display_[display];
+  if (!hwc_display) {
+    return;
+  }
+
+  // Unchanged state short-circuits inside Record(), so this is a handful of
+  // loads on the steady-state commit path.
+  HWCStateJournal::DisplayState state;
+  uint32_t active_config = 0;
+  if (!hwc_display->GetActiveDisplayConfig(&active_config)) {
+    state.active_config = INT32(active_config);
+  }
+  state.power_mode = INT32(hwc_display->GetCurrentPowerMode());
+  state.color_mode = INT32(hwc_display->GetCurrentColorMode());
+  state.render_intent = INT32(hwc_display->GetCurrentRenderIntent());
+  state_journal_.Record(UINT32(display), state);
+}
+
+void HWCSession::RestoreDisplayState(Display client_id) {
+  HWCStateJournal::DisplayState state;
+  if (!state_journal_.Lookup(UINT32(client_id), &state)) {
+    return;
+  }
+
+  SCOPE_LOCK(locker_[client_id]);
+  HWCDisplay *hwc_display = hwc_display_[client_id];
+  if (!hwc_display) {
+    return;
+  }
+
+  DLOGI("Restoring display %d: power %d, config %d, color mode %d, intent %d", UINT32(client_id),
+        state.power_mode, state.active_config, state.color_mode, state.render_intent);
+
+  // Panel back on first so the restored config/color state lands on a powered
+  // pipe. Only ON is replayed; anything else is the safe boot default anyway.
+  // The framework repeats its own state once it reconnects - that replay is
+  // idempotent, this just gets a frame on screen before it happens.
+  if (state.power_mode == INT32(PowerMode::ON)) {
+    HWC3::Error error = hwc_display->SetPowerMode(PowerMode::ON, false /* teardown */);
+    if (error != HWC3::Error::None) {
+      DLOGW("Power mode restore failed for display %d", UINT32(client_id));
+      return;
+    }
+  }
+
+  uint32_t config_count = 0;
+  if ((state.active_config >= 0) && !hwc_display->GetDisplayConfigCount(&config_count) &&
+      (UINT32(state.active_config) < config_count)) {
+    hwc_display->SetActiveDisplayConfig(UINT32(state.active_config));
+  }
+
+  if (state.color_mode >= 0) {
+    hwc_display->SetColorModeWithRenderIntent(static_cast<ColorMode>(state.color_mode),
+                                              static_cast<RenderIntent>(state.render_intent));
+  }
+}
+
 void HWCSession::PostCommitUnlocked(Display display, const shared_ptr<Fence> &retire_fence) {
   HandlePendingPowerMode(display, retire_fence);
   HandlePendingHotplug(display, retire_fence);
@@ -903,18 +1222,19 @@ void HWCSession::PostCommitUnlocked(Display display, const shared_ptr<Fence> &re
 }
 
 void HWCSession::HandlePendingRefresh() {
-  if (pending_refresh_.none()) {
-    return;
-  }
-
-  for (size_t i = 0; i < pending_refresh_.size(); i++) {
-    if (pending_refresh_.test(i)) {
-      callbacks_.Refresh(i);
-      break;
+  // A single refresh restarts the commit cycle for every queued request; further queued
+  // refreshes in the same drain are folded into it, matching the old bitset behavior.
+  bool refresh_sent = false;
+  deferred_actions_.Drain([&](const DeferredAction &action) {
+    switch (action.type) {
+      case kDeferredRefresh:
+        if (!refresh_sent) {
+          callbacks_.Refresh(action.display);
+          refresh_sent = true;
+        }
+        break;
     }
-  }
-
-  pending_refresh_.reset();
+  });
 }
 
 void HWCSession::RegisterCallback(CallbackCommand descriptor, void *callback_data,
@@ -958,11 +1278,20 @@ void HWCSession::RegisterCallback(CallbackCommand descriptor, void *callback_dat
       DLOGW("Failed handling built-in displays.");
     }
     DLOGI("Handling pluggable displays...");
-    int32_t err = HandlePluggableDisplays(false);
-    if (err) {
-      DLOGW("All displays could not be created. Error %d '%s'. Hotplug handling %s.", err,
-            strerror(abs(err)), pending_hotplug_event_ == kHotPlugEvent ? "deferred" : "dropped");
+    // Probe pluggable displays off the client thread. Even with nothing connected the
+    // connector probe costs tens of ms, and the client only learns about pluggable displays
+    // through hotplug callbacks anyway, which HandlePluggableDisplays() fires itself.
+    if (pluggable_probe_thread_.joinable()) {
+      pluggable_probe_thread_.join();
     }
+    pluggable_probe_thread_ = std::thread([this]() {
+      prctl(PR_SET_NAME, "pluggable_probe", 0, 0, 0);
+      int32_t err = HandlePluggableDisplays(false);
+      if (err) {
+        DLOGW("All displays could not be created. Error %d '%s'. Hotplug handling %s.", err,
+              strerror(abs(err)), pending_hotplug_event_ == kHotPlugEvent ? "deferred" : "dropped");
+      }
+    });
 
     // If previously registered, call hotplug for all connected displays to refresh
     if (already_connected) {
@@ -1104,7 +1433,11 @@ HWC3::Error HWCSession::SetLayerDataspace(Display display, LayerId layer, int32_
 }
 
 HWC3::Error HWCSession::SetLayerDisplayFrame(Display display, LayerId layer, Rect frame) {
-  return CallLayerFunction(display, layer, &HWCLayer::SetLayerDisplayFrame, frame);
+  auto status = CallLayerFunction(display, layer, &HWCLayer::SetLayerDisplayFrame, frame);
+  if (status == HWC3::Error::None) {
+    KickSpeculativePrepare(display);
+  }
+  return status;
 }
 
 HWC3::Error HWCSession::SetLayerPlaneAlpha(Display display, LayerId layer, float alpha) {
@@ -1128,7 +1461,34 @@ HWC3::Error HWCSession::SetLayerVisibleRegion(Display display, LayerId layer, Re
 }
 
 HWC3::Error HWCSession::SetLayerZOrder(Display display, LayerId layer, uint32_t z) {
-  return CallDisplayFunction(display, &HWCDisplay::SetLayerZOrder, layer, z);
+  auto status = CallDisplayFunction(display, &HWCDisplay::SetLayerZOrder, layer, z);
+  if (status == HWC3::Error::None) {
+    KickSpeculativePrepare(display);
+  }
+  return status;
+}
+
+void HWCSession::KickSpeculativePrepare(Display display) {
+  if (!speculative_prepare_enabled_ || display >= HWCCallbacks::kNumDisplays) {
+    return;
+  }
+
+  if (secure_session_active_ || speculative_prepare_kicked_[display].exchange(true)) {
+    return;
+  }
+
+  // Geometry for the pending frame is changing; warm the composition strategy on the display's
+  // worker while the caller is still parsing the rest of the command batch. The real validate
+  // runs inline on the command thread and serializes with this task on the display locker, so
+  // by the time it runs, prepare usually reduces to a cache hit. Layer commands landing after
+  // the task ran mark the frame dirty again and the real validate recomputes the delta.
+  GetPresentWorker(display)->Post([this, display]() {
+    SCOPE_LOCK(locker_[display]);
+    if (hwc_display_[display] && !pending_power_mode_[display]) {
+      hwc_display_[display]->SpeculatePrepare();
+    }
+    return HWC3::Error::None;
+  });
 }
 
 HWC3::Error HWCSession::SetLayerType(Display display, LayerId layer, LayerType type) {
@@ -1264,7 +1624,12 @@ HWC3::Error HWCSession::SetPowerMode(Display display, int32_t int_mode) {
 
   if (mode == PowerMode::DOZE) {
     // Trigger one more refresh for PP features to take effect.
-    pending_refresh_.set(UINT32(display));
+    deferred_actions_.Push({kDeferredRefresh, display});
+  }
+
+  {
+    SCOPE_LOCK(locker_[display]);
+    PublishDisplayState(display);
   }
 
   return HWC3::Error::None;
@@ -1425,6 +1790,7 @@ HWC3::Error HWCSession::CreateVirtualDisplayObj(uint32_t width, uint32_t height,
       map_info.disp_type = kVirtual;
       map_info.sdm_id = display_id;
       map_active_displays_.insert(std::make_pair(client_id, &map_info));
+      PublishDisplayConfigs(client_id);
 
       VirtualDisplayData vds_data;
       vds_data.width = width;
@@ -1458,66 +1824,128 @@ bool HWCSession::IsVirtualDisplayConnected() {
   return connected;
 }
 
+namespace {
+
+// Parcel requirements for the QService commands handled by notifyCallback(),
+// indexed by command code. A zero entry marks an unsupported command. Keeping
+// this as flat data lets notifyCallback() validate the parcels once up front
+// instead of repeating the checks in every case of the dispatch switch.
+constexpr uint8_t kNeedsInputParcel = 1 << 0;
+constexpr uint8_t kNeedsOutputParcel = 1 << 1;
+constexpr uint8_t kNeedsBothParcels = kNeedsInputParcel | kNeedsOutputParcel;
+
+std::array<uint8_t, qService::IQService::COMMAND_LIST_END> InitQServiceParcelFlags() {
+  std::array<uint8_t, qService::IQService::COMMAND_LIST_END> flags = {};
+  using qService::IQService;
+  flags[IQService::DYNAMIC_DEBUG] = kNeedsInputParcel;
+  flags[IQService::SCREEN_REFRESH] = kNeedsInputParcel;
+  flags[IQService::SET_IDLE_TIMEOUT] = kNeedsInputParcel;
+  flags[IQService::SET_FRAME_DUMP_CONFIG] = kNeedsInputParcel;
+  flags[IQService::SET_MAX_PIPES_PER_MIXER] = kNeedsInputParcel;
+  flags[IQService::SET_DISPLAY_MODE] = kNeedsInputParcel;
+  flags[IQService::SET_SECONDARY_DISPLAY_STATUS] = kNeedsBothParcels;
+  flags[IQService::CONFIGURE_DYN_REFRESH_RATE] = kNeedsInputParcel;
+  flags[IQService::TOGGLE_SCREEN_UPDATES] = kNeedsBothParcels;
+  flags[IQService::QDCM_SVC_CMDS] = kNeedsBothParcels;
+  flags[IQService::MIN_HDCP_ENCRYPTION_LEVEL_CHANGED] = kNeedsBothParcels;
+  flags[IQService::CONTROL_PARTIAL_UPDATE] = kNeedsBothParcels;
+  flags[IQService::SET_NOISE_PLUGIN_OVERRIDE] = kNeedsInputParcel;
+  flags[IQService::SET_ACTIVE_CONFIG] = kNeedsInputParcel;
+  flags[IQService::GET_ACTIVE_CONFIG] = kNeedsBothParcels;
+  flags[IQService::GET_CONFIG_COUNT] = kNeedsBothParcels;
+  flags[IQService::GET_DISPLAY_ATTRIBUTES_FOR_CONFIG] = kNeedsBothParcels;
+  flags[IQService::GET_PANEL_BRIGHTNESS] = kNeedsBothParcels;
+  flags[IQService::SET_PANEL_BRIGHTNESS] = kNeedsBothParcels;
+  flags[IQService::GET_DISPLAY_VISIBLE_REGION] = kNeedsBothParcels;
+  flags[IQService::SET_CAMERA_STATUS] = kNeedsInputParcel;
+  flags[IQService::GET_BW_TRANSACTION_STATUS] = kNeedsOutputParcel;
+  flags[IQService::SET_LAYER_MIXER_RESOLUTION] = kNeedsInputParcel;
+  flags[IQService::SET_COLOR_MODE] = kNeedsInputParcel;
+  flags[IQService::SET_COLOR_MODE_WITH_RENDER_INTENT] = kNeedsInputParcel;
+  flags[IQService::SET_COLOR_MODE_BY_ID] = kNeedsInputParcel;
+  flags[IQService::GET_COMPOSER_STATUS] = kNeedsOutputParcel;
+  flags[IQService::SET_QSYNC_MODE] = kNeedsInputParcel;
+  flags[IQService::SET_COLOR_SAMPLING_ENABLED] = kNeedsInputParcel;
+  flags[IQService::SET_IDLE_PC] = kNeedsInputParcel;
+  flags[IQService::SET_DPPS_AD4_ROI_CONFIG] = kNeedsInputParcel;
+  flags[IQService::SET_DSI_CLK] = kNeedsInputParcel;
+  flags[IQService::SET_JITTER_CONFIG] = kNeedsInputParcel;
+  flags[IQService::GET_DSI_CLK] = kNeedsBothParcels;
+  flags[IQService::GET_SUPPORTED_DSI_CLK] = kNeedsBothParcels;
+  flags[IQService::SET_PANEL_LUMINANCE] = kNeedsInputParcel;
+  flags[IQService::SET_COLOR_MODE_FROM_CLIENT] = kNeedsInputParcel;
+  flags[IQService::SET_FRAME_TRIGGER_MODE] = kNeedsInputParcel;
+  flags[IQService::SET_BRIGHTNESS_SCALE] = kNeedsInputParcel;
+  flags[IQService::SET_BPP_MODE] = kNeedsInputParcel;
+  flags[IQService::NOTIFY_APP_LAUNCH] = kNeedsInputParcel;
+  flags[IQService::GET_FRAME_DROP_STATS] = kNeedsBothParcels;
+  flags[IQService::SET_VSYNC_STATE] = kNeedsBothParcels;
+  flags[IQService::NOTIFY_TUI_TRANSITION] = kNeedsBothParcels;
+  flags[IQService::GET_DISPLAY_PORT_ID] = kNeedsBothParcels;
+#ifdef PROFILE_COVERAGE_DATA
+  flags[IQService::DUMP_CODE_COVERAGE] = kNeedsInputParcel;
+#endif
+  flags[IQService::SET_DIMMING_ENABLE] = kNeedsBothParcels;
+  flags[IQService::SET_DIMMING_MIN_BL] = kNeedsBothParcels;
+  flags[IQService::UPDATE_TRANSFER_TIME] = kNeedsInputParcel;
+  flags[IQService::RETRIEVE_DEMURATN_FILES] = kNeedsBothParcels;
+  flags[IQService::SET_DEMURA_STATE] = kNeedsBothParcels;
+  flags[IQService::SET_DEMURA_CONFIG] = kNeedsBothParcels;
+  return flags;
+}
+
+const std::array<uint8_t, qService::IQService::COMMAND_LIST_END> kQServiceParcelFlags =
+    InitQServiceParcelFlags();
+
+}  // namespace
+
 // Qclient methods
 android::status_t HWCSession::notifyCallback(uint32_t command, const android::Parcel *input_parcel,
                                              android::Parcel *output_parcel) {
   android::status_t status = -EINVAL;
 
+  uint8_t parcel_flags = (command < kQServiceParcelFlags.size()) ? kQServiceParcelFlags[command]
+                                                                 : uint8_t(0);
+  if (!parcel_flags) {
+    DLOGW("QService command = %d is not supported.", command);
+    return status;
+  }
+  if ((parcel_flags & kNeedsInputParcel) && !input_parcel) {
+    DLOGE("QService command = %d: input_parcel needed.", command);
+    return status;
+  }
+  if ((parcel_flags & kNeedsOutputParcel) && !output_parcel) {
+    DLOGE("QService command = %d: output_parcel needed.", command);
+    return status;
+  }
+
   switch (command) {
     case qService::IQService::DYNAMIC_DEBUG:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = 0;
       DynamicDebug(input_parcel);
       break;
 
     case qService::IQService::SCREEN_REFRESH:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = RefreshScreen(input_parcel);
       break;
 
     case qService::IQService::SET_IDLE_TIMEOUT:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetIdleTimeout(UINT32(input_parcel->readInt32()));
       break;
 
     case qService::IQService::SET_FRAME_DUMP_CONFIG:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetFrameDumpConfig(input_parcel);
       break;
 
     case qService::IQService::SET_MAX_PIPES_PER_MIXER:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetMaxMixerStages(input_parcel);
       break;
 
     case qService::IQService::SET_DISPLAY_MODE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetDisplayMode(input_parcel);
       break;
 
     case qService::IQService::SET_SECONDARY_DISPLAY_STATUS: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = INT(input_parcel->readInt32());
       HWCDisplay::DisplayStatus disp_status =
           static_cast<HWCDisplay::DisplayStatus>(input_parcel->readInt32());
@@ -1526,36 +1954,20 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::CONFIGURE_DYN_REFRESH_RATE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = ConfigureRefreshRate(input_parcel);
       break;
 
     case qService::IQService::TOGGLE_SCREEN_UPDATES: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int32_t input = input_parcel->readInt32();
       status = ToggleScreenUpdate(input == 1);
       output_parcel->writeInt32(status);
     } break;
 
     case qService::IQService::QDCM_SVC_CMDS:
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = QdcmCMDHandler(input_parcel, output_parcel);
       break;
 
     case qService::IQService::MIN_HDCP_ENCRYPTION_LEVEL_CHANGED: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       uint32_t min_enc_level = UINT32(input_parcel->readInt32());
       status = MinHdcpEncryptionLevelChanged(disp_id, min_enc_level);
@@ -1563,10 +1975,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::CONTROL_PARTIAL_UPDATE: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       uint32_t enable = UINT32(input_parcel->readInt32());
       status = ControlPartialUpdate(disp_id, enable == 1);
@@ -1574,11 +1982,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::SET_NOISE_PLUGIN_OVERRIDE: {
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
-
       int32_t disp_id = input_parcel->readInt32();
 
       bool override_en = ((input_parcel->readInt32()) == 1);
@@ -1597,20 +2000,12 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::SET_ACTIVE_CONFIG: {
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       uint32_t config = UINT32(input_parcel->readInt32());
       int disp_id = input_parcel->readInt32();
       status = SetActiveConfigIndex(disp_id, config);
     } break;
 
     case qService::IQService::GET_ACTIVE_CONFIG: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       uint32_t config = 0;
       status = GetActiveConfigIndex(disp_id, &config);
@@ -1618,10 +2013,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::GET_CONFIG_COUNT: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       uint32_t count = 0;
       status = GetConfigCount(disp_id, &count);
@@ -1629,19 +2020,10 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::GET_DISPLAY_ATTRIBUTES_FOR_CONFIG:
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = GetDisplayAttributesForConfig(input_parcel, output_parcel);
       break;
 
     case qService::IQService::GET_PANEL_BRIGHTNESS: {
-      if (!output_parcel) {
-        DLOGE("QService command = %d: output_parcel needed.", command);
-        break;
-      }
-
       uint32_t display = input_parcel->readUint32();
       uint32_t max_brightness_level = 0;
       status = getDisplayMaxBrightness(display, &max_brightness_level);
@@ -1662,11 +2044,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::SET_PANEL_BRIGHTNESS: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
-
       uint32_t max_brightness_level = 0;
       uint32_t display = HWC_DISPLAY_PRIMARY;
       status = getDisplayMaxBrightness(display, &max_brightness_level);
@@ -1678,192 +2055,141 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
       DLOGV("Panel Max brightness is %u", max_brightness_level);
 
       int level = input_parcel->readInt32();
-      if (level == 0) {
-        status = INT32(SetDisplayBrightness(display, -1.0f));
+      // Optional trailing (duration_ms, curve) animates the change on the commit thread,
+      // one request for the whole ramp instead of one binder call per step.
+      uint32_t duration_ms = 0;
+      uint32_t curve = 0;
+      if (input_parcel->dataAvail() >= sizeof(int32_t)) {
+        duration_ms = UINT32(input_parcel->readInt32());
+      }
+      if (input_parcel->dataAvail() >= sizeof(int32_t)) {
+        curve = UINT32(input_parcel->readInt32());
+      }
+
+      float brightness =
+          (level == 0) ? -1.0f : (level - 1) / (static_cast<float>(max_brightness_level - 1));
+      if (duration_ms && hwc_display_[display]) {
+        status = INT32(hwc_display_[display]->SetPanelBrightnessAnimated(brightness, duration_ms,
+                                                                         curve));
       } else {
-        status = INT32(SetDisplayBrightness(
-            display, (level - 1) / (static_cast<float>(max_brightness_level - 1))));
+        status = INT32(SetDisplayBrightness(display, brightness));
       }
       output_parcel->writeInt32(status);
     } break;
 
     case qService::IQService::GET_DISPLAY_VISIBLE_REGION:
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = GetVisibleDisplayRect(input_parcel, output_parcel);
       break;
 
     case qService::IQService::SET_CAMERA_STATUS: {
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       uint32_t camera_status = UINT32(input_parcel->readInt32());
       status = SetCameraLaunchStatus(camera_status);
     } break;
 
     case qService::IQService::GET_BW_TRANSACTION_STATUS: {
-      if (!output_parcel) {
-        DLOGE("QService command = %d: output_parcel needed.", command);
-        break;
-      }
       bool state = true;
       status = DisplayBWTransactionPending(&state);
       output_parcel->writeInt32(state);
     } break;
 
     case qService::IQService::SET_LAYER_MIXER_RESOLUTION:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetMixerResolution(input_parcel);
       break;
 
     case qService::IQService::SET_COLOR_MODE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetColorModeOverride(input_parcel);
       break;
 
     case qService::IQService::SET_COLOR_MODE_WITH_RENDER_INTENT:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetColorModeWithRenderIntentOverride(input_parcel);
       break;
 
     case qService::IQService::SET_COLOR_MODE_BY_ID:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetColorModeById(input_parcel);
       break;
 
     case qService::IQService::GET_COMPOSER_STATUS:
-      if (!output_parcel) {
-        DLOGE("QService command = %d: output_parcel needed.", command);
-        break;
-      }
       status = 0;
       output_parcel->writeInt32(getComposerStatus());
       break;
 
     case qService::IQService::SET_QSYNC_MODE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetQSyncMode(input_parcel);
       break;
 
     case qService::IQService::SET_COLOR_SAMPLING_ENABLED:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = setColorSamplingEnabled(input_parcel);
       break;
 
     case qService::IQService::SET_IDLE_PC:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetIdlePC(input_parcel);
       break;
 
     case qService::IQService::SET_DPPS_AD4_ROI_CONFIG:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetAd4RoiConfig(input_parcel);
       break;
 
     case qService::IQService::SET_DSI_CLK:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetDsiClk(input_parcel);
       break;
 
     case qService::IQService::SET_JITTER_CONFIG:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetJitterConfig(input_parcel);
       break;
 
     case qService::IQService::GET_DSI_CLK:
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = GetDsiClk(input_parcel, output_parcel);
       break;
 
     case qService::IQService::GET_SUPPORTED_DSI_CLK:
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = GetSupportedDsiClk(input_parcel, output_parcel);
       break;
 
     case qService::IQService::SET_PANEL_LUMINANCE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetPanelLuminanceAttributes(input_parcel);
       break;
 
     case qService::IQService::SET_COLOR_MODE_FROM_CLIENT:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetColorModeFromClient(input_parcel);
       break;
 
     case qService::IQService::SET_FRAME_TRIGGER_MODE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetFrameTriggerMode(input_parcel);
       break;
 
     case qService::IQService::SET_BRIGHTNESS_SCALE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = INT32(SetDisplayBrightnessScale(input_parcel));
       break;
 
     case qService::IQService::SET_BPP_MODE:
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = SetBppMode(input_parcel);
       break;
 
-    case qService::IQService::SET_VSYNC_STATE: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("Qservice command = %d: input_parcel needed.", command);
+    case qService::IQService::NOTIFY_APP_LAUNCH: {
+      int disp_id = input_parcel->readInt32();
+      status = NotifyAppLaunch(disp_id);
+    } break;
+
+    case qService::IQService::GET_FRAME_DROP_STATS: {
+      uint32_t display = input_parcel->readUint32();
+      if (display >= HWCCallbacks::kNumDisplays || !hwc_display_[display]) {
+        status = -ENODEV;
         break;
       }
+      uint64_t total_frames = 0;
+      uint64_t late_frames = 0;
+      uint64_t cause_counts[kDropCauseCount] = {};
+      hwc_display_[display]->GetFrameDropStats(&total_frames, &late_frames, cause_counts);
+      output_parcel->writeUint64(total_frames);
+      output_parcel->writeUint64(late_frames);
+      output_parcel->writeUint32(kDropCauseCount);
+      for (uint32_t cause = 0; cause < kDropCauseCount; cause++) {
+        output_parcel->writeUint64(cause_counts[cause]);
+      }
+      status = 0;
+    } break;
+
+    case qService::IQService::SET_VSYNC_STATE: {
       auto display = input_parcel->readInt32();
       int32_t enable = input_parcel->readInt32();
       bool vsync_state = false;
@@ -1877,10 +2203,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::NOTIFY_TUI_TRANSITION: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int event = input_parcel->readInt32();
       status = HandleTUITransition(disp_id, event);
@@ -1888,10 +2210,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::GET_DISPLAY_PORT_ID: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int port_id = 0;
       status = GetDisplayPortId(disp_id, &port_id);
@@ -1899,10 +2217,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 #ifdef PROFILE_COVERAGE_DATA
     case qService::IQService::DUMP_CODE_COVERAGE: {
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = DumpCodeCoverage(input_parcel);
       DLOGD("QService command = DUMP_CODE_COVERAGE status: %d", status);
       break;
@@ -1910,10 +2224,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
 #endif
 
     case qService::IQService::SET_DIMMING_ENABLE: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int enable = input_parcel->readInt32();
       status = INT32(SetDimmingEnable(disp_id, enable));
@@ -1921,10 +2231,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::SET_DIMMING_MIN_BL: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int min_bl = input_parcel->readInt32();
       status = INT32(SetDimmingMinBl(disp_id, min_bl));
@@ -1932,27 +2238,15 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::UPDATE_TRANSFER_TIME: {
-      if (!input_parcel) {
-        DLOGE("QService command = %d: input_parcel needed.", command);
-        break;
-      }
       status = UpdateTransferTime(input_parcel);
     } break;
 
     case qService::IQService::RETRIEVE_DEMURATN_FILES: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       status = RetrieveDemuraTnFiles(input_parcel);
       output_parcel->writeInt32(status);
     } break;
 
     case qService::IQService::SET_DEMURA_STATE: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int state = input_parcel->readInt32();
       status = INT32(SetDemuraState(disp_id, state));
@@ -1960,10 +2254,6 @@ android::status_t HWCSession::notifyCallback(uint32_t command, const android::Pa
     } break;
 
     case qService::IQService::SET_DEMURA_CONFIG: {
-      if (!input_parcel || !output_parcel) {
-        DLOGE("QService command = %d: input_parcel and output_parcel needed.", command);
-        break;
-      }
       int disp_id = input_parcel->readInt32();
       int demura_idx = input_parcel->readInt32();
       status = INT32(SetDemuraConfig(disp_id, demura_idx));
@@ -2913,6 +3203,13 @@ int HWCSession::CreatePrimaryDisplay() {
         }
 
         map_active_displays_.insert(std::make_pair(client_id, &map_info_primary_));
+        PublishDisplayConfigs(client_id);
+
+        if (enable_state_journal_ && state_journal_.IsRecovery()) {
+          // Crash restart within the same boot: put the last committed state
+          // back without waiting for the framework round trip.
+          RestoreDisplayState(client_id);
+        }
       } else {
         DLOGE("Primary display creation has failed! status = %d", status);
         return status;
@@ -2989,6 +3286,7 @@ int HWCSession::HandleBuiltInDisplays() {
         map_info.sdm_id = info.display_id;
 
         map_active_displays_.insert(std::make_pair(client_id, &map_info));
+        PublishDisplayConfigs(client_id);
       }
 
       DLOGI("Hotplugging builtin display, sdm id = %d, client id = %d", info.display_id,
@@ -3201,6 +3499,7 @@ int HWCSession::HandleConnectedDisplays(HWDisplaysInfo *hw_displays_info, bool d
       map_info.sdm_id = info.display_id;
 
       map_active_displays_.insert(std::make_pair(client_id, &map_info));
+      PublishDisplayConfigs(client_id);
 
       pending_hotplugs_.push_back((Display)client_id);
 
@@ -3391,6 +3690,8 @@ void HWCSession::DestroyPluggableDisplayLocked(DisplayMapInfo *map_info) {
   display_ready_.reset(UINT32(client_id));
   pending_power_mode_[client_id] = false;
   hwc_display = nullptr;
+  PublishDisplayState(client_id);
+  PublishDisplayConfigs(client_id);
   map_info->Reset();
 }
 
@@ -3429,6 +3730,8 @@ void HWCSession::DestroyNonPluggableDisplayLocked(DisplayMapInfo *map_info) {
   pending_power_mode_[client_id] = false;
   hwc_display = nullptr;
   display_ready_.reset(UINT32(client_id));
+  PublishDisplayState(client_id);
+  PublishDisplayConfigs(client_id);
   map_info->Reset();
 }
 
@@ -3444,72 +3747,75 @@ void HWCSession::RemoveDisconnectedPluggableDisplays() {
   HandleDisconnectedDisplays(&hw_displays_info);
 }
 
-void HWCSession::PerformDisplayPowerReset() {
-  RemoveDisconnectedPluggableDisplays();
-
-  // Wait until all commands are flushed.
-  std::lock_guard<std::mutex> lock(command_seq_mutex_);
+void HWCSession::PerformDisplayPowerReset(Display display) {
+  // Staged recovery: only the display that reported the failure is power cycled. The
+  // other displays keep scanning out and their SDM objects and cached configs stay
+  // live, so the visible interruption is confined to the dead panel's power/init
+  // sequence instead of a teardown and re-init of every display in the system.
+  bool pluggable = false;
+  {
+    SCOPE_LOCK(locker_[display]);
+    if (!hwc_display_[display]) {
+      DLOGW("Display = %d is not connected.", INT32(display));
+      return;
+    }
+    pluggable = (hwc_display_[display]->GetDisplayClass() == DISPLAY_CLASS_PLUGGABLE);
+  }
 
-  // Acquire lock on all displays.
-  for (Display display = HWC_DISPLAY_PRIMARY; display < HWCCallbacks::kNumDisplays; display++) {
-    locker_[display].Lock();
+  // A pluggable display may have been unplugged while it was dead; resync the
+  // connection state before power cycling it.
+  if (pluggable) {
+    RemoveDisconnectedPluggableDisplays();
   }
 
-  HWC3::Error status = HWC3::Error::None;
-  PowerMode last_power_mode[HWCCallbacks::kNumDisplays] = {};
+  // Wait until all commands are flushed.
+  std::lock_guard<std::mutex> lock(command_seq_mutex_);
 
-  for (Display display = HWC_DISPLAY_PRIMARY; display < HWCCallbacks::kNumDisplays; display++) {
-    if (hwc_display_[display] != NULL) {
-      last_power_mode[display] = hwc_display_[display]->GetCurrentPowerMode();
-      DLOGI("Powering off display = %d", INT32(display));
-      status = hwc_display_[display]->SetPowerMode(PowerMode::OFF, true /* teardown */);
-      if (status != HWC3::Error::None) {
-        DLOGE("Power off for display = %d failed with error = %d", INT32(display), status);
-      }
+  {
+    SCOPE_LOCK(locker_[display]);
+    if (!hwc_display_[display]) {
+      DLOGW("Display = %d disconnected while its reset was pending.", INT32(display));
+      return;
     }
-  }
 
-  for (Display display = HWC_DISPLAY_PRIMARY; display < HWCCallbacks::kNumDisplays; display++) {
-    if (hwc_display_[display] != NULL) {
-      PowerMode mode = last_power_mode[display];
-      DLOGI("Setting display %d to mode = %d", INT32(display), mode);
-      status = hwc_display_[display]->SetPowerMode(mode, false /* teardown */);
-      if (status != HWC3::Error::None) {
-        DLOGE("%d mode for display = %d failed with error = %d", mode, INT32(display), status);
-      }
-      ColorMode color_mode = hwc_display_[display]->GetCurrentColorMode();
-      RenderIntent render_intent = hwc_display_[display]->GetCurrentRenderIntent();
-      status = hwc_display_[display]->SetColorModeWithRenderIntent(color_mode, render_intent);
-      if (status != HWC3::Error::None) {
-        DLOGE("SetColorMode failed for display = %d error = %d", INT32(display), status);
-      }
+    HWC3::Error status = HWC3::Error::None;
+    PowerMode last_power_mode = hwc_display_[display]->GetCurrentPowerMode();
+    DLOGI("Powering off display = %d", INT32(display));
+    status = hwc_display_[display]->SetPowerMode(PowerMode::OFF, true /* teardown */);
+    if (status != HWC3::Error::None) {
+      DLOGE("Power off for display = %d failed with error = %d", INT32(display), status);
     }
-  }
 
-  Display vsync_source = callbacks_.GetVsyncSource();
-  // adb shell stop sets vsync source as max display
-  if (vsync_source != HWCCallbacks::kNumDisplays && hwc_display_[vsync_source]) {
-    status = hwc_display_[vsync_source]->SetVsyncEnabled(true);
+    DLOGI("Setting display %d to mode = %d", INT32(display), last_power_mode);
+    status = hwc_display_[display]->SetPowerMode(last_power_mode, false /* teardown */);
     if (status != HWC3::Error::None) {
-      DLOGE("Enabling vsync failed for disp: %" PRIu64 " with error = %d", vsync_source, status);
+      DLOGE("%d mode for display = %d failed with error = %d", last_power_mode, INT32(display),
+            status);
+    }
+    ColorMode color_mode = hwc_display_[display]->GetCurrentColorMode();
+    RenderIntent render_intent = hwc_display_[display]->GetCurrentRenderIntent();
+    status = hwc_display_[display]->SetColorModeWithRenderIntent(color_mode, render_intent);
+    if (status != HWC3::Error::None) {
+      DLOGE("SetColorMode failed for display = %d error = %d", INT32(display), status);
     }
-  }
 
-  // Release lock on all displays.
-  for (Display display = HWC_DISPLAY_PRIMARY; display < HWCCallbacks::kNumDisplays; display++) {
-    locker_[display].Unlock();
+    if (display == callbacks_.GetVsyncSource()) {
+      status = hwc_display_[display]->SetVsyncEnabled(true);
+      if (status != HWC3::Error::None) {
+        DLOGE("Enabling vsync failed for disp: %" PRIu64 " with error = %d", display, status);
+      }
+    }
   }
 
-  // Do not call refresh if valid vsync source is not set i,e. Its kNumDisplay
-  if (vsync_source != HWCCallbacks::kNumDisplays) {
-    callbacks_.Refresh(vsync_source);
-  }
+  // The client still holds the buffers of the last committed frame; the refresh makes it
+  // re-present that content as soon as the link is back up.
+  callbacks_.Refresh(display);
 }
 
-void HWCSession::DisplayPowerReset() {
+void HWCSession::DisplayPowerReset(Display display) {
   // Do Power Reset in a different thread to avoid blocking of SDM event thread
   // when disconnecting display.
-  std::thread(&HWCSession::PerformDisplayPowerReset, this).detach();
+  std::thread(&HWCSession::PerformDisplayPowerReset, this, display).detach();
 }
 
 void HWCSession::VmReleaseDone(Display display) {
@@ -3624,6 +3930,8 @@ void HWCSession::HandlePendingPowerMode(Display disp_id, const shared_ptr<Fence>
     return;
   }
 
+  std::vector<Display> power_down_list;
+  std::vector<Display> power_up_list;
   for (Display display = HWC_DISPLAY_PRIMARY + 1; display < HWCCallbacks::kNumDisplays; display++) {
     if (display == active_builtin_disp_id) {
       continue;
@@ -3666,18 +3974,55 @@ void HWCSession::HandlePendingPowerMode(Display disp_id, const shared_ptr<Fence>
     if (pending_mode == PowerMode::OFF || pending_mode == PowerMode::DOZE_SUSPEND) {
       map_active_displays_.erase(display);
       active_displays_.erase(display);
+      power_down_list.push_back(display);
     } else {
       map_active_displays_.insert(std::make_pair(disp_map_info->client_id, disp_map_info));
       active_displays_.insert(display);
+      power_up_list.push_back(display);
     }
+  }
+
+  // Replay the cached transitions in two waves rather than summing every panel's power
+  // sequence serially: first every display heading down, then every display coming up. Rails
+  // shared between panels are released by the down wave before the up wave loads them, and the
+  // panels within a wave power in parallel, so a dual-panel transition pays the slowest
+  // sequence instead of the sum. pending_power_mode_[display] stays set until a wave worker
+  // clears it, which keeps client-driven power requests rejected in the meantime.
+  bool refresh_needed = false;
+  auto apply_pending_mode = [this](Display display, uint8_t *success) {
+    SCOPE_LOCK(locker_[display]);
+    if (!hwc_display_[display]) {
+      return;
+    }
+    PowerMode pending_mode = hwc_display_[display]->GetPendingPowerMode();
     HWC3::Error error = hwc_display_[display]->SetPowerMode(pending_mode, false);
     if (HWC3::Error::None == error) {
       pending_power_mode_[display] = false;
       hwc_display_[display]->ClearPendingPowerMode();
-      pending_refresh_.set(UINT32(HWC_DISPLAY_PRIMARY));
+      *success = 1;
     } else {
       DLOGE("SetDisplayStatus error = %d (%s)", error, to_string(error).c_str());
     }
+  };
+  for (const auto &wave : {power_down_list, power_up_list}) {
+    std::vector<uint8_t> success(wave.size(), 0);
+    if (wave.size() == 1) {
+      apply_pending_mode(wave.at(0), &success.at(0));
+    } else if (wave.size() > 1) {
+      std::vector<std::thread> workers;
+      for (uint32_t i = 0; i < wave.size(); i++) {
+        workers.emplace_back(apply_pending_mode, wave.at(i), &success.at(i));
+      }
+      for (auto &worker : workers) {
+        worker.join();
+      }
+    }
+    for (uint8_t display_done : success) {
+      refresh_needed |= (display_done != 0);
+    }
+  }
+  if (refresh_needed) {
+    deferred_actions_.Push({kDeferredRefresh, HWC_DISPLAY_PRIMARY});
   }
 
   secure_session_active_ = false;
@@ -4623,6 +4968,18 @@ HWC3::Error HWCSession::CommitOrPrepare(Display display, bool validate_only,
   }
 
   HandleSecureSession();
+
+  return CommitOrPrepareInternal(display, validate_only, out_retire_fence, out_num_types,
+                                 out_num_requests, needs_commit);
+}
+
+HWC3::Error HWCSession::CommitOrPrepareInternal(Display display, bool validate_only,
+                                                shared_ptr<Fence> *out_retire_fence,
+                                                uint32_t *out_num_types,
+                                                uint32_t *out_num_requests, bool *needs_commit) {
+  // The real validate for this frame is here; let the next frame speculate again.
+  speculative_prepare_kicked_[display].store(false);
+
   auto status = HWC3::Error::None;
   {
     SEQUENCE_ENTRY_SCOPE_LOCK(locker_[display]);
@@ -38,11 +38,15 @@
 #include <core/ipc_interface.h>
 #include <utils/locker.h>
 #include <utils/constants.h>
+#include <utils/Timers.h>
 #include <display_config.h>
 #include <vector>
 #include <queue>
 #include <utility>
 #include <future>  // NOLINT
+#include <deque>
+#include <thread>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <string>
@@ -51,6 +55,7 @@
 #include <core/display_interface.h>
 
 #include "hwc_callbacks.h"
+#include "hwc_deferred_actions.h"
 #include "hwc_layers.h"
 #include "hwc_display.h"
 #include "hwc_display_builtin.h"
@@ -62,6 +67,7 @@
 #include "hwc_display_event_handler.h"
 #include "hwc_buffer_sync_handler.h"
 #include "hwc_display_virtual_factory.h"
+#include "hwc_state_journal.h"
 
 using ::android::sp;
 using android::hardware::hidl_handle;
@@ -309,8 +315,8 @@ class HWCSession : public HWCUEvent,
   int NotifyTUIEventDone(int disp_id, TUIEventType event_type);
 
   // HWCDisplayEventHandler
-  virtual void DisplayPowerReset();
-  virtual void PerformDisplayPowerReset();
+  virtual void DisplayPowerReset(Display display);
+  virtual void PerformDisplayPowerReset(Display display);
   virtual void PerformQsyncCallback(Display display, bool qsync_enabled, uint32_t refresh_rate,
                                     uint32_t qsync_refresh_rate);
   virtual void VmReleaseDone(Display display);
@@ -397,6 +403,27 @@ class HWCSession : public HWCUEvent,
     HWCSession *hwc_session_ = nullptr;
   };
 
+  // Dedicated worker thread per display, used to run speculative prepares off the command
+  // thread while it is still parsing the rest of the batch. Per-display ordering is retained
+  // by the FIFO task queue; tasks serialize with the inline present path on the display locker.
+  class PresentWorker {
+   public:
+    explicit PresentWorker(Display display);
+    ~PresentWorker();
+
+    std::future<HWC3::Error> Post(std::function<HWC3::Error()> task);
+
+   private:
+    void ProcessTasks();
+
+    Display display_ = 0;
+    std::deque<std::packaged_task<HWC3::Error()>> task_queue_;
+    std::mutex task_lock_;
+    std::condition_variable task_cv_;
+    bool exit_ = false;
+    std::thread worker_thread_;
+  };
+
   struct DisplayMapInfo {
     Display client_id = HWCCallbacks::kNumDisplays;  // mapped sf id for this display
     int32_t sdm_id = -1;                             // sdm id for this display
@@ -452,6 +479,7 @@ class HWCSession : public HWCUEvent,
   int SetIdleTimeout(uint32_t value);
   int ToggleScreenUpdate(bool on);
   int SetCameraLaunchStatus(uint32_t on);
+  int NotifyAppLaunch(int disp_id);
   int SetDisplayDppsAdROI(uint32_t display_id, uint32_t h_start, uint32_t h_end, uint32_t v_start,
                           uint32_t v_end, uint32_t factor_in, uint32_t factor_out);
   int ControlIdlePowerCollapse(bool enable, bool synchronous);
@@ -535,6 +563,17 @@ class HWCSession : public HWCUEvent,
   HWC3::Error TeardownConcurrentWriteback(Display display);
   void PostCommitUnlocked(Display display, const shared_ptr<Fence> &retire_fence);
   void PostCommitLocked(Display display, shared_ptr<Fence> &retire_fence);
+  void JournalDisplayState(Display display);
+  void RestoreDisplayState(Display client_id);
+  void PublishDisplayState(Display display);
+  void PublishDisplayConfigs(Display display);
+  bool ReadDisplayState(int disp_idx, uint32_t *active_config, uint32_t *refresh_rate, bool *doze);
+  HWC3::Error PresentDisplayInternal(Display display, shared_ptr<Fence> *out_retire_fence);
+  HWC3::Error CommitOrPrepareInternal(Display display, bool validate_only,
+                                      shared_ptr<Fence> *out_retire_fence, uint32_t *out_num_types,
+                                      uint32_t *out_num_requests, bool *needs_commit);
+  PresentWorker *GetPresentWorker(Display display);
+  void KickSpeculativePrepare(Display display);
   int WaitForCommitDone(Display display, int client_id);
   int WaitForCommitDoneAsync(Display display, int client_id);
   void NotifyDisplayAttributes(Display display, Config config);
@@ -567,6 +606,8 @@ class HWCSession : public HWCUEvent,
   std::map<Display, Display> map_hwc_display_;  // Real and dummy display pairs.
   bool reset_panel_ = false;
   bool client_connected_ = false;
+  HWCStateJournal state_journal_;
+  bool enable_state_journal_ = false;
   bool new_bw_mode_ = false;
   int bw_mode_release_fd_ = -1;
   qService::QService *qservice_ = nullptr;
@@ -577,6 +618,25 @@ class HWCSession : public HWCUEvent,
   static bool pending_power_mode_[HWCCallbacks::kNumDisplays];
   HotPlugEvent pending_hotplug_event_ = kHotPlugNone;
 
+  // Hot read-only display state mirrored for lock-free client queries.
+  // Writers update the snapshot while holding locker_[display]; readers use
+  // the sequence counter to detect torn reads instead of taking the lock.
+  struct DisplayStateSnapshot {
+    std::atomic<uint32_t> seq {0};
+    uint32_t active_config = 0;
+    uint32_t refresh_rate = 0;
+    bool doze = false;
+    bool valid = false;
+  };
+  DisplayStateSnapshot display_state_snapshot_[HWCCallbacks::kNumDisplays];
+
+  // Per-display immutable config lists. A display's config set is fixed once UpdateConfigs()
+  // has run during HWCDisplay creation, so the list is published from the create/destroy
+  // paths and getDisplayConfigurations is served from it without entering locker_[display].
+  std::shared_ptr<const std::vector<DisplayConfiguration>>
+      display_configs_snapshot_[HWCCallbacks::kNumDisplays];
+  std::mutex display_configs_lock_;  // guards the snapshot pointers only
+
   struct VirtualDisplayData {
     uint32_t width;
     uint32_t height;
@@ -592,7 +652,10 @@ class HWCSession : public HWCUEvent,
   int32_t enable_primary_reconfig_req_ = 0;
   float set_max_lum_ = -1.0;
   float set_min_lum_ = -1.0;
-  std::bitset<HWCCallbacks::kNumDisplays> pending_refresh_;
+  // Cross-thread deferred actions, drained once per present in PostCommitUnlocked(). Producers
+  // must not need a display locker or a fence wait at drain time; deferrals that do (pending
+  // power modes, hotplugs) keep their own handlers.
+  DeferredActionQueue deferred_actions_;
   CWB cwb_;
   std::weak_ptr<DisplayConfig::ConfigCallback> qsync_callback_;
   std::weak_ptr<DisplayConfig::ConfigCallback> idle_callback_;
@@ -600,6 +663,11 @@ class HWCSession : public HWCUEvent,
   std::unordered_map<int64_t, std::shared_ptr<IDisplayConfigCallback>> callback_clients_;
   uint64_t callback_client_id_ = 0;
   bool async_vds_creation_ = false;
+  std::mutex present_worker_lock_;
+  std::unique_ptr<PresentWorker> present_worker_[HWCCallbacks::kNumDisplays];
+  bool speculative_prepare_enabled_ = false;
+  // One speculative prepare per display per frame; cleared when the real validate runs.
+  std::atomic<bool> speculative_prepare_kicked_[HWCCallbacks::kNumDisplays] {};
   bool tui_state_transition_[HWCCallbacks::kNumDisplays] = {};
   std::bitset<HWCCallbacks::kNumDisplays> display_ready_;
   bool secure_session_active_ = false;
@@ -626,6 +694,24 @@ class HWCSession : public HWCUEvent,
   // it up to terminate it before terminating hwc.
   void HpdThreadBottom();
   std::thread hpd_thread_;
+  // One-shot worker for the initial pluggable display probe, so callback registration does
+  // not block the client on connector probing. Joined on re-registration and teardown.
+  std::thread pluggable_probe_thread_;
+
+  // Boot milestones in CLOCK_MONOTONIC time, recorded once per composer instance and reported
+  // in the bootstat section of Dump() so first-frame latency can be read from a bugreport.
+  struct BootTimeline {
+    nsecs_t init_start = 0;       // Entry of Init()
+    nsecs_t core_created = 0;     // Display core up, primary hotplug seen
+    nsecs_t primary_created = 0;  // Primary HWCDisplay constructed
+    nsecs_t init_done = 0;        // Exit of Init()
+    nsecs_t first_commit = 0;     // First successful commit on the primary display
+  };
+  BootTimeline boot_timeline_;
+
+  // Makes the first gralloc allocation during core bring-up instead of on the first
+  // framebuffer-target allocation. Joined in Deinit().
+  std::thread gralloc_warmup_thread_;
 
   std::vector<Display> pending_hotplugs_{};
 };
@@ -180,6 +180,12 @@ int HWCSession::GetActiveConfigIndex(int disp_id, uint32_t *config) {
     return -EINVAL;
   }
 
+  // Fast path: answer from the commit-time snapshot without touching the
+  // per-display lock, so polling clients cannot stall behind a commit.
+  if (ReadDisplayState(disp_idx, config, nullptr, nullptr)) {
+    return 0;
+  }
+
   SEQUENCE_WAIT_SCOPE_LOCK(locker_[disp_idx]);
 
   if (hwc_display_[disp_idx]) {
@@ -201,6 +207,7 @@ int HWCSession::SetActiveConfigIndex(int disp_id, uint32_t config) {
   if (hwc_display_[disp_idx]) {
     error = hwc_display_[disp_idx]->SetActiveDisplayConfig(config);
     if (!error) {
+      PublishDisplayState(disp_idx);
       callbacks_.Refresh(0);
     }
   }
@@ -329,6 +336,30 @@ int HWCSession::SetIdleTimeout(uint32_t value) {
   return -ENODEV;
 }
 
+int HWCSession::NotifyAppLaunch(int disp_id) {
+  int disp_idx = GetDisplayIndex(disp_id);
+  if (disp_idx == -1) {
+    DLOGE("Invalid display = %d", disp_id);
+    return -EINVAL;
+  }
+
+  {
+    SCOPE_LOCK(locker_[disp_idx]);
+    if (!hwc_display_[disp_idx]) {
+      return -ENODEV;
+    }
+
+    if (hwc_display_[disp_idx]->HandleAppLaunchHint() != kErrorNone) {
+      return -ENOTSUP;
+    }
+  }
+
+  // The display requested a warm-up frame; schedule it before the launch frame arrives.
+  callbacks_.Refresh(disp_idx);
+
+  return 0;
+}
+
 int HWCSession::SetCameraLaunchStatus(uint32_t on) {
   if (!core_intf_) {
     DLOGW("core_intf_ not initialized.");
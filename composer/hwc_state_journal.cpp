@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "hwc_debugger.h"
+#include "hwc_state_journal.h"
+
+#define __CLASS__ "HWCStateJournal"
+
+namespace sdm {
+
+static const char *kJournalPath = "/data/vendor/display/display_state_journal.bin";
+
+// The journal is only trusted within the boot it was written in; hash the
+// kernel boot id so a reboot (which resets all DRM state) discards it.
+static uint32_t GetBootHash() {
+  char boot_id[64] = {};
+  int fd = open("/proc/sys/kernel/random/boot_id", O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  ssize_t len = read(fd, boot_id, sizeof(boot_id) - 1);
+  close(fd);
+  if (len <= 0) {
+    return 0;
+  }
+
+  uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+  for (ssize_t i = 0; i < len; i++) {
+    hash ^= static_cast<uint8_t>(boot_id[i]);
+    hash *= 1099511628211ULL;
+  }
+  return static_cast<uint32_t>(hash ^ (hash >> 32));
+}
+
+int HWCStateJournal::Init() {
+  map_size_ = sizeof(Header) + (kNumSlots * sizeof(Slot));
+
+  int fd = open(kJournalPath, O_RDWR | O_CREAT, 0600);
+  if (fd < 0) {
+    DLOGW("Failed to open %s, errno %d", kJournalPath, errno);
+    return -errno;
+  }
+
+  struct stat st = {};
+  bool existing = (fstat(fd, &st) == 0) && (st.st_size == static_cast<off_t>(map_size_));
+  if (!existing && ftruncate(fd, map_size_) != 0) {
+    DLOGW("Failed to size %s, errno %d", kJournalPath, errno);
+    close(fd);
+    return -errno;
+  }
+
+  map_ = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);  // mapping keeps its own reference
+  if (map_ == MAP_FAILED) {
+    map_ = nullptr;
+    DLOGW("Failed to map %s, errno %d", kJournalPath, errno);
+    return -ENOMEM;
+  }
+
+  uint32_t boot_hash = GetBootHash();
+  Header *header = static_cast<Header *>(map_);
+  recovered_ = existing && (header->magic == kMagic) && (header->version == kVersion) &&
+               (header->num_slots == kNumSlots) && (header->boot_hash == boot_hash);
+  if (!recovered_) {
+    memset(map_, 0, map_size_);
+    Slot *slots = reinterpret_cast<Slot *>(header + 1);
+    for (uint32_t i = 0; i < kNumSlots; i++) {
+      slots[i].client_id = UINT32_MAX;
+    }
+    header->version = kVersion;
+    header->num_slots = kNumSlots;
+    header->boot_hash = boot_hash;
+    header->magic = kMagic;  // written last: a crash before this leaves it invalid
+  }
+
+  DLOGI("State journal mapped, recovery journal %s", recovered_ ? "found" : "not found");
+  return 0;
+}
+
+void HWCStateJournal::Deinit() {
+  if (map_) {
+    munmap(map_, map_size_);
+    map_ = nullptr;
+  }
+}
+
+HWCStateJournal::Slot *HWCStateJournal::FindSlot(uint32_t client_id, bool allocate) {
+  if (!map_) {
+    return nullptr;
+  }
+
+  Slot *slots = reinterpret_cast<Slot *>(static_cast<Header *>(map_) + 1);
+  Slot *free_slot = nullptr;
+  for (uint32_t i = 0; i < kNumSlots; i++) {
+    if (slots[i].client_id == client_id) {
+      return &slots[i];
+    }
+    if (!free_slot && slots[i].client_id == UINT32_MAX) {
+      free_slot = &slots[i];
+    }
+  }
+
+  if (allocate && free_slot) {
+    free_slot->client_id = client_id;
+    return free_slot;
+  }
+  return nullptr;
+}
+
+void HWCStateJournal::Record(uint32_t client_id, const DisplayState &state) {
+  Slot *slot = FindSlot(client_id, true /* allocate */);
+  if (!slot) {
+    return;
+  }
+
+  // Commit-path hot write: skip the seqlock churn when nothing changed.
+  if (memcmp(&slot->state, &state, sizeof(state)) == 0) {
+    return;
+  }
+
+  slot->seq.fetch_add(1, std::memory_order_release);  // odd: write in progress
+  slot->state = state;
+  slot->seq.fetch_add(1, std::memory_order_release);
+}
+
+bool HWCStateJournal::Lookup(uint32_t client_id, DisplayState *state) {
+  Slot *slot = FindSlot(client_id, false /* allocate */);
+  if (!slot) {
+    return false;
+  }
+
+  uint32_t seq = slot->seq.load(std::memory_order_acquire);
+  if (seq & 1) {
+    // Previous instance crashed mid-write; the slot contents are torn.
+    return false;
+  }
+  *state = slot->state;
+  return true;
+}
+
+}  // namespace sdm
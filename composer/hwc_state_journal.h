@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HWC_STATE_JOURNAL_H__
+#define __HWC_STATE_JOURNAL_H__
+
+#include <atomic>
+#include <cstdint>
+
+namespace sdm {
+
+/*
+ * Crash-recovery journal of last-known-good display state. A small file under
+ * /data/vendor/display is kept mapped for the lifetime of the composer and
+ * updated in place after each commit; the page cache preserves it across a
+ * composer crash, so the restarted service can replay power/config/color state
+ * immediately instead of waiting for the framework to re-derive it. A boot-id
+ * hash in the header invalidates journals from earlier boots, where the
+ * recorded state no longer matches the hardware.
+ *
+ * Slots are seqlocked: a torn write from a crash mid-Record() leaves an odd
+ * sequence count and the slot is ignored on recovery.
+ */
+class HWCStateJournal {
+ public:
+  struct DisplayState {
+    int32_t active_config = -1;
+    int32_t power_mode = -1;     // PowerMode enum value
+    int32_t color_mode = -1;     // ColorMode enum value
+    int32_t render_intent = -1;  // RenderIntent enum value
+  };
+
+  // Maps (creating if needed) the journal file. Returns 0 on success.
+  int Init();
+  void Deinit();
+  // True when a valid journal from this boot was found at Init(), i.e. the
+  // previous composer instance crashed rather than the device having rebooted.
+  bool IsRecovery() { return recovered_; }
+  void Record(uint32_t client_id, const DisplayState &state);
+  bool Lookup(uint32_t client_id, DisplayState *state);
+
+ private:
+  static const uint32_t kMagic = 0x314A5344;  // 'DSJ1'
+  static const uint32_t kVersion = 1;
+  static const uint32_t kNumSlots = 16;
+
+  struct Slot {
+    std::atomic<uint32_t> seq;
+    uint32_t client_id;  // UINT32_MAX = free
+    DisplayState state;
+  };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t boot_hash;
+  };
+
+  Slot *FindSlot(uint32_t client_id, bool allocate);
+
+  void *map_ = nullptr;
+  uint32_t map_size_ = 0;
+  bool recovered_ = false;
+};
+
+}  // namespace sdm
+
+#endif  // __HWC_STATE_JOURNAL_H__
@@ -85,6 +85,19 @@ void ToneMapSession::OnTask(const ToneMapTaskCode &task_code,
                                         grid_entries, grid_size, tone_map_config_.secure);
     } break;
 
+    case ToneMapTaskCode::kCodePrewarm: {
+      ToneMapGetInstanceContext *ctx = static_cast<ToneMapGetInstanceContext *>(task_context);
+      if (!gpu_tone_mapper_) {
+        break;
+      }
+      // Create the EGLImages for the session's buffer set on the GL thread before the first
+      // blit needs them, so buffer rotation does not pay the import cost inline.
+      gpu_tone_mapper_->prewarm(reinterpret_cast<const void *>(ctx->layer->input_buffer.buffer_id));
+      for (uint8_t i = 0; i < kNumIntermediateBuffers; i++) {
+        gpu_tone_mapper_->prewarm(buffer_info_[i].private_data);
+      }
+    } break;
+
     case ToneMapTaskCode::kCodeBlit: {
       ToneMapBlitContext *ctx = static_cast<ToneMapBlitContext *>(task_context);
       uint8_t buffer_index = current_buffer_index_;
@@ -172,6 +185,7 @@ bool ToneMapSession::IsSameToneMapConfig(Layer *layer, PrimariesTransfer blend_c
 int HWCToneMapper::HandleToneMap(LayerStack *layer_stack) {
   uint32_t gpu_count = 0;
   DisplayError error = kErrorNone;
+  pending_tasks_.clear();
 
   for (uint32_t i = 0; i < layer_stack->layers.size(); i++) {
     uint32_t session_index = 0;
@@ -195,6 +209,7 @@ int HWCToneMapper::HandleToneMap(LayerStack *layer_stack) {
               fb_tone_map_session->UpdateBuffer(nullptr /* acquire_fence */, &layer->input_buffer);
               fb_tone_map_session->layer_index_ = INT(i);
               fb_tone_map_session->acquired_ = true;
+              WaitForToneMapTasks(layer_stack);
               return 0;
             }
           }
@@ -207,37 +222,54 @@ int HWCToneMapper::HandleToneMap(LayerStack *layer_stack) {
       }
 
       if (error != kErrorNone) {
+        // Join any blits already in flight before tearing the sessions down.
+        WaitForToneMapTasks(layer_stack);
         Terminate();
         return -1;
       }
 
       ToneMapSession *session = tone_map_sessions_.at(session_index);
-      ToneMap(layer, session);
+      ToneMapAsync(layer, session);
       DLOGI_IF(kTagClient, "Layer %d associated with session index %d", i, session_index);
       session->layer_index_ = INT(i);
+      pending_tasks_.push_back(session);
     }
   }
 
+  WaitForToneMapTasks(layer_stack);
+
   return 0;
 }
 
-void HWCToneMapper::ToneMap(Layer *layer, ToneMapSession *session) {
-  ToneMapBlitContext ctx = {};
-  ctx.layer = layer;
+void HWCToneMapper::ToneMapAsync(Layer *layer, ToneMapSession *session) {
+  session->blit_ctx_ = {};
+  session->blit_ctx_.layer = layer;
 
   uint8_t buffer_index = session->current_buffer_index_;
 
   // use and close the layer->input_buffer acquire fence fd.
   // remove create when rf made it as a shared_ptr
-  ctx.merged =
+  session->blit_ctx_.merged =
       Fence::Merge(session->release_fence_[buffer_index], layer->input_buffer.acquire_fence);
 
-  DTRACE_BEGIN("GPU_TM_BLIT");
-  session->tone_map_task_.PerformTask(ToneMapTaskCode::kCodeBlit, &ctx);
+  // Enqueue the blit on the session's GL worker and continue; the output fence is collected
+  // in WaitForToneMapTasks() before commit consumes the buffers.
+  DTRACE_BEGIN("GPU_TM_BLIT_KICK");
+  session->tone_map_task_.BeginTask(ToneMapTaskCode::kCodeBlit, &session->blit_ctx_);
   DTRACE_END();
+}
+
+void HWCToneMapper::WaitForToneMapTasks(LayerStack *layer_stack) {
+  for (ToneMapSession *session : pending_tasks_) {
+    DTRACE_BEGIN("GPU_TM_BLIT_WAIT");
+    session->tone_map_task_.WaitForTask();
+    DTRACE_END();
 
-  DumpToneMapOutput(session, ctx.fence);
-  session->UpdateBuffer(ctx.fence, &layer->input_buffer);
+    DumpToneMapOutput(session, session->blit_ctx_.fence);
+    Layer *layer = layer_stack->layers.at(UINT32(session->layer_index_));
+    session->UpdateBuffer(session->blit_ctx_.fence, &layer->input_buffer);
+  }
+  pending_tasks_.clear();
 }
 
 void HWCToneMapper::PostCommit(LayerStack *layer_stack) {
@@ -251,6 +283,11 @@ void HWCToneMapper::PostCommit(LayerStack *layer_stack) {
       LayerBuffer &layer_buffer = layer->input_buffer;
       session->SetReleaseFence(layer_buffer.release_fence);
       session->acquired_ = false;
+      session->idle_frames_ = 0;
+      it++;
+    } else if (++session->idle_frames_ < kMaxSessionIdleFrames) {
+      // Keep the session warm so a matching layer can reacquire it without re-creating the
+      // GPU tonemapper instance and intermediate buffers.
       it++;
     } else {
       DLOGI_IF(kTagClient, "Tone map session %d closed.", session_index);
@@ -371,6 +408,11 @@ DisplayError HWCToneMapper::AcquireToneMapSession(Layer *layer, uint32_t *sessio
     return error;
   }
 
+  // Import the session's buffer set into the EGLImage cache before the first blit needs it.
+  ToneMapGetInstanceContext prewarm_ctx;
+  prewarm_ctx.layer = layer;
+  session->tone_map_task_.PerformTask(ToneMapTaskCode::kCodePrewarm, &prewarm_ctx);
+
   session->acquired_ = true;
   tone_map_sessions_.push_back(session);
   *session_index = UINT32(tone_map_sessions_.size() - 1);
@@ -53,6 +53,7 @@ namespace sdm {
 
 enum class ToneMapTaskCode : int32_t {
   kCodeGetInstance,
+  kCodePrewarm,
   kCodeBlit,
   kCodeDestroy,
 };
@@ -100,6 +101,8 @@ class ToneMapSession : public SyncTask<ToneMapTaskCode>::TaskHandler {
   shared_ptr<Fence> release_fence_[kNumIntermediateBuffers] = {nullptr, nullptr};
   bool acquired_ = false;
   int layer_index_ = -1;
+  ToneMapBlitContext blit_ctx_ = {};  // Context of the in-flight async blit, if any
+  uint32_t idle_frames_ = 0;          // Consecutive frames this session went unacquired
 };
 
 class HWCToneMapper {
@@ -114,11 +117,17 @@ class HWCToneMapper {
   void Terminate();
 
  private:
-  void ToneMap(Layer *layer, ToneMapSession *session);
+  void ToneMapAsync(Layer *layer, ToneMapSession *session);
+  void WaitForToneMapTasks(LayerStack *layer_stack);
   DisplayError AcquireToneMapSession(Layer *layer, uint32_t *sess_idx, PrimariesTransfer blend_cs);
   void DumpToneMapOutput(ToneMapSession *session, shared_ptr<sdm::Fence> acquire_fence);
 
+  // Unacquired sessions are kept warm for this many frames before teardown, so the GPU
+  // tonemapper instance and intermediate buffers survive transient composition drops.
+  static const uint32_t kMaxSessionIdleFrames = 8;
+
   std::vector<ToneMapSession *> tone_map_sessions_;
+  std::vector<ToneMapSession *> pending_tasks_;  // Sessions with a blit in flight this frame
   HWCBufferAllocator *buffer_allocator_ = nullptr;
   uint32_t dump_frame_count_ = 0;
   uint32_t dump_frame_index_ = 0;
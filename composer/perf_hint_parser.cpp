@@ -5,6 +5,13 @@
 
 #include <tinyxml2.h>
 #include <cutils/properties.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
 #include "perf_hint_parser.h"
 #include "hwc_debugger.h"
 
@@ -18,19 +25,106 @@ using tinyxml2::XMLElement;
 namespace sdm {
 
 HWC3::Error PerfHintParser::Init() {
+  // The compiled cache is authoritative as long as the source XML has not changed underneath
+  // it; a hit skips tinyxml2 entirely on composer restart.
+  if (LoadPerfHintThresholdFromCache()) {
+    return HWC3::Error::None;
+  }
+
   if (!LoadPerfHintThresholdFromFile(kPerfThresholdXmlPath)) {
     DLOGW("Could not load Perf hint threshold XML.");
     return HWC3::Error::BadParameter;
   }
+
+  SavePerfHintThresholdToCache();
   return HWC3::Error::None;
 }
 
+int32_t PerfHintParser::GetPerfVersion() {
+  char value[PROPERTY_VALUE_MAX];
+  property_get("vendor.display.perf.version", value, "0");
+  return atoi(value);
+}
+
+int64_t PerfHintParser::GetFileMtime(const char *file_name) {
+  struct stat stat_buf;
+  if (stat(file_name, &stat_buf) != 0) {
+    return 0;
+  }
+  return stat_buf.st_mtime;
+}
+
+bool PerfHintParser::LoadPerfHintThresholdFromCache() {
+  int fd = open(kPerfThresholdCachePath, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  CacheHeader header;
+  bool valid = (read(fd, &header, sizeof(header)) == sizeof(header)) &&
+               (header.magic == kCacheMagic) &&
+               (header.format_version == kCacheFormatVersion) &&
+               (header.source_mtime == GetFileMtime(kPerfThresholdXmlPath)) &&
+               (header.perf_version == GetPerfVersion()) && header.count && (header.count <= 256);
+  if (!valid) {
+    close(fd);
+    return false;
+  }
+
+  std::vector<int32_t> entries(header.count * 2);
+  ssize_t size = static_cast<ssize_t>(entries.size() * sizeof(int32_t));
+  if (read(fd, entries.data(), size) != size) {
+    close(fd);
+    return false;
+  }
+  close(fd);
+
+  for (uint32_t i = 0; i < header.count; i++) {
+    fps_to_threshold_map_.insert(make_pair(entries[i * 2], entries[i * 2 + 1]));
+  }
+
+  DLOGI("Loaded %u perf hint thresholds from compiled cache", header.count);
+  return true;
+}
+
+void PerfHintParser::SavePerfHintThresholdToCache() {
+  // Write-then-rename so a crash mid-write leaves either the old cache or none at all.
+  std::string tmp_path = std::string(kPerfThresholdCachePath) + ".tmp";
+  int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    DLOGW("Failed to create perf hint cache %s: %s", tmp_path.c_str(), strerror(errno));
+    return;
+  }
+
+  CacheHeader header;
+  header.magic = kCacheMagic;
+  header.format_version = kCacheFormatVersion;
+  header.source_mtime = GetFileMtime(kPerfThresholdXmlPath);
+  header.perf_version = GetPerfVersion();
+  header.count = UINT32(fps_to_threshold_map_.size());
+
+  std::vector<int32_t> entries;
+  entries.reserve(header.count * 2);
+  for (auto &item : fps_to_threshold_map_) {
+    entries.push_back(item.first);
+    entries.push_back(item.second);
+  }
+
+  ssize_t size = static_cast<ssize_t>(entries.size() * sizeof(int32_t));
+  bool written = (write(fd, &header, sizeof(header)) == sizeof(header)) &&
+                 (write(fd, entries.data(), size) == size);
+  close(fd);
+
+  if (!written || rename(tmp_path.c_str(), kPerfThresholdCachePath) != 0) {
+    DLOGW("Failed to persist perf hint cache: %s", strerror(errno));
+    unlink(tmp_path.c_str());
+  }
+}
+
 bool PerfHintParser::LoadPerfHintThresholdFromFile(const char *file_name) {
   XMLDocument doc;
   const char *retStr = NULL;
-  char value[PROPERTY_VALUE_MAX];
-  property_get("vendor.display.perf.version", value, "0");
-  int perf_version = atoi(value);
+  int perf_version = GetPerfVersion();
 
   if (doc.LoadFile(file_name) != XML_SUCCESS) {
     DLOGW("Failed to load perf hint threshold xml file!");
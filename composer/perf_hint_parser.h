@@ -20,12 +20,29 @@ class PerfHintParser {
   HWC3::Error Init();
 
  private:
+  // Compiled form of the parsed XML, cached on disk so a composer restart skips XML parsing.
+  // Invalidated when the source file mtime or the perf version property changes.
+  struct CacheHeader {
+    uint32_t magic = 0;
+    uint32_t format_version = 0;
+    int64_t source_mtime = 0;
+    int32_t perf_version = 0;
+    uint32_t count = 0;
+  };
+  static const uint32_t kCacheMagic = 0x54485250;  // "PRHT"
+  static const uint32_t kCacheFormatVersion = 1;
+
   const char *kPerfThresholdXmlPath = "/vendor/etc/display/perf_hint_threshold.xml";
+  const char *kPerfThresholdCachePath = "/data/vendor/display/perf_hint_threshold.bin";
   unordered_map<int32_t, int32_t> fps_to_threshold_map_;
 
   bool LoadPerfHintThresholdFromFile(const char *file_name);
+  bool LoadPerfHintThresholdFromCache();
+  void SavePerfHintThresholdToCache();
+  static int32_t GetPerfVersion();
+  static int64_t GetFileMtime(const char *file_name);
 };
 
 }  // namespace sdm
 
-#endif  // __PERF_HINT_PARSER_H__
\ No newline at end of file
+#endif  // __PERF_HINT_PARSER_H__
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <utils/Log.h>
+#include <cutils/native_handle.h>
+#include <QtiGralloc.h>
+#include <QtiGrallocPriv.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "CpuTonemapEngine.h"
+#include "Tonemapper.h"
+
+using private_handle_t = qtigralloc::private_handle_t;
+
+// Fixed EGL cost of a GL blit (make-current + draw + out-fence) on a tiny
+// surface; pixel count where the measured CPU cost crosses this is the cutoff.
+static const int64_t kGpuBlitOverheadNs = 1500000;
+static const int kMaxCpuPixels = 512 * 512;
+static const int kMinCpuPixels = 64 * 64;
+
+//-----------------------------------------------------------------------------
+static inline uint32_t unpack10(uint32_t packed, int shift)
+//-----------------------------------------------------------------------------
+{
+  return (packed >> shift) & 0x3FF;
+}
+
+//-----------------------------------------------------------------------------
+static int64_t getMonotonicNs()
+//-----------------------------------------------------------------------------
+{
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((int64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+}
+
+//-----------------------------------------------------------------------------
+static void waitAndCloseFence(int fenceFd)
+//-----------------------------------------------------------------------------
+{
+  if (fenceFd < 0) {
+    return;
+  }
+
+  // Sync file fds poll readable once signaled; same wait the GL path gets from
+  // its EGL native fence, minus the EGL object.
+  struct pollfd pfd = {};
+  pfd.fd = fenceFd;
+  pfd.events = POLLIN;
+  int ret;
+  do {
+    ret = poll(&pfd, 1, 1000 /* ms */);
+  } while (ret == -1 && (errno == EINTR || errno == EAGAIN));
+  if (ret <= 0) {
+    ALOGE("timed out waiting for source fence fd = %d", fenceFd);
+  }
+  close(fenceFd);
+}
+
+//-----------------------------------------------------------------------------
+CpuTonemapEngine::CpuTonemapEngine()
+//-----------------------------------------------------------------------------
+{
+  lutDim_ = 0;
+  xformSize_ = 0;
+  cpuNsPerKilopixel_ = 0;
+  maxPixels_ = kMaxCpuPixels;
+}
+
+//-----------------------------------------------------------------------------
+CpuTonemapEngine *CpuTonemapEngine::build(int type, void *colorMap, int colorMapSize,
+                                          void *lutXform, int lutXformSize, bool isSecure)
+//-----------------------------------------------------------------------------
+{
+  // Secure buffers cannot be mapped here, and the inverse path folds the
+  // premultiplied alpha divide into the shader; both stay on the GL engine.
+  if (isSecure || (type != TONEMAP_FORWARD)) {
+    return 0;
+  }
+  if ((colorMap == 0) || (colorMapSize <= 1)) {
+    return 0;
+  }
+
+  CpuTonemapEngine *engine = new CpuTonemapEngine();
+
+  engine->lutDim_ = colorMapSize;
+  engine->lut_.resize((size_t)colorMapSize * colorMapSize * colorMapSize * 3);
+  const uint32_t *packed = static_cast<const uint32_t *>(colorMap);
+  for (size_t i = 0; i < engine->lut_.size() / 3; i++) {
+    engine->lut_[i * 3 + 0] = unpack10(packed[i], 0);
+    engine->lut_[i * 3 + 1] = unpack10(packed[i], 10);
+    engine->lut_[i * 3 + 2] = unpack10(packed[i], 20);
+  }
+
+  if ((lutXform != 0) && (lutXformSize > 1)) {
+    engine->xformSize_ = lutXformSize;
+    engine->xform_.resize((size_t)lutXformSize * 3);
+    packed = static_cast<const uint32_t *>(lutXform);
+    for (int i = 0; i < lutXformSize; i++) {
+      engine->xform_[i * 3 + 0] = unpack10(packed[i], 0);
+      engine->xform_[i * 3 + 1] = unpack10(packed[i], 10);
+      engine->xform_[i * 3 + 2] = unpack10(packed[i], 20);
+    }
+  }
+
+  return engine;
+}
+
+//-----------------------------------------------------------------------------
+bool CpuTonemapEngine::canBlit(const void *dst, const void *src)
+//-----------------------------------------------------------------------------
+{
+  const private_handle_t *s = static_cast<const private_handle_t *>(src);
+  const private_handle_t *d = static_cast<const private_handle_t *>(dst);
+  if ((s == 0) || (d == 0)) {
+    return false;
+  }
+
+  int unmappable = qtigralloc::PRIV_FLAGS_SECURE_BUFFER | qtigralloc::PRIV_FLAGS_UBWC_ALIGNED;
+  if ((s->flags & unmappable) || (d->flags & unmappable)) {
+    return false;
+  }
+
+  // Plain 8-bit RGBA only, and no scaling: the GL path stretches src onto dst,
+  // the CPU path walks matching rows.
+  bool formats_ok = ((s->format == HAL_PIXEL_FORMAT_RGBA_8888) ||
+                     (s->format == HAL_PIXEL_FORMAT_RGBX_8888)) &&
+                    ((d->format == HAL_PIXEL_FORMAT_RGBA_8888) ||
+                     (d->format == HAL_PIXEL_FORMAT_RGBX_8888));
+  if (!formats_ok) {
+    return false;
+  }
+  if ((s->unaligned_width != d->unaligned_width) ||
+      (s->unaligned_height != d->unaligned_height)) {
+    return false;
+  }
+
+  int pixels = s->unaligned_width * s->unaligned_height;
+  return (pixels > 0) && (pixels <= maxPixels_);
+}
+
+//-----------------------------------------------------------------------------
+void CpuTonemapEngine::tonemapPixel(uint32_t r8, uint32_t g8, uint32_t b8,
+                                    uint8_t *outR, uint8_t *outG, uint8_t *outB)
+//-----------------------------------------------------------------------------
+{
+  // Channels as Q10, 1023 == 1.0 (matches the lattice entries).
+  uint32_t c[3];
+  c[0] = (r8 << 2) | (r8 >> 6);
+  c[1] = (g8 << 2) | (g8 >> 6);
+  c[2] = (b8 << 2) | (b8 >> 6);
+
+  // Non-uniform xform. The shader's scale/offset places samples so that
+  // texture(xform, v) reduces to a lerp across the table at v * (size - 1).
+  if (xformSize_ != 0) {
+    for (int ch = 0; ch < 3; ch++) {
+      uint32_t pos = c[ch] * (uint32_t)(xformSize_ - 1);  // Q10 table index
+      uint32_t idx = pos >> 10;
+      uint32_t frac = pos & 0x3FF;
+      int32_t lo = xform_[idx * 3 + ch];
+      int32_t hi = xform_[(idx + 1) * 3 + ch];
+      c[ch] = (uint32_t)(lo + (((hi - lo) * (int32_t)frac) >> 10));
+    }
+  }
+
+  // Trilinear sample of the 3D lattice; r is the fastest-varying axis, same
+  // layout glTexImage3D was given. NEON has no gather, so the eight corner
+  // fetches stay scalar.
+  uint32_t n = (uint32_t)lutDim_;
+  uint32_t pos[3], idx[3];
+  int32_t frac[3];
+  for (int ch = 0; ch < 3; ch++) {
+    pos[ch] = c[ch] * (n - 1);
+    idx[ch] = pos[ch] >> 10;
+    frac[ch] = (int32_t)(pos[ch] & 0x3FF);
+    if (idx[ch] >= n - 1) {  // defensive clamp, c[ch] <= 1023 keeps idx <= n - 2
+      idx[ch] = n - 2;
+      frac[ch] = 1024;
+    }
+  }
+
+  const uint16_t *base = &lut_[((idx[2] * n + idx[1]) * n + idx[0]) * 3];
+  size_t dy = n * 3;       // +1 in g
+  size_t dz = n * n * 3;   // +1 in b
+  uint8_t out[3];
+  for (int ch = 0; ch < 3; ch++) {
+    const uint16_t *p = base + ch;
+    int32_t c000 = p[0],      c100 = p[3];
+    int32_t c010 = p[dy],     c110 = p[dy + 3];
+    int32_t c001 = p[dz],     c101 = p[dz + 3];
+    int32_t c011 = p[dz + dy], c111 = p[dz + dy + 3];
+
+    int32_t c00 = c000 + (((c100 - c000) * frac[0]) >> 10);
+    int32_t c10 = c010 + (((c110 - c010) * frac[0]) >> 10);
+    int32_t c01 = c001 + (((c101 - c001) * frac[0]) >> 10);
+    int32_t c11 = c011 + (((c111 - c011) * frac[0]) >> 10);
+    int32_t c0 = c00 + (((c10 - c00) * frac[1]) >> 10);
+    int32_t c1 = c01 + (((c11 - c01) * frac[1]) >> 10);
+    int32_t q10 = c0 + (((c1 - c0) * frac[2]) >> 10);
+
+    out[ch] = (uint8_t)(((uint32_t)q10 * 255 + 511) / 1023);
+  }
+  *outR = out[0];
+  *outG = out[1];
+  *outB = out[2];
+}
+
+//-----------------------------------------------------------------------------
+void CpuTonemapEngine::tonemapRow(const uint32_t *src, uint32_t *dst, int width)
+//-----------------------------------------------------------------------------
+{
+  int x = 0;
+
+#if defined(__ARM_NEON)
+  // Deinterleave/reinterleave eight pixels at a time; the per-pixel core in
+  // between is table lookups, which stay scalar (see tonemapPixel).
+  for (; x + 8 <= width; x += 8) {
+    uint8x8x4_t px = vld4_u8(reinterpret_cast<const uint8_t *>(src + x));
+    uint8_t r[8], g[8], b[8];
+    vst1_u8(r, px.val[0]);
+    vst1_u8(g, px.val[1]);
+    vst1_u8(b, px.val[2]);
+    for (int i = 0; i < 8; i++) {
+      tonemapPixel(r[i], g[i], b[i], &r[i], &g[i], &b[i]);
+    }
+    px.val[0] = vld1_u8(r);
+    px.val[1] = vld1_u8(g);
+    px.val[2] = vld1_u8(b);
+    vst4_u8(reinterpret_cast<uint8_t *>(dst + x), px);  // alpha passes through
+  }
+#endif
+
+  for (; x < width; x++) {
+    uint32_t p = src[x];
+    uint8_t r, g, b;
+    tonemapPixel(p & 0xFF, (p >> 8) & 0xFF, (p >> 16) & 0xFF, &r, &g, &b);
+    dst[x] = (p & 0xFF000000) | ((uint32_t)b << 16) | ((uint32_t)g << 8) | r;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void CpuTonemapEngine::updateCrossover(int pixels, int64_t elapsedNs)
+//-----------------------------------------------------------------------------
+{
+  int64_t measured = (elapsedNs * 1024) / pixels;
+  if (cpuNsPerKilopixel_ == 0) {
+    cpuNsPerKilopixel_ = measured;
+  } else {
+    cpuNsPerKilopixel_ = ((cpuNsPerKilopixel_ * 7) + measured) / 8;
+  }
+
+  // Take blits only while the projected CPU time stays under the fixed GL
+  // round-trip cost; everything larger goes back to the GPU.
+  int64_t crossover = (kGpuBlitOverheadNs * 1024) / std::max(cpuNsPerKilopixel_, (int64_t)1);
+  maxPixels_ = (int)std::min((int64_t)kMaxCpuPixels, std::max((int64_t)kMinCpuPixels, crossover));
+}
+
+//-----------------------------------------------------------------------------
+int CpuTonemapEngine::blit(const void *dst, const void *src, int srcFenceFd)
+//-----------------------------------------------------------------------------
+{
+  const private_handle_t *s = static_cast<const private_handle_t *>(src);
+  const private_handle_t *d = static_cast<const private_handle_t *>(dst);
+
+  void *src_base = mmap(0, s->size, PROT_READ, MAP_SHARED, s->fd, 0);
+  if (src_base == MAP_FAILED) {
+    ALOGE("src mmap failed for fd = %d, err %d", s->fd, errno);
+    return -EINVAL;
+  }
+  void *dst_base = mmap(0, d->size, PROT_READ | PROT_WRITE, MAP_SHARED, d->fd, 0);
+  if (dst_base == MAP_FAILED) {
+    ALOGE("dst mmap failed for fd = %d, err %d", d->fd, errno);
+    munmap(src_base, s->size);
+    return -EINVAL;
+  }
+
+  waitAndCloseFence(srcFenceFd);
+
+  int64_t start = getMonotonicNs();
+  int width = s->unaligned_width;
+  int height = s->unaligned_height;
+  const uint32_t *src_px = static_cast<const uint32_t *>(src_base);
+  uint32_t *dst_px = static_cast<uint32_t *>(dst_base);
+  for (int y = 0; y < height; y++) {
+    // handle->width is the aligned width, i.e. the row stride in pixels
+    tonemapRow(src_px + ((size_t)y * s->width), dst_px + ((size_t)y * d->width), width);
+  }
+  updateCrossover(width * height, getMonotonicNs() - start);
+
+  munmap(src_base, s->size);
+  munmap(dst_base, d->size);
+
+  // Work is done on return; a null fence is already signaled.
+  return -1;
+}
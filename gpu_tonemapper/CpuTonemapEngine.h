@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __TONEMAPPER_CPU_TONEMAP_ENGINE_H__
+#define __TONEMAPPER_CPU_TONEMAP_ENGINE_H__
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * CPU fallback for the GL tonemap blit. For small linear RGBA buffers (CWB
+ * verification blocks, thumbnails) the EGL make-current/draw/fence round trip
+ * dominates the actual math, so the lookups are evaluated directly over the
+ * mapped buffers in fixed point instead. The engine measures its own per-pixel
+ * cost and only volunteers for blits it can finish below the GPU overhead floor.
+ */
+class CpuTonemapEngine {
+ private:
+  CpuTonemapEngine();
+
+  // 3D lattice unpacked from the 10-10-10-2 colorMap, interleaved RGB, Q10 per
+  // channel (1023 == 1.0), lutDim_^3 lattice points.
+  std::vector<uint16_t> lut_;
+  int lutDim_;
+
+  // Optional non-uniform 1D xform, interleaved RGB Q10, xformSize_ entries.
+  std::vector<uint16_t> xform_;
+  int xformSize_;
+
+  // Measured cost EWMA and the resulting crossover, see updateCrossover().
+  int64_t cpuNsPerKilopixel_;
+  int maxPixels_;
+
+  void tonemapPixel(uint32_t r8, uint32_t g8, uint32_t b8,
+                    uint8_t *outR, uint8_t *outG, uint8_t *outB);
+  void tonemapRow(const uint32_t *src, uint32_t *dst, int width);
+  void updateCrossover(int pixels, int64_t elapsedNs);
+
+ public:
+  // Returns 0 when the combination cannot be handled on the CPU (secure
+  // session, inverse/premultiplied path, bad LUT).
+  static CpuTonemapEngine *build(int type, void *colorMap, int colorMapSize, void *lutXform,
+                                 int lutXformSize, bool isSecure);
+  bool canBlit(const void *dst, const void *src);
+  // Waits on srcFenceFd (and closes it), blits synchronously, returns -1 as
+  // the "already signaled" release fence. Returns < -1 on mapping failure so
+  // the caller can fall back to the GL path.
+  int blit(const void *dst, const void *src, int srcFenceFd);
+};
+
+#endif  // __TONEMAPPER_CPU_TONEMAP_ENGINE_H__
@@ -64,6 +64,7 @@ void EGLImageWrapper::DeleteEGLImageCallback::operator()(int& buffInt, EGLImageB
   if (eglImage != 0) {
     delete eglImage;
   }
+  evictionCount++;
 
   if (!mapClearPending) {
     for (auto it = buffStrbuffIntMapPtr->begin(); it != buffStrbuffIntMapPtr->end(); it++) {
@@ -102,6 +103,14 @@ void EGLImageWrapper::Init()
 void EGLImageWrapper::Deinit()
 //-----------------------------------------------------------------------------
 {
+  if (cacheHits || cacheMisses || cachePrewarms) {
+    ALOGI("EGLImage cache: %u hits, %u misses, %u prewarms, %u evictions", cacheHits, cacheMisses,
+          cachePrewarms, (callback != 0) ? callback->evictionCount : 0);
+  }
+  cacheHits = 0;
+  cacheMisses = 0;
+  cachePrewarms = 0;
+
   if (eglImageBufferCache != 0) {
     if (callback != 0) {
       callback->mapClearPending = true;
@@ -161,7 +170,7 @@ static EGLImageBuffer *L_wrap(const private_handle_t *src)
 }
 
 //-----------------------------------------------------------------------------
-EGLImageBuffer *EGLImageWrapper::wrap(const void *pvt_handle)
+EGLImageBuffer *EGLImageWrapper::fetch(const void *pvt_handle, bool prewarmHint)
 //-----------------------------------------------------------------------------
 {
   const private_handle_t *src = static_cast<const private_handle_t *>(pvt_handle);
@@ -172,11 +181,19 @@ EGLImageBuffer *EGLImageWrapper::wrap(const void *pvt_handle)
     auto it = buffStrbuffIntMap.find(buffStr);
     if (it != buffStrbuffIntMap.end()) {
       eglImage = eglImageBufferCache->get(it->second);
+      if (!prewarmHint) {
+        cacheHits++;
+      }
     } else {
         eglImage = L_wrap(src);
         buffStrbuffIntMap.insert(pair<string, int>(buffStr, buffInt));
         eglImageBufferCache->put(buffInt, eglImage);
         buffInt++;
+        if (prewarmHint) {
+          cachePrewarms++;
+        } else {
+          cacheMisses++;
+        }
     }
   } else {
     ALOGE("Could not provide an eglImage for fd = %d, EGLImageWrapper = %p", src->fd, this);
@@ -184,3 +201,30 @@ EGLImageBuffer *EGLImageWrapper::wrap(const void *pvt_handle)
 
   return eglImage;
 }
+
+//-----------------------------------------------------------------------------
+EGLImageBuffer *EGLImageWrapper::wrap(const void *pvt_handle)
+//-----------------------------------------------------------------------------
+{
+  return fetch(pvt_handle, false /* prewarmHint */);
+}
+
+//-----------------------------------------------------------------------------
+void EGLImageWrapper::prewarm(const void *pvt_handle)
+//-----------------------------------------------------------------------------
+{
+  if (pvt_handle != 0) {
+    fetch(pvt_handle, true /* prewarmHint */);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void EGLImageWrapper::getCacheStats(unsigned int* hits, unsigned int* misses,
+                                    unsigned int* prewarms, unsigned int* evictions)
+//-----------------------------------------------------------------------------
+{
+  *hits = cacheHits;
+  *misses = cacheMisses;
+  *prewarms = cachePrewarms;
+  *evictions = (callback != 0) ? callback->evictionCount : 0;
+}
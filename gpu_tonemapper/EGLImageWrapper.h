@@ -37,17 +37,29 @@ class EGLImageWrapper {
      void operator()(int& buffInt, EGLImageBuffer*& eglImage);
      map<string, int>* buffStrbuffIntMapPtr = nullptr;
      bool mapClearPending = false;
+     unsigned int evictionCount = 0;
   };
 
   android::LruCache<int, EGLImageBuffer *>* eglImageBufferCache;
   map<string, int> buffStrbuffIntMap = {};
   DeleteEGLImageCallback* callback = 0;
   uint64_t buffInt = 0;
+  // LRU accounting, logged at Deinit() so the cache size can be tuned against real sessions.
+  unsigned int cacheHits = 0;
+  unsigned int cacheMisses = 0;
+  unsigned int cachePrewarms = 0;
+
+  EGLImageBuffer* fetch(const void *pvt_handle, bool prewarmHint);
 
  public:
   EGLImageWrapper();
   ~EGLImageWrapper();
   EGLImageBuffer* wrap(const void *pvt_handle);
+  // Create and cache the EGLImage for a buffer ahead of its first blit, so the first
+  // tonemap of the buffer does not pay the import cost inline.
+  void prewarm(const void *pvt_handle);
+  void getCacheStats(unsigned int* hits, unsigned int* misses, unsigned int* prewarms,
+                     unsigned int* evictions);
   void Init();
   void Deinit();
 };
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "TonemapChainShader.h"
+#include "Tonemapper.h"
+
+//-----------------------------------------------------------------------------
+static std::string generateChainShader(const TonemapChainDesc &desc)
+//-----------------------------------------------------------------------------
+{
+  std::string src;
+
+  src += "#version 300 es\n"
+         "#extension GL_OES_EGL_image_external_essl3 : require\n"
+         "precision highp float;\n"
+         "precision highp sampler2D;\n"
+         "layout(binding = 0) uniform samplerExternalOES externalTexture;\n"
+         "layout(binding = 1) uniform sampler3D tonemapper;\n"
+         "layout(binding = 2) uniform sampler2D xform;\n"
+         "layout(location = 3) uniform vec2 tSO;\n";
+  if (desc.useXform) {
+    src += "layout(location = 4) uniform vec2 xSO;\n";
+  }
+  if (desc.useCsc) {
+    src += "layout(location = 5) uniform mat3 csc;\n";
+  }
+  src += "in vec2 uv;\n"
+         "out vec4 fs_color;\n"
+         "\n"
+         "vec3 ScaleOffset(in vec3 samplePt, in vec2 so)\n"
+         "{\n"
+         "   vec3 adjPt = so.x * samplePt + so.y;\n"
+         "   return adjPt;\n"
+         "}\n"
+         "\n"
+         "vec3 Chain(in vec3 rgb)\n"
+         "{\n";
+  if (desc.useXform) {
+    src += "   vec3 adj = ScaleOffset(rgb, xSO);\n"
+           "   rgb.r = texture(xform, vec2(adj.r, 0.5f)).r;\n"
+           "   rgb.g = texture(xform, vec2(adj.g, 0.5f)).g;\n"
+           "   rgb.b = texture(xform, vec2(adj.b, 0.5f)).b;\n";
+  }
+  src += "   rgb = texture(tonemapper, ScaleOffset(rgb, tSO)).rgb;\n";
+  if (desc.useCsc) {
+    src += "   rgb = clamp(csc * rgb, 0.0f, 1.0f);\n";
+  }
+  src += "   return rgb;\n"
+         "}\n"
+         "\n"
+         "void main()\n"
+         "{\n"
+         "vec2 flipped = vec2(uv.x, 1.0f - uv.y);\n";
+  if (desc.type == TONEMAP_INVERSE) {
+    // inverse content arrives premultiplied; unmultiply around the chain
+    src += "vec4 rgb_premulalpha = texture(externalTexture, flipped);\n"
+           "fs_color = rgb_premulalpha;\n"
+           "if( rgb_premulalpha.a > 0.0 ) {\n"
+           "fs_color.rgb = Chain(rgb_premulalpha.rgb/rgb_premulalpha.a) * rgb_premulalpha.a;\n"
+           "fs_color.a = rgb_premulalpha.a;\n"
+           "}\n";
+  } else {
+    src += "vec4 rgb = texture(externalTexture, flipped);\n"
+           "fs_color.rgb = Chain(rgb.rgb);\n";
+  }
+  src += "}\n";
+
+  return src;
+}
+
+//-----------------------------------------------------------------------------
+const char *TonemapChainShader_Get(const TonemapChainDesc &desc)
+//-----------------------------------------------------------------------------
+{
+  static std::mutex cacheLock;
+  static std::map<unsigned int, std::string> cache;
+
+  unsigned int signature = ((desc.type == TONEMAP_INVERSE) ? 1u : 0u) |
+                           (desc.useXform ? 2u : 0u) |
+                           (desc.useCsc ? 4u : 0u);
+
+  std::lock_guard<std::mutex> lock(cacheLock);
+  auto it = cache.find(signature);
+  if (it == cache.end()) {
+    it = cache.emplace(signature, generateChainShader(desc)).first;
+  }
+  return it->second.c_str();
+}
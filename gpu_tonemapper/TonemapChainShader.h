@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __TONEMAPPER_TONEMAP_CHAIN_SHADER_H__
+#define __TONEMAPPER_TONEMAP_CHAIN_SHADER_H__
+
+/*
+ * Fused tonemap chain shader generator. The forward and inverse tonemap
+ * programs used to live in separate static sources, and a chain that also
+ * needed a color space conversion would have paid a second render pass
+ * through an intermediate target. The generator instead composes the
+ * requested stages — optional non-uniform 1D transfer sampling, the 3D
+ * tonemap LUT and an optional 3x3 color space conversion — into one fragment
+ * shader, so every chain runs as a single pass over the source. Generated
+ * sources are cached by chain signature; compiled binaries are further
+ * cached by the engine's program cache.
+ */
+
+struct TonemapChainDesc {
+  int type;       // TONEMAP_FORWARD or TONEMAP_INVERSE
+  bool useXform;  // non-uniform 1D transfer sampling ahead of the 3D LUT
+  bool useCsc;    // 3x3 color space conversion after the 3D LUT
+};
+
+// Returns the fused fragment shader source for the chain; the pointer stays
+// valid for the life of the process.
+const char *TonemapChainShader_Get(const TonemapChainDesc &desc);
+
+#endif  // __TONEMAPPER_TONEMAP_CHAIN_SHADER_H__
@@ -24,11 +24,13 @@
 
 //----------------------------------------------------------------------------------------------------------------------------------------------------------
 Tonemapper *TonemapperFactory_GetInstance(int type, void *colorMap, int colorMapSize,
-                                          void *lutXform, int lutXformSize, bool isSecure)
+                                          void *lutXform, int lutXformSize, bool isSecure,
+                                          const float *csc)
 //----------------------------------------------------------------------------------------------------------------------------------------------------------
 {
   // build the tonemapper
-  Tonemapper *tonemapper = Tonemapper::build(type, colorMap, colorMapSize, lutXform, lutXformSize, isSecure);
+  Tonemapper *tonemapper =
+      Tonemapper::build(type, colorMap, colorMapSize, lutXform, lutXformSize, isSecure, csc);
 
   return tonemapper;
 }
@@ -26,9 +26,11 @@
 extern "C" {
 #endif
 
-// returns an instance of Tonemapper
+// returns an instance of Tonemapper; csc is an optional column-major 3x3 color
+// space conversion fused into the same render pass as the tonemap lut
 Tonemapper *TonemapperFactory_GetInstance(int type, void *colorMap, int colorMapSize,
-                                          void *lutXform, int lutXformSize, bool isSecure);
+                                          void *lutXform, int lutXformSize, bool isSecure,
+                                          const float *csc = 0);
 
 #ifdef __cplusplus
 }
@@ -18,12 +18,12 @@
  */
 #include <utils/Log.h>
 
+#include "CpuTonemapEngine.h"
 #include "EGLImageWrapper.h"
+#include "TonemapChainShader.h"
 #include "Tonemapper.h"
 #include "engine.h"
-#include "forward_tonemap.inl"
 #include "fullscreen_vertex_shader.inl"
-#include "rgba_inverse_tonemap.inl"
 
 //-----------------------------------------------------------------------------
 Tonemapper::Tonemapper()
@@ -32,6 +32,7 @@ Tonemapper::Tonemapper()
   tonemapTexture = 0;
   lutXformTexture = 0;
   programID = 0;
+  cpuEngine = 0;
   eglImageWrapper = new EGLImageWrapper();
 
   lutXformScaleOffset[0] = 1.0f;
@@ -39,6 +40,11 @@ Tonemapper::Tonemapper()
 
   tonemapScaleOffset[0] = 1.0f;
   tonemapScaleOffset[1] = 0.0f;
+
+  useCsc = false;
+  for (int i = 0; i < 9; i++) {
+    cscMatrix[i] = 0.0f;
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -57,11 +63,16 @@ Tonemapper::~Tonemapper()
   }
 
   engine_shutdown(engineContext);
+
+  if (cpuEngine != 0) {
+    delete cpuEngine;
+    cpuEngine = 0;
+  }
 }
 
 //-----------------------------------------------------------------------------
 Tonemapper *Tonemapper::build(int type, void *colorMap, int colorMapSize, void *lutXform,
-                              int lutXformSize, bool isSecure)
+                              int lutXformSize, bool isSecure, const float *csc)
 //-----------------------------------------------------------------------------
 {
   if (colorMapSize <= 0) {
@@ -90,27 +101,26 @@ Tonemapper *Tonemapper::build(int type, void *colorMap, int colorMapSize, void *
       tonemapper->lutXformScaleOffset[1] = 1.0f/(2.0f*lutXformSize);
   }
 
-  // create the program
-  const char *fragmentShaders[3];
-  int fragmentShaderCount = 0;
-  const char *version = "#version 300 es\n";
-  const char *define = "#define USE_NONUNIFORM_SAMPLING\n";
-
-  fragmentShaders[fragmentShaderCount++] = version;
-
-  // non-uniform sampling
-  if (bUseXform) {
-    fragmentShaders[fragmentShaderCount++] = define;
+  // optional fused color space conversion applied after the 3D lut
+  if (csc != 0) {
+    tonemapper->useCsc = true;
+    for (int i = 0; i < 9; i++) {
+      tonemapper->cscMatrix[i] = csc[i];
+    }
   }
 
-  if (type == TONEMAP_INVERSE) {  // inverse tonemapping
-    fragmentShaders[fragmentShaderCount++] = rgba_inverse_tonemap_shader;
-  } else {  // forward tonemapping
-    fragmentShaders[fragmentShaderCount++] = forward_tonemap_shader;
-  }
+  // create the fused chain program; every stage runs in a single pass
+  TonemapChainDesc chain;
+  chain.type = type;
+  chain.useXform = bUseXform;
+  chain.useCsc = tonemapper->useCsc;
+  const char *fragmentShader = TonemapChainShader_Get(chain);
+
+  tonemapper->programID = engine_loadProgram(1, &fullscreen_vertex_shader, 1, &fragmentShader);
 
-  tonemapper->programID =
-      engine_loadProgram(1, &fullscreen_vertex_shader, fragmentShaderCount, fragmentShaders);
+  // CPU fallback for blits too small to amortize the GL round trip
+  tonemapper->cpuEngine =
+      CpuTonemapEngine::build(type, colorMap, colorMapSize, lutXform, lutXformSize, isSecure);
 
   return tonemapper;
 }
@@ -119,6 +129,16 @@ Tonemapper *Tonemapper::build(int type, void *colorMap, int colorMapSize, void *
 int Tonemapper::blit(const void *dst, const void *src, int srcFenceFd)
 //-----------------------------------------------------------------------------
 {
+  // small linear blits finish faster in fixed point than EGL setup alone takes;
+  // chains with a fused csc stage have no fixed point equivalent
+  if (!useCsc && (cpuEngine != 0) && cpuEngine->canBlit(dst, src)) {
+    int ret = cpuEngine->blit(dst, src, srcFenceFd);
+    if (ret == -1) {
+      return ret;
+    }
+    // mapping failed; fall through to the GL path
+  }
+
   // make current
   engine_bind(engineContext);
 
@@ -135,6 +155,9 @@ int Tonemapper::blit(const void *dst, const void *src, int srcFenceFd)
   {
     engine_setData2f(4, lutXformScaleOffset);
   }
+  if (useCsc) {
+    engine_setData3x3f(5, cscMatrix);
+  }
 
   // set destination
   if (dst_buffer) {
@@ -155,3 +178,18 @@ int Tonemapper::blit(const void *dst, const void *src, int srcFenceFd)
 
   return fenceFD;
 }
+
+//-----------------------------------------------------------------------------
+void Tonemapper::prewarm(const void *buffer)
+//-----------------------------------------------------------------------------
+{
+  if (buffer == 0) {
+    return;
+  }
+
+  // make current
+  engine_bind(engineContext);
+
+  // create and cache the eglimage ahead of the first blit of this buffer
+  eglImageWrapper->prewarm(buffer);
+}
@@ -26,22 +26,28 @@
 #include "EGLImageWrapper.h"
 #include "engine.h"
 
+class CpuTonemapEngine;
+
 class Tonemapper {
  private:
   void* engineContext;
+  CpuTonemapEngine* cpuEngine;  // fixed-point fallback for small linear blits
   unsigned int tonemapTexture;
   unsigned int lutXformTexture;
   unsigned int programID;
   float lutXformScaleOffset[2];
   float tonemapScaleOffset[2];
+  float cscMatrix[9];  // column-major 3x3, fused into the chain shader when useCsc is set
+  bool useCsc;
   EGLImageWrapper* eglImageWrapper;
   Tonemapper();
 
  public:
   ~Tonemapper();
   static Tonemapper *build(int type, void *colorMap, int colorMapSize, void *lutXform,
-                           int lutXformSize, bool isSecure);
+                           int lutXformSize, bool isSecure, const float *csc = 0);
   int blit(const void *dst, const void *src, int srcFenceFd);
+  void prewarm(const void *buffer);
 };
 
 #endif  //__TONEMAPPER_TONEMAP_H__
@@ -18,12 +18,21 @@
  */
 
 #include "glengine.h"
+#include <inttypes.h>
 #include <log/log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include "engine.h"
 
 void checkGlError(const char *, int);
 void checkEglError(const char *, int);
 
+// Directory for cached tonemap program binaries. Binaries are keyed on a hash of the
+// shader permutation so a driver or shader update simply misses the cache and recompiles.
+static const char *kProgramCacheDir = "/data/vendor/display";
+
 class EngineContext {
     public:
     EGLDisplay eglDisplay;
@@ -134,6 +143,13 @@ void engine_setData2f(int location, float* data)
     GL(glUniform2f(location, data[0], data[1]));
 }
 
+//-----------------------------------------------------------------------------
+void engine_setData3x3f(int location, float* data)
+//-----------------------------------------------------------------------------
+{
+    GL(glUniformMatrix3fv(location, 1, GL_FALSE, data));
+}
+
 //-----------------------------------------------------------------------------
 unsigned int engine_load3DTexture(void *colorMapData, int sz, int format)
 //-----------------------------------------------------------------------------
@@ -184,12 +200,139 @@ void dumpShaderLog(int shader)
   }
 }
 
+//-----------------------------------------------------------------------------
+static uint64_t hashShaderSources(int vertexEntries, const char **vertex, int fragmentEntries,
+                                  const char **fragment)
+//-----------------------------------------------------------------------------
+{
+  // FNV-1a over every source string; entry boundaries are folded in so permutations built
+  // from the same fragments in a different arrangement do not collide.
+  uint64_t hash = 14695981039346656037ULL;
+  const uint64_t prime = 1099511628211ULL;
+  for (int i = 0; i < vertexEntries + fragmentEntries; i++) {
+    const char *src = (i < vertexEntries) ? vertex[i] : fragment[i - vertexEntries];
+    for (const char *p = src; *p; p++) {
+      hash = (hash ^ (uint64_t)(unsigned char)(*p)) * prime;
+    }
+    hash = (hash ^ 0xffULL) * prime;
+  }
+  return hash;
+}
+
+//-----------------------------------------------------------------------------
+static void cachedProgramPath(uint64_t key, char *path, size_t size)
+//-----------------------------------------------------------------------------
+{
+  snprintf(path, size, "%s/tonemap_program_%016" PRIx64 ".bin", kProgramCacheDir, key);
+}
+
+//-----------------------------------------------------------------------------
+static GLuint loadCachedProgram(uint64_t key)
+//-----------------------------------------------------------------------------
+{
+  char path[256];
+  cachedProgramPath(key, path, sizeof(path));
+
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return 0;
+  }
+
+  GLenum binaryFormat = 0;
+  long binaryLength = 0;
+  fseek(fp, 0, SEEK_END);
+  binaryLength = ftell(fp) - (long)sizeof(binaryFormat);
+  fseek(fp, 0, SEEK_SET);
+  if (binaryLength <= 0 || fread(&binaryFormat, sizeof(binaryFormat), 1, fp) != 1) {
+    fclose(fp);
+    return 0;
+  }
+
+  void *binary = malloc(binaryLength);
+  if (binary == NULL || fread(binary, binaryLength, 1, fp) != 1) {
+    free(binary);
+    fclose(fp);
+    return 0;
+  }
+  fclose(fp);
+
+  GLuint progId = glCreateProgram();
+  glProgramBinary(progId, binaryFormat, binary, binaryLength);
+  free(binary);
+
+  // A stale binary (driver update) fails to link; caller falls back to compiling.
+  int linked = 0;
+  GL(glGetProgramiv(progId, GL_LINK_STATUS, &linked));
+  if (!linked) {
+    glGetError();  // eat the glProgramBinary error
+    GL(glDeleteProgram(progId));
+    unlink(path);
+    return 0;
+  }
+
+  return progId;
+}
+
+//-----------------------------------------------------------------------------
+static void storeCachedProgram(uint64_t key, GLuint progId)
+//-----------------------------------------------------------------------------
+{
+  GLint binaryLength = 0;
+  GL(glGetProgramiv(progId, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+  if (binaryLength <= 0) {
+    return;
+  }
+
+  void *binary = malloc(binaryLength);
+  if (binary == NULL) {
+    return;
+  }
+
+  GLenum binaryFormat = 0;
+  GLsizei written = 0;
+  GL(glGetProgramBinary(progId, binaryLength, &written, &binaryFormat, binary));
+  if (written <= 0) {
+    free(binary);
+    return;
+  }
+
+  char path[256];
+  char tmpPath[272];
+  cachedProgramPath(key, path, sizeof(path));
+  snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", path);
+
+  // Write to a temp file and rename so readers never see a partial binary.
+  FILE *fp = fopen(tmpPath, "wb");
+  if (fp != NULL) {
+    bool ok = (fwrite(&binaryFormat, sizeof(binaryFormat), 1, fp) == 1) &&
+              (fwrite(binary, written, 1, fp) == 1);
+    fclose(fp);
+    if (ok) {
+      rename(tmpPath, path);
+    } else {
+      unlink(tmpPath);
+    }
+  }
+  free(binary);
+}
+
 //-----------------------------------------------------------------------------
 GLuint engine_loadProgram(int vertexEntries, const char **vertex, int fragmentEntries,
                           const char **fragment)
 //-----------------------------------------------------------------------------
 {
-  GLuint progId = glCreateProgram();
+  uint64_t key = hashShaderSources(vertexEntries, vertex, fragmentEntries, fragment);
+
+  GLuint progId = loadCachedProgram(key);
+  if (progId != 0) {
+    ALOGI("Loaded cached tonemap program for key %016" PRIx64, key);
+    return progId;
+  }
+
+  progId = glCreateProgram();
+
+  // Request a retrievable binary before linking so it can be persisted below.
+  GL(glProgramParameteri(progId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
 
   int vertId = glCreateShader(GL_VERTEX_SHADER);
   int fragId = glCreateShader(GL_FRAGMENT_SHADER);
@@ -213,6 +356,12 @@ GLuint engine_loadProgram(int vertexEntries, const char **vertex, int fragmentEn
   GL(glDeleteShader(vertId));
   GL(glDeleteShader(fragId));
 
+  int linked = 0;
+  GL(glGetProgramiv(progId, GL_LINK_STATUS, &linked));
+  if (linked) {
+    storeCachedProgram(key, progId);
+  }
+
   return progId;
 }
 
@@ -73,15 +73,9 @@ ndk::ScopedAStatus QtiAllocatorAIDL::allocate(const std::vector<uint8_t>& descri
   }
 
   std::vector<buffer_handle_t> buffers;
-  buffers.reserve(count);
-
-  for (uint32_t i = 0; i < count; i++) {
-    buffer_handle_t buffer;
-    err = buf_mgr_->AllocateBuffer(desc, &buffer);
-    if (err != Error::NONE) {
-      return ToBinderStatus(err);
-    }
-    buffers.emplace_back(buffer);
+  err = buf_mgr_->AllocateBuffers(desc, static_cast<uint32_t>(count), &buffers);
+  if (err != Error::NONE) {
+    return ToBinderStatus(err);
   }
 
   if (buffers.size() > 0) {
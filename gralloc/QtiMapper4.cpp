@@ -189,7 +189,12 @@ Error QtiMapper::LockBuffer(void *buffer, uint64_t usage, const hidl_handle &acq
       access_region.height > hnd->height) {
     return Error::BAD_VALUE;
   }
-  return static_cast<IMapper_4_0_Error>(buf_mgr_->LockBuffer(hnd, usage));
+
+  // Forward the declared access region so cache maintenance for this lock/unlock pair can be
+  // restricted to the scanlines the client actually touches.
+  gralloc::BufferAccessRegion region = {access_region.left, access_region.top, access_region.width,
+                                        access_region.height};
+  return static_cast<IMapper_4_0_Error>(buf_mgr_->LockBuffer(hnd, usage, region));
 }
 
 Return<void> QtiMapper::lock(void *buffer, uint64_t cpu_usage, const IMapper::Rect &access_region,
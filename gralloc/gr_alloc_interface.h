@@ -114,6 +114,30 @@ class AllocInterface {
   virtual int CleanBuffer(void *base, unsigned int size, unsigned int offset, int handle, int op,
                           int fd) = 0;
 
+  /*! @brief Ranged variant of CleanBuffer restricted to the byte span
+       [range_offset, range_offset + range_length) of the buffer.
+
+    @details Backends without a ranged sync primitive fall back to the full-buffer operation,
+       so a ranged request is a best-effort optimization, never a correctness requirement.
+       A range_length of 0 means the whole buffer.
+
+    @param[out] base - virtual base address
+    @param[in] size - size of the buffer
+    @param[in] offset - offset of the buffer
+    @param[in] range_offset - start of the span to sync, in bytes from the buffer start
+    @param[in] range_length - length of the span to sync in bytes, 0 for the whole buffer
+    @param[in] handle - handle of the buffer
+    @param[in] op - cache operation to be done on buffer
+    @param[in] fd - fd of the buffer
+
+    @return Returns 0 on sucess otherwise errno
+  */
+  virtual int CleanBufferRange(void *base, unsigned int size, unsigned int offset,
+                               unsigned int /* range_offset */, unsigned int /* range_length */,
+                               int handle, int op, int fd) {
+    return CleanBuffer(base, size, offset, handle, op, fd);
+  }
+
   /*! @brief Method to import buffer
 
     @param[in] fd - fd of the buffer to be imported
@@ -150,6 +150,21 @@ int Allocator::CleanBuffer(void *base, unsigned int size, unsigned int offset, i
   return -EINVAL;
 }
 
+int Allocator::CleanBufferRange(void *base, unsigned int size, unsigned int offset,
+                                unsigned int range_offset, unsigned int range_length, int handle,
+                                int op, int fd) {
+  AllocInterface *alloc_intf = AllocInterface::GetInstance();
+  if (!alloc_intf) {
+    return -ENOMEM;
+  }
+  if (alloc_intf) {
+    return alloc_intf->CleanBufferRange(base, size, offset, range_offset, range_length, handle, op,
+                                        fd);
+  }
+
+  return -EINVAL;
+}
+
 bool Allocator::CheckForBufferSharing(uint32_t num_descriptors,
                                       const vector<shared_ptr<BufferDescriptor>> &descriptors,
                                       ssize_t *max_index) {
@@ -47,6 +47,9 @@ class Allocator {
   int ImportBuffer(int fd);
   int FreeBuffer(void *base, unsigned int size, unsigned int offset, int fd, int handle);
   int CleanBuffer(void *base, unsigned int size, unsigned int offset, int handle, int op, int fd);
+  int CleanBufferRange(void *base, unsigned int size, unsigned int offset,
+                       unsigned int range_offset, unsigned int range_length, int handle, int op,
+                       int fd);
   int AllocateMem(AllocData *data, uint64_t usage, int format);
   // @return : index of the descriptor with maximum buffer size req
   bool CheckForBufferSharing(uint32_t num_descriptors,
@@ -31,15 +31,19 @@
 #include <sys/mman.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 #include <fstream>
 
 #include "gr_adreno_info.h"
 #include "gr_buf_descriptor.h"
+#include "gr_metadata_notify.h"
+#include "gr_shared_layout.h"
 #include "gr_utils.h"
 #include "qd_utils.h"
 #include "color_extensions.h"
@@ -268,7 +272,6 @@ int BufferManager::GetCustomDimensions(private_handle_t *hnd, int *stride, int *
 }
 
 BufferManager::BufferManager() : next_id_(0) {
-  handles_map_.clear();
   allocator_ = new Allocator();
   enable_logs = property_get_bool(ENABLE_LOGS_PROP, 0);
 }
@@ -364,9 +367,15 @@ void BufferManager::RegisterHandleLocked(const private_handle_t *hnd, int ion_ha
     buffer->reserved_region_ptr = reinterpret_cast<void *>(&(metadata->reservedRegion.data));
     buffer->reserved_size = metadata->reservedRegion.size;
 #endif
+
+    MetadataNotify *notify = GetMetadataNotify(hnd->base_metadata, hnd->reserved_size,
+                                               hnd->custom_content_md_reserved_size);
+    if (MetadataNotifyValid(notify)) {
+      buffer->metadata_notify_ptr = notify;
+    }
   }
 
-  handles_map_.emplace(std::make_pair(hnd, buffer));
+  GetShard(hnd).map.emplace(std::make_pair(hnd, buffer));
 }
 
 Error BufferManager::ImportHandleLocked(private_handle_t *hnd) {
@@ -400,18 +409,14 @@ Error BufferManager::ImportHandleLocked(private_handle_t *hnd) {
   }
 
   RegisterHandleLocked(hnd, ion_handle, ion_handle_meta);
-  allocated_ += hnd->size;
-  if (allocated_ >= kAllocThreshold) {
-    kAllocThreshold += kMemoryOffset;
-    BuffersDump();
-  }
   return Error::NONE;
 }
 
 std::shared_ptr<BufferManager::Buffer> BufferManager::GetBufferFromHandleLocked(
     const private_handle_t *hnd) {
-  auto it = handles_map_.find(hnd);
-  if (it != handles_map_.end()) {
+  auto &shard = GetShard(hnd);
+  auto it = shard.map.find(hnd);
+  if (it != shard.map.end()) {
     return it->second;
   } else {
     return nullptr;
@@ -437,7 +442,7 @@ Error BufferManager::MapBuffer(private_handle_t const *handle) {
 }
 
 Error BufferManager::IsBufferImported(const private_handle_t *hnd) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
   auto buf = GetBufferFromHandleLocked(hnd);
   if (buf != nullptr) {
     return Error::NONE;
@@ -448,39 +453,118 @@ Error BufferManager::IsBufferImported(const private_handle_t *hnd) {
 Error BufferManager::RetainBuffer(private_handle_t const *hnd) {
   ALOGD_IF(enable_logs, "Retain buffer handle:%p id: %" PRIu64, hnd, hnd->id);
   auto err = Error::NONE;
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-  auto buf = GetBufferFromHandleLocked(hnd);
-  if (buf != nullptr) {
-    buf->IncRef();
-  } else {
-    private_handle_t *handle = const_cast<private_handle_t *>(hnd);
-    err = ImportHandleLocked(handle);
+  bool imported = false;
+  {
+    std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
+    auto buf = GetBufferFromHandleLocked(hnd);
+    if (buf != nullptr) {
+      buf->IncRef();
+    } else {
+      private_handle_t *handle = const_cast<private_handle_t *>(hnd);
+      err = ImportHandleLocked(handle);
+      imported = (err == Error::NONE);
+    }
+  }
+  // Memory accounting runs outside the shard lock as a threshold crossing dumps all shards.
+  if (imported) {
+    AccountAllocation(hnd->size);
   }
   return err;
 }
 
 Error BufferManager::ReleaseBuffer(private_handle_t const *hnd) {
   ALOGD_IF(enable_logs, "Release buffer handle:%p", hnd);
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-  auto buf = GetBufferFromHandleLocked(hnd);
-  if (buf == nullptr) {
-    ALOGE("Could not find handle: %p", hnd);
-    return Error::BAD_BUFFER;
-  } else {
-    if (buf->DecRef()) {
-      handles_map_.erase(hnd);
-      // Unmap, close ion handle and close fd
-      if (allocated_ >= hnd->size) {
-        allocated_ -= hnd->size;
+  uint64_t released_size = 0;
+  {
+    std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
+    auto buf = GetBufferFromHandleLocked(hnd);
+    if (buf == nullptr) {
+      ALOGE("Could not find handle: %p", hnd);
+      return Error::BAD_BUFFER;
+    } else {
+      if (buf->DecRef()) {
+        GetShard(hnd).map.erase(hnd);
+        released_size = hnd->size;
+        // Unmap, close ion handle and close fd
+        FreeBuffer(buf);
       }
-      FreeBuffer(buf);
     }
   }
+  if (released_size) {
+    AccountRelease(released_size);
+  }
   return Error::NONE;
 }
 
+int BufferManager::CleanBufferRegion(const std::shared_ptr<Buffer> &buf,
+                                     const private_handle_t *hnd, int op) {
+  void *base = reinterpret_cast<void *>(hnd->base);
+  const BufferAccessRegion &region = buf->lock_region;
+
+  // Rect-to-byte-span mapping is only well defined for uncompressed linear layouts, and only
+  // pays off when the region leaves scanlines untouched. Columns are ignored on purpose:
+  // rows are contiguous in memory so a row span is the tightest range one sync can cover.
+  int unaligned_height = INT(hnd->unaligned_height);
+  bool partial = region.top >= 0 && region.width > 0 && region.height > 0 &&
+                 (region.top > 0 || region.height < unaligned_height) &&
+                 !(hnd->flags & qtigralloc::PRIV_FLAGS_UBWC_ALIGNED);
+
+  unsigned int aligned_w = 0;
+  unsigned int aligned_h = 0;
+  int plane_count = 0;
+  PlaneLayoutInfo plane_info[8] = {};
+  BufferInfo info(INT(hnd->unaligned_width), unaligned_height, hnd->format, hnd->usage);
+  if (partial && GetAlignedWidthAndHeight(info, &aligned_w, &aligned_h)) {
+    partial = false;
+  }
+  if (partial) {
+    if (IsYuvFormat(hnd->format)) {
+      partial = (GetYUVPlaneInfo(info, hnd->format, INT(aligned_w), INT(aligned_h),
+                                 0 /* interlaced */, &plane_count, plane_info, hnd) == 0);
+    } else {
+      GetRGBPlaneInfo(info, hnd->format, INT(aligned_w), INT(aligned_h), 0 /* flags */,
+                      &plane_count, plane_info);
+    }
+    partial = partial && plane_count > 0 && plane_count <= 8;
+  }
+
+  if (!partial) {
+    return allocator_->CleanBuffer(base, hnd->size, hnd->offset, buf->ion_handle_main, op,
+                                   hnd->fd);
+  }
+
+  int status = 0;
+  for (int i = 0; i < plane_count; i++) {
+    const PlaneLayoutInfo &plane = plane_info[i];
+    uint32_t v_sub = plane.v_subsampling ? plane.v_subsampling : 1;
+    if (plane.stride_bytes <= 0) {
+      return allocator_->CleanBuffer(base, hnd->size, hnd->offset, buf->ion_handle_main, op,
+                                     hnd->fd);
+    }
+    uint64_t first_row = UINT(region.top) / v_sub;
+    uint64_t row_count = (UINT(region.height) + v_sub - 1) / v_sub;
+    uint64_t start = plane.offset + first_row * UINT(plane.stride_bytes);
+    if (start >= hnd->size) {
+      continue;
+    }
+    uint64_t length = std::min(row_count * UINT(plane.stride_bytes),
+                               static_cast<uint64_t>(hnd->size) - start);
+    if (allocator_->CleanBufferRange(base, hnd->size, hnd->offset, UINT(start), UINT(length),
+                                     buf->ion_handle_main, op, hnd->fd) != 0) {
+      status = -1;
+    }
+  }
+
+  return status;
+}
+
 Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  return LockBuffer(hnd, usage, BufferAccessRegion());
+}
+
+Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage,
+                                const BufferAccessRegion &region) {
+  std::lock_guard<std::mutex> lock(GetShard(hnd).lock);
   auto err = Error::NONE;
   ALOGD_IF(enable_logs, "LockBuffer buffer handle:%p id: %" PRIu64, hnd, hnd->id);
 
@@ -499,6 +583,8 @@ Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
     err = MapBuffer(hnd);
   }
 
+  buf->lock_region = region;
+
   // Invalidate if CPU reads in software and there are non-CPU
   // writers. No need to do this for the metadata buffer as it is
   // only read/written in software.
@@ -506,8 +592,7 @@ Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
   // todo use handle here
   if (err == Error::NONE && (hnd->flags & qtigralloc::PRIV_FLAGS_USES_ION) &&
       (hnd->flags & qtigralloc::PRIV_FLAGS_CACHED)) {
-    if (allocator_->CleanBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset,
-                                buf->ion_handle_main, CACHE_INVALIDATE, hnd->fd)) {
+    if (CleanBufferRegion(buf, hnd, CACHE_INVALIDATE)) {
       return Error::BAD_BUFFER;
     }
   }
@@ -522,7 +607,7 @@ Error BufferManager::LockBuffer(const private_handle_t *hnd, uint64_t usage) {
 }
 
 Error BufferManager::FlushBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -531,8 +616,7 @@ Error BufferManager::FlushBuffer(const private_handle_t *handle) {
     return Error::BAD_BUFFER;
   }
 
-  if (allocator_->CleanBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset,
-                              buf->ion_handle_main, CACHE_CLEAN, hnd->fd) != 0) {
+  if (CleanBufferRegion(buf, hnd, CACHE_CLEAN) != 0) {
     status = Error::BAD_BUFFER;
   }
 
@@ -540,7 +624,7 @@ Error BufferManager::FlushBuffer(const private_handle_t *handle) {
 }
 
 Error BufferManager::RereadBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -549,8 +633,7 @@ Error BufferManager::RereadBuffer(const private_handle_t *handle) {
     return Error::BAD_BUFFER;
   }
 
-  if (allocator_->CleanBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset,
-                              buf->ion_handle_main, CACHE_INVALIDATE, hnd->fd) != 0) {
+  if (CleanBufferRegion(buf, hnd, CACHE_INVALIDATE) != 0) {
     status = Error::BAD_BUFFER;
   }
 
@@ -558,7 +641,7 @@ Error BufferManager::RereadBuffer(const private_handle_t *handle) {
 }
 
 Error BufferManager::UnlockBuffer(const private_handle_t *handle) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   auto status = Error::NONE;
 
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -568,17 +651,16 @@ Error BufferManager::UnlockBuffer(const private_handle_t *handle) {
   }
 
   if (hnd->flags & qtigralloc::PRIV_FLAGS_NEEDS_FLUSH) {
-    if (allocator_->CleanBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset,
-                                buf->ion_handle_main, CACHE_CLEAN, hnd->fd) != 0) {
+    if (CleanBufferRegion(buf, hnd, CACHE_CLEAN) != 0) {
       status = Error::BAD_BUFFER;
     }
     hnd->flags &= ~qtigralloc::PRIV_FLAGS_NEEDS_FLUSH;
   } else {
-    if (allocator_->CleanBuffer(reinterpret_cast<void *>(hnd->base), hnd->size, hnd->offset,
-                                buf->ion_handle_main, CACHE_READ_DONE, hnd->fd) != 0) {
+    if (CleanBufferRegion(buf, hnd, CACHE_READ_DONE) != 0) {
       status = Error::BAD_BUFFER;
     }
   }
+  buf->lock_region = BufferAccessRegion();
 
   return status;
 }
@@ -612,51 +694,165 @@ static void InitializePrivateHandle(private_handle_t *hnd, int fd, int meta_fd,
   hnd->ubwcp_format = false;
 }
 
-Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_handle_t *handle,
-                                    unsigned int bufferSize, bool testAlloc) {
-  if (!handle)
-    return Error::BAD_BUFFER;
-  std::lock_guard<std::mutex> buffer_lock(buffer_lock_);
-
+Error BufferManager::ComputeAllocationLayout(const BufferDescriptor &descriptor,
+                                             AllocationLayout *layout) {
   uint64_t reserved_size = descriptor.GetReservedSize();
-  uint64_t usage = descriptor.GetUsage();
-  int format = GetImplDefinedFormat(usage, descriptor.GetFormat());
-  uint64_t custom_content_md_reserved_size = GetCustomContentMetadataSize(format, usage);
-  if (reserved_size + sizeof(MetaData_t) + getpagesize() + custom_content_md_reserved_size >=
-      UINT32_MAX) {
-    return Error::UNSUPPORTED;
+  int raw_format = descriptor.GetFormat();
+  uint64_t hash = static_cast<uint64_t>(raw_format) * 31 +
+                  static_cast<uint64_t>(descriptor.GetWidth()) * 17 +
+                  static_cast<uint64_t>(descriptor.GetHeight()) * 7 +
+                  static_cast<uint64_t>(descriptor.GetLayerCount()) * 3 + descriptor.GetUsage();
+  uint32_t slot = static_cast<uint32_t>(hash % kLayoutCacheEntries);
+  {
+    std::lock_guard<std::mutex> lock(layout_cache_lock_);
+    LayoutCacheEntry &entry = layout_cache_[slot];
+    if (entry.valid && entry.format == raw_format && entry.usage == descriptor.GetUsage() &&
+        entry.width == descriptor.GetWidth() && entry.height == descriptor.GetHeight() &&
+        entry.layer_count == descriptor.GetLayerCount()) {
+      // The metadata overflow check is the one input outside the cache key; redo it.
+      if (reserved_size + sizeof(MetaData_t) + getpagesize() +
+              entry.layout.custom_content_md_reserved_size >= UINT32_MAX) {
+        return Error::UNSUPPORTED;
+      }
+      *layout = entry.layout;
+      return Error::NONE;
+    }
   }
 
-  uint32_t layer_count = descriptor.GetLayerCount();
-
-  unsigned int size;
-  unsigned int alignedw, alignedh;
-  int err = 0;
+  layout->usage = descriptor.GetUsage();
+  layout->format = GetImplDefinedFormat(layout->usage, descriptor.GetFormat());
+  layout->custom_content_md_reserved_size =
+      GetCustomContentMetadataSize(layout->format, layout->usage);
+  if (reserved_size + sizeof(MetaData_t) + getpagesize() +
+          layout->custom_content_md_reserved_size >= UINT32_MAX) {
+    return Error::UNSUPPORTED;
+  }
 
-  int buffer_type = GetBufferType(format);
+  layout->layer_count = descriptor.GetLayerCount();
+  layout->buffer_type = GetBufferType(layout->format);
   BufferInfo info = GetBufferInfo(descriptor);
-  info.format = format;
-  info.layer_count = layer_count;
+  info.format = layout->format;
+  info.layer_count = layout->layer_count;
 
-  GraphicsMetadata graphics_metadata = {};
-  err = GetBufferSizeAndDimensions(info, &size, &alignedw, &alignedh, &graphics_metadata);
+  int err = GetBufferSizeAndDimensions(info, &layout->size, &layout->alignedw, &layout->alignedh,
+                                       &layout->graphics_metadata);
   if (err == -ENOTSUP) {
     return Error::UNSUPPORTED;
   } else if (err < 0) {
     return Error::BAD_DESCRIPTOR;
   }
 
-  if (size == 0) {
+  if (layout->size == 0) {
     ALOGW("gralloc failed to allocate buffer for size %d format %d AWxAH %dx%d usage %" PRIu64,
-          size, format, alignedw, alignedh, usage);
+          layout->size, layout->format, layout->alignedw, layout->alignedh, layout->usage);
     return Error::UNSUPPORTED;
   }
 
+  std::lock_guard<std::mutex> lock(layout_cache_lock_);
+  layout_cache_[slot] = {true, raw_format, descriptor.GetWidth(), descriptor.GetHeight(),
+                         descriptor.GetLayerCount(), descriptor.GetUsage(), *layout};
+  return Error::NONE;
+}
+
+Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_handle_t *handle,
+                                    unsigned int bufferSize, bool testAlloc) {
+  if (!handle)
+    return Error::BAD_BUFFER;
+
+  AllocationLayout layout;
+  Error status = ComputeAllocationLayout(descriptor, &layout);
+  if (status != Error::NONE) {
+    return status;
+  }
+
   if (testAlloc) {
     return Error::NONE;
   }
 
-  size = (bufferSize >= size) ? bufferSize : size;
+  layout.size = (bufferSize >= layout.size) ? bufferSize : layout.size;
+  return AllocateBufferFromLayout(descriptor, layout, handle);
+}
+
+Error BufferManager::AllocateBuffers(const BufferDescriptor &descriptor, uint32_t count,
+                                     std::vector<buffer_handle_t> *handles) {
+  if (!handles)
+    return Error::BAD_BUFFER;
+
+  if (count == 0)
+    return Error::NONE;
+
+  // Compute the descriptor-derived layout (format resolution, size/alignment query, graphics
+  // metadata) once and reuse it for every buffer in the batch.
+  AllocationLayout layout;
+  Error status = ComputeAllocationLayout(descriptor, &layout);
+  if (status != Error::NONE) {
+    return status;
+  }
+
+  handles->resize(count, nullptr);
+  std::vector<Error> results(count, Error::NONE);
+
+  // Each allocation is independent - the dma-buf ioctls, metadata mapping and
+  // the sharded handle table all tolerate concurrent callers - so fan a burst
+  // out over a few short-lived workers instead of serializing 30+ camera or
+  // codec buffers on one thread. Single and double allocations stay inline;
+  // thread startup would cost more than it saves.
+  std::atomic<uint32_t> next_index(0);
+  auto worker = [&]() {
+    uint32_t i = 0;
+    while ((i = next_index.fetch_add(1)) < count) {
+      results[i] = AllocateBufferFromLayout(descriptor, layout, &(*handles)[i]);
+    }
+  };
+
+  uint32_t workers = std::min(count / 2, kAllocWorkerCount);
+  if (workers > 1) {
+    std::vector<std::thread> threads;
+    threads.reserve(workers);
+    for (uint32_t i = 0; i < workers; i++) {
+      threads.emplace_back(worker);
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  } else {
+    worker();
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    if (results[i] != Error::NONE) {
+      status = results[i];
+    }
+  }
+
+  if (status != Error::NONE) {
+    // Unwind buffers already allocated in this batch so a partial failure leaks nothing.
+    for (auto allocated : *handles) {
+      if (allocated) {
+        ReleaseBuffer(static_cast<const private_handle_t *>(allocated));
+      }
+    }
+    handles->clear();
+    return status;
+  }
+
+  return Error::NONE;
+}
+
+Error BufferManager::AllocateBufferFromLayout(const BufferDescriptor &descriptor,
+                                              const AllocationLayout &layout,
+                                              buffer_handle_t *handle) {
+  uint64_t usage = layout.usage;
+  int format = layout.format;
+  int buffer_type = layout.buffer_type;
+  uint32_t layer_count = layout.layer_count;
+  unsigned int size = layout.size;
+  unsigned int alignedw = layout.alignedw;
+  unsigned int alignedh = layout.alignedh;
+  uint64_t custom_content_md_reserved_size = layout.custom_content_md_reserved_size;
+  GraphicsMetadata graphics_metadata = layout.graphics_metadata;
+  int err = 0;
+
   uint64_t flags = 0;
   auto page_size = UINT(getpagesize());
   AllocData data;
@@ -745,11 +941,39 @@ Error BufferManager::AllocateBuffer(const BufferDescriptor &descriptor, buffer_h
   metadata->heapName[heap_name_length] = '\0';
 #endif
 
+  MetadataNotifyInit(GetMetadataNotify(hnd->base_metadata, hnd->reserved_size,
+                                       hnd->custom_content_md_reserved_size));
+
+  // Publish the derived plane layout into the shared metadata page. Consumers in other
+  // processes resolve plane geometry from this block instead of each re-deriving it; the
+  // arguments mirror the GetPlaneLayout() compute path so both produce identical layouts.
+  SharedBufferLayout *shared_layout = GetSharedBufferLayout(
+      hnd->base_metadata, hnd->reserved_size, hnd->custom_content_md_reserved_size);
+  if (shared_layout) {
+    SharedBufferLayoutInit(shared_layout);
+    PlaneLayoutInfo plane_info[8] = {};
+    int plane_count = 0;
+    BufferInfo info(hnd->unaligned_width, hnd->unaligned_height, hnd->format, hnd->usage);
+    if (IsYuvFormat(hnd->format)) {
+      if (GetYUVPlaneInfo(info, hnd->format, hnd->width, hnd->height, hnd->flags, &plane_count,
+                          plane_info, hnd) == 0) {
+        SharedBufferLayoutPublish(shared_layout, plane_info, plane_count);
+      }
+    } else if (IsUncompressedRGBFormat(hnd->format) || IsCompressedRGBFormat(hnd->format)) {
+      GetRGBPlaneInfo(info, hnd->format, hnd->width, hnd->height, hnd->flags, &plane_count,
+                      plane_info);
+      SharedBufferLayoutPublish(shared_layout, plane_info, plane_count);
+    }
+  }
+
   UnmapAndReset(hnd);
 
   *handle = hnd;
 
-  RegisterHandleLocked(hnd, data.ion_handle, e_data.ion_handle);
+  {
+    std::lock_guard<std::mutex> shard_lock(GetShard(hnd).lock);
+    RegisterHandleLocked(hnd, data.ion_handle, e_data.ion_handle);
+  }
   ALOGD_IF(enable_logs,
            "Allocated buffer info: handle id:%" PRIu64
            " wxh:%dx%d uwxuh:%dx%d size: %d fd:%d fd_meta:%d flags:0x%x "
@@ -783,18 +1007,40 @@ void BufferManager::BuffersDump() {
   }
   fs << "============================" << std::endl;
   fs << timeStamp << std::endl;
-  fs << "Total layers = " << handles_map_.size() << std::endl;
+
+  // Snapshot the per-buffer fields under the shard locks and format with the locks dropped,
+  // so a bugreport-sized walk (thousands of live buffers) does not stall allocation.
+  struct BufferDumpRecord {
+    std::string client;
+    int width;
+    int height;
+    uint64_t size;
+  };
+  std::vector<BufferDumpRecord> records;
+  uint64_t total_layers = 0;
   uint64_t totalAllocationSize = 0;
-  for (auto it : handles_map_) {
-    auto buf = it.second;
-    auto hnd = buf->handle;
-    auto metadata = reinterpret_cast<MetaData_t *>(hnd->base_metadata);
-    fs << std::setw(80) << "Client:" << (metadata ? metadata->name : "No name");
-    fs << std::setw(20) << "WxH:" << std::setw(4) << hnd->width << " x " << std::setw(4)
-       << hnd->height;
-    fs << std::setw(20) << "Size: " << std::setw(9) << hnd->size << std::endl;
-    totalAllocationSize += hnd->size;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    total_layers += shard.map.size();
+    records.reserve(total_layers);
+    for (auto it : shard.map) {
+      auto hnd = it.second->handle;
+      auto metadata = reinterpret_cast<MetaData_t *>(hnd->base_metadata);
+      records.push_back({metadata ? metadata->name : "No name", hnd->width, hnd->height,
+                         static_cast<uint64_t>(hnd->size)});
+      totalAllocationSize += hnd->size;
+    }
+  }
+
+  std::ostringstream entries;
+  for (auto &rec : records) {
+    entries << std::setw(80) << "Client:" << rec.client;
+    entries << std::setw(20) << "WxH:" << std::setw(4) << rec.width << " x " << std::setw(4)
+            << rec.height;
+    entries << std::setw(20) << "Size: " << std::setw(9) << rec.size << std::endl;
   }
+  fs << "Total layers = " << total_layers << std::endl;
+  fs << entries.str();
   fs << "Total allocation  = " << totalAllocationSize / 1024 << "KiB" << std::endl;
   file_dump_.position = fs.tellp();
   if (file_dump_.position > (20 * 1024 * 1024)) {
@@ -803,47 +1049,89 @@ void BufferManager::BuffersDump() {
   fs.close();
 }
 
+void BufferManager::AccountAllocation(uint64_t size) {
+  std::lock_guard<std::mutex> lock(alloc_stats_lock_);
+  allocated_ += size;
+  if (allocated_ >= kAllocThreshold) {
+    kAllocThreshold += kMemoryOffset;
+    BuffersDump();
+  }
+}
+
+void BufferManager::AccountRelease(uint64_t size) {
+  std::lock_guard<std::mutex> lock(alloc_stats_lock_);
+  if (allocated_ >= size) {
+    allocated_ -= size;
+  }
+}
+
 Error BufferManager::Dump(std::ostringstream *os) {
-  std::lock_guard<std::mutex> buffer_lock(buffer_lock_);
-  for (auto it : handles_map_) {
-    auto buf = it.second;
-    auto hnd = buf->handle;
-    *os << "handle id: " << std::setw(4) << hnd->id;
-    *os << " fd: " << std::setw(3) << hnd->fd;
-    *os << " fd_meta: " << std::setw(3) << hnd->fd_metadata;
-    *os << " wxh: " << std::setw(4) << hnd->width << " x " << std::setw(4) << hnd->height;
-    *os << " uwxuh: " << std::setw(4) << hnd->unaligned_width << " x ";
-    *os << std::setw(4) << hnd->unaligned_height;
-    *os << " size: " << std::setw(9) << hnd->size;
+  // Same snapshot-then-format split as BuffersDump(): copy the handle fields under the shard
+  // locks and do the stream formatting unlocked.
+  struct HandleDumpRecord {
+    uint64_t id;
+    int fd;
+    int fd_metadata;
+    int width;
+    int height;
+    int unaligned_width;
+    int unaligned_height;
+    uint64_t size;
+    int flags;
+    uint64_t usage;
+    int format;
+  };
+  std::vector<HandleDumpRecord> records;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> buffer_lock(shard.lock);
+    records.reserve(records.size() + shard.map.size());
+    for (auto it : shard.map) {
+      auto hnd = it.second->handle;
+      records.push_back({hnd->id, hnd->fd, hnd->fd_metadata, hnd->width, hnd->height,
+                         hnd->unaligned_width, hnd->unaligned_height,
+                         static_cast<uint64_t>(hnd->size), hnd->flags, hnd->usage, hnd->format});
+    }
+  }
+
+  for (auto &rec : records) {
+    *os << "handle id: " << std::setw(4) << rec.id;
+    *os << " fd: " << std::setw(3) << rec.fd;
+    *os << " fd_meta: " << std::setw(3) << rec.fd_metadata;
+    *os << " wxh: " << std::setw(4) << rec.width << " x " << std::setw(4) << rec.height;
+    *os << " uwxuh: " << std::setw(4) << rec.unaligned_width << " x ";
+    *os << std::setw(4) << rec.unaligned_height;
+    *os << " size: " << std::setw(9) << rec.size;
     *os << std::hex << std::setfill('0');
     *os << " priv_flags: "
-        << "0x" << std::setw(8) << hnd->flags;
+        << "0x" << std::setw(8) << rec.flags;
     *os << " usage: "
-        << "0x" << std::setw(8) << hnd->usage;
+        << "0x" << std::setw(8) << rec.usage;
     // TODO(user): get format string from qdutils
     *os << " format: "
-        << "0x" << std::setw(8) << hnd->format;
+        << "0x" << std::setw(8) << rec.format;
     *os << std::dec << std::setfill(' ') << std::endl;
   }
   return Error::NONE;
 }
 
-// Get list of private handles in handles_map_
+// Get list of private handles across all shards
 Error BufferManager::GetAllHandles(std::vector<const private_handle_t *> *out_handle_list) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-  if (handles_map_.empty()) {
-    return Error::NO_RESOURCES;
+  for (auto &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.lock);
+    out_handle_list->reserve(out_handle_list->size() + shard.map.size());
+    for (auto handle : shard.map) {
+      out_handle_list->push_back(handle.first);
+    }
   }
-  out_handle_list->reserve(handles_map_.size());
-  for (auto handle : handles_map_) {
-    out_handle_list->push_back(handle.first);
+  if (out_handle_list->empty()) {
+    return Error::NO_RESOURCES;
   }
   return Error::NONE;
 }
 
 Error BufferManager::GetReservedRegion(private_handle_t *handle, void **reserved_region,
                                        uint64_t *reserved_region_size) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
 
@@ -863,7 +1151,7 @@ Error BufferManager::GetReservedRegion(private_handle_t *handle, void **reserved
 Error BufferManager::GetCustomContentMdRegion(private_handle_t *handle,
                                             void **custom_content_md_region,
                                             uint64_t *custom_content_md_region_size) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
 
@@ -880,9 +1168,28 @@ Error BufferManager::GetCustomContentMdRegion(private_handle_t *handle,
   return Error::NONE;
 }
 
+Error BufferManager::GetMetadataNotifyRegion(private_handle_t *handle, void **notify_region) {
+  if (!handle || !notify_region)
+    return Error::BAD_BUFFER;
+
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
+
+  auto buf = GetBufferFromHandleLocked(handle);
+  if (buf == nullptr)
+    return Error::BAD_BUFFER;
+  if (buf->metadata_notify_ptr == nullptr) {
+    // Buffer predates the notification block.
+    return Error::UNSUPPORTED;
+  }
+
+  *notify_region = buf->metadata_notify_ptr;
+
+  return Error::NONE;
+}
+
 Error BufferManager::GetMetadataValue(private_handle_t *handle, int64_t metadatatype_value,
                                       void *param) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
   auto buf = GetBufferFromHandleLocked(handle);
@@ -910,6 +1217,26 @@ Error BufferManager::GetMetadataValue(private_handle_t *handle, int64_t metadata
   }
 }
 
+Error BufferManager::GetMetadataValueBatch(private_handle_t *handle, uint32_t count,
+                                           const int64_t *types, void *const *values,
+                                           Error *statuses) {
+  // Takes the shard lock and resolves the handle once for all requested fields.
+  // QTI_CUSTOM_CONTENT_METADATA lives outside the metadata region and is not batchable;
+  // query it through GetMetadataValue().
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
+  if (!handle)
+    return Error::BAD_BUFFER;
+  auto buf = GetBufferFromHandleLocked(handle);
+  if (buf == nullptr)
+    return Error::BAD_BUFFER;
+
+  if (!handle->base_metadata) {
+    return Error::BAD_BUFFER;
+  }
+
+  return GetMetaDataValueBatch(handle, count, types, values, statuses);
+}
+
 #ifdef QTI_CUSTOM_CONTENT_METADATA
 static Error GetCustomMetadataHelper(void *custom_content_md_region_ptr,
                                      uint64_t custom_content_md_size,
@@ -931,7 +1258,7 @@ static Error GetCustomMetadataHelper(void *custom_content_md_region_ptr,
 
 Error BufferManager::GetMetadata(private_handle_t *handle, int64_t metadatatype_value,
                                  hidl_vec<uint8_t> *out) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
   if (!handle)
     return Error::BAD_BUFFER;
   auto buf = GetBufferFromHandleLocked(handle);
@@ -1463,15 +1790,76 @@ Error BufferManager::GetMetadata(private_handle_t *handle, int64_t metadatatype_
 
 Error BufferManager::SetMetadata(private_handle_t *handle, int64_t metadatatype_value,
                                  hidl_vec<uint8_t> in) {
-  std::lock_guard<std::mutex> lock(buffer_lock_);
-
   if (!handle)
     return Error::BAD_BUFFER;
 
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
+
   auto buf = GetBufferFromHandleLocked(handle);
   if (buf == nullptr)
     return Error::BAD_BUFFER;
 
+  return SetMetadataLocked(buf, handle, metadatatype_value, in);
+}
+
+Error BufferManager::SetMetadataBatch(private_handle_t *handle, uint32_t count,
+                                      const int64_t *types, const hidl_vec<uint8_t> *values,
+                                      Error *statuses) {
+  if (!handle || !types || !values || !statuses) {
+    return Error::BAD_VALUE;
+  }
+
+  // One lock acquisition and one buffer lookup for the whole batch; video
+  // pipelines set several fields back-to-back on every buffer.
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
+
+  auto buf = GetBufferFromHandleLocked(handle);
+  if (buf == nullptr)
+    return Error::BAD_BUFFER;
+
+  Error first_error = Error::NONE;
+  for (uint32_t i = 0; i < count; i++) {
+    statuses[i] = SetMetadataLocked(buf, handle, types[i], values[i]);
+    if (statuses[i] != Error::NONE && first_error == Error::NONE) {
+      first_error = statuses[i];
+    }
+  }
+
+  return first_error;
+}
+
+static MetadataNotifyGroup GetMetadataNotifyGroup(int64_t metadatatype_value) {
+  switch (metadatatype_value) {
+    case (int64_t)StandardMetadataType::DATASPACE:
+    case (int64_t)StandardMetadataType::BLEND_MODE:
+    case (int64_t)StandardMetadataType::SMPTE2086:
+    case (int64_t)StandardMetadataType::CTA861_3:
+    case (int64_t)StandardMetadataType::SMPTE2094_40:
+    case QTI_COLOR_METADATA:
+      return kNotifyGroupColor;
+    case (int64_t)StandardMetadataType::CROP:
+      return kNotifyGroupGeometry;
+    case QTI_VT_TIMESTAMP:
+    case QTI_UBWC_CR_STATS_INFO:
+    case QTI_CVP_METADATA:
+    case QTI_VIDEO_HISTOGRAM_STATS:
+#ifdef QTI_VIDEO_TRANSCODE_STATS
+    case QTI_VIDEO_TRANSCODE_STATS:
+#endif
+#ifdef QTI_VIDEO_TS_INFO
+    case QTI_VIDEO_TS_INFO:
+#endif
+#ifdef QTI_CUSTOM_CONTENT_METADATA
+    case QTI_CUSTOM_CONTENT_METADATA:
+#endif
+      return kNotifyGroupVideo;
+    default:
+      return kNotifyGroupMisc;
+  }
+}
+
+Error BufferManager::SetMetadataLocked(std::shared_ptr<Buffer> buf, private_handle_t *handle,
+                                       int64_t metadatatype_value, const hidl_vec<uint8_t> &in) {
   if (!handle->base_metadata) {
     return Error::BAD_BUFFER;
   }
@@ -1772,6 +2160,48 @@ Error BufferManager::SetMetadata(private_handle_t *handle, int64_t metadatatype_
   }
 #endif
 
+  // Track which fields changed since the last dirty-mask query.
+  if (IS_VENDOR_METADATA_TYPE(metadatatype_value)) {
+    uint64_t index = static_cast<uint64_t>(GET_VENDOR_METADATA_STATUS_INDEX(metadatatype_value));
+    if (index < 64) {
+      buf->vendor_dirty_mask |= (1ULL << index);
+    }
+  } else {
+    uint64_t index = static_cast<uint64_t>(GET_STANDARD_METADATA_STATUS_INDEX(metadatatype_value));
+    if (index < 64) {
+      buf->standard_dirty_mask |= (1ULL << index);
+    }
+  }
+
+  // Publish the change to cross-process watchers: bump the field group generation and the
+  // futex word, then wake anyone waiting on it.
+  if (buf->metadata_notify_ptr) {
+    MetadataNotifySignal(reinterpret_cast<MetadataNotify *>(buf->metadata_notify_ptr),
+                         GetMetadataNotifyGroup(metadatatype_value));
+  }
+
+  return Error::NONE;
+}
+
+Error BufferManager::GetMetadataDirtyMask(private_handle_t *handle, bool clear,
+                                          uint64_t *standard_mask, uint64_t *vendor_mask) {
+  if (!handle || !standard_mask || !vendor_mask) {
+    return Error::BAD_VALUE;
+  }
+
+  std::lock_guard<std::mutex> lock(GetShard(handle).lock);
+
+  auto buf = GetBufferFromHandleLocked(handle);
+  if (buf == nullptr)
+    return Error::BAD_BUFFER;
+
+  *standard_mask = buf->standard_dirty_mask;
+  *vendor_mask = buf->vendor_dirty_mask;
+  if (clear) {
+    buf->standard_dirty_mask = 0;
+    buf->vendor_dirty_mask = 0;
+  }
+
   return Error::NONE;
 }
 
@@ -38,15 +38,28 @@
 
 namespace gralloc {
 using gralloc::Error;
+
+// CPU access region a client declared at lock() time, in pixels of the unaligned frame.
+// A non-positive width or height means the whole buffer.
+struct BufferAccessRegion {
+  int32_t left = 0;
+  int32_t top = 0;
+  int32_t width = -1;
+  int32_t height = -1;
+};
+
 class BufferManager {
  public:
   ~BufferManager();
 
   Error AllocateBuffer(const BufferDescriptor &descriptor, buffer_handle_t *handle,
                        unsigned int bufferSize = 0, bool testAlloc = false);
+  Error AllocateBuffers(const BufferDescriptor &descriptor, uint32_t count,
+                        std::vector<buffer_handle_t> *handles);
   Error RetainBuffer(private_handle_t const *hnd);
   Error ReleaseBuffer(private_handle_t const *hnd);
   Error LockBuffer(const private_handle_t *hnd, uint64_t usage);
+  Error LockBuffer(const private_handle_t *hnd, uint64_t usage, const BufferAccessRegion &region);
   Error UnlockBuffer(const private_handle_t *hnd);
   Error Dump(std::ostringstream *os);
   void BuffersDump();
@@ -56,20 +69,59 @@ class BufferManager {
   void SetGrallocDebugProperties(gralloc::GrallocProperties props);
   Error GetMetadata(private_handle_t *handle, int64_t metadatatype_value, hidl_vec<uint8_t> *out);
   Error SetMetadata(private_handle_t *handle, int64_t metadatatype_value, hidl_vec<uint8_t> in);
+  Error SetMetadataBatch(private_handle_t *handle, uint32_t count, const int64_t *types,
+                         const hidl_vec<uint8_t> *values, Error *statuses);
+  Error GetMetadataDirtyMask(private_handle_t *handle, bool clear, uint64_t *standard_mask,
+                             uint64_t *vendor_mask);
   Error GetReservedRegion(private_handle_t *handle, void **reserved_region,
                           uint64_t *reserved_region_size);
   Error GetCustomContentMdRegion(private_handle_t *handle, void **custom_content_md_region,
                        uint64_t *custom_content_md_region_size);
+  Error GetMetadataNotifyRegion(private_handle_t *handle, void **notify_region);
   Error FlushBuffer(const private_handle_t *handle);
   Error RereadBuffer(const private_handle_t *handle);
   Error GetAllHandles(std::vector<const private_handle_t *> *out_handle_list);
   int GetCustomDimensions(private_handle_t *handle, int *stride, int *height);
   Error GetMetadataValue(private_handle_t *handle, int64_t metadatatype_value, void *out);
+  Error GetMetadataValueBatch(private_handle_t *handle, uint32_t count, const int64_t *types,
+                              void *const *values, Error *statuses);
 
  private:
   BufferManager();
   Error MapBuffer(private_handle_t const *hnd);
 
+  // Descriptor-derived allocation parameters, computed once per descriptor so that batched
+  // allocations do not repeat format resolution and size queries for every buffer.
+  struct AllocationLayout {
+    unsigned int size = 0;
+    unsigned int alignedw = 0;
+    unsigned int alignedh = 0;
+    int format = 0;
+    int buffer_type = 0;
+    uint32_t layer_count = 0;
+    uint64_t usage = 0;
+    uint64_t custom_content_md_reserved_size = 0;
+    GraphicsMetadata graphics_metadata = {};
+  };
+
+  // Interned layouts: camera and codec sessions allocate thousands of buffers from a handful
+  // of descriptor shapes, so completed layouts are kept in a small direct-mapped cache keyed
+  // by descriptor content and reused across allocation calls.
+  struct LayoutCacheEntry {
+    bool valid = false;
+    int format = 0;  // raw descriptor format, before usage-based resolution
+    int width = 0;
+    int height = 0;
+    uint32_t layer_count = 0;
+    uint64_t usage = 0;
+    AllocationLayout layout;
+  };
+  static const uint32_t kLayoutCacheEntries = 8;
+
+  Error ComputeAllocationLayout(const BufferDescriptor &descriptor, AllocationLayout *layout);
+  Error AllocateBufferFromLayout(const BufferDescriptor &descriptor, const AllocationLayout &layout,
+                                 buffer_handle_t *handle);
+
   // Imports the ion fds into the current process. Returns an error for invalid handles
   Error ImportHandleLocked(private_handle_t *hnd);
 
@@ -99,15 +151,58 @@ class BufferManager {
     void *reserved_region_ptr = nullptr;
     uint64_t custom_content_md_size = 0;
     void *custom_content_md_region_ptr = nullptr;
+    // Shared change-notification block (futex word + group generations); nullptr when the
+    // buffer predates the block.
+    void *metadata_notify_ptr = nullptr;
+    // Fields written since the last GetMetadataDirtyMask() query, indexed by
+    // metadata status index. Lets readers skip re-decoding unchanged fields.
+    uint64_t standard_dirty_mask = 0;
+    uint64_t vendor_dirty_mask = 0;
+    // CPU access region declared at lock() time. Cache maintenance until the matching
+    // unlock() is restricted to the scanlines this region touches.
+    BufferAccessRegion lock_region = {};
   };
 
   Error FreeBuffer(std::shared_ptr<Buffer> buf);
 
   // Get the wrapper Buffer object from the handle, returns nullptr if handle is not found
   std::shared_ptr<Buffer> GetBufferFromHandleLocked(const private_handle_t *hnd);
+
+  // Cache maintenance over the buffer's recorded lock region; caller holds the handle's shard
+  // lock. Issues one ranged sync per plane span, or a full-buffer sync when no byte range can
+  // be derived for the layout.
+  int CleanBufferRegion(const std::shared_ptr<Buffer> &buf, const private_handle_t *hnd, int op);
+
+  // Core of SetMetadata; caller holds the handle's shard lock.
+  Error SetMetadataLocked(std::shared_ptr<Buffer> buf, private_handle_t *handle,
+                          int64_t metadatatype_value, const hidl_vec<uint8_t> &in);
+
+  // Handle table is sharded by handle address so that import/release/metadata traffic on
+  // independent buffers does not serialize behind a single lock.
+  static const uint32_t kHandleShardCount = 16;  // must be a power of two
+
+  // Upper bound on the short-lived workers AllocateBuffers() fans a burst out over.
+  static const uint32_t kAllocWorkerCount = 4;
+
+  struct HandleShard {
+    std::mutex lock;
+    std::unordered_map<const private_handle_t *, std::shared_ptr<Buffer>> map = {};
+  };
+
+  HandleShard &GetShard(const private_handle_t *hnd) {
+    // Drop the low bits which are constant due to allocator alignment.
+    uint64_t key = reinterpret_cast<uint64_t>(hnd) >> 4;
+    return shards_[key & (kHandleShardCount - 1)];
+  }
+
+  void AccountAllocation(uint64_t size);
+  void AccountRelease(uint64_t size);
+
   Allocator *allocator_ = NULL;
-  std::mutex buffer_lock_;
-  std::unordered_map<const private_handle_t *, std::shared_ptr<Buffer>> handles_map_ = {};
+  HandleShard shards_[kHandleShardCount];
+  LayoutCacheEntry layout_cache_[kLayoutCacheEntries];
+  std::mutex layout_cache_lock_;
+  std::mutex alloc_stats_lock_;  // protects allocated_ and kAllocThreshold
   std::atomic<uint64_t> next_id_;
   uint64_t allocated_ = 0;
   uint64_t kAllocThreshold = (uint64_t)1*1024*1024*1024;
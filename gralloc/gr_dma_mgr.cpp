@@ -33,6 +33,7 @@
 #include <sys/mman.h>
 
 #include <linux/dma-buf.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include <log/log.h>
@@ -41,6 +42,8 @@
 #include <errno.h>
 #include <utils/Trace.h>
 #include <dlfcn.h>
+#include <unistd.h>
+#include <algorithm>
 #include <string>
 #include <utility>
 #include <vector>
@@ -79,6 +82,11 @@ DmaManager *DmaManager::GetInstance() {
     dma_manager_->enable_logs_ = property_get_bool(ENABLE_LOGS_PROP, 0);
     dma_manager_->GetUncachedHeapUsage();
     dma_manager_->GetCameraPreviewPerms();
+    int pool_max_mb = property_get_int32(DMA_BUF_POOL_MAX_MB_PROP, 0);
+    if (pool_max_mb > 0) {
+      dma_manager_->buffer_pool_max_bytes_ = UINT(pool_max_mb) * 1024 * 1024;
+      ALOGI("dma-buf recycling pool enabled, cap %d MB", pool_max_mb);
+    }
   }
   return dma_manager_;
 }
@@ -128,6 +136,7 @@ void DmaManager::DeinitMemUtils() {
 }
 
 void DmaManager::Deinit() {
+  TrimBufferPool();
   DeinitMemUtils();
   if (dma_dev_fd_ > FD_INIT) {
     close(dma_dev_fd_);
@@ -136,6 +145,46 @@ void DmaManager::Deinit() {
   dma_dev_fd_ = FD_INIT;
 }
 
+std::string DmaManager::BufferPoolKey(const AllocData &data) {
+  return data.heap_name + ":" + std::to_string(data.size) + ":" + std::to_string(data.flags) +
+         ":" + std::to_string(data.align);
+}
+
+bool DmaManager::IsSoleOwner(int fd) {
+  char path[64] = {};
+  snprintf(path, sizeof(path), "/proc/self/fdinfo/%d", fd);
+  FILE *fdinfo = fopen(path, "r");
+  if (!fdinfo) {
+    return false;
+  }
+
+  char line[128] = {};
+  long count = -1;
+  while (fgets(line, sizeof(line), fdinfo)) {
+    if (sscanf(line, "count: %ld", &count) == 1) {
+      break;
+    }
+  }
+  fclose(fdinfo);
+  return count == 1;
+}
+
+void DmaManager::ForgetPoolOrigin(int fd) {
+  std::lock_guard<std::mutex> lock(buffer_pool_lock_);
+  buffer_pool_origin_.erase(fd);
+}
+
+void DmaManager::TrimBufferPool() {
+  std::lock_guard<std::mutex> lock(buffer_pool_lock_);
+  for (auto &bucket : buffer_pool_) {
+    for (int pooled_fd : bucket.second) {
+      close(pooled_fd);
+    }
+  }
+  buffer_pool_.clear();
+  buffer_pool_bytes_ = 0;
+}
+
 int DmaManager::AllocBuffer(AllocData *data) {
   ATRACE_CALL();
   unsigned int flags = data->flags;
@@ -145,9 +194,32 @@ int DmaManager::AllocBuffer(AllocData *data) {
     tag_name = "libdma alloc size: " + std::to_string(data->size);
   }
 
+  // Reallocation of a recently freed identical descriptor is a freelist pop.
+  if (buffer_pool_max_bytes_ && data->vm_names.empty()) {
+    std::lock_guard<std::mutex> lock(buffer_pool_lock_);
+    auto bucket = buffer_pool_.find(BufferPoolKey(*data));
+    if (bucket != buffer_pool_.end() && !bucket->second.empty()) {
+      data->fd = bucket->second.back();
+      bucket->second.pop_back();
+      data->ion_handle = data->fd;
+      buffer_pool_bytes_ -= data->size;
+      buffer_pool_origin_[data->fd] = std::make_pair(bucket->first, data->size);
+      ALOGD_IF(enable_logs_, "libdma: Recycled buffer size:%u fd:%d", data->size, data->fd);
+      return 0;
+    }
+  }
+
   ATRACE_BEGIN("GrallocAllocation");
   dma_dev_fd_ = buffer_allocator_.Alloc(data->heap_name, data->size, flags, data->align);
   ATRACE_END();
+  if (dma_dev_fd_ < 0 && buffer_pool_bytes_) {
+    // Allocation failure is the memory-pressure signal; give the pooled buffers back to
+    // the kernel and retry once.
+    TrimBufferPool();
+    ATRACE_BEGIN("GrallocAllocation");
+    dma_dev_fd_ = buffer_allocator_.Alloc(data->heap_name, data->size, flags, data->align);
+    ATRACE_END();
+  }
   if (dma_dev_fd_ < 0) {
     ALOGE("libdma alloc failed ion_fd %d size %d align %d heap_name %s flags %x", dma_dev_fd_,
           data->size, data->align, data->heap_name.c_str(), flags);
@@ -156,6 +228,10 @@ int DmaManager::AllocBuffer(AllocData *data) {
 
   data->fd = dma_dev_fd_;
   data->ion_handle = dma_dev_fd_;
+  if (buffer_pool_max_bytes_ && data->vm_names.empty()) {
+    std::lock_guard<std::mutex> lock(buffer_pool_lock_);
+    buffer_pool_origin_[data->fd] = std::make_pair(BufferPoolKey(*data), data->size);
+  }
   ALOGD_IF(enable_logs_, "libdma: Allocated buffer size:%u fd:%d", data->size, data->fd);
 
   return 0;
@@ -171,6 +247,26 @@ int DmaManager::FreeBuffer(void *base, unsigned int size, unsigned int offset, i
     err = UnmapBuffer(base, size, offset);
   }
 
+  if (buffer_pool_max_bytes_) {
+    std::lock_guard<std::mutex> lock(buffer_pool_lock_);
+    auto origin = buffer_pool_origin_.find(fd);
+    if (origin != buffer_pool_origin_.end()) {
+      std::string key = origin->second.first;
+      unsigned int alloc_size = origin->second.second;
+      buffer_pool_origin_.erase(origin);
+      // Pool only when this fd is the last reference anywhere to the dma-buf (fdinfo
+      // count of one), so a recycled fd can never alias a buffer some other process
+      // still holds or maps.
+      if (alloc_size == size && buffer_pool_bytes_ + size <= buffer_pool_max_bytes_ &&
+          IsSoleOwner(fd)) {
+        buffer_pool_[key].push_back(fd);
+        buffer_pool_bytes_ += size;
+        ALOGD_IF(enable_logs_, "libdma: Pooled buffer size:%u fd:%d", size, fd);
+        return err;
+      }
+    }
+  }
+
   close(fd);
   return err;
 }
@@ -179,28 +275,37 @@ int DmaManager::ImportBuffer(int fd) {
   return fd;
 }
 
-int DmaManager::CleanBuffer(void * /*base*/, unsigned int /*size*/, unsigned int /*offset*/,
-                            int /*handle*/, int op, int dma_buf_fd) {
-  ATRACE_CALL();
-  ATRACE_INT("operation id", op);
-
-  struct dma_buf_sync sync;
-  int err = 0;
-
+static int GetSyncFlags(int op, uint64_t *flags) {
   switch (op) {
     case CACHE_CLEAN:
-      sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW;
+      *flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_RW;
       break;
     case CACHE_INVALIDATE:
-      sync.flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW;
+      *flags = DMA_BUF_SYNC_START | DMA_BUF_SYNC_RW;
       break;
     case CACHE_READ_DONE:
-      sync.flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
+      *flags = DMA_BUF_SYNC_END | DMA_BUF_SYNC_READ;
       break;
     default:
       ALOGE("%s: Invalid operation %d", __FUNCTION__, op);
       return -1;
   }
+  return 0;
+}
+
+int DmaManager::CleanBuffer(void * /*base*/, unsigned int /*size*/, unsigned int /*offset*/,
+                            int /*handle*/, int op, int dma_buf_fd) {
+  ATRACE_CALL();
+  ATRACE_INT("operation id", op);
+
+  struct dma_buf_sync sync;
+  int err = 0;
+  uint64_t flags = 0;
+
+  if (GetSyncFlags(op, &flags)) {
+    return -1;
+  }
+  sync.flags = flags;
 
   if (ioctl(dma_buf_fd, INT(DMA_BUF_IOCTL_SYNC), &sync)) {
     err = -errno;
@@ -211,6 +316,51 @@ int DmaManager::CleanBuffer(void * /*base*/, unsigned int /*size*/, unsigned int
   return 0;
 }
 
+int DmaManager::CleanBufferRange(void *base, unsigned int size, unsigned int offset,
+                                 unsigned int range_offset, unsigned int range_length, int handle,
+                                 int op, int dma_buf_fd) {
+#ifdef DMA_BUF_IOCTL_SYNC_PARTIAL
+  ATRACE_CALL();
+  ATRACE_INT("operation id", op);
+
+  if (range_length == 0 || range_offset >= size || range_length > size - range_offset) {
+    return CleanBuffer(base, size, offset, handle, op, dma_buf_fd);
+  }
+
+  uint64_t flags = 0;
+  if (GetSyncFlags(op, &flags)) {
+    return -1;
+  }
+
+  // The partial sync ioctl works at page granularity; widen the span to page bounds so the
+  // kernel never rejects an unaligned request.
+  unsigned int page_mask = UINT(getpagesize()) - 1;
+  unsigned int start = range_offset & ~page_mask;
+  unsigned int end = std::min(size, (range_offset + range_length + page_mask) & ~page_mask);
+
+  struct dma_buf_sync_partial sync = {};
+  sync.flags = flags;
+  sync.offset = start;
+  sync.len = end - start;
+
+  if (ioctl(dma_buf_fd, INT(DMA_BUF_IOCTL_SYNC_PARTIAL), &sync)) {
+    // Kernels predating the partial sync ioctl reject it; sync the whole buffer instead.
+    if (errno == ENOTTY || errno == EINVAL) {
+      return CleanBuffer(base, size, offset, handle, op, dma_buf_fd);
+    }
+    int err = -errno;
+    ALOGE("%s: DMA_BUF_IOCTL_SYNC_PARTIAL failed with error - %s", __FUNCTION__, strerror(errno));
+    return err;
+  }
+
+  return 0;
+#else
+  (void)range_offset;
+  (void)range_length;
+  return CleanBuffer(base, size, offset, handle, op, dma_buf_fd);
+#endif
+}
+
 int DmaManager::MapBuffer(void **base, unsigned int size, unsigned int offset, int fd) {
   ATRACE_CALL();
   int err = 0;
@@ -414,6 +564,10 @@ int DmaManager::SetBufferPermission(int fd, BufferPermission *buf_perm, int64_t
     return 0;
   }
 
+  // Once a buffer is lent to another VM its contents and state are no longer plain heap
+  // memory; never recycle it.
+  ForgetPoolOrigin(fd);
+
   InitMemUtils();
   if (!mem_buf_) {
     return -EINVAL;
@@ -38,7 +38,10 @@
 #include <linux/qti-smmu-proxy.h>
 #endif
 
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include <bitset>
 
@@ -67,6 +70,9 @@ class DmaManager : public AllocInterface {
   virtual int ImportBuffer(int fd);
   virtual int CleanBuffer(void *base, unsigned int size, unsigned int offset, int handle, int op,
                           int fd);
+  virtual int CleanBufferRange(void *base, unsigned int size, unsigned int offset,
+                               unsigned int range_offset, unsigned int range_length, int handle,
+                               int op, int fd);
   virtual int SecureMemPerms(AllocData *data);
   virtual void GetHeapInfo(uint64_t usage, bool sensor_flag, int format, bool use_uncached,
                            std::string *heap_name, std::vector<std::string> *vm_names,
@@ -84,6 +90,10 @@ class DmaManager : public AllocInterface {
   void InitMemUtils();
   void DeinitMemUtils();
   void Deinit();
+  std::string BufferPoolKey(const AllocData &data);
+  bool IsSoleOwner(int fd);
+  void ForgetPoolOrigin(int fd);
+  void TrimBufferPool();
 
   int dma_dev_fd_ = FD_INIT;
   BufferAllocator buffer_allocator_;
@@ -108,6 +118,16 @@ class DmaManager : public AllocInterface {
 
   void* libvmmemPointer;
   std::unique_ptr<VmMem> (*createVmMem)();
+
+  // Recycling pool of recently freed dma-buf fds, bucketed by allocation descriptor.
+  // buffer_pool_origin_ remembers the bucket and size an fd was allocated with so
+  // FreeBuffer() can return it without re-deriving heap name and flags. Enabled by
+  // setting DMA_BUF_POOL_MAX_MB_PROP to a non-zero cap; guarded by buffer_pool_lock_.
+  std::mutex buffer_pool_lock_;
+  std::map<std::string, std::vector<int>> buffer_pool_;
+  std::map<int, std::pair<std::string, unsigned int>> buffer_pool_origin_;
+  unsigned int buffer_pool_bytes_ = 0;
+  unsigned int buffer_pool_max_bytes_ = 0;
 };
 
 }  // namespace gralloc
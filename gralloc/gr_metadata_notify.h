@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __GR_METADATA_NOTIFY_H__
+#define __GR_METADATA_NOTIFY_H__
+
+#include <QtiGrallocPriv.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+
+namespace gralloc {
+
+/*
+ * Change-notification block placed in the shared metadata allocation, after the client
+ * reserved region and the custom content metadata region. SetMetadata bumps the matching
+ * group generation and the futex word, then wakes waiters, so same-device consumers can
+ * watch for metadata changes (e.g. HDR dynamic metadata per frame) without a binder round
+ * trip per query. Both sides locate the block from handle fields, so the layout below is
+ * shared ABI across processes; bump kMetadataNotifyVersion on any change.
+ */
+
+enum MetadataNotifyGroup {
+  kNotifyGroupColor = 0,  // dataspace, color/HDR static and dynamic metadata, blend mode
+  kNotifyGroupGeometry,   // crop and buffer geometry
+  kNotifyGroupVideo,      // video stats, timestamps, CVP and custom content metadata
+  kNotifyGroupMisc,       // everything else
+  kNotifyGroupMax,
+};
+
+const uint32_t kMetadataNotifyMagic = 0x4E4D4453;  // "SDMN"
+const uint32_t kMetadataNotifyVersion = 1;
+
+struct MetadataNotify {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t futex_word;  // incremented on every metadata write; futex wait/wake target
+  uint32_t reserved;
+  uint32_t group_generation[kNotifyGroupMax];  // incremented per affected field group
+};
+
+/*
+ * Offset math mirrors GetMetaDataSize(): the reserved region only exists outside MetaData_t
+ * when METADATA_V2 is in use.
+ */
+inline MetadataNotify *GetMetadataNotify(uintptr_t base_metadata, uint64_t reserved_size,
+                                         uint64_t custom_content_md_size) {
+  if (!base_metadata) {
+    return nullptr;
+  }
+#ifndef METADATA_V2
+  reserved_size = 0;
+#endif
+  return reinterpret_cast<MetadataNotify *>(base_metadata + sizeof(MetaData_t) + reserved_size +
+                                            custom_content_md_size);
+}
+
+inline void MetadataNotifyInit(MetadataNotify *notify) {
+  notify->futex_word = 0;
+  notify->reserved = 0;
+  for (uint32_t i = 0; i < kNotifyGroupMax; i++) {
+    notify->group_generation[i] = 0;
+  }
+  notify->version = kMetadataNotifyVersion;
+  __atomic_store_n(&notify->magic, kMetadataNotifyMagic, __ATOMIC_RELEASE);
+}
+
+/* Buffers allocated before this block existed carry whatever the allocator zeroed. */
+inline bool MetadataNotifyValid(const MetadataNotify *notify) {
+  return notify && __atomic_load_n(&notify->magic, __ATOMIC_ACQUIRE) == kMetadataNotifyMagic &&
+         notify->version == kMetadataNotifyVersion;
+}
+
+inline void MetadataNotifySignal(MetadataNotify *notify, MetadataNotifyGroup group) {
+  __atomic_add_fetch(&notify->group_generation[group], 1, __ATOMIC_RELEASE);
+  __atomic_add_fetch(&notify->futex_word, 1, __ATOMIC_RELEASE);
+  // Shared (non-private) futex: waiters may sit in another process.
+  syscall(SYS_futex, &notify->futex_word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+inline uint32_t MetadataNotifyRead(const MetadataNotify *notify) {
+  return __atomic_load_n(&notify->futex_word, __ATOMIC_ACQUIRE);
+}
+
+inline uint32_t MetadataNotifyGroupGeneration(const MetadataNotify *notify,
+                                              MetadataNotifyGroup group) {
+  return __atomic_load_n(&notify->group_generation[group], __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Blocks until the futex word moves past last_seen or the (relative) timeout expires.
+ * Returns 0 when a change is visible, -ETIMEDOUT on timeout, -errno otherwise.
+ * Pass nullptr to wait indefinitely.
+ */
+inline int MetadataNotifyWait(MetadataNotify *notify, uint32_t last_seen,
+                              const struct timespec *timeout) {
+  while (MetadataNotifyRead(notify) == last_seen) {
+    if (syscall(SYS_futex, &notify->futex_word, FUTEX_WAIT, last_seen, timeout, nullptr, 0) < 0) {
+      if (errno == EAGAIN || errno == EINTR) {
+        continue;  // word already moved, or spurious wakeup; re-check
+      }
+      return -errno;
+    }
+  }
+  return 0;
+}
+
+}  // namespace gralloc
+
+#endif  // __GR_METADATA_NOTIFY_H__
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+#ifndef __GR_SHARED_LAYOUT_H__
+#define __GR_SHARED_LAYOUT_H__
+
+#include <stdint.h>
+
+#include "gr_metadata_notify.h"
+#include "gr_utils.h"
+
+namespace gralloc {
+
+/*
+ * Derived plane layout published by the allocating process into the shared metadata
+ * allocation, right after the change-notification block. A buffer shared between camera,
+ * codec and composer is imported once per process, and each process used to re-derive the
+ * same plane geometry (including Adreno layout queries for GPU formats) on every layout
+ * request. Every importer already maps the metadata allocation, so consumers now resolve
+ * plane geometry with a read from the shared page and only fall back to the compute path
+ * for buffers that predate the block or whose publication failed.
+ *
+ * The layout is derived from handle fields that are fixed at allocation time, so the
+ * published block never goes stale. Paths that derive geometry from mutable metadata
+ * (crop, linear-format and interlaced overrides) keep computing. Both sides locate the
+ * block from handle fields, so the structures below are shared ABI across processes;
+ * bump kSharedLayoutVersion on any change.
+ */
+
+const uint32_t kSharedLayoutMagic = 0x4C4D4453;  // "SDML"
+const uint32_t kSharedLayoutVersion = 1;
+const int32_t kSharedLayoutMaxPlanes = 8;
+
+// Fixed-width mirror of PlaneLayoutInfo; PlaneLayoutInfo itself is not ABI stable.
+struct SharedPlaneInfo {
+  uint32_t component;
+  uint32_t h_subsampling;
+  uint32_t v_subsampling;
+  uint32_t offset;
+  int32_t step;
+  int32_t stride;
+  int32_t stride_bytes;
+  int32_t scanlines;
+  uint32_t size;
+};
+
+struct SharedBufferLayout {
+  uint32_t magic;
+  uint32_t version;
+  int32_t plane_count;  // 0 until the allocator publishes
+  uint32_t reserved;
+  SharedPlaneInfo planes[kSharedLayoutMaxPlanes];
+};
+
+inline SharedBufferLayout *GetSharedBufferLayout(uintptr_t base_metadata, uint64_t reserved_size,
+                                                 uint64_t custom_content_md_size) {
+  MetadataNotify *notify =
+      GetMetadataNotify(base_metadata, reserved_size, custom_content_md_size);
+  if (!notify) {
+    return nullptr;
+  }
+  return reinterpret_cast<SharedBufferLayout *>(reinterpret_cast<uintptr_t>(notify) +
+                                                sizeof(MetadataNotify));
+}
+
+inline void SharedBufferLayoutInit(SharedBufferLayout *layout) {
+  layout->plane_count = 0;
+  layout->reserved = 0;
+  layout->version = kSharedLayoutVersion;
+  __atomic_store_n(&layout->magic, kSharedLayoutMagic, __ATOMIC_RELEASE);
+}
+
+/* Buffers allocated before this block existed carry whatever the allocator zeroed. */
+inline bool SharedBufferLayoutValid(const SharedBufferLayout *layout) {
+  return layout && __atomic_load_n(&layout->magic, __ATOMIC_ACQUIRE) == kSharedLayoutMagic &&
+         layout->version == kSharedLayoutVersion;
+}
+
+inline void SharedBufferLayoutPublish(SharedBufferLayout *layout,
+                                      const PlaneLayoutInfo plane_info[], int plane_count) {
+  if (plane_count <= 0 || plane_count > kSharedLayoutMaxPlanes) {
+    return;
+  }
+  for (int i = 0; i < plane_count; i++) {
+    layout->planes[i].component = static_cast<uint32_t>(plane_info[i].component);
+    layout->planes[i].h_subsampling = plane_info[i].h_subsampling;
+    layout->planes[i].v_subsampling = plane_info[i].v_subsampling;
+    layout->planes[i].offset = plane_info[i].offset;
+    layout->planes[i].step = plane_info[i].step;
+    layout->planes[i].stride = plane_info[i].stride;
+    layout->planes[i].stride_bytes = plane_info[i].stride_bytes;
+    layout->planes[i].scanlines = plane_info[i].scanlines;
+    layout->planes[i].size = plane_info[i].size;
+  }
+  // The count is the consumer-visible commit point for the plane entries above.
+  __atomic_store_n(&layout->plane_count, plane_count, __ATOMIC_RELEASE);
+}
+
+/* Returns the published plane count, or 0 when nothing usable was published. */
+inline int SharedBufferLayoutRead(const SharedBufferLayout *layout,
+                                  PlaneLayoutInfo plane_info[]) {
+  int plane_count = __atomic_load_n(&layout->plane_count, __ATOMIC_ACQUIRE);
+  if (plane_count <= 0 || plane_count > kSharedLayoutMaxPlanes) {
+    return 0;
+  }
+  for (int i = 0; i < plane_count; i++) {
+    plane_info[i].component = static_cast<PlaneComponent>(layout->planes[i].component);
+    plane_info[i].h_subsampling = layout->planes[i].h_subsampling;
+    plane_info[i].v_subsampling = layout->planes[i].v_subsampling;
+    plane_info[i].offset = layout->planes[i].offset;
+    plane_info[i].step = layout->planes[i].step;
+    plane_info[i].stride = layout->planes[i].stride;
+    plane_info[i].stride_bytes = layout->planes[i].stride_bytes;
+    plane_info[i].scanlines = layout->planes[i].scanlines;
+    plane_info[i].size = layout->planes[i].size;
+  }
+  return plane_count;
+}
+
+}  // namespace gralloc
+
+#endif  // __GR_SHARED_LAYOUT_H__
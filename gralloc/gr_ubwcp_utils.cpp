@@ -48,6 +48,9 @@ UbwcpUtils::UbwcpUtils() {
 
 UbwcpUtils::~UbwcpUtils() {
   if (libUbwcpUtils_) {
+    if (session_) {
+      LINK_UBWCPLib_destroy_session(session_);
+    }
     ::dlclose(libUbwcpUtils_);
   }
 }
@@ -69,20 +72,38 @@ UBWCPLib_Image_Format UbwcpUtils::GetUbwcpPixelFormat(int hal_format) {
   return UBWCPLib_NUM_FORMATS;
 }
 
+void *UbwcpUtils::GetSession() {
+  // Caller holds session_lock_. One session serves the whole process; creating
+  // and destroying one per allocation was pure overhead during buffer storms.
+  if (!session_ && libUbwcpUtils_) {
+    session_ = LINK_UBWCPLib_create_session();
+    if (!session_) {
+      ALOGW("Unable to create UBWCPLib session\n");
+    }
+  }
+  return session_;
+}
+
 bool UbwcpUtils::IsStrideAligned(int hal_format, int width) {
-  UBWCPLib_Image_Format ubwcp_format = GetUbwcpPixelFormat(hal_format);
-  size_t stride_req;
-  void *session;
+  size_t stride_req = 0;
   int ret = false;
 
-  session = LINK_UBWCPLib_create_session();
-  if (!session) {
-    ALOGW("Unable to create UBWCPLib session\n");
-    return ret;
+  {
+    lock_guard<mutex> obj(session_lock_);
+    auto it = stride_alignment_cache_.find(hal_format);
+    if (it != stride_alignment_cache_.end()) {
+      stride_req = it->second;
+    } else {
+      void *session = GetSession();
+      if (!session) {
+        return ret;
+      }
+      UBWCPLib_Image_Format ubwcp_format = GetUbwcpPixelFormat(hal_format);
+      LINK_UBWCPLib_get_stride_alignment(session, ubwcp_format, &stride_req);
+      stride_alignment_cache_[hal_format] = stride_req;
+    }
   }
 
-  LINK_UBWCPLib_get_stride_alignment(session, ubwcp_format, &stride_req);
-
   // if width is aligned to stride_req
   if (ALIGN(width, stride_req))
     ret = true;
@@ -92,12 +113,78 @@ bool UbwcpUtils::IsStrideAligned(int hal_format, int width) {
     ret = false;
   }
 
-  LINK_UBWCPLib_destroy_session(session);
   return ret;
 }
 
+bool UbwcpUtils::GetCachedLayout(const BufferInfo &info, int32_t format, int flags,
+                                 const private_handle_t *handle, UbwcpLayout *layout) {
+  std::tuple<int32_t, int32_t, int32_t, int> key(format, info.width, info.height, flags);
+  {
+    lock_guard<mutex> obj(layout_lock_);
+    auto it = layout_cache_.find(key);
+    if (it != layout_cache_.end()) {
+      *layout = it->second;
+      return true;
+    }
+  }
+
+  int plane_count = 0;
+  gralloc::PlaneLayoutInfo plane_layout[8] = {};
+  if (gralloc::IsYuvFormat(format)) {
+    gralloc::GetYUVPlaneInfo(info, format, info.width, info.height, flags, &plane_count,
+                             plane_layout, handle);
+    if (format == HAL_PIXEL_FORMAT_YCbCr_420_TP10_UBWC) {
+      layout->planar_padding =
+          plane_layout[3].offset - plane_layout[0].offset - plane_layout[0].size;
+    } else {
+      layout->planar_padding =
+          plane_layout[1].offset - plane_layout[0].offset - plane_layout[0].size;
+    }
+    layout->linear_size = plane_layout[0].size + plane_layout[1].size;
+  } else {
+    gralloc::GetRGBPlaneInfo(info, format, info.width, info.height, flags, &plane_count,
+                             plane_layout);
+    layout->planar_padding = 0;
+    layout->linear_size = plane_layout[0].size;
+  }
+
+  if (!plane_count) {
+    return false;
+  }
+
+  layout->stride_bytes = plane_layout[0].stride_bytes;
+  layout->scanlines = plane_layout[0].scanlines;
+
+  lock_guard<mutex> obj(layout_lock_);
+  layout_cache_[key] = *layout;
+  return true;
+}
+
 #endif
 
+uint32_t UbwcpUtils::GetUbwcpLayouts(uint32_t count, const BufferInfo *infos,
+                                     UbwcpLayout *layouts) {
+  uint32_t resolved = 0;
+#ifdef TARGET_USES_UBWCP
+  if (!infos || !layouts) {
+    return 0;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    layouts[i] = {};
+    const BufferInfo &info = infos[i];
+    if (!IsUBwcPEnabled(info.format, info.usage)) {
+      continue;
+    }
+    BufferInfo linear_info(info.width, info.height, info.format,
+                           info.usage | GRALLOC_USAGE_PRIVATE_NO_UBWC_P);
+    if (GetCachedLayout(linear_info, info.format, 0 /* flags */, nullptr, &layouts[i])) {
+      resolved++;
+    }
+  }
+#endif
+  return resolved;
+}
+
 void UbwcpUtils::ConfigUBWCPAttributes(private_handle_t const *handle) {
 #ifdef TARGET_USES_UBWCP
   private_handle_t *hnd = const_cast<private_handle_t *>(handle);
@@ -106,56 +193,37 @@ void UbwcpUtils::ConfigUBWCPAttributes(private_handle_t const *handle) {
                   hnd->usage | GRALLOC_USAGE_PRIVATE_NO_UBWC_P);
 
   if (IsUBwcPEnabled(hnd->format, hnd->usage)) {
-    void *session;
     hnd->ubwcp_format = true;
-    size_t planar_padding;
 
-    session = LINK_UBWCPLib_create_session();
-    if (!session) {
-      ALOGW("Unable to create UBWCPLib session\n");
+    UbwcpLayout layout = {};
+    if (!GetCachedLayout(info, hnd->format, hnd->flags, handle, &layout)) {
       return;
     }
+    hnd->linear_size = layout.linear_size;
+
     UBWCPLib_buf_attrs attrsUBWCP;
     memset(&attrsUBWCP, 0, sizeof(UBWCPLib_buf_attrs));
-
-    int plane_count = 0;
-
-    gralloc::PlaneLayoutInfo plane_layout[8] = {};
-    if (gralloc::IsYuvFormat(handle->format)) {
-      gralloc::GetYUVPlaneInfo(info, handle->format, handle->unaligned_width,
-                               handle->unaligned_height, handle->flags, &plane_count, plane_layout,
-                               handle);
-      if (handle->format == HAL_PIXEL_FORMAT_YCbCr_420_TP10_UBWC) {
-        planar_padding = plane_layout[3].offset - plane_layout[0].offset - plane_layout[0].size;
-      } else {
-        planar_padding = plane_layout[1].offset - plane_layout[0].offset - plane_layout[0].size;
-      }
-      attrsUBWCP.planar_padding = planar_padding;
-      hnd->linear_size = plane_layout[0].size + plane_layout[1].size;
-    } else {
-      gralloc::GetRGBPlaneInfo(info, handle->format, handle->unaligned_width,
-                               handle->unaligned_height, handle->flags, &plane_count, plane_layout);
-      attrsUBWCP.planar_padding = 0;
-      hnd->linear_size = plane_layout[0].size;
-    }
-
     attrsUBWCP.image_format = GetUbwcpPixelFormat(hnd->format);
     attrsUBWCP.width = hnd->unaligned_width;
     attrsUBWCP.height = hnd->unaligned_height;
-    attrsUBWCP.stride = plane_layout[0].stride_bytes;
-    attrsUBWCP.scanlines = plane_layout[0].scanlines;
+    attrsUBWCP.stride = layout.stride_bytes;
+    attrsUBWCP.scanlines = layout.scanlines;
+    attrsUBWCP.planar_padding = layout.planar_padding;
 
     ALOGD("attrsUBWCP f:0x%x, w: %d, h: %d stride: %d scan_lines: %d planar_padding: %d size:%d \n",
           attrsUBWCP.image_format, attrsUBWCP.width, attrsUBWCP.height, attrsUBWCP.stride,
           attrsUBWCP.scanlines, attrsUBWCP.planar_padding, hnd->linear_size);
 
+    lock_guard<mutex> obj(session_lock_);
+    void *session = GetSession();
+    if (!session) {
+      return;
+    }
     ret = LINK_UBWCPLib_set_buf_attrs(session, hnd->fd, &attrsUBWCP);
     if (ret) {
       ALOGE("UBWCPLib_set_buf_attrs failed and ret is %d \n", ret);
       return;
     }
-
-    LINK_UBWCPLib_destroy_session(session);
   }
 #endif
 }
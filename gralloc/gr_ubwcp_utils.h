@@ -5,6 +5,10 @@
 #ifndef __GR_UBWCP_UTILS_H__
 #define __GR_UBWCP_UTILS_H__
 
+#include <map>
+#include <mutex>
+#include <tuple>
+
 #include "gr_utils.h"
 #ifdef TARGET_USES_UBWCP
 #include "UBWCPLib.h"
@@ -12,9 +16,31 @@
 
 namespace gralloc {
 
+/*
+ * Layout results the UBWC-P path computes per allocation; cached by
+ * (format, width, height, flags) so an allocation storm of identical
+ * streams computes each layout once.
+ */
+struct UbwcpLayout {
+  uint32_t stride_bytes = 0;
+  uint32_t scanlines = 0;
+  uint32_t planar_padding = 0;
+  uint32_t linear_size = 0;
+};
+
 class UbwcpUtils {
  public:
   void ConfigUBWCPAttributes(private_handle_t const *handle);
+
+  /*
+   * Batch layout query for stream configuration time: resolves (and caches) the
+   * UBWC-P layout for each BufferInfo in one pass so the per-buffer allocations
+   * that follow hit the cache instead of recomputing during the storm.
+   * Entries whose format/usage is not UBWC-P eligible are left zeroed.
+   * Returns the number of entries resolved.
+   */
+  uint32_t GetUbwcpLayouts(uint32_t count, const BufferInfo *infos, UbwcpLayout *layouts);
+
   static UbwcpUtils *GetInstance();
 
  private:
@@ -32,6 +58,20 @@ class UbwcpUtils {
    * Function to get the corresponding ubwcplib format for given HAL format
    */
   UBWCPLib_Image_Format GetUbwcpPixelFormat(int hal_format);
+
+  /*
+   * Returns the process-wide library session, created on first use. All session
+   * use must hold session_lock_; the library makes no thread safety promises.
+   */
+  void *GetSession();
+
+  /*
+   * Resolves the layout for (format, width, height, flags) through the cache,
+   * computing and inserting it on a miss. Returns false for layouts the plane
+   * info helpers cannot produce.
+   */
+  bool GetCachedLayout(const BufferInfo &info, int32_t format, int flags,
+                       const private_handle_t *handle, UbwcpLayout *layout);
 #endif
 
   /*
@@ -40,6 +80,14 @@ class UbwcpUtils {
   bool IsStrideAligned(int hal_format, int width);
 
   void *libUbwcpUtils_ = NULL;
+  void *session_ = NULL;
+  std::mutex session_lock_;
+  std::mutex layout_lock_;
+  // (format, width, height, flags) -> layout
+  std::map<std::tuple<int32_t, int32_t, int32_t, int>, UbwcpLayout> layout_cache_;
+  // hal_format -> stride alignment; the requirement depends on the format only,
+  // so one library query per format serves every later validation.
+  std::map<int, size_t> stride_alignment_cache_;
 
   static UbwcpUtils *s_instance;
 };
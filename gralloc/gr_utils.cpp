@@ -38,14 +38,24 @@
 
 #include <drm/drm_fourcc.h>
 
+#include <display_scanout_caps.h>
+#include <sched.h>
+#include <stdio.h>
 #include <sys/mman.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 #include <cutils/properties.h>
 #include <algorithm>
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include "gr_adreno_info.h"
 #include "gr_camera_info.h"
+#include "gr_metadata_notify.h"
+#include "gr_shared_layout.h"
 #include "gr_utils.h"
 #include "QtiGralloc.h"
 #include "color_extensions.h"
@@ -131,36 +141,50 @@ bool IsYuvFormat(int format) {
   }
 }
 
-bool IsUncompressedRGBFormat(int format) {
-  switch (format) {
-    case static_cast<int>(PixelFormat::RGBA_8888):
-    case static_cast<int>(PixelFormat::RGBX_8888):
-    case static_cast<int>(PixelFormat::RGB_888):
-    case static_cast<int>(PixelFormat::RGB_565):
-    case HAL_PIXEL_FORMAT_BGR_565:
-    case static_cast<int>(PixelFormat::BGRA_8888):
-    case HAL_PIXEL_FORMAT_RGBA_5551:
-    case HAL_PIXEL_FORMAT_RGBA_4444:
-    case HAL_PIXEL_FORMAT_R_8:
-    case static_cast<int>(aidl::android::hardware::graphics::common::PixelFormat::R_8):
-    case HAL_PIXEL_FORMAT_RG_88:
-    case HAL_PIXEL_FORMAT_BGRX_8888:
-    case static_cast<int>(PixelFormat::RGBA_1010102):
-    case HAL_PIXEL_FORMAT_ARGB_2101010:
-    case HAL_PIXEL_FORMAT_RGBX_1010102:
-    case HAL_PIXEL_FORMAT_XRGB_2101010:
-    case HAL_PIXEL_FORMAT_BGRA_1010102:
-    case HAL_PIXEL_FORMAT_ABGR_2101010:
-    case HAL_PIXEL_FORMAT_BGRX_1010102:
-    case HAL_PIXEL_FORMAT_XBGR_2101010:
-    case static_cast<int>(PixelFormat::RGBA_FP16):
-    case HAL_PIXEL_FORMAT_BGR_888:
-      return true;
-    default:
-      break;
+// Per-format attributes of the uncompressed RGB formats; one table serves both the
+// predicate and the bpp query so the hot paths do a single lookup.
+struct UncompressedRGBFormatEntry {
+  int format;
+  uint32_t bpp;
+};
+
+constexpr UncompressedRGBFormatEntry kUncompressedRGBFormats[] = {
+    {static_cast<int>(PixelFormat::RGBA_FP16), 8},
+    {static_cast<int>(PixelFormat::RGBA_8888), 4},
+    {static_cast<int>(PixelFormat::RGBX_8888), 4},
+    {static_cast<int>(PixelFormat::BGRA_8888), 4},
+    {HAL_PIXEL_FORMAT_BGRX_8888, 4},
+    {static_cast<int>(PixelFormat::RGBA_1010102), 4},
+    {HAL_PIXEL_FORMAT_ARGB_2101010, 4},
+    {HAL_PIXEL_FORMAT_RGBX_1010102, 4},
+    {HAL_PIXEL_FORMAT_XRGB_2101010, 4},
+    {HAL_PIXEL_FORMAT_BGRA_1010102, 4},
+    {HAL_PIXEL_FORMAT_ABGR_2101010, 4},
+    {HAL_PIXEL_FORMAT_BGRX_1010102, 4},
+    {HAL_PIXEL_FORMAT_XBGR_2101010, 4},
+    {static_cast<int>(PixelFormat::RGB_888), 3},
+    {HAL_PIXEL_FORMAT_BGR_888, 3},
+    {static_cast<int>(PixelFormat::RGB_565), 2},
+    {HAL_PIXEL_FORMAT_BGR_565, 2},
+    {HAL_PIXEL_FORMAT_RGBA_5551, 2},
+    {HAL_PIXEL_FORMAT_RGBA_4444, 2},
+    {HAL_PIXEL_FORMAT_RG_88, 2},
+    {HAL_PIXEL_FORMAT_R_8, 1},
+    {static_cast<int>(aidl::android::hardware::graphics::common::PixelFormat::R_8), 1},
+};
+
+static constexpr const UncompressedRGBFormatEntry *FindUncompressedRGBFormat(int format) {
+  for (auto &entry : kUncompressedRGBFormats) {
+    if (entry.format == format) {
+      return &entry;
+    }
   }
 
-  return false;
+  return nullptr;
+}
+
+bool IsUncompressedRGBFormat(int format) {
+  return FindUncompressedRGBFormat(format) != nullptr;
 }
 
 bool IsCompressedRGBFormat(int format) {
@@ -282,46 +306,13 @@ bool IsUbwcFlexFormat(int format) {
 }
 
 uint32_t GetBppForUncompressedRGB(int format) {
-  uint32_t bpp = 0;
-  switch (format) {
-    case static_cast<int>(PixelFormat::RGBA_FP16):
-      bpp = 8;
-      break;
-    case static_cast<int>(PixelFormat::RGBA_8888):
-    case static_cast<int>(PixelFormat::RGBX_8888):
-    case static_cast<int>(PixelFormat::BGRA_8888):
-    case HAL_PIXEL_FORMAT_BGRX_8888:
-    case static_cast<int>(PixelFormat::RGBA_1010102):
-    case HAL_PIXEL_FORMAT_ARGB_2101010:
-    case HAL_PIXEL_FORMAT_RGBX_1010102:
-    case HAL_PIXEL_FORMAT_XRGB_2101010:
-    case HAL_PIXEL_FORMAT_BGRA_1010102:
-    case HAL_PIXEL_FORMAT_ABGR_2101010:
-    case HAL_PIXEL_FORMAT_BGRX_1010102:
-    case HAL_PIXEL_FORMAT_XBGR_2101010:
-      bpp = 4;
-      break;
-    case static_cast<int>(PixelFormat::RGB_888):
-    case HAL_PIXEL_FORMAT_BGR_888:
-      bpp = 3;
-      break;
-    case static_cast<int>(PixelFormat::RGB_565):
-    case HAL_PIXEL_FORMAT_BGR_565:
-    case HAL_PIXEL_FORMAT_RGBA_5551:
-    case HAL_PIXEL_FORMAT_RGBA_4444:
-    case HAL_PIXEL_FORMAT_RG_88:
-      bpp = 2;
-      break;
-    case HAL_PIXEL_FORMAT_R_8:
-    case static_cast<int>(aidl::android::hardware::graphics::common::PixelFormat::R_8):
-      bpp = 1;
-      break;
-    default:
-      ALOGE("Error : %s New format request = 0x%x", __FUNCTION__, format);
-      break;
+  const UncompressedRGBFormatEntry *entry = FindUncompressedRGBFormat(format);
+  if (!entry) {
+    ALOGE("Error : %s New format request = 0x%x", __FUNCTION__, format);
+    return 0;
   }
 
-  return bpp;
+  return entry->bpp;
 }
 
 bool CpuCanAccess(uint64_t usage) {
@@ -590,18 +581,62 @@ int GetBufferSizeAndDimensions(const BufferInfo &info, unsigned int *size, unsig
   return GetBufferSizeAndDimensions(info, size, alignedw, alignedh, &graphics_metadata);
 }
 
+// Memo cache for the descriptor -> (size, stride) computation. Alignment math depends only
+// on the descriptor and on process-wide configuration fixed at init, and clients such as
+// camera reconfigure with identical descriptors back to back, so a small direct-mapped
+// cache absorbs the repeated lookups. The Adreno-sized path is excluded because it also
+// produces a graphics metadata blob.
+struct BufferSizeCacheEntry {
+  bool valid = false;
+  BufferInfo info = {0, 0, 0};
+  unsigned int size = 0;
+  unsigned int alignedw = 0;
+  unsigned int alignedh = 0;
+};
+
+static const uint32_t kSizeCacheEntries = 16;
+static BufferSizeCacheEntry size_cache[kSizeCacheEntries];
+static std::mutex size_cache_lock;
+
+static uint32_t GetSizeCacheSlot(const BufferInfo &info) {
+  uint64_t hash = static_cast<uint64_t>(info.format) * 31 + static_cast<uint64_t>(info.width) * 17 +
+                  static_cast<uint64_t>(info.height) * 7 +
+                  static_cast<uint64_t>(info.layer_count) * 3 + info.usage;
+  return static_cast<uint32_t>(hash % kSizeCacheEntries);
+}
+
+static bool SameBufferInfo(const BufferInfo &lhs, const BufferInfo &rhs) {
+  return lhs.width == rhs.width && lhs.height == rhs.height && lhs.format == rhs.format &&
+         lhs.layer_count == rhs.layer_count && lhs.usage == rhs.usage;
+}
+
 int GetBufferSizeAndDimensions(const BufferInfo &info, unsigned int *size, unsigned int *alignedw,
                                unsigned int *alignedh, GraphicsMetadata *graphics_metadata) {
   int buffer_type = GetBufferType(info.format);
   if (CanUseAdrenoForSize(buffer_type, info.usage)) {
     return GetGpuResourceSizeAndDimensions(info, size, alignedw, alignedh, graphics_metadata);
   } else {
+    uint32_t slot = GetSizeCacheSlot(info);
+    {
+      std::lock_guard<std::mutex> lock(size_cache_lock);
+      BufferSizeCacheEntry &entry = size_cache[slot];
+      if (entry.valid && SameBufferInfo(entry.info, info)) {
+        *alignedw = entry.alignedw;
+        *alignedh = entry.alignedh;
+        *size = entry.size;
+        return 0;
+      }
+    }
+
     int err = GetAlignedWidthAndHeight(info, alignedw, alignedh);
     if (err) {
       *size = 0;
       return err;
     }
     *size = GetSize(info, *alignedw, *alignedh);
+
+    std::lock_guard<std::mutex> lock(size_cache_lock);
+    size_cache[slot] = {true, info, *size, *alignedw, *alignedh};
   }
   return 0;
 }
@@ -878,6 +913,56 @@ bool IsUBwcFormat(int format) {
   }
 }
 
+// Scanout capability table published by SDM (see display_scanout_caps.h). Loaded once per
+// process; a missing or invalid table leaves the usage-flag-based decision untouched.
+static std::vector<ScanoutCapsEntry> scanout_caps_table;
+static std::once_flag scanout_caps_once;
+
+static void LoadScanoutCaps() {
+  FILE *file = fopen(SCANOUT_CAPS_FILE, "rb");
+  if (!file) {
+    return;
+  }
+
+  const uint32_t kMaxEntries = 1024;
+  ScanoutCapsHeader header = {};
+  if (fread(&header, sizeof(header), 1, file) == 1 && header.magic == SCANOUT_CAPS_MAGIC &&
+      header.version == SCANOUT_CAPS_VERSION && header.entry_count > 0 &&
+      header.entry_count <= kMaxEntries) {
+    std::vector<ScanoutCapsEntry> entries(header.entry_count);
+    if (fread(entries.data(), sizeof(ScanoutCapsEntry), header.entry_count, file) ==
+        header.entry_count) {
+      scanout_caps_table = std::move(entries);
+    }
+  }
+  fclose(file);
+}
+
+// Whether the display can scan out this format with its compressed modifier. Permissive when
+// the table has not been published (e.g. first boot before the composer came up).
+static bool IsDisplayScanoutCapable(int format) {
+  std::call_once(scanout_caps_once, LoadScanoutCaps);
+  if (scanout_caps_table.empty()) {
+    return true;
+  }
+
+  uint32_t drm_format = 0;
+  uint64_t modifier = 0;
+  GetDRMFormat(static_cast<uint32_t>(format), qtigralloc::PRIV_FLAGS_UBWC_ALIGNED, &drm_format,
+               &modifier);
+  if (!drm_format) {
+    return true;
+  }
+
+  for (auto &entry : scanout_caps_table) {
+    if (entry.drm_format == drm_format && entry.modifier == modifier) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool IsUBwcSupported(int format) {
   // Existing HAL formats with UBWC support
   switch (format) {
@@ -974,6 +1059,12 @@ bool IsUBwcEnabled(int format, uint64_t usage) {
 
     // Allow UBWC, only if CPU usage flags are not set
     if (enable && !(CpuCanAccess(usage))) {
+      // An overlay-bound buffer only benefits from UBWC when the display can scan the
+      // compressed modifier out; otherwise the layer falls back to GPU every frame, which
+      // is worse than a linear allocation composed directly.
+      if ((usage & BufferUsage::COMPOSER_OVERLAY) && !IsDisplayScanoutCapable(format)) {
+        return false;
+      }
       return true;
     }
   }
@@ -1070,51 +1161,79 @@ void GetYuvUBwcWidthAndHeight(int width, int height, int format, unsigned int *a
   }
 }
 
-void GetRgbUBwcBlockSize(uint32_t bpp, int *block_width, int *block_height) {
-  *block_width = 0;
-  *block_height = 0;
+// UBWC macro-tile geometry of the uncompressed RGB formats, keyed by bytes per
+// pixel. Folding the geometry and the meta-plane padding into constant data
+// keeps the allocation-size path branch-light during allocation bursts.
+struct RgbUBwcBlockGeometry {
+  uint32_t bpp;
+  unsigned int block_width;
+  unsigned int block_height;
+};
 
-  switch (bpp) {
-    case 2:
-    case 4:
-      *block_width = 16;
-      *block_height = 4;
-      break;
-    case 8:
-      *block_width = 8;
-      *block_height = 4;
-      break;
-    case 16:
-      *block_width = 4;
-      *block_height = 4;
-      break;
-    default:
-      ALOGE("%s: Unsupported bpp: %d", __FUNCTION__, bpp);
-      break;
+constexpr RgbUBwcBlockGeometry kRgbUBwcBlockGeometry[] = {
+    {2, 16, 4},
+    {4, 16, 4},
+    {8, 8, 4},
+    {16, 4, 4},
+};
+
+static constexpr const RgbUBwcBlockGeometry *FindRgbUBwcBlockGeometry(uint32_t bpp) {
+  for (auto &entry : kRgbUBwcBlockGeometry) {
+    if (entry.bpp == bpp) {
+      return &entry;
+    }
   }
+
+  return nullptr;
 }
 
-unsigned int GetRgbUBwcMetaBufferSize(int width, int height, uint32_t bpp) {
-  unsigned int size = 0;
-  int meta_width, meta_height;
-  int block_width, block_height;
+// All UBWC meta-plane alignments are powers of two; ALIGN() is not constexpr,
+// so use a local helper the compiler can evaluate at compile time.
+static constexpr unsigned int AlignPow2(unsigned int x, unsigned int align) {
+  return (x + align - 1) & ~(align - 1);
+}
+
+static constexpr unsigned int RgbUBwcMetaBufferSize(const RgbUBwcBlockGeometry &geometry,
+                                                    unsigned int width, unsigned int height) {
+  // Align meta buffer height to 16 blocks and width to 64 blocks
+  unsigned int meta_height = AlignPow2((height + geometry.block_height - 1) / geometry.block_height,
+                                       16);
+  unsigned int meta_width = AlignPow2((width + geometry.block_width - 1) / geometry.block_width,
+                                      64);
+
+  // Align meta buffer size to 4K
+  return AlignPow2(meta_width * meta_height, 4096);
+}
 
-  GetRgbUBwcBlockSize(bpp, &block_width, &block_height);
-  if (!block_width || !block_height) {
+// Spot-check the folded math against known panel geometries so a table
+// regression is caught at compile time.
+static_assert(RgbUBwcMetaBufferSize(kRgbUBwcBlockGeometry[1], 1080, 2400) == 77824,
+              "32bpp UBWC meta buffer size mismatch for 1080x2400");
+static_assert(RgbUBwcMetaBufferSize(kRgbUBwcBlockGeometry[2], 1080, 2400) == 118784,
+              "64bpp UBWC meta buffer size mismatch for 1080x2400");
+
+void GetRgbUBwcBlockSize(uint32_t bpp, int *block_width, int *block_height) {
+  const RgbUBwcBlockGeometry *geometry = FindRgbUBwcBlockGeometry(bpp);
+  if (!geometry) {
+    *block_width = 0;
+    *block_height = 0;
     ALOGE("%s: Unsupported bpp: %d", __FUNCTION__, bpp);
-    return size;
+    return;
   }
 
-  // Align meta buffer height to 16 blocks
-  meta_height = ALIGN(((height + block_height - 1) / block_height), 16);
-
-  // Align meta buffer width to 64 blocks
-  meta_width = ALIGN(((width + block_width - 1) / block_width), 64);
+  *block_width = static_cast<int>(geometry->block_width);
+  *block_height = static_cast<int>(geometry->block_height);
+}
 
-  // Align meta buffer size to 4K
-  size = (unsigned int)ALIGN((meta_width * meta_height), 4096);
+unsigned int GetRgbUBwcMetaBufferSize(int width, int height, uint32_t bpp) {
+  const RgbUBwcBlockGeometry *geometry = FindRgbUBwcBlockGeometry(bpp);
+  if (!geometry) {
+    ALOGE("%s: Unsupported bpp: %d", __FUNCTION__, bpp);
+    return 0;
+  }
 
-  return size;
+  return RgbUBwcMetaBufferSize(*geometry, static_cast<unsigned int>(width),
+                               static_cast<unsigned int>(height));
 }
 
 unsigned int GetUBwcSize(int width, int height, int format, unsigned int alignedw,
@@ -2357,7 +2476,9 @@ uint64_t GetMetaDataSize(uint64_t reserved_region_size, uint64_t custom_content_
   reserved_region_size = 0;
 #endif
   return static_cast<uint64_t>(ROUND_UP_PAGESIZE(sizeof(MetaData_t) + reserved_region_size +
-                                                 custom_content_md_region_size));
+                                                 custom_content_md_region_size +
+                                                 sizeof(MetadataNotify) +
+                                                 sizeof(SharedBufferLayout)));
 }
 
 void UnmapAndReset(private_handle_t *handle) {
@@ -2540,6 +2661,40 @@ bool getGralloc4Array(MetaData_t *metadata, int64_t paramType) {
   }
 }
 
+// Layout table for fixed-size MetaData_t fields, resolved at compile time through offsetof().
+// Entries cover fields whose get is a plain same-size copy, so a query can be served with a
+// direct read from the mapped region; everything else takes the switch in GetMetaDataInternal().
+struct MetadataFieldEntry {
+  int64_t type;
+  size_t offset;
+  size_t size;
+};
+
+static const MetadataFieldEntry kMetadataFieldTable[] = {
+    {QTI_PP_PARAM_INTERLACED, offsetof(MetaData_t, interlaced), sizeof(MetaData_t::interlaced)},
+    {(int64_t)StandardMetadataType::CROP, offsetof(MetaData_t, crop), sizeof(MetaData_t::crop)},
+    {QTI_REFRESH_RATE, offsetof(MetaData_t, refreshrate), sizeof(MetaData_t::refreshrate)},
+    {QTI_MAP_SECURE_BUFFER, offsetof(MetaData_t, mapSecureBuffer),
+     sizeof(MetaData_t::mapSecureBuffer)},
+    {QTI_LINEAR_FORMAT, offsetof(MetaData_t, linearFormat), sizeof(MetaData_t::linearFormat)},
+    {QTI_SINGLE_BUFFER_MODE, offsetof(MetaData_t, isSingleBufferMode),
+     sizeof(MetaData_t::isSingleBufferMode)},
+    {QTI_VT_TIMESTAMP, offsetof(MetaData_t, vtTimeStamp), sizeof(MetaData_t::vtTimeStamp)},
+    {QTI_COLOR_METADATA, offsetof(MetaData_t, color), sizeof(MetaData_t::color)},
+    {QTI_VIDEO_PERF_MODE, offsetof(MetaData_t, isVideoPerfMode),
+     sizeof(MetaData_t::isVideoPerfMode)},
+    {QTI_VIDEO_TS_INFO, offsetof(MetaData_t, videoTsInfo), sizeof(MetaData_t::videoTsInfo)},
+};
+
+static const MetadataFieldEntry *GetMetadataFieldEntry(int64_t type) {
+  for (auto &entry : kMetadataFieldTable) {
+    if (entry.type == type) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
 Error GetMetaDataByReference(void *buffer, int64_t type, void **out) {
   return GetMetaDataInternal(buffer, type, nullptr, out);
 }
@@ -2548,6 +2703,41 @@ Error GetMetaDataValue(void *buffer, int64_t type, void *in) {
   return GetMetaDataInternal(buffer, type, in, nullptr);
 }
 
+Error GetMetaDataValueBatch(void *buffer, uint32_t count, const int64_t *types,
+                            void *const *values, Error *statuses) {
+  if (buffer == nullptr || types == nullptr || values == nullptr || statuses == nullptr) {
+    ALOGE("Invalid input params");
+    return Error::BAD_VALUE;
+  }
+
+  private_handle_t *handle = static_cast<private_handle_t *>(buffer);
+  // Validate and map once for the whole batch; the per-field reads below reuse the mapping.
+  if (ValidateAndMap(handle) != 0) {
+    return Error::UNSUPPORTED;
+  }
+
+  MetaData_t *data = reinterpret_cast<MetaData_t *>(handle->base_metadata);
+  if (data == nullptr) {
+    return Error::BAD_VALUE;
+  }
+
+  for (uint32_t i = 0; i < count; i++) {
+    const MetadataFieldEntry *entry = GetMetadataFieldEntry(types[i]);
+    if (entry != nullptr) {
+      if (!getGralloc4Array(data, types[i])) {
+        statuses[i] = Error::BAD_VALUE;
+        continue;
+      }
+      memcpy(values[i], reinterpret_cast<uint8_t *>(data) + entry->offset, entry->size);
+      statuses[i] = Error::NONE;
+    } else {
+      statuses[i] = GetMetaDataInternal(buffer, types[i], values[i], nullptr);
+    }
+  }
+
+  return Error::NONE;
+}
+
 Error ColorMetadataToDataspace(ColorMetaData color_metadata, Dataspace *dataspace) {
   Dataspace primaries, transfer, range = Dataspace::UNKNOWN;
 
@@ -3016,15 +3206,25 @@ Error GetPlaneLayout(private_handle_t *handle,
   BufferInfo info(handle->unaligned_width, handle->unaligned_height, handle->format, handle->usage);
 
   gralloc::PlaneLayoutInfo plane_layout[8] = {};
-  if (gralloc::IsYuvFormat(handle->format)) {
-    gralloc::GetYUVPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
-                             &plane_count, plane_layout, handle);
-  } else if (gralloc::IsUncompressedRGBFormat(handle->format) ||
-             gralloc::IsCompressedRGBFormat(handle->format)) {
-    gralloc::GetRGBPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
-                             &plane_count, plane_layout);
-  } else {
-    return Error::BAD_BUFFER;
+  // The allocating process publishes this layout into the shared metadata page; it is
+  // derived from the same fixed handle geometry, so importing processes read it instead
+  // of re-deriving it (including the Adreno layout query for GPU formats) per query.
+  const SharedBufferLayout *shared_layout = GetSharedBufferLayout(
+      handle->base_metadata, handle->reserved_size, handle->custom_content_md_reserved_size);
+  if (SharedBufferLayoutValid(shared_layout)) {
+    plane_count = SharedBufferLayoutRead(shared_layout, plane_layout);
+  }
+  if (plane_count == 0) {
+    if (gralloc::IsYuvFormat(handle->format)) {
+      gralloc::GetYUVPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
+                               &plane_count, plane_layout, handle);
+    } else if (gralloc::IsUncompressedRGBFormat(handle->format) ||
+               gralloc::IsCompressedRGBFormat(handle->format)) {
+      gralloc::GetRGBPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
+                               &plane_count, plane_layout);
+    } else {
+      return Error::BAD_BUFFER;
+    }
   }
   plane_info.resize(plane_count);
   for (int i = 0; i < plane_count; i++) {
@@ -3044,6 +3244,87 @@ Error GetPlaneLayout(private_handle_t *handle,
   return Error::NONE;
 }
 
+// Zero fill in bounded chunks, yielding between them so a multi-megabyte clear cannot
+// monopolize the calling thread. The wide stores keep the hot loop off the byte path;
+// unaligned heads and tails fall back to memset.
+static void ClearBytes(uint8_t *dst, size_t length) {
+  const size_t kChunkBytes = 1 << 20;
+  while (length) {
+    size_t chunk = std::min(length, kChunkBytes);
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    if ((reinterpret_cast<uintptr_t>(dst) & 15) == 0) {
+      size_t aligned = chunk & ~static_cast<size_t>(63);
+      uint8x16_t zero = vdupq_n_u8(0);
+      for (size_t i = 0; i < aligned; i += 64) {
+        vst1q_u8(dst + i, zero);
+        vst1q_u8(dst + i + 16, zero);
+        vst1q_u8(dst + i + 32, zero);
+        vst1q_u8(dst + i + 48, zero);
+      }
+      if (chunk > aligned) {
+        memset(dst + aligned, 0, chunk - aligned);
+      }
+    } else {
+      memset(dst, 0, chunk);
+    }
+#else
+    memset(dst, 0, chunk);
+#endif
+    dst += chunk;
+    length -= chunk;
+    if (length) {
+      sched_yield();
+    }
+  }
+}
+
+int ClearBufferContents(private_handle_t *handle, void *base) {
+  if (!handle || !base) {
+    return -EINVAL;
+  }
+
+  PlaneLayoutInfo plane_layout[8] = {};
+  int plane_count = 0;
+  const SharedBufferLayout *shared_layout = GetSharedBufferLayout(
+      handle->base_metadata, handle->reserved_size, handle->custom_content_md_reserved_size);
+  if (SharedBufferLayoutValid(shared_layout)) {
+    plane_count = SharedBufferLayoutRead(shared_layout, plane_layout);
+  }
+  if (plane_count == 0) {
+    BufferInfo info(handle->unaligned_width, handle->unaligned_height, handle->format,
+                    handle->usage);
+    if (IsYuvFormat(handle->format)) {
+      GetYUVPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
+                      &plane_count, plane_layout, handle);
+    } else if (IsUncompressedRGBFormat(handle->format) || IsCompressedRGBFormat(handle->format)) {
+      GetRGBPlaneInfo(info, handle->format, handle->width, handle->height, handle->flags,
+                      &plane_count, plane_layout);
+    }
+  }
+
+  if (plane_count <= 0) {
+    // No layout derivable for this format; clear the whole mapping.
+    ClearBytes(reinterpret_cast<uint8_t *>(base), handle->size);
+    return 0;
+  }
+
+  // Clear only the pixel data planes; meta planes (UBWC compression metadata) and the
+  // alignment padding between planes never reach a consumer as pixels, so zeroing them
+  // is wasted bandwidth.
+  for (int i = 0; i < plane_count; i++) {
+    if (plane_layout[i].component & PLANE_COMPONENT_META) {
+      continue;
+    }
+    uint64_t offset = plane_layout[i].offset;
+    uint64_t size = plane_layout[i].size;
+    if (offset >= handle->size || size > handle->size - offset) {
+      continue;  // inconsistent layout; do not run past the mapping
+    }
+    ClearBytes(reinterpret_cast<uint8_t *>(base) + offset, static_cast<size_t>(size));
+  }
+  return 0;
+}
+
 Error GetMetaDataInternal(void *buffer, int64_t type, void *in, void **out) {
   if (!in && !out) {
     ALOGE("Invalid input params");
@@ -3081,61 +3362,19 @@ Error GetMetaDataInternal(void *buffer, int64_t type, void *in, void **out) {
 
   ret = Error::NONE;
 
+  // Fixed-size fields are served straight from the layout table without walking the switch.
+  const MetadataFieldEntry *entry = GetMetadataFieldEntry(type);
+  if (entry != nullptr) {
+    uint8_t *field = reinterpret_cast<uint8_t *>(data) + entry->offset;
+    if (copy) {
+      memcpy(in, field, entry->size);
+    } else {
+      *out = field;
+    }
+    return ret;
+  }
+
   switch (type) {
-    case QTI_PP_PARAM_INTERLACED:
-      if (copy) {
-        *(reinterpret_cast<int32_t *>(in)) = data->interlaced;
-      } else {
-        *out = &data->interlaced;
-      }
-      break;
-    case (int64_t)StandardMetadataType::CROP:
-      if (copy) {
-        *(reinterpret_cast<CropRectangle_t *>(in)) = data->crop;
-      }
-      break;
-    case QTI_REFRESH_RATE:
-      if (copy) {
-        *(reinterpret_cast<float *>(in)) = data->refreshrate;
-      } else {
-        *out = &data->refreshrate;
-      }
-      break;
-    case QTI_MAP_SECURE_BUFFER:
-      if (copy) {
-        *(reinterpret_cast<int32_t *>(in)) = data->mapSecureBuffer;
-      } else {
-        *out = &data->mapSecureBuffer;
-      }
-      break;
-    case QTI_LINEAR_FORMAT:
-      if (copy) {
-        *(reinterpret_cast<uint32_t *>(in)) = data->linearFormat;
-      } else {
-        *out = &data->linearFormat;
-      }
-      break;
-    case QTI_SINGLE_BUFFER_MODE:
-      if (copy) {
-        *(reinterpret_cast<uint32_t *>(in)) = data->isSingleBufferMode;
-      } else {
-        *out = &data->isSingleBufferMode;
-      }
-      break;
-    case QTI_VT_TIMESTAMP:
-      if (copy) {
-        *(reinterpret_cast<uint64_t *>(in)) = data->vtTimeStamp;
-      } else {
-        *out = &data->vtTimeStamp;
-      }
-      break;
-    case QTI_COLOR_METADATA:
-      if (copy) {
-        *(reinterpret_cast<ColorMetaData *>(in)) = data->color;
-      } else {
-        *out = &data->color;
-      }
-      break;
     case QTI_UBWC_CR_STATS_INFO: {
       if (copy) {
         struct UBWCStats *stats = (struct UBWCStats *)in;
@@ -3148,13 +3387,6 @@ Error GetMetaDataInternal(void *buffer, int64_t type, void *in, void **out) {
       }
       break;
     }
-    case QTI_VIDEO_PERF_MODE:
-      if (copy) {
-        *(reinterpret_cast<uint32_t *>(in)) = data->isVideoPerfMode;
-      } else {
-        *out = &data->isVideoPerfMode;
-      }
-      break;
     case QTI_GRAPHICS_METADATA:
       if (copy) {
         memcpy(in, data->graphics_metadata.data, sizeof(data->graphics_metadata.data));
@@ -3221,13 +3453,6 @@ Error GetMetaDataInternal(void *buffer, int64_t type, void *in, void **out) {
       break;
     }
 #endif
-    case QTI_VIDEO_TS_INFO:
-      if (copy) {
-        *(reinterpret_cast<VideoTimestampInfo *>(in)) = data->videoTsInfo;
-      } else {
-        *out = &data->videoTsInfo;
-      }
-      break;
 #ifdef QTI_TIMED_RENDERING
     case QTI_TIMED_RENDERING:
       if (copy) {
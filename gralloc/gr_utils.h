@@ -276,11 +276,16 @@ int ValidateAndMap(private_handle_t *handle);
 Error GetColorSpaceFromColorMetaData(ColorMetaData color_metadata, uint32_t *color_space);
 Error GetMetaDataByReference(void *buffer, int64_t type, void **out);
 Error GetMetaDataValue(void *buffer, int64_t type, void *in);
+Error GetMetaDataValueBatch(void *buffer, uint32_t count, const int64_t *types,
+                            void *const *values, Error *statuses);
 Error GetMetaDataInternal(void *buffer, int64_t type, void *in, void **out);
 Error ColorMetadataToDataspace(ColorMetaData color_metadata,
                                aidl::android::hardware::graphics::common::Dataspace *dataspace);
 Error GetPlaneLayout(private_handle_t *handle,
                      std::vector<aidl::android::hardware::graphics::common::PlaneLayout> *out);
+// Zero fills the pixel data planes of a CPU-mapped buffer, skipping meta planes and
+// inter-plane padding; clears the whole mapping when no plane layout can be derived.
+int ClearBufferContents(private_handle_t *handle, void *base);
 Error SetMetaData(private_handle_t *handle, uint64_t paramType, void *param);
 }  // namespace gralloc
 
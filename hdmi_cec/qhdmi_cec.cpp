@@ -42,6 +42,13 @@
 #include <fcntl.h>
 #include <hardware/hdmi_cec.h>
 #include <utils/Trace.h>
+#include <unistd.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include "qhdmi_cec.h"
 #include "QHDMIClient.h"
 
@@ -50,7 +57,12 @@ namespace qhdmicec {
 const int NUM_HDMI_PORTS = 1;
 const int MAX_SYSFS_DATA = 128;
 const int MAX_CEC_FRAME_SIZE = 20;
-const int MAX_SEND_MESSAGE_RETRIES = 1;
+// A CEC bus transaction takes tens of ms; the worker retries a busy line with
+// a growing backoff instead of making the caller eat the wait.
+const int MAX_SEND_MESSAGE_ATTEMPTS = 3;
+const int SEND_MESSAGE_BACKOFF_US = 5000;
+// Upper bound on how long a caller blocks for a polling message result
+const int POLL_RESULT_TIMEOUT_MS = 500;
 
 enum {
     LOGICAL_ADDRESS_SET   =  1,
@@ -69,8 +81,32 @@ enum {
     CEC_OFFSET_RETRANSMIT,
 };
 
+// One queued CEC frame. Polling messages carry the real bus ACK/NACK back to
+// the framework (logical address allocation depends on it), so their callers
+// wait for completion; directed and broadcast messages are fire-and-forget.
+struct cec_tx_request_t {
+    char frame[MAX_CEC_FRAME_SIZE];
+    bool poll;
+    int destination;
+    int result;
+    bool done;
+};
+
+// Dedicated TX worker so CEC bus waits are serialized here instead of in the
+// callers. The HAL v1.0 API has no TX completion callback, so deferred sends
+// report failures through logs; polls stay synchronous via done_cv.
+struct cec_tx_engine_t {
+    cec_context_t *ctx = NULL;
+    std::thread worker;
+    std::mutex lock;
+    std::condition_variable cv;       // Signalled when work is queued or on exit
+    std::condition_variable done_cv;  // Signalled when a request completes
+    std::deque<std::shared_ptr<cec_tx_request_t>> queue;
+    bool exit = false;
+};
+
 //Forward declarations
-static void cec_close_context(cec_context_t* ctx __unused);
+static void cec_close_context(cec_context_t* ctx);
 static int cec_enable(cec_context_t *ctx, int enable);
 static int cec_is_connected(const struct hdmi_cec_device* dev, int port_id);
 
@@ -211,6 +247,157 @@ static int cec_get_physical_address(const struct hdmi_cec_device* dev,
         return 0;
 }
 
+// Writes one frame to the driver, retrying a busy line with backoff.
+// Runs on the TX worker, never on a framework thread.
+static int cec_tx_transmit(cec_context_t *ctx, const char *frame)
+{
+    ATRACE_CALL();
+    char write_msg_path[MAX_PATH_LENGTH];
+    char dump[128];
+    hex_to_string(frame, MAX_CEC_FRAME_SIZE, dump);
+    ALOGD_IF(DEBUG, "%s: message to driver: %s", __FUNCTION__, dump);
+    snprintf(write_msg_path, sizeof(write_msg_path), "%s/cec/wr_msg",
+            ctx->fb_sysfs_path);
+    ssize_t err = 0;
+    for (int attempt = 0; attempt < MAX_SEND_MESSAGE_ATTEMPTS; attempt++) {
+        if (attempt > 0) {
+            ALOGE("%s: CEC line busy, retrying", __FUNCTION__);
+            usleep(SEND_MESSAGE_BACKOFF_US << (attempt - 1));
+        }
+        err = write_node(write_msg_path, frame, MAX_CEC_FRAME_SIZE);
+        if (err != -EAGAIN)
+            break;
+    }
+
+    if (err < 0) {
+       if (err == -ENXIO) {
+           ALOGI("%s: No device exists with the destination address",
+                   __FUNCTION__);
+           return HDMI_RESULT_NACK;
+       } else if (err == -EAGAIN) {
+            ALOGE("%s: CEC line is busy, max retry count exceeded",
+                    __FUNCTION__);
+            return HDMI_RESULT_BUSY;
+        } else {
+            ALOGE("%s: Failed to send CEC message err: %zd - %s",
+                    __FUNCTION__, err, strerror(int(-err)));
+            return HDMI_RESULT_FAIL;
+        }
+    } else {
+        ALOGD_IF(DEBUG, "%s: Sent CEC message - %zd bytes written",
+                __FUNCTION__, err);
+        return HDMI_RESULT_SUCCESS;
+    }
+}
+
+static void cec_tx_worker(cec_tx_engine_t *eng)
+{
+    std::unique_lock<std::mutex> l(eng->lock);
+    while (true) {
+        if (eng->exit) {
+            // Fail anything still queued so no poll caller is left waiting
+            while (!eng->queue.empty()) {
+                std::shared_ptr<cec_tx_request_t> req = eng->queue.front();
+                eng->queue.pop_front();
+                req->result = HDMI_RESULT_FAIL;
+                req->done = true;
+            }
+            eng->done_cv.notify_all();
+            return;
+        }
+        if (eng->queue.empty()) {
+            eng->cv.wait(l);
+            continue;
+        }
+        std::shared_ptr<cec_tx_request_t> req = eng->queue.front();
+        eng->queue.pop_front();
+        l.unlock();
+        int result = cec_tx_transmit(eng->ctx, req->frame);
+        if (result != HDMI_RESULT_SUCCESS && !req->poll) {
+            // Fire-and-forget sends have no caller to report to
+            ALOGE("%s: Deferred CEC send to %d failed with result %d",
+                    __FUNCTION__, req->destination, result);
+        }
+        l.lock();
+        req->result = result;
+        req->done = true;
+        eng->done_cv.notify_all();
+    }
+}
+
+// Queues a frame on the TX worker. Polling messages block for the real bus
+// result; when an identical poll is already queued the caller piggybacks on
+// it instead of putting a second transaction on the bus. Everything else
+// returns once queued.
+static int cec_tx_submit(cec_context_t *ctx, const char *frame, bool poll,
+        int destination)
+{
+    cec_tx_engine_t *eng = ctx->tx_engine;
+    if (!eng) {
+        // Engine is torn down or never came up; send inline
+        return cec_tx_transmit(ctx, frame);
+    }
+
+    std::unique_lock<std::mutex> l(eng->lock);
+    std::shared_ptr<cec_tx_request_t> req;
+    if (poll) {
+        for (auto &pending : eng->queue) {
+            if (pending->poll && pending->destination == destination) {
+                ALOGD_IF(DEBUG, "%s: Merging poll to %d with queued poll",
+                        __FUNCTION__, destination);
+                req = pending;
+                break;
+            }
+        }
+    }
+    if (!req) {
+        req = std::make_shared<cec_tx_request_t>();
+        memcpy(req->frame, frame, MAX_CEC_FRAME_SIZE);
+        req->poll = poll;
+        req->destination = destination;
+        req->result = HDMI_RESULT_FAIL;
+        req->done = false;
+        eng->queue.push_back(req);
+        eng->cv.notify_one();
+    }
+
+    if (!poll) {
+        // Worker owns retries and failure logging from here on
+        return HDMI_RESULT_SUCCESS;
+    }
+
+    if (!eng->done_cv.wait_for(l, std::chrono::milliseconds(POLL_RESULT_TIMEOUT_MS),
+            [&req] { return req->done; })) {
+        ALOGE("%s: Timed out waiting for poll result for %d",
+                __FUNCTION__, destination);
+        return HDMI_RESULT_BUSY;
+    }
+    return req->result;
+}
+
+static cec_tx_engine_t* cec_tx_engine_start(cec_context_t *ctx)
+{
+    cec_tx_engine_t *eng = new cec_tx_engine_t;
+    eng->ctx = ctx;
+    eng->worker = std::thread(cec_tx_worker, eng);
+    return eng;
+}
+
+static void cec_tx_engine_stop(cec_context_t *ctx)
+{
+    cec_tx_engine_t *eng = ctx->tx_engine;
+    if (!eng)
+        return;
+    ctx->tx_engine = NULL;
+    {
+        std::lock_guard<std::mutex> l(eng->lock);
+        eng->exit = true;
+        eng->cv.notify_one();
+    }
+    eng->worker.join();
+    delete eng;
+}
+
 static int cec_send_message(const struct hdmi_cec_device* dev,
         const cec_message_t* msg)
 {
@@ -230,7 +417,6 @@ static int cec_send_message(const struct hdmi_cec_device* dev,
         ALOGD_IF(DEBUG, "%s: message from framework: %s", __FUNCTION__, dump);
     }
 
-    char write_msg_path[MAX_PATH_LENGTH];
     char write_msg[MAX_CEC_FRAME_SIZE];
     memset(write_msg, 0, sizeof(write_msg));
     // See definition of struct hdmi_cec_msg in driver code
@@ -247,42 +433,11 @@ static int cec_send_message(const struct hdmi_cec_device* dev,
     }
     //msg length + initiator + destination
     write_msg[CEC_OFFSET_FRAME_LENGTH] = (unsigned char) (msg->length + 1);
-    hex_to_string(write_msg, sizeof(write_msg), dump);
-    ALOGD_IF(DEBUG, "%s: message to driver: %s", __FUNCTION__, dump);
-    snprintf(write_msg_path, sizeof(write_msg_path), "%s/cec/wr_msg",
-            ctx->fb_sysfs_path);
-    int retry_count = 0;
-    ssize_t err = 0;
-    //HAL spec requires us to retry at least once.
-    while (true) {
-        err = write_node(write_msg_path, write_msg, sizeof(write_msg));
-        retry_count++;
-        if (err == -EAGAIN && retry_count <= MAX_SEND_MESSAGE_RETRIES) {
-            ALOGE("%s: CEC line busy, retrying", __FUNCTION__);
-        } else {
-            break;
-        }
-    }
 
-    if (err < 0) {
-       if (err == -ENXIO) {
-           ALOGI("%s: No device exists with the destination address",
-                   __FUNCTION__);
-           return HDMI_RESULT_NACK;
-       } else if (err == -EAGAIN) {
-            ALOGE("%s: CEC line is busy, max retry count exceeded",
-                    __FUNCTION__);
-            return HDMI_RESULT_BUSY;
-        } else {
-            return HDMI_RESULT_FAIL;
-            ALOGE("%s: Failed to send CEC message err: %zd - %s",
-                    __FUNCTION__, err, strerror(int(-err)));
-        }
-    } else {
-        ALOGD_IF(DEBUG, "%s: Sent CEC message - %zd bytes written",
-                __FUNCTION__, err);
-        return HDMI_RESULT_SUCCESS;
-    }
+    // A zero-length body is a polling message; its ACK/NACK matters to the
+    // framework, so it rides the queue synchronously. Everything else is
+    // acknowledged at enqueue and retried by the worker if the line is busy.
+    return cec_tx_submit(ctx, write_msg, msg->length == 0, msg->destination);
 }
 
 void cec_receive_message(cec_context_t *ctx, char *msg, ssize_t len)
@@ -461,12 +616,16 @@ static void cec_init_context(cec_context_t *ctx)
     //Enable CEC - framework expects it to be enabled by default
     cec_enable(ctx, true);
 
+    //Bring up the TX worker once the driver nodes are usable
+    ctx->tx_engine = cec_tx_engine_start(ctx);
+
     ALOGD("%s: CEC enabled", __FUNCTION__);
 }
 
-static void cec_close_context(cec_context_t* ctx __unused)
+static void cec_close_context(cec_context_t* ctx)
 {
     ALOGD("%s: Closing context", __FUNCTION__);
+    cec_tx_engine_stop(ctx);
 }
 
 static int cec_device_open(const struct hw_module_t* module,
@@ -38,6 +38,8 @@ namespace qClient {
 
 namespace qhdmicec {
 
+struct cec_tx_engine_t;
+
 #define SYSFS_BASE  "/sys/class/graphics/fb"
 #define MAX_PATH_LENGTH  128
 
@@ -65,6 +67,7 @@ struct cec_context_t {
     int version;
     uint32_t vendor_id;
     android::sp<qClient::QHDMIClient> disp_client;
+    cec_tx_engine_t *tx_engine;  // Async TX queue and worker, owned by the context
 };
 
 void cec_receive_message(cec_context_t *ctx, char *msg, ssize_t len);
@@ -79,6 +79,7 @@
 #define DISABLE_METADATA_DYNAMIC_FPS_PROP    DISPLAY_PROP("disable_metadata_dynamic_fps")
 #define DISABLE_SKIP_VALIDATE_PROP           DISPLAY_PROP("disable_skip_validate")
 #define DISABLE_DESTINATION_SCALER_PROP      DISPLAY_PROP("disable_dest_scaler")
+#define DISABLE_HW_CAPS_SNAPSHOT_PROP        DISPLAY_PROP("disable_hw_caps_snapshot")
 #define DISABLE_SECURE_INLINE_ROTATOR_PROP   DISPLAY_PROP("disable_secure_inline_rotator")
 #define DISABLE_MULTIRECT_PROP               DISPLAY_PROP("disable_multirect")
 #define DISABLE_UBWC_FF_VOTING_PROP          DISPLAY_PROP("disable_ubwc_ff_voting")
@@ -114,7 +115,18 @@
 // Enable posted start dynamic
 #define ENABLE_POSTED_START_DYN_PROP         DISPLAY_PROP("enable_posted_start_dyn")
 #define ENABLE_OPTIMIZE_REFRESH              DISPLAY_PROP("enable_optimize_refresh")
+// Align command mode commits to the panel TE window
+#define ENABLE_COMMIT_WINDOW_SCHEDULING      DISPLAY_PROP("enable_commit_window_scheduling")
+// Record per-commit DRM property streams for the sdm_commit_replay tool
+#define ENABLE_COMMIT_REPLAY_RECORD          DISPLAY_PROP("enable_commit_replay_record")
+#define ENABLE_COMMIT_WATCHDOG               DISPLAY_PROP("enable_commit_watchdog")
+#define COMMIT_WATCHDOG_FAST_FAIL            DISPLAY_PROP("commit_watchdog_fast_fail")
+// Cap color histogram collection to this many samples per second (0 = panel rate)
+#define HISTOGRAM_SAMPLING_RATE              DISPLAY_PROP("histogram_sampling_rate")
+// Deliver vsyncs of displays landing within this window from one wakeup (0 = off)
+#define VSYNC_COALESCE_WINDOW_NS             DISPLAY_PROP("vsync_coalesce_window_ns")
 #define DISABLE_PARALLEL_CACHE               DISPLAY_PROP("disable_parallel_cache")
+#define DISABLE_STRATEGY_CACHE               DISPLAY_PROP("disable_strategy_cache")
 #define DISABLE_LAYER_STITCH                 DISPLAY_PROP("disable_layer_stitch")
 // Disable 3d tonemap support for UI layers
 #define DISABLE_UI_3D_TONEMAP                DISPLAY_PROP("disable_ui_3d_tonemap")
@@ -123,6 +135,7 @@
 #define ENABLE_FORCE_SPLIT                   DISPLAY_PROP("enable_force_split")
 #define DISABLE_GPU_COLOR_CONVERT            DISPLAY_PROP("disable_gpu_color_convert")
 #define ENABLE_ASYNC_VDS_CREATION            DISPLAY_PROP("enable_async_vds_creation")
+#define ENABLE_SPECULATIVE_PREPARE           DISPLAY_PROP("enable_speculative_prepare")
 #define ENABLE_HISTOGRAM_INTR                DISPLAY_PROP("enable_hist_intr")
 #define DISABLE_MMRM_PROP                    DISPLAY_PROP("disable_mmrm_prop")
 #define DEFER_FPS_FRAME_COUNT                DISPLAY_PROP("defer_fps_frame_count")
@@ -180,10 +193,14 @@
 
 // PERF hint properties
 #define ENABLE_PERF_HINT_LARGE_COMP_CYCLE    DISPLAY_PROP("enable_perf_hint_large_comp_cycle")
+#define DISABLE_CPU_SCHED_HINTS              DISPLAY_PROP("disable_cpu_sched_hints")
 #define LARGE_COMP_HINT_THRESHOLD            DISPLAY_PROP("large_comp_hint_threshold")
 #define DISABLE_DYNAMIC_FPS                  DISPLAY_PROP("disable_dynamic_fps")
 #define ENABLE_QSYNC_IDLE                    DISPLAY_PROP("enable_qsync_idle")
 #define ENHANCE_IDLE_TIME                    DISPLAY_PROP("enhance_idle_time")
+#define ENABLE_ADAPTIVE_IDLE_TIMEOUT         DISPLAY_PROP("enable_adaptive_idle_timeout")
+#define IDLE_FLATTEN_FRAME_THRESHOLD         DISPLAY_PROP("idle_flatten_frame_threshold")
+#define ENABLE_VIDEO_CADENCE_LOCK            DISPLAY_PROP("enable_video_cadence_lock")
 
 #define MMRM_FLOOR_CLK_VOTE                  DISPLAY_PROP("mmrm_floor_vote")
 
@@ -224,6 +241,7 @@
 #define HW_SUPPORTS_UBWCP                    GRALLOC_PROP("hw_supports_ubwcp")
 #define USE_UNCACHED_HEAP                    GRALLOC_PROP("use_uncached_heap")
 #define ALLOW_CAMERA_PREVIEW_WRITE           GRALLOC_PROP("allow_camera_preview_write")
+#define DMA_BUF_POOL_MAX_MB_PROP             GRALLOC_PROP("dma_buf_pool_max_mb")
 
 // Add all vendor.gralloc.properties above
 
@@ -240,6 +258,8 @@
 #define DISABLE_IDLE_FPS_SWITCH              DISPLAY_PROP("disable_idle_fps_switch")
 #define DISABLE_IDLE_SCALING_LAYERS          DISPLAY_PROP("disable_idle_scaling_layers")
 #define DISABLE_LLCC_DURING_AOD              DISPLAY_PROP("disable_llcc_during_aod")
+// Scale MDP clock/bandwidth votes down for sparse doze frames (tiny AOD clock updates)
+#define ENABLE_DOZE_QOS_FLOOR                DISPLAY_PROP("enable_doze_qos_floor")
 #define DISABLE_CWB_IDLE_FALLBACK            DISPLAY_PROP("disable_cwb_idle_fallback")
 #define PRIORITIZE_CLIENT_CWB                DISPLAY_PROP("prioritize_client_cwb")
 #define TRANSIENT_FPS_CYCLE_COUNT            DISPLAY_PROP("transient_fps_cycle_count")
@@ -247,6 +267,23 @@
 #define WAIT_FOR_PRIMARY_DISPLAY             DISPLAY_PROP("wait_for_primary_display")
 #define ENABLE_ASYNC_POWER_OFF_WAIT          DISPLAY_PROP("enable_async_power_off_wait")
 #define FORCE_GPU_COMPOSITION                DISPLAY_PROP("force_gpu_composition")
+// Turn off the hysteresis governor that holds GPU composition after fallback thrash
+#define DISABLE_GPU_FALLBACK_GOVERNOR        DISPLAY_PROP("disable_gpu_fallback_governor")
+#define RESET_LATENCY_STATS_PROP             DISPLAY_PROP("reset_latency_stats")
+// Count heap allocations per traced scope and report them in dumpsys
+#define ENABLE_ALLOC_AUDIT                   DISPLAY_PROP("enable_alloc_audit")
+// Abort when one scope instance allocates more than this many times (CI only, 0 = off)
+#define ALLOC_AUDIT_BUDGET                   DISPLAY_PROP("alloc_audit_budget")
+// Journal last-committed display state for fast crash recovery
+#define ENABLE_STATE_JOURNAL                 DISPLAY_PROP("enable_state_journal")
+// Record fence waits longer than this many ms for dumpsys attribution (0 = off)
+#define FENCE_WAIT_STATS_MS                  DISPLAY_PROP("fence_wait_stats_ms")
+// Hand back the retire fence as the release fence of device-composed layers
+#define ENABLE_RELEASE_FENCE_SPECULATION     DISPLAY_PROP("enable_release_fence_speculation")
+// Keep the kernel vsync event on for this many ms after a disable request (0 = disable eagerly)
+#define VSYNC_DISABLE_LINGER_MS              DISPLAY_PROP("vsync_disable_linger_ms")
+// Frames that may be queued to hardware before the client is throttled (0 = draw method default)
+#define COMMIT_QUEUE_DEPTH                   DISPLAY_PROP("commit_queue_depth")
 
 // Add all other.properties above
 // End of property
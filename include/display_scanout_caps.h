@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __DISPLAY_SCANOUT_CAPS_H__
+#define __DISPLAY_SCANOUT_CAPS_H__
+
+#include <cstdint>
+
+/*
+ * Scanout capability table shared between SDM and gralloc.
+ *
+ * SDM probes the (DRM format, modifier) pairs the display planes can scan out and publishes
+ * them to SCANOUT_CAPS_FILE once at init. Gralloc consults the table when picking between a
+ * compressed and a linear layout, so buffers are not allocated with modifiers the display
+ * would reject at validate time (which forces GPU fallback for every frame of that layer).
+ *
+ * The file is header + entry_count packed entries, written atomically via rename. A missing
+ * or mismatching file means no filtering: gralloc keeps its usage-flag-based decision.
+ */
+
+#define SCANOUT_CAPS_FILE "/data/vendor/display/scanout_caps.bin"
+
+#define SCANOUT_CAPS_MAGIC 0x43534D53  /* "SMSC" */
+#define SCANOUT_CAPS_VERSION 1
+
+/* ScanoutCapsEntry flags */
+#define SCANOUT_CAP_INLINE_ROTATION (1u << 0)
+
+typedef struct ScanoutCapsHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t entry_count;
+  uint32_t reserved;
+} ScanoutCapsHeader;
+
+typedef struct ScanoutCapsEntry {
+  uint32_t drm_format;    /* DRM fourcc */
+  uint32_t flags;
+  uint64_t modifier;      /* DRM format modifier */
+  uint32_t max_width;     /* largest source rect a pipe accepts, 0 = unknown */
+  uint32_t max_height;
+} ScanoutCapsEntry;
+
+#endif  // __DISPLAY_SCANOUT_CAPS_H__
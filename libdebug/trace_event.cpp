@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "trace_event.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace display {
+
+thread_local TraceEvent::ThreadRing *TraceEvent::ring_ = nullptr;
+std::vector<TraceEvent::ThreadRing *> *TraceEvent::rings_ = nullptr;
+
+namespace {
+
+// Registration and dumping are rare; a single lock guarding both the name
+// table and the ring list is sufficient. The record path never takes it.
+std::mutex g_trace_lock;
+const char *g_trace_names[TraceEvent::kMaxTracePoints] = {};
+uint32_t g_trace_name_count = 0;
+
+}  // namespace
+
+uint32_t TraceEvent::Register(const char *name) {
+  std::lock_guard<std::mutex> guard(g_trace_lock);
+
+  for (uint32_t i = 0; i < g_trace_name_count; i++) {
+    if (!strcmp(g_trace_names[i], name)) {
+      return i;
+    }
+  }
+
+  if (g_trace_name_count == kMaxTracePoints) {
+    // Out of ids; alias further registrations to the last slot rather than
+    // failing the call site.
+    g_trace_names[kMaxTracePoints - 1] = "overflow";
+    return kMaxTracePoints - 1;
+  }
+
+  g_trace_names[g_trace_name_count] = name;
+  return g_trace_name_count++;
+}
+
+TraceEvent::ThreadRing *TraceEvent::AllocRing() {
+  ThreadRing *ring = new (std::nothrow) ThreadRing();
+  if (!ring) {
+    return nullptr;
+  }
+  ring->tid = static_cast<int32_t>(gettid());
+
+  std::lock_guard<std::mutex> guard(g_trace_lock);
+  if (!rings_) {
+    rings_ = new std::vector<ThreadRing *>();
+  }
+  // Rings are intentionally kept for the life of the process so Dump() can
+  // decode threads that have exited; the footprint is bounded by the number
+  // of distinct threads that ever traced.
+  rings_->push_back(ring);
+  ring_ = ring;
+
+  return ring;
+}
+
+void TraceEvent::Dump(std::string *out) {
+  if (!out) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(g_trace_lock);
+  if (!rings_) {
+    return;
+  }
+
+  char line[160];
+  for (ThreadRing *ring : *rings_) {
+    uint64_t next = ring->next;
+    uint64_t first = (next > kEventsPerThread) ? (next - kEventsPerThread) : 0;
+    for (uint64_t seq = first; seq < next; seq++) {
+      const Event &event = ring->events[seq & (kEventsPerThread - 1)];
+      uint32_t id = event.code & ~kBeginFlag;
+      if (!event.timestamp || id >= g_trace_name_count) {
+        continue;
+      }
+      snprintf(line, sizeof(line), "tid %d %c %" PRIu64 " %s\n", ring->tid,
+               (event.code & kBeginFlag) ? 'B' : 'E', event.timestamp, g_trace_names[id]);
+      out->append(line);
+    }
+  }
+}
+
+}  // namespace display
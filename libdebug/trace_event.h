@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __TRACE_EVENT_H__
+#define __TRACE_EVENT_H__
+
+#include <stdint.h>
+#include <time.h>
+
+#include <string>
+#include <vector>
+
+// Structured trace points. Unlike DTRACE_*, which formats strings and crosses
+// a virtual call per event, these record an (id, timestamp) pair into a fixed
+// per-thread ring buffer with no locking on the hot path — cheap enough to
+// stay enabled in production. A call site registers its name once through a
+// function-local static; DumpTraceEvents() decodes every thread's ring.
+
+#define TRACE_EVENT_SCOPED(name)                                           \
+  static uint32_t s_trace_point_id = display::TraceEvent::Register(name);  \
+  display::ScopedTraceEvent scoped_trace_event(s_trace_point_id)
+
+#define TRACE_EVENT_BEGIN(name)                                              \
+  do {                                                                       \
+    static uint32_t s_trace_point_id = display::TraceEvent::Register(name); \
+    display::TraceEvent::Begin(s_trace_point_id);                            \
+  } while (0)
+
+#define TRACE_EVENT_END(name)                                                \
+  do {                                                                       \
+    static uint32_t s_trace_point_id = display::TraceEvent::Register(name); \
+    display::TraceEvent::End(s_trace_point_id);                              \
+  } while (0)
+
+namespace display {
+
+class TraceEvent {
+ public:
+  static const uint32_t kMaxTracePoints = 256;
+  static const uint32_t kEventsPerThread = 4096;  // power of two, ~64 KB per thread
+
+  // Returns the id for a trace point name, registering it on first use.
+  // Call sites cache the result in a static so this runs once per site;
+  // the same name used from several sites resolves to one id.
+  static uint32_t Register(const char *name);
+
+  static void Begin(uint32_t id) { Record(id | kBeginFlag); }
+  static void End(uint32_t id) { Record(id); }
+
+  // Decodes every thread's ring into human-readable lines, oldest event
+  // first per thread. Rings keep filling while this runs; events are read
+  // without synchronization, so a line racing an in-flight write may be
+  // dropped or torn — acceptable for a diagnostic dump.
+  static void Dump(std::string *out);
+
+ private:
+  static const uint32_t kBeginFlag = 0x80000000;
+
+  struct Event {
+    uint32_t code = 0;       // trace point id, kBeginFlag set for begin events
+    uint64_t timestamp = 0;  // CLOCK_MONOTONIC_RAW in nanoseconds
+  };
+
+  struct ThreadRing {
+    int32_t tid = 0;
+    uint64_t next = 0;  // monotonically increasing write index
+    Event events[kEventsPerThread];
+  };
+
+  static uint64_t Now() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+  }
+
+  static void Record(uint32_t code) {
+    ThreadRing *ring = ring_;
+    if (!ring) {
+      ring = AllocRing();
+      if (!ring) {
+        return;
+      }
+    }
+    Event &event = ring->events[ring->next & (kEventsPerThread - 1)];
+    event.code = code;
+    event.timestamp = Now();
+    ring->next++;
+  }
+
+  static ThreadRing *AllocRing();
+
+  static thread_local ThreadRing *ring_;
+  static std::vector<ThreadRing *> *rings_;  // all rings ever allocated, for Dump()
+};
+
+class ScopedTraceEvent {
+ public:
+  explicit ScopedTraceEvent(uint32_t id) : id_(id) { TraceEvent::Begin(id_); }
+  ~ScopedTraceEvent() { TraceEvent::End(id_); }
+
+ private:
+  uint32_t id_;
+};
+
+}  // namespace display
+
+#endif  // __TRACE_EVENT_H__
@@ -1284,6 +1284,18 @@ enum struct DRMCacheWBState {
   ENABLED,
 };
 
+/* Plain-old-data atomic operation, used to batch property updates through
+ * DRMAtomicReqInterface::PerformBatch(). args holds the operation payload laid out exactly as
+ * the varargs of the equivalent Perform() call: one 64-bit word per scalar or pointer argument,
+ * with structs that Perform() takes by value (e.g. DRMRect) spanning consecutive words. */
+struct DRMAtomicOp {
+  static const uint32_t kMaxArgs = 4;
+
+  DRMOps op_code;
+  uint32_t obj_id;
+  uint64_t args[kMaxArgs];
+};
+
 /* DRM Atomic Request Property Set.
  *
  * Helper class to create and populate atomic properties of DRM components
@@ -1301,6 +1313,18 @@ class DRMAtomicReqInterface {
    */
   virtual int Perform(DRMOps opcode, uint32_t obj_id, ...) = 0;
 
+  /* Perform a batch of request operations in one call.
+   *
+   * Equivalent to calling Perform() once per entry, but the ops are POD so the caller can fill
+   * an array up front and submit it with a single virtual call instead of one varargs call per
+   * property on the commit hot path.
+   *
+   * [input]: ops: array of operations, dispatched in order.
+   *          num_ops: number of entries in ops.
+   * [return]: Error code if the API fails, 0 on success.
+   */
+  virtual int PerformBatch(const DRMAtomicOp *ops, uint32_t num_ops) = 0;
+
   /*
    * Commit the params set via Perform(). Also resets the properties after commit. Needs to be
    * called every frame.
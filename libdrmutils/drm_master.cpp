@@ -29,6 +29,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <xf86drm.h>
@@ -82,21 +83,85 @@ void DRMMaster::DestroyInstance() {
 }
 
 int DRMMaster::Init() {
+  dev_fd_ = OpenDeviceFd();
+  if (dev_fd_ < 0) {
+    return -ENODEV;
+  }
+
+  return 0;
+}
+
+int DRMMaster::OpenDeviceFd() {
   uint8_t retry = 0;
+  int fd = -1;
+  auto start = std::chrono::steady_clock::now();
   do {
-    dev_fd_ = drmOpen("msm_drm", nullptr);
-    if(dev_fd_ < 0) {
-      DRM_LOGW("drmOpen failed with error %d, retry %d", dev_fd_, retry);
+    fd = drmOpen("msm_drm", nullptr);
+    if(fd < 0) {
+      DRM_LOGW("drmOpen failed with error %d, retry %d", fd, retry);
       if (retry >= MAX_RETRY) {
-        return -ENODEV;
+        break;
       }
+      audit_.retry_count++;
       std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
-  } while(dev_fd_ < 0 && retry++ < MAX_RETRY);
+  } while(fd < 0 && retry++ < MAX_RETRY);
+
+  uint64_t elapsed_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  audit_.open_count++;
+  audit_.total_open_time_us += elapsed_us;
+  audit_.max_open_time_us = std::max(audit_.max_open_time_us, elapsed_us);
+  if (retry) {
+    // A contended boot race is worth a line in the log even when the open eventually wins.
+    DRM_LOGW("drmOpen took %" PRIu64 " us after %d retries", elapsed_us, retry);
+  }
+
+  return fd;
+}
+
+int DRMMaster::OpenNonMasterFd(int *fd) {
+  lock_guard<mutex> obj(s_lock);
+  // The master fd is already held by this singleton, so further opens on the node come up
+  // non-master; funneling them here dedups the retry policy and feeds the audit counters.
+  int new_fd = OpenDeviceFd();
+  if (new_fd < 0) {
+    return -ENODEV;
+  }
 
+  *fd = new_fd;
   return 0;
 }
 
+int DRMMaster::CreateLease(const uint32_t *object_ids, uint32_t object_count, int *lease_fd,
+                           uint32_t *lessee_id) {
+  lock_guard<mutex> obj(s_lock);
+#ifdef DRM_IOCTL_MODE_CREATE_LEASE
+  int fd = drmModeCreateLease(dev_fd_, object_ids, static_cast<int>(object_count), O_CLOEXEC,
+                              lessee_id);
+  if (fd < 0) {
+    DRM_LOGE("drmModeCreateLease failed with error %d", fd);
+    return fd;
+  }
+
+  audit_.lease_count++;
+  *lease_fd = fd;
+  return 0;
+#else
+  (void)object_ids;
+  (void)object_count;
+  (void)lease_fd;
+  (void)lessee_id;
+  DRM_LOGE("DRM lease support not available in kernel headers");
+  return -ENOTSUP;
+#endif
+}
+
+void DRMMaster::GetOpenAudit(DRMOpenAudit *audit) {
+  lock_guard<mutex> obj(s_lock);
+  *audit = audit_;
+}
+
 DRMMaster::~DRMMaster() {
   drmClose(dev_fd_);
   dev_fd_ = -1;
@@ -38,6 +38,15 @@ namespace drm_utils {
 
 #define MAX_RETRY 10
 
+/* Open/auth audit counters for the process; see DRMMaster::GetOpenAudit() */
+struct DRMOpenAudit {
+  uint32_t open_count = 0;          // Device opens issued through DRMMaster
+  uint32_t retry_count = 0;         // Retries spent in open backoff loops
+  uint32_t lease_count = 0;         // Leases handed out through CreateLease()
+  uint64_t total_open_time_us = 0;  // Cumulative time spent inside drmOpen
+  uint64_t max_open_time_us = 0;    // Slowest single open, backoff included
+};
+
 struct DRMBuffer {
   int fd = -1;
   uint32_t width = 0;
@@ -75,6 +84,33 @@ class DRMMaster {
   void GetHandle(int *fd) { *fd = dev_fd_; }
   /* Returns true if the ref counted version of rmfb is being used */
   bool IsRmFbRefCounted();
+  /* Opens a non-master fd on the device through the shared retry/backoff path, so every
+   * open in the process funnels through one audited code path instead of scattered
+   * drmOpen() calls. The master fd stays with this singleton; callers own the returned fd.
+   * Input:
+   *   fd: Pointer to store the non-master fd into
+   * Returns:
+   *   -ENODEV if the device cannot be opened
+   */
+  int OpenNonMasterFd(int *fd);
+  /* Hands a capability lease off the master fd to a non-composer client, so the client
+   * drives its leased objects without holding a master-capable fd of its own.
+   * Input:
+   *   object_ids: DRM object ids (CRTC/connector/plane) to place in the lease
+   *   object_count: Number of entries in object_ids
+   * Output:
+   *   lease_fd: Lessee fd to hand to the client, owned by the caller
+   *   lessee_id: Lessee id usable with drmModeRevokeLease()
+   * Returns:
+   *   Negative errno on failure, -ENOTSUP if the kernel headers lack lease support
+   */
+  int CreateLease(const uint32_t *object_ids, uint32_t object_count, int *lease_fd,
+                  uint32_t *lessee_id);
+  /* Snapshots the process-wide open/auth audit counters
+   * Input:
+   *   audit: Pointer to store the counters into
+   */
+  void GetOpenAudit(DRMOpenAudit *audit);
 
   /* Creates an instance of DRMMaster if it doesn't exist and initializes it. Threadsafe.
    * Input:
@@ -88,8 +124,10 @@ class DRMMaster {
  private:
   DRMMaster() {}
   int Init();
+  int OpenDeviceFd();  // called with s_lock held; audited retry/backoff open
 
   int dev_fd_ = -1;              // Master fd for DRM
+  DRMOpenAudit audit_ = {};      // Guarded by s_lock
   static DRMMaster *s_instance;  // Singleton instance
   static std::mutex s_lock;
 };
@@ -22,6 +22,7 @@
  * SPDX-License-Identifier: BSD-3-Clause-Clear
  */
 
+#include <dlfcn.h>
 #include <fcntl.h>
 #include <log/log.h>
 #include <pthread.h>
@@ -30,6 +31,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <algorithm>
 #include <chrono>
 #include <ctime>
 #include <fstream>
@@ -48,6 +50,8 @@
 #include "ringbuffer.h"
 
 constexpr static auto implementation_defined_max_frame_ringbuffer = 300;
+// Full-rate samples taken after a scene change before decimation resumes.
+constexpr static uint32_t scene_change_burst_samples = 8;
 
 histogram::HistogramCollector::HistogramCollector()
     : histogram(histogram::Ringbuffer::create(implementation_defined_max_frame_ringbuffer,
@@ -55,6 +59,33 @@ histogram::HistogramCollector::HistogramCollector()
 
 histogram::HistogramCollector::~HistogramCollector() {
   stop();
+  consumer_ = nullptr;
+  if (consumer_lib_) {
+    dlclose(consumer_lib_);
+  }
+}
+
+void histogram::HistogramCollector::load_consumer_plugin() {
+  consumer_lib_ = dlopen("libhistogramconsumer.so", RTLD_NOW);
+  if (!consumer_lib_) {
+    return;  // no consumer on this device; binder sampling still works
+  }
+
+  typedef HistogramConsumerFactoryIntf *(*GetFactoryFunc)();
+  GetFactoryFunc get_factory = reinterpret_cast<GetFactoryFunc>(
+      dlsym(consumer_lib_, "GetHistogramConsumerFactoryIntf"));
+  HistogramConsumerFactoryIntf *factory = get_factory ? get_factory() : nullptr;
+  if (factory) {
+    consumer_ = factory->CreateHistogramConsumerIntf(HISTOGRAM_CONSUMER_REVISION_MAJOR,
+                                                     HISTOGRAM_CONSUMER_REVISION_MINOR);
+  }
+  if (!consumer_) {
+    ALOGW("libhistogramconsumer.so present but no usable consumer (factory %p)", factory);
+    dlclose(consumer_lib_);
+    consumer_lib_ = nullptr;
+    return;
+  }
+  ALOGI("Loaded in-process histogram consumer plug-in");
 }
 
 namespace {
@@ -151,6 +182,10 @@ void histogram::HistogramCollector::start(uint64_t max_frames) {
   }
 
   started = true;
+  if (!consumer_load_attempted_) {
+    consumer_load_attempted_ = true;
+    load_consumer_plugin();
+  }
   histogram =
       histogram::Ringbuffer::create(max_frames, std::make_unique<histogram::DefaultTimeKeeper>());
   monitoring_thread = std::thread(&HistogramCollector::blob_processing_thread, this);
@@ -170,6 +205,22 @@ void histogram::HistogramCollector::stop() {
     monitoring_thread.join();
 }
 
+bool histogram::HistogramCollector::getBacklightScale(float *scale) const {
+  std::lock_guard<std::mutex> decision_lock(decision_mutex_);
+  if (!latest_decision_.valid) {
+    return false;
+  }
+  *scale = static_cast<float>(std::min(latest_decision_.backlight_scale, 65535u)) / 65535.0f;
+  return true;
+}
+
+void histogram::HistogramCollector::setSamplingRate(uint32_t samples_per_sec) {
+  std::unique_lock<decltype(mutex)> lk(mutex);
+  sampling_interval_ns_ = samples_per_sec ? (1000000000LL / samples_per_sec) : 0;
+  last_sample_ns_ = 0;
+  burst_samples_left_ = 0;
+}
+
 void histogram::HistogramCollector::notify_histogram_event(int blob_source_fd, BlobId id,
                                                            uint32_t width, uint32_t height) {
   std::unique_lock<decltype(mutex)> lk(mutex);
@@ -177,6 +228,21 @@ void histogram::HistogramCollector::notify_histogram_event(int blob_source_fd, B
     ALOGW("Discarding event blob-id: %X", id);
     return;
   }
+
+  if (sampling_interval_ns_) {
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    if (burst_samples_left_) {
+      burst_samples_left_--;
+    } else if (now_ns - last_sample_ns_ < sampling_interval_ns_) {
+      // Dropped vsync: returning here means the blob is never fetched, so decimation saves
+      // the ioctl and the validation pass, not just the ringbuffer insert.
+      return;
+    }
+    last_sample_ns_ = now_ns;
+  }
+
   if (work_available) {
     ALOGI("notified of histogram event before consuming last one. prior event discarded");
   }
@@ -204,22 +270,70 @@ void histogram::HistogramCollector::blob_processing_thread() {
     work_available = false;
     lk.unlock();
 
-    drmModePropertyBlobPtr blob = drmModeGetPropertyBlob(work.fd, work.id);
-    if (!blob || !blob->data) {
+    // Fetch the blob payload straight into the next ringbuffer staging slot instead of
+    // going through drmModeGetPropertyBlob, which allocates and copies per event. The slot
+    // is only published if the payload validates; otherwise it is reused for the next event.
+    struct drm_msm_hist *slot = histogram->begin_insert();
+    struct drm_mode_get_blob get_blob {};
+    get_blob.blob_id = work.id;
+    get_blob.length = sizeof(*slot);
+    get_blob.data = reinterpret_cast<uint64_t>(slot);
+    if (drmIoctl(work.fd, DRM_IOCTL_MODE_GETPROPBLOB, &get_blob)) {
+      lk.lock();
+      continue;
+    }
+    if (get_blob.length != sizeof(*slot)) {
+      ALOGI("Unexpected histogram blob size %u, expected %zu", get_blob.length, sizeof(*slot));
       lk.lock();
       continue;
     }
 
-    bool pass = hist_data_validate(*static_cast<struct drm_msm_hist *>(blob->data));
-    if (pass) {
-      histogram->insert(*static_cast<struct drm_msm_hist *>(blob->data));
+    if (hist_data_validate(*slot)) {
+      bool scene_change = scene_change_detect(*slot);
+      if (consumer_) {
+        // Hand the decoded bins to the in-process consumer before the next blob can land.
+        // The staging slot is only reused by a later begin_insert() on this same thread, so
+        // the payload is stable for the duration of the callback.
+        HistogramFrame frame = {panel_width_, panel_height_, HIST_V_SIZE, slot->data};
+        HistogramDecision decision;
+        if (!consumer_->ProcessHistogram(frame, &decision) && decision.valid) {
+          std::lock_guard<std::mutex> decision_lock(decision_mutex_);
+          latest_decision_ = decision;
+        }
+      }
+      histogram->finish_insert();
+      lk.lock();
+      if (scene_change && sampling_interval_ns_) {
+        // Sample the next few frames at full rate so the consumer tracks the transition.
+        burst_samples_left_ = scene_change_burst_samples;
+      }
+      continue;
     }
-    drmModeFreePropertyBlob(blob);
 
     lk.lock();
   }
 }
 
+bool histogram::HistogramCollector::scene_change_detect(struct drm_msm_hist const &hist) {
+  if (prev_frame_bins_.size() != HIST_V_SIZE) {
+    prev_frame_bins_.assign(hist.data, hist.data + HIST_V_SIZE);
+    return false;
+  }
+
+  uint64_t diff = 0;
+  for (auto i = 0u; i < HIST_V_SIZE; i++) {
+    uint32_t value = hist.data[i];
+    diff +=
+        (value > prev_frame_bins_[i]) ? value - prev_frame_bins_[i] : prev_frame_bins_[i] - value;
+    prev_frame_bins_[i] = value;
+  }
+
+  // Every pixel that moves between bins contributes twice to diff; flag a scene change when
+  // more than a quarter of the panel moved.
+  uint64_t pixels = uint64_t(panel_width_) * panel_height_;
+  return pixels && (diff > pixels / 2);
+}
+
 bool histogram::HistogramCollector::hist_data_validate(struct drm_msm_hist const &hist) {
   uint32_t hist_checksum = 0;
   uint32_t pixels_sum = panel_width_ * panel_height_;
@@ -28,12 +28,15 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #define HWC2_INCLUDE_STRINGIFICATION
 #define HWC2_USE_CPP11
 #include <hardware/hwcomposer2.h>
 #undef HWC2_INCLUDE_STRINGIFICATION
 #undef HWC2_USE_CPP11
 
+#include "histogram_consumer_intf.h"
+
 // number of enums in hwc2_format_color_component_t;
 #define NUM_HISTOGRAM_COLOR_COMPONENTS 4
 
@@ -52,6 +55,15 @@ class HistogramCollector {
 
   void notify_histogram_event(int blob_source_fd, BlobId id, uint32_t width, uint32_t height);
 
+  // Decimate collection to roughly samples_per_sec; 0 restores sampling at panel rate.
+  // Dropped vsyncs skip the blob fetch entirely, and a detected scene change temporarily
+  // returns to full rate so consumers see the transition without waiting out the interval.
+  void setSamplingRate(uint32_t samples_per_sec);
+
+  // Latest backlight scale from the loaded consumer plug-in, 0.0 to 1.0. Returns false when
+  // no plug-in is loaded or it has not produced a decision yet.
+  bool getBacklightScale(float *scale) const;
+
   std::string Dump() const;
 
   HWC2::Error collect(uint64_t max_frames, uint64_t timestamp,
@@ -65,6 +77,8 @@ class HistogramCollector {
   HistogramCollector &operator=(HistogramCollector const &) = delete;
   void blob_processing_thread();
   bool hist_data_validate(struct drm_msm_hist const &hist);
+  bool scene_change_detect(struct drm_msm_hist const &hist);
+  void load_consumer_plugin();
 
   std::condition_variable cv;
   std::mutex mutable mutex;
@@ -83,6 +97,18 @@ class HistogramCollector {
   std::unique_ptr<histogram::Ringbuffer> histogram;
   uint32_t panel_width_ = 0;
   uint32_t panel_height_ = 0;
+
+  int64_t sampling_interval_ns_ = 0;   /* GUARDED_BY(mutex) */
+  int64_t last_sample_ns_ = 0;         /* GUARDED_BY(mutex) */
+  uint32_t burst_samples_left_ = 0;    /* GUARDED_BY(mutex) */
+  std::vector<uint32_t> prev_frame_bins_;  // touched only by blob_processing_thread
+
+  // Optional in-process consumer plug-in; invoked on blob_processing_thread.
+  bool consumer_load_attempted_ = false; /* GUARDED_BY(mutex) */
+  void *consumer_lib_ = nullptr;
+  std::unique_ptr<HistogramConsumerIntf> consumer_;
+  std::mutex mutable decision_mutex_;
+  HistogramDecision latest_decision_; /* GUARDED_BY(decision_mutex_) */
 };
 
 }  // namespace histogram
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef HISTOGRAM_HISTOGRAM_CONSUMER_INTF_H_
+#define HISTOGRAM_HISTOGRAM_CONSUMER_INTF_H_
+
+#include <cstdint>
+#include <memory>
+
+namespace histogram {
+
+#define HISTOGRAM_CONSUMER_REVISION_MAJOR (1)
+#define HISTOGRAM_CONSUMER_REVISION_MINOR (0)
+
+/*
+ * In-process histogram consumer plug-in, loaded from libhistogramconsumer.so when present.
+ * ProcessHistogram() runs on the blob processing thread with the raw decoded bins right after
+ * they validate, so a backlight/dimming algorithm sees each sampled frame without the binder
+ * round trip that getDisplayedContentSample consumers pay. The callback must not block; the
+ * next histogram event is dropped while it runs.
+ */
+
+struct HistogramFrame {
+  uint32_t panel_width;
+  uint32_t panel_height;
+  uint32_t num_bins;
+  const uint32_t *bins;  // valid only for the duration of the callback
+};
+
+struct HistogramDecision {
+  bool valid = false;
+  uint32_t backlight_scale = 65535;  // backlight multiplier, 0..65535 (65535 = no dimming)
+};
+
+class HistogramConsumerIntf {
+ public:
+  virtual ~HistogramConsumerIntf() {}
+  // Returns 0 on success; a non-zero return discards the decision.
+  virtual int ProcessHistogram(const HistogramFrame &frame, HistogramDecision *out_decision) = 0;
+};
+
+class HistogramConsumerFactoryIntf {
+ public:
+  virtual ~HistogramConsumerFactoryIntf() {}
+  virtual std::unique_ptr<HistogramConsumerIntf> CreateHistogramConsumerIntf(
+      uint32_t major_ver, uint32_t minor_ver) = 0;
+};
+
+extern "C" HistogramConsumerFactoryIntf *GetHistogramConsumerFactoryIntf();
+
+}  // namespace histogram
+
+#endif  // HISTOGRAM_HISTOGRAM_CONSUMER_INTF_H_
@@ -25,10 +25,70 @@
 #include <log/log.h>
 #include <unistd.h>
 #include <algorithm>
-#include <iostream>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
 
 #include "ringbuffer.h"
 
+namespace {
+
+// bins[i] += data[i] * weight over the histogram bins. Weights are display times in ms and
+// comfortably fit 32 bits for any realistic collection window, which lets NEON widen the
+// u32 x u32 products straight into the u64 accumulators four bins at a time.
+void accumulate_weighted(const uint32_t *data, uint64_t weight, uint64_t *bins) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  if (weight <= std::numeric_limits<uint32_t>::max()) {
+    const uint32x2_t w = vdup_n_u32(static_cast<uint32_t>(weight));
+    for (auto i = 0u; i < HIST_V_SIZE; i += 4) {
+      uint32x4_t d = vld1q_u32(data + i);
+      uint64x2_t lo = vld1q_u64(bins + i);
+      uint64x2_t hi = vld1q_u64(bins + i + 2);
+      lo = vmlal_u32(lo, vget_low_u32(d), w);
+      hi = vmlal_u32(hi, vget_high_u32(d), w);
+      vst1q_u64(bins + i, lo);
+      vst1q_u64(bins + i + 2, hi);
+    }
+    return;
+  }
+#endif
+  for (auto i = 0u; i < HIST_V_SIZE; i++) {
+    bins[i] += data[i] * weight;
+  }
+}
+
+// bins[i] -= data[i] * weight. Exact inverse of accumulate_weighted for the same inputs, so
+// a frame's contribution can be retired when it leaves the collection window.
+void subtract_weighted(const uint32_t *data, uint64_t weight, uint64_t *bins) {
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+  if (weight <= std::numeric_limits<uint32_t>::max()) {
+    const uint32x2_t w = vdup_n_u32(static_cast<uint32_t>(weight));
+    for (auto i = 0u; i < HIST_V_SIZE; i += 4) {
+      uint32x4_t d = vld1q_u32(data + i);
+      uint64x2_t lo = vld1q_u64(bins + i);
+      uint64x2_t hi = vld1q_u64(bins + i + 2);
+      lo = vsubq_u64(lo, vmull_u32(vget_low_u32(d), w));
+      hi = vsubq_u64(hi, vmull_u32(vget_high_u32(d), w));
+      vst1q_u64(bins + i, lo);
+      vst1q_u64(bins + i + 2, hi);
+    }
+    return;
+  }
+#endif
+  for (auto i = 0u; i < HIST_V_SIZE; i++) {
+    bins[i] -= data[i] * weight;
+  }
+}
+
+uint64_t display_time_ms(nsecs_t start_timestamp, nsecs_t end_timestamp) {
+  const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::nanoseconds(end_timestamp - start_timestamp));
+  return static_cast<uint64_t>(delta.count());
+}
+
+}  // namespace
+
 nsecs_t histogram::DefaultTimeKeeper::current_time() const {
   return systemTime(SYSTEM_TIME_MONOTONIC);
 }
@@ -36,6 +96,7 @@ nsecs_t histogram::DefaultTimeKeeper::current_time() const {
 histogram::Ringbuffer::Ringbuffer(size_t ringbuffer_size, std::unique_ptr<histogram::TimeKeeper> tk)
     : rb_max_size(ringbuffer_size), timekeeper(std::move(tk)), cumulative_frame_count(0) {
   cumulative_bins.fill(0);
+  window_bins.fill(0);
 }
 
 std::unique_ptr<histogram::Ringbuffer> histogram::Ringbuffer::create(
@@ -52,13 +113,11 @@ void histogram::Ringbuffer::update_cumulative(nsecs_t now, uint64_t &count,
     return;
 
   count++;
-  ALOGI("count : %llu", static_cast<unsigned long long>(count));
 
   const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(
       std::chrono::nanoseconds(now - ringbuffer.front().start_timestamp));
 
   for (auto i = 0u; i < bins.size(); i++) {
-    ALOGI("histogram.data[%d]: %u\n", i, ringbuffer.front().histogram.data[i]);
     auto const increment = ringbuffer.front().histogram.data[i] * delta.count();
     // Check increment non-0 to avoid overflow in the next hist event
     if (CC_UNLIKELY(increment && ((bins[i] + increment < bins[i]) ||
@@ -67,40 +126,99 @@ void histogram::Ringbuffer::update_cumulative(nsecs_t now, uint64_t &count,
     } else {
       bins[i] += increment;
     }
-    ALOGI("bins[%d]: %llu\n", i, static_cast<unsigned long long>(bins[i]));
   }
 }
 
-void histogram::Ringbuffer::insert(drm_msm_hist const &frame) {
-  std::cout << "Enter insert ringbuffer" << std::endl;
-
-  std::unique_lock<decltype(mutex)> lk(mutex);
-  auto now = timekeeper->current_time();
-
-  std::cout << "update cumulative count" << std::endl;
+void histogram::Ringbuffer::commit_frame(drm_msm_hist const &frame, nsecs_t now) const {
   update_cumulative(now, cumulative_frame_count, cumulative_bins);
 
-  if (ringbuffer.size() == rb_max_size)
+  if (ringbuffer.size() == rb_max_size) {
+    auto const &evicted = ringbuffer.back();
+    if (evicted.end_timestamp) {
+      subtract_weighted(evicted.histogram.data,
+                        display_time_ms(evicted.start_timestamp, evicted.end_timestamp),
+                        window_bins.data());
+    }
     ringbuffer.pop_back();
-  if (!ringbuffer.empty())
-    ringbuffer.front().end_timestamp = now;
+  }
+  if (!ringbuffer.empty()) {
+    auto &displayed = ringbuffer.front();
+    displayed.end_timestamp = now;
+    accumulate_weighted(displayed.histogram.data,
+                        display_time_ms(displayed.start_timestamp, now), window_bins.data());
+  }
 
-  std::cout << "Exit insert ringbuffer" << std::endl;
   ringbuffer.push_front({frame, now, 0});
 }
 
+void histogram::Ringbuffer::drain_staging(std::unique_lock<std::mutex> const &) const {
+  auto tail = staging_tail.load(std::memory_order_relaxed);
+  auto head = staging_head.load(std::memory_order_acquire);
+  while (tail != head) {
+    auto const &entry = staging[tail % kStagingSize];
+    commit_frame(entry.histogram, entry.timestamp);
+    staging_tail.store(++tail, std::memory_order_release);
+    head = staging_head.load(std::memory_order_acquire);
+  }
+}
+
+void histogram::Ringbuffer::insert(drm_msm_hist const &frame) {
+  auto now = timekeeper->current_time();
+
+  // Fast path: publish into the staging ring without contending with collectors.
+  auto head = staging_head.load(std::memory_order_relaxed);
+  auto tail = staging_tail.load(std::memory_order_acquire);
+  if (head - tail < kStagingSize) {
+    staging[head % kStagingSize] = {frame, now};
+    staging_head.store(head + 1, std::memory_order_release);
+    return;
+  }
+
+  // Staging ring is full; no collector has run in a while. Drain inline under the lock.
+  std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
+  commit_frame(frame, now);
+}
+
+drm_msm_hist *histogram::Ringbuffer::begin_insert() {
+  auto head = staging_head.load(std::memory_order_relaxed);
+  auto tail = staging_tail.load(std::memory_order_acquire);
+  if (head - tail == kStagingSize) {
+    // Staging ring is full; no collector has run in a while. Drain inline to free the slot.
+    std::unique_lock<decltype(mutex)> lk(mutex);
+    drain_staging(lk);
+  }
+  return &staging[head % kStagingSize].histogram;
+}
+
+void histogram::Ringbuffer::finish_insert() {
+  auto head = staging_head.load(std::memory_order_relaxed);
+  staging[head % kStagingSize].timestamp = timekeeper->current_time();
+  staging_head.store(head + 1, std::memory_order_release);
+}
+
 bool histogram::Ringbuffer::resize(size_t ringbuffer_size) {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   if (ringbuffer_size == 0)
     return false;
   rb_max_size = ringbuffer_size;
-  if (ringbuffer.size() > rb_max_size)
+  if (ringbuffer.size() > rb_max_size) {
+    for (auto it = ringbuffer.begin() + rb_max_size; it != ringbuffer.end(); it++) {
+      if (it->end_timestamp) {
+        subtract_weighted(it->histogram.data,
+                          display_time_ms(it->start_timestamp, it->end_timestamp),
+                          window_bins.data());
+      }
+    }
     ringbuffer.resize(rb_max_size);
+  }
   return true;
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_cumulative() const {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   histogram::Ringbuffer::Sample sample{cumulative_frame_count, cumulative_bins};
   update_cumulative(timekeeper->current_time(), std::get<0>(sample), std::get<1>(sample));
   return sample;
@@ -108,22 +226,26 @@ histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_cumulative() const
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_ringbuffer_all() const {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   return collect_max(ringbuffer.size(), lk);
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_after(nsecs_t timestamp) const {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   return collect_max_after(timestamp, ringbuffer.size(), lk);
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max(uint32_t max_frames) const {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   return collect_max(max_frames, lk);
 }
 
 histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max_after(nsecs_t timestamp,
                                                                        uint32_t max_frames) const {
   std::unique_lock<decltype(mutex)> lk(mutex);
+  drain_staging(lk);
   return collect_max_after(timestamp, max_frames, lk);
 }
 
@@ -133,6 +255,18 @@ histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max(
   if (collect_first == 0)
     return {0, {}};
   std::array<uint64_t, HIST_V_SIZE> bins;
+
+  if (collect_first == ringbuffer.size()) {
+    // Whole-buffer collect: the completed frames are pre-aggregated in window_bins, only the
+    // still-displayed front frame has to be weighted against the current time.
+    auto const &displayed = ringbuffer.front();
+    bins = window_bins;
+    accumulate_weighted(displayed.histogram.data,
+                        display_time_ms(displayed.start_timestamp, timekeeper->current_time()),
+                        bins.data());
+    return {collect_first, bins};
+  }
+
   bins.fill(0);
   for (auto it = ringbuffer.begin(); it != ringbuffer.end() &&
     it != ringbuffer.begin() + collect_first; it++) {
@@ -140,11 +274,8 @@ histogram::Ringbuffer::Sample histogram::Ringbuffer::collect_max(
     if (it == ringbuffer.begin()) {
       end_timestamp = timekeeper->current_time();
     }
-    const auto time_displayed = std::chrono::nanoseconds(end_timestamp - it->start_timestamp);
-    const auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(time_displayed);
-    for (auto i = 0u; i < HIST_V_SIZE; i++) {
-      bins[i] += it->histogram.data[i] * delta.count();
-    }
+    accumulate_weighted(it->histogram.data, display_time_ms(it->start_timestamp, end_timestamp),
+                        bins.data());
   }
   return {collect_first, bins};
 }
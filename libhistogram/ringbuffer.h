@@ -23,6 +23,7 @@
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <array>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <mutex>
@@ -48,6 +49,11 @@ class Ringbuffer {
  public:
   static std::unique_ptr<Ringbuffer> create(size_t ringbuffer_size, std::unique_ptr<TimeKeeper> tk);
   void insert(drm_msm_hist const &frame);
+  // Zero-copy insert path for the single producer: fill the slot returned by begin_insert()
+  // in place (e.g. have the blob ioctl write straight into it), then publish it with
+  // finish_insert(). Skipping finish_insert() abandons the slot; it is reused next time.
+  drm_msm_hist *begin_insert();
+  void finish_insert();
   bool resize(size_t ringbuffer_size);
 
   using Sample = std::tuple<uint64_t /* numFrames */, std::array<uint64_t, HIST_V_SIZE> /* bins */>;
@@ -68,6 +74,20 @@ class Ringbuffer {
                            std::unique_lock<std::mutex> const &) const;
   void update_cumulative(nsecs_t now, uint64_t &count,
                          std::array<uint64_t, HIST_V_SIZE> &bins) const;
+  void drain_staging(std::unique_lock<std::mutex> const &) const;
+  void commit_frame(drm_msm_hist const &frame, nsecs_t now) const;
+
+  // Wait-free staging ring between the single histogram-event producer and the collectors.
+  // insert() publishes into the staging ring without taking the mutex; entries are drained
+  // into the deque by whichever collector holds it. Size must be a power of two.
+  static constexpr size_t kStagingSize = 64;
+  struct StagingEntry {
+    drm_msm_hist histogram;
+    nsecs_t timestamp;
+  };
+  std::array<StagingEntry, kStagingSize> mutable staging;
+  std::atomic<size_t> mutable staging_head{0};  // next write slot, producer only
+  std::atomic<size_t> mutable staging_tail{0};  // next read slot, updated under mutex
 
   std::mutex mutable mutex;
   struct HistogramEntry {
@@ -75,12 +95,18 @@ class Ringbuffer {
     nsecs_t start_timestamp;
     nsecs_t end_timestamp;
   };
-  std::deque<HistogramEntry> ringbuffer;
+  std::deque<HistogramEntry> mutable ringbuffer;
   size_t rb_max_size;
   std::unique_ptr<TimeKeeper> const timekeeper;
 
-  uint64_t cumulative_frame_count;
-  std::array<uint64_t, HIST_V_SIZE> cumulative_bins;
+  uint64_t mutable cumulative_frame_count;
+  std::array<uint64_t, HIST_V_SIZE> mutable cumulative_bins;
+
+  // Running time-weighted sum of every completed frame currently in the ringbuffer (all
+  // entries except the still-displayed front). Contributions are added when a frame gets its
+  // end timestamp and subtracted when it is evicted, so whole-buffer collects only need to
+  // weight the front frame instead of rescanning the deque.
+  std::array<uint64_t, HIST_V_SIZE> mutable window_bins;
 };
 
 }  // namespace histogram
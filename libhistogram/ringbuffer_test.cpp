@@ -133,6 +133,34 @@ TEST_F(RingbufferTestCases, SimpleTest) {
   }
 }
 
+TEST_F(RingbufferTestCases, InPlaceInsertMatchesCopyingInsert) {
+  auto rb = histogram::Ringbuffer::create(3, std::make_unique<TickingTimeKeeper>());
+
+  *rb->begin_insert() = frame0;
+  rb->finish_insert();
+  *rb->begin_insert() = frame1;
+  rb->finish_insert();
+
+  std::tie(numFrames, bins) = rb->collect_ringbuffer_all();
+  EXPECT_THAT(numFrames, Eq(2));
+}
+
+TEST_F(RingbufferTestCases, AbandonedInPlaceInsertIsNotPublished) {
+  auto rb = histogram::Ringbuffer::create(3, std::make_unique<TickingTimeKeeper>());
+
+  *rb->begin_insert() = frame0;
+  // No finish_insert(); the slot must not become visible.
+
+  std::tie(numFrames, bins) = rb->collect_ringbuffer_all();
+  EXPECT_THAT(numFrames, Eq(0));
+
+  *rb->begin_insert() = frame1;
+  rb->finish_insert();
+
+  std::tie(numFrames, bins) = rb->collect_ringbuffer_all();
+  EXPECT_THAT(numFrames, Eq(1));
+}
+
 TEST_F(RingbufferTestCases, TestEvictionSingle) {
   int fill_frame0 = 9;
   int fill_frame1 = 111;
@@ -407,6 +435,33 @@ TEST_F(RingbufferTestCases, TimeWeightingTest) {
   }
 }
 
+TEST_F(RingbufferTestCases, StagedInsertionsVisibleToCollection) {
+  auto tk = std::make_shared<TickingTimeKeeper>();
+  auto rb = histogram::Ringbuffer::create(4, std::make_unique<TimeKeeperWrapper>(tk));
+
+  // Insertions are staged lock-free and only folded in when a collection runs.
+  insertFrameIncrementTimeline(*rb, *tk, frame0);
+  insertFrameIncrementTimeline(*rb, *tk, frame1);
+
+  std::tie(numFrames, bins) = rb->collect_ringbuffer_all();
+  EXPECT_THAT(numFrames, Eq(2));
+  EXPECT_THAT(bins, Each(fill_frame0 + fill_frame1));
+}
+
+TEST_F(RingbufferTestCases, StagingOverflowFallsBackToDirectInsertion) {
+  static constexpr auto numInsertions = 200u;  // larger than the internal staging ring
+  auto tk = std::make_shared<TickingTimeKeeper>();
+  auto rb = histogram::Ringbuffer::create(2, std::make_unique<TimeKeeperWrapper>(tk));
+
+  for (auto i = 0u; i < numInsertions; i++) {
+    insertFrameIncrementTimeline(*rb, *tk, frame1);
+  }
+
+  std::tie(numFrames, bins) = rb->collect_ringbuffer_all();
+  EXPECT_THAT(numFrames, Eq(2));
+  EXPECT_THAT(bins, Each(2 * fill_frame1));
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
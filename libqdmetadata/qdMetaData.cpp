@@ -28,6 +28,7 @@
  */
 
 #include "qdMetaData.h"
+#include "qdMetaDataDirect.h"
 
 #include <QtiGrallocPriv.h>
 #include <errno.h>
@@ -571,6 +572,116 @@ int getMetaDataVa(MetaData_t *data, DispFetchParamType paramType,
     return ret;
 }
 
+// Fields with a direct in-region representation for the writer side. UPDATE_BUFFER_GEOMETRY
+// and UPDATE_COLOR_SPACE are stored converted (crop rect / ColorMetaData) and stay on the
+// copying API.
+static void *getFieldPtr(MetaData_t *data, enum DispParamType paramType) {
+  switch (paramType) {
+    case PP_PARAM_INTERLACED:
+      return &data->interlaced;
+    case UPDATE_REFRESH_RATE:
+      return &data->refreshrate;
+    case MAP_SECURE_BUFFER:
+      return &data->mapSecureBuffer;
+    case S3D_FORMAT:
+      return &data->s3dFormat;
+    case LINEAR_FORMAT:
+      return &data->linearFormat;
+    case SET_SINGLE_BUFFER_MODE:
+      return &data->isSingleBufferMode;
+    case SET_VT_TIMESTAMP:
+      return &data->vtTimeStamp;
+    case COLOR_METADATA:
+      return &data->color;
+    case SET_UBWC_CR_STATS_INFO:
+      return data->ubwcCRStats;
+    case SET_VIDEO_PERF_MODE:
+      return &data->isVideoPerfMode;
+    case SET_GRAPHICS_METADATA:
+      return &data->graphics_metadata;
+    case SET_CVP_METADATA:
+      return &data->cvpMetadata;
+    case SET_VIDEO_HISTOGRAM_STATS:
+      return &data->video_histogram_stats;
+    case SET_VIDEO_TS_INFO:
+      return &data->videoTsInfo;
+    default:
+      return nullptr;
+  }
+}
+
+static const void *getFieldPtr(MetaData_t *data, enum DispFetchParamType paramType) {
+  switch (paramType) {
+    case GET_PP_PARAM_INTERLACED:
+      return &data->interlaced;
+    case GET_REFRESH_RATE:
+      return &data->refreshrate;
+    case GET_MAP_SECURE_BUFFER:
+      return &data->mapSecureBuffer;
+    case GET_S3D_FORMAT:
+      return &data->s3dFormat;
+    case GET_LINEAR_FORMAT:
+      return &data->linearFormat;
+    case GET_SINGLE_BUFFER_MODE:
+      return &data->isSingleBufferMode;
+    case GET_VT_TIMESTAMP:
+      return &data->vtTimeStamp;
+    case GET_COLOR_METADATA:
+      return &data->color;
+    case GET_UBWC_CR_STATS_INFO:
+      return data->ubwcCRStats;
+    case GET_VIDEO_PERF_MODE:
+      return &data->isVideoPerfMode;
+    case GET_GRAPHICS_METADATA:
+      return &data->graphics_metadata;
+    case GET_CVP_METADATA:
+      return &data->cvpMetadata;
+    case GET_VIDEO_HISTOGRAM_STATS:
+      return &data->video_histogram_stats;
+    case GET_VIDEO_TS_INFO:
+      return &data->videoTsInfo;
+    default:
+      return nullptr;
+  }
+}
+
+void *getMetaDataWriterVa(MetaData_t *data, enum DispParamType paramType) {
+  if (data == nullptr)
+    return nullptr;
+
+  void *field = getFieldPtr(data, paramType);
+  if (field) {
+    setGralloc4Array(data, paramType, true);
+  }
+  return field;
+}
+
+const void *getMetaDataReaderVa(MetaData_t *data, enum DispFetchParamType paramType) {
+  if (data == nullptr)
+    return nullptr;
+
+  if (!getGralloc4Array(data, paramType)) {
+    // Field was never set; hand out nothing rather than stale region contents.
+    return nullptr;
+  }
+  return getFieldPtr(data, paramType);
+}
+
+int setMetaDataStateVa(MetaData_t *data, enum DispParamType paramType, int is_set) {
+  if (data == nullptr)
+    return -EINVAL;
+
+  setGralloc4Array(data, paramType, is_set != 0);
+  return 0;
+}
+
+int getMetaDataStateVa(MetaData_t *data, enum DispFetchParamType paramType) {
+  if (data == nullptr)
+    return -EINVAL;
+
+  return getGralloc4Array(data, paramType) ? 1 : 0;
+}
+
 int copyMetaData(struct private_handle_t *src, struct private_handle_t *dst) {
     auto err = validateAndMap(src);
     if (err != 0)
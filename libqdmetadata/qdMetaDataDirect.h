@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef _QDMETADATADIRECT_H
+#define _QDMETADATADIRECT_H
+
+#include "qdMetaData.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Copy-free views into a mapped MetaData_t region for clients that touch metadata on every
+ * frame. The returned pointers alias the mapped region directly, so the structure copies that
+ * setMetaDataVa/getMetaDataVa pay in both directions are skipped.
+ *
+ * Consistency follows the existing Va contract: the region is single-writer and neither path
+ * takes a lock, so a writer must finish updating the field before publishing the buffer to a
+ * reader. Field-granular dirty tracking uses the same set-status bits the copying API
+ * maintains, so the two APIs can be mixed freely on one buffer.
+ */
+
+/* Returns a writable pointer to the field backing paramType and marks the field set, or NULL
+ * if the field has no direct representation. The caller owns filling the field completely
+ * before the buffer is handed to a reader. */
+void *getMetaDataWriterVa(MetaData_t *data, enum DispParamType paramType);
+
+/* Returns a read-only pointer to the field backing paramType, or NULL if the field was never
+ * set or has no direct representation. */
+const void *getMetaDataReaderVa(MetaData_t *data, enum DispFetchParamType paramType);
+
+/* Dirty tracking without a data access: mark a field set/unset, or query it. setMetaDataVa
+ * with a NULL param clears the payload as well; this only flips the status bit. */
+int setMetaDataStateVa(MetaData_t *data, enum DispParamType paramType, int is_set);
+int getMetaDataStateVa(MetaData_t *data, enum DispFetchParamType paramType);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _QDMETADATADIRECT_H */
@@ -129,6 +129,8 @@ public:
       SET_DEMURA_STATE = 60,                   // Enable/disable demura feature
       SET_DEMURA_CONFIG = 61,                  // Set the demura configuration index
       SET_BPP_MODE = 62,                       // Set Panel bpp to 24bpp or 30bpp
+      NOTIFY_APP_LAUNCH = 63,                  // Hint that an app launch transition is imminent
+      GET_FRAME_DROP_STATS = 64,               // Get late-frame counters by root cause
       COMMAND_LIST_END = 400,
     };
 
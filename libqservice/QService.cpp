@@ -30,11 +30,23 @@
 #include <QService.h>
 #include <binder/Parcel.h>
 #include <binder/IPCThreadState.h>
+#include <utils/String8.h>
+#include <utils/Timers.h>
+#include <chrono>
 
 #define QSERVICE_DEBUG 0
 
 using namespace android;
 
+namespace {
+// Dispatches slower than this are logged with the queue depth seen at entry
+const uint32_t DISPATCH_THRESHOLD_US = 100000;
+// Upper bounds of the latency histogram buckets, in microseconds
+const uint32_t LATENCY_BUCKET_LIMITS_US[] = {1000, 5000, 20000, 50000, 100000};
+// How long a slow command waits for in-flight fast commands to drain
+const int SLOW_LANE_YIELD_MS = 100;
+}
+
 namespace qService {
 
 QService* QService::sQService = NULL;
@@ -59,6 +71,52 @@ void QService::connect(const sp<qClient::IQHDMIClient>& client) {
     mHDMIClient = client;
 }
 
+bool QService::isSlowCommand(uint32_t command) {
+    // Calibration and session-transition commands known to hold the pipeline
+    // for tens of ms; they take the slow lane so latency-critical controls
+    // never queue behind them
+    switch (command) {
+        case IQService::QDCM_SVC_CMDS:
+        case IQService::SET_DISPLAY_MODE:
+        case IQService::NOTIFY_TUI_TRANSITION:
+        case IQService::RETRIEVE_DEMURATN_FILES:
+        case IQService::DUMP_CODE_COVERAGE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void QService::recordDispatch(uint32_t command, uint32_t duration_us,
+        uint32_t queue_depth) {
+    if (command >= IQService::COMMAND_LIST_END)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mStatsLock);
+        DispatchStats& stats = mStats[command];
+        stats.count++;
+        stats.total_us += duration_us;
+        if (duration_us > stats.max_us)
+            stats.max_us = duration_us;
+        int bucket = NUM_LATENCY_BUCKETS - 1;
+        for (int i = 0; i < NUM_LATENCY_BUCKETS - 1; i++) {
+            if (duration_us < LATENCY_BUCKET_LIMITS_US[i]) {
+                bucket = i;
+                break;
+            }
+        }
+        stats.buckets[bucket]++;
+        if (duration_us >= DISPATCH_THRESHOLD_US)
+            stats.over_threshold++;
+    }
+
+    if (duration_us >= DISPATCH_THRESHOLD_US) {
+        ALOGW("%s: Command %u took %u ms with %u commands in flight at entry",
+                __FUNCTION__, command, duration_us / 1000, queue_depth);
+    }
+}
+
 status_t QService::dispatch(uint32_t command, const Parcel* inParcel,
         Parcel* outParcel) {
     status_t err = (status_t) FAILED_TRANSACTION;
@@ -69,7 +127,25 @@ status_t QService::dispatch(uint32_t command, const Parcel* inParcel,
         inParcel->setDataPosition(0);
     if (mClient.get()) {
         ALOGD_IF(QSERVICE_DEBUG, "Dispatching command: %d", command);
-        err = mClient->notifyCallback(command, inParcel, outParcel);
+        uint32_t queue_depth = (uint32_t) mInflight.fetch_add(1);
+        nsecs_t start = systemTime(SYSTEM_TIME_MONOTONIC);
+        if (isSlowCommand(command)) {
+            // One slow command at a time, and it yields (bounded) to fast
+            // commands already in flight
+            std::unique_lock<std::mutex> lane(mSlowLaneLock);
+            mSlowLaneCv.wait_for(lane, std::chrono::milliseconds(SLOW_LANE_YIELD_MS),
+                    [this] { return mFastInflight.load() == 0; });
+            err = mClient->notifyCallback(command, inParcel, outParcel);
+        } else {
+            mFastInflight.fetch_add(1);
+            err = mClient->notifyCallback(command, inParcel, outParcel);
+            if (mFastInflight.fetch_sub(1) == 1)
+                mSlowLaneCv.notify_all();
+        }
+        uint32_t duration_us =
+                (uint32_t) ns2us(systemTime(SYSTEM_TIME_MONOTONIC) - start);
+        mInflight.fetch_sub(1);
+        recordDispatch(command, duration_us, queue_depth);
         //Rewind parcel in case we're calling from the same process
         if (sameProcess)
             outParcel->setDataPosition(0);
@@ -77,6 +153,27 @@ status_t QService::dispatch(uint32_t command, const Parcel* inParcel,
     return err;
 }
 
+status_t QService::dump(int fd, const Vector<String16>& /*args*/) {
+    String8 result;
+    result.appendFormat("QService dispatch stats "
+            "(buckets: <1ms <5ms <20ms <50ms <100ms >=100ms)\n");
+    std::lock_guard<std::mutex> lock(mStatsLock);
+    for (uint32_t cmd = 0; cmd < IQService::COMMAND_LIST_END; cmd++) {
+        const DispatchStats& stats = mStats[cmd];
+        if (!stats.count)
+            continue;
+        result.appendFormat("  cmd %3u: count %u avg %llu us max %u us"
+                " over-threshold %u |", cmd, stats.count,
+                (unsigned long long) (stats.total_us / stats.count),
+                stats.max_us, stats.over_threshold);
+        for (int i = 0; i < NUM_LATENCY_BUCKETS; i++)
+            result.appendFormat(" %u", stats.buckets[i]);
+        result.append("\n");
+    }
+    write(fd, result.c_str(), result.size());
+    return NO_ERROR;
+}
+
 void QService::onHdmiHotplug(int connected) {
     if(mHDMIClient.get()) {
         ALOGD_IF(QSERVICE_DEBUG, "%s: HDMI hotplug", __FUNCTION__);
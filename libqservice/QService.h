@@ -36,6 +36,9 @@
 #include <binder/IServiceManager.h>
 #include <IQService.h>
 #include <IQClient.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 struct hwc_context_t;
 
@@ -52,11 +55,39 @@ public:
             android::Parcel* reply);
     virtual void onHdmiHotplug(int connected);
     virtual void onCECMessageReceived(char *msg, ssize_t len);
+    virtual android::status_t dump(int fd, const android::Vector<android::String16>& args);
     static void init();
 private:
+    // Latency histogram buckets: <1ms <5ms <20ms <50ms <100ms >=100ms
+    static const int NUM_LATENCY_BUCKETS = 6;
+    struct DispatchStats {
+        uint32_t count = 0;
+        uint64_t total_us = 0;
+        uint32_t max_us = 0;
+        uint32_t over_threshold = 0;
+        uint32_t buckets[NUM_LATENCY_BUCKETS] = {};
+    };
+
     QService();
+    static bool isSlowCommand(uint32_t command);
+    void recordDispatch(uint32_t command, uint32_t duration_us, uint32_t queue_depth);
+
     android::sp<qClient::IQClient> mClient;
     android::sp<qClient::IQHDMIClient> mHDMIClient;
+
+    // Per-opcode latency accounting, guarded by mStatsLock
+    std::mutex mStatsLock;
+    DispatchStats mStats[IQService::COMMAND_LIST_END];
+
+    // Commands in flight through dispatch, sampled as queue depth at entry
+    std::atomic<int> mInflight{0};
+    // Priority lane: slow calibration commands serialize on mSlowLaneLock and
+    // yield to fast commands already in flight, so refresh controls are never
+    // queued behind a 100ms+ calibration call
+    std::atomic<int> mFastInflight{0};
+    std::mutex mSlowLaneLock;
+    std::condition_variable mSlowLaneCv;
+
     static QService *sQService;
 };
 }; // namespace qService
@@ -27,6 +27,7 @@
  *IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <unistd.h>
 #include <sstream>
 #include <iomanip>
 #include <string>
@@ -142,44 +143,35 @@ int FileFinderOemExtn::FindFileData(const GenericPayload &in, GenericPayload *ou
 
 DemuraFilePaths FileFinderOemExtn::getSrcFilePaths(const std::string &panel_id_hex_str) {
   DemuraFilePaths paths = {};
-  FILE *calib_file = NULL;
-  FILE *signature_file = NULL;
-  FILE *publickey_file = NULL;
 
-  // Build path strings and check if the file is available
+  // Build path strings and check if the file is readable; access() avoids
+  // opening the (potentially large) calibration files just to probe them.
   std::string sp = LOCAL_SOURCE_PATH;
   errno = 0;
   std::string src_path_calib = sp + "demura_config_" + panel_id_hex_str;
-  calib_file = fopen(src_path_calib.c_str(), "rb");
-
   std::string src_path_sig = sp + "demura_signature_" + panel_id_hex_str;
-  signature_file = fopen(src_path_sig.c_str(), "rb");
-
   std::string src_path_pk = sp + "demura_publickey_" + panel_id_hex_str;
-  publickey_file = fopen(src_path_pk.c_str(), "rb");
 
   // Get files OTA if any file is missing
-  if (calib_file == NULL || signature_file == NULL || publickey_file == NULL) {
+  if (access(src_path_calib.c_str(), R_OK) || access(src_path_sig.c_str(), R_OK) ||
+      access(src_path_pk.c_str(), R_OK)) {
     DLOGW("Failed to open files locally, attempting OTA");
     paths = getFileOTA(panel_id_hex_str);
     errno = 0;
-    calib_file = fopen(paths.configFilePath.c_str(), "rb");
-    if (calib_file == NULL) {
-      paths.configFilePath = "";
+    if (access(paths.configFilePath.c_str(), R_OK)) {
       DLOGE("Failed to open file after OTA at %s. Error = %s", paths.configFilePath.c_str(),
             strerror(errno));
+      paths.configFilePath = "";
     }
-    signature_file = fopen(paths.signatureFilePath.c_str(), "rb");
-    if (signature_file == NULL) {
-      paths.signatureFilePath = "";
+    if (access(paths.signatureFilePath.c_str(), R_OK)) {
       DLOGE("Failed to open file after OTA at %s. Error = %s", paths.signatureFilePath.c_str(),
             strerror(errno));
+      paths.signatureFilePath = "";
     }
-    publickey_file = fopen(paths.publickeyFilePath.c_str(), "rb");
-    if (publickey_file == NULL) {
-      paths.publickeyFilePath = "";
+    if (access(paths.publickeyFilePath.c_str(), R_OK)) {
       DLOGE("Failed to open file after OTA at %s. Error = %s", paths.publickeyFilePath.c_str(),
             strerror(errno));
+      paths.publickeyFilePath = "";
     }
   } else {
     paths.configFilePath = src_path_calib;
@@ -187,16 +179,6 @@ DemuraFilePaths FileFinderOemExtn::getSrcFilePaths(const std::string &panel_id_h
     paths.publickeyFilePath = src_path_pk;
   }
 
-  if (calib_file != NULL) {
-    fclose(calib_file);
-  }
-  if (signature_file != NULL) {
-    fclose(signature_file);
-  }
-  if (publickey_file != NULL) {
-    fclose(publickey_file);
-  }
-
   return paths;
 }
 
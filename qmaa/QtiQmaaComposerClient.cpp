@@ -69,6 +69,18 @@ bool QtiQmaaComposerClient::init() {
     return false;
   }
 
+  // Opt-in timing emulation for hardware-less performance CI: virtual vsync,
+  // emulated commit latency and sw_sync-backed present fences.
+  int64_t display = static_cast<int64_t>(DisplayConnectionType::INTERNAL);
+  if (timing_emulator_.Init(default_variable_config_.vsync_period_ns,
+                            [this, display](int64_t timestamp_ns, int32_t period_ns) {
+                              OnVsync(this, display, timestamp_ns, period_ns);
+                            })) {
+    // Report the emulated period so SF schedules against the same grid
+    default_variable_config_.vsync_period_ns = timing_emulator_.GetVsyncPeriodNs();
+    default_variable_config_.fps = 1000000000 / timing_emulator_.GetVsyncPeriodNs();
+  }
+
   return true;
 }
 
@@ -400,6 +412,9 @@ ScopedAStatus QtiQmaaComposerClient::setReadbackBuffer(
 }
 
 ScopedAStatus QtiQmaaComposerClient::setVsyncEnabled(int64_t in_display, bool in_enabled) {
+  if (timing_emulator_.Enabled()) {
+    timing_emulator_.SetVsyncEnabled(in_enabled);
+  }
   return TO_BINDER_STATUS(INT32(Error::None));
 }
 ScopedAStatus QtiQmaaComposerClient::setIdleTimerEnabled(int64_t in_display, int32_t in_timeoutMs) {
@@ -691,9 +706,13 @@ void QtiQmaaComposerClient::CommandEngine::executePresentOrValidateDisplay(
   // First try to Present as is.
   mClient.getCapabilities();
   if (mClient.hasCapability(Capability::SKIP_VALIDATE)) {
-    auto err = Error::None;
+    auto err = presentDisplay(display);
     if (err == Error::None) {
       mWriter->setPresentOrValidateResult(display, PresentOrValidate::Result::Presented);
+      if (mClient.timing_emulator_.Enabled()) {
+        mWriter->setPresentFence(
+            display, ::ndk::ScopedFileDescriptor(mClient.timing_emulator_.CreatePresentFence()));
+      }
       return;
     }
   }
@@ -716,6 +735,11 @@ void QtiQmaaComposerClient::CommandEngine::executePresentOrValidateDisplay(
 void QtiQmaaComposerClient::CommandEngine::executeAcceptDisplayChanges(int64_t display) {}
 
 Error QtiQmaaComposerClient::CommandEngine::presentDisplay(int64_t display) {
+  // Under emulation a present costs a reproducible slice of time, like a real
+  // commit blocking in the kernel
+  if (mClient.timing_emulator_.Enabled()) {
+    mClient.timing_emulator_.EmulateCommitLatency();
+  }
   return Error::None;
 }
 
@@ -723,6 +747,11 @@ void QtiQmaaComposerClient::CommandEngine::executePresentDisplay(int64_t display
   auto err = presentDisplay(display);
   if (err != Error::None) {
     writeError(__FUNCTION__, err);
+    return;
+  }
+  if (mClient.timing_emulator_.Enabled()) {
+    mWriter->setPresentFence(
+        display, ::ndk::ScopedFileDescriptor(mClient.timing_emulator_.CreatePresentFence()));
   }
 }
 
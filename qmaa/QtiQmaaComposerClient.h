@@ -34,6 +34,7 @@
 #include <aidl/android/hardware/graphics/composer3/Capability.h>
 #include "QtiQmaaComposerHandleImporter.h"
 #include "QtiQmaaComposerServiceWriter.h"
+#include "QtiQmaaTimingEmulator.h"
 #define INT32(exp) static_cast<int32_t>(exp)
 
 namespace aidl {
@@ -423,6 +424,7 @@ class QtiQmaaComposerClient : public BnComposerClient {
   std::function<void()> mOnClientDestroyed;
   std::unordered_map<Display, DisplayData> mDisplayData;
   QMAADisplayConfigVariableInfo default_variable_config_ = {};
+  QtiQmaaTimingEmulator timing_emulator_;
 };
 
 }  // namespace composer3
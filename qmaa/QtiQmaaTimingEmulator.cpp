@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include "QtiQmaaTimingEmulator.h"
+
+#include <cutils/properties.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <linux/types.h>
+#include <log/log.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <chrono>
+
+namespace aidl {
+namespace vendor {
+namespace qti {
+namespace hardware {
+namespace display {
+namespace composer3 {
+
+namespace {
+
+// sw_sync is the kernel's debug timeline for exactly this use case: userspace-driven
+// fences. Definitions are local because the uapi header is not exported everywhere.
+struct sw_sync_create_fence_data {
+  __u32 value;
+  char name[32];
+  __s32 fence;
+};
+
+#define SW_SYNC_IOC_MAGIC 'W'
+#define SW_SYNC_IOC_CREATE_FENCE _IOWR(SW_SYNC_IOC_MAGIC, 0, struct sw_sync_create_fence_data)
+#define SW_SYNC_IOC_INC _IOW(SW_SYNC_IOC_MAGIC, 1, __u32)
+
+int64_t GetMonotonicNs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+}  // namespace
+
+QtiQmaaTimingEmulator::~QtiQmaaTimingEmulator() {
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    exit_ = true;
+    cv_.notify_all();
+  }
+  if (vsync_thread_.joinable()) {
+    vsync_thread_.join();
+  }
+  if (timeline_fd_ >= 0) {
+    close(timeline_fd_);
+  }
+}
+
+bool QtiQmaaTimingEmulator::Init(uint32_t default_vsync_period_ns, VsyncCallback vsync_cb) {
+  char value[PROPERTY_VALUE_MAX] = {};
+  property_get("vendor.display.qmaa.emulate_timing", value, "0");
+  enabled_ = (atoi(value) == 1);
+  if (!enabled_) {
+    return false;
+  }
+
+  property_get("vendor.display.qmaa.vsync_period_ns", value, "0");
+  vsync_period_ns_ = (uint32_t)atoi(value);
+  if (!vsync_period_ns_) {
+    vsync_period_ns_ = default_vsync_period_ns;
+  }
+
+  property_get("vendor.display.qmaa.commit_latency_us", value, "0");
+  commit_latency_us_ = (uint32_t)atoi(value);
+  property_get("vendor.display.qmaa.commit_jitter_us", value, "0");
+  commit_jitter_us_ = (uint32_t)atoi(value);
+  property_get("vendor.display.qmaa.timing_seed", value, "1");
+  rng_state_ = (uint64_t)atoll(value);
+
+  // Try the debugfs node first; newer kernels expose /dev/sw_sync instead.
+  timeline_fd_ = open("/sys/kernel/debug/sync/sw_sync", O_RDWR);
+  if (timeline_fd_ < 0) {
+    timeline_fd_ = open("/dev/sw_sync", O_RDWR);
+  }
+  if (timeline_fd_ < 0) {
+    ALOGW("%s: No sw_sync timeline available, present fences will be omitted", __FUNCTION__);
+  }
+
+  // Align the vsync grid to the next period boundary so timestamps are exact
+  // multiples of the period and runs are comparable.
+  epoch_ns_ = ((GetMonotonicNs() / vsync_period_ns_) + 1) * vsync_period_ns_;
+  vsync_cb_ = vsync_cb;
+  vsync_thread_ = std::thread(&QtiQmaaTimingEmulator::VsyncLoop, this);
+
+  ALOGI("%s: Timing emulation on: period %u ns, commit latency %u +/- %u us, seed %" PRIu64,
+        __FUNCTION__, vsync_period_ns_, commit_latency_us_, commit_jitter_us_, rng_state_);
+  return true;
+}
+
+void QtiQmaaTimingEmulator::SetVsyncEnabled(bool enabled) {
+  std::lock_guard<std::mutex> l(lock_);
+  vsync_enabled_ = enabled;
+  cv_.notify_all();
+}
+
+uint64_t QtiQmaaTimingEmulator::NextRandom() {
+  // Fixed-constant LCG so the latency sequence replays identically per seed
+  rng_state_ = rng_state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+  return rng_state_ >> 33;
+}
+
+void QtiQmaaTimingEmulator::EmulateCommitLatency() {
+  if (!commit_latency_us_ && !commit_jitter_us_) {
+    return;
+  }
+
+  int64_t latency_us = commit_latency_us_;
+  if (commit_jitter_us_) {
+    std::lock_guard<std::mutex> l(lock_);
+    latency_us += (int64_t)(NextRandom() % (2 * commit_jitter_us_ + 1)) - commit_jitter_us_;
+  }
+  if (latency_us > 0) {
+    usleep((useconds_t)latency_us);
+  }
+}
+
+int QtiQmaaTimingEmulator::CreatePresentFence() {
+  if (timeline_fd_ < 0) {
+    return -1;
+  }
+
+  struct sw_sync_create_fence_data data = {};
+  {
+    std::lock_guard<std::mutex> l(lock_);
+    // Signals when the vsync thread retires the upcoming tick
+    data.value = ticks_ + 1;
+  }
+  snprintf(data.name, sizeof(data.name), "qmaa-present-%u", data.value);
+  if (ioctl(timeline_fd_, SW_SYNC_IOC_CREATE_FENCE, &data) < 0) {
+    ALOGE("%s: Failed to create fence at %u: %s", __FUNCTION__, data.value, strerror(errno));
+    return -1;
+  }
+  return data.fence;
+}
+
+void QtiQmaaTimingEmulator::VsyncLoop() {
+  std::unique_lock<std::mutex> l(lock_);
+  while (!exit_) {
+    int64_t target_ns = epoch_ns_ + (int64_t)(ticks_ + 1) * vsync_period_ns_;
+    auto deadline = std::chrono::steady_clock::time_point(std::chrono::nanoseconds(target_ns));
+    if (cv_.wait_until(l, deadline) != std::cv_status::timeout) {
+      continue;  // Woken for enable/exit; recompute state
+    }
+
+    ticks_++;
+    if (timeline_fd_ >= 0) {
+      __u32 inc = 1;
+      ioctl(timeline_fd_, SW_SYNC_IOC_INC, &inc);
+    }
+
+    if (vsync_enabled_ && vsync_cb_) {
+      VsyncCallback cb = vsync_cb_;
+      l.unlock();
+      // Report the grid time, not wakeup time, so consumers see zero jitter
+      cb(target_ns, (int32_t)vsync_period_ns_);
+      l.lock();
+    }
+  }
+}
+
+}  // namespace composer3
+}  // namespace display
+}  // namespace hardware
+}  // namespace qti
+}  // namespace vendor
+}  // namespace aidl
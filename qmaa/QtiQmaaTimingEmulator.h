@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace aidl {
+namespace vendor {
+namespace qti {
+namespace hardware {
+namespace display {
+namespace composer3 {
+
+// Deterministic timing emulation for the QMAA stub composer. When enabled via
+// vendor.display.qmaa.emulate_timing, the stub behaves like a panel with real timing:
+// vsync callbacks tick on a fixed monotonic grid, present fences signal on the next
+// emulated vsync through a sw_sync timeline, and each commit costs a reproducible
+// pseudo-random latency drawn from a seeded distribution. This lets performance CI
+// exercise the full SurfaceFlinger <-> composer AIDL surface on machines without
+// display hardware and still measure client/command-processing latency.
+class QtiQmaaTimingEmulator {
+ public:
+  using VsyncCallback = std::function<void(int64_t timestamp_ns, int32_t period_ns)>;
+
+  ~QtiQmaaTimingEmulator();
+
+  // Reads the emulation properties and starts the vsync thread. Returns true only
+  // when emulation is enabled; everything else is then safe to call.
+  bool Init(uint32_t default_vsync_period_ns, VsyncCallback vsync_cb);
+  bool Enabled() const { return enabled_; }
+  uint32_t GetVsyncPeriodNs() const { return vsync_period_ns_; }
+
+  void SetVsyncEnabled(bool enabled);
+
+  // Blocks the caller for the next sample of the configured latency distribution,
+  // mirroring the time a real commit spends in the kernel. Samples come from a
+  // seeded generator so a CI run sees the same sequence every time.
+  void EmulateCommitLatency();
+
+  // Returns a fence fd that signals on the upcoming emulated vsync, or -1 when no
+  // sw_sync timeline is available (callers already treat -1 as "no fence").
+  int CreatePresentFence();
+
+ private:
+  void VsyncLoop();
+  uint64_t NextRandom();
+
+  bool enabled_ = false;
+  uint32_t vsync_period_ns_ = 0;
+  int64_t epoch_ns_ = 0;
+  uint32_t commit_latency_us_ = 0;
+  uint32_t commit_jitter_us_ = 0;
+  uint64_t rng_state_ = 0;
+
+  VsyncCallback vsync_cb_ = nullptr;
+  std::thread vsync_thread_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool vsync_enabled_ = false;
+  bool exit_ = false;
+
+  int timeline_fd_ = -1;
+  uint32_t ticks_ = 0;  // Vsyncs signalled on the timeline so far
+};
+
+}  // namespace composer3
+}  // namespace display
+}  // namespace hardware
+}  // namespace qti
+}  // namespace vendor
+}  // namespace aidl
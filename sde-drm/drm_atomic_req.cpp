@@ -65,11 +65,14 @@
 
 #include <drm_logger.h>
 
+#include <algorithm>
+
 #include "drm_atomic_req.h"
 #include "drm_connector.h"
 #include "drm_crtc.h"
 #include "drm_manager.h"
 #include "drm_plane.h"
+#include "drm_utils.h"
 #include "string.h"
 
 #define __CLASS__ "DRMAtomicReq"
@@ -87,6 +90,13 @@ DRMAtomicReq::~DRMAtomicReq() {
 
 int DRMAtomicReq::Init(const DRMDisplayToken &tok) {
   token_ = tok;
+  if (drm_atomic_req_) {
+    // Recycled from the DRMManager pool; the libdrm buffer keeps the capacity it grew to for
+    // the previous display, so rebinding to a new token costs no allocation.
+    drmModeAtomicSetCursor(drm_atomic_req_, 0);
+    return 0;
+  }
+
   drm_atomic_req_ = drmModeAtomicAlloc();
   if (!drm_atomic_req_) {
     return -ENOMEM;
@@ -95,9 +105,50 @@ int DRMAtomicReq::Init(const DRMDisplayToken &tok) {
   return 0;
 }
 
+void DRMAtomicReq::PreAllocate(uint32_t num_props) {
+  if (!drm_atomic_req_ || !num_props) {
+    return;
+  }
+
+  // libdrm exposes no reserve call and grows the request by realloc as properties are staged.
+  // Stage num_props placeholder entries to force the buffer to its final size once, then rewind
+  // the cursor; entries behind the cursor are never submitted to the kernel.
+  for (uint32_t i = 0; i < num_props; i++) {
+    drmModeAtomicAddProperty(drm_atomic_req_, 0 /* obj_id */, 0 /* prop_id */, 0 /* value */);
+  }
+  drmModeAtomicSetCursor(drm_atomic_req_, 0);
+}
+
 int DRMAtomicReq::Perform(DRMOps opcode, uint32_t obj_id, ...) {
   va_list args;
   va_start(args, obj_id);
+  int ret = PerformInternal(opcode, obj_id, args);
+  va_end(args);
+  return ret;
+}
+
+int DRMAtomicReq::PerformBatch(const DRMAtomicOp *ops, uint32_t num_ops) {
+  if (!ops) {
+    return -EINVAL;
+  }
+
+  for (uint32_t i = 0; i < num_ops; i++) {
+    const DRMAtomicOp &op = ops[i];
+    PerformOp(op.op_code, op.obj_id, op.args[0], op.args[1], op.args[2], op.args[3]);
+  }
+
+  return 0;
+}
+
+int DRMAtomicReq::PerformOp(DRMOps opcode, uint32_t obj_id, ...) {
+  va_list args;
+  va_start(args, obj_id);
+  int ret = PerformInternal(opcode, obj_id, args);
+  va_end(args);
+  return ret;
+}
+
+int DRMAtomicReq::PerformInternal(DRMOps opcode, uint32_t obj_id, va_list args) {
   switch (opcode) {
     case DRMOps::PLANE_SET_SRC_RECT:
     case DRMOps::PLANE_SET_DST_RECT:
@@ -214,7 +265,6 @@ int DRMAtomicReq::Perform(DRMOps opcode, uint32_t obj_id, ...) {
     default:
       DRM_LOGE("Invalid opcode %d", opcode);
   }
-  va_end(args);
   return 0;
 }
 
@@ -231,6 +281,9 @@ int DRMAtomicReq::Validate() {
 
   drm_mgr_->GetPlaneMgr()->PostValidate(token_.crtc_id, !ret);
   drm_mgr_->GetCrtcMgr()->PostValidate(token_.crtc_id, !ret);
+  drm_mgr_->GetConnectorMgr()->PostValidate(token_.conn_id, !ret);
+  high_water_mark_ = std::max(high_water_mark_,
+                              static_cast<uint32_t>(drmModeAtomicGetCursor(drm_atomic_req_)));
   drmModeAtomicSetCursor(drm_atomic_req_, 0);
 
   return ret;
@@ -238,6 +291,11 @@ int DRMAtomicReq::Validate() {
 
 int DRMAtomicReq::Commit(bool synchronous, bool retain_planes) {
   DTRACE_SCOPED();
+  // Note: the commit ioctl must stay on the caller thread. CRTC_GET_RELEASE_FENCE and
+  // CONNECTOR_GET_RETIRE_FENCE stage OUT_FENCE_PTR addresses of variables on the caller's
+  // stack, the kernel writes the fds through them during this ioctl, and every caller reads
+  // those variables as soon as Commit() returns. Deferring the ioctl to a worker would hand
+  // back unpopulated fds; for DRM_MODE_ATOMIC_NONBLOCK the flip itself is already async.
   if (retain_planes) {
     // It is not enough to simply avoid calling UnsetUnusedPlanes, since state transitons have to
     // be correct when CommitPlaneState is called
@@ -259,6 +317,10 @@ int DRMAtomicReq::Commit(bool synchronous, bool retain_planes) {
 
   drm_mgr_->GetPlaneMgr()->PostCommit(token_.crtc_id, !ret);
   drm_mgr_->GetCrtcMgr()->PostCommit(token_.crtc_id, !ret);
+  drm_mgr_->GetConnectorMgr()->PostCommit(token_.conn_id, !ret);
+  DRMBlobStats::RecordCommit();
+  high_water_mark_ = std::max(high_water_mark_,
+                              static_cast<uint32_t>(drmModeAtomicGetCursor(drm_atomic_req_)));
   drmModeAtomicSetCursor(drm_atomic_req_, 0);
 
   return ret;
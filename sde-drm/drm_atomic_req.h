@@ -32,6 +32,7 @@
 
 #include <drm_interface.h>
 #include <drm_utils.h>
+#include <stdarg.h>
 #include <xf86drm.h>
 #include <xf86drmMode.h>
 #include <vector>
@@ -45,12 +46,21 @@ class DRMAtomicReq : public DRMAtomicReqInterface {
   DRMAtomicReq(int fd, DRMManager *drm_manager);
   virtual ~DRMAtomicReq();
   virtual int Perform(DRMOps op_code, uint32_t obj_id, ...);
+  virtual int PerformBatch(const DRMAtomicOp *ops, uint32_t num_ops);
   virtual int Commit(bool synchronous, bool retain_planes);
   virtual int Validate();
   int Init(const DRMDisplayToken &tok);
+  void PreAllocate(uint32_t num_props);
+  uint32_t GetHighWaterMark() { return high_water_mark_; }
 
  private:
+  // Variadic trampoline used by PerformBatch() to re-enter the per-op parsers with the payload
+  // words of a DRMAtomicOp stamped out as varargs.
+  int PerformOp(DRMOps op_code, uint32_t obj_id, ...);
+  int PerformInternal(DRMOps op_code, uint32_t obj_id, va_list args);
   drmModeAtomicReq *drm_atomic_req_ = {};
+  // Largest number of staged properties seen across all frames of this request's lifetime.
+  uint32_t high_water_mark_ = 0;
   DRMManager *drm_mgr_ = {};
   int fd_ = -1;
   DRMDisplayToken token_ = {};
@@ -133,6 +133,21 @@ static uint8_t DRM_MODE_COLORIMETRY_DCI_P3_RGB_THEATER = 12;
 static uint8_t CACHE_STATE_DISABLED = 0;
 static uint8_t CACHE_STATE_ENABLED = 1;
 
+// FNV-1a over a payload passed by pointer, so pointer-valued properties can be
+// deduped on contents rather than address.
+static uint64_t HashPropPayload(const void *payload, size_t size) {
+  if (!payload) {
+    return 0;
+  }
+  const uint8_t *bytes = static_cast<const uint8_t *>(payload);
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
 static void PopulatePowerModes(drmModePropertyRes *prop) {
   for (auto i = 0; i < prop->count_enums; i++) {
     string enum_name(prop->enums[i].name);
@@ -418,6 +433,22 @@ void DRMConnectorManager::Perform(DRMOps code, uint32_t obj_id, drmModeAtomicReq
   it->second->Perform(code, req, args);
 }
 
+void DRMConnectorManager::PostValidate(uint32_t conn_id, bool success) {
+  lock_guard<mutex> lock(lock_);
+  auto it = connector_pool_.find(conn_id);
+  if (it != connector_pool_.end()) {
+    it->second->PostValidate(success);
+  }
+}
+
+void DRMConnectorManager::PostCommit(uint32_t conn_id, bool success) {
+  lock_guard<mutex> lock(lock_);
+  auto it = connector_pool_.find(conn_id);
+  if (it != connector_pool_.end()) {
+    it->second->PostCommit(success);
+  }
+}
+
 int DRMConnectorManager::GetConnectorInfo(uint32_t conn_id, DRMConnectorInfo *info) {
   lock_guard<mutex> lock(lock_);
   int ret = -ENODEV;
@@ -1038,6 +1069,25 @@ int DRMConnector::GetInfo(DRMConnectorInfo *info) {
 
   uint32_t index = UINT32_MAX;
 
+  if (prop_mgr_.IsPropertyAvailable(DRMProperty::EDID)) {
+    index = std::distance(props->props,
+                          std::find(props->props, props->props + props->count_props,
+                                    prop_mgr_.GetPropertyId(DRMProperty::EDID)));
+    ParseCapabilities(props->prop_values[index], &info->edid);
+  }
+
+  // Hotplug storms re-connect the same sink back to back. When the EDID matches the last
+  // parse, reuse the cached mode list and capabilities and skip the blob parsing below.
+  if (info_cache_valid_ && !info->edid.empty() && info->edid == cached_edid_) {
+    bool is_connected = info->is_connected;
+    bool is_reserved = info->is_reserved;
+    *info = cached_info_;
+    info->is_connected = is_connected;
+    info->is_reserved = is_reserved;
+    drmModeFreeObjectProperties(props);
+    return 0;
+  }
+
   if (prop_mgr_.IsPropertyAvailable(DRMProperty::HDR_PROPERTIES)) {
     index = std::distance(props->props,
                           std::find(props->props, props->props + props->count_props,
@@ -1076,13 +1126,6 @@ int DRMConnector::GetInfo(DRMConnectorInfo *info) {
                                     prop_mgr_.GetPropertyId(DRMProperty::TOPOLOGY_CONTROL)));
     info->topology_control = props->prop_values[index];
   }
-  if (prop_mgr_.IsPropertyAvailable(DRMProperty::EDID)) {
-    index = std::distance(props->props,
-                          std::find(props->props, props->props + props->count_props,
-                                    prop_mgr_.GetPropertyId(DRMProperty::EDID)));
-    ParseCapabilities(props->prop_values[index], &info->edid);
-  }
-
   if (prop_mgr_.IsPropertyAvailable(DRMProperty::SUPPORTED_COLORSPACES)) {
     index = std::distance(props->props,
                           std::find(props->props, props->props + props->count_props,
@@ -1097,6 +1140,14 @@ int DRMConnector::GetInfo(DRMConnectorInfo *info) {
     ParseCapabilities(props->prop_values[index], &info->panel_id);
   }
 
+  // Remember the full parse for this sink; connectors without an EDID (builtin panels,
+  // writeback) keep taking the regular path since their parse has nothing to key on.
+  if (!info->edid.empty()) {
+    cached_edid_ = info->edid;
+    cached_info_ = *info;
+    info_cache_valid_ = true;
+  }
+
   drmModeFreeObjectProperties(props);
 
   return 0;
@@ -1109,13 +1160,26 @@ void DRMConnector::InitAndParse(drmModeConnector *conn) {
   pp_mgr_->Init(prop_mgr_, DRM_MODE_OBJECT_CONNECTOR);
 }
 
+void DRMConnector::PostValidate(bool success) {
+  tmp_prop_val_map_ = committed_prop_val_map_;
+}
+
+void DRMConnector::PostCommit(bool success) {
+  if (success) {
+    committed_prop_val_map_ = tmp_prop_val_map_;
+  } else {
+    tmp_prop_val_map_ = committed_prop_val_map_;
+  }
+}
+
 void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
   uint32_t obj_id = drm_connector_->connector_id;
 
   switch (code) {
     case DRMOps::CONNECTOR_SET_CRTC: {
       uint32_t crtc = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::CRTC_ID), crtc);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::CRTC_ID), crtc,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting CRTC %d", obj_id, crtc);
     } break;
 
@@ -1137,14 +1201,14 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CONNECTOR_SET_OUTPUT_RECT: {
       DRMRect rect = va_arg(args, DRMRect);
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::DST_X), rect.left);
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::DST_Y), rect.top);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_W),
-                               rect.right - rect.left);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_H),
-                               rect.bottom - rect.top);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_X), rect.left,
+                  true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_Y), rect.top,
+                  true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_W),
+                  rect.right - rect.left, true /* cache */, tmp_prop_val_map_);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DST_H),
+                  rect.bottom - rect.top, true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting dst [x,y,w,h][%d,%d,%d,%d]", obj_id, rect.left,
                   rect.top, (rect.right - rect.left), (rect.bottom - rect.top));
     } break;
@@ -1175,7 +1239,8 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
           DRM_LOGE("Invalid power mode %d to set on connector %d", drm_power_mode, obj_id);
           break;
       }
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::LP), power_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::LP), power_mode,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting power_mode %d", obj_id, power_mode);
     } break;
 
@@ -1187,23 +1252,22 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CONNECTOR_SET_BRIGHTNESS: {
       uint32_t brightness_level = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::BRIGHTNESS),
-                               brightness_level);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::BRIGHTNESS),
+                  brightness_level, true /* cache */, tmp_prop_val_map_);
     } break;
 
     case DRMOps::CONNECTOR_SET_AUTOREFRESH: {
       uint32_t enable = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::AUTOREFRESH),
-                               enable);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::AUTOREFRESH), enable,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting autorefresh %d", obj_id, enable);
     } break;
 
     case DRMOps::CONNECTOR_SET_FB_SECURE_MODE: {
       int secure_mode = va_arg(args, int);
       uint32_t fb_secure_mode = (secure_mode == (int)DRMSecureMode::SECURE) ? SECURE : NON_SECURE;
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::FB_TRANSLATION_MODE),
-                               fb_secure_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::FB_TRANSLATION_MODE),
+                  fb_secure_mode, true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting FB secure mode %d", obj_id, fb_secure_mode);
     } break;
 
@@ -1215,8 +1279,19 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CONNECTOR_SET_HDR_METADATA: {
       drm_msm_ext_hdr_metadata *hdr_metadata = va_arg(args, drm_msm_ext_hdr_metadata *);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::HDR_METADATA),
-                               reinterpret_cast<uint64_t>(hdr_metadata));
+      uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::HDR_METADATA);
+      // Dedup on payload contents, not the pointer - callers reuse the same
+      // struct across frames. The hash rides the tmp/committed value maps so
+      // a failed commit rolls it back with the rest of the cached state.
+      uint64_t hash = HashPropPayload(hdr_metadata, sizeof(*hdr_metadata));
+#ifndef SDM_VIRTUAL_DRIVER
+      auto it = tmp_prop_val_map_.find(prop_id);
+      if (it != tmp_prop_val_map_.end() && it->second == hash) {
+        break;
+      }
+#endif
+      drmModeAtomicAddProperty(req, obj_id, prop_id, reinterpret_cast<uint64_t>(hdr_metadata));
+      tmp_prop_val_map_[prop_id] = hash;
     } break;
 
     case DRMOps::CONNECTOR_SET_QSYNC_MODE: {
@@ -1225,15 +1300,15 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
       }
       int drm_qsync_mode = va_arg(args, int);
       uint32_t qsync_mode = static_cast<uint32_t>(drm_qsync_mode);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::QSYNC_MODE),
-                               qsync_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::QSYNC_MODE), qsync_mode,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting Qsync mode %d", obj_id, qsync_mode);
     } break;
 
     case DRMOps::CONNECTOR_SET_TOPOLOGY_CONTROL: {
       uint32_t topology_control = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::TOPOLOGY_CONTROL),
-                               topology_control);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::TOPOLOGY_CONTROL),
+                  topology_control, true /* cache */, tmp_prop_val_map_);
     } break;
 
     case DRMOps::CONNECTOR_SET_FRAME_TRIGGER: {
@@ -1259,14 +1334,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
           break;
       }
       if (frame_trigger_mode >= 0) {
-        uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::FRAME_TRIGGER);
-        int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, frame_trigger_mode);
-        if (ret < 0) {
-          DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d mode %d ret %d",
-                   obj_id, prop_id, frame_trigger_mode, ret);
-        } else {
-          DRM_LOGD("Connector %d: Setting frame trigger mode %d", obj_id, frame_trigger_mode);
-        }
+        AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::FRAME_TRIGGER),
+                    frame_trigger_mode, true /* cache */, tmp_prop_val_map_);
+        DRM_LOGD("Connector %d: Setting frame trigger mode %d", obj_id, frame_trigger_mode);
       }
     } break;
 
@@ -1278,14 +1348,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
       int32_t colorspace = 0;
       colorspace = GetColorspace(drm_colorspace);
       if (colorspace >= 0) {
-        uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::COLORSPACE);
-        int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, colorspace);
-        if (ret < 0) {
-          DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d mode %d ret %d",
-                   obj_id, prop_id, colorspace, ret);
-        } else {
-          DRM_LOGD("Connector %d: Setting colorspace %d", obj_id, colorspace);
-        }
+        AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::COLORSPACE), colorspace,
+                    true /* cache */, tmp_prop_val_map_);
+        DRM_LOGD("Connector %d: Setting colorspace %d", obj_id, colorspace);
       } else {
         DRM_LOGE("Invalid colorspace %d", colorspace);
       }
@@ -1296,8 +1361,8 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint32_t drm_panel_mode = va_arg(args, uint32_t);
-      drmModeAtomicAddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::PANEL_MODE),
-                               drm_panel_mode);
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::PANEL_MODE), drm_panel_mode,
+                  true /* cache */, tmp_prop_val_map_);
       DRM_LOGD("Connector %d: Setting Panel mode 0x%x", obj_id, drm_panel_mode);
     } break;
 
@@ -1306,14 +1371,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint32_t bpp_mode = va_arg(args, uint32_t);
-      uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::BPP_MODE);
-      int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, bpp_mode);
-      if (ret < 0) {
-        DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d bpp_mode %d ret %d",
-                 obj_id, prop_id, bpp_mode, ret);
-      } else {
-        DRM_LOGD("Connector %d: Setting Bpp mode 0x%x", obj_id, bpp_mode);
-      }
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::BPP_MODE), bpp_mode,
+                  true /* cache */, tmp_prop_val_map_);
+      DRM_LOGD("Connector %d: Setting Bpp mode 0x%x", obj_id, bpp_mode);
     } break;
 
     case DRMOps::CONNECTOR_SET_DYN_BIT_CLK: {
@@ -1321,14 +1381,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint64_t drm_bit_clk_rate = va_arg(args, uint64_t);
-      uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::DYN_BIT_CLK);
-      int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, drm_bit_clk_rate);
-      if (ret < 0) {
-        DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d, bit_clk_rate %" PRIu64
-                 " ret %d", obj_id, prop_id, drm_bit_clk_rate, ret);
-      } else {
-        DRM_LOGD("Connector %d: Setting dynamic bit clk rate %" PRIu64, obj_id, drm_bit_clk_rate);
-      }
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DYN_BIT_CLK),
+                  drm_bit_clk_rate, true /* cache */, tmp_prop_val_map_);
+      DRM_LOGD("Connector %d: Setting dynamic bit clk rate %" PRIu64, obj_id, drm_bit_clk_rate);
     } break;
 
     case DRMOps::CONNECTOR_SET_DSC_MODE: {
@@ -1336,14 +1391,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint64_t drm_compression_mode = va_arg(args, uint32_t);
-      uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::DSC_MODE);
-      int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, drm_compression_mode);
-      if (ret < 0) {
-        DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d, compression_mode %d ret %d",
-                 obj_id, prop_id, drm_compression_mode, ret);
-      } else {
-        DRM_LOGD("Connector %d: Setting compression mode %d", obj_id, drm_compression_mode);
-      }
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DSC_MODE),
+                  drm_compression_mode, true /* cache */, tmp_prop_val_map_);
+      DRM_LOGD("Connector %d: Setting compression mode %d", obj_id, drm_compression_mode);
     } break;
 
     case DRMOps::CONNECTOR_SET_TRANSFER_TIME: {
@@ -1351,15 +1401,9 @@ void DRMConnector::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
         return;
       }
       uint32_t drm_transfer_time = va_arg(args, uint32_t);
-      uint32_t prop_id = prop_mgr_.GetPropertyId(DRMProperty::DYN_TRANSFER_TIME);
-      int ret = drmModeAtomicAddProperty(req, obj_id, prop_id, drm_transfer_time);
-      if (ret < 0) {
-        DRM_LOGE("AtomicAddProperty failed obj_id 0x%x, prop_id %d, transfer_time %" PRIu64
-                 " ret %d",
-                 obj_id, prop_id, drm_transfer_time, ret);
-      } else {
-        DRM_LOGD("Connector %d: Setting new transfer time %" PRIu64, obj_id, drm_transfer_time);
-      }
+      AddProperty(req, obj_id, prop_mgr_.GetPropertyId(DRMProperty::DYN_TRANSFER_TIME),
+                  drm_transfer_time, true /* cache */, tmp_prop_val_map_);
+      DRM_LOGD("Connector %d: Setting new transfer time %d", obj_id, drm_transfer_time);
     } break;
 
     case DRMOps::CONNECTOR_GET_TRANSFER_TIME: {
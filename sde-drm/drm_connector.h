@@ -76,6 +76,7 @@
 #include <display/drm/sde_drm.h>
 #include <mutex>
 #include <set>
+#include <unordered_map>
 #include "drm_pp_manager.h"
 
 #include "drm_utils.h"
@@ -98,6 +99,8 @@ class DRMConnector {
   int IsConnected() { return (DRM_MODE_CONNECTED == drm_connector_->connection); }
   int GetPossibleEncoders(std::set<uint32_t> *possible_encoders);
   void SetSkipConnectorReload(bool skip_reload) { skip_connector_reload_ = skip_reload; };
+  void PostValidate(bool success);
+  void PostCommit(bool success);
   void Dump();
 
  private:
@@ -118,6 +121,15 @@ class DRMConnector {
   DRMStatus status_ = DRMStatus::FREE;
   std::unique_ptr<DRMPPManager> pp_mgr_{};
   DRMJitterConfig jitter_cfg_ = {};
+  // Shadow state of properties issued to the driver. Identical values are dropped from the
+  // atomic request instead of being re-marshalled every commit.
+  std::unordered_map<uint32_t, uint64_t> tmp_prop_val_map_ {};
+  std::unordered_map<uint32_t, uint64_t> committed_prop_val_map_ {};
+  // Fully parsed info from the last GetInfo(), keyed by the sink's raw EDID. A re-connect
+  // of the same sink reuses it instead of re-parsing the capability and mode blobs.
+  std::vector<uint8_t> cached_edid_ {};
+  DRMConnectorInfo cached_info_ {};
+  bool info_cache_valid_ = false;
 #ifdef SDE_MAX_ROI_V1
   sde_drm_roi_v1 roi_v1_ {};
 #endif
@@ -140,6 +152,8 @@ class DRMConnectorManager {
   int GetPossibleEncoders(uint32_t connector_id, std::set<uint32_t> *possible_encoders);
   int GetPreferredModeLMCounts(std::map<uint32_t, uint8_t> *lm_counts);
   void MapEncoderToConnector(std::map<uint32_t, uint32_t> *encoder_to_connector);
+  void PostValidate(uint32_t conn_id, bool success);
+  void PostCommit(uint32_t conn_id, bool success);
   ~DRMConnectorManager() {}
 
  private:
@@ -182,6 +182,7 @@ void DRMCrtcManager::Init(drmModeRes *resource) {
     if (libdrm_crtc) {
       crtc->InitAndParse(libdrm_crtc);
       crtc_pool_[resource->crtcs[i]] = std::move(crtc);
+      crtc_index_map_[i] = resource->crtcs[i];
     } else {
       DRM_LOGE("Critical error: drmModeGetCrtc() failed for crtc %d.", resource->crtcs[i]);
     }
@@ -198,6 +199,7 @@ void DRMCrtcManager::DumpAll() {
   for (auto &crtc : crtc_pool_) {
     crtc.second->Dump();
   }
+  DRMBlobStats::Dump();
 }
 
 void DRMCrtcManager::Perform(DRMOps code, uint32_t obj_id, drmModeAtomicReq *req,
@@ -228,32 +230,28 @@ void DRMCrtcManager::SetScalerLUT(const DRMScalerLUTInfo &lut_info) {
     return;
   }
 
-  if (lut_info.dir_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.dir_lut),
-                              lut_info.dir_lut_size, &dir_lut_blob_id_);
-  }
-  if (lut_info.cir_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.cir_lut),
-                              lut_info.cir_lut_size, &cir_lut_blob_id_);
-  }
-  if (lut_info.sep_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.sep_lut),
-                              lut_info.sep_lut_size, &sep_lut_blob_id_);
-  }
+  // Re-reference live blobs when LUT content is unchanged; mode switches commonly
+  // re-program identical LUT sets.
+  UpdateLUTBlob(fd_, lut_info.dir_lut, lut_info.dir_lut_size, &dir_lut_blob_id_,
+                &dir_lut_checksum_, kBlobObjectCrtc);
+  UpdateLUTBlob(fd_, lut_info.cir_lut, lut_info.cir_lut_size, &cir_lut_blob_id_,
+                &cir_lut_checksum_, kBlobObjectCrtc);
+  UpdateLUTBlob(fd_, lut_info.sep_lut, lut_info.sep_lut_size, &sep_lut_blob_id_,
+                &sep_lut_checksum_, kBlobObjectCrtc);
 }
 
 void DRMCrtcManager::UnsetScalerLUT() {
   lock_guard<mutex> lock(lock_);
   if (dir_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, dir_lut_blob_id_);
+    DestroyBlob(fd_, dir_lut_blob_id_, kBlobObjectCrtc);
     dir_lut_blob_id_ = 0;
   }
   if (cir_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, cir_lut_blob_id_);
+    DestroyBlob(fd_, cir_lut_blob_id_, kBlobObjectCrtc);
     cir_lut_blob_id_ = 0;
   }
   if (sep_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, sep_lut_blob_id_);
+    DestroyBlob(fd_, sep_lut_blob_id_, kBlobObjectCrtc);
     sep_lut_blob_id_ = 0;
   }
 }
@@ -289,14 +287,19 @@ void DRMCrtcManager::GetPPInfo(uint32_t crtc_id, DRMPPFeatureInfo *info) {
 int DRMCrtcManager::Reserve(const std::set<uint32_t> &possible_crtc_indices,
                              DRMDisplayToken *token) {
   lock_guard<mutex> lock(lock_);
-  for (auto &item : crtc_pool_) {
-    if (item.second->GetStatus() == DRMStatus::FREE) {
-      if (possible_crtc_indices.find(item.second->GetIndex()) != possible_crtc_indices.end()) {
-        item.second->Lock();
-        token->crtc_id = item.first;
-        token->crtc_index = item.second->GetIndex();
-        return 0;
-      }
+  // Probe only the encoder's candidate indices via the table built at Init instead of
+  // scanning the whole pool against the set on every token reservation
+  for (const uint32_t &crtc_index : possible_crtc_indices) {
+    auto item = crtc_index_map_.find(crtc_index);
+    if (item == crtc_index_map_.end()) {
+      continue;
+    }
+    auto &crtc = crtc_pool_.at(item->second);
+    if (crtc->GetStatus() == DRMStatus::FREE) {
+      crtc->Lock();
+      token->crtc_id = item->second;
+      token->crtc_index = crtc_index;
+      return 0;
     }
   }
 
@@ -643,7 +646,7 @@ void DRMCrtc::Lock() {
 
 void DRMCrtc::Unlock() {
   if (mode_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, mode_blob_id_);
+    DestroyBlob(fd_, mode_blob_id_, kBlobObjectCrtc);
     mode_blob_id_ = 0;
   }
 
@@ -654,7 +657,7 @@ void DRMCrtc::Unlock() {
 
 void DRMCrtc::SetModeBlobID(uint64_t blob_id) {
   if (mode_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, mode_blob_id_);
+    DestroyBlob(fd_, mode_blob_id_, kBlobObjectCrtc);
   }
 
   mode_blob_id_ = blob_id;
@@ -677,7 +680,7 @@ void DRMCrtc::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
       uint32_t blob_id = 0;
 
       if (mode) {
-        if (drmModeCreatePropertyBlob(fd_, (const void *)mode, sizeof(drmModeModeInfo), &blob_id)) {
+        if (CreateBlob(fd_, (const void *)mode, sizeof(drmModeModeInfo), &blob_id, kBlobObjectCrtc)) {
           DRM_LOGE("drmModeCreatePropertyBlob failed for CRTC_SET_MODE, crtc %d", obj_id);
           return;
         }
@@ -746,8 +749,9 @@ void DRMCrtc::Perform(DRMOps code, drmModeAtomicReq *req, va_list args) {
 
     case DRMOps::CRTC_SET_ROT_PREFILL_BW: {
       uint64_t rot_bw = va_arg(args, uint64_t);
-      drmModeAtomicAddProperty(req, obj_id,
-                               prop_mgr_.GetPropertyId(DRMProperty::ROT_PREFILL_BW), rot_bw);
+      AddProperty(req, obj_id,
+                  prop_mgr_.GetPropertyId(DRMProperty::ROT_PREFILL_BW), rot_bw, true /* cache */,
+                  tmp_prop_val_map_);
     }; break;
 
     case DRMOps::CRTC_SET_ROT_CLK: {
@@ -128,10 +128,15 @@ class DRMCrtcManager {
  private:
   int fd_ = -1;
   std::map<uint32_t, std::unique_ptr<DRMCrtc>> crtc_pool_{};
-    // GLobal Scaler LUT blobs
+  // Crtc index -> id, fixed at Init; lets Reserve() probe candidate indices directly
+  std::map<uint32_t, uint32_t> crtc_index_map_{};
+    // GLobal Scaler LUT blobs with payload checksums for re-upload dedup
   uint32_t dir_lut_blob_id_ = 0;
   uint32_t cir_lut_blob_id_ = 0;
   uint32_t sep_lut_blob_id_ = 0;
+  uint64_t dir_lut_checksum_ = 0;
+  uint64_t cir_lut_checksum_ = 0;
+  uint64_t sep_lut_checksum_ = 0;
   std::mutex lock_;
 };
 
@@ -71,6 +71,25 @@ void DRMEncoderManager::Init(drmModeRes *resource) {
 
   // TODO(user): Remove call when driver reporting of encoders is consistent across all use cases
   InsertSecondaryDSI();
+
+  // Pool membership is final now; precompute the per-encoder port codes used by Reserve()
+  BuildHwPortIndex();
+}
+
+void DRMEncoderManager::BuildHwPortIndex() {
+  hw_port_map_.clear();
+  int encoder_index = 0;
+  for (auto &encoder : encoder_pool_) {
+    encoder_index++;  // 1-indexed port
+    // Port id format.
+    // Bit 7   --> Display type 0: Pluggable 1: BuiltIn X:Virtual.
+    // Bit 6   --> Pluggable: 0 for TMDS encoder, 1 for DPMST encoder.
+    //             Builtin Or Virtual: X
+    // Bit 5-0 --> Encoder index.
+    uint32_t encoder_type;
+    encoder.second->GetType(&encoder_type);
+    hw_port_map_[encoder.first] = GetDisplayTypeCode(encoder_type) | encoder_index;
+  }
 }
 
 /*
@@ -147,30 +166,21 @@ int DRMEncoderManager::GetEncoderList(std::vector<uint32_t> *encoder_ids) {
 }
 
 int DRMEncoderManager::Reserve(const std::set<uint32_t> &possible_encoders, DRMDisplayToken *token) {
-  int ret = -ENODEV;
-  for (auto encoder = encoder_pool_.begin(); encoder != encoder_pool_.end(); encoder++) {
-    const uint32_t &encoder_id = encoder->first;
-    if ((encoder->second)->GetStatus() == DRMStatus::FREE) {
-      // If encoder is found in the set, the encoder is a candidate for selection and the encoder
-      // type for display's connector and encoder-this-iteration are already matched implicitly
-      if (possible_encoders.find(encoder_id) != possible_encoders.end()) {
-        encoder->second->Lock();
-        token->encoder_id = encoder_id;
-        int encoder_index = distance(encoder_pool_.begin(), encoder) + 1;  // 1-indexed port
-        // Port id format.
-        // Bit 7   --> Display type 0: Pluggable 1: BuiltIn X:Virtual.
-        // Bit 6   --> Pluggable: 0 for TMDS encoder, 1 for DPMST encoder.
-        //             Builtin Or Virtual: X
-        // Bit 5-0 --> Encoder index.
-        uint32_t encoder_type;
-        encoder->second->GetType(&encoder_type);
-        token->hw_port = GetDisplayTypeCode(encoder_type) | encoder_index;
-        ret = 0;
-        break;
-      }
+  // Probe only the connector's candidate encoders instead of walking the full pool; both the
+  // set and the pool are id-ordered, so the first free candidate matches the old selection.
+  // Encoder type compatibility with the display's connector is already matched implicitly by
+  // membership in the set, and the port code was precomputed at Init.
+  for (const uint32_t &encoder_id : possible_encoders) {
+    auto encoder = encoder_pool_.find(encoder_id);
+    if (encoder == encoder_pool_.end() || encoder->second->GetStatus() != DRMStatus::FREE) {
+      continue;
     }
+    encoder->second->Lock();
+    token->encoder_id = encoder_id;
+    token->hw_port = hw_port_map_[encoder_id];
+    return 0;
   }
-  return ret;
+  return -ENODEV;
 }
 
 int DRMEncoderManager::GetDisplayTypeCode(uint32_t encoder_type) {
@@ -247,21 +257,24 @@ void DRMEncoder::Unlock() {
 void DRMEncoder::InitAndParse(drmModeEncoder *encoder) {
   drm_encoder_ = encoder;
   encoder_info_.type = drm_encoder_->encoder_type;
-}
 
-int DRMEncoder::GetPossibleCrtcIndices(std::set<uint32_t> *possible_crtc_indices) {
-  if (!possible_crtc_indices) {
-    return -EINVAL;
-  }
-
-  (*possible_crtc_indices).clear();
+  // Decode the crtc compatibility bitmask once; GetPossibleCrtcIndices serves every
+  // subsequent token reservation from this set.
+  possible_crtc_indices_.clear();
   std::bitset<32> possible_crtcs = drm_encoder_->possible_crtcs;
   for (uint32_t i = 0; i < possible_crtcs.size(); i++) {
     if (possible_crtcs[i]) {
-      (*possible_crtc_indices).insert(i);
+      possible_crtc_indices_.insert(i);
     }
   }
+}
+
+int DRMEncoder::GetPossibleCrtcIndices(std::set<uint32_t> *possible_crtc_indices) {
+  if (!possible_crtc_indices) {
+    return -EINVAL;
+  }
 
+  *possible_crtc_indices = possible_crtc_indices_;
   return 0;
 }
 
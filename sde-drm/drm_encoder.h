@@ -70,6 +70,8 @@ class DRMEncoder {
   drmModeEncoder *drm_encoder_ = {};
   DRMStatus status_ = DRMStatus::FREE;
   DRMEncoderInfo encoder_info_ = {};
+  // Decoded once from possible_crtcs at InitAndParse; empty for userspace-injected encoders
+  std::set<uint32_t> possible_crtc_indices_ = {};
 
   // Userspace injected data, only used for creating object not reported by the driver
   uint32_t fake_id_;
@@ -95,7 +97,11 @@ class DRMEncoderManager {
  private:
   int fd_ = -1;
   std::map<uint32_t, std::unique_ptr<DRMEncoder>> encoder_pool_{};
+  // Port codes precomputed per encoder once the pool is final, so Reserve() does not
+  // recompute pool distances on every display token acquisition
+  std::map<uint32_t, uint32_t> hw_port_map_{};
   int GetDisplayTypeCode(uint32_t encoder_type);
+  void BuildHwPortIndex();
 };
 
 }  // namespace sde_drm
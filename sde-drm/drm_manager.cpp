@@ -30,6 +30,7 @@
 #include <drm_logger.h>
 
 #include <string.h>
+#include <algorithm>
 #include "drm_atomic_req.h"
 #include "drm_connector.h"
 #include "drm_crtc.h"
@@ -326,6 +327,10 @@ void DRMManager::UnregisterDisplay(DRMDisplayToken *token) {
 }
 
 DRMManager::~DRMManager() {
+  for (auto &req : atomic_req_pool_) {
+    delete req;
+  }
+  atomic_req_pool_.clear();
   if (conn_mgr_) {
     conn_mgr_->DeInit();
     delete conn_mgr_;
@@ -352,7 +357,21 @@ DRMManager::~DRMManager() {
 }
 
 int DRMManager::CreateAtomicReq(const DRMDisplayToken &token, DRMAtomicReqInterface **intf) {
-  DRMAtomicReq *req = new DRMAtomicReq(fd_, this);
+  DRMAtomicReq *req = nullptr;
+  uint32_t high_water_mark = 0;
+  {
+    lock_guard<mutex> lock(atomic_req_pool_lock_);
+    if (!atomic_req_pool_.empty()) {
+      req = atomic_req_pool_.back();
+      atomic_req_pool_.pop_back();
+    }
+    high_water_mark = atomic_req_high_water_;
+  }
+
+  bool recycled = (req != nullptr);
+  if (!req) {
+    req = new DRMAtomicReq(fd_, this);
+  }
   int ret = req ? req->Init(token) : -ENOMEM;
 
   if (ret < 0) {
@@ -361,13 +380,27 @@ int DRMManager::CreateAtomicReq(const DRMDisplayToken &token, DRMAtomicReqInterf
     delete req;
     return ret;
   }
+
+  if (!recycled) {
+    // Size the fresh request to the largest one seen so far, so the first frames of a new
+    // display never grow the libdrm buffer in the commit path. Recycled requests already
+    // carry their capacity.
+    req->PreAllocate(high_water_mark);
+  }
   *intf = req;
 
   return 0;
 }
 
 int DRMManager::DestroyAtomicReq(DRMAtomicReqInterface *intf) {
-  delete intf;
+  DRMAtomicReq *req = static_cast<DRMAtomicReq *>(intf);
+  if (!req) {
+    return 0;
+  }
+
+  lock_guard<mutex> lock(atomic_req_pool_lock_);
+  atomic_req_high_water_ = std::max(atomic_req_high_water_, req->GetHighWaterMark());
+  atomic_req_pool_.push_back(req);
   return 0;
 }
 
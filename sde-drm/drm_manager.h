@@ -32,11 +32,13 @@
 
 #include <drm_interface.h>
 #include <mutex>
+#include <vector>
 #include "drm_dpps_mgr_intf.h"
 #include "drm_panel_feature_mgr_intf.h"
 
 namespace sde_drm {
 
+class DRMAtomicReq;
 class DRMAtomicReqInterface;
 class DRMPlaneManager;
 class DRMPlane;
@@ -94,6 +96,11 @@ class DRMManager : public DRMManagerInterface {
   DRMCrtcManager *crtc_mgr_ = {};
   DRMDppsManagerIntf *dpps_mgr_intf_ = {};
   DRMPanelFeatureMgrIntf *panel_feature_mgr_intf_ = {};
+  // Retired atomic requests kept for reuse, and the largest property count any request has ever
+  // staged; see CreateAtomicReq().
+  std::vector<DRMAtomicReq *> atomic_req_pool_;
+  uint32_t atomic_req_high_water_ = 0;
+  std::mutex atomic_req_pool_lock_;
 
   static DRMManager *s_drm_instance;
   static std::mutex s_lock;
@@ -72,8 +72,11 @@
 #include <cstring>
 #include <regex>
 #include <inttypes.h>
+#include <time.h>
+#include <algorithm>
 
 #include "drm_panel_feature_mgr.h"
+#include "drm_utils.h"
 
 #define __CLASS__ "DRMPanelFeatureMgr"
 
@@ -96,6 +99,22 @@ DRMPanelFeatureMgrIntf *GetPanelFeatureManagerIntf() {
   return &panel_feature_mgr;
 }
 
+// FNV-1a over the blob payload; collisions only cost a spurious blob recreation.
+static uint64_t HashBlobPayload(const uint8_t *data, uint32_t size) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < size; i++) {
+    hash = (hash ^ data[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+static uint64_t GetTimeUs() {
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (static_cast<uint64_t>(t.tv_sec) * 1000000ULL) +
+         (static_cast<uint64_t>(t.tv_nsec) / 1000ULL);
+}
+
 void DRMPanelFeatureMgr::Init(int fd, drmModeRes* res) {
   lock_guard<mutex> lock(lock_);
 
@@ -187,13 +206,13 @@ void DRMPanelFeatureMgr::Deinit() {
   int ret = 0;
   for (int i = kDRMPanelFeatureDsppIndex; i < kDRMPanelFeatureMax; i++) {
     DRMPanelFeatureID prop_id = static_cast<DRMPanelFeatureID>(i);
-    if (drm_prop_blob_ids_map_[prop_id]) {
-      ret = drmModeDestroyPropertyBlob(dev_fd_, drm_prop_blob_ids_map_[prop_id]);
+    if (blob_cache_[prop_id].blob_id) {
+      ret = DestroyBlob(dev_fd_, blob_cache_[prop_id].blob_id, kBlobObjectPanelFeature);
       if (ret) {
         DRM_LOGE("failed to destroy blob for feature %d, ret = %d", prop_id, ret);
         return;
       } else {
-        drm_prop_blob_ids_map_[prop_id] = 0;
+        blob_cache_[prop_id] = {};
       }
     }
   }
@@ -491,20 +510,34 @@ void DRMPanelFeatureMgr::CachePanelFeature(const DRMPanelFeatureInfo &info) {
 
 void DRMPanelFeatureMgr::CommitPanelFeatures(drmModeAtomicReq *req, const DRMDisplayToken &token) {
   lock_guard<mutex> lock(lock_);
+  uint64_t start_us = GetTimeUs();
+  uint32_t applied = 0;
   for (auto it = dirty_features_.begin(); it != dirty_features_.end();) {
     if (it->obj_id == token.crtc_id || it->obj_id == token.conn_id) {
       DRMPanelFeatureInfo info = *it;
       ApplyDirtyFeature(req, token, info);
       it = dirty_features_.erase(it);
+      applied++;
     } else {
       it++;
     }
   }
+
+  if (applied) {
+    uint64_t apply_us = GetTimeUs() - start_us;
+    features_applied_ += applied;
+    max_apply_us_ = std::max(max_apply_us_, apply_us);
+    DRM_LOGI("Applied %u panel features in %" PRIu64 " us (total %u, blobs created %u, "
+             "cache hits %u, max pass %" PRIu64 " us)", applied, apply_us, features_applied_,
+             blob_creations_, blob_cache_hits_, max_apply_us_);
+  }
 }
 
 void DRMPanelFeatureMgr::NullCommitPanelFeatures(drmModeAtomicReq *req,
                                                  const DRMDisplayToken &token) {
   lock_guard<mutex> lock(lock_);
+  uint64_t start_us = GetTimeUs();
+  uint32_t applied = 0;
   for (auto it = dirty_features_.begin(); it != dirty_features_.end();) {
     if (it->obj_id == token.crtc_id || it->obj_id == token.conn_id) {
       DRMPanelFeatureInfo info = *it;
@@ -523,10 +556,20 @@ void DRMPanelFeatureMgr::NullCommitPanelFeatures(drmModeAtomicReq *req,
       ApplyDirtyFeature(req, token, info);
       it = dirty_features_.erase(it);
       apply_in_null_commit_.erase(info.obj_id);
+      applied++;
     } else {
       it++;
     }
   }
+
+  if (applied) {
+    uint64_t apply_us = GetTimeUs() - start_us;
+    features_applied_ += applied;
+    max_apply_us_ = std::max(max_apply_us_, apply_us);
+    DRM_LOGI("Applied %u panel features via null commit in %" PRIu64 " us (total %u, "
+             "blobs created %u, cache hits %u, max pass %" PRIu64 " us)", applied, apply_us,
+             features_applied_, blob_creations_, blob_cache_hits_, max_apply_us_);
+  }
 }
 
 // LCOV_EXCL_START
@@ -601,24 +644,35 @@ void DRMPanelFeatureMgr::ApplyDirtyFeature(drmModeAtomicReq *req, const DRMDispl
       return;
     }
 
-    ret = drmModeCreatePropertyBlob(dev_fd_, reinterpret_cast<void *> (info.prop_ptr),
-            info.prop_size, &blob_id);
-    if (ret || blob_id == 0) {
-      DRM_LOGE("failed to create blob ret %d, id = %d prop_ptr:%" PRIu64 " prop_sz:%d",
-              ret, blob_id, info.prop_ptr, info.prop_size);
-      return;
-    }
-
-    if (drm_prop_blob_ids_map_[info.prop_id]) {
-      ret = drmModeDestroyPropertyBlob(dev_fd_, drm_prop_blob_ids_map_[info.prop_id]);
-      if (ret) {
-        DRM_LOGE("failed to destroy blob for feature %d, ret = %d", info.prop_id, ret);
+    uint64_t content_hash = HashBlobPayload(reinterpret_cast<uint8_t *>(info.prop_ptr),
+                                            info.prop_size);
+    BlobCacheEntry &cached = blob_cache_[info.prop_id];
+    if (cached.blob_id && cached.size == info.prop_size && cached.content_hash == content_hash) {
+      // Payload unchanged since the blob was created; reuse it and skip the
+      // create + destroy ioctl pair.
+      blob_cache_hits_++;
+      value = cached.blob_id;
+    } else {
+      ret = CreateBlob(dev_fd_, reinterpret_cast<void *> (info.prop_ptr),
+              info.prop_size, &blob_id, kBlobObjectPanelFeature);
+      if (ret || blob_id == 0) {
+        DRM_LOGE("failed to create blob ret %d, id = %d prop_ptr:%" PRIu64 " prop_sz:%d",
+                ret, blob_id, info.prop_ptr, info.prop_size);
         return;
       }
-    }
-    drm_prop_blob_ids_map_[info.prop_id] = blob_id;
 
-    value = blob_id;
+      if (cached.blob_id) {
+        ret = DestroyBlob(dev_fd_, cached.blob_id, kBlobObjectPanelFeature);
+        if (ret) {
+          DRM_LOGE("failed to destroy blob for feature %d, ret = %d", info.prop_id, ret);
+          return;
+        }
+      }
+      cached = {content_hash, info.prop_size, blob_id};
+      blob_creations_++;
+
+      value = blob_id;
+    }
   } else if (info.prop_size == sizeof(uint64_t)) {
     value = (reinterpret_cast<uint64_t *> (info.prop_ptr))[0];
   } else {
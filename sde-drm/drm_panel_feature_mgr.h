@@ -97,6 +97,15 @@ class DRMPanelFeatureMgr : public DRMPanelFeatureMgrIntf {
   void ApplyDirtyFeature(drmModeAtomicReq *req, const DRMDisplayToken &token,
                          DRMPanelFeatureInfo &info);
 
+  // Last blob created per feature, keyed by payload content. Re-applies with an unchanged
+  // payload (the common case when features are reprogrammed after doze exit) reuse the live
+  // blob id instead of paying a create + destroy ioctl pair per feature.
+  struct BlobCacheEntry {
+    uint64_t content_hash = 0;
+    uint32_t size = 0;
+    uint32_t blob_id = 0;
+  };
+
   std::mutex lock_;
   int dev_fd_ = -1;
   drmModeRes* drm_res_ = nullptr;
@@ -104,9 +113,14 @@ class DRMPanelFeatureMgr : public DRMPanelFeatureMgrIntf {
   std::vector<struct DRMPanelFeatureInfo> dirty_features_ {};
   std::map<DRMPanelFeatureID, DRMProperty> drm_property_map_ {};
   std::map<DRMPanelFeatureID, DRMPropType> drm_prop_type_map_ {};
-  std::map<DRMPanelFeatureID, uint32_t> drm_prop_blob_ids_map_ {};
+  std::map<DRMPanelFeatureID, BlobCacheEntry> blob_cache_ {};
   std::array<DRMPanelFeatureInfo, kDRMPanelFeatureMax> feature_info_tbl_ {};
   std::map<uint32_t /* obj_id */, DRMPanelFeatureID> apply_in_null_commit_ {};
+  // Apply-latency counters, logged with each non-empty commit pass.
+  uint32_t features_applied_ = 0;
+  uint32_t blob_creations_ = 0;
+  uint32_t blob_cache_hits_ = 0;
+  uint64_t max_apply_us_ = 0;
 };
 
 }  // namespace sde_drm
@@ -474,7 +474,14 @@ void DRMPlaneManager::Init() {
     drmModePlane *libdrm_plane = drmModeGetPlane(fd_, resource->planes[i]);
     if (libdrm_plane) {
       plane->InitAndParse(libdrm_plane);
-      plane_pool_[resource->planes[i]] = std::move(plane);
+      uint32_t plane_id = resource->planes[i];
+      DRMPlane *plane_ptr = plane.get();
+      plane_pool_[plane_id] = std::move(plane);
+      planes_.push_back(std::make_pair(plane_id, plane_ptr));
+      if (plane_id >= plane_lookup_.size()) {
+        plane_lookup_.resize(plane_id + 1, nullptr);
+      }
+      plane_lookup_[plane_id] = plane_ptr;
     } else {
       DRM_LOGE("Critical error: drmModeGetPlane() failed for plane %d.", resource->planes[i]);
     }
@@ -485,25 +492,30 @@ void DRMPlaneManager::Init() {
 
 void DRMPlaneManager::DumpByID(uint32_t id) {
   lock_guard<mutex> lock(lock_);
-  plane_pool_.at(id)->Dump();
+  DRMPlane *plane = GetPlane(id);
+  if (!plane) {
+    DRM_LOGE("Invalid plane id %d", id);
+    return;
+  }
+  plane->Dump();
 }
 
 void DRMPlaneManager::Perform(DRMOps code, uint32_t obj_id, drmModeAtomicReq *req, va_list args) {
   lock_guard<mutex> lock(lock_);
-  auto it = plane_pool_.find(obj_id);
-  if (it == plane_pool_.end()) {
+  DRMPlane *plane = GetPlane(obj_id);
+  if (!plane) {
     DRM_LOGE("Invalid plane id %d", obj_id);
     return;
   }
 
   if (code == DRMOps::PLANE_SET_SCALER_CONFIG) {
-    if (it->second->ConfigureScalerLUT(req, dir_lut_blob_id_, cir_lut_blob_id_,
-                                       sep_lut_blob_id_)) {
+    if (plane->ConfigureScalerLUT(req, dir_lut_blob_id_, cir_lut_blob_id_,
+                                  sep_lut_blob_id_)) {
       DRM_LOGD("Plane %d: Configuring scaler LUTs", obj_id);
     }
   }
 
-  it->second->Perform(code, req, args);
+  plane->Perform(code, req, args);
 }
 
 void DRMPlaneManager::Perform(DRMOps code, drmModeAtomicReq *req, uint32_t obj_id, ...) {
@@ -516,14 +528,15 @@ void DRMPlaneManager::Perform(DRMOps code, drmModeAtomicReq *req, uint32_t obj_i
 
 void DRMPlaneManager::DumpAll() {
   lock_guard<mutex> lock(lock_);
-  for (uint32_t i = 0; i < plane_pool_.size(); i++) {
-    plane_pool_[i]->Dump();
+  for (auto &plane : planes_) {
+    plane.second->Dump();
   }
+  DRMBlobStats::Dump();
 }
 
 void DRMPlaneManager::GetPlanesInfo(DRMPlanesInfo *info) {
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     info->push_back(std::make_pair(plane.first, plane.second->GetPlaneTypeInfo()));
   }
 }
@@ -532,7 +545,7 @@ void DRMPlaneManager::UnsetUnusedResources(uint32_t crtc_id, bool is_commit, drm
   // Unset planes that were assigned to the crtc referred to by crtc_id but are not requested
   // in this round
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     uint32_t assigned_crtc = 0;
     uint32_t requested_crtc = 0;
     plane.second->GetAssignedCrtc(&assigned_crtc);
@@ -548,7 +561,7 @@ void DRMPlaneManager::UnsetUnusedResources(uint32_t crtc_id, bool is_commit, drm
 
 void DRMPlaneManager::RetainPlanes(uint32_t crtc_id) {
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     uint32_t assigned_crtc = 0;
     plane.second->GetAssignedCrtc(&assigned_crtc);
     if (assigned_crtc == crtc_id) {
@@ -562,7 +575,7 @@ void DRMPlaneManager::RetainPlanes(uint32_t crtc_id) {
 
 void DRMPlaneManager::PostValidate(uint32_t crtc_id, bool success) {
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     plane.second->PostValidate(crtc_id, success);
   }
 }
@@ -570,46 +583,42 @@ void DRMPlaneManager::PostValidate(uint32_t crtc_id, bool success) {
 void DRMPlaneManager::PostCommit(uint32_t crtc_id, bool success) {
   lock_guard<mutex> lock(lock_);
   DRM_LOGD("crtc %d", crtc_id);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     plane.second->PostCommit(crtc_id, success);
   }
 }
 
 void DRMPlaneManager::SetScalerLUT(const DRMScalerLUTInfo &lut_info) {
   lock_guard<mutex> lock(lock_);
-  if (lut_info.dir_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.dir_lut),
-                              lut_info.dir_lut_size, &dir_lut_blob_id_);
-  }
-  if (lut_info.cir_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.cir_lut),
-                              lut_info.cir_lut_size, &cir_lut_blob_id_);
-  }
-  if (lut_info.sep_lut_size) {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(lut_info.sep_lut),
-                              lut_info.sep_lut_size, &sep_lut_blob_id_);
-  }
+  // Re-reference live blobs when LUT content is unchanged; mode switches commonly
+  // re-program identical LUT sets.
+  UpdateLUTBlob(fd_, lut_info.dir_lut, lut_info.dir_lut_size, &dir_lut_blob_id_,
+                &dir_lut_checksum_, kBlobObjectPlane);
+  UpdateLUTBlob(fd_, lut_info.cir_lut, lut_info.cir_lut_size, &cir_lut_blob_id_,
+                &cir_lut_checksum_, kBlobObjectPlane);
+  UpdateLUTBlob(fd_, lut_info.sep_lut, lut_info.sep_lut_size, &sep_lut_blob_id_,
+                &sep_lut_checksum_, kBlobObjectPlane);
 }
 
 void DRMPlaneManager::UnsetScalerLUT() {
   lock_guard<mutex> lock(lock_);
   if (dir_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, dir_lut_blob_id_);
+    DestroyBlob(fd_, dir_lut_blob_id_, kBlobObjectPlane);
     dir_lut_blob_id_ = 0;
   }
   if (cir_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, cir_lut_blob_id_);
+    DestroyBlob(fd_, cir_lut_blob_id_, kBlobObjectPlane);
     cir_lut_blob_id_ = 0;
   }
   if (sep_lut_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, sep_lut_blob_id_);
+    DestroyBlob(fd_, sep_lut_blob_id_, kBlobObjectPlane);
     sep_lut_blob_id_ = 0;
   }
 }
 
 void DRMPlaneManager::ResetCache(drmModeAtomicReq *req, uint32_t crtc_id) {
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     uint32_t assigned_crtc = 0;
     plane.second->GetAssignedCrtc(&assigned_crtc);
     if (assigned_crtc == crtc_id) {
@@ -620,7 +629,7 @@ void DRMPlaneManager::ResetCache(drmModeAtomicReq *req, uint32_t crtc_id) {
 
 void DRMPlaneManager::ResetPlanesLUT(drmModeAtomicReq *req) {
   lock_guard<mutex> lock(lock_);
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     plane.second->ResetPlanesLUT(req);
   }
 }
@@ -635,7 +644,7 @@ void DRMPlaneManager::MapPlaneToCrtc(std::map<uint32_t, uint32_t> *plane_to_crtc
 
   plane_to_crtc->clear();
 
-  for (auto &plane : plane_pool_) {
+  for (auto &plane : planes_) {
     uint32_t crtc_id = 0;
     plane.second->GetCrtc(&crtc_id);
     if (crtc_id)
@@ -656,7 +665,7 @@ void DRMPlaneManager::GetPlaneIdsFromDescriptions(FetchResourceList &description
     }
     const int32_t &idx = std::get<1>(desc);
     const int8_t &rect = std::get<2>(desc);
-    for (auto &p : plane_pool_) {
+    for (auto &p : planes_) {
       DRMPlaneType plane_type;
       p.second->GetType(&plane_type);
       uint8_t plane_idx;
@@ -1033,8 +1042,8 @@ bool DRMPlane::SetFp16CscConfig(drmModeAtomicReq *req, DRMFp16CscType csc_type)
     }
 #endif
     UnsetFp16CscConfig();
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(&csc_fp16_convert[csc_type]),
-                              sizeof(drm_msm_fp16_csc), &fp16_csc_blob_id_);
+    CreateBlob(fd_, reinterpret_cast<void *>(&csc_fp16_convert[csc_type]),
+                              sizeof(drm_msm_fp16_csc), &fp16_csc_blob_id_, kBlobObjectPlane);
     AddProperty(req, drm_plane_->plane_id, prop_id, fp16_csc_blob_id_, false /* cache */,
                 tmp_prop_val_map_);
   }
@@ -1088,8 +1097,8 @@ bool DRMPlane::SetFp16GcConfig(drmModeAtomicReq *req, drm_msm_fp16_gc *fp16_gc_c
     }
 #endif
     UnsetFp16GcConfig();
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(fp16_gc_config),
-                              sizeof(drm_msm_fp16_gc), &fp16_gc_blob_id_);
+    CreateBlob(fd_, reinterpret_cast<void *>(fp16_gc_config),
+                              sizeof(drm_msm_fp16_gc), &fp16_gc_blob_id_, kBlobObjectPlane);
     AddProperty(req, drm_plane_->plane_id, prop_id, fp16_gc_blob_id_, false /* cache */,
                 tmp_prop_val_map_);
   }
@@ -1101,14 +1110,14 @@ bool DRMPlane::SetFp16GcConfig(drmModeAtomicReq *req, drm_msm_fp16_gc *fp16_gc_c
 
 void DRMPlane::UnsetFp16CscConfig() {
   if (fp16_csc_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, fp16_csc_blob_id_);
+    DestroyBlob(fd_, fp16_csc_blob_id_, kBlobObjectPlane);
     fp16_csc_blob_id_ = 0;
   }
 }
 
 void DRMPlane::UnsetFp16GcConfig() {
   if (fp16_gc_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, fp16_gc_blob_id_);
+    DestroyBlob(fd_, fp16_gc_blob_id_, kBlobObjectPlane);
     fp16_gc_blob_id_ = 0;
   }
 }
@@ -1126,8 +1135,8 @@ void DRMPlane::SetUcscCscConfig(drmModeAtomicReq *req, drm_msm_ucsc_csc *ucsc_cs
     AddProperty(req, drm_plane_->plane_id, prop_id, 0, false /* cache */, tmp_prop_val_map_);
     DRM_LOGD("Plane %d: Resetting UCSC CSC", drm_plane_->plane_id);
   } else {
-    drmModeCreatePropertyBlob(fd_, reinterpret_cast<void *>(ucsc_csc_config),
-                              sizeof(drm_msm_ucsc_csc), &ucsc_csc_blob_id_);
+    CreateBlob(fd_, reinterpret_cast<void *>(ucsc_csc_config),
+                              sizeof(drm_msm_ucsc_csc), &ucsc_csc_blob_id_, kBlobObjectPlane);
     AddProperty(req, drm_plane_->plane_id, prop_id, ucsc_csc_blob_id_, false /* cache */,
                 tmp_prop_val_map_);
     DRM_LOGD("Plane %d: Setting UCSC CSC", drm_plane_->plane_id);
@@ -1136,7 +1145,7 @@ void DRMPlane::SetUcscCscConfig(drmModeAtomicReq *req, drm_msm_ucsc_csc *ucsc_cs
 
 void DRMPlane::UnsetUcscCscConfig() {
   if (ucsc_csc_blob_id_) {
-    drmModeDestroyPropertyBlob(fd_, ucsc_csc_blob_id_);
+    DestroyBlob(fd_, ucsc_csc_blob_id_, kBlobObjectPlane);
     ucsc_csc_blob_id_ = 0;
   }
 }
@@ -1622,6 +1631,23 @@ void DRMPlane::Dump() {
   DRM_LOGE("Format Suported: \n");
   for (uint32_t i = 0; i < (uint32_t)drm_plane_->count_formats; i++)
     DRM_LOGE(" %4.4s", (char *)&drm_plane_->formats[i]);
+
+  // Built only when the dump actually runs; the names are interned, so this allocates
+  // nothing beyond the line buffer.
+  char props[1024] = {};
+  size_t used = 0;
+  for (uint32_t i = 1; i < (uint32_t)DRMProperty::MAX; i++) {
+    if (!prop_mgr_.IsPropertyAvailable((DRMProperty)i)) {
+      continue;
+    }
+    int written = snprintf(props + used, sizeof(props) - used, " %s",
+                           GetDRMPropertyName((DRMProperty)i));
+    if (written < 0 || used + written >= sizeof(props)) {
+      break;
+    }
+    used += written;
+  }
+  DRM_LOGE("Properties:%s", props);
 }
 
 void DRMPlane::SetMultiRectMode(drmModeAtomicReq *req, DRMMultiRectMode drm_multirect_mode) {
@@ -43,6 +43,8 @@
 #include <string>
 #include <tuple>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 #include "drm_property.h"
 #include "drm_pp_manager.h"
@@ -169,14 +171,24 @@ class DRMPlaneManager {
 
  private:
   void Perform(DRMOps code, drmModeAtomicReq *req, uint32_t obj_id, ...);
+  DRMPlane *GetPlane(uint32_t plane_id) {
+    return (plane_id < plane_lookup_.size()) ? plane_lookup_[plane_id] : nullptr;
+  }
 
   int fd_ = -1;
   // Map of plane id to DRMPlane *
   std::map<uint32_t, std::unique_ptr<DRMPlane>> plane_pool_{};
-  // Global Scaler LUT blobs
+  // Built once at Init(): dense O(1) lookup by plane object id (null holes) and
+  // a flat iteration list in enumeration (priority) order. plane_pool_ owns.
+  std::vector<DRMPlane *> plane_lookup_{};
+  std::vector<std::pair<uint32_t, DRMPlane *>> planes_{};
+  // Global Scaler LUT blobs with payload checksums for re-upload dedup
   uint32_t dir_lut_blob_id_ = 0;
   uint32_t cir_lut_blob_id_ = 0;
   uint32_t sep_lut_blob_id_ = 0;
+  uint64_t dir_lut_checksum_ = 0;
+  uint64_t cir_lut_checksum_ = 0;
+  uint64_t sep_lut_checksum_ = 0;
   std::mutex lock_;
 };
 
@@ -72,30 +72,84 @@
 #include <drm_logger.h>
 #include <cstring>
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
 #include <map>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "drm_pp_manager.h"
+#include "drm_utils.h"
 #include "drm_property.h"
 
 #define __CLASS__ "DRMPPManager"
 namespace sde_drm {
 
+#ifdef PP_DRM_ENABLE
+namespace {
+
+// Deferred blob destruction. Destroy ioctls for evicted blobs run on this reaper thread so
+// the commit thread never blocks on them; the kernel holds its own reference for any state
+// still scanning out of a blob, so destruction order does not matter.
+std::mutex g_blob_reaper_lock;
+std::condition_variable g_blob_reaper_cv;
+std::vector<std::pair<int, uint32_t>> g_blob_reaper_queue;
+bool g_blob_reaper_running = false;
+
+void BlobReaperLoop() {
+  std::unique_lock<std::mutex> lock(g_blob_reaper_lock);
+  while (true) {
+    g_blob_reaper_cv.wait(lock, [] { return !g_blob_reaper_queue.empty(); });
+    std::vector<std::pair<int, uint32_t>> batch;
+    batch.swap(g_blob_reaper_queue);
+    lock.unlock();
+    for (auto &entry : batch) {
+      int ret = DestroyBlob(entry.first, entry.second, kBlobObjectPPFeature);
+      if (ret) {
+        DRM_LOGE("failed to destroy property blob %u, ret = %d", entry.second, ret);
+      }
+    }
+    lock.lock();
+  }
+}
+
+void DeferBlobDestroy(int fd, uint32_t blob_id) {
+  std::lock_guard<std::mutex> guard(g_blob_reaper_lock);
+  if (!g_blob_reaper_running) {
+    std::thread(BlobReaperLoop).detach();
+    g_blob_reaper_running = true;
+  }
+  g_blob_reaper_queue.push_back({fd, blob_id});
+  g_blob_reaper_cv.notify_one();
+}
+
+uint64_t HashBlobPayload(const void *payload, uint32_t size) {
+  const uint8_t *bytes = reinterpret_cast<const uint8_t *>(payload);
+  uint64_t hash = 14695981039346656037ULL;  // FNV-1a
+  for (uint32_t i = 0; i < size; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+}  // namespace
+#endif
+
 DRMPPManager::DRMPPManager(int fd) : fd_(fd) {
 }
 
 DRMPPManager::~DRMPPManager() {
 #ifdef PP_DRM_ENABLE
-  DRMPPPropInfo prop_info = {};
-
-  /* free previously created blob to avoid memory leak */
+  /* free previously created blobs to avoid memory leak; teardown is off the frame path so
+   * destroy synchronously rather than racing the reaper against fd close */
   for (int i = 0; i < kPPFeaturesMax; i++) {
-    prop_info = pp_prop_map_[i];
     for (int j = 0; j < NUM_CACHED_BLOB_ID; j++) {
-      if (prop_info.blob_id[j] > 0) {
-        drmModeDestroyPropertyBlob(fd_, prop_info.blob_id[j]);
-        prop_info.blob_id[j] = 0;
+      if (pp_prop_map_[i].blob_cache[j].blob_id > 0) {
+        DestroyBlob(fd_, pp_prop_map_[i].blob_cache[j].blob_id, kBlobObjectPPFeature);
+        pp_prop_map_[i].blob_cache[j] = {};
       }
     }
   }
@@ -338,25 +392,30 @@ int DRMPPManager::SetPPBlobProperty(drmModeAtomicReq *req, uint32_t obj_id,
     return 0;
   }
 
-  /* free previously created blob for this feature if exist */
-  if (prop_info->blob_id[prop_info->blob_id_index] > 0) {
-    ret = drmModeDestroyPropertyBlob(fd_, prop_info->blob_id[prop_info->blob_id_index]);
-    if (ret) {
-      DRM_LOGE("failed to destroy property blob for feature %d, ret = %d", feature.id, ret);
-      return ret;
-    } else {
-      prop_info->blob_id[prop_info->blob_id_index] = 0;
+  /* reuse a ready-made blob when this payload was applied before; hashing the payload is much
+   * cheaper than the create ioctl plus the eventual destroy */
+  uint64_t hash = HashBlobPayload(feature.payload, feature.payload_size);
+  for (int i = 0; i < NUM_CACHED_BLOB_ID; i++) {
+    DRMPPBlobCacheEntry &entry = prop_info->blob_cache[i];
+    if (entry.blob_id > 0 && entry.hash == hash && entry.payload_size == feature.payload_size) {
+      drmModeAtomicAddProperty(req, obj_id, prop_info->prop_id, entry.blob_id);
+      return 0;
     }
   }
 
-  ret = drmModeCreatePropertyBlob(fd_, feature.payload, feature.payload_size, &blob_id);
+  ret = CreateBlob(fd_, feature.payload, feature.payload_size, &blob_id, kBlobObjectPPFeature);
   if (ret || blob_id == 0) {
     DRM_LOGE("failed to create property blob ret %d, blob_id = %d", ret, blob_id);
     return DRM_ERR_INVALID;
   }
 
-  prop_info->blob_id[prop_info->blob_id_index] = blob_id;
-  prop_info->blob_id_index = (++prop_info->blob_id_index) % NUM_CACHED_BLOB_ID;
+  /* evict the oldest cached blob off the frame path */
+  DRMPPBlobCacheEntry &slot = prop_info->blob_cache[prop_info->blob_cache_index];
+  if (slot.blob_id > 0) {
+    DeferBlobDestroy(fd_, slot.blob_id);
+  }
+  slot = {hash, feature.payload_size, blob_id};
+  prop_info->blob_cache_index = (prop_info->blob_cache_index + 1) % NUM_CACHED_BLOB_ID;
   drmModeAtomicAddProperty(req, obj_id, prop_info->prop_id, blob_id);
 
 #endif
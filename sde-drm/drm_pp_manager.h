@@ -35,16 +35,24 @@
 #include "drm_interface.h"
 #include "drm_property.h"
 
-#define NUM_CACHED_BLOB_ID 2
+#define NUM_CACHED_BLOB_ID 4
 
 namespace sde_drm {
 
+struct DRMPPBlobCacheEntry {
+  uint64_t hash = 0;
+  uint32_t payload_size = 0;
+  uint32_t blob_id = 0;
+};
+
 struct DRMPPPropInfo {
   DRMProperty prop_enum;
   uint32_t version = std::numeric_limits<uint32_t>::max();
   uint32_t prop_id;
-  uint32_t blob_id[NUM_CACHED_BLOB_ID];
-  uint32_t blob_id_index;
+  // Ready-made blobs for recently applied payloads. Color mode transitions toggle between a
+  // small set of LUTs, so a hit turns the create ioctl into a lookup.
+  DRMPPBlobCacheEntry blob_cache[NUM_CACHED_BLOB_ID];
+  uint32_t blob_cache_index;  // next eviction slot
 };
 
 class DRMPPManager {
@@ -65,188 +65,215 @@
 
 #include "drm_property.h"
 
+#include <unordered_map>
+#include <vector>
+
 namespace sde_drm {
 
-// clang-format off
+namespace {
+
+// Single name -> enum table shared by every DRM object's property manager. Each plane, crtc and
+// connector probes the same kernel property set during Init(), so resolving names through one
+// hash lookup instead of a chain of string comparisons keeps startup and hotplug re-probe cost
+// proportional to the property count rather than its square.
+const std::unordered_map<std::string, DRMProperty> &GetPropertyNameMap() {
+  // clang-format off
+  static const std::unordered_map<std::string, DRMProperty> name_map = {
+    {"type", DRMProperty::TYPE},
+    {"FB_ID", DRMProperty::FB_ID},
+    {"rot_fb_id", DRMProperty::ROT_FB_ID},
+    {"CRTC_ID", DRMProperty::CRTC_ID},
+    {"CRTC_X", DRMProperty::CRTC_X},
+    {"CRTC_Y", DRMProperty::CRTC_Y},
+    {"CRTC_W", DRMProperty::CRTC_W},
+    {"CRTC_H", DRMProperty::CRTC_H},
+    {"SRC_X", DRMProperty::SRC_X},
+    {"SRC_Y", DRMProperty::SRC_Y},
+    {"SRC_W", DRMProperty::SRC_W},
+    {"SRC_H", DRMProperty::SRC_H},
+    {"zpos", DRMProperty::ZPOS},
+    {"alpha", DRMProperty::ALPHA},
+    {"excl_rect_v1", DRMProperty::EXCL_RECT},
+    {"h_decimate", DRMProperty::H_DECIMATE},
+    {"v_decimate", DRMProperty::V_DECIMATE},
+    {"input_fence", DRMProperty::INPUT_FENCE},
+    {"rotation", DRMProperty::ROTATION},
+    {"blend_op", DRMProperty::BLEND_OP},
+    {"src_config", DRMProperty::SRC_CONFIG},
+    {"scaler_v1", DRMProperty::SCALER_V1},
+    {"scaler_v2", DRMProperty::SCALER_V2},
+    {"csc_v1", DRMProperty::CSC_V1},
+    {"capabilities", DRMProperty::CAPABILITIES},
+    {"mode_properties", DRMProperty::MODE_PROPERTIES},
+    {"lut_ed", DRMProperty::LUT_ED},
+    {"lut_cir", DRMProperty::LUT_CIR},
+    {"lut_sep", DRMProperty::LUT_SEP},
+    {"rot_caps_v1", DRMProperty::ROTATOR_CAPS_V1},
+    {"true_inline_rot_rev", DRMProperty::TRUE_INLINE_ROT_REV},
+    {"fb_translation_mode", DRMProperty::FB_TRANSLATION_MODE},
+    {"ACTIVE", DRMProperty::ACTIVE},
+    {"MODE_ID", DRMProperty::MODE_ID},
+    {"output_fence_offset", DRMProperty::OUTPUT_FENCE_OFFSET},
+    {"output_fence", DRMProperty::OUTPUT_FENCE},
+    {"sde_drm_roi_v1", DRMProperty::ROI_V1},
+    {"core_clk", DRMProperty::CORE_CLK},
+    {"core_ab", DRMProperty::CORE_AB},
+    {"core_ib", DRMProperty::CORE_IB},
+    {"llcc_ab", DRMProperty::LLCC_AB},
+    {"llcc_ib", DRMProperty::LLCC_IB},
+    {"dram_ab", DRMProperty::DRAM_AB},
+    {"dram_ib", DRMProperty::DRAM_IB},
+    {"rot_prefill_bw", DRMProperty::ROT_PREFILL_BW},
+    {"rot_clk", DRMProperty::ROT_CLK},
+    {"security_level", DRMProperty::SECURITY_LEVEL},
+    {"dim_layer_v1", DRMProperty::DIM_STAGES_V1},
+    {"idle_time", DRMProperty::IDLE_TIME},
+    {"RETIRE_FENCE", DRMProperty::RETIRE_FENCE},
+    {"RETIRE_FENCE_OFFSET", DRMProperty::RETIRE_FENCE_OFFSET},
+    {"DST_X", DRMProperty::DST_X},
+    {"DST_Y", DRMProperty::DST_Y},
+    {"DST_W", DRMProperty::DST_W},
+    {"DST_H", DRMProperty::DST_H},
+    {"LP", DRMProperty::LP},
+    {"dest_scaler", DRMProperty::DEST_SCALER},
+    {"ds_lut_ed", DRMProperty::DS_LUT_ED},
+    {"ds_lut_cir", DRMProperty::DS_LUT_CIR},
+    {"ds_lut_sep", DRMProperty::DS_LUT_SEP},
+    {"hdr_properties", DRMProperty::HDR_PROPERTIES},
+    {"SDE_DSPP_GAMUT_V3", DRMProperty::SDE_DSPP_GAMUT_V3},
+    {"SDE_DSPP_GAMUT_V4", DRMProperty::SDE_DSPP_GAMUT_V4},
+    {"SDE_DSPP_GAMUT_V5", DRMProperty::SDE_DSPP_GAMUT_V5},
+    {"SDE_DSPP_GC_V1", DRMProperty::SDE_DSPP_GC_V1},
+    {"SDE_DSPP_GC_V2", DRMProperty::SDE_DSPP_GC_V2},
+    {"SDE_DSPP_IGC_V2", DRMProperty::SDE_DSPP_IGC_V2},
+    {"SDE_DSPP_IGC_V3", DRMProperty::SDE_DSPP_IGC_V3},
+    {"SDE_DSPP_IGC_V4", DRMProperty::SDE_DSPP_IGC_V4},
+    {"SDE_DSPP_PCC_V3", DRMProperty::SDE_DSPP_PCC_V3},
+    {"SDE_DSPP_PCC_V4", DRMProperty::SDE_DSPP_PCC_V4},
+    {"SDE_DSPP_PCC_V5", DRMProperty::SDE_DSPP_PCC_V5},
+    {"SDE_DSPP_PA_HSIC_V1", DRMProperty::SDE_DSPP_PA_HSIC_V1},
+    {"SDE_DSPP_PA_HSIC_V2", DRMProperty::SDE_DSPP_PA_HSIC_V2},
+    {"SDE_DSPP_PA_SIXZONE_V1", DRMProperty::SDE_DSPP_PA_SIXZONE_V1},
+    {"SDE_DSPP_PA_SIXZONE_V2", DRMProperty::SDE_DSPP_PA_SIXZONE_V2},
+    {"SDE_DSPP_PA_MEMCOL_SKIN_V1", DRMProperty::SDE_DSPP_PA_MEMCOL_SKIN_V1},
+    {"SDE_DSPP_PA_MEMCOL_SKIN_V2", DRMProperty::SDE_DSPP_PA_MEMCOL_SKIN_V2},
+    {"SDE_DSPP_PA_MEMCOL_SKY_V1", DRMProperty::SDE_DSPP_PA_MEMCOL_SKY_V1},
+    {"SDE_DSPP_PA_MEMCOL_SKY_V2", DRMProperty::SDE_DSPP_PA_MEMCOL_SKY_V2},
+    {"SDE_DSPP_PA_MEMCOL_FOLIAGE_V1", DRMProperty::SDE_DSPP_PA_MEMCOL_FOLIAGE_V1},
+    {"SDE_DSPP_PA_MEMCOL_FOLIAGE_V2", DRMProperty::SDE_DSPP_PA_MEMCOL_FOLIAGE_V2},
+    {"SDE_DSPP_PA_MEMCOL_PROT_V1", DRMProperty::SDE_DSPP_PA_MEMCOL_PROT_V1},
+    {"SDE_DSPP_PA_MEMCOL_PROT_V2", DRMProperty::SDE_DSPP_PA_MEMCOL_PROT_V2},
+    {"autorefresh", DRMProperty::AUTOREFRESH},
+    {"ext_hdr_properties", DRMProperty::EXT_HDR_PROPERTIES},
+    {"hdr_metadata", DRMProperty::HDR_METADATA},
+    {"multirect_mode", DRMProperty::MULTIRECT_MODE},
+    {"SDE_DSPP_PA_DITHER_V1", DRMProperty::SDE_DSPP_PA_DITHER_V1},
+    {"SDE_DSPP_PA_DITHER_V2", DRMProperty::SDE_DSPP_PA_DITHER_V2},
+    {"SDE_PP_DITHER_V1", DRMProperty::SDE_PP_DITHER_V1},
+    {"SDE_PP_DITHER_V2", DRMProperty::SDE_PP_DITHER_V2},
+    {"inverse_pma", DRMProperty::INVERSE_PMA},
+    {"csc_dma_v1", DRMProperty::CSC_DMA_V1},
+    {"SDE_DGM_1D_LUT_IGC_V5", DRMProperty::SDE_DGM_1D_LUT_IGC_V5},
+    {"SDE_DGM_1D_LUT_GC_V5", DRMProperty::SDE_DGM_1D_LUT_GC_V5},
+    {"SDE_VIG_1D_LUT_IGC_V5", DRMProperty::SDE_VIG_1D_LUT_IGC_V5},
+    {"SDE_VIG_3D_LUT_GAMUT_V5", DRMProperty::SDE_VIG_3D_LUT_GAMUT_V5},
+    {"SDE_DSPP_AD_V4_MODE", DRMProperty::SDE_DSPP_AD4_MODE},
+    {"SDE_DSPP_AD_V4_INIT", DRMProperty::SDE_DSPP_AD4_INIT},
+    {"SDE_DSPP_AD_V4_CFG", DRMProperty::SDE_DSPP_AD4_CFG},
+    {"SDE_DSPP_AD_V4_ASSERTIVENESS", DRMProperty::SDE_DSPP_AD4_ASSERTIVENESS},
+    {"SDE_DSPP_AD_V4_STRENGTH", DRMProperty::SDE_DSPP_AD4_STRENGTH},
+    {"SDE_DSPP_AD_V4_INPUT", DRMProperty::SDE_DSPP_AD4_INPUT},
+    {"SDE_DSPP_AD_V4_BACKLIGHT", DRMProperty::SDE_DSPP_AD4_BACKLIGHT},
+    {"SDE_DSPP_AD_V4_ROI", DRMProperty::SDE_DSPP_AD4_ROI},
+    {"SDE_DSPP_HIST_CTRL_V1", DRMProperty::SDE_DSPP_ABA_HIST_CTRL},
+    {"SDE_DSPP_HIST_IRQ_V1", DRMProperty::SDE_DSPP_ABA_HIST_IRQ},
+    {"SDE_DSPP_VLUT_V1", DRMProperty::SDE_DSPP_ABA_LUT},
+    {"bl_scale", DRMProperty::SDE_DSPP_BL_SCALE},
+    {"sv_bl_scale", DRMProperty::SDE_DSPP_SV_BL_SCALE},
+    {"capture_mode", DRMProperty::CAPTURE_MODE},
+    {"qsync_mode", DRMProperty::QSYNC_MODE},
+    {"idle_pc_state", DRMProperty::IDLE_PC_STATE},
+    {"topology_control", DRMProperty::TOPOLOGY_CONTROL},
+    {"EDID", DRMProperty::EDID},
+    {"SDE_DSPP_LTM_V1", DRMProperty::SDE_LTM_VERSION},
+    {"SDE_DSPP_LTM_INIT_V1", DRMProperty::SDE_LTM_INIT},
+    {"SDE_DSPP_LTM_ROI_V1", DRMProperty::SDE_LTM_CFG},
+    {"SDE_DSPP_LTM_HIST_THRESH_V1", DRMProperty::SDE_LTM_NOISE_THRESH},
+    {"SDE_DSPP_LTM_HIST_CTRL_V1", DRMProperty::SDE_LTM_HIST_CTRL},
+    {"SDE_DSPP_LTM_SET_BUF_V1", DRMProperty::SDE_LTM_BUFFER_CTRL},
+    {"SDE_DSPP_LTM_QUEUE_BUF_V1", DRMProperty::SDE_LTM_QUEUE_BUFFER},
+    {"SDE_DSPP_LTM_QUEUE_BUF2_V1", DRMProperty::SDE_LTM_QUEUE_BUFFER2},
+    {"SDE_DSPP_LTM_QUEUE_BUF3_V1", DRMProperty::SDE_LTM_QUEUE_BUFFER3},
+    {"SDE_DSPP_LTM_VLUT_V1", DRMProperty::SDE_LTM_VLUT},
+    {"SDE_VIG_1D_LUT_IGC_V6", DRMProperty::SDE_VIG_1D_LUT_IGC_V6},
+    {"SDE_VIG_3D_LUT_GAMUT_V6", DRMProperty::SDE_VIG_3D_LUT_GAMUT_V6},
+    {"frame_trigger_mode", DRMProperty::FRAME_TRIGGER},
+    {"Colorspace", DRMProperty::COLORSPACE},
+    {"supported_colorspaces", DRMProperty::SUPPORTED_COLORSPACES},
+    {"SDE_DSPP_SPR_DITHER_V1", DRMProperty::SDE_DSPP_SPR_DITHER_V1},
+    {"cache_state", DRMProperty::CACHE_STATE},
+    {"vm_request_state", DRMProperty::VM_REQ_STATE},
+    {"dspp_caps", DRMProperty::DSPP_CAPABILITIES},
+    {"SDE_SPR_INIT_CFG_V1", DRMProperty::SPR_INIT_CFG_V1},
+    {"SDE_SPR_INIT_CFG_V2", DRMProperty::SPR_INIT_CFG_V2},
+    {"SDE_SPR_UDC_CFG_V2", DRMProperty::SPR_UDC_CFG_V2},
+    {"SDE_DSPP_RC_MASK_V1", DRMProperty::DSPP_RC_MASK_V1},
+    {"panel_mode", DRMProperty::PANEL_MODE},
+    {"bpp_mode", DRMProperty::BPP_MODE},
+    {"SDE_DEMURA_INIT_CFG_V1", DRMProperty::DEMURA_INIT_CFG_V1},
+    {"SDE_DEMURA_CFG0_PARAM2", DRMProperty::DEMURA_CFG0_PARAM2},
+    {"DEMURA_PANEL_ID", DRMProperty::DEMURA_PANEL_ID},
+    {"SDE_DEMURA_BOOT_PLANE_V1", DRMProperty::DEMURA_BOOT_PLANE_V1},
+    {"dyn_bit_clk", DRMProperty::DYN_BIT_CLK},
+    {"SDE_PP_CWB_DITHER_V2", DRMProperty::SDE_PP_CWB_DITHER_V2},
+    {"noise_layer_v1", DRMProperty::NOISE_LAYER_V1},
+    {"dsc_mode", DRMProperty::DSC_MODE},
+    {"dimming_bl_lut", DRMProperty::DIMMING_BL_LUT},
+    {"dimming_dyn_ctrl", DRMProperty::DIMMING_DYN_CTRL},
+    {"dimming_min_bl", DRMProperty::DIMMING_MIN_BL},
+    {"dyn_transfer_time", DRMProperty::DYN_TRANSFER_TIME},
+    {"jitter_config", DRMProperty::JITTER_CONFIG},
+    {"transfer_time", DRMProperty::TRANSFER_TIME},
+    {"early_fence_line", DRMProperty::EARLY_FENCE_LINE},
+    {"dnsc_blur", DRMProperty::DNSC_BLR},
+    {"wb_usage_type", DRMProperty::WB_USAGE_TYPE},
+    {"SDE_SSPP_FP16_IGC_V1", DRMProperty::SDE_SSPP_FP16_IGC_V1},
+    {"SDE_SSPP_FP16_GC_V1", DRMProperty::SDE_SSPP_FP16_GC_V1},
+    {"SDE_SSPP_FP16_CSC_V1", DRMProperty::SDE_SSPP_FP16_CSC_V1},
+    {"SDE_SSPP_FP16_UNMULT_V1", DRMProperty::SDE_SSPP_FP16_UNMULT_V1},
+    {"SDE_SSPP_UCSC_UNMULT_V1", DRMProperty::SDE_SSPP_UCSC_UNMULT_V1},
+    {"SDE_SSPP_UCSC_IGC_V1", DRMProperty::SDE_SSPP_UCSC_IGC_V1},
+    {"SDE_SSPP_UCSC_CSC_V1", DRMProperty::SDE_SSPP_UCSC_CSC_V1},
+    {"SDE_SSPP_UCSC_GC_V1", DRMProperty::SDE_SSPP_UCSC_GC_V1},
+    {"SDE_SSPP_UCSC_ALPHA_DITHER_V1", DRMProperty::SDE_SSPP_UCSC_ALPHA_DITHER_V1},
+    {"EPT", DRMProperty::EPT},
+    {"brightness", DRMProperty::BRIGHTNESS},
+  };
+  // clang-format on
+  return name_map;
+}
+
+}  // namespace
+
 DRMProperty DRMPropertyManager::GetPropertyEnum(const std::string &name) const {
-  if (name == "type") { return DRMProperty::TYPE; }
-  if (name == "FB_ID") { return DRMProperty::FB_ID; }
-  if (name == "rot_fb_id") { return DRMProperty::ROT_FB_ID; }
-  if (name == "CRTC_ID") { return DRMProperty::CRTC_ID; }
-  if (name == "CRTC_X") { return DRMProperty::CRTC_X; }
-  if (name == "CRTC_Y") { return DRMProperty::CRTC_Y; }
-  if (name == "CRTC_W") { return DRMProperty::CRTC_W; }
-  if (name == "CRTC_H") { return DRMProperty::CRTC_H; }
-  if (name == "SRC_X") { return DRMProperty::SRC_X; }
-  if (name == "SRC_Y") { return DRMProperty::SRC_Y; }
-  if (name == "SRC_W") { return DRMProperty::SRC_W; }
-  if (name == "SRC_H") { return DRMProperty::SRC_H; }
-  if (name == "zpos") { return DRMProperty::ZPOS; }
-  if (name == "alpha") { return DRMProperty::ALPHA; }
-  if (name == "excl_rect_v1") { return DRMProperty::EXCL_RECT; }
-  if (name == "h_decimate") { return DRMProperty::H_DECIMATE; }
-  if (name == "v_decimate") { return DRMProperty::V_DECIMATE; }
-  if (name == "input_fence") { return DRMProperty::INPUT_FENCE; }
-  if (name == "rotation") { return DRMProperty::ROTATION; }
-  if (name == "blend_op") { return DRMProperty::BLEND_OP; }
-  if (name == "src_config") { return DRMProperty::SRC_CONFIG; }
-  if (name == "scaler_v1") { return DRMProperty::SCALER_V1; }
-  if (name == "scaler_v2") { return DRMProperty::SCALER_V2; }
-  if (name == "csc_v1") { return DRMProperty::CSC_V1; }
-  if (name == "capabilities") { return DRMProperty::CAPABILITIES; }
-  if (name == "mode_properties") { return DRMProperty::MODE_PROPERTIES; }
-  if (name == "lut_ed") { return DRMProperty::LUT_ED; }
-  if (name == "lut_cir") { return DRMProperty::LUT_CIR; }
-  if (name == "lut_sep") { return DRMProperty::LUT_SEP; }
-  if (name == "rot_caps_v1") { return DRMProperty::ROTATOR_CAPS_V1; }
-  if (name == "true_inline_rot_rev") { return DRMProperty::TRUE_INLINE_ROT_REV; }
-  if (name == "fb_translation_mode") { return DRMProperty::FB_TRANSLATION_MODE; }
-  if (name == "ACTIVE") { return DRMProperty::ACTIVE; }
-  if (name == "MODE_ID") { return DRMProperty::MODE_ID; }
-  if (name == "output_fence_offset") { return DRMProperty::OUTPUT_FENCE_OFFSET; }
-  if (name == "output_fence") { return DRMProperty::OUTPUT_FENCE; }
-  if (name == "sde_drm_roi_v1") { return DRMProperty::ROI_V1; }
-  if (name == "core_clk") { return DRMProperty::CORE_CLK; }
-  if (name == "core_ab") { return DRMProperty::CORE_AB; }
-  if (name == "core_ib") { return DRMProperty::CORE_IB; }
-  if (name == "llcc_ab") { return DRMProperty::LLCC_AB; }
-  if (name == "llcc_ib") { return DRMProperty::LLCC_IB; }
-  if (name == "dram_ab") { return DRMProperty::DRAM_AB; }
-  if (name == "dram_ib") { return DRMProperty::DRAM_IB; }
-  if (name == "rot_prefill_bw") { return DRMProperty::ROT_PREFILL_BW; }
-  if (name == "rot_clk") { return DRMProperty::ROT_CLK; }
-  if (name == "security_level") { return DRMProperty::SECURITY_LEVEL; }
-  if (name == "dim_layer_v1") { return DRMProperty::DIM_STAGES_V1; }
-  if (name == "idle_time") { return DRMProperty::IDLE_TIME; }
-  if (name == "RETIRE_FENCE") { return DRMProperty::RETIRE_FENCE; }
-  if (name == "RETIRE_FENCE_OFFSET") { return DRMProperty::RETIRE_FENCE_OFFSET; }
-  if (name == "DST_X") { return DRMProperty::DST_X; }
-  if (name == "DST_Y") { return DRMProperty::DST_Y; }
-  if (name == "DST_W") { return DRMProperty::DST_W; }
-  if (name == "DST_H") { return DRMProperty::DST_H; }
-  if (name == "LP") { return DRMProperty::LP; }
-  if (name == "dest_scaler") { return DRMProperty::DEST_SCALER; }
-  if (name == "ds_lut_ed") { return DRMProperty::DS_LUT_ED; }
-  if (name == "ds_lut_cir") { return DRMProperty::DS_LUT_CIR; }
-  if (name == "ds_lut_sep") { return DRMProperty::DS_LUT_SEP; }
-  if (name == "hdr_properties") { return DRMProperty::HDR_PROPERTIES; }
-  if (name == "SDE_DSPP_GAMUT_V3") { return DRMProperty::SDE_DSPP_GAMUT_V3; }
-  if (name == "SDE_DSPP_GAMUT_V4") { return DRMProperty::SDE_DSPP_GAMUT_V4; }
-  if (name == "SDE_DSPP_GAMUT_V5") { return DRMProperty::SDE_DSPP_GAMUT_V5; }
-  if (name == "SDE_DSPP_GC_V1") { return DRMProperty::SDE_DSPP_GC_V1; }
-  if (name == "SDE_DSPP_GC_V2") { return DRMProperty::SDE_DSPP_GC_V2; }
-  if (name == "SDE_DSPP_IGC_V2") { return DRMProperty::SDE_DSPP_IGC_V2; }
-  if (name == "SDE_DSPP_IGC_V3") { return DRMProperty::SDE_DSPP_IGC_V3; }
-  if (name == "SDE_DSPP_IGC_V4") { return DRMProperty::SDE_DSPP_IGC_V4; }
-  if (name == "SDE_DSPP_PCC_V3") { return DRMProperty::SDE_DSPP_PCC_V3; }
-  if (name == "SDE_DSPP_PCC_V4") { return DRMProperty::SDE_DSPP_PCC_V4; }
-  if (name == "SDE_DSPP_PCC_V5") { return DRMProperty::SDE_DSPP_PCC_V5; }
-  if (name == "SDE_DSPP_PA_HSIC_V1") { return DRMProperty::SDE_DSPP_PA_HSIC_V1; }
-  if (name == "SDE_DSPP_PA_HSIC_V2") { return DRMProperty::SDE_DSPP_PA_HSIC_V2; }
-  if (name == "SDE_DSPP_PA_SIXZONE_V1") { return DRMProperty::SDE_DSPP_PA_SIXZONE_V1; }
-  if (name == "SDE_DSPP_PA_SIXZONE_V2") { return DRMProperty::SDE_DSPP_PA_SIXZONE_V2; }
-  if (name == "SDE_DSPP_PA_MEMCOL_SKIN_V1") { return DRMProperty::SDE_DSPP_PA_MEMCOL_SKIN_V1; }
-  if (name == "SDE_DSPP_PA_MEMCOL_SKIN_V2") { return DRMProperty::SDE_DSPP_PA_MEMCOL_SKIN_V2; }
-  if (name == "SDE_DSPP_PA_MEMCOL_SKY_V1") { return DRMProperty::SDE_DSPP_PA_MEMCOL_SKY_V1; }
-  if (name == "SDE_DSPP_PA_MEMCOL_SKY_V2") { return DRMProperty::SDE_DSPP_PA_MEMCOL_SKY_V2; }
-  if (name == "SDE_DSPP_PA_MEMCOL_FOLIAGE_V1") { return DRMProperty::SDE_DSPP_PA_MEMCOL_FOLIAGE_V1; }
-  if (name == "SDE_DSPP_PA_MEMCOL_FOLIAGE_V2") { return DRMProperty::SDE_DSPP_PA_MEMCOL_FOLIAGE_V2; }
-  if (name == "SDE_DSPP_PA_MEMCOL_PROT_V1") { return DRMProperty::SDE_DSPP_PA_MEMCOL_PROT_V1; }
-  if (name == "SDE_DSPP_PA_MEMCOL_PROT_V2") { return DRMProperty::SDE_DSPP_PA_MEMCOL_PROT_V2; }
-  if (name == "autorefresh") { return DRMProperty::AUTOREFRESH; }
-  if (name == "ext_hdr_properties") { return DRMProperty::EXT_HDR_PROPERTIES; }
-  if (name == "hdr_metadata") { return DRMProperty::HDR_METADATA; }
-  if (name == "multirect_mode") { return DRMProperty::MULTIRECT_MODE; }
-  if (name == "SDE_DSPP_PA_DITHER_V1") { return DRMProperty::SDE_DSPP_PA_DITHER_V1; }
-  if (name == "SDE_DSPP_PA_DITHER_V2") { return DRMProperty::SDE_DSPP_PA_DITHER_V2; }
-  if (name == "SDE_PP_DITHER_V1") { return DRMProperty::SDE_PP_DITHER_V1; }
-  if (name == "SDE_PP_DITHER_V2") { return DRMProperty::SDE_PP_DITHER_V2; }
-  if (name == "inverse_pma") { return DRMProperty::INVERSE_PMA; }
-  if (name == "csc_dma_v1") { return DRMProperty::CSC_DMA_V1; }
-  if (name == "SDE_DGM_1D_LUT_IGC_V5") { return DRMProperty::SDE_DGM_1D_LUT_IGC_V5; }
-  if (name == "SDE_DGM_1D_LUT_GC_V5") { return DRMProperty::SDE_DGM_1D_LUT_GC_V5; }
-  if (name == "SDE_VIG_1D_LUT_IGC_V5") { return DRMProperty::SDE_VIG_1D_LUT_IGC_V5; }
-  if (name == "SDE_VIG_3D_LUT_GAMUT_V5") { return DRMProperty::SDE_VIG_3D_LUT_GAMUT_V5; }
-  if (name == "SDE_DSPP_AD_V4_MODE") { return DRMProperty::SDE_DSPP_AD4_MODE; }
-  if (name == "SDE_DSPP_AD_V4_INIT") { return DRMProperty::SDE_DSPP_AD4_INIT; }
-  if (name == "SDE_DSPP_AD_V4_CFG") { return DRMProperty::SDE_DSPP_AD4_CFG; }
-  if (name == "SDE_DSPP_AD_V4_ASSERTIVENESS") { return DRMProperty::SDE_DSPP_AD4_ASSERTIVENESS; }
-  if (name == "SDE_DSPP_AD_V4_STRENGTH") { return DRMProperty::SDE_DSPP_AD4_STRENGTH; }
-  if (name == "SDE_DSPP_AD_V4_INPUT") { return DRMProperty::SDE_DSPP_AD4_INPUT; }
-  if (name == "SDE_DSPP_AD_V4_BACKLIGHT") { return DRMProperty::SDE_DSPP_AD4_BACKLIGHT; }
-  if (name == "SDE_DSPP_AD_V4_ROI") { return DRMProperty::SDE_DSPP_AD4_ROI; }
-  if (name == "SDE_DSPP_HIST_CTRL_V1") { return DRMProperty::SDE_DSPP_ABA_HIST_CTRL; }
-  if (name == "SDE_DSPP_HIST_IRQ_V1") { return DRMProperty::SDE_DSPP_ABA_HIST_IRQ; }
-  if (name == "SDE_DSPP_VLUT_V1") { return DRMProperty::SDE_DSPP_ABA_LUT; }
-  if (name == "bl_scale") { return DRMProperty::SDE_DSPP_BL_SCALE; }
-  if (name == "sv_bl_scale") { return DRMProperty::SDE_DSPP_SV_BL_SCALE; }
-  if (name == "capture_mode") { return DRMProperty::CAPTURE_MODE; }
-  if (name == "qsync_mode") { return DRMProperty::QSYNC_MODE; }
-  if (name == "idle_pc_state") { return DRMProperty::IDLE_PC_STATE; }
-  if (name == "topology_control") { return DRMProperty::TOPOLOGY_CONTROL; }
-  if (name == "EDID") { return DRMProperty::EDID; }
-  if (name == "SDE_DSPP_LTM_V1") { return DRMProperty::SDE_LTM_VERSION; }
-  if (name == "SDE_DSPP_LTM_INIT_V1") { return DRMProperty::SDE_LTM_INIT; }
-  if (name == "SDE_DSPP_LTM_ROI_V1") { return DRMProperty::SDE_LTM_CFG; }
-  if (name == "SDE_DSPP_LTM_HIST_THRESH_V1") { return DRMProperty::SDE_LTM_NOISE_THRESH; }
-  if (name == "SDE_DSPP_LTM_HIST_CTRL_V1") { return DRMProperty::SDE_LTM_HIST_CTRL; }
-  if (name == "SDE_DSPP_LTM_SET_BUF_V1") { return DRMProperty::SDE_LTM_BUFFER_CTRL; }
-  if (name == "SDE_DSPP_LTM_QUEUE_BUF_V1") { return DRMProperty::SDE_LTM_QUEUE_BUFFER; }
-  if (name == "SDE_DSPP_LTM_QUEUE_BUF2_V1") { return DRMProperty::SDE_LTM_QUEUE_BUFFER2; }
-  if (name == "SDE_DSPP_LTM_QUEUE_BUF3_V1") { return DRMProperty::SDE_LTM_QUEUE_BUFFER3; }
-  if (name == "SDE_DSPP_LTM_VLUT_V1") { return DRMProperty::SDE_LTM_VLUT; }
-  if (name == "SDE_VIG_1D_LUT_IGC_V6") { return DRMProperty::SDE_VIG_1D_LUT_IGC_V6; }
-  if (name == "SDE_VIG_3D_LUT_GAMUT_V6") { return DRMProperty::SDE_VIG_3D_LUT_GAMUT_V6; }
-  if (name == "frame_trigger_mode") { return DRMProperty::FRAME_TRIGGER; }
-  if (name == "Colorspace") { return DRMProperty::COLORSPACE; }
-  if (name == "supported_colorspaces") { return DRMProperty::SUPPORTED_COLORSPACES; }
-  if (name == "SDE_DSPP_SPR_DITHER_V1") { return DRMProperty::SDE_DSPP_SPR_DITHER_V1; }
-  if (name == "cache_state") { return DRMProperty::CACHE_STATE; }
-  if (name == "vm_request_state") { return DRMProperty::VM_REQ_STATE; }
-  if (name == "dspp_caps") { return DRMProperty::DSPP_CAPABILITIES; }
-  if (name == "SDE_SPR_INIT_CFG_V1") { return DRMProperty::SPR_INIT_CFG_V1; }
-  if (name == "SDE_SPR_INIT_CFG_V2") {
-    return DRMProperty::SPR_INIT_CFG_V2;
-  }
-  if (name == "SDE_SPR_UDC_CFG_V2") {
-    return DRMProperty::SPR_UDC_CFG_V2;
-  }
-  if (name == "SDE_DSPP_RC_MASK_V1") { return DRMProperty::DSPP_RC_MASK_V1; }
-  if (name == "panel_mode") { return DRMProperty::PANEL_MODE; }
-  if (name == "bpp_mode") { return DRMProperty::BPP_MODE; }
-  if (name == "SDE_DEMURA_INIT_CFG_V1") { return DRMProperty::DEMURA_INIT_CFG_V1; }
-  if (name == "SDE_DEMURA_CFG0_PARAM2") {
-    return DRMProperty::DEMURA_CFG0_PARAM2;
-  }
-  if (name == "DEMURA_PANEL_ID") { return DRMProperty::DEMURA_PANEL_ID; }
-  if (name == "SDE_DEMURA_BOOT_PLANE_V1") { return DRMProperty::DEMURA_BOOT_PLANE_V1; }
-  if (name == "dyn_bit_clk") { return DRMProperty::DYN_BIT_CLK; }
-  if (name == "SDE_PP_CWB_DITHER_V2") { return DRMProperty::SDE_PP_CWB_DITHER_V2; }
-  if (name == "noise_layer_v1") { return DRMProperty::NOISE_LAYER_V1; }
-  if (name == "dsc_mode") { return DRMProperty::DSC_MODE; }
-  if (name == "dimming_bl_lut") { return DRMProperty::DIMMING_BL_LUT; }
-  if (name == "dimming_dyn_ctrl") { return DRMProperty::DIMMING_DYN_CTRL; }
-  if (name == "dimming_min_bl") { return DRMProperty::DIMMING_MIN_BL; }
-  if (name == "dyn_transfer_time") { return DRMProperty::DYN_TRANSFER_TIME; }
-  if (name == "jitter_config") { return DRMProperty::JITTER_CONFIG; }
-  if (name == "transfer_time") { return DRMProperty::TRANSFER_TIME; }
-  if (name == "early_fence_line") { return DRMProperty::EARLY_FENCE_LINE; }
-  if (name == "dnsc_blur") { return DRMProperty::DNSC_BLR; }
-  if (name == "wb_usage_type") { return DRMProperty::WB_USAGE_TYPE; }
-  if (name == "SDE_SSPP_FP16_IGC_V1") { return DRMProperty::SDE_SSPP_FP16_IGC_V1; }
-  if (name == "SDE_SSPP_FP16_GC_V1") { return DRMProperty::SDE_SSPP_FP16_GC_V1; }
-  if (name == "SDE_SSPP_FP16_CSC_V1") { return DRMProperty::SDE_SSPP_FP16_CSC_V1; }
-  if (name == "SDE_SSPP_FP16_UNMULT_V1") { return DRMProperty::SDE_SSPP_FP16_UNMULT_V1; }
-  if (name == "SDE_SSPP_UCSC_UNMULT_V1") { return DRMProperty::SDE_SSPP_UCSC_UNMULT_V1; }
-  if (name == "SDE_SSPP_UCSC_IGC_V1") { return DRMProperty::SDE_SSPP_UCSC_IGC_V1; }
-  if (name == "SDE_SSPP_UCSC_CSC_V1") { return DRMProperty::SDE_SSPP_UCSC_CSC_V1; }
-  if (name == "SDE_SSPP_UCSC_GC_V1") { return DRMProperty::SDE_SSPP_UCSC_GC_V1; }
-  if (name == "SDE_SSPP_UCSC_ALPHA_DITHER_V1") { return DRMProperty::SDE_SSPP_UCSC_ALPHA_DITHER_V1; }
-  if (name == "EPT") { return DRMProperty::EPT; }
-  if (name == "brightness") { return DRMProperty::BRIGHTNESS; }
+  const std::unordered_map<std::string, DRMProperty> &name_map = GetPropertyNameMap();
+  auto it = name_map.find(name);
+  return (it == name_map.end()) ? DRMProperty::INVALID : it->second;
+}
+
+const char *GetDRMPropertyName(DRMProperty prop) {
+  // Interned once from the forward map; the pointers reference the map's keys, which live
+  // for the process lifetime.
+  static const std::vector<const char *> names = []() {
+    std::vector<const char *> table((uint32_t)DRMProperty::MAX, "unknown");
+    for (auto &entry : GetPropertyNameMap()) {
+      table[(uint32_t)entry.second] = entry.first.c_str();
+    }
+    return table;
+  }();
 
-  return DRMProperty::INVALID;
+  uint32_t index = (uint32_t)prop;
+  return (index < names.size()) ? names[index] : "unknown";
 }
-// clang-format on
 
 }  // namespace sde_drm
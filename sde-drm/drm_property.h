@@ -266,6 +266,11 @@ struct DRMPropertyManager {
   uint32_t properties_[(uint32_t)DRMProperty::MAX] {};
 };
 
+// Returns the kernel name of a recognized property. The reverse table is interned once
+// from the shared name -> enum map, so dump paths can print names without building any
+// strings. Unrecognized values map to "unknown".
+const char *GetDRMPropertyName(DRMProperty prop);
+
 }  // namespace sde_drm
 
 #endif  // __DRM_PROPERTY_H__
@@ -34,7 +34,9 @@
 */
 
 #include <drm/drm_fourcc.h>
+#include <drm_logger.h>
 #include <drm_utils.h>
+#include <inttypes.h>
 #include <regex>
 #include <sstream>
 #include <sstream>
@@ -51,6 +53,52 @@ using std::vector;
 
 namespace sde_drm {
 
+std::atomic<uint64_t> DRMBlobStats::creates_[kBlobObjectTypeMax] = {};
+std::atomic<uint64_t> DRMBlobStats::destroys_[kBlobObjectTypeMax] = {};
+std::atomic<uint64_t> DRMBlobStats::commits_ = {};
+uint64_t DRMBlobStats::dumped_creates_[kBlobObjectTypeMax] = {};
+uint64_t DRMBlobStats::dumped_destroys_[kBlobObjectTypeMax] = {};
+uint64_t DRMBlobStats::dumped_commits_ = 0;
+
+void DRMBlobStats::Dump() {
+  static const char *type_names[kBlobObjectTypeMax] = {"plane", "crtc", "pp feature",
+                                                       "panel feature"};
+  uint64_t commits = commits_.load();
+  uint64_t window_commits = commits - dumped_commits_;
+  DRM_LOGE("Property blob stats (%" PRIu64 " commits, %" PRIu64 " since last dump):", commits,
+           window_commits);
+  for (uint32_t i = 0; i < kBlobObjectTypeMax; i++) {
+    uint64_t creates = creates_[i].load();
+    uint64_t destroys = destroys_[i].load();
+    uint64_t window_creates = creates - dumped_creates_[i];
+    uint64_t window_destroys = destroys - dumped_destroys_[i];
+    DRM_LOGE("  %-13s creates: %" PRIu64 " destroys: %" PRIu64 " outstanding: %" PRId64
+             " window creates/destroys: %" PRIu64 "/%" PRIu64,
+             type_names[i], creates, destroys, static_cast<int64_t>(creates - destroys),
+             window_creates, window_destroys);
+    dumped_creates_[i] = creates;
+    dumped_destroys_[i] = destroys;
+  }
+  dumped_commits_ = commits;
+}
+
+int CreateBlob(int fd, const void *data, size_t length, uint32_t *blob_id,
+               DRMBlobObjectType type) {
+  int ret = drmModeCreatePropertyBlob(fd, data, length, blob_id);
+  if (!ret) {
+    DRMBlobStats::RecordCreate(type);
+  }
+  return ret;
+}
+
+int DestroyBlob(int fd, uint32_t blob_id, DRMBlobObjectType type) {
+  int ret = drmModeDestroyPropertyBlob(fd, blob_id);
+  if (!ret) {
+    DRMBlobStats::RecordDestroy(type);
+  }
+  return ret;
+}
+
 void ParseFormats(const string &line, vector<pair<uint32_t, uint64_t>> *formats) {
   // Match fourcc strings like RA24 or those with modifier like RA24/5/1. The
   // digit after first / is vendor code, the digit after second / is modifier
@@ -121,4 +169,31 @@ void AddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_
 #endif
 }
 
+void UpdateLUTBlob(int fd, uint64_t lut, uint32_t size, uint32_t *blob_id, uint64_t *checksum,
+                   DRMBlobObjectType type) {
+  if (!size) {
+    return;
+  }
+
+  // FNV-1a over the payload bytes; LUT tables are large, the hash is cheap relative to
+  // the blob creation ioctl it avoids.
+  const uint8_t *data = reinterpret_cast<const uint8_t *>(lut);
+  uint64_t new_checksum = 14695981039346656037ULL;
+  for (uint32_t i = 0; i < size; i++) {
+    new_checksum = (new_checksum ^ data[i]) * 1099511628211ULL;
+  }
+
+  if (*blob_id && new_checksum == *checksum) {
+    // Identical LUT content; keep referencing the live blob.
+    return;
+  }
+
+  if (*blob_id) {
+    DestroyBlob(fd, *blob_id, type);
+    *blob_id = 0;
+  }
+  CreateBlob(fd, reinterpret_cast<const void *>(lut), size, blob_id, type);
+  *checksum = new_checksum;
+}
+
 }  // namespace sde_drm
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <xf86drmMode.h>
+#include <atomic>
 #include <string>
 #include <utility>
 #include <vector>
@@ -45,10 +46,50 @@ enum struct DRMStatus {
   FREE,
 };
 
+// Object classes for property blob accounting; see DRMBlobStats.
+enum DRMBlobObjectType {
+  kBlobObjectPlane,
+  kBlobObjectCrtc,
+  kBlobObjectPPFeature,
+  kBlobObjectPanelFeature,
+  kBlobObjectTypeMax,
+};
+
+// Per-object-type accounting of property blob creations and destroys. Kernel-side blob
+// lookup degrades as the blob list grows, so a leak (creates outrunning destroys) shows up
+// as a slow system-wide commit regression long before allocation fails. Every blob in this
+// library is routed through CreateBlob()/DestroyBlob() below, and Dump() reports totals,
+// outstanding count and the per-frame rate over the window since the previous dump.
+class DRMBlobStats {
+ public:
+  static void RecordCreate(DRMBlobObjectType type) { creates_[type]++; }
+  static void RecordDestroy(DRMBlobObjectType type) { destroys_[type]++; }
+  static void RecordCommit() { commits_++; }
+  static void Dump();
+
+ private:
+  static std::atomic<uint64_t> creates_[kBlobObjectTypeMax];
+  static std::atomic<uint64_t> destroys_[kBlobObjectTypeMax];
+  static std::atomic<uint64_t> commits_;
+  // Snapshot at the previous Dump(), to report per-frame rates over the window in between.
+  static uint64_t dumped_creates_[kBlobObjectTypeMax];
+  static uint64_t dumped_destroys_[kBlobObjectTypeMax];
+  static uint64_t dumped_commits_;
+};
+
+// Counted wrappers around drmModeCreatePropertyBlob()/drmModeDestroyPropertyBlob().
+int CreateBlob(int fd, const void *data, size_t length, uint32_t *blob_id,
+               DRMBlobObjectType type);
+int DestroyBlob(int fd, uint32_t blob_id, DRMBlobObjectType type);
+
 void ParseFormats(const std::string &line, std::vector<std::pair<uint32_t, uint64_t>> *formats);
 void Tokenize(const std::string &str, std::vector<std::string> *tokens, char delim);
 void AddProperty(drmModeAtomicReqPtr req, uint32_t object_id, uint32_t property_id, uint64_t value,
                  bool cache, std::unordered_map<uint32_t, uint64_t> &prop_val_map);
+// Creates or refreshes a property blob holding a scaler LUT payload. When the payload
+// checksum matches the live blob, the existing id is kept instead of recreating the blob.
+void UpdateLUTBlob(int fd, uint64_t lut, uint32_t size, uint32_t *blob_id, uint64_t *checksum,
+                   DRMBlobObjectType type);
 
 }  // namespace sde_drm
 
@@ -201,6 +201,24 @@ class BufferAllocator {
     (void) num_planes;
     return -ENOTSUP; }
 
+  /*
+     @brief Clears the pixel contents of a CPU mapped buffer
+
+     @details This method zero fills only the pixel data planes of the buffer, skipping
+     metadata planes and inter-plane padding, in bounded chunks so that large clears do
+     not stall the calling thread. The whole mapping is cleared when the plane layout
+     cannot be derived.
+
+     @param[in] buf buffer handle
+     @param[in] base_ptr CPU mapped base of the buffer
+
+     @return 0 on success, negative errno otherwise
+   */
+  virtual int ClearBufferContents(void *buf, void *base_ptr) {
+    (void) buf;
+    (void) base_ptr;
+    return -ENOTSUP; }
+
  protected:
   virtual ~BufferAllocator() { }
 };
@@ -38,6 +38,7 @@
 #define __BUFFER_SYNC_HANDLER_H__
 
 #include <sstream>
+#include <vector>
 
 namespace sdm {
 
@@ -63,6 +64,45 @@ class BufferSyncHandler {
 
   virtual int SyncWait(int fd, int timeout) = 0;
 
+  /*! @brief Method to wait on a group of sync fds with one shared deadline.
+
+    @details This method waits until every fd in the group is signaled or the shared timeout
+    in milliseconds expires, using a single wait per wakeup instead of one blocking call per
+    fd. Invalid fds are treated as signaled. It is the responsibility of the caller to close
+    the file descriptors.
+
+    @param[in] fds file descriptors
+    @param[in] timeout shared deadline in milliseconds, negative waits forever
+
+    @return \link int \endlink
+  */
+
+  virtual int SyncWaitBatch(const std::vector<int> &fds, int timeout) = 0;
+
+  /*! @brief Method to check whether a sync fd is already signaled without blocking.
+
+    @details This method queries the fence status and never sleeps. Invalid fds are treated
+    as signaled. It is the responsibility of the caller to close the file descriptor.
+
+    @param[in] fd file descriptor
+
+    @return 0 if signaled, -ETIME if still pending
+  */
+
+  virtual int SyncTryWait(int fd) = 0;
+
+  /*! @brief Method to get the signal timestamp of a sync fd without blocking.
+
+    @details This method queries the fence signal time in nanoseconds on the system monotonic
+    clock and never sleeps. It is the responsibility of the caller to close the file descriptor.
+
+    @param[in] fd file descriptor
+
+    @return signal timestamp in ns, 0 if the fence is still pending, invalid or unsupported
+  */
+
+  virtual uint64_t SyncGetSignalTime(int fd) = 0;
+
   /*! @brief Method to merge two sync fds into one sync fd
 
     @details This method merges two buffer sync fds into one sync fd, if a producer/consumer
@@ -234,6 +234,13 @@ enum DisplayDrawMethod {
                               //!< Retire fence returned through commit in this method will
                               //!< signal when the current composed buffers begin to display
                               //!< on panel.
+
+  kDrawUnifiedPipelined,      //!< Same as kDrawUnified, except PrePrepare of the next draw
+                              //!< cycle is allowed to run while the hardware commit of the
+                              //!< current draw cycle is still in flight on the commit thread.
+                              //!< Opt-in for command mode panels where strategy evaluation and
+                              //!< the commit routinely overflow a single vsync period.
+                              //!< Fence semantics are identical to kDrawUnified.
 };
 
 /*! @brief This structure defines configuration for display dpps ad4 region of interest. */
@@ -370,6 +377,20 @@ struct QsyncEventData {
   uint32_t qsync_refresh_rate = 0;
 };
 
+/*! @brief This struct stores per-display commit timing feedback.
+
+  @details Margin is the time between an atomic commit returning and the pageflip it made; a
+  collapsing margin means commits are landing ever closer to the hardware deadline.
+
+  @sa DisplayInterface::GetCommitTimingStats
+*/
+struct CommitTimingStats {
+  uint64_t last_flip_time_ns = 0;        //!< Pageflip timestamp of the last retired frame
+  uint64_t last_commit_time_ns = 0;      //!< Commit completion timestamp of that frame
+  uint64_t last_commit_duration_ns = 0;  //!< Time that frame spent in the atomic commit call
+  uint64_t avg_margin_ns = 0;            //!< EWMA of commit-to-flip margin
+};
+
 /*! @brief This struct stores the panel feature info
 
   @sa DisplayInterface::PanelFeatureInfo
@@ -518,6 +539,22 @@ class DisplayInterface {
   */
   virtual DisplayError CommitOrPrepare(LayerStack *layer_stack) = 0;
 
+  /*! @brief Method to speculatively run the prepare stage ahead of CommitOrPrepare().
+
+    @details Client may call this once it knows the layer geometry of the next frame has changed
+    but before the frame is complete. The display warms its composition strategy for the pending
+    stack so the subsequent CommitOrPrepare() call finds most of the prepare work already done.
+    This call shall not change client-visible state; it is an optimization hint and displays are
+    free to ignore it.
+
+    @param[in] layer_stack \link LayerStack \endlink
+
+    @return \link DisplayError \endlink
+
+    @sa CommitOrPrepare
+  */
+  virtual DisplayError PrePrepare(LayerStack *layer_stack) { return kErrorNotSupported; }
+
   /*! @brief Method to commit layers of a frame submitted in a former call to Prepare().
 
     @details Client shall call this method to submit layers for final composition. The composed
@@ -1247,6 +1284,20 @@ class DisplayInterface {
     @return \link void \endlink
   */
   virtual DisplayError GetQsyncFps(uint32_t *qsync_fps) = 0;
+
+  /*! @brief Method to get commit timing feedback of the display.
+
+    @details Timing of each frame is recorded at commit and resolved against the pageflip
+    timestamp of the retired frame, so the returned stats trail the live frame by one commit.
+
+    @param[out] stats commit timing feedback
+
+    @return \link DisplayError \endlink
+  */
+  virtual DisplayError GetCommitTimingStats(CommitTimingStats *stats) {
+    return kErrorNotSupported;
+  }
+
   /*! @brief Method to get the alternate config with same fps and different compression mode.
 
     @param[out] pointer to config value
@@ -1359,6 +1410,16 @@ class DisplayInterface {
   */
   virtual DisplayError SetDemuraConfig(int demura_idx) = 0;
 
+  /*! @brief Method to trigger composition flattening for a static layer stack.
+
+   @details Client calls this after observing a run of draw cycles without any updating layers.
+   The display flattens the stack through the idle fallback composition path, capturing the
+   composed output via concurrent writeback so subsequent refreshes scan out the cached buffer.
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError TriggerIdleFlattening() = 0;
+
   /*! @brief Method to enable/disable panel OPR info.
 
    @param[in] client_name : client name
@@ -1370,6 +1431,80 @@ class DisplayInterface {
   virtual DisplayError PanelOprInfo(const std::string &client_name, bool enable,
                                     SdmDisplayCbInterface<PanelOprPayload> *cb_intf) = 0;
 
+  /*! @brief Method to enable/disable batched panel OPR info.
+
+   @details Events are buffered and delivered as one callback per vsync interval instead of one
+   callback per event, reducing the crossing overhead for clients that sample OPR continuously.
+   Displays that do not support batching return kErrorNotSupported.
+
+   @param[in] client_name : client name
+   @param[in] enable: enable or disable
+   @param[in] cb_intf: batched callback interface
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError PanelOprInfoBatched(const std::string &client_name, bool enable,
+                                           SdmDisplayCbInterface<PanelOprBatchPayload> *cb_intf) {
+    return kErrorNotSupported;
+  }
+
+  /*! @brief Method to report the current thermal level to the display.
+
+   @details Client calls this on notifications from the platform thermal service. Sustained
+   levels at or above the constraint threshold bias composition strategies toward fewer DPU
+   pipes, trading DPU clock and bandwidth for GPU composition; the bias lifts with hysteresis
+   once the level recedes.
+
+   @param[in] thermal_level current thermal level, higher is hotter
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError ProcessThermalEvent(int64_t thermal_level) {
+    return kErrorNotSupported;
+  }
+
+  /*! @brief Method to hint that the given configuration is about to become active.
+
+   @details Client calls this when a config switch has been scheduled for a future frame so
+   the display can precompute per-config state off the designated switch frame. This is a
+   hint only; the active config does not change until SetActiveConfig() is applied.
+
+   @param[in] index index of the upcoming active configuration
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError PrefetchActiveConfig(uint32_t index) {
+    return kErrorNotSupported;
+  }
+
+  /*! @brief Method to set the number of frames that may be queued to hardware.
+
+   @details A depth of 1 retires each frame at its own flip (double buffering). Deeper queues
+   chain the retire fence of frame N to a later flip so frame N+1 can be committed while N's
+   flip is still pending, trading one frame of latency per extra slot for immunity to
+   single-frame CPU spikes. The display clamps the depth to what the panel mode supports.
+
+   @param[in] depth number of in-flight frames, including the one being composed
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError SetCommitQueueDepth(uint32_t depth) {
+    return kErrorNotSupported;
+  }
+
+  /*! @brief Method to hint that an app launch transition is imminent.
+
+   @details Client calls this when the framework expects a burst of new layers within the
+   next few frames. The display drops any idle composition state and runs one fully
+   validated frame ahead of the launch so the launch frame itself hits warm strategy and
+   QoS caches. This is a hint only; it has no effect on committed content.
+
+   @return \link DisplayError \endlink
+  */
+  virtual DisplayError HandleAppLaunchHint() {
+    return kErrorNotSupported;
+  }
+
  protected:
   virtual ~DisplayInterface() { }
 };
@@ -584,6 +584,15 @@ struct LayerStack {
   uint32_t force_refresh_rate = 0;
 
   uint64_t expected_present_time = 0;  //!< Expected Present timestamp for current frame.
+
+  //!< Recycles the stack for the next draw cycle; the layer pointer vector keeps its heap
+  //!< capacity so steady-state frames do not reallocate it while rebuilding the stack.
+  void Reset() {
+    std::vector<Layer *> reuse = std::move(layers);
+    *this = LayerStack();
+    reuse.clear();
+    layers = std::move(reuse);
+  }
 };
 
 // clang-format on
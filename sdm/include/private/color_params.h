@@ -75,7 +75,9 @@
 #include <core/sdm_types.h>
 #include <core/display_interface.h>
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "hw_info_types.h"
 
@@ -235,17 +237,75 @@ struct PPFeatureVersion {
   PPFeatureVersion() { memset(version, 0, sizeof(version)); }
 };
 
+// Persistent QDCM calibration cache. The proxy checksums the panel's calibration assets and
+// hands the color library an open, mmap-ready cache file through PPHWAttributes below: when
+// the stored header key matches, the library can restore its post-parse binary state by mmap
+// instead of re-parsing the XML assets on every composer start.
+static const uint32_t kCalCacheMagic = 0x51434143;  // 'QCAC'
+static const uint32_t kCalCacheVersion = 1;
+
+struct PPCalCacheHeader {
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t key = 0;           // checksum of the calibration assets the payload was built from
+  uint32_t payload_size = 0;  // bytes following the header; written by the color library
+  uint32_t reserved = 0;
+};
+
 struct PPHWAttributes : HWResourceInfo, HWPanelInfo, DisplayConfigVariableInfo {
   char panel_name[256] = "generic_panel";
   PPFeatureVersion version;
   DppsControlInterface *dpps_intf = NULL;
   uint32_t max_brightness = 0;
+  int cal_cache_fd = -1;         // calibration cache file; owned by ColorManagerProxy
+  uint64_t cal_cache_key = 0;    // checksum the cache header must carry to be restorable
+  bool cal_cache_valid = false;  // header matched; library may restore instead of parse
 
   void Set(const HWResourceInfo &hw_res, const HWPanelInfo &panel_info,
            const DisplayConfigVariableInfo &attr, const PPFeatureVersion &feature_ver,
            DppsControlInterface *dpps_intf);
 };
 
+// Bounded size-bucketed recycling for owned payload buffers. Live QDCM tuning streams hundreds
+// of payloads per second through CreatePayload()/DestroyPayload(); recycling identical-size
+// blocks keeps that churn off the heap. Every block originates from new uint8_t[], so buffers
+// crossing a module boundary stay safe to release with plain delete[].
+class PPPayloadPool {
+ public:
+  static PPPayloadPool &Get() {
+    static PPPayloadPool pool;
+    return pool;
+  }
+
+  uint8_t *Acquire(uint32_t size) {
+    SCOPE_LOCK(locker_);
+    std::vector<uint8_t *> &bucket = free_blocks_[size];
+    if (!bucket.empty()) {
+      uint8_t *block = bucket.back();
+      bucket.pop_back();
+      memset(block, 0, size);
+      return block;
+    }
+    return new uint8_t[size]();
+  }
+
+  void Release(uint8_t *block, uint32_t size) {
+    SCOPE_LOCK(locker_);
+    std::vector<uint8_t *> &bucket = free_blocks_[size];
+    if (bucket.size() >= kMaxBlocksPerBucket) {
+      delete[] block;
+      return;
+    }
+    bucket.push_back(block);
+  }
+
+ private:
+  // Calibration traffic reuses a handful of request/response sizes; anything deeper is churn.
+  static const uint32_t kMaxBlocksPerBucket = 8;
+  Locker locker_;
+  std::map<uint32_t, std::vector<uint8_t *>> free_blocks_;
+};
+
 struct PPDisplayAPIPayload {
   bool own_payload = false;  // to indicate if *payload is owned by this or just a reference.
   uint32_t size = 0;
@@ -255,12 +315,37 @@ struct PPDisplayAPIPayload {
   PPDisplayAPIPayload() = default;
   PPDisplayAPIPayload(uint32_t size, uint8_t *param)
       : size(size), payload(param) {}
+  // Moves transfer buffer ownership so routed payloads need not copy; copies stay available
+  // for existing callers and never duplicate ownership of the underlying buffer.
+  PPDisplayAPIPayload(const PPDisplayAPIPayload &) = default;
+  PPDisplayAPIPayload &operator=(const PPDisplayAPIPayload &) = default;
+  PPDisplayAPIPayload(PPDisplayAPIPayload &&other)
+      : own_payload(other.own_payload), size(other.size), payload(other.payload), fd(other.fd) {
+    other.own_payload = false;
+    other.payload = NULL;
+    other.size = 0;
+    other.fd = -1;
+  }
+  PPDisplayAPIPayload &operator=(PPDisplayAPIPayload &&other) {
+    if (this != &other) {
+      DestroyPayload();
+      own_payload = other.own_payload;
+      size = other.size;
+      payload = other.payload;
+      fd = other.fd;
+      other.own_payload = false;
+      other.payload = NULL;
+      other.size = 0;
+      other.fd = -1;
+    }
+    return *this;
+  }
 
   template <typename T>
   DisplayError CreatePayload(T *&output) {
     DisplayError ret = kErrorNone;
 
-    payload = new uint8_t[sizeof(T)]();
+    payload = PPPayloadPool::Get().Acquire(sizeof(T));
     if (!payload) {
       ret = kErrorMemory;
       output = NULL;
@@ -275,7 +360,7 @@ struct PPDisplayAPIPayload {
   DisplayError CreatePayloadBytes(uint32_t size_in_bytes, uint8_t **output) {
     DisplayError ret = kErrorNone;
 
-    payload = new uint8_t[size_in_bytes]();
+    payload = PPPayloadPool::Get().Acquire(size_in_bytes);
     if (!payload) {
       ret = kErrorMemory;
       *output = NULL;
@@ -289,9 +374,10 @@ struct PPDisplayAPIPayload {
 
   inline void DestroyPayload() {
     if (payload && own_payload) {
-      delete[] payload;
+      PPPayloadPool::Get().Release(payload, size);
       payload = NULL;
       size = 0;
+      own_payload = false;
     } else {
       payload = NULL;
       size = 0;
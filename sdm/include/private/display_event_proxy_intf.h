@@ -41,6 +41,14 @@ struct PanelOprInfoParam {
   SdmDisplayCbInterface<PanelOprPayload> *cb_intf = nullptr;
 };
 
+// Batch of coalesced display events. The events array is valid only for the
+// duration of the Notify() call that delivers it.
+struct PanelOprBatchPayload {
+  uint32_t version = sizeof(PanelOprBatchPayload);
+  uint32_t count = 0;
+  const PanelOprPayload *events = nullptr;
+};
+
 using DisplayEventProxyIntf = GenericIntf<DispEventProxyParams, DispEventProxyOps, GenericPayload>;
 
 class DispEventProxyFactIntf {
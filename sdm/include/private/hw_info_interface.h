@@ -33,6 +33,7 @@
 #include <vector>
 #include <utility>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace sdm {
@@ -43,6 +44,17 @@ class HWInfoInterface {
   static DisplayError Destroy(HWInfoInterface *intf);
   virtual DisplayError Init() = 0;
   virtual DisplayError GetHWResourceInfo(HWResourceInfo *hw_resource) = 0;
+  // Read-mostly shared snapshot of the probed capabilities. Consumers hold the returned
+  // pointer instead of copying the multi-KB struct; backends replace the whole snapshot
+  // on reprobe, so a held pointer always stays internally consistent. The default wraps
+  // the copying query for backends without a cached snapshot.
+  virtual std::shared_ptr<const HWResourceInfo> GetHWResourceInfo() {
+    std::shared_ptr<HWResourceInfo> snapshot = std::make_shared<HWResourceInfo>();
+    if (GetHWResourceInfo(snapshot.get()) != kErrorNone) {
+      return nullptr;
+    }
+    return snapshot;
+  }
   virtual DisplayError GetFirstDisplayInterfaceType(HWDisplayInterfaceInfo *hw_disp_info) = 0;
   virtual DisplayError GetDisplaysStatus(HWDisplaysInfo *hw_displays_info) = 0;
   virtual DisplayError GetMaxDisplaysSupported(DisplayType type, int32_t *max_displays) = 0;
@@ -978,11 +978,44 @@ struct HWLayersInfo {
   HWDNSCInfo demura_dnsc_cfg = {};
   SelfRefreshState self_refresh_state = kSelfRefreshNone;
   uint64_t expected_present_time = 0;
+
+  // Recycles the object for the next draw cycle while retaining the heap capacity of the
+  // per-frame vectors, so steady-state Prepare/Commit cycles do not reallocate them.
+  void Reset() {
+    std::vector<ColorPrimaries> primaries = std::move(wide_color_primaries);
+    std::vector<Layer> layers = std::move(hw_layers);
+    std::vector<LayerExt> exts = std::move(layer_exts);
+    std::vector<uint32_t> indexes = std::move(index);
+    std::vector<uint32_t> roi_indexes = std::move(roi_index);
+    std::vector<LayerRect> left_rois = std::move(left_frame_roi);
+    std::vector<LayerRect> right_rois = std::move(right_frame_roi);
+    *this = HWLayersInfo();
+    primaries.clear();
+    layers.clear();
+    exts.clear();
+    indexes.clear();
+    roi_indexes.clear();
+    left_rois.clear();
+    right_rois.clear();
+    wide_color_primaries = std::move(primaries);
+    hw_layers = std::move(layers);
+    layer_exts = std::move(exts);
+    index = std::move(indexes);
+    roi_index = std::move(roi_indexes);
+    left_frame_roi = std::move(left_rois);
+    right_frame_roi = std::move(right_rois);
+  }
 };
 
 struct DispLayerStack {
   LayerStack *stack = NULL;          // Input layer stack. Set by the caller.
   HWLayersInfo info {};
+
+  // Capacity-retaining counterpart of assigning a fresh DispLayerStack.
+  void Reset() {
+    stack = NULL;
+    info.Reset();
+  }
 };
 
 struct HWDisplayAttributes : DisplayConfigVariableInfo {
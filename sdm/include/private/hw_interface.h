@@ -132,6 +132,9 @@ class HWInterface {
                                             HWDisplayAttributes *display_attributes) = 0;
   virtual DisplayError GetHWPanelInfo(HWPanelInfo *panel_info) = 0;
   virtual DisplayError SetDisplayAttributes(uint32_t index) = 0;
+  // Optional hint that the given config is about to become active; the device may warm its
+  // per-config caches off the switch frame so the apply only swaps cached state.
+  virtual DisplayError PrefetchDisplayConfig(uint32_t index) { return kErrorNotSupported; }
   virtual DisplayError SetDisplayAttributes(const HWDisplayAttributes &display_attributes) = 0;
   virtual DisplayError GetConfigIndex(char *mode, uint32_t *index) = 0;
   virtual DisplayError PowerOn(const HWQosData &qos_data, SyncPoints *sync_points) = 0;
@@ -184,6 +187,7 @@ class HWInterface {
   virtual void FlushConcurrentWriteback() = 0;
   virtual DisplayError SetAlternateDisplayConfig(uint32_t *alt_config) = 0;
   virtual DisplayError GetQsyncFps(uint32_t *qsync_fps) = 0;
+  virtual DisplayError GetCommitTimingStats(CommitTimingStats *stats) = 0;
   virtual DisplayError UpdateTransferTime(uint32_t transfer_time) = 0;
   virtual DisplayError CancelDeferredPowerMode() = 0;
   virtual void HandleCwbTeardown(bool sync_teardown) = 0;
@@ -35,6 +35,9 @@ namespace sdm {
 
 struct PUConstraints {
   bool enable = true;             //!< If this is set, PU will be enabled or it will be disabled
+  uint32_t max_roi_rects = 1;     //!< Number of damage rects the panel/driver accepts per frame.
+                                  //!< ROI generation may emit up to this many disjoint ROIs
+                                  //!< instead of merging all damage into one rect.
 };
 
 class PartialUpdateInterface {
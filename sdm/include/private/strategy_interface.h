@@ -51,6 +51,8 @@ struct StrategyConstraints {
   bool idle_timeout = false;
   bool gpu_fallback_mode = false;  //!< This flag forces GPU composition strategy.
   bool tonemapping_query_mandatory = false;  //!< This flag forces a strategy with tonemapping query
+  bool use_inline_rotation = false;  //!< Current frame has a rotated layer the SSPPs can rotate
+                                     //!< inline; strategies shall prefer it over GPU fallback.
 };
 
 class StrategyInterface {
@@ -76,15 +76,40 @@ class Fence {
   // Ownership of returned fd lies with caller. Caller must explicitly close the fd.
   static int Dup(const shared_ptr<Fence> &fence);
 
+  // Merging with a null fence returns the other fence as is; no new fd is created.
+  // Results are memoized until ResetMergeCache(), so repeated merges of the same
+  // pair within a frame share one merged fd.
   static shared_ptr<Fence> Merge(const shared_ptr<Fence> &fence1, const shared_ptr<Fence> &fence2);
 
+  // Merges through a single chain of sync merges, closing intermediate fds as it
+  // goes, so N inputs cost one fence object instead of N pairwise merged fences.
   static shared_ptr<Fence> Merge(const std::vector<shared_ptr<Fence>> &fences,
                                  bool ignore_signaled);
 
+  // Drop memoized merge results. Called once per frame from the post commit path;
+  // cached entries pin their source fds, so they must not outlive the frame.
+  static void ResetMergeCache();
+
   // Wait on null fence will return success.
   static int Wait(const shared_ptr<Fence> &fence);
   static int Wait(const shared_ptr<Fence> &fence, int timeout);
 
+  // Wait for all fences to signal with one shared deadline, using a single wait per wakeup
+  // instead of one blocking call per fence. Null fences count as signaled.
+  static int WaitAll(const std::vector<shared_ptr<Fence>> &fences, int timeout);
+
+  // Non-blocking signaled check; never sleeps. Null fence returns true.
+  static bool TryWait(const shared_ptr<Fence> &fence);
+
+  // Signal timestamp in ns on the system monotonic clock; never sleeps.
+  // Returns 0 for a pending or null fence, or when the driver has no fence info support.
+  static uint64_t GetSignalTime(const shared_ptr<Fence> &fence);
+
+  // Record any wait blocking longer than threshold_ms (fence name, duration,
+  // result) into a small lock-free ring surfaced through Dump(), so fleet
+  // dumps can attribute pipeline stalls to their producer. 0 disables.
+  static void EnableWaitStats(int threshold_ms);
+
   // Status check on null fence will return signaled.
   static Status GetStatus(const shared_ptr<Fence> &fence);
 
@@ -93,14 +118,36 @@ class Fence {
   // Write all fences info to the output stream.
   static void Dump(std::ostringstream *os);
 
- private:
+ protected:
   explicit Fence(int fd, const string &name);
+
+ private:
   Fence(const Fence &fence) = delete;
   Fence& operator=(const Fence &fence) = delete;
   Fence(Fence &&fence) = delete;
   Fence& operator=(Fence &&fence) = delete;
   static int Get(const shared_ptr<Fence> &fence);
 
+  // Recycled node pool backing fence allocations. Create() routes the fence
+  // object and its shared_ptr control block through these so steady-state
+  // fence churn does not hit the heap.
+  static void *PoolAlloc(size_t size);
+  static void PoolFree(void *ptr, size_t size);
+
+  template <typename T>
+  struct PoolAllocator {
+    using value_type = T;
+    PoolAllocator() = default;
+    template <typename U>
+    explicit PoolAllocator(const PoolAllocator<U> &) {}
+    T *allocate(size_t n) { return reinterpret_cast<T *>(Fence::PoolAlloc(n * sizeof(T))); }
+    void deallocate(T *ptr, size_t n) { Fence::PoolFree(ptr, n * sizeof(T)); }
+    bool operator==(const PoolAllocator &) const { return true; }
+    bool operator!=(const PoolAllocator &) const { return false; }
+  };
+  template <typename U>
+  friend struct PoolAllocator;
+
   static BufferSyncHandler *g_buffer_sync_handler_;
   static std::vector<std::weak_ptr<Fence>> wps_;
   int fd_ = -1;
@@ -50,6 +50,9 @@ namespace sdm {
   void Normalize(const uint32_t &align_x, const uint32_t &align_y, LayerRect *rect);
   LayerRect Union(const LayerRect &rect1, const LayerRect &rect2);
   LayerRect Intersection(const LayerRect &rect1, const LayerRect &rect2);
+  LayerRect UnionOfRects(const LayerRect *rects, uint32_t count);
+  void IntersectionOfRects(const LayerRect &ref, const LayerRect *rects, uint32_t count,
+                           LayerRect *out_rects);
   LayerRect Subtract(const LayerRect &rect1, const LayerRect &rect2);
   void Subtract(const LayerRect &rect1, const LayerRect &rect2, LayerRect *res);
   bool Contains(const LayerRect &rect1, const LayerRect &rect2);
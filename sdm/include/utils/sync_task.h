@@ -30,12 +30,101 @@
 #ifndef __SYNC_TASK_H__
 #define __SYNC_TASK_H__
 
+#include <stdint.h>
 #include <thread>
 #include <mutex>
 #include <condition_variable>   // NOLINT
+#include <deque>
+#include <functional>
 
 namespace sdm {
 
+// Shared worker pool behind SyncTask. Instead of one parked thread per SyncTask instance, all
+// instances share a small fixed set of workers. Each instance is pinned to one worker for its
+// whole lifetime, so handlers that bind state to the executing thread (EGL contexts in the GL
+// color convert, layer stitch and tonemap handlers) keep their single-thread guarantee.
+class TaskPool {
+ public:
+  static const uint32_t kNumWorkers = 2;
+
+  static TaskPool &Get() {
+    static TaskPool pool;
+    return pool;
+  }
+
+  // Pin a new client to the worker with the fewest clients.
+  uint32_t AttachClient() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    uint32_t best = 0;
+    for (uint32_t i = 1; i < kNumWorkers; i++) {
+      if (workers_[i].client_count < workers_[best].client_count) {
+        best = i;
+      }
+    }
+    workers_[best].client_count++;
+    return best;
+  }
+
+  void DetachClient(uint32_t worker) {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    workers_[worker].client_count--;
+  }
+
+  void Post(uint32_t worker, std::function<void()> work) {
+    Worker &w = workers_[worker];
+    std::lock_guard<std::mutex> lock(w.mutex);
+    // Workers are spawned on first use so processes that never run a GL task stay thread-free.
+    if (!w.thread.joinable()) {
+      w.thread = std::thread(&TaskPool::WorkerLoop, this, &w);
+    }
+    w.queue.push_back(std::move(work));
+    w.cv.notify_one();
+  }
+
+ private:
+  struct Worker {
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> queue;
+    uint32_t client_count = 0;
+  };
+
+  TaskPool() = default;
+
+  ~TaskPool() {
+    for (uint32_t i = 0; i < kNumWorkers; i++) {
+      {
+        std::lock_guard<std::mutex> lock(workers_[i].mutex);
+        exit_ = true;
+        workers_[i].cv.notify_one();
+      }
+      if (workers_[i].thread.joinable()) {
+        workers_[i].thread.join();
+      }
+    }
+  }
+
+  void WorkerLoop(Worker *worker) {
+    std::unique_lock<std::mutex> lock(worker->mutex);
+    while (true) {
+      worker->cv.wait(lock, [this, worker] { return exit_ || !worker->queue.empty(); });
+      if (worker->queue.empty()) {
+        break;
+      }
+      std::function<void()> work = std::move(worker->queue.front());
+      worker->queue.pop_front();
+      lock.unlock();
+      work();
+      lock.lock();
+    }
+  }
+
+  std::mutex pool_mutex_;
+  Worker workers_[kNumWorkers];
+  bool exit_ = false;
+};
+
 template <class TaskCode>
 class SyncTask {
  public:
@@ -53,89 +142,52 @@ class SyncTask {
   };
 
   explicit SyncTask(TaskHandler &task_handler) : task_handler_(task_handler) {
-    // Block caller thread until worker thread has started and ready to listen to task commands.
-    // Worker thread will signal as soon as callback is received in the new thread.
-    std::unique_lock<std::mutex> caller_lock(caller_mutex_);
-    std::thread worker_thread(SyncTaskThread, this);
-    worker_thread_.swap(worker_thread);
-    caller_cv_.wait(caller_lock);
+    worker_ = TaskPool::Get().AttachClient();
   }
 
   ~SyncTask() {
-    // Task code does not matter here.
-    PerformTask(task_code_, nullptr, true);
-    worker_thread_.join();
+    // Every public API is synchronous from the caller's point of view (BeginTask() requires a
+    // matching WaitForTask()), so no task of this instance can still be queued here.
+    TaskPool::Get().DetachClient(worker_);
   }
 
   void PerformTask(const TaskCode &task_code, TaskContext *task_context) {
-    PerformTask(task_code, task_context, false);
-  }
-
- private:
-  void PerformTask(const TaskCode &task_code, TaskContext *task_context, bool terminate) {
-    std::unique_lock<std::mutex> caller_lock(caller_mutex_);
-
-    // New scope to limit scope of worker lock to this block.
-    {
-      // Set task command code and notify worker thread.
-      std::unique_lock<std::mutex> worker_lock(worker_mutex_);
-      task_code_ = task_code;
-      task_context_ = task_context;
-      worker_thread_exit_ = terminate;
-      pending_code_ = true;
-      worker_cv_.notify_one();
-    }
-
-    // Wait for worker thread to finish and signal.
-    caller_cv_.wait(caller_lock);
+    BeginTask(task_code, task_context);
+    WaitForTask();
   }
 
-  static void SyncTaskThread(SyncTask *sync_task) {
-    if (sync_task) {
-      sync_task->OnThreadCallback();
-    }
-  }
-
-  void OnThreadCallback() {
-    // Acquire worker lock and start waiting for events.
-    // Wait must start before caller thread can post events, otherwise posted events will be lost.
-    // Caller thread will be blocked until worker thread signals readiness.
-    std::unique_lock<std::mutex> worker_lock(worker_mutex_);
-
-    // New scope to limit scope of caller lock to this block.
+  // Post a task to the worker thread without blocking for its completion. The task context must
+  // stay alive and untouched, and no further task may be posted, until WaitForTask() returns.
+  void BeginTask(const TaskCode &task_code, TaskContext *task_context) {
+    // Mark the task outstanding before it becomes visible to the worker thread.
     {
-      // Signal caller thread that worker thread is ready to listen to events.
       std::unique_lock<std::mutex> caller_lock(caller_mutex_);
-      caller_cv_.notify_one();
+      task_done_ = false;
     }
 
-    while (!worker_thread_exit_) {
-      // Add predicate to handle spurious interrupts.
-      // Wait for caller thread to signal new command codes.
-      worker_cv_.wait(worker_lock, [this] { return pending_code_; });
-
+    TaskPool::Get().Post(worker_, [this, task_code, task_context]() {
       // Call task handler which is implemented by the caller.
-      if (!worker_thread_exit_) {
-        task_handler_.OnTask(task_code_, task_context_);
-      }
+      task_handler_.OnTask(task_code, task_context);
 
-      pending_code_ = false;
       // Notify completion of current task to the caller thread which is blocked.
       std::unique_lock<std::mutex> caller_lock(caller_mutex_);
+      task_done_ = true;
       caller_cv_.notify_one();
-    }
+    });
+  }
+
+  // Block until the task posted through BeginTask() has finished.
+  void WaitForTask() {
+    std::unique_lock<std::mutex> caller_lock(caller_mutex_);
+    caller_cv_.wait(caller_lock, [this] { return task_done_; });
   }
 
+ private:
   TaskHandler &task_handler_;
-  TaskCode task_code_;
-  TaskContext *task_context_ = nullptr;
-  std::thread worker_thread_;
+  uint32_t worker_ = 0;
   std::mutex caller_mutex_;
-  std::mutex worker_mutex_;
   std::condition_variable caller_cv_;
-  std::condition_variable worker_cv_;
-  bool worker_thread_exit_ = false;
-  bool pending_code_ = false;
+  bool task_done_ = true;
 };
 
 }  // namespace sdm
@@ -34,7 +34,12 @@
 */
 
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <private/color_interface.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <utils/constants.h>
 #include <utils/debug.h>
 #include <algorithm>
@@ -215,6 +220,10 @@ ColorManagerProxy *ColorManagerProxy::CreateColorManagerProxy(DisplayType type,
             versions.version[kGlobalColorFeaturePaV2]);
     }
 
+    // Offer the color library a persistent calibration cache keyed by the panel's
+    // calibration checksum, so a composer restart can restore by mmap instead of re-parsing.
+    color_manager_proxy->SetupCalibrationCache();
+
     // 2. instantiate concrete ColorInterface from libsdm-color.so, pass all hardware info in.
     error = create_intf_(COLOR_VERSION_TAG, color_manager_proxy->display_id_,
                          color_manager_proxy->device_type_, hw_attr,
@@ -264,10 +273,81 @@ ColorManagerProxy *ColorManagerProxy::CreateColorManagerProxy(DisplayType type,
   return color_manager_proxy;
 }
 
+void ColorManagerProxy::SetupCalibrationCache() {
+  PPHWAttributes &hw_attr = pp_hw_attributes_;
+
+  char calib_path[256];
+  snprintf(calib_path, sizeof(calib_path), "/vendor/etc/qdcm_calib_data_%s.xml",
+           hw_attr.panel_name);
+  int calib_fd = open(calib_path, O_RDONLY);
+  if (calib_fd < 0) {
+    DLOGI("No calibration file %s, not setting up a cache", calib_path);
+    return;
+  }
+
+  // FNV-1a over the calibration assets; a recalibrated panel produces a new key and the
+  // stale cache payload is rebuilt.
+  uint64_t key = 14695981039346656037ULL;
+  uint8_t buf[4096];
+  ssize_t bytes = 0;
+  while ((bytes = read(calib_fd, buf, sizeof(buf))) > 0) {
+    for (ssize_t i = 0; i < bytes; i++) {
+      key ^= buf[i];
+      key *= 1099511628211ULL;
+    }
+  }
+  close(calib_fd);
+
+  char cache_path[320];
+  snprintf(cache_path, sizeof(cache_path), "/data/vendor/display/qdcm_cache_%s_%d.bin",
+           hw_attr.panel_name, display_id_);
+  int cache_fd = open(cache_path, O_RDWR | O_CREAT, 0600);
+  if (cache_fd < 0) {
+    DLOGW("Failed to open calibration cache %s, errno %d", cache_path, errno);
+    return;
+  }
+
+  PPCalCacheHeader header = {};
+  bool valid = false;
+  struct stat cache_stat = {};
+  if (!fstat(cache_fd, &cache_stat) && cache_stat.st_size >= (off_t)(sizeof(header))) {
+    void *map = mmap(NULL, sizeof(header), PROT_READ, MAP_SHARED, cache_fd, 0);
+    if (map != MAP_FAILED) {
+      header = *reinterpret_cast<PPCalCacheHeader *>(map);
+      munmap(map, sizeof(header));
+      valid = (header.magic == kCalCacheMagic) && (header.version == kCalCacheVersion) &&
+              (header.key == key);
+    }
+  }
+
+  if (!valid) {
+    // Seed a fresh header; the color library fills in the payload after its parse.
+    header = {};
+    header.magic = kCalCacheMagic;
+    header.version = kCalCacheVersion;
+    header.key = key;
+    if (pwrite(cache_fd, &header, sizeof(header), 0) != (ssize_t)(sizeof(header))) {
+      DLOGW("Failed to seed calibration cache %s, errno %d", cache_path, errno);
+      close(cache_fd);
+      return;
+    }
+  }
+
+  hw_attr.cal_cache_fd = cache_fd;
+  hw_attr.cal_cache_key = key;
+  hw_attr.cal_cache_valid = valid;
+  DLOGI("Calibration cache %s for display %d: %s", cache_path, display_id_,
+        valid ? "restorable" : "needs rebuild");
+}
+
 ColorManagerProxy::~ColorManagerProxy() {
   if (destroy_intf_)
     destroy_intf_(display_id_);
   color_intf_ = NULL;
+  if (pp_hw_attributes_.cal_cache_fd >= 0) {
+    close(pp_hw_attributes_.cal_cache_fd);
+    pp_hw_attributes_.cal_cache_fd = -1;
+  }
   if (feature_intf_) {
     feature_intf_->Deinit();
     delete feature_intf_;
@@ -544,6 +624,10 @@ DisplayError ColorManagerProxy::Validate(DispLayerStack *disp_layer_stack) {
   }
 
   if (needs_update_ || apply_mode_ || update_meta_data) {
+    if (needs_update_) {
+      // Color service internal state changed, pre-staged mode assets are stale.
+      mode_assets_cache_.clear();
+    }
     UpdateModeHwassets(cur_mode_id_, curr_mode_, update_meta_data, meta_data_);
     DumpColorMetaData(meta_data_);
     apply_mode_ = false;
@@ -670,6 +754,12 @@ DisplayError ColorManagerProxy::ConvertToPPFeatures(const HwConfigOutputParams &
   return error;
 }
 
+static bool SameStcMode(const snapdragoncolor::ColorMode &lhs,
+                        const snapdragoncolor::ColorMode &rhs) {
+  return (lhs.gamut == rhs.gamut && lhs.gamma == rhs.gamma && lhs.intent == rhs.intent &&
+          lhs.intent_name == rhs.intent_name && lhs.hw_assets == rhs.hw_assets);
+}
+
 DisplayError ColorManagerProxy::UpdateModeHwassets(int32_t mode_id,
                                   snapdragoncolor::ColorMode color_mode, bool valid_meta_data,
                                   const ColorMetaData &meta_data) {
@@ -678,6 +768,24 @@ DisplayError ColorManagerProxy::UpdateModeHwassets(int32_t mode_id,
   }
 
   DisplayError error = kErrorNone;
+
+  // Modes carrying dynamic HDR metadata change frame to frame and are never cached; for the
+  // rest, re-apply the pre-staged assets generated when the mode was first switched to.
+  bool cacheable = !valid_meta_data;
+  if (cacheable) {
+    for (auto &entry : mode_assets_cache_) {
+      if (entry.mode_id == mode_id && SameStcMode(entry.color_mode, color_mode)) {
+        error = ConvertToPPFeatures(entry.hw_params, &pp_features_);
+        if (error != kErrorNone) {
+          DLOGE("Failed to convert cached hw assets to PP features, error = %d", error);
+          return kErrorUndefined;
+        }
+        pp_features_.MarkAsDirty();
+        return error;
+      }
+    }
+  }
+
   struct snapdragoncolor::ModeRenderInputParams mode_params = {};
   struct snapdragoncolor::HwConfigOutputParams hw_params = {};
   mode_params.valid_meta_data = valid_meta_data;
@@ -700,6 +808,12 @@ DisplayError ColorManagerProxy::UpdateModeHwassets(int32_t mode_id,
     return kErrorUndefined;
   }
 
+  if (cacheable) {
+    // Payloads are shared pointers, so staging a copy keeps the generated LUTs alive without
+    // duplicating the tables.
+    mode_assets_cache_.push_back({mode_id, color_mode, hw_params});
+  }
+
   error = ConvertToPPFeatures(hw_params, &pp_features_);
   if (error != kErrorNone) {
     DLOGE("Failed to convert hw assets to PP features, error = %d", error);
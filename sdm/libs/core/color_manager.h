@@ -181,6 +181,14 @@ class ColorManagerProxy {
                                         PPFeaturesConfig *out_data);
   typedef std::map<std::string, ConvertProc> ConvertTable;
 
+  // Hw assets generated by the color service for one mode, kept so that switching back to
+  // the mode re-applies the pre-built LUT/PCC payloads instead of regenerating them.
+  struct ModeHwAssetsCacheEntry {
+    int32_t mode_id = -1;
+    snapdragoncolor::ColorMode color_mode = {};
+    snapdragoncolor::HwConfigOutputParams hw_params = {};
+  };
+
   bool NeedAssetsUpdate();
   DisplayError UpdateModeHwassets(int32_t mode_id, snapdragoncolor::ColorMode color_mode,
                                   bool valid_meta_data, const ColorMetaData &meta_data);
@@ -188,6 +196,7 @@ class ColorManagerProxy {
   void DumpColorMetaData(const ColorMetaData &color_metadata);
   bool HasNativeModeSupport();
   DisplayError ApplySwAssets();
+  void SetupCalibrationCache();
 
   int32_t display_id_;
   DisplayType device_type_;
@@ -204,6 +213,7 @@ class ColorManagerProxy {
   snapdragoncolor::ScPostBlendInterface *stc_intf_ = NULL;
   snapdragoncolor::ColorMode curr_mode_;
   bool needs_update_ = false;
+  std::vector<ModeHwAssetsCacheEntry> mode_assets_cache_;
 };
 
 class ColorFeatureCheckingImpl : public FeatureInterface {
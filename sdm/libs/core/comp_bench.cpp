@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+// Standalone composition strategy benchmark. Replays layer stacks (synthetic or recorded
+// as a trace file) through CompManager::PrePrepare/Prepare/PostPrepare/Commit/PostCommit
+// against ResourceDefault, and reports per-frame CPU time and heap allocation counts so
+// strategy changes can be A/B compared off-target.
+//
+// Trace file format, one command per line:
+//   L <left> <top> <right> <bottom>   add an app layer with the given dst rect
+//   F                                 end of frame; replay the accumulated layers
+// Lines starting with '#' are ignored. Without a trace file a synthetic stack of
+// -l full screen layers is replayed for -n frames.
+
+#include <getopt.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <core/buffer_allocator.h>
+#include <core/layer_stack.h>
+#include <private/hw_info_types.h>
+#include <utils/constants.h>
+
+#include "comp_manager.h"
+
+namespace {
+
+// Heap traffic counters. Every operator new in the process is counted, which is exactly
+// what we want: strategy-side allocation regressions show up no matter which container
+// triggers them.
+std::atomic<uint64_t> g_alloc_count(0);
+
+}  // namespace
+
+void *operator new(size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  void *ptr = malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void *operator new[](size_t size) {
+  g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+  void *ptr = malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void operator delete(void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept {
+  free(ptr);
+}
+
+namespace sdm {
+
+// The benchmark never touches real buffers; allocation requests only need plausible
+// aligned sizes so that strategy math has something to chew on.
+class BenchBufferAllocator : public BufferAllocator {
+ public:
+  int AllocateBuffer(BufferInfo *buffer_info) override { return -ENOTSUP; }
+  int FreeBuffer(BufferInfo *buffer_info) override { return 0; }
+  uint32_t GetBufferSize(BufferInfo *buffer_info) override {
+    const BufferConfig &config = buffer_info->buffer_config;
+    return config.width * config.height * 4;
+  }
+  int GetAllocatedBufferInfo(const BufferConfig &buffer_config,
+                             AllocatedBufferInfo *allocated_buffer_info) override {
+    allocated_buffer_info->aligned_width = ALIGN(buffer_config.width, 32);
+    allocated_buffer_info->aligned_height = ALIGN(buffer_config.height, 32);
+    allocated_buffer_info->size = allocated_buffer_info->aligned_width *
+                                  allocated_buffer_info->aligned_height * 4;
+    return 0;
+  }
+  int GetBufferLayout(const AllocatedBufferInfo &buf_info, uint32_t stride[4],
+                      uint32_t offset[4], uint32_t *num_planes) override {
+    stride[0] = buf_info.aligned_width * 4;
+    offset[0] = 0;
+    *num_planes = 1;
+    return 0;
+  }
+};
+
+class BenchEventHandler : public CompManagerEventHandler {
+ public:
+  void NotifyCwbDone(int32_t status, const LayerBuffer &buffer) override {}
+  void Refresh() override {}
+  void OnCwbTeardown(bool sync_teardown) override {}
+};
+
+struct BenchStats {
+  uint64_t frames = 0;
+  uint64_t total_cpu_ns = 0;
+  uint64_t max_cpu_ns = 0;
+  uint64_t total_allocs = 0;
+  uint64_t prepare_failures = 0;
+};
+
+class CompBench {
+ public:
+  int Setup(uint32_t width, uint32_t height);
+  void Teardown();
+  void RunFrame(const std::vector<LayerRect> &app_rects, BenchStats *stats);
+
+ private:
+  static uint64_t ThreadCpuNs() {
+    struct timespec ts = {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return UINT64(ts.tv_sec) * 1000000000 + UINT64(ts.tv_nsec);
+  }
+
+  void BuildStackStats();
+
+  CompManager comp_manager_;
+  BenchBufferAllocator buffer_allocator_;
+  BenchEventHandler event_handler_;
+  Handle display_ctx_ = nullptr;
+  uint32_t width_ = 0;
+  uint32_t height_ = 0;
+  LayerStack layer_stack_;
+  DispLayerStack disp_layer_stack_;
+  std::vector<Layer> layers_;
+};
+
+int CompBench::Setup(uint32_t width, uint32_t height) {
+  width_ = width;
+  height_ = height;
+
+  // Enough source pipes for typical strategies; mirrors a mid tier target.
+  HWResourceInfo hw_res_info;
+  hw_res_info.num_vig_pipe = 4;
+  hw_res_info.num_dma_pipe = 4;
+  hw_res_info.num_blending_stages = 8;
+  hw_res_info.max_scale_up = 4;
+  hw_res_info.max_scale_down = 4;
+  hw_res_info.max_bandwidth_low = 6000000;
+  hw_res_info.max_bandwidth_high = 6000000;
+  hw_res_info.max_mixer_width = 2560;
+  hw_res_info.max_pipe_width = 2560;
+  for (uint32_t i = 0; i < hw_res_info.num_vig_pipe; i++) {
+    HWPipeCaps caps;
+    caps.type = kPipeTypeVIG;
+    caps.id = i;
+    hw_res_info.hw_pipes.push_back(caps);
+  }
+  for (uint32_t i = 0; i < hw_res_info.num_dma_pipe; i++) {
+    HWPipeCaps caps;
+    caps.type = kPipeTypeDMA;
+    caps.id = hw_res_info.num_vig_pipe + i;
+    hw_res_info.hw_pipes.push_back(caps);
+  }
+
+  DisplayError error = comp_manager_.Init(hw_res_info, nullptr /* extension_intf */,
+                                          &buffer_allocator_, nullptr /* socket_handler */);
+  if (error != kErrorNone) {
+    std::cerr << "CompManager::Init failed: " << error << "\n";
+    return -1;
+  }
+
+  HWDisplayAttributes display_attributes;
+  display_attributes.x_pixels = width_;
+  display_attributes.y_pixels = height_;
+  display_attributes.fps = 60;
+  display_attributes.vsync_period_ns = 16666666;
+
+  HWPanelInfo panel_info;
+  HWMixerAttributes mixer_attributes;
+  mixer_attributes.width = width_;
+  mixer_attributes.height = height_;
+  mixer_attributes.split_left = width_;
+
+  DisplayConfigVariableInfo fb_config;
+  fb_config.x_pixels = width_;
+  fb_config.y_pixels = height_;
+  fb_config.fps = 60;
+
+  HWQosData qos_data;
+  error = comp_manager_.RegisterDisplay(0 /* display_id */, kBuiltIn, display_attributes,
+                                        panel_info, mixer_attributes, fb_config, &display_ctx_,
+                                        &qos_data, &event_handler_);
+  if (error != kErrorNone) {
+    std::cerr << "CompManager::RegisterDisplay failed: " << error << "\n";
+    comp_manager_.Deinit();
+    return -1;
+  }
+
+  return 0;
+}
+
+void CompBench::Teardown() {
+  if (display_ctx_) {
+    comp_manager_.UnregisterDisplay(display_ctx_);
+    display_ctx_ = nullptr;
+  }
+  comp_manager_.Deinit();
+}
+
+// Minimal equivalent of DisplayBase::BuildLayerStackStats for the replayed stack.
+void CompBench::BuildStackStats() {
+  HWLayersInfo &info = disp_layer_stack_.info;
+  info = {};
+  info.app_layer_count = 0;
+  info.gpu_target_index = -1;
+  info.stitch_target_index = -1;
+  info.noise_layer_index = -1;
+
+  disp_layer_stack_.stack = &layer_stack_;
+  info.flags = layer_stack_.flags;
+
+  for (auto &layer : layer_stack_.layers) {
+    if (layer->buffer_map == nullptr) {
+      layer->buffer_map = std::make_shared<LayerBufferMap>();
+    }
+    if (layer->composition == kCompositionGPUTarget) {
+      info.gpu_target_index = info.app_layer_count;
+    } else {
+      info.app_layer_count++;
+    }
+  }
+}
+
+void CompBench::RunFrame(const std::vector<LayerRect> &app_rects, BenchStats *stats) {
+  layers_.clear();
+  layers_.resize(app_rects.size() + 1);
+  layer_stack_.layers.clear();
+
+  for (size_t i = 0; i < app_rects.size(); i++) {
+    Layer &layer = layers_[i];
+    layer.src_rect = {0.0f, 0.0f, app_rects[i].right - app_rects[i].left,
+                      app_rects[i].bottom - app_rects[i].top};
+    layer.dst_rect = app_rects[i];
+    layer.input_buffer.width = UINT32(layer.src_rect.right);
+    layer.input_buffer.height = UINT32(layer.src_rect.bottom);
+    layer.input_buffer.unaligned_width = layer.input_buffer.width;
+    layer.input_buffer.unaligned_height = layer.input_buffer.height;
+    layer.input_buffer.format = kFormatRGBA8888;
+    layer_stack_.layers.push_back(&layer);
+  }
+
+  // GPU target layer, always last.
+  Layer &fb_layer = layers_.back();
+  fb_layer.composition = kCompositionGPUTarget;
+  fb_layer.src_rect = {0.0f, 0.0f, FLOAT(width_), FLOAT(height_)};
+  fb_layer.dst_rect = fb_layer.src_rect;
+  fb_layer.input_buffer.width = width_;
+  fb_layer.input_buffer.height = height_;
+  fb_layer.input_buffer.unaligned_width = width_;
+  fb_layer.input_buffer.unaligned_height = height_;
+  fb_layer.input_buffer.format = kFormatRGBA8888;
+  layer_stack_.layers.push_back(&fb_layer);
+
+  BuildStackStats();
+
+  uint64_t allocs_before = g_alloc_count.load(std::memory_order_relaxed);
+  uint64_t cpu_before = ThreadCpuNs();
+
+  DisplayError error = comp_manager_.PrePrepare(display_ctx_, &disp_layer_stack_);
+  if (error == kErrorNone || error == kErrorNeedsValidate || error == kErrorNeedsLutRegen) {
+    error = comp_manager_.Prepare(display_ctx_, &disp_layer_stack_);
+  }
+  if (error == kErrorNone) {
+    comp_manager_.PostPrepare(display_ctx_, &disp_layer_stack_);
+    comp_manager_.Commit(display_ctx_, &disp_layer_stack_);
+    comp_manager_.PostCommit(display_ctx_, &disp_layer_stack_);
+  } else {
+    stats->prepare_failures++;
+  }
+
+  uint64_t frame_ns = ThreadCpuNs() - cpu_before;
+  stats->total_cpu_ns += frame_ns;
+  stats->max_cpu_ns = std::max(stats->max_cpu_ns, frame_ns);
+  stats->total_allocs += g_alloc_count.load(std::memory_order_relaxed) - allocs_before;
+  stats->frames++;
+}
+
+}  // namespace sdm
+
+static void ShowUsage(const char *progname) {
+  std::cout << "Usage: " << progname << " {options}\n"
+            << "Replay layer stacks through CompManager and report CPU cost.\n\n"
+            << "\tOptions:\n"
+            << "\t-h        display this help message\n"
+            << "\t-t FILE   replay a recorded trace file instead of a synthetic stack\n"
+            << "\t-n NUM    number of synthetic frames to replay (default 1000)\n"
+            << "\t-l NUM    app layers per synthetic frame (default 4)\n"
+            << "\t-W NUM    display width (default 1080)\n"
+            << "\t-H NUM    display height (default 2400)\n";
+}
+
+int main(int argc, char **argv) {
+  const char *trace_file = nullptr;
+  uint32_t frames = 1000;
+  uint32_t layers = 4;
+  uint32_t width = 1080;
+  uint32_t height = 2400;
+
+  int c;
+  while ((c = getopt(argc, argv, "t:n:l:W:H:h")) != -1) {
+    switch (c) {
+      case 't':
+        trace_file = optarg;
+        break;
+      case 'n':
+        frames = UINT32(strtoul(optarg, nullptr, 10));
+        break;
+      case 'l':
+        layers = UINT32(strtoul(optarg, nullptr, 10));
+        break;
+      case 'W':
+        width = UINT32(strtoul(optarg, nullptr, 10));
+        break;
+      case 'H':
+        height = UINT32(strtoul(optarg, nullptr, 10));
+        break;
+      default:
+      case 'h':
+        ShowUsage(argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  sdm::CompBench bench;
+  if (bench.Setup(width, height)) {
+    return EXIT_FAILURE;
+  }
+
+  sdm::BenchStats stats;
+  if (trace_file) {
+    std::ifstream trace(trace_file);
+    if (!trace.is_open()) {
+      std::cerr << "Cannot open trace file " << trace_file << "\n";
+      bench.Teardown();
+      return EXIT_FAILURE;
+    }
+    std::vector<sdm::LayerRect> rects;
+    std::string line;
+    while (std::getline(trace, line)) {
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      std::istringstream tokens(line);
+      char cmd = 0;
+      tokens >> cmd;
+      if (cmd == 'L') {
+        sdm::LayerRect rect;
+        tokens >> rect.left >> rect.top >> rect.right >> rect.bottom;
+        rects.push_back(rect);
+      } else if (cmd == 'F') {
+        if (!rects.empty()) {
+          bench.RunFrame(rects, &stats);
+          rects.clear();
+        }
+      }
+    }
+  } else {
+    std::vector<sdm::LayerRect> rects(layers);
+    for (uint32_t i = 0; i < layers; i++) {
+      rects[i] = {0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height)};
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+      bench.RunFrame(rects, &stats);
+    }
+  }
+
+  bench.Teardown();
+
+  if (!stats.frames) {
+    std::cerr << "No frames replayed.\n";
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "frames:             " << stats.frames << "\n"
+            << "prepare failures:   " << stats.prepare_failures << "\n"
+            << "avg cpu per frame:  " << (stats.total_cpu_ns / stats.frames) / 1000 << " us\n"
+            << "max cpu per frame:  " << stats.max_cpu_ns / 1000 << " us\n"
+            << "avg allocs/frame:   " << stats.total_allocs / stats.frames << "\n";
+
+  return EXIT_SUCCESS;
+}
@@ -32,7 +32,13 @@
 #include <core/buffer_allocator.h>
 #include <utils/constants.h>
 #include <utils/debug.h>
+#include <utils/formats.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <iomanip>
 #include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <map>
@@ -75,6 +81,12 @@ DisplayError CompManager::Init(const HWResourceInfo &hw_res_info,
   buffer_allocator_ = buffer_allocator;
   extension_intf_ = extension_intf;
 
+  int disable_governor = 0;
+  DebugHandler::Get()->GetProperty(DISABLE_GPU_FALLBACK_GOVERNOR, &disable_governor);
+  disable_fallback_governor_ = (disable_governor == 1);
+
+  disable_inline_rotation_ = Debug::GetPropertyDisableInlineMode();
+
   return error;
 }
 
@@ -168,11 +180,17 @@ DisplayError CompManager::RegisterDisplay(int32_t display_id, DisplayType type,
   display_comp_ctx->display_type = type;
   display_comp_ctx->fb_config = fb_config;
   display_comp_ctx->dest_scaler_blocks_used = mixer_attributes.dest_scaler_blocks_used;
+  // Let ROI generation emit as many disjoint damage rects as the panel/driver accepts per
+  // frame (kNumMaxROIs in the DAL), instead of merging multi-window damage into one rect.
+  display_comp_ctx->pu_constraints.max_roi_rects =
+      std::min(std::max(hw_panel_info.left_roi_count, 1u), 4u);
   *display_ctx = display_comp_ctx;
+  display_ctx_map_[display_id] = display_comp_ctx;
   // New non-primary display device has been added, so move the composition mode to safe mode until
   // resources for the added display is configured properly.
   if (!display_comp_ctx->is_primary_panel) {
     max_sde_secondary_fetch_layers_ = UINT32(Debug::GetSecondaryMaxFetchLayers());
+    BalanceSecondaryFetchLayers();
   }
 
   display_demura_status_[display_id] = false;
@@ -218,6 +236,9 @@ DisplayError CompManager::UnregisterDisplay(Handle display_ctx) {
   callback_map_.erase(display_comp_ctx->display_id);
   registered_displays_.erase(display_comp_ctx->display_id);
   powered_on_displays_.erase(display_comp_ctx->display_id);
+  idle_collapsed_displays_.erase(display_comp_ctx->display_id);
+  display_ctx_map_.erase(display_comp_ctx->display_id);
+  BalanceSecondaryFetchLayers();
 
   DLOGV_IF(kTagCompManager, "Registered displays [%s], display %d-%d",
            StringDisplayList(registered_displays_).c_str(), display_comp_ctx->display_id,
@@ -294,9 +315,174 @@ DisplayError CompManager::ReconfigureDisplay(Handle comp_handle,
 
   // Update new resolution.
   display_comp_ctx->fb_config = fb_config;
+  // ROI count is a per-mode panel capability; refresh it on mode switches.
+  display_comp_ctx->pu_constraints.max_roi_rects =
+      std::min(std::max(hw_panel_info.left_roi_count, 1u), 4u);
+  // Mixer or panel geometry changed; remembered DPU verdicts may no longer hold and the
+  // cross-display pipe budget needs resizing.
+  display_comp_ctx->feedback_memory.clear();
+  BalanceSecondaryFetchLayers();
   return error;
 }
 
+void CompManager::BalanceSecondaryFetchLayers() {
+  uint32_t total_pipes =
+      hw_res_info_.num_vig_pipe + hw_res_info_.num_rgb_pipe + hw_res_info_.num_dma_pipe;
+  if (!total_pipes) {
+    return;
+  }
+
+  // Outputs wider than a mixer need the layer split across two pipes.
+  auto pipes_per_layer = [this](const DisplayConfigVariableInfo &fb_config) {
+    return (fb_config.x_pixels > hw_res_info_.max_mixer_width) ? 2u : 1u;
+  };
+
+  uint32_t primary_reserve = 0;
+  uint32_t secondary_factor = 0;
+  for (auto &ctx_pair : display_ctx_map_) {
+    DisplayCompositionContext *ctx = ctx_pair.second;
+    if (ctx->is_primary_panel) {
+      uint32_t layers = kPrimaryReserveLayers;
+      if (ctx->fb_config.fps >= kHighRefreshFps) {
+        layers += 2;
+      }
+      primary_reserve = std::max(primary_reserve, layers * pipes_per_layer(ctx->fb_config));
+    } else if (ctx->display_type != kBuiltIn) {
+      secondary_factor = std::max(secondary_factor, pipes_per_layer(ctx->fb_config));
+    }
+  }
+  if (!secondary_factor) {
+    return;  // no virtual/pluggable display registered
+  }
+
+  // Fit the virtual/pluggable fetch budget into the pipes left after the primary's reserve,
+  // instead of letting a wide mirroring session contend for them and push the primary into
+  // revalidation. The configured property stays the ceiling.
+  uint32_t ceiling = UINT32(Debug::GetSecondaryMaxFetchLayers());
+  uint32_t available = (total_pipes > primary_reserve) ? (total_pipes - primary_reserve) : 0;
+  uint32_t balanced = std::max(1u, std::min(available / secondary_factor, ceiling));
+  if (balanced != max_sde_secondary_fetch_layers_) {
+    DLOGI("Secondary fetch layers balanced to %d (pipes %d, primary reserve %d, split %d)",
+          balanced, total_pipes, primary_reserve, secondary_factor);
+    max_sde_secondary_fetch_layers_ = balanced;
+  }
+}
+
+// Fingerprint of the layer properties a DPU rejection can depend on. While it stays stable
+// the rejection is assumed to recur; any change (rotation ends, format switch, resize)
+// invalidates the remembered feedback.
+static uint64_t LayerFingerprint(const Layer *layer) {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ULL;
+  };
+  auto mix_float = [&mix](float value) {
+    uint32_t bits = 0;
+    memcpy(&bits, &value, sizeof(bits));
+    mix(bits);
+  };
+
+  mix_float(layer->transform.rotation);
+  mix(layer->transform.flip_horizontal);
+  mix(layer->transform.flip_vertical);
+  mix(UINT32(layer->input_buffer.format));
+  mix(layer->input_buffer.width);
+  mix(layer->input_buffer.height);
+  mix(layer->input_buffer.flags.secure);
+  mix(layer->input_buffer.flags.video);
+  mix(layer->input_buffer.flags.hdr);
+  mix(layer->flags.skip);
+  mix(layer->flags.solid_fill);
+  mix_float(layer->src_rect.left);
+  mix_float(layer->src_rect.top);
+  mix_float(layer->src_rect.right);
+  mix_float(layer->src_rect.bottom);
+  mix_float(layer->dst_rect.left);
+  mix_float(layer->dst_rect.top);
+  mix_float(layer->dst_rect.right);
+  mix_float(layer->dst_rect.bottom);
+
+  return hash;
+}
+
+void CompManager::ApplyFeedbackMemory(DisplayCompositionContext *display_comp_ctx,
+                                      DispLayerStack *disp_layer_stack, LayerFeedback *feedback) {
+  uint32_t app_layer_count = disp_layer_stack->info.app_layer_count;
+  std::vector<DisplayCompositionContext::LayerFeedbackMemory> &memory =
+      display_comp_ctx->feedback_memory;
+  memory.resize(app_layer_count);
+
+  for (uint32_t i = 0; i < app_layer_count; i++) {
+    if (!memory[i].ttl) {
+      continue;
+    }
+    if (memory[i].fingerprint != LayerFingerprint(disp_layer_stack->stack->layers.at(i))) {
+      memory[i] = {};
+      continue;
+    }
+    memory[i].ttl--;
+    if (i < feedback->unsupported_list_.size()) {
+      feedback->unsupported_list_[i] = true;
+    }
+  }
+}
+
+void CompManager::RecordFeedbackMemory(DisplayCompositionContext *display_comp_ctx,
+                                       DispLayerStack *disp_layer_stack,
+                                       const LayerFeedback &feedback) {
+  uint32_t app_layer_count = disp_layer_stack->info.app_layer_count;
+  std::vector<DisplayCompositionContext::LayerFeedbackMemory> &memory =
+      display_comp_ctx->feedback_memory;
+  memory.resize(app_layer_count);
+
+  // Only the property based unsupported verdicts are worth remembering; contention entries
+  // depend on what else is on screen and must be re-evaluated every frame.
+  for (uint32_t i = 0; i < app_layer_count && i < feedback.unsupported_list_.size(); i++) {
+    if (feedback.unsupported_list_[i]) {
+      memory[i].fingerprint = LayerFingerprint(disp_layer_stack->stack->layers.at(i));
+      memory[i].ttl = kFeedbackMemoryFrames;
+    }
+  }
+}
+
+bool CompManager::CanUseInlineRotation(const Layer *layer) const {
+  const InlineRotationInfo &inrot_info = hw_res_info_.inline_rot_info;
+  if (inrot_info.inrot_version == kInlineRotationNone) {
+    return false;
+  }
+
+  if (layer->transform.rotation != 90.0f) {
+    return false;
+  }
+
+  // The SSPP fetches the source rotated, which the hardware supports for UBWC layouts only,
+  // and only for the formats the rotator block advertises.
+  const LayerBuffer &input_buffer = layer->input_buffer;
+  if (GetBufferLayout(input_buffer.format) != kUBWC) {
+    return false;
+  }
+  const std::vector<LayerBufferFormat> &formats = inrot_info.inrot_fmts_supported;
+  if (std::find(formats.begin(), formats.end(), input_buffer.format) == formats.end()) {
+    return false;
+  }
+
+  // Bandwidth guard: rotated fetch swaps the downscale axes, and anything beyond the real
+  // time downscale limit needs the pre-downscaler or the offline rotator instead.
+  float dst_w = layer->dst_rect.right - layer->dst_rect.left;
+  float dst_h = layer->dst_rect.bottom - layer->dst_rect.top;
+  if (dst_w <= 0.0f || dst_h <= 0.0f) {
+    return false;
+  }
+  float ds_w = (layer->src_rect.bottom - layer->src_rect.top) / dst_w;
+  float ds_h = (layer->src_rect.right - layer->src_rect.left) / dst_h;
+  if (std::max(ds_w, ds_h) > inrot_info.max_downscale_rt) {
+    return false;
+  }
+
+  return true;
+}
+
 void CompManager::PrepareStrategyConstraints(Handle comp_handle,
                                              DispLayerStack *disp_layer_stack) {
   DisplayCompositionContext *display_comp_ctx =
@@ -313,6 +499,22 @@ void CompManager::PrepareStrategyConstraints(Handle comp_handle,
   constraints->max_layers = hw_res_info_.num_blending_stages;
   constraints->feedback = feedback;
 
+  // Pre-mark layers whose DPU rejection from earlier frames is still valid, so the first
+  // strategy attempt already excludes them.
+  ApplyFeedbackMemory(display_comp_ctx, disp_layer_stack, &constraints->feedback);
+
+  // Flag frames carrying a rotated layer the SSPPs can rotate inline, so strategies keep such
+  // layers on the DPU instead of falling back to GPU (the common portrait video case).
+  constraints->use_inline_rotation = false;
+  if (!disable_inline_rotation_) {
+    for (uint32_t i = 0; i < disp_layer_stack->info.app_layer_count; i++) {
+      if (CanUseInlineRotation(disp_layer_stack->stack->layers.at(i))) {
+        constraints->use_inline_rotation = true;
+        break;
+      }
+    }
+  }
+
   // Limit 2 layer SDE Comp if its not a Primary Display.
   // Safe mode is the policy for External display on a low end device.
   if (!display_comp_ctx->is_primary_panel) {
@@ -332,6 +534,15 @@ void CompManager::PrepareStrategyConstraints(Handle comp_handle,
     constraints->max_layers = 1;
   }
 
+  // Thermal governor: under sustained thermal pressure bias strategies toward fewer DPU
+  // pipes, trading DPU for GPU power explicitly — blending moves to the GPU while fewer
+  // active pipes lower the MDP clock and bandwidth votes. The budget still leaves the
+  // common video + UI split on the DPU.
+  if (EvaluateThermalConstraint()) {
+    constraints->max_layers = std::min(constraints->max_layers, kThermalMaxLayers);
+    thermal_constrained_frames_++;
+  }
+
   uint32_t size_ff = 1;  // gpu target layer always present
   if (disp_layer_stack->info.stitch_present)
     size_ff++;
@@ -353,6 +564,12 @@ void CompManager::PrepareStrategyConstraints(Handle comp_handle,
   if (force_gpu_comp_) {
     DoGpuFallback(comp_handle);
   }
+
+  if (display_comp_ctx->gpu_fallback_hold) {
+    // Governor hold: keep composition on GPU so a marginal frame does not bounce back to
+    // HW only to fall back again next frame.
+    DoGpuFallback(comp_handle);
+  }
 }
 
 void CompManager::GenerateROI(Handle display_ctx, DispLayerStack *disp_layer_stack) {
@@ -367,6 +584,9 @@ DisplayError CompManager::PrePrepare(Handle display_ctx, DispLayerStack *disp_la
   DisplayCompositionContext *display_comp_ctx =
                              reinterpret_cast<DisplayCompositionContext *>(display_ctx);
 
+  // A frame from this display brings it out of idle power collapse.
+  idle_collapsed_displays_.erase(display_comp_ctx->display_id);
+
   if (display_comp_ctx->idle_fallback) {
     display_comp_ctx->constraints.idle_timeout = true;
   }
@@ -403,8 +623,10 @@ DisplayError CompManager::Prepare(Handle display_ctx, DispLayerStack *disp_layer
   resource_intf_->Start(display_resource_ctx, disp_layer_stack->stack);
 
   bool exit = false;
+  uint32_t attempts = 0;
   uint32_t &count = display_comp_ctx->remaining_strategies;
   for (; !exit && count > 0; count--) {
+    attempts++;
     error = display_comp_ctx->strategy->GetNextStrategy();
     if (error != kErrorNone) {
       // Composition strategies exhausted. Resource Manager could not allocate resources even for
@@ -417,12 +639,17 @@ DisplayError CompManager::Prepare(Handle display_ctx, DispLayerStack *disp_layer
       error = resource_intf_->Prepare(display_resource_ctx, disp_layer_stack, &updated_feedback);
       // Exit if successfully prepared resource, else try next strategy.
       exit = (error == kErrorNone);
-      if (!exit)
+      if (!exit) {
         display_comp_ctx->constraints.feedback = updated_feedback;
+        RecordFeedbackMemory(display_comp_ctx, disp_layer_stack, updated_feedback);
+      }
     }
   }
 
+  StrategyStats &stats = display_comp_ctx->strategy_stats;
   if (error != kErrorNone) {
+    stats.exhausted_frames++;
+    UpdateGpuFallbackGovernor(display_comp_ctx, true /* gpu_fallback */, attempts);
     resource_intf_->Stop(display_resource_ctx, disp_layer_stack);
     DLOGE("Composition strategies exhausted for display = %d-%d. (first frame = %s)",
           display_comp_ctx->display_id, display_comp_ctx->display_type,
@@ -430,9 +657,63 @@ DisplayError CompManager::Prepare(Handle display_ctx, DispLayerStack *disp_layer
     return error;
   }
 
+  stats.frames++;
+  stats.total_attempts += attempts;
+  stats.max_attempts = std::max(stats.max_attempts, UINT64(attempts));
+
+  // Count a GPU fallback when every app layer ended up marked for GPU composition.
+  uint32_t app_layer_count = disp_layer_stack->info.app_layer_count;
+  bool gpu_fallback = (app_layer_count > 0);
+  for (uint32_t i = 0; gpu_fallback && i < app_layer_count; i++) {
+    gpu_fallback = (disp_layer_stack->stack->layers.at(i)->composition == kCompositionGPU);
+  }
+  if (gpu_fallback) {
+    stats.gpu_fallback_frames++;
+  }
+
+  UpdateGpuFallbackGovernor(display_comp_ctx, gpu_fallback, attempts);
+
   return error;
 }
 
+void CompManager::UpdateGpuFallbackGovernor(DisplayCompositionContext *display_comp_ctx,
+                                            bool gpu_fallback, uint32_t attempts) {
+  // At 60 fps the window is half a second; this many pressured frames within it indicate
+  // HW<->GPU thrash rather than an isolated transition spike.
+  const uint32_t kFallbackWindowFrames = 30;
+  const uint32_t kFallbackWindowHits = 4;
+  const uint32_t kGpuFallbackHoldFrames = 12;
+
+  if (disable_fallback_governor_ || force_gpu_comp_) {
+    return;
+  }
+
+  if (display_comp_ctx->gpu_fallback_hold) {
+    display_comp_ctx->gpu_fallback_hold--;
+    return;
+  }
+
+  display_comp_ctx->fallback_window_frames++;
+  // Multiple strategy attempts mean resources are under pressure even when the frame did not
+  // fully fall back; counting them lets the hold engage a frame early on a rising trend, so
+  // the client target is already populated when the full fallback would have hit.
+  if (gpu_fallback || attempts > 1) {
+    display_comp_ctx->fallback_window_hits++;
+  }
+
+  if (display_comp_ctx->fallback_window_hits >= kFallbackWindowHits) {
+    display_comp_ctx->gpu_fallback_hold = kGpuFallbackHoldFrames;
+    display_comp_ctx->fallback_window_frames = 0;
+    display_comp_ctx->fallback_window_hits = 0;
+    DLOGV_IF(kTagCompManager, "GPU fallback hold engaged for %u frames on display %d-%d",
+             kGpuFallbackHoldFrames, display_comp_ctx->display_id,
+             display_comp_ctx->display_type);
+  } else if (display_comp_ctx->fallback_window_frames >= kFallbackWindowFrames) {
+    display_comp_ctx->fallback_window_frames = 0;
+    display_comp_ctx->fallback_window_hits = 0;
+  }
+}
+
 DisplayError CompManager::PostPrepare(Handle display_ctx, DispLayerStack *disp_layer_stack) {
   std::lock_guard<std::recursive_mutex> obj(comp_mgr_mutex_);
   DisplayCompositionContext *display_comp_ctx =
@@ -545,18 +826,112 @@ void CompManager::DoGpuFallback(Handle display_ctx) {
   }
 }
 
+void CompManager::ProcessThermalEvent(Handle display_ctx, int64_t thermal_level) {
+  std::lock_guard<std::recursive_mutex> obj(comp_mgr_mutex_);
+
+  DisplayCompositionContext *display_comp_ctx =
+                             reinterpret_cast<DisplayCompositionContext *>(display_ctx);
+  if (!display_comp_ctx) {
+    return;
+  }
+
+  DLOGI("Thermal level %d reported through display %d-%d", INT(thermal_level),
+        display_comp_ctx->display_id, display_comp_ctx->display_type);
+  thermal_level_ = thermal_level;
+
+  if (thermal_level >= kMaxThermalLevel) {
+    thermal_relief_start_ms_ = 0;
+    if (!thermally_constrained_) {
+      thermally_constrained_ = true;
+      thermal_transitions_++;
+      DLOGI("Composition constrained to %d pipes under thermal pressure", kThermalMaxLayers);
+    }
+  } else if (thermally_constrained_ && !thermal_relief_start_ms_) {
+    // Start the relief dwell; the constraint lifts from the prepare path once the level has
+    // held below the threshold long enough, so a flapping sensor cannot bounce the strategy.
+    thermal_relief_start_ms_ = SystemTimeMs();
+  }
+}
+
+bool CompManager::EvaluateThermalConstraint() {
+  if (!thermally_constrained_) {
+    return false;
+  }
+
+  if (thermal_relief_start_ms_ &&
+      (SystemTimeMs() - thermal_relief_start_ms_) >= kThermalReliefDwellMs) {
+    thermally_constrained_ = false;
+    thermal_relief_start_ms_ = 0;
+    thermal_transitions_++;
+    DLOGI("Thermal pressure relieved, composition pipe constraint lifted");
+    return false;
+  }
+
+  return true;
+}
+
+uint64_t CompManager::SystemTimeMs() {
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (UINT64(t.tv_sec) * 1000) + (UINT64(t.tv_nsec) / 1000000);
+}
+
 void CompManager::ProcessIdlePowerCollapse(Handle display_ctx) {
   std::lock_guard<std::recursive_mutex> obj(comp_mgr_mutex_);
 
   DisplayCompositionContext *display_comp_ctx =
           reinterpret_cast<DisplayCompositionContext *>(display_ctx);
 
-  if (display_comp_ctx) {
-    resource_intf_->Perform(ResourceInterface::kCmdResetLUT,
-                            display_comp_ctx->display_resource_ctx);
+  if (!display_comp_ctx) {
+    return;
+  }
+
+  if (!idle_collapsed_displays_.insert(display_comp_ctx->display_id).second) {
+    // Collapsed again with no frame in between. The LUTs are still reset from the first
+    // enter - nothing has reprogrammed them without a commit - so repeating the reset only
+    // cycles the shared clock vote. This is the enter/exit oscillation seen when a sibling
+    // display's activity keeps bouncing an idle display out of collapse.
+    idle_pc_redundant_enters_++;
+    return;
+  }
+
+  idle_pc_enters_++;
+  resource_intf_->Perform(ResourceInterface::kCmdResetLUT,
+                          display_comp_ctx->display_resource_ctx);
+
+  // Each powered-on display holds one vote on the shared clocks; the chip is only fully
+  // idle once the last vote is gone. Log that edge - it is the transition power cares about.
+  bool all_idle = true;
+  for (auto display_id : powered_on_displays_) {
+    if (idle_collapsed_displays_.find(display_id) == idle_collapsed_displays_.end()) {
+      all_idle = false;
+      break;
+    }
+  }
+  if (all_idle) {
+    idle_pc_all_idle_edges_++;
+    DLOGI("All %zu powered on displays are in idle power collapse",
+          powered_on_displays_.size());
   }
 }
 
+void CompManager::ProcessAppLaunchHint(Handle display_ctx) {
+  std::lock_guard<std::recursive_mutex> obj(comp_mgr_mutex_);
+
+  DisplayCompositionContext *display_comp_ctx =
+          reinterpret_cast<DisplayCompositionContext *>(display_ctx);
+
+  if (!display_comp_ctx) {
+    return;
+  }
+
+  // An app launch replaces most of the stack; idle-time composition decisions no longer
+  // describe it. Drop them now so the warm-up frame validates the strategy the launch
+  // frame will actually use.
+  display_comp_ctx->idle_fallback = false;
+  display_comp_ctx->gpu_fallback_hold = 0;
+}
+
 DisplayError CompManager::SetMaxMixerStages(Handle display_ctx, uint32_t max_mixer_stages) {
   std::lock_guard<std::recursive_mutex> obj(comp_mgr_mutex_);
 
@@ -693,6 +1068,7 @@ bool CompManager::SetDisplayState(Handle display_ctx, DisplayState state,
   case kStateOff:
     Purge(display_ctx);
     powered_on_displays_.erase(display_comp_ctx->display_id);
+    idle_collapsed_displays_.erase(display_comp_ctx->display_id);
     break;
 
   case kStateOn:
@@ -700,10 +1076,12 @@ bool CompManager::SetDisplayState(Handle display_ctx, DisplayState state,
     resource_intf_->Perform(ResourceInterface::kCmdDedicatePipes,
                             display_comp_ctx->display_resource_ctx);
     powered_on_displays_.insert(display_comp_ctx->display_id);
+    idle_collapsed_displays_.erase(display_comp_ctx->display_id);
     break;
 
   case kStateDozeSuspend:
     powered_on_displays_.erase(display_comp_ctx->display_id);
+    idle_collapsed_displays_.erase(display_comp_ctx->display_id);
     break;
 
   default:
@@ -822,7 +1200,11 @@ DisplayError CompManager::SetDrawMethod(Handle display_ctx, const DisplayDrawMet
   if (error != kErrorNone) {
     return error;
   }
-  error = resource_intf_->SetDrawMethod(display_comp_ctx->display_resource_ctx, draw_method);
+  // Resource extensions treat the pipelined method as unified; the overlap is handled in
+  // DisplayBase and serialized here by comp_mgr_mutex_.
+  DisplayDrawMethod resource_method =
+      (draw_method == kDrawUnifiedPipelined) ? kDrawUnified : draw_method;
+  error = resource_intf_->SetDrawMethod(display_comp_ctx->display_resource_ctx, resource_method);
   if (error != kErrorNone) {
     return error;
   }
@@ -970,7 +1352,28 @@ std::string CompManager::Dump(Handle display_ctx) {
   DisplayCompositionContext *display_comp_ctx =
       reinterpret_cast<DisplayCompositionContext *>(display_ctx);
 
-  return resource_intf_->Dump(display_comp_ctx->display_resource_ctx);
+  std::ostringstream os;
+  StrategyStats &stats = display_comp_ctx->strategy_stats;
+  os << "\nStrategy stats: frames: " << stats.frames;
+  if (stats.frames) {
+    os << " avg attempts: " << std::fixed << std::setprecision(2)
+       << (FLOAT(stats.total_attempts) / FLOAT(stats.frames));
+  }
+  os << " max attempts: " << stats.max_attempts
+     << " gpu fallbacks: " << stats.gpu_fallback_frames
+     << " exhausted: " << stats.exhausted_frames << "\n";
+  os << "Thermal governor: level: " << thermal_level_
+     << " constrained: " << thermally_constrained_
+     << " constrained frames: " << thermal_constrained_frames_
+     << " transitions: " << thermal_transitions_ << "\n";
+  os << "Idle PC ledger: collapsed: " << idle_collapsed_displays_.size()
+     << "/" << powered_on_displays_.size()
+     << " enters: " << idle_pc_enters_
+     << " redundant: " << idle_pc_redundant_enters_
+     << " all-idle edges: " << idle_pc_all_idle_edges_ << "\n";
+  os << resource_intf_->Dump(display_comp_ctx->display_resource_ctx);
+
+  return os.str();
 }
 
 DppsControlInterface* CompManager::GetDppsControlIntf() {
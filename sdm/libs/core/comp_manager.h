@@ -84,6 +84,7 @@ class CompManager : public CwbCallback {
   void DoGpuFallback(Handle display_ctx);
   void ProcessThermalEvent(Handle display_ctx, int64_t thermal_level);
   void ProcessIdlePowerCollapse(Handle display_ctx);
+  void ProcessAppLaunchHint(Handle display_ctx);
   DisplayError SetMaxMixerStages(Handle display_ctx, uint32_t max_mixer_stages);
   void ControlPartialUpdate(Handle display_ctx, bool enable);
   DisplayError ValidateScaling(const LayerRect &crop, const LayerRect &dst, bool rotate90);
@@ -146,10 +147,46 @@ class CompManager : public CwbCallback {
  private:
   static const int kMaxThermalLevel = 3;
   static const int kSafeModeThreshold = 4;
+  // Upper bound on how long a remembered DPU rejection may pre-mark a layer for GPU, so a
+  // rejection that depended on transient resource state cannot pin the layer forever.
+  static const uint32_t kFeedbackMemoryFrames = 600;
+  // Pipes kept in reserve for the primary panel when sizing the secondary fetch layer budget;
+  // high refresh primaries reserve extra since they have no headroom to re-validate.
+  static const uint32_t kPrimaryReserveLayers = 4;
+  static const uint32_t kHighRefreshFps = 90;
+  // Thermal governor: composition is constrained while the reported thermal level is at or
+  // above kMaxThermalLevel; the constraint lifts only after the level has held below the
+  // threshold for the relief dwell, so a flapping sensor cannot bounce the strategy.
+  static const uint32_t kThermalMaxLayers = 4;       // DPU pipe budget under thermal pressure
+  static const uint64_t kThermalReliefDwellMs = 5000;
 
   void PrepareStrategyConstraints(Handle display_ctx, DispLayerStack *disp_layer_stack);
+  // True if the SSPPs can rotate this layer inline: 90 degree rotation, UBWC layout, an
+  // advertised inline rotation format and a downscale within the real time limit.
+  bool CanUseInlineRotation(const Layer *layer) const;
+  void UpdateGpuFallbackGovernor(DisplayCompositionContext *display_comp_ctx, bool gpu_fallback,
+                                 uint32_t attempts);
+  void BalanceSecondaryFetchLayers();
+  void ApplyFeedbackMemory(DisplayCompositionContext *display_comp_ctx,
+                           DispLayerStack *disp_layer_stack, LayerFeedback *feedback);
+  void RecordFeedbackMemory(DisplayCompositionContext *display_comp_ctx,
+                            DispLayerStack *disp_layer_stack, const LayerFeedback &feedback);
   void UpdateStrategyConstraints(bool is_primary, bool disabled);
   std::string StringDisplayList(const std::set<int32_t> &displays);
+  // True while composition must stay thermally constrained; also retires an expired relief
+  // dwell, so the constraint lifts from the prepare path even without further thermal events.
+  bool EvaluateThermalConstraint();
+  static uint64_t SystemTimeMs();
+
+  // Composition strategy accounting surfaced through Dump(). Updated in Prepare() under
+  // comp_mgr_mutex_, so plain counters are sufficient.
+  struct StrategyStats {
+    uint64_t frames = 0;               // prepare cycles that found a strategy
+    uint64_t total_attempts = 0;       // strategies tried across all such cycles
+    uint64_t max_attempts = 0;         // worst-case attempts in a single cycle
+    uint64_t gpu_fallback_frames = 0;  // cycles where every app layer fell back to GPU
+    uint64_t exhausted_frames = 0;     // cycles where all strategies failed
+  };
 
   struct DisplayCompositionContext {
     Strategy *strategy = NULL;
@@ -167,14 +204,38 @@ class CompManager : public CwbCallback {
     DisplayConfigVariableInfo fb_config = {};
     bool first_cycle_ = true;
     uint32_t dest_scaler_blocks_used = 0;
+    StrategyStats strategy_stats;
+    // GPU fallback governor: hysteresis against HW<->GPU composition thrash.
+    // See UpdateGpuFallbackGovernor().
+    uint32_t fallback_window_frames = 0;  // frames observed in the current window
+    uint32_t fallback_window_hits = 0;    // fallback/retry frames in the current window
+    uint32_t gpu_fallback_hold = 0;       // frames left to hold GPU composition
+    // DPU rejections remembered from failed resource prepares, indexed by app layer position.
+    // While a layer's fingerprint keeps matching, it is pre-marked unsupported so strategies
+    // that would stage it on DPU are skipped instead of burning a validation round-trip every
+    // frame. Entries drop when the layer changes or the TTL runs out.
+    struct LayerFeedbackMemory {
+      uint64_t fingerprint = 0;
+      uint32_t ttl = 0;  // frames remaining before the memory expires
+    };
+    std::vector<LayerFeedbackMemory> feedback_memory = {};
   };
 
   std::recursive_mutex comp_mgr_mutex_;
   ResourceInterface *resource_intf_ = NULL;
   std::map<int32_t, CompManagerEventHandler*> callback_map_;
+  // Registered composition contexts, used to size the cross-display pipe budget.
+  std::map<int32_t, DisplayCompositionContext *> display_ctx_map_;
   std::set<int32_t> registered_displays_;  // List of registered displays
   std::set<int32_t> configured_displays_;  // List of sucessfully configured displays
   std::set<int32_t> powered_on_displays_;  // List of powered on displays.
+  // Cross-display idle power collapse ledger. A display is added when the kernel reports
+  // collapse and removed by its next frame or power state change, so redundant enters can
+  // be detected and the last-vote-gone edge identified on multi-display devices.
+  std::set<int32_t> idle_collapsed_displays_;
+  uint64_t idle_pc_enters_ = 0;           // collapse notifications acted upon
+  uint64_t idle_pc_redundant_enters_ = 0; // repeats absorbed with no frame in between
+  uint64_t idle_pc_all_idle_edges_ = 0;   // times the last powered display collapsed
   bool safe_mode_ = false;              // Flag to notify all displays to be in resource crunch
                                         // mode, where strategy manager chooses the best strategy
                                         // that uses optimal number of pipes for each display
@@ -190,6 +251,14 @@ class CompManager : public CwbCallback {
   std::map<int32_t /* display_id */, bool> display_demura_status_;
   SecureEvent secure_event_ = kSecureEventMax;
   bool force_gpu_comp_ = false;
+  bool disable_fallback_governor_ = false;
+  bool disable_inline_rotation_ = false;  // DISABLE_INLINE_ROTATOR_PROP
+  // Thermal governor state, guarded by comp_mgr_mutex_; counters surfaced through Dump().
+  int64_t thermal_level_ = 0;
+  bool thermally_constrained_ = false;
+  uint64_t thermal_relief_start_ms_ = 0;      // when the level last dropped below the threshold
+  uint64_t thermal_constrained_frames_ = 0;   // prepare cycles run under the constraint
+  uint32_t thermal_transitions_ = 0;          // constrain/relieve edges
 };
 
 }  // namespace sdm
@@ -68,11 +68,10 @@ CoreImpl::CoreImpl(BufferAllocator *buffer_allocator,
   : buffer_allocator_(buffer_allocator), socket_handler_(socket_handler), ipc_intf_(ipc_intf) {
 }
 
-DisplayError CoreImpl::Init() {
-  SCOPE_LOCK(locker_);
-  DisplayError error = kErrorNone;
-
-  // Try to load extension library & get handle to its interface.
+// Loads the extension library & gets a handle to its interface. The dependency chain behind
+// it (color/QDCM libraries) costs tens of ms in dlopen+relocation, so Init() runs this off
+// the boot-critical path and joins it in WaitForExtensionLib() before the first factory use.
+DisplayError CoreImpl::LoadExtensionLib() {
   if (extension_lib_.Open(EXTENSION_LIBRARY_NAME)) {
     if (!extension_lib_.Sym(CREATE_EXTENSION_INTERFACE_NAME,
                             reinterpret_cast<void **>(&create_extension_intf_)) ||
@@ -82,7 +81,7 @@ DisplayError CoreImpl::Init() {
       return kErrorUndefined;
     }
 
-    error = create_extension_intf_(EXTENSION_VERSION_TAG, &extension_intf_);
+    DisplayError error = create_extension_intf_(EXTENSION_VERSION_TAG, &extension_intf_);
     if (error != kErrorNone) {
       DLOGE("Unable to create interface");
       return error;
@@ -97,16 +96,51 @@ DisplayError CoreImpl::Init() {
 #endif
   }
 
+  return kErrorNone;
+}
+
+DisplayError CoreImpl::WaitForExtensionLib() {
+  if (!extension_load_.valid()) {
+    return kErrorNone;
+  }
+
+  return extension_load_.get();
+}
+
+DisplayError CoreImpl::Init() {
+  SCOPE_LOCK(locker_);
+  DisplayError error = kErrorNone;
+  DisplayError ext_error = kErrorNone;
+
+  // Load the extension chain concurrently with the hardware info query below; both take tens
+  // of ms and neither depends on the other.
+  extension_load_ = std::async(std::launch::async, [this]() {
+    return LoadExtensionLib();
+  });
+
   int value = 0;
   Debug::Get()->GetProperty(ENABLE_NULL_DISPLAY_PROP, &value);
   enable_null_display_ = (value == 1);
   DLOGI("property: enable_null_display_ = %d", enable_null_display_);
   if (enable_null_display_) {
+    error = WaitForExtensionLib();
+    if (error != kErrorNone) {
+      return error;
+    }
     hw_info_intf_ = new HWInfoDefault();
     return kErrorNone;
   }
 
   error = HWInfoInterface::Create(&hw_info_intf_);
+
+  // First factory use of the extension interface is comp_mgr_.Init() (also reached through
+  // HandleNullDisplay()), so the load must have finished here.
+  ext_error = WaitForExtensionLib();
+  if (ext_error != kErrorNone) {
+    error = ext_error;
+    goto CleanupOnError;
+  }
+
   if (error != kErrorNone) {
     DisplayError err = HandleNullDisplay();
 
@@ -139,11 +173,12 @@ DisplayError CoreImpl::Init() {
     return kErrorNone;
   }
 
-  error = ColorManagerProxy::Init(hw_resource_);
-  // if failed, doesn't affect display core functionalities.
-  if (error != kErrorNone) {
-    DLOGW("Unable creating color manager and continue without it.");
-  }
+  // Color manager loads its libraries and calibration data off hw_resource_ only, so it can be
+  // brought up concurrently with the remaining core init and the caller's display bring-up.
+  // Joined in WaitForColorManagerInit() before the first display is created.
+  color_mgr_init_ = std::async(std::launch::async, [this]() {
+    return ColorManagerProxy::Init(hw_resource_);
+  });
 
   // Populate hw_displays_info_ once.
   error = hw_info_intf_->GetDisplaysStatus(&hw_displays_info_);
@@ -189,8 +224,21 @@ DisplayError CoreImpl::RequestVirtualDisplayId(int32_t *vdisp_id) {
   return comp_mgr_.RequestVirtualDisplayId(vdisp_id);
 }
 
+void CoreImpl::WaitForColorManagerInit() {
+  if (!color_mgr_init_.valid()) {
+    return;
+  }
+
+  DisplayError error = color_mgr_init_.get();
+  // if failed, doesn't affect display core functionalities.
+  if (error != kErrorNone) {
+    DLOGW("Unable creating color manager and continue without it.");
+  }
+}
+
 DisplayError CoreImpl::Deinit() {
   SCOPE_LOCK(locker_);
+  WaitForColorManagerInit();
   if (vm_cb_intf_) {
     vm_cb_intf_->Deinit();
     delete vm_cb_intf_;
@@ -237,6 +285,9 @@ DisplayError CoreImpl::CreateDisplay(DisplayType type, DisplayEventHandler *even
     return CreateNullDisplayLocked(intf);
   }
 
+  // Displays create per-display color manager proxies in Init(); the global proxy must be up.
+  WaitForColorManagerInit();
+
   DisplayBase *display_base = NULL;
 
   switch (type) {
@@ -283,6 +334,9 @@ DisplayError CoreImpl::CreateDisplay(int32_t display_id, DisplayEventHandler *ev
     return CreateNullDisplayLocked(intf);
   }
 
+  // Displays create per-display color manager proxies in Init(); the global proxy must be up.
+  WaitForColorManagerInit();
+
   auto iter = hw_displays_info_.find(display_id);
 
   if (iter == hw_displays_info_.end()) {
@@ -47,6 +47,7 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <future>
 
 #include "comp_manager.h"
 
@@ -117,6 +118,9 @@ class CoreImpl : public CoreInterface {
 
  protected:
   void InitializeSDMUtils();
+  void WaitForColorManagerInit();
+  DisplayError LoadExtensionLib();
+  DisplayError WaitForExtensionLib();
   void ReleaseDemuraResources();
   void OverRideDemuraPanelIds(std::vector<uint64_t> *panel_ids);
   DisplayError CreateNullDisplayLocked(DisplayInterface **intf);
@@ -143,6 +147,12 @@ class CoreImpl : public CoreInterface {
   char *raw_mapped_buffer_ = nullptr;
   std::vector<uint32_t> demura_display_ids_;
   bool enable_null_display_ = false;
+  // Color manager bring-up runs concurrently with the rest of Init(); joined before the first
+  // display is created and on Deinit(). See WaitForColorManagerInit().
+  std::future<DisplayError> color_mgr_init_ = {};
+  // Extension chain dlopen+relocation runs concurrently with the hardware info query and is
+  // joined before the first factory use. See WaitForExtensionLib().
+  std::future<DisplayError> extension_load_ = {};
 };
 
 }  // namespace sdm
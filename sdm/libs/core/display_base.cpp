@@ -30,6 +30,7 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 #include <malloc.h>
 #include <utils/constants.h>
 #include <utils/debug.h>
@@ -139,9 +140,12 @@ DisplayError DisplayBase::Init() {
   hw_intf_->GetHWPanelInfo(&hw_panel_info_);
   default_panel_mode_ = hw_panel_info_.mode;
   if (hw_info_intf_) {
-    hw_info_intf_->GetHWResourceInfo(&hw_resource_info_);
+    std::shared_ptr<const HWResourceInfo> snapshot = hw_info_intf_->GetHWResourceInfo();
+    if (snapshot) {
+      hw_resource_info_ = snapshot;
+    }
   }
-  auto max_mixer_stages = hw_resource_info_.num_blending_stages;
+  auto max_mixer_stages = hw_resource_info_->num_blending_stages;
   int property_value = Debug::GetMaxPipesPerMixer(display_type_);
 
   uint32_t active_index = 0;
@@ -219,7 +223,7 @@ DisplayError DisplayBase::Init() {
   }
 
   if (property_value > 0) {
-    max_mixer_stages = std::min(UINT32(property_value), hw_resource_info_.num_blending_stages);
+    max_mixer_stages = std::min(UINT32(property_value), hw_resource_info_->num_blending_stages);
   }
   DisplayBase::SetMaxMixerStages(max_mixer_stages);
 
@@ -253,6 +257,10 @@ DisplayError DisplayBase::Init() {
     disable_llcc_during_aod_ = (prop == 1);
   }
   prop = 0;
+  if (Debug::Get()->GetProperty(ENABLE_DOZE_QOS_FLOOR, &prop) == kErrorNone) {
+    enable_doze_qos_floor_ = (prop == 1);
+  }
+  prop = 0;
   if (Debug::Get()->GetProperty(ALLOW_TONEMAP_NATIVE, &prop) == kErrorNone) {
     allow_tonemap_native_ = (prop == 1);
   }
@@ -495,9 +503,9 @@ DisplayError DisplayBase::SetupPanelFeatureFactory() {
 }
 
 DisplayError DisplayBase::NoiseInit() {
-  if (!hw_resource_info_.has_noise_layer || noise_disable_prop_) {
+  if (!hw_resource_info_->has_noise_layer || noise_disable_prop_) {
     DLOGW("Noise Layer disabled on display %d-%d has_noise = %d noise_disable_prop = %d",
-          display_id_, display_type_, hw_resource_info_.has_noise_layer, noise_disable_prop_);
+          display_id_, display_type_, hw_resource_info_->has_noise_layer, noise_disable_prop_);
     return kErrorNone;
   }
 
@@ -532,7 +540,7 @@ DisplayError DisplayBase::InitRC() {
     input_cfg.display_type = display_type_;
     input_cfg.display_xres = display_attributes_.x_pixels;
     input_cfg.display_yres = display_attributes_.y_pixels;
-    input_cfg.max_mem_size = hw_resource_info_.rc_total_mem_size;
+    input_cfg.max_mem_size = hw_resource_info_->rc_total_mem_size;
     rc_core_ = pf_factory_->CreateRCIntf(input_cfg, prop_intf_);
     GenericPayload dummy;
     int err = 0;
@@ -612,7 +620,7 @@ DisplayError DisplayBase::GetCwbBufferResolution(CwbConfig *cwb_config, uint32_t
 
 void DisplayBase::ConfigureCwbParams(LayerStack *layer_stack) {
   DisplayError error = kErrorNone;
-  if (hw_resource_info_.has_concurrent_writeback && layer_stack->output_buffer) {  // CWB requested
+  if (hw_resource_info_->has_concurrent_writeback && layer_stack->output_buffer) {  // CWB requested
     cwb_configured_ = true;
     comp_manager_->HandleCwbFrequencyBoost(true);
 
@@ -646,8 +654,8 @@ void DisplayBase::ConfigureCwbParams(LayerStack *layer_stack) {
 bool DisplayBase::IsWriteBackSupportedFormat(const LayerBufferFormat &format) {
   // check whether writeback supported for parameter color format or not.
   std::map<HWSubBlockType, std::vector<LayerBufferFormat>>::iterator it =
-      hw_resource_info_.supported_formats_map.find(HWSubBlockType::kHWWBIntfOutput);
-  if (it == hw_resource_info_.supported_formats_map.end()) {
+      hw_resource_info_->supported_formats_map.find(HWSubBlockType::kHWWBIntfOutput);
+  if (it == hw_resource_info_->supported_formats_map.end()) {
     return false;
   }
   std::vector<LayerBufferFormat> &supported_sdm_formats = it->second;
@@ -775,9 +783,89 @@ bool DisplayBase::IsValidateNeeded() {
   return false;
 }
 
+bool DisplayBase::IsDirectScanoutFrame(LayerStack *layer_stack) {
+  const HWLayersInfo &info = disp_layer_stack_->info;
+  bool candidate = (info.app_layer_count == 1) && !info.flags.noise_present &&
+                   !layer_stack->output_buffer && !layer_stack->flags.geometry_changed;
+
+  Layer *layer = nullptr;
+  if (candidate) {
+    layer = layer_stack->layers.at(0);
+    LayerRect full_frame = {0.0f, 0.0f, FLOAT(mixer_attributes_.width),
+                            FLOAT(mixer_attributes_.height)};
+    float src_width = layer->src_rect.right - layer->src_rect.left;
+    float src_height = layer->src_rect.bottom - layer->src_rect.top;
+    candidate = !layer->flags.skip && !layer->flags.solid_fill &&
+                !layer->input_buffer.flags.hdr && (layer->plane_alpha == 0xff) &&
+                ((layer->blending == kBlendingOpaque) ||
+                 (layer->blending == kBlendingPremultiplied)) &&
+                (layer->transform == LayerTransform()) && (layer->dst_rect == full_frame) &&
+                (src_width == FLOAT(mixer_attributes_.width)) &&
+                (src_height == FLOAT(mixer_attributes_.height)) &&
+                layer->dirty_regions.empty();  // full damage keeps the cached full-frame ROI exact
+  }
+
+  if (!candidate) {
+    direct_scanout_streak_ = 0;
+    return false;
+  }
+
+  // Geometry fingerprint of everything the skipped work depends on. Buffer
+  // contents change every frame and intentionally stay out of it.
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint64_t value) {
+    hash ^= value;
+    hash *= 1099511628211ULL;
+  };
+  auto mix_rect = [&mix](const LayerRect &rect) {
+    uint32_t bits = 0;
+    float fields[] = {rect.left, rect.top, rect.right, rect.bottom};
+    for (float field : fields) {
+      memcpy(&bits, &field, sizeof(bits));
+      mix(bits);
+    }
+  };
+  mix(UINT64(layer->input_buffer.format));
+  mix(layer->input_buffer.flags.secure);
+  mix(UINT64(layer->blending));
+  mix((UINT64(mixer_attributes_.width) << 32) | mixer_attributes_.height);
+  mix_rect(layer->src_rect);
+  mix_rect(layer->dst_rect);
+
+  if (hash != direct_scanout_hash_) {
+    direct_scanout_hash_ = hash;
+    direct_scanout_streak_ = 1;
+    return false;
+  }
+  if (direct_scanout_streak_ < UINT32_MAX) {
+    direct_scanout_streak_++;
+  }
+
+  // With pipelined prepare the stacks alternate; both must have carried this
+  // exact frame before their cached ROI/color state can be trusted.
+  if ((direct_scanout_streak_ < 3) || !validated_) {
+    return false;
+  }
+
+  // Any pending color asset/mode work forces the full path so it gets applied.
+  if (color_mgr_ && color_mgr_->IsValidateNeeded()) {
+    return false;
+  }
+
+  return true;
+}
+
 DisplayError DisplayBase::PrePrepare(LayerStack *layer_stack) {
   DTRACE_SCOPED();
-  ClientLock lock(disp_mutex_);
+  // In pipelined draw, run prepare of the next cycle concurrently with an in-flight async
+  // commit. The commit thread operates on commit_stack_ only, so advance to the other stack
+  // before writing any prepare state.
+  bool overlap_commit = pipelined_prepare_ && !first_cycle_;
+  ClientLock lock(disp_mutex_, overlap_commit);
+  if (overlap_commit && !pipelined_stack_advanced_) {
+    AdvanceDispLayerStack();
+    pipelined_stack_advanced_ = true;
+  }
 
   EnableLlccDuringAodMode(layer_stack);
 
@@ -902,7 +990,14 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
   DisplayError error = kErrorNone;
   needs_validate_ = true;
 
-  ResetDispLayerStack();
+  if (pipelined_stack_advanced_) {
+    // PrePrepare already moved to the next stack for this cycle.
+    pipelined_stack_advanced_ = false;
+  } else if (pipelined_prepare_) {
+    AdvanceDispLayerStack();
+  } else {
+    ResetDispLayerStack();
+  }
 
   if (!layer_stack) {
     return kErrorParameters;
@@ -929,7 +1024,12 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
   // This call in Prepare will return the cached value during PrePrepare()
   PrepareRC(layer_stack);
 
-  if (color_mgr_) {
+  // Repeated fullscreen single-layer frame: color pipeline and ROI state from
+  // the previous cycle are exact, so skip re-deriving them. Strategy below
+  // still runs but resolves to its cached composition on the first attempt.
+  bool direct_scanout = IsDirectScanoutFrame(layer_stack);
+
+  if (color_mgr_ && !direct_scanout) {
     color_mgr_->Prepare();
     // apply pending DE config
     PPPendingParams pending_action;
@@ -953,7 +1053,9 @@ DisplayError DisplayBase::Prepare(LayerStack *layer_stack) {
   }
 
   disp_layer_stack_->info.updates_mask.set(kUpdateResources);
-  comp_manager_->GenerateROI(display_comp_ctx_, disp_layer_stack_);
+  if (!direct_scanout) {
+    comp_manager_->GenerateROI(display_comp_ctx_, disp_layer_stack_);
+  }
 
   CheckMMRMState();
 
@@ -1418,8 +1520,8 @@ DisplayError DisplayBase::CommitOrPrepare(LayerStack *layer_stack) {
 
 void DisplayBase::HandleAsyncCommit() {
   // Do not acquire mutexes here.
-  // Perform hw commit here.
-  DisplayError error = PerformHwCommit(&disp_layer_stack_->info);
+  // Perform hw commit on the stack captured in SetUpCommit.
+  DisplayError error = PerformHwCommit(&commit_stack_->info);
   if (error != kErrorNone) {
     DLOGW("HwCommit failed %d", error);
     CleanupOnError();
@@ -1487,6 +1589,10 @@ DisplayError DisplayBase::SetUpCommit(LayerStack *layer_stack) {
     return kErrorParameters;
   }
 
+  // Capture the stack for the commit thread; disp_layer_stack_ may advance to the next
+  // cycle's stack before this commit completes in pipelined draw.
+  commit_stack_ = disp_layer_stack_;
+
   disp_layer_stack_->info.output_buffer = layer_stack->output_buffer;
   disp_layer_stack_->info.cwb_id = layer_stack->cwb_id;
   if (layer_stack->request_flags.trigger_refresh) {
@@ -1546,9 +1652,73 @@ DisplayError DisplayBase::SetUpCommit(LayerStack *layer_stack) {
   return error;
 }
 
+void DisplayBase::ApplyDozeQosFloor(HWLayersInfo *hw_layers_info) {
+  if (!enable_doze_qos_floor_ || ((state_ != kStateDoze) && (state_ != kStateDozeSuspend))) {
+    return;
+  }
+
+  HWQosData &qos_data = hw_layers_info->qos_data;
+  if (!qos_data.valid) {
+    return;
+  }
+
+  // Area below which a doze frame counts as sparse (AOD clock region), and the floor any
+  // vote is scaled to, so prefill for the first ROI line is never starved.
+  const uint64_t kSparseAreaPct = 10;
+  const uint64_t kQosFloorPct = 5;
+
+  uint64_t panel_width = display_attributes_.x_pixels;
+  uint64_t panel_height = display_attributes_.y_pixels;
+  uint64_t panel_area = panel_width * panel_height;
+  if (!panel_area) {
+    return;
+  }
+
+  uint64_t update_area = 0;
+  uint64_t update_height = 0;
+  for (uint32_t i = 0; i < hw_layers_info->left_frame_roi.size(); i++) {
+    const LayerRect &l_roi = hw_layers_info->left_frame_roi.at(i);
+    const LayerRect &r_roi = hw_layers_info->right_frame_roi.at(i);
+    if (IsValid(l_roi)) {
+      update_area += UINT64(l_roi.right - l_roi.left) * UINT64(l_roi.bottom - l_roi.top);
+      update_height += UINT64(l_roi.bottom - l_roi.top);
+    }
+    if (IsValid(r_roi)) {
+      update_area += UINT64(r_roi.right - r_roi.left) * UINT64(r_roi.bottom - r_roi.top);
+    }
+  }
+
+  if (!update_area || ((update_area * 100) >= (panel_area * kSparseAreaPct))) {
+    // No partial update ROI, or too large a region to count as sparse.
+    return;
+  }
+
+  // Bandwidth follows the pixels actually fetched; the core clock follows the lines pushed to
+  // the panel, since each updated line is still fetched at line rate.
+  uint64_t bw_pct = std::max((update_area * 100) / panel_area, kQosFloorPct);
+  uint64_t clk_pct = std::max((update_height * 100) / panel_height, kQosFloorPct);
+
+  qos_data.clock_hz = UINT32((qos_data.clock_hz * clk_pct) / 100);
+  qos_data.core_ab_bps = (qos_data.core_ab_bps * bw_pct) / 100;
+  qos_data.core_ib_bps = (qos_data.core_ib_bps * bw_pct) / 100;
+  qos_data.llcc_ab_bps = (qos_data.llcc_ab_bps * bw_pct) / 100;
+  qos_data.llcc_ib_bps = (qos_data.llcc_ib_bps * bw_pct) / 100;
+  qos_data.dram_ab_bps = (qos_data.dram_ab_bps * bw_pct) / 100;
+  qos_data.dram_ib_bps = (qos_data.dram_ib_bps * bw_pct) / 100;
+
+  DLOGV_IF(kTagDisplay, "Doze QoS floor: update area %u%% height %u%% -> clk %u core_ab %u Mbps",
+           UINT32((update_area * 100) / panel_area), UINT32(clk_pct), qos_data.clock_hz,
+           UINT32(qos_data.core_ab_bps / 1000000));
+}
+
 DisplayError DisplayBase::PerformCommit(HWLayersInfo *hw_layers_info) {
   DTRACE_SCOPED();
+  // Scale votes down for sparse doze frames, but keep the composed values as the frame's state
+  // so caching and power transitions never see the floored numbers compound.
+  HWQosData full_qos_data = hw_layers_info->qos_data;
+  ApplyDozeQosFloor(hw_layers_info);
   DisplayError error = hw_intf_->Commit(hw_layers_info);
+  hw_layers_info->qos_data = full_qos_data;
   if (error != kErrorNone) {
     DLOGE("COMMIT failed: %d ", error);
   }
@@ -1645,7 +1815,8 @@ DisplayError DisplayBase::PerformHwCommit(HWLayersInfo *hw_layers_info) {
 
 void DisplayBase::CleanupOnError() {
   // Buffer Fd's are duped for async thread operation.
-  for (auto &hw_layer : disp_layer_stack_->info.hw_layers) {
+  DispLayerStack *stack = commit_stack_ ? commit_stack_ : disp_layer_stack_;
+  for (auto &hw_layer : stack->info.hw_layers) {
     CloseFd(&hw_layer.input_buffer.planes[0].fd);
   }
 }
@@ -1673,7 +1844,7 @@ DisplayError DisplayBase::PostCommit(HWLayersInfo *hw_layers_info) {
     comp_manager_->ControlPartialUpdate(display_comp_ctx_, true /* enable */);
   }
 
-  DisplayError error = comp_manager_->PostCommit(display_comp_ctx_, disp_layer_stack_);
+  DisplayError error = comp_manager_->PostCommit(display_comp_ctx_, commit_stack_);
   if (error != kErrorNone) {
     return error;
   }
@@ -1697,15 +1868,17 @@ DisplayError DisplayBase::PostCommit(HWLayersInfo *hw_layers_info) {
 
   CacheFrameBuffer();
 
-  for (auto &hw_layer : disp_layer_stack_->info.hw_layers) {
+  for (auto &hw_layer : hw_layers_info->hw_layers) {
     CloseFd(&hw_layer.input_buffer.planes[0].fd);
   }
 
   first_cycle_ = false;
 
-  if (clearstack_.load()) {
+  // In pipelined draw the next slot is recycled in AdvanceDispLayerStack under the client
+  // lock; recycling it here could wipe a prepare already in progress on that slot.
+  if (!pipelined_prepare_ && clearstack_.load()) {
     uint8_t clearindex = (disp_stack_index_ + 1) % kDispStackCount;
-    disp_layer_stacks_[clearindex] = DispLayerStack();
+    disp_layer_stacks_[clearindex].Reset();
     clearstack_.store(false);
   }
 
@@ -1810,9 +1983,8 @@ DisplayError DisplayBase::GetConfig(DisplayConfigFixedInfo *fixed_info) {
   ClientLock lock(disp_mutex_);
   fixed_info->is_cmdmode = (hw_panel_info_.mode == kModeCommand);
 
-  HWResourceInfo hw_resource_info = HWResourceInfo();
-  hw_info_intf_->GetHWResourceInfo(&hw_resource_info);
-  bool hdr_supported = hw_resource_info.has_hdr;
+  std::shared_ptr<const HWResourceInfo> hw_resource_info = hw_info_intf_->GetHWResourceInfo();
+  bool hdr_supported = hw_resource_info && hw_resource_info->has_hdr;
   bool hdr_plus_supported = false;
   bool dolby_vision_supported = false;
   HWDisplayInterfaceInfo hw_disp_info = {};
@@ -1837,7 +2009,7 @@ DisplayError DisplayBase::GetConfig(DisplayConfigFixedInfo *fixed_info) {
   fixed_info->hdr_eotf = hw_panel_info_.hdr_eotf;
   fixed_info->hdr_metadata_type_one = hw_panel_info_.hdr_metadata_type_one;
   fixed_info->partial_update = hw_panel_info_.partial_update;
-  fixed_info->readback_supported = hw_resource_info.has_concurrent_writeback;
+  fixed_info->readback_supported = hw_resource_info && hw_resource_info->has_concurrent_writeback;
   fixed_info->supports_unified_draw = unified_draw_supported_;
 
   return kErrorNone;
@@ -1883,14 +2055,18 @@ DisplayError DisplayBase::SetDrawMethod(DisplayDrawMethod draw_method) {
     DLOGE("Failed to set method: %d for %d-%d", draw_method, display_id_, display_type_);
     retire_fence_offset_ = 0;
     draw_method_ = kDrawDefault;
+    pipelined_prepare_ = false;
     draw_method_set_ = true;
     return error;
   }
 
   retire_fence_offset_ = (draw_method != kDrawDefault) && (display_type_ != kVirtual) ? 1 : 0;
-  draw_method_ = draw_method;
+  // Pipelined draw differs from unified only in prepare scheduling; internal draw cycle
+  // decisions continue to key off kDrawUnified.
+  pipelined_prepare_ = (draw_method == kDrawUnifiedPipelined);
+  draw_method_ = pipelined_prepare_ ? kDrawUnified : draw_method;
   draw_method_set_ = true;
-  DLOGI("method: %d", draw_method);
+  DLOGI("method: %d pipelined: %d", draw_method_, pipelined_prepare_);
 
   return kErrorNone;
 }
@@ -2090,6 +2266,35 @@ DisplayError DisplayBase::SetActiveConfig(uint32_t index) {
   return ReconfigureDisplay();
 }
 
+DisplayError DisplayBase::PrefetchActiveConfig(uint32_t index) {
+  ClientLock lock(disp_mutex_);
+  return hw_intf_->PrefetchDisplayConfig(index);
+}
+
+DisplayError DisplayBase::SetCommitQueueDepth(uint32_t depth) {
+  ClientLock lock(disp_mutex_);
+  if (depth < 1 || depth > kMaxCommitQueueDepth) {
+    return kErrorParameters;
+  }
+
+  if (display_type_ == kVirtual) {
+    return kErrorNotSupported;
+  }
+
+  if (depth > 1 && draw_method_ == kDrawDefault) {
+    // Default draw retires each frame at its own flip; only unified draw supports chaining
+    // the retire fence to a later flip.
+    return kErrorNotSupported;
+  }
+
+  retire_fence_offset_ = depth - 1;
+  deep_queue_busy_commits_ = 0;
+  DLOGI("Commit queue depth %u (retire fence offset %u) for %d-%d", depth, retire_fence_offset_,
+        display_id_, display_type_);
+
+  return kErrorNone;
+}
+
 DisplayError DisplayBase::SetMaxMixerStages(uint32_t max_mixer_stages) {
   ClientLock lock(disp_mutex_);
   DisplayError error = kErrorNone;
@@ -2104,129 +2309,122 @@ DisplayError DisplayBase::SetMaxMixerStages(uint32_t max_mixer_stages) {
   return error;
 }
 
-void DisplayBase::AppendRCMaskData(std::ostringstream &os) {
-  uint32_t num_mask_layers = disp_layer_stack_->info.rc_layers_info.mask_layer_idx.size();
-  uint32_t num_rc_hw_layers = disp_layer_stack_->info.rc_layers_info.rc_hw_layer_idx.size();
-  if (num_mask_layers && rc_enable_prop_) {
-    os << "\nRC HW Mask Layer Idx: [";
-    for (uint32_t i = 0; i < num_rc_hw_layers; i++) {
-      os << disp_layer_stack_->info.rc_layers_info.rc_hw_layer_idx.at(i);
-      if (i < (num_rc_hw_layers - 1)) {
-        os << ", ";
-      }
-    }
-    os << "] of [";
-    for (uint32_t i = 0; i < num_mask_layers; i++) {
-      os << disp_layer_stack_->info.rc_layers_info.mask_layer_idx.at(i);
-      if (i < (num_mask_layers - 1)) {
-        os << ", ";
-      }
-    }
-    os << "]";
-  }
-}
-
-std::string DisplayBase::Dump() {
-  ClientLock lock(disp_mutex_);
-  HWDisplayAttributes attrib;
-  uint32_t active_index = 0;
-  uint32_t num_modes = 0;
-  std::ostringstream os;
+void DisplayBase::CaptureDumpSnapshot() {
+  // Mirror the per-frame state Dump() formats, with flat copies only. Runs at commit while the
+  // display lock is already held; the vectors retain their capacity across frames so steady
+  // state does not allocate.
+  DispLayerStack *stack = commit_stack_ ? commit_stack_ : disp_layer_stack_;
+  HWLayersInfo &layer_info = stack->info;
+  LayerTableSnapshot &snapshot = dump_snapshot_;
 
-  hw_intf_->GetNumDisplayAttributes(&num_modes);
-  hw_intf_->GetActiveConfig(&active_index);
-  hw_intf_->GetDisplayAttributes(active_index, &attrib);
+  uint32_t num_hw_layers = UINT32(layer_info.hw_layers.size());
+  snapshot.layers.resize(num_hw_layers);
+  for (uint32_t i = 0; i < num_hw_layers; i++) {
+    DumpLayerRecord &record = snapshot.layers[i];
+    Layer &hw_layer = layer_info.hw_layers.at(i);
+    HWLayerConfig &layer_config = layer_info.config[i];
+    HWRotatorSession &hw_rotator_session = layer_config.hw_rotator_session;
 
-  os << "device type:" << display_type_;
-  os << " DrawMethod: " << draw_method_;
-  os << "\nstate: " << state_ << " vsync on: " << vsync_enable_
-     << " max. mixer stages: " << max_mixer_stages_;
-  if (disp_layer_stack_->info.noise_layer_info.enable) {
-    os << "\nNoise z-orders: [" << disp_layer_stack_->info.noise_layer_info.zpos_noise << ","
-       << disp_layer_stack_->info.noise_layer_info.zpos_attn << "]";
-  }
-  os << "\nnum configs: " << num_modes << " active config index: " << active_index;
-  os << "\nDisplay Attributes:";
-  os << "\n Mode:" << (hw_panel_info_.mode == kModeVideo ? "Video" : "Command");
-  os << std::boolalpha;
-  os << " Primary:" << hw_panel_info_.is_primary_panel;
-  os << " DynFPS:" << hw_panel_info_.dynamic_fps;
-  os << "\n HDR Panel:" << hw_panel_info_.hdr_enabled;
-  os << " QSync:" << hw_panel_info_.qsync_support;
-  os << " DynBitclk:" << hw_panel_info_.dyn_bitclk_support;
-  os << "\n Left Split:" << hw_panel_info_.split_info.left_split
-     << " Right Split:" << hw_panel_info_.split_info.right_split;
-  os << "\n PartialUpdate:" << hw_panel_info_.partial_update;
-  if (hw_panel_info_.partial_update) {
-    os << "\n ROI Min w:" << hw_panel_info_.min_roi_width;
-    os << " Min h:" << hw_panel_info_.min_roi_height;
-    os << " NeedsMerge: " << hw_panel_info_.needs_roi_merge;
-    os << " Alignment: l:" << hw_panel_info_.left_align << " w:" << hw_panel_info_.width_align;
-    os << " t:" << hw_panel_info_.top_align << " b:" << hw_panel_info_.height_align;
-  }
-  os << "\n FPS min:" << hw_panel_info_.min_fps << " max:" << hw_panel_info_.max_fps
-     << " cur:" << display_attributes_.fps;
-  os << " TransferTime: " << hw_panel_info_.transfer_time_us << "us";
-  os << " Min TransferTime: " << hw_panel_info_.transfer_time_us_min << "us";
-  os << " Max TransferTime: " << hw_panel_info_.transfer_time_us_max << "us";
-  os << " MaxBrightness:" << hw_panel_info_.panel_max_brightness;
-  os << "\n Display WxH: " << display_attributes_.x_pixels << "x" << display_attributes_.y_pixels;
-  os << " MixerWxH: " << mixer_attributes_.width << "x" << mixer_attributes_.height;
-  os << " DPI: " << display_attributes_.x_dpi << "x" << display_attributes_.y_dpi;
-  os << " LM_Split: " << display_attributes_.is_device_split;
-  os << "\n vsync_period " << display_attributes_.vsync_period_ns;
-  os << " v_back_porch: " << display_attributes_.v_back_porch;
-  os << " v_front_porch: " << display_attributes_.v_front_porch;
-  os << " v_pulse_width: " << display_attributes_.v_pulse_width;
-  os << "\n v_total: " << display_attributes_.v_total;
-  os << " h_total: " << display_attributes_.h_total;
-  os << " clk: " << display_attributes_.clock_khz;
-  os << " Topology: " << display_attributes_.topology;
-  os << std::noboolalpha;
+    record.layer_index = layer_info.index.at(i);
+    record.composition = hw_layer.composition;
+    record.buffer_width = hw_layer.input_buffer.width;
+    record.buffer_height = hw_layer.input_buffer.height;
+    record.buffer_format = hw_layer.input_buffer.format;
+    record.layer_flags = hw_layer.flags.flags;
+    record.color_primaries = UINT32(hw_layer.input_buffer.color_metadata.colorPrimaries);
+    record.color_range = UINT32(hw_layer.input_buffer.color_metadata.range);
+    record.color_transfer = UINT32(hw_layer.input_buffer.color_metadata.transfer);
+
+    record.rotate_count = std::min(hw_rotator_session.hw_block_count, UINT32(kMaxRotatePerLayer));
+    for (uint32_t count = 0; count < record.rotate_count; count++) {
+      record.rotate[count].src_roi = hw_rotator_session.hw_rotate_info[count].src_roi;
+      record.rotate[count].dst_roi = hw_rotator_session.hw_rotate_info[count].dst_roi;
+    }
+    record.rot_buffer_width = hw_rotator_session.output_buffer.width;
+    record.rot_buffer_height = hw_rotator_session.output_buffer.height;
+    record.rot_buffer_format = hw_rotator_session.output_buffer.format;
+    record.use_inline_rot = layer_config.use_inline_rot;
+
+    record.use_solidfill_stage = layer_config.use_solidfill_stage;
+    record.solidfill_z_order = layer_config.hw_solidfill_stage.z_order;
+    record.solidfill_roi = layer_config.hw_solidfill_stage.roi;
 
-  os << "\nCurrent Color Mode: " << current_color_mode_.c_str();
-  os << "\nAvailable Color Modes:\n";
-  for (auto it : color_mode_map_) {
-    os << "  " << it.first << " " << std::setw(35 - INT(it.first.length())) << it.second->id;
-    os << " ";
-    for (auto attr_it : color_mode_attr_map_[it.first]) {
-      os << std::right << " " << attr_it.first << ": " << attr_it.second;
+    for (uint32_t count = 0; count < 2; count++) {
+      HWPipeInfo &pipe = (count == 0) ? layer_config.left_pipe : layer_config.right_pipe;
+      DumpPipeRecord &pipe_record = record.pipes[count];
+      pipe_record.valid = pipe.valid;
+      pipe_record.pipe_id = pipe.pipe_id;
+      pipe_record.src_roi = pipe.src_roi;
+      pipe_record.dst_roi = pipe.dst_roi;
+      pipe_record.z_order = pipe.z_order;
+      pipe_record.flags = pipe.flags;
+      pipe_record.horizontal_decimation = pipe.horizontal_decimation;
+      pipe_record.vertical_decimation = pipe.vertical_decimation;
     }
-    os << "\n";
   }
 
-  uint32_t num_hw_layers = UINT32(disp_layer_stack_->info.hw_layers.size());
+  snapshot.left_frame_roi = layer_info.left_frame_roi;
+  snapshot.right_frame_roi = layer_info.right_frame_roi;
+  snapshot.partial_fb_roi = layer_info.partial_fb_roi;
+  snapshot.rc_mask_layer_idx = layer_info.rc_layers_info.mask_layer_idx;
+  snapshot.rc_hw_layer_idx = layer_info.rc_layers_info.rc_hw_layer_idx;
+
+  snapshot.cwb_active = cwb_active_;
+  snapshot.cwb_width = cwb_output_buf_.width;
+  snapshot.cwb_height = cwb_output_buf_.height;
+  snapshot.cwb_format = cwb_output_buf_.format;
+}
+
+void DisplayBase::DumpLayerTable(const LayerTableSnapshot &snapshot, std::ostringstream &os) {
+  uint32_t num_hw_layers = UINT32(snapshot.layers.size());
 
   if (num_hw_layers == 0) {
     os << "\nNo hardware layers programmed";
-    return os.str();
+    return;
   }
 
-  if (cwb_active_) {
-    os << "\n Output buffer res: " << cwb_output_buf_.width << "x" << cwb_output_buf_.height
-       << " format: " << GetFormatString(cwb_output_buf_.format);
+  if (snapshot.cwb_active) {
+    os << "\n Output buffer res: " << snapshot.cwb_width << "x" << snapshot.cwb_height
+       << " format: " << GetFormatString(snapshot.cwb_format);
   }
 
-  HWLayersInfo &layer_info = disp_layer_stack_->info;
-  for (uint32_t i = 0; i < layer_info.left_frame_roi.size(); i++) {
-    LayerRect &l_roi = layer_info.left_frame_roi.at(i);
-    LayerRect &r_roi = layer_info.right_frame_roi.at(i);
+  for (uint32_t i = 0; i < snapshot.left_frame_roi.size(); i++) {
+    const LayerRect &l_roi = snapshot.left_frame_roi.at(i);
 
     os << "\nROI(LTRB)#" << i << " LEFT(" << INT(l_roi.left) << " " << INT(l_roi.top) << " "
        << INT(l_roi.right) << " " << INT(l_roi.bottom) << ")";
-    if (IsValid(r_roi)) {
+    if (i < snapshot.right_frame_roi.size() && IsValid(snapshot.right_frame_roi.at(i))) {
+      const LayerRect &r_roi = snapshot.right_frame_roi.at(i);
       os << " RIGHT(" << INT(r_roi.left) << " " << INT(r_roi.top) << " " << INT(r_roi.right) << " "
          << INT(r_roi.bottom) << ")";
     }
   }
 
-  LayerRect &fb_roi = layer_info.partial_fb_roi;
+  const LayerRect &fb_roi = snapshot.partial_fb_roi;
   if (IsValid(fb_roi)) {
     os << "\nPartial FB ROI(LTRB):(" << INT(fb_roi.left) << " " << INT(fb_roi.top) << " "
        << INT(fb_roi.right) << " " << INT(fb_roi.bottom) << ")";
   }
 
-  AppendRCMaskData(os);
+  uint32_t num_mask_layers = snapshot.rc_mask_layer_idx.size();
+  uint32_t num_rc_hw_layers = snapshot.rc_hw_layer_idx.size();
+  if (num_mask_layers && rc_enable_prop_) {
+    os << "\nRC HW Mask Layer Idx: [";
+    for (uint32_t i = 0; i < num_rc_hw_layers; i++) {
+      os << snapshot.rc_hw_layer_idx.at(i);
+      if (i < (num_rc_hw_layers - 1)) {
+        os << ", ";
+      }
+    }
+    os << "] of [";
+    for (uint32_t i = 0; i < num_mask_layers; i++) {
+      os << snapshot.rc_mask_layer_idx.at(i);
+      if (i < (num_mask_layers - 1)) {
+        os << ", ";
+      }
+    }
+    os << "]";
+  }
 
   const char *header =
       "\n| Idx |   Comp Type   |   Split   | Pipe |    W x H    |          Format          |  "
@@ -2246,48 +2444,44 @@ std::string DisplayBase::Dump() {
   os << newline;
 
   for (uint32_t i = 0; i < num_hw_layers; i++) {
-    uint32_t layer_index = disp_layer_stack_->info.index.at(i);
-    // hw-layer from hw layers info
-    Layer &hw_layer = disp_layer_stack_->info.hw_layers.at(i);
-    LayerBuffer *input_buffer = &hw_layer.input_buffer;
-    HWLayerConfig &layer_config = disp_layer_stack_->info.config[i];
-    HWRotatorSession &hw_rotator_session = layer_config.hw_rotator_session;
+    const DumpLayerRecord &record = snapshot.layers.at(i);
 
-    const char *comp_type = GetCompositionName(hw_layer.composition);
-    const char *buffer_format = GetFormatString(input_buffer->format);
+    const char *comp_type = GetCompositionName(record.composition);
+    const char *buffer_format = GetFormatString(record.buffer_format);
+    uint32_t buffer_width = record.buffer_width;
+    uint32_t buffer_height = record.buffer_height;
     const char *pipe_split[2] = {"Pipe-1", "Pipe-2"};
     const char *rot_pipe[2] = {"Rot-inl-1", "Rot-inl-2"};
     char idx[8];
 
-    snprintf(idx, sizeof(idx), "%d", layer_index);
+    snprintf(idx, sizeof(idx), "%d", record.layer_index);
 
-    for (uint32_t count = 0; count < hw_rotator_session.hw_block_count; count++) {
+    for (uint32_t count = 0; count < record.rotate_count; count++) {
       char row[1024];
-      HWRotateInfo &rotate = hw_rotator_session.hw_rotate_info[count];
-      LayerRect &src_roi = rotate.src_roi;
-      LayerRect &dst_roi = rotate.dst_roi;
+      const LayerRect &src_roi = record.rotate[count].src_roi;
+      const LayerRect &dst_roi = record.rotate[count].dst_roi;
       char rot[12] = {0};
 
-      snprintf(rot, sizeof(rot), "Rot-%s-%d", layer_config.use_inline_rot ? "inl" : "off",
-               count + 1);
+      snprintf(rot, sizeof(rot), "Rot-%s-%d", record.use_inline_rot ? "inl" : "off", count + 1);
 
-      snprintf(row, sizeof(row), format, idx, comp_type, rot, 0, input_buffer->width,
-               input_buffer->height, buffer_format, INT(src_roi.left), INT(src_roi.top),
-               INT(src_roi.right), INT(src_roi.bottom), INT(dst_roi.left), INT(dst_roi.top),
-               INT(dst_roi.right), INT(dst_roi.bottom), "-", "-    ", "-    ", "-", "-", "-");
+      snprintf(row, sizeof(row), format, idx, comp_type, rot, 0, buffer_width, buffer_height,
+               buffer_format, INT(src_roi.left), INT(src_roi.top), INT(src_roi.right),
+               INT(src_roi.bottom), INT(dst_roi.left), INT(dst_roi.top), INT(dst_roi.right),
+               INT(dst_roi.bottom), "-", "-    ", "-    ", "-", "-", "-");
       os << row;
       // print the below only once per layer block, fill with spaces for rest.
       idx[0] = 0;
       comp_type = "";
     }
 
-    if (hw_rotator_session.hw_block_count > 0) {
-      input_buffer = &hw_rotator_session.output_buffer;
-      buffer_format = GetFormatString(input_buffer->format);
+    if (record.rotate_count > 0) {
+      buffer_width = record.rot_buffer_width;
+      buffer_height = record.rot_buffer_height;
+      buffer_format = GetFormatString(record.rot_buffer_format);
     }
 
-    if (layer_config.use_solidfill_stage) {
-      LayerRect src_roi = layer_config.hw_solidfill_stage.roi;
+    if (record.use_solidfill_stage) {
+      const LayerRect &src_roi = record.solidfill_roi;
       const char *decimation = "";
       char flags[16] = {0};
       char z_order[8] = {0};
@@ -2296,8 +2490,8 @@ std::string DisplayBase::Dump() {
       const char *transfer = "";
       char row[1024] = {0};
 
-      snprintf(z_order, sizeof(z_order), "%d", layer_config.hw_solidfill_stage.z_order);
-      snprintf(flags, sizeof(flags), "0x%08x", hw_layer.flags.flags);
+      snprintf(z_order, sizeof(z_order), "%d", record.solidfill_z_order);
+      snprintf(flags, sizeof(flags), "0x%08x", record.layer_flags);
       snprintf(row, sizeof(row), format, idx, comp_type, pipe_split[0], 0, INT(src_roi.right),
                INT(src_roi.bottom), buffer_format, INT(src_roi.left), INT(src_roi.top),
                INT(src_roi.right), INT(src_roi.bottom), INT(src_roi.left), INT(src_roi.top),
@@ -2314,32 +2508,31 @@ std::string DisplayBase::Dump() {
       char color_primary[8] = {0};
       char range[8] = {0};
       char transfer[8] = {0};
-      bool rot = layer_config.use_inline_rot;
+      bool rot = record.use_inline_rot;
 
-      HWPipeInfo &pipe = (count == 0) ? layer_config.left_pipe : layer_config.right_pipe;
+      const DumpPipeRecord &pipe = record.pipes[count];
 
       if (!pipe.valid) {
         continue;
       }
 
-      LayerRect src_roi = pipe.src_roi;
-      LayerRect &dst_roi = pipe.dst_roi;
+      const LayerRect &src_roi = pipe.src_roi;
+      const LayerRect &dst_roi = pipe.dst_roi;
 
       snprintf(z_order, sizeof(z_order), "%d", pipe.z_order);
       snprintf(flags, sizeof(flags), "0x%08x", pipe.flags);
       snprintf(decimation, sizeof(decimation), "%3d x %3d", pipe.horizontal_decimation,
                pipe.vertical_decimation);
-      ColorMetaData &color_metadata = hw_layer.input_buffer.color_metadata;
-      snprintf(color_primary, sizeof(color_primary), "%d", color_metadata.colorPrimaries);
-      snprintf(range, sizeof(range), "%d", color_metadata.range);
-      snprintf(transfer, sizeof(transfer), "%d", color_metadata.transfer);
+      snprintf(color_primary, sizeof(color_primary), "%d", record.color_primaries);
+      snprintf(range, sizeof(range), "%d", record.color_range);
+      snprintf(transfer, sizeof(transfer), "%d", record.color_transfer);
 
       char row[1024];
       snprintf(row, sizeof(row), format, idx, comp_type, rot ? rot_pipe[count] : pipe_split[count],
-               pipe.pipe_id, input_buffer->width, input_buffer->height, buffer_format,
-               INT(src_roi.left), INT(src_roi.top), INT(src_roi.right), INT(src_roi.bottom),
-               INT(dst_roi.left), INT(dst_roi.top), INT(dst_roi.right), INT(dst_roi.bottom),
-               z_order, flags, decimation, color_primary, range, transfer);
+               pipe.pipe_id, buffer_width, buffer_height, buffer_format, INT(src_roi.left),
+               INT(src_roi.top), INT(src_roi.right), INT(src_roi.bottom), INT(dst_roi.left),
+               INT(dst_roi.top), INT(dst_roi.right), INT(dst_roi.bottom), z_order, flags,
+               decimation, color_primary, range, transfer);
 
       os << row;
       // print the below only once per layer block, fill with spaces for rest.
@@ -2349,10 +2542,98 @@ std::string DisplayBase::Dump() {
   }
 
   os << newline << "\n";
+}
+
+std::string DisplayBase::Dump() {
+  std::ostringstream os;
+  LayerTableSnapshot snapshot;
+
+  // Format only the short attribute header under the lock; the layer table is formatted from
+  // the commit-time snapshot after the lock is dropped, so a dumpsys racing with composition
+  // cannot delay the next frame.
+  {
+    ClientLock lock(disp_mutex_);
+    DumpDisplayAttributes(os);
+    snapshot = dump_snapshot_;
+  }
+
+  DumpLayerTable(snapshot, os);
 
   return os.str();
 }
 
+void DisplayBase::DumpDisplayAttributes(std::ostringstream &os) {
+  HWDisplayAttributes attrib;
+  uint32_t active_index = 0;
+  uint32_t num_modes = 0;
+
+  hw_intf_->GetNumDisplayAttributes(&num_modes);
+  hw_intf_->GetActiveConfig(&active_index);
+  hw_intf_->GetDisplayAttributes(active_index, &attrib);
+
+  os << "device type:" << display_type_;
+  os << " DrawMethod: " << draw_method_;
+  if (retire_fence_offset_ > 1) {
+    os << " QueueDepth: " << (retire_fence_offset_ + 1)
+       << " busy commits: " << deep_queue_busy_commits_;
+  }
+  os << "\nstate: " << state_ << " vsync on: " << vsync_enable_
+     << " max. mixer stages: " << max_mixer_stages_;
+  if (disp_layer_stack_->info.noise_layer_info.enable) {
+    os << "\nNoise z-orders: [" << disp_layer_stack_->info.noise_layer_info.zpos_noise << ","
+       << disp_layer_stack_->info.noise_layer_info.zpos_attn << "]";
+  }
+  os << "\nnum configs: " << num_modes << " active config index: " << active_index;
+  os << "\nDisplay Attributes:";
+  os << "\n Mode:" << (hw_panel_info_.mode == kModeVideo ? "Video" : "Command");
+  os << std::boolalpha;
+  os << " Primary:" << hw_panel_info_.is_primary_panel;
+  os << " DynFPS:" << hw_panel_info_.dynamic_fps;
+  os << "\n HDR Panel:" << hw_panel_info_.hdr_enabled;
+  os << " QSync:" << hw_panel_info_.qsync_support;
+  os << " DynBitclk:" << hw_panel_info_.dyn_bitclk_support;
+  os << "\n Left Split:" << hw_panel_info_.split_info.left_split
+     << " Right Split:" << hw_panel_info_.split_info.right_split;
+  os << "\n PartialUpdate:" << hw_panel_info_.partial_update;
+  if (hw_panel_info_.partial_update) {
+    os << "\n ROI Min w:" << hw_panel_info_.min_roi_width;
+    os << " Min h:" << hw_panel_info_.min_roi_height;
+    os << " NeedsMerge: " << hw_panel_info_.needs_roi_merge;
+    os << " Alignment: l:" << hw_panel_info_.left_align << " w:" << hw_panel_info_.width_align;
+    os << " t:" << hw_panel_info_.top_align << " b:" << hw_panel_info_.height_align;
+  }
+  os << "\n FPS min:" << hw_panel_info_.min_fps << " max:" << hw_panel_info_.max_fps
+     << " cur:" << display_attributes_.fps;
+  os << " TransferTime: " << hw_panel_info_.transfer_time_us << "us";
+  os << " Min TransferTime: " << hw_panel_info_.transfer_time_us_min << "us";
+  os << " Max TransferTime: " << hw_panel_info_.transfer_time_us_max << "us";
+  os << " MaxBrightness:" << hw_panel_info_.panel_max_brightness;
+  os << "\n Display WxH: " << display_attributes_.x_pixels << "x" << display_attributes_.y_pixels;
+  os << " MixerWxH: " << mixer_attributes_.width << "x" << mixer_attributes_.height;
+  os << " DPI: " << display_attributes_.x_dpi << "x" << display_attributes_.y_dpi;
+  os << " LM_Split: " << display_attributes_.is_device_split;
+  os << "\n vsync_period " << display_attributes_.vsync_period_ns;
+  os << " v_back_porch: " << display_attributes_.v_back_porch;
+  os << " v_front_porch: " << display_attributes_.v_front_porch;
+  os << " v_pulse_width: " << display_attributes_.v_pulse_width;
+  os << "\n v_total: " << display_attributes_.v_total;
+  os << " h_total: " << display_attributes_.h_total;
+  os << " clk: " << display_attributes_.clock_khz;
+  os << " Topology: " << display_attributes_.topology;
+  os << std::noboolalpha;
+
+  os << "\nCurrent Color Mode: " << current_color_mode_.c_str();
+  os << "\nAvailable Color Modes:\n";
+  for (auto it : color_mode_map_) {
+    os << "  " << it.first << " " << std::setw(35 - INT(it.first.length())) << it.second->id;
+    os << " ";
+    for (auto attr_it : color_mode_attr_map_[it.first]) {
+      os << std::right << " " << attr_it.first << ": " << attr_it.second;
+    }
+    os << "\n";
+  }
+}
+
 DisplayError DisplayBase::ColorSVCRequestRoute(const PPDisplayAPIPayload &in_payload,
                                                PPDisplayAPIPayload *out_payload,
                                                PPPendingParams *pending_action) {
@@ -2988,7 +3269,36 @@ DisplayError DisplayBase::ReconfigureMixer(uint32_t width, uint32_t height) {
     return error;
   }
 
-  return ReconfigureDisplay();
+  // A successful SetMixerAttributes() means the change is absorbed entirely by destination
+  // scaler programming in the next frame commit; the panel mode is untouched. Reconfigure
+  // composition against the cached display state directly instead of going through
+  // ReconfigureDisplay(), which re-reads and re-compares the full display/panel state on a
+  // path that runs per-frame under dynamic resolution.
+  HWMixerAttributes new_mixer_attributes;
+  error = hw_intf_->GetMixerAttributes(&new_mixer_attributes);
+  if (error != kErrorNone) {
+    return error;
+  }
+
+  error = comp_manager_->ReconfigureDisplay(display_comp_ctx_, display_attributes_, hw_panel_info_,
+                                            new_mixer_attributes, fb_config_, &cached_qos_data_);
+  if (error != kErrorNone) {
+    return error;
+  }
+  default_clock_hz_ = cached_qos_data_.clock_hz;
+
+  mixer_attributes_ = new_mixer_attributes;
+
+  // The whole output is rescaled when the LM geometry moves; the first frame after the switch
+  // must be a full frame.
+  DisablePartialUpdateOneFrameInternal();
+  SetPUonDestScaler();
+  if (hw_panel_info_.partial_update && !disable_pu_on_dest_scaler_) {
+    // Queue a pending PU request so the first PU enable frame after the switch can serve it.
+    pu_pending_ = true;
+  }
+
+  return kErrorNone;
 }
 
 bool DisplayBase::NeedsDownScale(const LayerRect &src_rect, const LayerRect &dst_rect,
@@ -3031,10 +3341,10 @@ bool DisplayBase::NeedsMixerReconfiguration(LayerStack *layer_stack, uint32_t *n
 
   // Resize mixer attributes to fb config when client requests CWB at LM tap-point
   // TODO(user): remove below check when clients request buffer with mixer resolution
-  if (force_lm_to_fb_config_ || (hw_resource_info_.has_concurrent_writeback &&
+  if (force_lm_to_fb_config_ || (hw_resource_info_->has_concurrent_writeback &&
                                  layer_stack->output_buffer && valid_lm_tappoint)) {
     DLOGV_IF(kTagDisplay, "CWB:%d, force_lm_to_fb_config_:%d, configure LM width:%d height:%d",
-             (hw_resource_info_.has_concurrent_writeback && layer_stack->output_buffer),
+             (hw_resource_info_->has_concurrent_writeback && layer_stack->output_buffer),
              force_lm_to_fb_config_, fb_width, fb_height);
     *new_mixer_width = fb_width;
     *new_mixer_height = fb_height;
@@ -3333,7 +3643,8 @@ void DisplayBase::UpdateFrameBuffer() {
 }
 
 void DisplayBase::PostCommitLayerParams() {
-  cached_qos_data_ = disp_layer_stack_->info.qos_data;
+  cached_qos_data_ = commit_stack_->info.qos_data;
+  CaptureDumpSnapshot();
 }
 
 DisplayError DisplayBase::InitializeColorModes() {
@@ -3385,7 +3696,7 @@ DisplayError DisplayBase::InitializeColorModes() {
           color_mode_attr_map_.insert(std::make_pair(color_modes_[i].name, var));
           // If target doesn't support SSPP tone maping and color mode is HDR,
           // add bt2020pq and bt2020hlg color modes.
-          if (hw_resource_info_.src_tone_map.none() && IsHdrMode(var)) {
+          if (hw_resource_info_->src_tone_map.none() && IsHdrMode(var)) {
             std::string str_render_intent;
             GetValueOfModeAttribute(var, kRenderIntentAttribute, &str_render_intent);
             color_mode_map_.insert(std::make_pair(kBt2020Pq, &color_modes_[i]));
@@ -3452,7 +3763,7 @@ DisplayError DisplayBase::GetClientTargetSupport(uint32_t width, uint32_t height
 }
 
 bool DisplayBase::IsSupportSsppTonemap() {
-  if (hw_resource_info_.src_tone_map.none()) {
+  if (hw_resource_info_->src_tone_map.none()) {
     return false;
   } else {
     return true;
@@ -3463,8 +3774,8 @@ DisplayError DisplayBase::ValidateScaling(uint32_t width, uint32_t height) {
   uint32_t display_width = display_attributes_.x_pixels;
   uint32_t display_height = display_attributes_.y_pixels;
 
-  float max_scale_down = FLOAT(hw_resource_info_.max_scale_down);
-  float max_scale_up = FLOAT(hw_resource_info_.max_scale_up);
+  float max_scale_down = FLOAT(hw_resource_info_->max_scale_down);
+  float max_scale_up = FLOAT(hw_resource_info_->max_scale_up);
 
   float scale_x = FLOAT(width / display_width);
   float scale_y = FLOAT(height / display_height);
@@ -3680,7 +3991,7 @@ void DisplayBase::EndDisplayPowerReset() {
 }
 
 bool DisplayBase::SetHdrModeAtStart(LayerStack *layer_stack) {
-  return (hw_resource_info_.src_tone_map.none() && layer_stack->flags.hdr_present);
+  return (hw_resource_info_->src_tone_map.none() && layer_stack->flags.hdr_present);
 }
 
 PrimariesTransfer DisplayBase::GetBlendSpaceFromColorMode() {
@@ -3709,7 +4020,7 @@ PrimariesTransfer DisplayBase::GetBlendSpaceFromColorMode() {
     }
   }
   // TODO(user): Check is if someone calls with hal_display_p3
-  if (hw_resource_info_.src_tone_map.none() &&
+  if (hw_resource_info_->src_tone_map.none() &&
       (pic_quality == kStandard && color_gamut == kBt2020)) {
     pt.primaries = GetColorPrimariesFromAttribute(color_gamut, allow_tonemap_native_);
     if (transfer == kHlg) {
@@ -3847,7 +4158,7 @@ DisplayError DisplayBase::IsSupportedOnDisplay(const SupportedDisplayFeature fea
       *supported = custom_mixer_resolution_;
       break;
     case kCwbDemuraTapPoint: {
-      std::vector<CwbTapPoint> &tappoints = hw_resource_info_.tap_points;
+      const std::vector<CwbTapPoint> &tappoints = hw_resource_info_->tap_points;
       *supported = UINT32(std::find(tappoints.begin(), tappoints.end(),
                                     CwbTapPoint::kDemuraTapPoint) != tappoints.end());
       break;
@@ -4022,7 +4333,7 @@ void DisplayBase::CheckMMRMState() {
   DTRACE_SCOPED();
   DLOGI("Handling updated MMRM request");
   mmrm_updated_ = false;
-  bool reduced_clk = (mmrm_requested_clk_ < hw_resource_info_.max_sde_clk) ? true : false;
+  bool reduced_clk = (mmrm_requested_clk_ < hw_resource_info_->max_sde_clk) ? true : false;
 
   // Check layers if clock is less than max
   LayerStack *stack = disp_layer_stack_->stack;
@@ -4109,6 +4420,13 @@ void DisplayBase::Abort() {
 }
 
 void DisplayBase::CacheRetireFence() {
+  if (retire_fence_offset_ > 1 && retire_fence_ &&
+      Fence::GetStatus(retire_fence_) == Fence::Status::kPending) {
+    // The previous frame is still in flight at commit time - the deep queue just absorbed
+    // what would otherwise have been a dropped frame.
+    deep_queue_busy_commits_++;
+  }
+
   if (draw_method_ == kDrawDefault) {
     retire_fence_ = disp_layer_stack_->info.retire_fence;
   } else {
@@ -4253,6 +4571,16 @@ DisplayError DisplayBase::GetPanelBlMaxLvl(uint32_t *max_level) {
   return err;
 }
 
+DisplayError DisplayBase::GetCommitTimingStats(CommitTimingStats *stats) {
+  if (!stats) {
+    return kErrorParameters;
+  }
+
+  // HWDeviceDRM keeps the stats behind its own lock; skip disp_mutex_ so schedulers can poll
+  // the margin without serializing against an in-flight commit.
+  return hw_intf_->GetCommitTimingStats(stats);
+}
+
 DisplayError DisplayBase::SetPPConfig(void *payload, size_t size) {
   DTRACE_SCOPED();
   {
@@ -4348,6 +4676,20 @@ DisplayError DisplayBase::GetPanelFeatureInfo(PanelFeatureInfo *info) {
   return kErrorNone;
 }
 
+void DisplayBase::AdvanceDispLayerStack() {
+  DTRACE_SCOPED();
+  if (first_cycle_) {
+    return;
+  }
+  // Pipelined variant of ResetDispLayerStack. The slot being switched to is recycled here,
+  // under the client lock, instead of in PostCommit on the commit thread; the commit thread
+  // keeps using commit_stack_ so the switch is safe while a commit is in flight.
+  disp_stack_index_ = (disp_stack_index_ + 1) % kDispStackCount;
+  disp_layer_stack_ = &disp_layer_stacks_[disp_stack_index_];
+  disp_layer_stack_->Reset();
+  comp_manager_->SetDisplayLayerStack(display_comp_ctx_, disp_layer_stack_);
+}
+
 void DisplayBase::PrepareForAsyncTransition() {
   // Caution:
   // Structures which are owned by caller or main thread must not be referenced by async execution.
@@ -4460,7 +4802,7 @@ DisplayError DisplayBase::ValidateCwbRoiWithOutputBuffer(const LayerBuffer &outp
 DisplayError DisplayBase::CaptureCwb(const LayerBuffer &output_buffer, const CwbConfig &config) {
   ClientLock lock(disp_mutex_);
 
-  if (!hw_resource_info_.has_concurrent_writeback) {
+  if (!hw_resource_info_->has_concurrent_writeback) {
     return kErrorNotSupported;
   }
 
@@ -4523,7 +4865,7 @@ DisplayError DisplayBase::CaptureCwb(const LayerBuffer &output_buffer, const Cwb
 }
 
 bool DisplayBase::HandleCwbTeardown() {
-  if (!hw_resource_info_.has_concurrent_writeback) {
+  if (!hw_resource_info_->has_concurrent_writeback) {
     return false;
   }
 
@@ -4556,10 +4898,19 @@ void DisplayBase::ResetDispLayerStack() {
     clearstack_.store(true);
   } else {
     DLOGW("Stack did not clear in PostCommit. Clear now.");
-    *disp_layer_stack_ = DispLayerStack();
+    disp_layer_stack_->Reset();
   }
 }
 
+DisplayError DisplayBase::ProcessThermalEvent(int64_t thermal_level) {
+  ClientLock lock(disp_mutex_);
+  DLOGI("Thermal level %d for display %d-%d", INT(thermal_level), display_id_, display_type_);
+  comp_manager_->ProcessThermalEvent(display_comp_ctx_, thermal_level);
+  event_handler_->Refresh();
+
+  return kErrorNone;
+}
+
 DisplayError DisplayBase::DisableDestinationScalar() {
   DisplayError err = ReconfigureMixer(display_attributes_.x_pixels, display_attributes_.y_pixels);
   if (err != kErrorNone) {
@@ -47,6 +47,7 @@
 
 #include <limits.h>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <condition_variable>  // NOLINT
@@ -101,6 +102,8 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   virtual DisplayError SetDisplayState(DisplayState state, bool teardown,
                                        shared_ptr<Fence> *release_fence);
   virtual DisplayError SetActiveConfig(uint32_t index);
+  virtual DisplayError PrefetchActiveConfig(uint32_t index);
+  virtual DisplayError SetCommitQueueDepth(uint32_t depth);
   virtual DisplayError SetActiveConfig(DisplayConfigVariableInfo *variable_info) {
     return kErrorNotSupported;
   }
@@ -189,7 +192,6 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
     return kErrorNotSupported;
   }
   virtual DisplayError SetQSyncMode(QSyncMode qsync_mode) { return kErrorNotSupported; }
-  virtual void AppendRCMaskData(std::ostringstream &os);
   virtual std::string Dump();
   virtual DisplayError InitializeColorModes();
   virtual DisplayError ControlIdlePowerCollapse(bool enable, bool synchronous) {
@@ -245,6 +247,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
     return kErrorNone;
   }
   virtual DisplayError GetQsyncFps(uint32_t *qsync_fps) { return kErrorNotSupported; }
+  virtual DisplayError GetCommitTimingStats(CommitTimingStats *stats);
   virtual void FlushConcurrentWriteback();
   virtual DisplayError SetAlternateDisplayConfig(uint32_t *alt_config) {
     return kErrorNotSupported;
@@ -260,6 +263,8 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   virtual DisplayError SetDemuraState(int state) { return kErrorNotSupported; }
   virtual DisplayError SetDemuraConfig(int demura_idx) { return kErrorNotSupported; }
   virtual void ResetDispLayerStack();
+  virtual DisplayError TriggerIdleFlattening() { return kErrorNotSupported; }
+  virtual DisplayError ProcessThermalEvent(int64_t thermal_level);
   virtual DisplayError PanelOprInfo(const std::string &client_name, bool enable,
                                     SdmDisplayCbInterface<PanelOprPayload> *cb_intf) {
     return kErrorNotSupported;
@@ -277,8 +282,14 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
 
   class ClientLock {
    public:
-    explicit ClientLock(DisplayMutex &disp_mutex) : disp_mutex_(disp_mutex) {
+    explicit ClientLock(DisplayMutex &disp_mutex, bool allow_worker_overlap = false)
+        : disp_mutex_(disp_mutex), worker_overlap_(allow_worker_overlap) {
       disp_mutex_.client_mutex.lock();
+      if (worker_overlap_) {
+        // Pipelined prepare: serialize only against other client calls and let an in-flight
+        // async commit keep running. Caller must not touch the stack being committed.
+        return;
+      }
       disp_mutex_.worker_mutex.lock();
       while (disp_mutex_.worker_busy) {
         disp_mutex_.worker_cv.wait(disp_mutex_.worker_mutex);
@@ -286,7 +297,9 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
     }
 
     ~ClientLock() {
-      disp_mutex_.worker_mutex.unlock();
+      if (!worker_overlap_) {
+        disp_mutex_.worker_mutex.unlock();
+      }
       disp_mutex_.client_mutex.unlock();
     }
 
@@ -297,15 +310,74 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
 
    private:
     DisplayMutex &disp_mutex_;
+    bool worker_overlap_ = false;
   };
 
   const char *kBt2020Pq = "bt2020_pq";
   const char *kBt2020Hlg = "bt2020_hlg";
   const char *kDisplayBt2020 = "display_bt2020";
+
+  // Compact mirror of the per-frame state Dump() formats into the layer table. Refreshed with
+  // flat copies at commit while the display lock is already held; Dump() copies it out and
+  // formats the multi-KB table without the lock, so dumpsys does not perturb frame timing.
+  struct DumpPipeRecord {
+    bool valid = false;
+    uint32_t pipe_id = 0;
+    LayerRect src_roi = {};
+    LayerRect dst_roi = {};
+    uint32_t z_order = 0;
+    uint32_t flags = 0;
+    uint8_t horizontal_decimation = 0;
+    uint8_t vertical_decimation = 0;
+  };
+
+  struct DumpRotateRecord {
+    LayerRect src_roi = {};
+    LayerRect dst_roi = {};
+  };
+
+  struct DumpLayerRecord {
+    uint32_t layer_index = 0;
+    LayerComposition composition = kCompositionGPU;
+    uint32_t buffer_width = 0;
+    uint32_t buffer_height = 0;
+    LayerBufferFormat buffer_format = kFormatARGB8888;
+    uint32_t layer_flags = 0;
+    uint32_t color_primaries = 0;
+    uint32_t color_range = 0;
+    uint32_t color_transfer = 0;
+    uint32_t rotate_count = 0;
+    DumpRotateRecord rotate[kMaxRotatePerLayer] = {};
+    uint32_t rot_buffer_width = 0;
+    uint32_t rot_buffer_height = 0;
+    LayerBufferFormat rot_buffer_format = kFormatARGB8888;
+    bool use_inline_rot = false;
+    bool use_solidfill_stage = false;
+    uint32_t solidfill_z_order = 0;
+    LayerRect solidfill_roi = {};
+    DumpPipeRecord pipes[2] = {};
+  };
+
+  struct LayerTableSnapshot {
+    std::vector<DumpLayerRecord> layers = {};
+    std::vector<LayerRect> left_frame_roi = {};
+    std::vector<LayerRect> right_frame_roi = {};
+    LayerRect partial_fb_roi = {};
+    std::vector<uint32_t> rc_mask_layer_idx = {};
+    std::vector<uint32_t> rc_hw_layer_idx = {};
+    bool cwb_active = false;
+    uint32_t cwb_width = 0;
+    uint32_t cwb_height = 0;
+    LayerBufferFormat cwb_format = kFormatARGB8888;
+  };
+
   virtual DisplayError BuildLayerStackStats(LayerStack *layer_stack);
   virtual DisplayError ValidateGPUTargetParams();
   void CommitLayerParams(LayerStack *layer_stack);
   void PostCommitLayerParams();
+  void CaptureDumpSnapshot();
+  void DumpDisplayAttributes(std::ostringstream &os);
+  void DumpLayerTable(const LayerTableSnapshot &snapshot, std::ostringstream &os);
   DisplayError ValidateScaling(uint32_t width, uint32_t height);
   DisplayError ValidateDataspace(const ColorMetaData &color_metadata);
   void HwRecovery(const HWRecoveryEvent sdm_event_code);
@@ -343,6 +415,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   DisplayError SetVSyncStateLocked(bool enable);
   virtual DisplayError SetUpCommit(LayerStack *layer_stack);
   DisplayError PerformCommit(HWLayersInfo *hw_layers_info);
+  void ApplyDozeQosFloor(HWLayersInfo *hw_layers_info);
   virtual DisplayError PostCommit(HWLayersInfo *hw_layers_info);
   bool IsPrimaryDisplayLocked();
   virtual DisplayError CommitLocked(LayerStack *layer_stack);
@@ -352,6 +425,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   DisplayError NoiseInit();
   DisplayError HandleNoiseLayer(LayerStack *layer_stack);
   void PrepareForAsyncTransition();
+  void AdvanceDispLayerStack();
   virtual void IdleTimeout() {}
   std::chrono::system_clock::time_point WaitUntil();
   virtual void Abort();
@@ -365,7 +439,8 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   HWDeviceType hw_device_type_;
   HWInterface *hw_intf_ = NULL;
   HWPanelInfo hw_panel_info_;
-  HWResourceInfo hw_resource_info_ = {};
+  // Shared immutable capability snapshot; refreshed from HWInfoInterface, never copied.
+  std::shared_ptr<const HWResourceInfo> hw_resource_info_ = std::make_shared<HWResourceInfo>();
   BufferAllocator *buffer_allocator_ {};
   CompManager *comp_manager_ = NULL;
   DisplayState state_ = kStateOff;
@@ -377,6 +452,12 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   DispLayerStack disp_layer_stacks_[kDispStackCount];
   std::atomic<bool> clearstack_;
   uint8_t disp_stack_index_ = 0;
+  // Stack captured in SetUpCommit for the frame being committed. In pipelined draw,
+  // disp_layer_stack_ may already point at the next cycle's stack while the commit thread
+  // is still working on this one.
+  DispLayerStack *commit_stack_ = nullptr;
+  bool pipelined_prepare_ = false;
+  bool pipelined_stack_advanced_ = false;
   bool needs_validate_ = true;  // maintains validation state between Prepare/Commit Cycle
   bool vsync_enable_ = false;
   uint32_t max_mixer_stages_ = 0;
@@ -390,6 +471,10 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   bool disable_pu_on_dest_scaler_ = false;
   bool de_enabled_ = false;
   bool pu_pending_ = false;
+  // Direct-scanout fast path: geometry fingerprint of the last fullscreen
+  // single-layer frame and how many consecutive frames matched it.
+  uint64_t direct_scanout_hash_ = 0;
+  uint32_t direct_scanout_streak_ = 0;
   uint32_t num_color_modes_ = 0;
   std::vector<SDEDisplayMode> color_modes_;
   typedef std::map<std::string, SDEDisplayMode *> ColorModeMap;
@@ -413,6 +498,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   uint32_t current_refresh_rate_ = 0;
   bool drop_skewed_vsync_ = false;
   bool disable_llcc_during_aod_ = false;
+  bool enable_doze_qos_floor_ = false;
   bool custom_mixer_resolution_ = false;
   bool vsync_enable_pending_ = false;
   HWPowerState pending_power_state_ = kPowerStateNone;
@@ -454,6 +540,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   bool avoid_qsync_mode_change_ = false;
   LayerBuffer cwb_output_buf_ = {};
   bool cwb_active_ = false;
+  LayerTableSnapshot dump_snapshot_ = {};  // Last committed frame, for lock-free dump formatting
   DynLib extension_lib_;
 
  private:
@@ -478,6 +565,7 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   void UpdateFrameBuffer();
   void CleanupOnError();
   bool IsValidateNeeded();
+  bool IsDirectScanoutFrame(LayerStack *layer_stack);
   DisplayError InitBorderLayers();
   std::vector<LayerRect> GetBorderRects();
   void GenerateBorderLayers(const std::vector<LayerRect> &border_rects);
@@ -498,6 +586,11 @@ class DisplayBase : public DisplayInterface, public CompManagerEventHandler {
   bool transition_done_ = false;
   bool gpu_comp_frame_ = false;
   uint32_t retire_fence_offset_ = 0;
+  // Deep commit queue state: offsets beyond 1 are opt-in through SetCommitQueueDepth().
+  // busy_commits counts commits issued while the previously cached retire fence was still
+  // pending, i.e. frames where the extra queue slot absorbed a CPU spike.
+  static const uint32_t kMaxCommitQueueDepth = 3;
+  uint32_t deep_queue_busy_commits_ = 0;
   std::mutex power_mutex_;
   std::condition_variable cv_;
   LayerBuffer cached_framebuffer_ = {};
@@ -41,6 +41,7 @@
 #include <private/hw_info_interface.h>
 #include <iomanip>
 #include <algorithm>
+#include <chrono>
 #include <functional>
 #include <map>
 #include <string>
@@ -170,7 +171,15 @@ DisplayError DisplayBuiltIn::Init() {
       return error;
     }
 
-    SetupDemuraT0AndTn();
+    // Demura setup streams large calibration assets into the HFC buffer. The
+    // primary panel must be corrected from its first frame, but deferring
+    // secondary panels past their first commit keeps LUT loads off the boot
+    // critical path.
+    if (IsPrimaryDisplay()) {
+      SetupDemuraT0AndTn();
+    } else {
+      defer_demura_setup_ = true;
+    }
   } else {
     DLOGW("Skipping Panel Feature Setups!");
   }
@@ -194,6 +203,14 @@ DisplayError DisplayBuiltIn::Init() {
   DebugHandler::Get()->GetProperty(ENHANCE_IDLE_TIME, &value);
   enhance_idle_time_ = (value == 1);
 
+  value = 0;
+  DebugHandler::Get()->GetProperty(ENABLE_ADAPTIVE_IDLE_TIMEOUT, &value);
+  adaptive_idle_timeout_ = (value == 1);
+
+  value = 0;
+  DebugHandler::Get()->GetProperty(ENABLE_VIDEO_CADENCE_LOCK, &value);
+  enable_cadence_lock_ = (value == 1);
+
   value = 0;
   DebugHandler::Get()->GetProperty(ENABLE_DPPS_DYNAMIC_FPS, &value);
   enable_dpps_dyn_fps_ = (value == 1);
@@ -718,6 +735,112 @@ void DisplayBuiltIn::PreCommit(LayerStack *layer_stack) {
   if (histogramSetup) {
     SetDppsFeatureLocked(&histogramIRQ, sizeof(histogramIRQ));
   }
+
+  if (enable_cadence_lock_) {
+    ApplyVideoCadenceLock(layer_stack);
+  }
+}
+
+void DisplayBuiltIn::ApplyVideoCadenceLock(LayerStack *layer_stack) {
+  uint64_t ept = layer_stack->expected_present_time;
+  uint64_t vsync_ns = display_attributes_.vsync_period_ns;
+  uint64_t half_vsync_ns = vsync_ns / 2;
+  if (!ept || !half_vsync_ns) {
+    // No client timestamp on this frame (UI update, first frame after power cycle).
+    if (cadence_locked_) {
+      cadence_breaks_++;
+      cadence_locked_ = false;
+    }
+    cadence_stable_frames_ = 0;
+    cadence_units_prev_ = 0;
+    cadence_units_prev2_ = 0;
+    cadence_last_raw_ept_ = 0;
+    cadence_output_ept_ = 0;
+    return;
+  }
+
+  if (ept == cadence_last_raw_ept_) {
+    // PreCommit runs in both the prepare and the commit stage for the same frame;
+    // re-issue the decision taken on first sight instead of treating it as a new sample.
+    if (cadence_output_ept_) {
+      layer_stack->expected_present_time = cadence_output_ept_;
+      disp_layer_stack_->info.expected_present_time = cadence_output_ept_;
+    }
+    return;
+  }
+
+  uint64_t prev_ept = cadence_last_raw_ept_;
+  cadence_last_raw_ept_ = ept;
+  cadence_output_ept_ = 0;
+
+  if (!prev_ept || ept <= prev_ept) {
+    if (cadence_locked_) {
+      cadence_breaks_++;
+      cadence_locked_ = false;
+    }
+    cadence_stable_frames_ = 0;
+    cadence_units_prev_ = 0;
+    cadence_units_prev2_ = 0;
+    return;
+  }
+
+  // Frame deltas are classified in half-vsync units: 3:2 content on a 60 Hz panel alternates
+  // 4 and 6 units, 2:2 content holds a constant count, so both repeat with period two.
+  uint32_t units = UINT32((ept - prev_ept + half_vsync_ns / 2) / half_vsync_ns);
+
+  if (cadence_locked_) {
+    uint64_t ideal = cadence_ideal_ept_;
+    uint64_t deviation = (ept > ideal) ? (ept - ideal) : (ideal - ept);
+    if (deviation >= vsync_ns) {
+      // The source left the cadence (seek, fps change, interaction). Unlock and relearn.
+      DLOGV_IF(kTagDisplay, "Cadence break on display %d-%d: deviation %" PRIu64 " ns",
+               display_id_, display_type_, deviation);
+      cadence_breaks_++;
+      cadence_locked_ = false;
+      cadence_stable_frames_ = 0;
+      cadence_units_prev_ = 0;
+      cadence_units_prev2_ = 0;
+      return;
+    }
+    if (deviation) {
+      cadence_snapped_frames_++;
+    }
+    layer_stack->expected_present_time = ideal;
+    disp_layer_stack_->info.expected_present_time = ideal;
+    cadence_output_ept_ = ideal;
+    // Advance the grid, slewing it gently toward the client timestamps so nominal
+    // vsync-period error cannot accumulate into a false break.
+    int64_t drift = static_cast<int64_t>(ept) - static_cast<int64_t>(ideal);
+    cadence_ideal_ept_ = UINT64(static_cast<int64_t>(ideal + cadence_step_ns_) + drift / 8);
+    return;
+  }
+
+  // Learning: anything faster than the panel or slower than ~10 fps is not fixed-cadence video.
+  if (units < 2 || units > 12) {
+    cadence_stable_frames_ = 0;
+    cadence_units_prev_ = 0;
+    cadence_units_prev2_ = 0;
+    return;
+  }
+  if (cadence_units_prev2_ && units != cadence_units_prev2_) {
+    cadence_stable_frames_ = 0;
+  } else {
+    cadence_stable_frames_++;
+  }
+  cadence_units_prev2_ = cadence_units_prev_;
+  cadence_units_prev_ = units;
+  if (cadence_stable_frames_ < kCadenceLockFrames || !cadence_units_prev2_) {
+    return;
+  }
+
+  // Lock: the content interval is half the two-frame cycle, e.g. 24 fps on 60 Hz alternates
+  // 2 and 3 vsyncs and the step comes out at 2.5 vsync periods.
+  cadence_step_ns_ = (UINT64(cadence_units_prev_ + cadence_units_prev2_) * half_vsync_ns) / 2;
+  cadence_ideal_ept_ = ept + cadence_step_ns_;
+  cadence_locked_ = true;
+  cadence_locks_++;
+  DLOGV_IF(kTagDisplay, "Video cadence locked on display %d-%d: step %" PRIu64 " ns",
+           display_id_, display_type_, cadence_step_ns_);
 }
 
 DisplayError DisplayBuiltIn::SetupDemuraT0AndTn() {
@@ -1025,10 +1148,19 @@ DisplayError DisplayBuiltIn::PostCommit(HWLayersInfo *hw_layers_info) {
     deferred_config_.Clear();
   }
 
+  struct timespec prev_commit = idle_timer_start_;
   clock_gettime(CLOCK_MONOTONIC, &idle_timer_start_);
-  int idle_time_ms = disp_layer_stack_->info.set_idle_time_ms;
+  if (adaptive_idle_timeout_) {
+    UpdateFrameGapStats(prev_commit, idle_timer_start_);
+  }
+
+  int idle_time_ms = hw_layers_info->set_idle_time_ms;
   if (idle_time_ms >= 0) {
-    hw_intf_->SetIdleTimeoutMs(UINT32(idle_time_ms));
+    uint32_t timeout_ms = UINT32(idle_time_ms);
+    if (adaptive_idle_timeout_ && timeout_ms) {
+      timeout_ms = AdaptIdleTimeoutMs(timeout_ms);
+    }
+    hw_intf_->SetIdleTimeoutMs(timeout_ms);
     idle_time_ms_ = idle_time_ms;
   }
 
@@ -1048,6 +1180,11 @@ DisplayError DisplayBuiltIn::PostCommit(HWLayersInfo *hw_layers_info) {
   }
   dpps_info_.Init(this, hw_panel_info_.panel_name, this);
 
+  if (defer_demura_setup_) {
+    defer_demura_setup_ = false;
+    SetupDemuraT0AndTn();
+  }
+
   if (demuratn_)
     EnableDemuraTn(true);
 
@@ -1064,6 +1201,104 @@ DisplayError DisplayBuiltIn::PostCommit(HWLayersInfo *hw_layers_info) {
   return kErrorNone;
 }
 
+void DisplayBuiltIn::UpdateFrameGapStats(const struct timespec &prev_commit,
+                                         const struct timespec &curr_commit) {
+  if (!prev_commit.tv_sec && !prev_commit.tv_nsec) {
+    return;
+  }
+
+  int64_t gap_ms = (curr_commit.tv_sec - prev_commit.tv_sec) * 1000 +
+                   (curr_commit.tv_nsec - prev_commit.tv_nsec) / 1000000;
+  if (gap_ms < 0) {
+    return;
+  }
+  // Gaps beyond a few seconds carry no cadence information; treat them as a
+  // fresh burst instead of polluting the averages. A gap this long also means the last quiet
+  // period ran deep, which is evidence this context stays idle once it goes idle.
+  if (gap_ms > kMaxTrackedFrameGapMs) {
+    idle_long_dwell_score_ = std::min(idle_long_dwell_score_ + 1, 2 * kLongDwellConfidence);
+    avg_frame_gap_ms_ = 0;
+    frame_gap_jitter_ms_ = 0;
+    return;
+  }
+
+  if (idle_time_ms_ > 0 && gap_ms > idle_time_ms_) {
+    // The idle timeout fired but a frame followed within a couple of seconds: that was a
+    // wake-from-idle hit, so back off the dwell confidence faster than it builds.
+    idle_long_dwell_score_ = (idle_long_dwell_score_ > 2) ? (idle_long_dwell_score_ - 2) : 0;
+  }
+
+  uint32_t gap = UINT32(gap_ms);
+  if (!avg_frame_gap_ms_) {
+    avg_frame_gap_ms_ = gap;
+    frame_gap_jitter_ms_ = 0;
+    return;
+  }
+
+  uint32_t deviation = (gap > avg_frame_gap_ms_) ? (gap - avg_frame_gap_ms_)
+                                                 : (avg_frame_gap_ms_ - gap);
+  frame_gap_jitter_ms_ = (frame_gap_jitter_ms_ * 7 + deviation) / 8;
+  avg_frame_gap_ms_ = (avg_frame_gap_ms_ * 7 + gap) / 8;
+}
+
+void DisplayBuiltIn::SwitchIdleCadenceContext(uint32_t context_key) {
+  // The power service re-hints the idle timeout on a foreground-context change; park the
+  // cadence learned under the outgoing hint and restore what this hint learned last time it
+  // was foreground, so a returning context does not start cold.
+  if (idle_context_key_ && avg_frame_gap_ms_) {
+    if (idle_cadence_memory_.size() >= kMaxIdleCadenceContexts &&
+        idle_cadence_memory_.find(idle_context_key_) == idle_cadence_memory_.end()) {
+      // This much key churn is noise from a misbehaving hinter, not real contexts.
+      idle_cadence_memory_.clear();
+    }
+    idle_cadence_memory_[idle_context_key_] = {avg_frame_gap_ms_, frame_gap_jitter_ms_,
+                                               idle_long_dwell_score_};
+  }
+
+  auto entry = idle_cadence_memory_.find(context_key);
+  if (entry != idle_cadence_memory_.end()) {
+    avg_frame_gap_ms_ = entry->second.avg_frame_gap_ms;
+    frame_gap_jitter_ms_ = entry->second.frame_gap_jitter_ms;
+    idle_long_dwell_score_ = entry->second.long_dwell_score;
+  } else {
+    avg_frame_gap_ms_ = 0;
+    frame_gap_jitter_ms_ = 0;
+    idle_long_dwell_score_ = 0;
+  }
+  idle_context_key_ = context_key;
+}
+
+uint32_t DisplayBuiltIn::AdaptIdleTimeoutMs(uint32_t timeout_ms) {
+  if (!avg_frame_gap_ms_) {
+    return timeout_ms;
+  }
+
+  // The idle timer restarts on every commit, so the timeout only matters after
+  // the last frame of a burst. Predict when the next frame would arrive if the
+  // burst were still running; once that window passes without a frame, the
+  // burst is over and collapsing earlier than the configured timeout saves
+  // power without risking a wake-up hit mid-animation.
+  uint32_t predicted_gap_ms = avg_frame_gap_ms_ + 2 * frame_gap_jitter_ms_;
+  if (predicted_gap_ms >= timeout_ms) {
+    // Updates are already sparser than the timeout; nothing to predict.
+    return timeout_ms;
+  }
+
+  // Second level: a context whose quiet periods consistently run deep is heading for screen
+  // off far more often than for a wake, so collapse with a tighter margin there.
+  uint32_t margin_ms = (idle_long_dwell_score_ >= kLongDwellConfidence) ? (predicted_gap_ms / 4)
+                                                                        : (predicted_gap_ms / 2);
+  uint32_t adapted_ms = predicted_gap_ms + margin_ms;
+  // Keep a floor of a quarter of the configured timeout to bound collapse and
+  // wake-up churn when the cadence estimate runs hot.
+  adapted_ms = std::max(adapted_ms, timeout_ms / 4);
+
+  DLOGV_IF(kTagDisplay, "Idle timeout adapted to %d ms (configured %d, gap %d +/- %d)", adapted_ms,
+           timeout_ms, avg_frame_gap_ms_, frame_gap_jitter_ms_);
+
+  return adapted_ms;
+}
+
 void DisplayBuiltIn::HandleQsyncPostCommit() {
   if (qsync_mode_ == kQsyncModeOneShot) {
     // Reset qsync mode.
@@ -1175,6 +1410,9 @@ DisplayError DisplayBuiltIn::SetDisplayState(DisplayState state, bool teardown,
 
 void DisplayBuiltIn::SetIdleTimeoutMs(uint32_t active_ms, uint32_t inactive_ms) {
   ClientLock lock(disp_mutex_);
+  if (adaptive_idle_timeout_ && active_ms != idle_context_key_) {
+    SwitchIdleCadenceContext(active_ms);
+  }
   comp_manager_->SetIdleTimeoutMs(display_comp_ctx_, active_ms, inactive_ms);
   validated_ = false;
   handle_idle_timeout_ = false;
@@ -1358,11 +1596,25 @@ DisplayError DisplayBuiltIn::SetRefreshRate(uint32_t refresh_rate, bool final_ra
     return kErrorParameters;
   }
 
+  bool idle_lowered = false;
   if (CanLowerFps(idle_screen) && !final_rate && !enable_qsync_idle_) {
     refresh_rate = hw_panel_info_.min_fps;
+    idle_lowered = true;
   }
 
-  if (current_refresh_rate_ != refresh_rate) {
+  bool rate_switch = (current_refresh_rate_ != refresh_rate);
+  bool seamless = true;
+  struct timespec switch_start = {};
+
+  if (rate_switch) {
+    seamless = IsSeamlessSwitch(refresh_rate);
+    // Idle lowering has already waited out the idle timer; every other request goes through
+    // the governor so only rates that persist pay for a switch.
+    if (!idle_lowered && DeferRefreshRateSwitch(refresh_rate, final_rate, seamless)) {
+      return kErrorNone;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &switch_start);
     DisplayError error = hw_intf_->SetRefreshRate(refresh_rate);
     if (error != kErrorNone) {
       // Attempt to update refresh rate can fail if rf interfenence is detected.
@@ -1375,6 +1627,8 @@ DisplayError DisplayBuiltIn::SetRefreshRate(uint32_t refresh_rate, bool final_ra
     if (error != kErrorNone) {
       return error;
     }
+  } else {
+    pending_refresh_rate_ = 0;
   }
 
   // Set safe mode upon success.
@@ -1386,7 +1640,81 @@ DisplayError DisplayBuiltIn::SetRefreshRate(uint32_t refresh_rate, bool final_ra
   current_refresh_rate_ = refresh_rate;
   deferred_config_.MarkDirty();
 
-  return ReconfigureDisplay();
+  DisplayError error = ReconfigureDisplay();
+  if (rate_switch && error == kErrorNone) {
+    struct timespec switch_end;
+    clock_gettime(CLOCK_MONOTONIC, &switch_end);
+    RecordRefreshRateSwitchCost(seamless, GetTimeInMs(switch_end) - GetTimeInMs(switch_start));
+    pending_refresh_rate_ = 0;
+    last_rate_switch_ms_ = GetTimeInMs(switch_end);
+  }
+
+  return error;
+}
+
+bool DisplayBuiltIn::DeferRefreshRateSwitch(uint32_t refresh_rate, bool final_rate,
+                                            bool seamless) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t now_ms = GetTimeInMs(now);
+
+  if (refresh_rate != pending_refresh_rate_) {
+    pending_refresh_rate_ = refresh_rate;
+    pending_refresh_rate_since_ms_ = now_ms;
+  }
+
+  if (final_rate) {
+    // Framework insists on this rate; it cannot be absorbed.
+    return false;
+  }
+
+  // A rate must stay requested for a multiple of what switching to it will cost before the
+  // switch is executed. Oscillating requests keep resetting the window above and never pay a
+  // mode-set; the residency check against the last switch adds hysteresis on top.
+  float cost_ms = seamless ? avg_seamless_switch_ms_ : avg_modeset_switch_ms_;
+  float floor_ms = seamless ? 16.0f : 50.0f;
+  float ceil_ms = seamless ? 100.0f : 250.0f;
+  uint64_t debounce_ms = UINT64(std::min(std::max(4.0f * cost_ms, floor_ms), ceil_ms));
+
+  if ((now_ms - pending_refresh_rate_since_ms_) < debounce_ms ||
+      (now_ms - last_rate_switch_ms_) < debounce_ms) {
+    DLOGV_IF(kTagDisplay, "Deferring switch to %d fps: seamless %d, debounce %" PRIu64 " ms",
+             refresh_rate, seamless, debounce_ms);
+    return true;
+  }
+
+  return false;
+}
+
+bool DisplayBuiltIn::IsSeamlessSwitch(uint32_t refresh_rate) {
+  if (!hw_panel_info_.allowed_mode_switch) {
+    // No per-mode switch mask reported; dynamic fps panels change rate without a full mode-set.
+    return hw_panel_info_.dynamic_fps;
+  }
+
+  // allowed_mode_switch is the mask of modes reachable seamlessly from the active mode.
+  uint32_t num_modes = 0;
+  hw_intf_->GetNumDisplayAttributes(&num_modes);
+  for (uint32_t i = 0; i < num_modes; i++) {
+    HWDisplayAttributes attrib;
+    if (hw_intf_->GetDisplayAttributes(i, &attrib) != kErrorNone) {
+      continue;
+    }
+    if (attrib.fps == refresh_rate && attrib.x_pixels == display_attributes_.x_pixels &&
+        attrib.y_pixels == display_attributes_.y_pixels) {
+      return (hw_panel_info_.allowed_mode_switch & (1u << i));
+    }
+  }
+
+  return false;
+}
+
+void DisplayBuiltIn::RecordRefreshRateSwitchCost(bool seamless, uint64_t elapsed_ms) {
+  float *avg = seamless ? &avg_seamless_switch_ms_ : &avg_modeset_switch_ms_;
+  // EWMA so one slow commit does not distort the debounce window for long.
+  *avg = (*avg * 3.0f + FLOAT(elapsed_ms)) / 4.0f;
+  DLOGV_IF(kTagDisplay, "Refresh rate switch took %" PRIu64 " ms, avg %s cost %.1f ms",
+           elapsed_ms, seamless ? "seamless" : "mode-set", *avg);
 }
 
 bool DisplayBuiltIn::CanLowerFps(bool idle_screen) {
@@ -1459,6 +1787,27 @@ void DisplayBuiltIn::IdleTimeout() {
   event_handler_->Refresh();
 }
 
+DisplayError DisplayBuiltIn::TriggerIdleFlattening() {
+  ClientLock lock(disp_mutex_);
+  DTRACE_SCOPED();
+  if (state_ == kStateOff) {
+    return kErrorPermission;
+  }
+
+  if (pending_commit_) {
+    return kErrorResources;
+  }
+
+  // Drive the idle fallback composition path immediately instead of waiting for the idle
+  // timer, so the flattened output is captured while the client still commits frames.
+  handle_idle_timeout_ = true;
+  comp_manager_->ProcessIdleTimeout(display_comp_ctx_);
+  validated_ = false;
+  event_handler_->Refresh();
+
+  return kErrorNone;
+}
+
 void DisplayBuiltIn::PingPongTimeout() {
   ClientLock lock(disp_mutex_);
   hw_intf_->DumpDebugData();
@@ -1479,6 +1828,21 @@ DisplayError DisplayBuiltIn::ClearLUTs() {
   return kErrorNone;
 }
 
+DisplayError DisplayBuiltIn::HandleAppLaunchHint() {
+  ClientLock lock(disp_mutex_);
+
+  // Compose the warm-up frame with the full strategy instead of the idle flattening one,
+  // so the caches it fills are the ones the launch frame will hit.
+  handle_idle_timeout_ = false;
+  comp_manager_->ProcessAppLaunchHint(display_comp_ctx_);
+
+  // Force full validation on the next frame; the client schedules a refresh so it runs
+  // ahead of the launch and the launch frame itself can take the validate-skip path.
+  validated_ = false;
+
+  return kErrorNone;
+}
+
 void DisplayBuiltIn::MMRMEvent(uint32_t clk) {
   DTRACE_SCOPED();
   DisplayBase::MMRMEvent(clk);
@@ -1809,227 +2173,94 @@ DisplayError DisplayBuiltIn::NotifyDisplayCalibrationMode(bool in_calibration) {
 }
 
 std::string DisplayBuiltIn::Dump() {
-  ClientLock lock(disp_mutex_);
-  HWDisplayAttributes attrib;
-  uint32_t active_index = 0;
-  uint32_t num_modes = 0;
   std::ostringstream os;
-  char capabilities[16];
-
-  hw_intf_->GetNumDisplayAttributes(&num_modes);
-  hw_intf_->GetActiveConfig(&active_index);
-  hw_intf_->GetDisplayAttributes(active_index, &attrib);
-
-  os << "device type:" << display_type_;
-  os << " DrawMethod: " << draw_method_;
-  os << "\nstate: " << state_ << " vsync on: " << vsync_enable_
-     << " max. mixer stages: " << max_mixer_stages_;
-  if (disp_layer_stack_->info.noise_layer_info.enable) {
-    os << "\nNoise z-orders: [" << disp_layer_stack_->info.noise_layer_info.zpos_noise << ","
-       << disp_layer_stack_->info.noise_layer_info.zpos_attn << "]";
-  }
-  os << "\nnum configs: " << num_modes << " active config index: " << active_index;
-  os << "\nDisplay Attributes:";
-  os << "\n Mode:" << (hw_panel_info_.mode == kModeVideo ? "Video" : "Command");
-  os << std::boolalpha;
-  os << " Primary:" << hw_panel_info_.is_primary_panel;
-  os << " DynFPS:" << hw_panel_info_.dynamic_fps;
-  os << "\n HDR Panel:" << hw_panel_info_.hdr_enabled;
-  os << " QSync:" << hw_panel_info_.qsync_support;
-  os << " DynBitclk:" << hw_panel_info_.dyn_bitclk_support;
-  os << "\n Left Split:" << hw_panel_info_.split_info.left_split
-     << " Right Split:" << hw_panel_info_.split_info.right_split;
-  os << "\n PartialUpdate:" << hw_panel_info_.partial_update;
-  if (hw_panel_info_.partial_update) {
-    os << "\n ROI Min w:" << hw_panel_info_.min_roi_width;
-    os << " Min h:" << hw_panel_info_.min_roi_height;
-    os << " NeedsMerge: " << hw_panel_info_.needs_roi_merge;
-    os << " Alignment: l:" << hw_panel_info_.left_align << " w:" << hw_panel_info_.width_align;
-    os << " t:" << hw_panel_info_.top_align << " b:" << hw_panel_info_.height_align;
-  }
-  os << "\n FPS min:" << hw_panel_info_.min_fps << " max:" << hw_panel_info_.max_fps
-     << " cur:" << display_attributes_.fps;
-  os << " TransferTime: " << hw_panel_info_.transfer_time_us << "us";
-  os << " Min TransferTime: " << hw_panel_info_.transfer_time_us_min << "us";
-  os << " Max TransferTime: " << hw_panel_info_.transfer_time_us_max << "us";
-  os << " AllowedModeSwitch: " << hw_panel_info_.allowed_mode_switch;
-  os << " PanelModeCaps: ";
-  snprintf(capabilities, sizeof(capabilities), "0x%x", hw_panel_info_.panel_mode_caps);
-  os << capabilities;
-  os << " MaxBrightness:" << hw_panel_info_.panel_max_brightness;
-  os << "\n Display WxH: " << display_attributes_.x_pixels << "x" << display_attributes_.y_pixels;
-  os << " MixerWxH: " << mixer_attributes_.width << "x" << mixer_attributes_.height;
-  os << " DPI: " << display_attributes_.x_dpi << "x" << display_attributes_.y_dpi;
-  os << " LM_Split: " << display_attributes_.is_device_split;
-  os << "\n vsync_period " << display_attributes_.vsync_period_ns;
-  os << " v_back_porch: " << display_attributes_.v_back_porch;
-  os << " v_front_porch: " << display_attributes_.v_front_porch;
-  os << " v_pulse_width: " << display_attributes_.v_pulse_width;
-  os << "\n v_total: " << display_attributes_.v_total;
-  os << " h_total: " << display_attributes_.h_total;
-  os << " clk: " << display_attributes_.clock_khz;
-  os << " Topology: " << display_attributes_.topology;
-  os << " Qsync mode: " << active_qsync_mode_;
-  os << std::noboolalpha;
-
-  DynamicRangeType curr_dynamic_range = kSdrType;
-  if (std::find(current_color_mode_.hw_assets.begin(), current_color_mode_.hw_assets.end(),
-                snapdragoncolor::kPbHdrBlob) != current_color_mode_.hw_assets.end()) {
-    curr_dynamic_range = kHdrType;
-  }
-  os << "\nCurrent Color Mode: gamut " << current_color_mode_.gamut << " gamma "
-     << current_color_mode_.gamma << " intent " << current_color_mode_.intent << " Dynamice_range"
-     << (curr_dynamic_range == kSdrType ? " SDR" : " HDR");
-
-  uint32_t num_hw_layers = UINT32(disp_layer_stack_->info.hw_layers.size());
-
-  if (num_hw_layers == 0) {
-    os << "\nNo hardware layers programmed";
-    return os.str();
-  }
-
-  if (cwb_active_) {
-    os << "\n Output buffer res: " << cwb_output_buf_.width << "x" << cwb_output_buf_.height
-       << " format: " << GetFormatString(cwb_output_buf_.format);
-  }
-
-  HWLayersInfo &layer_info = disp_layer_stack_->info;
-  for (uint32_t i = 0; i < layer_info.left_frame_roi.size(); i++) {
-    LayerRect &l_roi = layer_info.left_frame_roi.at(i);
-    LayerRect &r_roi = layer_info.right_frame_roi.at(i);
-
-    os << "\nROI(LTRB)#" << i << " LEFT(" << INT(l_roi.left) << " " << INT(l_roi.top) << " " <<
-      INT(l_roi.right) << " " << INT(l_roi.bottom) << ")";
-    if (IsValid(r_roi)) {
-    os << " RIGHT(" << INT(r_roi.left) << " " << INT(r_roi.top) << " " << INT(r_roi.right) << " "
-      << INT(r_roi.bottom) << ")";
-    }
-  }
-
-  LayerRect &fb_roi = layer_info.partial_fb_roi;
-  if (IsValid(fb_roi)) {
-    os << "\nPartial FB ROI(LTRB):(" << INT(fb_roi.left) << " " << INT(fb_roi.top) << " " <<
-      INT(fb_roi.right) << " " << INT(fb_roi.bottom) << ")";
-  }
-
-  AppendRCMaskData(os);
-
-  const char *header  = "\n| Idx |   Comp Type   |   Split   | Pipe |    W x H    |          Format          |  Src Rect (L T R B) |  Dst Rect (L T R B) |  Z | Pipe Flags | Deci(HxV) | CS | Rng | Tr |";  //NOLINT
-  const char *newline = "\n|-----|---------------|-----------|------|-------------|--------------------------|---------------------|---------------------|----|------------|-----------|----|-----|----|";  //NOLINT
-  const char *format  = "\n| %3s | %13s | %9s | %4d | %4d x %4d | %24s | %4d %4d %4d %4d | %4d %4d %4d %4d | %2s | %10s | %9s | %2s | %3s | %2s |";  //NOLINT
-
-  os << "\n";
-  os << newline;
-  os << header;
-  os << newline;
-
-  for (uint32_t i = 0; i < num_hw_layers; i++) {
-    uint32_t layer_index = disp_layer_stack_->info.index.at(i);
-    // hw-layer from hw layers info
-    Layer &hw_layer = disp_layer_stack_->info.hw_layers.at(i);
-    LayerBuffer *input_buffer = &hw_layer.input_buffer;
-    HWLayerConfig &layer_config = disp_layer_stack_->info.config[i];
-    HWRotatorSession &hw_rotator_session = layer_config.hw_rotator_session;
-
-    const char *comp_type = GetCompositionName(hw_layer.composition);
-    const char *buffer_format = GetFormatString(input_buffer->format);
-    const char *pipe_split[2] = { "Pipe-1", "Pipe-2" };
-    const char *rot_pipe[2] = { "Rot-inl-1", "Rot-inl-2" };
-    char idx[8];
-
-    snprintf(idx, sizeof(idx), "%d", layer_index);
-
-    for (uint32_t count = 0; count < hw_rotator_session.hw_block_count; count++) {
-      char row[1024];
-      HWRotateInfo &rotate = hw_rotator_session.hw_rotate_info[count];
-      LayerRect &src_roi = rotate.src_roi;
-      LayerRect &dst_roi = rotate.dst_roi;
-      char rot[12] = { 0 };
-
-      snprintf(rot, sizeof(rot), "Rot-%s-%d", layer_config.use_inline_rot ?
-               "inl" : "off", count + 1);
-
-      snprintf(row, sizeof(row), format, idx, comp_type, rot,
-               0, input_buffer->width, input_buffer->height, buffer_format,
-               INT(src_roi.left), INT(src_roi.top), INT(src_roi.right), INT(src_roi.bottom),
-               INT(dst_roi.left), INT(dst_roi.top), INT(dst_roi.right), INT(dst_roi.bottom),
-               "-", "-    ", "-    ", "-", "-", "-");
-      os << row;
-      // print the below only once per layer block, fill with spaces for rest.
-      idx[0] = 0;
-      comp_type = "";
-    }
-
-    if (hw_rotator_session.hw_block_count > 0) {
-      input_buffer = &hw_rotator_session.output_buffer;
-      buffer_format = GetFormatString(input_buffer->format);
-    }
-
-    if (layer_config.use_solidfill_stage) {
-      LayerRect src_roi = layer_config.hw_solidfill_stage.roi;
-      const char *decimation = "";
-      char flags[16] = { 0 };
-      char z_order[8] = { 0 };
-      const char *color_primary = "";
-      const char *range = "";
-      const char *transfer = "";
-      char row[1024] = { 0 };
-
-      snprintf(z_order, sizeof(z_order), "%d", layer_config.hw_solidfill_stage.z_order);
-      snprintf(flags, sizeof(flags), "0x%08x", hw_layer.flags.flags);
-      snprintf(row, sizeof(row), format, idx, comp_type, pipe_split[0],
-               0, INT(src_roi.right), INT(src_roi.bottom),
-               buffer_format, INT(src_roi.left), INT(src_roi.top),
-               INT(src_roi.right), INT(src_roi.bottom), INT(src_roi.left),
-               INT(src_roi.top), INT(src_roi.right), INT(src_roi.bottom),
-               z_order, flags, decimation, color_primary, range, transfer);
-      os << row;
-      continue;
-    }
-
-    for (uint32_t count = 0; count < 2; count++) {
-      char decimation[16] = { 0 };
-      char flags[16] = { 0 };
-      char z_order[8] = { 0 };
-      char color_primary[8] = { 0 };
-      char range[8] = { 0 };
-      char transfer[8] = { 0 };
-      bool rot = layer_config.use_inline_rot;
-
-      HWPipeInfo &pipe = (count == 0) ? layer_config.left_pipe : layer_config.right_pipe;
-
-      if (!pipe.valid) {
-        continue;
-      }
+  LayerTableSnapshot snapshot;
 
-      LayerRect src_roi = pipe.src_roi;
-      LayerRect &dst_roi = pipe.dst_roi;
-
-      snprintf(z_order, sizeof(z_order), "%d", pipe.z_order);
-      snprintf(flags, sizeof(flags), "0x%08x", pipe.flags);
-      snprintf(decimation, sizeof(decimation), "%3d x %3d", pipe.horizontal_decimation,
-               pipe.vertical_decimation);
-      ColorMetaData &color_metadata = hw_layer.input_buffer.color_metadata;
-      snprintf(color_primary, sizeof(color_primary), "%d", color_metadata.colorPrimaries);
-      snprintf(range, sizeof(range), "%d", color_metadata.range);
-      snprintf(transfer, sizeof(transfer), "%d", color_metadata.transfer);
-
-      char row[1024];
-      snprintf(row, sizeof(row), format, idx, comp_type, rot ? rot_pipe[count] : pipe_split[count],
-               pipe.pipe_id, input_buffer->width, input_buffer->height,
-               buffer_format, INT(src_roi.left), INT(src_roi.top),
-               INT(src_roi.right), INT(src_roi.bottom), INT(dst_roi.left),
-               INT(dst_roi.top), INT(dst_roi.right), INT(dst_roi.bottom),
-               z_order, flags, decimation, color_primary, range, transfer);
-
-      os << row;
-      // print the below only once per layer block, fill with spaces for rest.
-      idx[0] = 0;
-      comp_type = "";
-    }
-  }
-
-  os << newline << "\n";
+  // Format only the short attribute header under the lock; the layer table is formatted from
+  // the commit-time snapshot after the lock is dropped, so a dumpsys racing with composition
+  // cannot delay the next frame.
+  {
+    ClientLock lock(disp_mutex_);
+    HWDisplayAttributes attrib;
+    uint32_t active_index = 0;
+    uint32_t num_modes = 0;
+    char capabilities[16];
+
+    hw_intf_->GetNumDisplayAttributes(&num_modes);
+    hw_intf_->GetActiveConfig(&active_index);
+    hw_intf_->GetDisplayAttributes(active_index, &attrib);
+
+    os << "device type:" << display_type_;
+    os << " DrawMethod: " << draw_method_;
+    os << "\nstate: " << state_ << " vsync on: " << vsync_enable_
+       << " max. mixer stages: " << max_mixer_stages_;
+    if (disp_layer_stack_->info.noise_layer_info.enable) {
+      os << "\nNoise z-orders: [" << disp_layer_stack_->info.noise_layer_info.zpos_noise << ","
+         << disp_layer_stack_->info.noise_layer_info.zpos_attn << "]";
+    }
+    os << "\nnum configs: " << num_modes << " active config index: " << active_index;
+    os << "\nDisplay Attributes:";
+    os << "\n Mode:" << (hw_panel_info_.mode == kModeVideo ? "Video" : "Command");
+    os << std::boolalpha;
+    os << " Primary:" << hw_panel_info_.is_primary_panel;
+    os << " DynFPS:" << hw_panel_info_.dynamic_fps;
+    os << "\n HDR Panel:" << hw_panel_info_.hdr_enabled;
+    os << " QSync:" << hw_panel_info_.qsync_support;
+    os << " DynBitclk:" << hw_panel_info_.dyn_bitclk_support;
+    os << "\n Left Split:" << hw_panel_info_.split_info.left_split
+       << " Right Split:" << hw_panel_info_.split_info.right_split;
+    os << "\n PartialUpdate:" << hw_panel_info_.partial_update;
+    if (hw_panel_info_.partial_update) {
+      os << "\n ROI Min w:" << hw_panel_info_.min_roi_width;
+      os << " Min h:" << hw_panel_info_.min_roi_height;
+      os << " NeedsMerge: " << hw_panel_info_.needs_roi_merge;
+      os << " Alignment: l:" << hw_panel_info_.left_align << " w:" << hw_panel_info_.width_align;
+      os << " t:" << hw_panel_info_.top_align << " b:" << hw_panel_info_.height_align;
+    }
+    os << "\n FPS min:" << hw_panel_info_.min_fps << " max:" << hw_panel_info_.max_fps
+       << " cur:" << display_attributes_.fps;
+    os << " TransferTime: " << hw_panel_info_.transfer_time_us << "us";
+    os << " Min TransferTime: " << hw_panel_info_.transfer_time_us_min << "us";
+    os << " Max TransferTime: " << hw_panel_info_.transfer_time_us_max << "us";
+    os << " AllowedModeSwitch: " << hw_panel_info_.allowed_mode_switch;
+    os << " PanelModeCaps: ";
+    snprintf(capabilities, sizeof(capabilities), "0x%x", hw_panel_info_.panel_mode_caps);
+    os << capabilities;
+    os << " MaxBrightness:" << hw_panel_info_.panel_max_brightness;
+    os << "\n Display WxH: " << display_attributes_.x_pixels << "x"
+       << display_attributes_.y_pixels;
+    os << " MixerWxH: " << mixer_attributes_.width << "x" << mixer_attributes_.height;
+    os << " DPI: " << display_attributes_.x_dpi << "x" << display_attributes_.y_dpi;
+    os << " LM_Split: " << display_attributes_.is_device_split;
+    os << "\n vsync_period " << display_attributes_.vsync_period_ns;
+    os << " v_back_porch: " << display_attributes_.v_back_porch;
+    os << " v_front_porch: " << display_attributes_.v_front_porch;
+    os << " v_pulse_width: " << display_attributes_.v_pulse_width;
+    os << "\n v_total: " << display_attributes_.v_total;
+    os << " h_total: " << display_attributes_.h_total;
+    os << " clk: " << display_attributes_.clock_khz;
+    os << " Topology: " << display_attributes_.topology;
+    os << " Qsync mode: " << active_qsync_mode_;
+    if (enable_cadence_lock_) {
+      os << "\n Video cadence: " << (cadence_locked_ ? "locked" : "tracking")
+         << " locks: " << cadence_locks_ << " breaks: " << cadence_breaks_
+         << " snapped frames: " << cadence_snapped_frames_;
+    }
+    os << std::noboolalpha;
+
+    DynamicRangeType curr_dynamic_range = kSdrType;
+    if (std::find(current_color_mode_.hw_assets.begin(), current_color_mode_.hw_assets.end(),
+                  snapdragoncolor::kPbHdrBlob) != current_color_mode_.hw_assets.end()) {
+      curr_dynamic_range = kHdrType;
+    }
+    os << "\nCurrent Color Mode: gamut " << current_color_mode_.gamut << " gamma "
+       << current_color_mode_.gamma << " intent " << current_color_mode_.intent
+       << " Dynamice_range" << (curr_dynamic_range == kSdrType ? " SDR" : " HDR");
+
+    snapshot = dump_snapshot_;
+  }
+
+  DumpLayerTable(snapshot, os);
   os << comp_manager_->Dump(display_comp_ctx_);
 
   return os.str();
@@ -2311,7 +2542,10 @@ bool DisplayBuiltIn::CanSkipDisplayPrepare(LayerStack *layer_stack) {
       }
     }
 
-    // Set the composition type for SDM layers.
+    // Replay the composition type of each app layer from the validated plan. Marking
+    // everything as SDE here silently restricted this path to full-device frames; a
+    // mixed-mode plan is just as binding, so layers absent from the cached HW layer
+    // index stay on GPU composition exactly as accepted.
     size_t size_ff = 1;  // GPU Target Layer always present in input
     if (layer_stack->flags.stitch_present)
       size_ff++;
@@ -2320,8 +2554,15 @@ bool DisplayBuiltIn::CanSkipDisplayPrepare(LayerStack *layer_stack) {
     if (disp_layer_stack_->info.flags.noise_present)
       size_ff++;
 
-    for (uint32_t i = 0; i < (layer_stack->layers.size() - size_ff); i++) {
-      layer_stack->layers.at(i)->composition = kCompositionSDE;
+    uint32_t app_layer_count = UINT32(layer_stack->layers.size() - size_ff);
+    for (uint32_t i = 0; i < app_layer_count; i++) {
+      layer_stack->layers.at(i)->composition = kCompositionGPU;
+    }
+    for (uint32_t j = 0; j < hw_layer_count; j++) {
+      uint32_t stack_index = UINT32(disp_layer_stack_->info.index.at(j));
+      if (stack_index < app_layer_count) {
+        layer_stack->layers.at(stack_index)->composition = kCompositionSDE;
+      }
     }
   }
 
@@ -2616,15 +2857,15 @@ DisplayError DisplayBuiltIn::GetConfig(DisplayConfigFixedInfo *fixed_info) {
   ClientLock lock(disp_mutex_);
   fixed_info->is_cmdmode = (hw_panel_info_.mode == kModeCommand);
 
-  HWResourceInfo hw_resource_info = HWResourceInfo();
-  hw_info_intf_->GetHWResourceInfo(&hw_resource_info);
+  std::shared_ptr<const HWResourceInfo> hw_resource_info = hw_info_intf_->GetHWResourceInfo();
   bool hdr_plus_supported = false;
   bool dolby_vision_supported = false;
 
   // Checking library support for HDR10+
   comp_manager_->GetHDRCapability(&hdr_plus_supported, &dolby_vision_supported);
 
-  fixed_info->hdr_supported = hw_resource_info.has_hdr && hw_panel_info_.hdr_enabled;
+  fixed_info->hdr_supported =
+      hw_resource_info && hw_resource_info->has_hdr && hw_panel_info_.hdr_enabled;
   // Built-in displays always support HDR10+ when the target supports HDR
   fixed_info->hdr_plus_supported = fixed_info->hdr_supported && hdr_plus_supported;
   fixed_info->dolby_vision_supported = fixed_info->hdr_supported && dolby_vision_supported;
@@ -2635,7 +2876,7 @@ DisplayError DisplayBuiltIn::GetConfig(DisplayConfigFixedInfo *fixed_info) {
   fixed_info->hdr_eotf = hw_panel_info_.hdr_eotf;
   fixed_info->hdr_metadata_type_one = hw_panel_info_.hdr_metadata_type_one;
   fixed_info->partial_update = hw_panel_info_.partial_update;
-  fixed_info->readback_supported = hw_resource_info.has_concurrent_writeback;
+  fixed_info->readback_supported = hw_resource_info && hw_resource_info->has_concurrent_writeback;
   fixed_info->supports_unified_draw = unified_draw_supported_;
 
   return kErrorNone;
@@ -2956,7 +3197,7 @@ void DisplayIPCVmCallbackImpl::OnServerExit() {
 // LCOV_EXCL_STOP
 
 void DisplayBuiltIn::InitCWBBuffer() {
-  if (hw_panel_info_.mode != kModeVideo || !hw_resource_info_.has_concurrent_writeback
+  if (hw_panel_info_.mode != kModeVideo || !hw_resource_info_->has_concurrent_writeback
       || !hw_panel_info_.is_primary_panel) {
     return;
   }
@@ -3300,6 +3541,13 @@ DisplayError DisplayBuiltIn::PanelOprInfo(const std::string &client_name, bool e
   return event_proxy_info_.PanelOprInfo(client_name, enable, cb_intf);
 }
 
+DisplayError DisplayBuiltIn::PanelOprInfoBatched(
+    const std::string &client_name, bool enable,
+    SdmDisplayCbInterface<PanelOprBatchPayload> *cb_intf) {
+  uint32_t fps = display_attributes_.fps ? display_attributes_.fps : 60;
+  return event_proxy_info_.PanelOprInfoBatched(client_name, enable, 1000000000 / fps, cb_intf);
+}
+
 DisplayError DisplayBuiltIn::SetQSyncModeLocked(QSyncMode qsync_mode) {
   if (!hw_panel_info_.qsync_support || first_cycle_) {
     DLOGW("Failed: qsync_support: %d first_cycle %d", hw_panel_info_.qsync_support, first_cycle_);
@@ -3403,4 +3651,126 @@ DisplayError EventProxyInfo::PanelOprInfo(const std::string &client_name, bool e
   return kErrorNone;
 }
 
+DisplayError EventProxyInfo::PanelOprInfoBatched(
+    const std::string &client_name, bool enable, uint32_t vsync_period_ns,
+    SdmDisplayCbInterface<PanelOprBatchPayload> *cb_intf) {
+  if (enable) {
+    DisplayError error = opr_batcher_.Start(vsync_period_ns, cb_intf);
+    if (error != kErrorNone) {
+      return error;
+    }
+    error = PanelOprInfo(client_name, true, &opr_batcher_);
+    if (error != kErrorNone) {
+      opr_batcher_.Stop();
+    }
+    return error;
+  }
+
+  DisplayError error = PanelOprInfo(client_name, false, &opr_batcher_);
+  opr_batcher_.Stop();
+  return error;
+}
+
+DisplayError PanelOprBatcher::Start(uint32_t vsync_period_ns,
+                                    SdmDisplayCbInterface<PanelOprBatchPayload> *client_cb) {
+  if (!client_cb) {
+    return kErrorParameters;
+  }
+
+  std::lock_guard<std::mutex> guard(lock_);
+  if (running_) {
+    DLOGW("Batched OPR delivery is already active");
+    return kErrorParameters;
+  }
+
+  client_cb_ = client_cb;
+  if (vsync_period_ns) {
+    vsync_period_ns_ = vsync_period_ns;
+  }
+  write_idx_ = 0;
+  read_idx_ = 0;
+  dropped_ = 0;
+  running_ = true;
+  flush_thread_ = std::thread(&PanelOprBatcher::FlushLoop, this);
+
+  return kErrorNone;
+}
+
+DisplayError PanelOprBatcher::Stop() {
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!running_) {
+      return kErrorNone;
+    }
+    running_ = false;
+  }
+  cv_.notify_one();
+  flush_thread_.join();
+  client_cb_ = nullptr;
+
+  return kErrorNone;
+}
+
+int PanelOprBatcher::Notify(const PanelOprPayload &payload) {
+  bool wake = false;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    if (!running_) {
+      return -ENODEV;
+    }
+    if (write_idx_ - read_idx_ >= kRingSize) {
+      // Overwrite the oldest entry; the latest OPR values matter most.
+      read_idx_++;
+      dropped_++;
+    }
+    ring_[write_idx_ & (kRingSize - 1)] = payload;
+    // Wake the flush thread only for the first event of a batch; later events
+    // ride along with the delivery already scheduled for this interval.
+    wake = (write_idx_ == read_idx_);
+    write_idx_++;
+  }
+  if (wake) {
+    cv_.notify_one();
+  }
+
+  return 0;
+}
+
+void PanelOprBatcher::FlushLoop() {
+  std::unique_lock<std::mutex> lock(lock_);
+  while (running_) {
+    cv_.wait(lock, [this]() { return !running_ || (write_idx_ != read_idx_); });
+    if (!running_) {
+      break;
+    }
+
+    // Let the rest of the vsync interval accumulate events before the single
+    // client delivery.
+    cv_.wait_for(lock, std::chrono::nanoseconds(vsync_period_ns_),
+                 [this]() { return !running_; });
+    if (!running_) {
+      break;
+    }
+
+    PanelOprPayload events[kRingSize];
+    uint32_t count = 0;
+    while ((read_idx_ != write_idx_) && (count < kRingSize)) {
+      events[count++] = ring_[read_idx_ & (kRingSize - 1)];
+      read_idx_++;
+    }
+    uint32_t dropped = dropped_;
+    dropped_ = 0;
+
+    lock.unlock();
+    if (dropped) {
+      DLOGW("Dropped %d OPR events, client delivery is too slow", dropped);
+    }
+    PanelOprBatchPayload batch = {};
+    batch.count = count;
+    batch.events = events;
+    client_cb_->Notify(batch);
+    lock.lock();
+  }
+}
+
 }  // namespace sdm
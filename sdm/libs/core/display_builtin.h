@@ -45,7 +45,11 @@
 #include <private/panel_feature_factory_intf.h>
 #include <private/hw_events_interface.h>
 #include <private/display_event_proxy_intf.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "display_base.h"
@@ -111,16 +115,46 @@ class DppsInfo {
   void Deinit_nolock();
 };
 
+// Coalesces per-event callbacks from the event proxy extension into batched
+// deliveries, waking the client at most once per vsync interval.
+class PanelOprBatcher : public SdmDisplayCbInterface<PanelOprPayload> {
+ public:
+  virtual ~PanelOprBatcher() { Stop(); }
+  DisplayError Start(uint32_t vsync_period_ns,
+                     SdmDisplayCbInterface<PanelOprBatchPayload> *client_cb);
+  DisplayError Stop();
+  int Notify(const PanelOprPayload &payload) override;
+
+ private:
+  void FlushLoop();
+
+  static const uint32_t kRingSize = 64;  // must be a power of two
+  PanelOprPayload ring_[kRingSize];
+  uint32_t write_idx_ = 0;  // total events queued, guarded by lock_
+  uint32_t read_idx_ = 0;   // total events delivered, guarded by lock_
+  uint32_t dropped_ = 0;
+  uint32_t vsync_period_ns_ = 16666666;
+  SdmDisplayCbInterface<PanelOprBatchPayload> *client_cb_ = nullptr;
+  bool running_ = false;
+  std::thread flush_thread_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+};
+
 class EventProxyInfo {
  public:
   DisplayError Init(const std::string &panel_name, DisplayInterface *intf, DynLib &extension_lib);
   DisplayError Deinit();
   DisplayError PanelOprInfo(const std::string &client_name, bool enable,
                             SdmDisplayCbInterface<PanelOprPayload> *cb_intf);
+  DisplayError PanelOprInfoBatched(const std::string &client_name, bool enable,
+                                   uint32_t vsync_period_ns,
+                                   SdmDisplayCbInterface<PanelOprBatchPayload> *cb_intf);
 
  private:
   std::mutex lock_;
   std::shared_ptr<DisplayEventProxyIntf> event_proxy_intf_ = nullptr;
+  PanelOprBatcher opr_batcher_;
 };
 
 class DisplayIPCVmCallbackImpl : public IPCVmCallbackIntf {
@@ -215,6 +249,9 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   DisplayError SetDemuraConfig(int demura_idx) override;
   DisplayError PanelOprInfo(const std::string &client_name, bool enable,
                             SdmDisplayCbInterface<PanelOprPayload> *cb_intf) override;
+  DisplayError PanelOprInfoBatched(const std::string &client_name, bool enable,
+                                   SdmDisplayCbInterface<PanelOprBatchPayload> *cb_intf) override;
+  DisplayError TriggerIdleFlattening() override;
 
   // Implement the HWEventHandlers
   DisplayError VSync(int64_t timestamp) override;
@@ -227,6 +264,7 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   void HwRecovery(const HWRecoveryEvent sdm_event_code) override;
   void MMRMEvent(uint32_t clk) override;
   DisplayError ClearLUTs() override;
+  DisplayError HandleAppLaunchHint() override;
   void Histogram(int histogram_fd, uint32_t blob_id) override;
   void HandleBacklightEvent(float brightness_level) override;
   void HandlePowerEvent() override;
@@ -266,6 +304,10 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   void SendBacklight();
   void SendDisplayConfigs();
   bool CanLowerFps(bool idle_screen);
+  // Refresh-rate switch governor; see DeferRefreshRateSwitch().
+  bool DeferRefreshRateSwitch(uint32_t refresh_rate, bool final_rate, bool seamless);
+  bool IsSeamlessSwitch(uint32_t refresh_rate);
+  void RecordRefreshRateSwitchCost(bool seamless, uint64_t elapsed_ms);
   int SetDemuraIntfStatus(bool enable, int current_idx = kDemuraDefaultIdx);
   DisplayError HandleSPR();
   void CacheFrameROI();
@@ -276,6 +318,10 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   void NotifyDppsHdrPresent(LayerStack *layer_stack);
   bool IdleFallbackLowerFps(bool idle_screen);
   void HandleUpdateTransferTime(QSyncMode mode);
+  void UpdateFrameGapStats(const struct timespec &prev_commit, const struct timespec &curr_commit);
+  uint32_t AdaptIdleTimeoutMs(uint32_t timeout_ms);
+  void SwitchIdleCadenceContext(uint32_t context_key);
+  void ApplyVideoCadenceLock(LayerStack *layer_stack);
 
   const uint32_t kPuTimeOutMs = 1000;
   std::vector<HWEvent> event_list_;
@@ -315,7 +361,54 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   std::shared_ptr<IPCIntf> ipc_intf_ = nullptr;
   bool enhance_idle_time_ = false;
   int idle_time_ms_ = 0;
-  struct timespec idle_timer_start_;
+  struct timespec idle_timer_start_ = {};
+  // Inter-commit cadence tracking for the adaptive idle timeout; see
+  // AdaptIdleTimeoutMs().
+  static const uint32_t kMaxTrackedFrameGapMs = 4000;
+  bool adaptive_idle_timeout_ = false;
+  uint32_t avg_frame_gap_ms_ = 0;
+  uint32_t frame_gap_jitter_ms_ = 0;
+  // Per-context cadence memory: the power service signals a foreground-context switch by
+  // re-hinting the idle timeout through SetIdleTimeoutMs(), so the hinted value doubles as the
+  // context key. Cadence learned under one hint is parked on a switch and restored when that
+  // hint returns, and the dwell score records whether the context's quiet periods tend to run
+  // long (heading for screen off) or end in a quick wake.
+  struct IdleCadence {
+    uint32_t avg_frame_gap_ms = 0;
+    uint32_t frame_gap_jitter_ms = 0;
+    uint32_t long_dwell_score = 0;
+  };
+  static const uint32_t kMaxIdleCadenceContexts = 16;
+  static const uint32_t kLongDwellConfidence = 6;
+  std::map<uint32_t, IdleCadence> idle_cadence_memory_;
+  uint32_t idle_context_key_ = 0;
+  uint32_t idle_long_dwell_score_ = 0;
+  // Video cadence lock: fixed-cadence video (24/30 fps on a 60/120 Hz panel) is detected from
+  // the expected-present timestamps and, once stable, outgoing timestamps are snapped onto the
+  // ideal cadence grid. The DPU driver already releases each commit at the requested instant,
+  // so snapping here removes the delivery jitter that breaks 3:2/2:2 pulldown patterns; see
+  // ApplyVideoCadenceLock().
+  static const uint32_t kCadenceLockFrames = 6;
+  bool enable_cadence_lock_ = false;
+  bool cadence_locked_ = false;
+  uint64_t cadence_last_raw_ept_ = 0;    // last expected present time as delivered by the client
+  uint64_t cadence_output_ept_ = 0;      // snapped value issued for that frame, 0 = passthrough
+  uint64_t cadence_ideal_ept_ = 0;       // next ideal presentation instant while locked
+  uint64_t cadence_step_ns_ = 0;         // locked content frame interval
+  uint32_t cadence_units_prev_ = 0;      // last two deltas in half-vsync units; 3:2 and 2:2
+  uint32_t cadence_units_prev2_ = 0;     // patterns both repeat with period two
+  uint32_t cadence_stable_frames_ = 0;
+  uint32_t cadence_locks_ = 0;           // times a cadence was acquired
+  uint32_t cadence_breaks_ = 0;          // times a locked cadence was abandoned
+  uint64_t cadence_snapped_frames_ = 0;  // frames whose timestamp was adjusted
+  // Refresh-rate switch governor state: a requested rate must stay requested for a debounce
+  // window derived from the measured switch cost before the switch is committed, so rapid
+  // oscillation (e.g. 60<->90<->120 while scrolling) does not pay a mode-set per request.
+  uint32_t pending_refresh_rate_ = 0;
+  uint64_t pending_refresh_rate_since_ms_ = 0;
+  uint64_t last_rate_switch_ms_ = 0;
+  float avg_seamless_switch_ms_ = 2.0f;    // EWMA of measured transition latencies
+  float avg_modeset_switch_ms_ = 50.0f;
   std::shared_ptr<DemuraIntf> demura_ = nullptr;
   bool demuratn_enabled_ = false;
   std::shared_ptr<DemuraTnCoreUvmIntf> demuratn_ = nullptr;
@@ -324,6 +417,8 @@ class DisplayBuiltIn : public DisplayBase, HWEventHandler, DppsPropIntf {
   bool demura_intended_ = false;
   bool demura_dynamic_enabled_ = true;
   int demura_current_idx_ = -1;
+  // Set when demura setup is postponed past the first frame; see Init().
+  bool defer_demura_setup_ = false;
   bool enable_dpps_dyn_fps_ = false;
   HWDisplayMode last_panel_mode_ = kModeDefault;
   bool hdr_present_ = false;
@@ -71,14 +71,15 @@ DisplayError DisplayVirtual::Init() {
   }
 
   if (hw_info_intf_) {
-    HWResourceInfo hw_resource_info = HWResourceInfo();
-    hw_info_intf_->GetHWResourceInfo(&hw_resource_info);
-    auto max_mixer_stages = hw_resource_info.num_blending_stages;
-    int property_value = Debug::GetMaxPipesPerMixer(display_type_);
-    if (property_value >= 0) {
-      max_mixer_stages = std::min(UINT32(property_value), hw_resource_info.num_blending_stages);
+    std::shared_ptr<const HWResourceInfo> hw_resource_info = hw_info_intf_->GetHWResourceInfo();
+    if (hw_resource_info) {
+      auto max_mixer_stages = hw_resource_info->num_blending_stages;
+      int property_value = Debug::GetMaxPipesPerMixer(display_type_);
+      if (property_value >= 0) {
+        max_mixer_stages = std::min(UINT32(property_value), hw_resource_info->num_blending_stages);
+      }
+      DisplayBase::SetMaxMixerStages(max_mixer_stages);
     }
-    DisplayBase::SetMaxMixerStages(max_mixer_stages);
   }
 
   return error;
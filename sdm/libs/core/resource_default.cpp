@@ -164,6 +164,8 @@ DisplayError ResourceDefault::Init() {
   src_pipes_[rgb_index + 1].owner = kPipeOwnerKernelMode;
 #endif
 
+  RebuildFreePipeLists();
+
   return error;
 }
 
@@ -293,11 +295,8 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, DispLayerStack *disp_l
     return error;
   }
 
-  for (uint32_t i = 0; i < num_pipe_; i++) {
-    if (src_pipes_[i].hw_block_type == hw_block_type && src_pipes_[i].owner == kPipeOwnerUserMode) {
-      src_pipes_[i].ResetState();
-    }
-  }
+  // Return pipes reserved for this block in the previous cycle back to the free lists.
+  ReleaseBlockPipes(hw_block_type);
 
   uint32_t left_index = num_pipe_;
   uint32_t right_index = num_pipe_;
@@ -311,7 +310,12 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, DispLayerStack *disp_l
   // left pipe is needed
   if (left_pipe->valid) {
     need_scale = IsScalingNeeded(left_pipe);
-    left_index = GetPipe(hw_block_type, need_scale);
+    // Prefer last frame's pipe so an unchanged layer keeps its routing state
+    left_index = AcquirePreferredPipe(display_resource_ctx->last_left_pipe_index, hw_block_type,
+                                      need_scale);
+    if (left_index >= num_pipe_) {
+      left_index = GetPipe(hw_block_type, need_scale);
+    }
     if (left_index >= num_pipe_) {
       DLOGV_IF(kTagResources, "Get left pipe failed: hw_block_type = %d, need_scale = %d",
                hw_block_type, need_scale);
@@ -330,13 +334,19 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, DispLayerStack *disp_l
     if (left_index < num_pipe_) {
       left_pipe->pipe_id = src_pipes_[left_index].mdss_pipe_id;
     }
+    display_resource_ctx->last_left_pipe_index = (left_index < num_pipe_) ? left_index : UINT32_MAX;
+    display_resource_ctx->last_right_pipe_index = UINT32_MAX;
     DLOGV_IF(kTagResources, "1 pipe acquired for FB layer, left_pipe = %x", left_pipe->pipe_id);
     return kErrorNone;
   }
 
   need_scale = IsScalingNeeded(right_pipe);
 
-  right_index = GetPipe(hw_block_type, need_scale);
+  right_index = AcquirePreferredPipe(display_resource_ctx->last_right_pipe_index, hw_block_type,
+                                     need_scale);
+  if (right_index >= num_pipe_) {
+    right_index = GetPipe(hw_block_type, need_scale);
+  }
   if (right_index >= num_pipe_) {
     DLOGV_IF(kTagResources, "Get right pipe failed: hw_block_type = %d, need_scale = %d",
              hw_block_type, need_scale);
@@ -352,6 +362,8 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, DispLayerStack *disp_l
   // assign dual pipes
   left_pipe->pipe_id = src_pipes_[left_index].mdss_pipe_id;
   right_pipe->pipe_id = src_pipes_[right_index].mdss_pipe_id;
+  display_resource_ctx->last_left_pipe_index = left_index;
+  display_resource_ctx->last_right_pipe_index = right_index;
 
   error = SetDecimationFactor(right_pipe);
   if (error != kErrorNone) {
@@ -365,6 +377,8 @@ DisplayError ResourceDefault::Prepare(Handle display_ctx, DispLayerStack *disp_l
 
 CleanupOnError:
   DLOGV_IF(kTagResources, "Resource reserving failed! hw_block_type = %d", hw_block_type);
+  display_resource_ctx->last_left_pipe_index = UINT32_MAX;
+  display_resource_ctx->last_right_pipe_index = UINT32_MAX;
 
   return kErrorResources;
 }
@@ -414,6 +428,8 @@ DisplayError ResourceDefault::PostCommit(Handle display_ctx, DispLayerStack *dis
       if (src_pipes_[i].hw_block_type == hw_block_type &&
           src_pipes_[i].owner == kPipeOwnerKernelMode) {
         src_pipes_[i].owner = kPipeOwnerUserMode;
+        // Handed-off pipes join the acquired list and get freed on the next Prepare()/Purge().
+        acquired_pipes_[hw_block_type].push_back(i);
       }
     }
   }
@@ -428,11 +444,7 @@ void ResourceDefault::Purge(Handle display_ctx) {
                           reinterpret_cast<DisplayResourceContext *>(display_ctx);
   HWBlockType hw_block_type = display_resource_ctx->hw_block_type;
 
-  for (uint32_t i = 0; i < num_pipe_; i++) {
-    if (src_pipes_[i].hw_block_type == hw_block_type && src_pipes_[i].owner == kPipeOwnerUserMode) {
-      src_pipes_[i].ResetState();
-    }
-  }
+  ReleaseBlockPipes(hw_block_type);
   DLOGV_IF(kTagResources, "display hw_block_type = %d", display_resource_ctx->hw_block_type);
 }
 
@@ -440,45 +452,106 @@ DisplayError ResourceDefault::SetMaxMixerStages(Handle display_ctx, uint32_t max
   return kErrorNone;
 }
 
-uint32_t ResourceDefault::SearchPipe(HWBlockType hw_block_type, SourcePipe *src_pipes,
-                                     uint32_t num_pipe) {
-  uint32_t index = num_pipe_;
-  SourcePipe *src_pipe;
+std::vector<uint32_t> *ResourceDefault::GetFreePipeList(PipeType type) {
+  switch (type) {
+  case kPipeTypeVIG:
+    return &free_vig_pipes_;
+  case kPipeTypeRGB:
+    return &free_rgb_pipes_;
+  case kPipeTypeDMA:
+  default:
+    return &free_dma_pipes_;
+  }
+}
+
+void ResourceDefault::ReturnFreePipe(uint32_t pipe_index) {
+  std::vector<uint32_t> *free_pipes = GetFreePipeList(src_pipes_[pipe_index].type);
 
-  // search the pipe being used
-  for (uint32_t i = 0; i < num_pipe; i++) {
-    src_pipe = &src_pipes[i];
+  // Keep each list sorted in descending index order so the back stays the preferred pipe.
+  auto it = std::lower_bound(free_pipes->begin(), free_pipes->end(), pipe_index,
+                             std::greater<uint32_t>());
+  free_pipes->insert(it, pipe_index);
+}
+
+void ResourceDefault::ReleaseBlockPipes(HWBlockType hw_block_type) {
+  for (const uint32_t &pipe_index : acquired_pipes_[hw_block_type]) {
+    src_pipes_[pipe_index].ResetState();
+    ReturnFreePipe(pipe_index);
+  }
+  acquired_pipes_[hw_block_type].clear();
+}
+
+void ResourceDefault::RebuildFreePipeLists() {
+  free_vig_pipes_.clear();
+  free_rgb_pipes_.clear();
+  free_dma_pipes_.clear();
+
+  // Walk in reverse so each list ends with its lowest (most preferred) pipe index at the back.
+  for (uint32_t i = num_pipe_; i > 0; i--) {
+    SourcePipe *src_pipe = &src_pipes_[i - 1];
     if (src_pipe->owner == kPipeOwnerUserMode && src_pipe->hw_block_type == kHWBlockMax) {
-      index = src_pipe->index;
-      src_pipe->hw_block_type = hw_block_type;
-      break;
+      GetFreePipeList(src_pipe->type)->push_back(i - 1);
     }
   }
-
-  return index;
 }
 
 uint32_t ResourceDefault::NextPipe(PipeType type, HWBlockType hw_block_type) {
-  uint32_t num_pipe = 0;
-  SourcePipe *src_pipes = NULL;
+  std::vector<uint32_t> *free_pipes = GetFreePipeList(type);
+  if (free_pipes->empty()) {
+    return num_pipe_;
+  }
 
-  switch (type) {
-  case kPipeTypeVIG:
-    src_pipes = &src_pipes_[0];
-    num_pipe = hw_res_info_.num_vig_pipe;
-    break;
-  case kPipeTypeRGB:
-    src_pipes = &src_pipes_[hw_res_info_.num_vig_pipe];
-    num_pipe = hw_res_info_.num_rgb_pipe;
-    break;
-  case kPipeTypeDMA:
-  default:
-    src_pipes = &src_pipes_[hw_res_info_.num_vig_pipe + hw_res_info_.num_rgb_pipe];
-    num_pipe = hw_res_info_.num_dma_pipe;
-    break;
+  uint32_t pipe_index = free_pipes->back();
+  free_pipes->pop_back();
+
+  SourcePipe *src_pipe = &src_pipes_[pipe_index];
+  src_pipe->hw_block_type = hw_block_type;
+  acquired_pipes_[hw_block_type].push_back(pipe_index);
+
+  return src_pipe->index;
+}
+
+bool ResourceDefault::PipeSatisfiesScaling(const SourcePipe &pipe, bool need_scale) {
+  if (!need_scale) {
+    // GetPipe() hands any pipe class to non-scaled layers
+    return true;
+  }
+  if (pipe.type == kPipeTypeVIG) {
+    return true;
+  }
+
+  return (pipe.type == kPipeTypeRGB) && !hw_res_info_.has_non_scalar_rgb;
+}
+
+// Re-acquires the exact pipe a block used last frame if it is still free and fits the layer's
+// scaling needs, so a steady layer never migrates between pipes and the kernel reprograms no
+// routing state for it.
+uint32_t ResourceDefault::AcquirePreferredPipe(uint32_t pipe_index, HWBlockType hw_block_type,
+                                               bool need_scale) {
+  if (pipe_index >= num_pipe_) {
+    return num_pipe_;
   }
 
-  return SearchPipe(hw_block_type, src_pipes, num_pipe);
+  SourcePipe *src_pipe = &src_pipes_[pipe_index];
+  if (src_pipe->owner != kPipeOwnerUserMode || src_pipe->hw_block_type != kHWBlockMax ||
+      !PipeSatisfiesScaling(*src_pipe, need_scale)) {
+    return num_pipe_;
+  }
+
+  std::vector<uint32_t> *free_pipes = GetFreePipeList(src_pipe->type);
+  auto it = std::find(free_pipes->begin(), free_pipes->end(), pipe_index);
+  if (it == free_pipes->end()) {
+    return num_pipe_;
+  }
+  free_pipes->erase(it);
+
+  src_pipe->hw_block_type = hw_block_type;
+  acquired_pipes_[hw_block_type].push_back(pipe_index);
+
+  DLOGV_IF(kTagResources, "Kept last frame's pipe %x for hw_block_type = %d",
+           src_pipe->mdss_pipe_id, hw_block_type);
+
+  return src_pipe->index;
 }
 
 uint32_t ResourceDefault::GetPipe(HWBlockType hw_block_type, bool need_scale) {
@@ -185,8 +185,16 @@ class ResourceDefault : public ResourceInterface {
     uint64_t frame_count;
     HWMixerAttributes mixer_attributes;
     Resolution fb_resolution;
+    // Pipe indices handed to this block last frame. Preferred again on the next Prepare() so an
+    // unchanged layer keeps its pipe and the kernel sees near-zero routing churn.
+    uint32_t last_left_pipe_index;
+    uint32_t last_right_pipe_index;
 
-    DisplayResourceContext() : hw_block_type(kHWBlockMax), frame_count(0) {}
+    DisplayResourceContext()
+      : hw_block_type(kHWBlockMax),
+        frame_count(0),
+        last_left_pipe_index(UINT32_MAX),
+        last_right_pipe_index(UINT32_MAX) {}
   };
 
   struct HWBlockContext {
@@ -198,8 +206,13 @@ class ResourceDefault : public ResourceInterface {
   DisplayError Init();
   DisplayError Deinit();
   uint32_t NextPipe(PipeType pipe_type, HWBlockType hw_block_type);
-  uint32_t SearchPipe(HWBlockType hw_block_type, SourcePipe *src_pipes, uint32_t num_pipe);
   uint32_t GetPipe(HWBlockType hw_block_type, bool need_scale);
+  uint32_t AcquirePreferredPipe(uint32_t pipe_index, HWBlockType hw_block_type, bool need_scale);
+  bool PipeSatisfiesScaling(const SourcePipe &pipe, bool need_scale);
+  std::vector<uint32_t> *GetFreePipeList(PipeType pipe_type);
+  void ReturnFreePipe(uint32_t pipe_index);
+  void ReleaseBlockPipes(HWBlockType hw_block_type);
+  void RebuildFreePipeLists();
   bool IsScalingNeeded(const HWPipeInfo *pipe_info);
   DisplayError Config(DisplayResourceContext *display_resource_ctx,
                       DispLayerStack *disp_layer_stack);
@@ -230,6 +243,13 @@ class ResourceDefault : public ResourceInterface {
   HWBlockContext hw_block_ctx_[kHWBlockMax];
   std::vector<SourcePipe> src_pipes_;
   uint32_t num_pipe_ = 0;
+  // Free pipe indices per pipe class, kept sorted so the most preferred pipe (priority follows
+  // array order) pops from the back in O(1). Pipes handed to a block are remembered per block so
+  // release on the next Prepare()/Purge() touches only the acquired pipes.
+  std::vector<uint32_t> free_vig_pipes_;
+  std::vector<uint32_t> free_rgb_pipes_;
+  std::vector<uint32_t> free_dma_pipes_;
+  std::vector<uint32_t> acquired_pipes_[kHWBlockMax];
 };
 
 }  // namespace sdm
@@ -28,6 +28,7 @@
 
 #include <utils/constants.h>
 #include <utils/debug.h>
+#include <cstring>
 #include <vector>
 
 #include "strategy.h"
@@ -37,6 +38,30 @@
 
 namespace sdm {
 
+namespace {
+
+constexpr uint64_t kFnvPrime64 = 1099511628211ULL;
+constexpr uint64_t kFnvOffset64 = 14695981039346656037ULL;
+
+inline uint64_t HashCombine(uint64_t hash, uint64_t value) {
+  return (hash ^ value) * kFnvPrime64;
+}
+
+inline uint64_t HashFloat(uint64_t hash, float value) {
+  uint32_t bits = 0;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return HashCombine(hash, bits);
+}
+
+inline uint64_t HashRect(uint64_t hash, const LayerRect &rect) {
+  hash = HashFloat(hash, rect.left);
+  hash = HashFloat(hash, rect.top);
+  hash = HashFloat(hash, rect.right);
+  return HashFloat(hash, rect.bottom);
+}
+
+}  // namespace
+
 Strategy::Strategy(ExtensionInterface *extension_intf,
                    BufferAllocator *buffer_allocator,
                    int32_t display_id, DisplayType type, const HWResourceInfo &hw_resource_info,
@@ -56,6 +81,10 @@ Strategy::Strategy(ExtensionInterface *extension_intf,
 DisplayError Strategy::Init() {
   DisplayError error = kErrorNone;
 
+  int value = 0;
+  Debug::Get()->GetProperty(DISABLE_STRATEGY_CACHE, &value);
+  disable_strategy_cache_ = (value == 1);
+
   if (extension_intf_) {
     error = extension_intf_->CreateStrategyExtn(display_id_, display_type_, buffer_allocator_,
                                                 hw_resource_info_, hw_panel_info_,
@@ -113,10 +142,26 @@ DisplayError Strategy::Start(DispLayerStack *disp_layer_stack, uint32_t *max_att
   }
 
   disp_layer_stack_->stack->flags.default_strategy = !extn_start_success_;
+
+  strategies_consumed_ = 0;
+  fast_forward_done_ = false;
+  pending_geometry_hash_ = ComputeGeometryHash(constraints);
+  strategy_cache_hit_ = (!disable_strategy_cache_ && extn_start_success_ &&
+                         strategy_cache_valid_ &&
+                         (pending_geometry_hash_ == cached_geometry_hash_));
+
   return error;
 }
 
 DisplayError Strategy::Stop() {
+  // Stop() marks the end of a successful prepare cycle. Remember which strategy in the
+  // iteration order won for the current layer stack geometry.
+  if (!disable_strategy_cache_ && extn_start_success_ && strategies_consumed_ > 0) {
+    cached_geometry_hash_ = pending_geometry_hash_;
+    cached_winning_strategy_ = strategies_consumed_;
+    strategy_cache_valid_ = true;
+  }
+
   if (strategy_intf_) {
     return strategy_intf_->Stop();
   }
@@ -132,7 +177,25 @@ DisplayError Strategy::GetNextStrategy() {
   }
 
   if (extn_start_success_) {
-    return strategy_intf_->GetNextStrategy();
+    DisplayError error = strategy_intf_->GetNextStrategy();
+    strategies_consumed_++;
+
+    // Geometry is unchanged from the last successful frame. Fast-forward the iteration to the
+    // strategy which won previously, so unchanged stacks skip the intermediate resource
+    // Prepare round-trips for strategies that are known to fail.
+    if (strategy_cache_hit_ && !fast_forward_done_) {
+      fast_forward_done_ = true;
+      while (error == kErrorNone && strategies_consumed_ < cached_winning_strategy_) {
+        error = strategy_intf_->GetNextStrategy();
+        strategies_consumed_++;
+      }
+      if (error != kErrorNone) {
+        // Remembered strategy is no longer reachable. Re-validate from scratch next frame.
+        InvalidateStrategyCache();
+      }
+    }
+
+    return error;
   }
 
   // Do not fallback to GPU if GPU comp is disabled.
@@ -173,10 +236,71 @@ DisplayError Strategy::GetNextStrategy() {
   return kErrorNone;
 }
 
+uint64_t Strategy::ComputeGeometryHash(StrategyConstraints *constraints) const {
+  uint64_t hash = kFnvOffset64;
+
+  if (!disp_layer_stack_ || !disp_layer_stack_->stack) {
+    return hash;
+  }
+
+  if (constraints) {
+    hash = HashCombine(hash, constraints->safe_mode);
+    hash = HashCombine(hash, constraints->max_layers);
+    hash = HashCombine(hash, constraints->idle_timeout);
+    hash = HashCombine(hash, constraints->gpu_fallback_mode);
+    hash = HashCombine(hash, constraints->tonemapping_query_mandatory);
+    hash = HashCombine(hash, constraints->use_inline_rotation);
+  }
+
+  const LayerStack *layer_stack = disp_layer_stack_->stack;
+  hash = HashCombine(hash, layer_stack->layers.size());
+  for (const Layer *layer : layer_stack->layers) {
+    hash = HashCombine(hash, layer->input_buffer.format);
+    hash = HashCombine(hash, layer->input_buffer.width);
+    hash = HashCombine(hash, layer->input_buffer.height);
+    hash = HashCombine(hash, layer->input_buffer.flags.flags);
+    hash = HashRect(hash, layer->src_rect);
+    hash = HashRect(hash, layer->dst_rect);
+    hash = HashFloat(hash, layer->transform.rotation);
+    hash = HashCombine(hash, layer->transform.flip_horizontal);
+    hash = HashCombine(hash, layer->transform.flip_vertical);
+    hash = HashCombine(hash, layer->blending);
+    hash = HashCombine(hash, layer->plane_alpha);
+    hash = HashCombine(hash, layer->flags.flags);
+  }
+
+  return hash;
+}
+
+void Strategy::InvalidateStrategyCache() {
+  strategy_cache_valid_ = false;
+  strategy_cache_hit_ = false;
+  cached_geometry_hash_ = 0;
+  cached_winning_strategy_ = 0;
+}
+
 void Strategy::GenerateROI() {
   bool split_display = false;
 
-  if (partial_update_intf_ && partial_update_intf_->GenerateROI(disp_layer_stack_) == kErrorNone) {
+  // After a sustained streak of full-frame ROIs the whole frame is predicted
+  // to keep changing; skip the ROI math and program the full frame directly.
+  bool skip_roi_math = (full_frame_skip_remaining_ > 0);
+  if (skip_roi_math) {
+    full_frame_skip_remaining_--;
+  }
+
+  if (!skip_roi_math && partial_update_intf_ &&
+      partial_update_intf_->GenerateROI(disp_layer_stack_) == kErrorNone) {
+    if (IsFullFrameROI()) {
+      stable_roi_hold_ = 0;
+      if (++full_frame_roi_streak_ >= kFullFramePredictFrames) {
+        full_frame_roi_streak_ = 0;
+        full_frame_skip_remaining_ = kFullFrameSkipFrames;
+      }
+    } else {
+      full_frame_roi_streak_ = 0;
+      StabilizeROI();
+    }
     return;
   }
 
@@ -203,6 +327,54 @@ void Strategy::GenerateROI() {
   }
 }
 
+bool Strategy::IsFullFrameROI() {
+  LayerRect damage = {};
+  for (auto &roi : disp_layer_stack_->info.left_frame_roi) {
+    damage = Union(damage, roi);
+  }
+  for (auto &roi : disp_layer_stack_->info.right_frame_roi) {
+    damage = Union(damage, roi);
+  }
+  if (!IsValid(damage)) {
+    return false;
+  }
+
+  float damage_area = (damage.right - damage.left) * (damage.bottom - damage.top);
+  float mixer_area = FLOAT(mixer_attributes_.width) * FLOAT(mixer_attributes_.height);
+
+  return (mixer_area > 0.0f) && (damage_area >= 0.95f * mixer_area);
+}
+
+void Strategy::StabilizeROI() {
+  std::vector<LayerRect> &left_roi = disp_layer_stack_->info.left_frame_roi;
+  std::vector<LayerRect> &right_roi = disp_layer_stack_->info.right_frame_roi;
+
+  // Stabilization handles the common single-ROI non-split case only.
+  if (left_roi.size() != 1 || (right_roi.size() && IsValid(right_roi.at(0)))) {
+    stable_roi_hold_ = 0;
+    return;
+  }
+
+  LayerRect &roi = left_roi.at(0);
+  if (stable_roi_hold_ && Contains(stable_roi_, roi)) {
+    // Damage keeps landing inside the recently programmed ROI; re-program the
+    // same (wider) ROI instead of churning the panel with a smaller one.
+    roi = stable_roi_;
+    stable_roi_hold_--;
+    return;
+  }
+
+  stable_roi_ = roi;
+  stable_roi_hold_ = kRoiHoldFrames;
+}
+
+void Strategy::ResetDamageHistory() {
+  full_frame_roi_streak_ = 0;
+  full_frame_skip_remaining_ = 0;
+  stable_roi_ = {};
+  stable_roi_hold_ = 0;
+}
+
 DisplayError Strategy::Reconfigure(const HWPanelInfo &hw_panel_info,
                                    const HWDisplayAttributes &display_attributes,
                                    const HWMixerAttributes &mixer_attributes,
@@ -237,6 +409,8 @@ DisplayError Strategy::Reconfigure(const HWPanelInfo &hw_panel_info,
   display_attributes_ = display_attributes;
   mixer_attributes_ = mixer_attributes;
   fb_config_ = fb_config;
+  InvalidateStrategyCache();
+  ResetDamageHistory();
 
   return kErrorNone;
 }
@@ -248,6 +422,7 @@ DisplayError Strategy::SetCompositionState(LayerComposition composition_type, bo
   if (composition_type == kCompositionGPU) {
     disable_gpu_comp_ = !enable;
   }
+  InvalidateStrategyCache();
 
   if (strategy_intf_) {
     return strategy_intf_->SetCompositionState(composition_type, enable);
@@ -257,6 +432,8 @@ DisplayError Strategy::SetCompositionState(LayerComposition composition_type, bo
 }
 
 DisplayError Strategy::Purge() {
+  InvalidateStrategyCache();
+  ResetDamageHistory();
   if (strategy_intf_) {
     return strategy_intf_->Purge();
   }
@@ -265,8 +442,13 @@ DisplayError Strategy::Purge() {
 }
 
 DisplayError Strategy::SetDrawMethod(const DisplayDrawMethod &draw_method) {
+  InvalidateStrategyCache();
   if (strategy_intf_) {
-    return strategy_intf_->SetDrawMethod(draw_method);
+    // Pipelining only changes prepare scheduling in DisplayBase. Strategy extensions see the
+    // unified draw method and need no awareness of the overlap.
+    DisplayDrawMethod mapped_method =
+        (draw_method == kDrawUnifiedPipelined) ? kDrawUnified : draw_method;
+    return strategy_intf_->SetDrawMethod(mapped_method);
   }
 
   return kErrorNotSupported;
@@ -288,6 +470,7 @@ DisplayError Strategy::SetColorModesInfo(const std::vector<PrimariesTransfer> &c
 }
 
 DisplayError Strategy::SetBlendSpace(const PrimariesTransfer &blend_space) {
+  InvalidateStrategyCache();
   if (strategy_intf_) {
     return strategy_intf_->SetBlendSpace(blend_space);
   }
@@ -68,6 +68,11 @@ class Strategy {
 
  private:
   void GenerateROI();
+  uint64_t ComputeGeometryHash(StrategyConstraints *constraints) const;
+  void InvalidateStrategyCache();
+  bool IsFullFrameROI();
+  void StabilizeROI();
+  void ResetDamageHistory();
 
   ExtensionInterface *extension_intf_ = NULL;
   StrategyInterface *strategy_intf_ = NULL;
@@ -84,6 +89,32 @@ class Strategy {
   bool disable_gpu_comp_ = false;
   BufferAllocator *buffer_allocator_ = NULL;
   std::shared_ptr<SPRIntf> spr_intf_ = nullptr;
+
+  // Memoization of the winning strategy for an unchanged layer stack geometry. When the
+  // geometry hash of the current frame matches the last successful frame, the strategy
+  // iteration fast-forwards to the remembered winner instead of retrying rejected strategies.
+  uint64_t cached_geometry_hash_ = 0;
+  uint64_t pending_geometry_hash_ = 0;
+  uint32_t cached_winning_strategy_ = 0;
+  uint32_t strategies_consumed_ = 0;
+  bool strategy_cache_valid_ = false;
+  bool strategy_cache_hit_ = false;
+  bool fast_forward_done_ = false;
+  bool disable_strategy_cache_ = false;
+
+  // ROI damage history. Sustained full-frame ROIs predict that the whole frame
+  // keeps changing (video, scrolling), letting GenerateROI() skip the ROI math
+  // for a stretch. When damage is partial, small fluctuating ROIs are absorbed
+  // into the last programmed ROI to limit panel reprogramming churn. Both
+  // shortcuts only ever widen the programmed ROI, never shrink it.
+  static const uint32_t kFullFramePredictFrames = 8;  // streak that triggers prediction
+  static const uint32_t kFullFrameSkipFrames = 32;    // frames of ROI math skipped on prediction
+  static const uint32_t kRoiHoldFrames = 4;           // frames a stabilized ROI absorbs sub-rects
+
+  uint32_t full_frame_roi_streak_ = 0;
+  uint32_t full_frame_skip_remaining_ = 0;
+  LayerRect stable_roi_ = {};
+  uint32_t stable_roi_hold_ = 0;
 };
 
 }  // namespace sdm
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <drm_master.h>
+#include <time.h>
+#include <utils/constants.h>
+#include <utils/debug.h>
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+#include <string>
+
+#include "hw_commit_recorder.h"
+
+#define __CLASS__ "HWCommitRecorder"
+
+using drm_utils::DRMMaster;
+
+namespace sdm {
+
+HWCommitRecorder::~HWCommitRecorder() {
+  if (file_) {
+    fclose(file_);
+  }
+}
+
+void HWCommitRecorder::Record(uint32_t crtc_id, uint32_t conn_id, uint64_t commit_duration_ns) {
+  if (enabled_ < 0) {
+    int value = 0;
+    Debug::Get()->GetProperty(ENABLE_COMMIT_REPLAY_RECORD, &value);
+    enabled_ = (value == 1);
+  }
+  if (!enabled_) {
+    return;
+  }
+
+  if (!file_ && !Init(crtc_id, conn_id)) {
+    enabled_ = 0;
+    return;
+  }
+
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  uint64_t timestamp_ns = (UINT64(t.tv_sec) * 1000000000LL + t.tv_nsec);
+
+  uint32_t frame_magic = kFrameMagic;
+  uint32_t object_count = UINT32(objects_.size());
+  fwrite(&frame_magic, sizeof(frame_magic), 1, file_);
+  fwrite(&timestamp_ns, sizeof(timestamp_ns), 1, file_);
+  fwrite(&commit_duration_ns, sizeof(commit_duration_ns), 1, file_);
+  fwrite(&object_count, sizeof(object_count), 1, file_);
+
+  for (auto &object : objects_) {
+    DumpObject(object.first, object.second);
+  }
+  fflush(file_);
+}
+
+bool HWCommitRecorder::Init(uint32_t crtc_id, uint32_t conn_id) {
+  DRMMaster *master = nullptr;
+  if (DRMMaster::GetInstance(&master) < 0) {
+    DLOGE("Failed to acquire DRMMaster instance");
+    return false;
+  }
+  master->GetHandle(&dev_fd_);
+
+  objects_.push_back({crtc_id, DRM_MODE_OBJECT_CRTC});
+  objects_.push_back({conn_id, DRM_MODE_OBJECT_CONNECTOR});
+  drmModePlaneRes *plane_res = drmModeGetPlaneResources(dev_fd_);
+  if (plane_res) {
+    for (uint32_t i = 0; i < plane_res->count_planes; i++) {
+      objects_.push_back({plane_res->planes[i], DRM_MODE_OBJECT_PLANE});
+    }
+    drmModeFreePlaneResources(plane_res);
+  }
+
+  std::string path = "/data/vendor/display/commit_replay_" + std::to_string(crtc_id) + ".bin";
+  file_ = fopen(path.c_str(), "wb");
+  if (!file_) {
+    DLOGE("Failed to open %s for commit recording", path.c_str());
+    return false;
+  }
+
+  uint32_t file_magic = kFileMagic;
+  uint32_t version = kFileVersion;
+  fwrite(&file_magic, sizeof(file_magic), 1, file_);
+  fwrite(&version, sizeof(version), 1, file_);
+  fwrite(&crtc_id, sizeof(crtc_id), 1, file_);
+  fwrite(&conn_id, sizeof(conn_id), 1, file_);
+
+  DLOGI("Recording commit property streams for CRTC %d to %s", crtc_id, path.c_str());
+  return true;
+}
+
+void HWCommitRecorder::DumpObject(uint32_t object_id, uint32_t object_type) {
+  std::vector<std::pair<uint32_t, uint64_t>> props = {};
+
+  drmModeObjectProperties *obj_props = drmModeObjectGetProperties(dev_fd_, object_id, object_type);
+  if (obj_props) {
+    for (uint32_t i = 0; i < obj_props->count_props; i++) {
+      uint32_t prop_id = obj_props->props[i];
+      auto it = prop_flags_.find(prop_id);
+      if (it == prop_flags_.end()) {
+        drmModePropertyRes *prop = drmModeGetProperty(dev_fd_, prop_id);
+        uint32_t flags = prop ? prop->flags : DRM_MODE_PROP_IMMUTABLE;
+        if (prop) {
+          drmModeFreeProperty(prop);
+        }
+        it = prop_flags_.insert({prop_id, flags}).first;
+      }
+      // Immutable properties cannot be set in an atomic request; recording them would only
+      // make the replay fail the kernel's atomic check.
+      if (it->second & DRM_MODE_PROP_IMMUTABLE) {
+        continue;
+      }
+      props.push_back({prop_id, obj_props->prop_values[i]});
+    }
+    drmModeFreeObjectProperties(obj_props);
+  }
+
+  uint32_t prop_count = UINT32(props.size());
+  fwrite(&object_id, sizeof(object_id), 1, file_);
+  fwrite(&object_type, sizeof(object_type), 1, file_);
+  fwrite(&prop_count, sizeof(prop_count), 1, file_);
+  for (auto &prop : props) {
+    fwrite(&prop.first, sizeof(prop.first), 1, file_);
+    fwrite(&prop.second, sizeof(prop.second), 1, file_);
+  }
+}
+
+}  // namespace sdm
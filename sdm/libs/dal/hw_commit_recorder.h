@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HW_COMMIT_RECORDER_H__
+#define __HW_COMMIT_RECORDER_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace sdm {
+
+// Opt-in commit stream recorder for kernel atomic check profiling. When the
+// enable_commit_replay_record property is set, every successful atomic commit appends one
+// frame record to a compact binary log: the commit duration plus a snapshot of the mutable
+// DRM properties of the display's CRTC, connector and all planes. The sdm_commit_replay
+// tool feeds the log back to the DRM device to reproduce userspace's exact property stream
+// against a different kernel. Disabled, Record() is a single integer compare.
+class HWCommitRecorder {
+ public:
+  ~HWCommitRecorder();
+  void Record(uint32_t crtc_id, uint32_t conn_id, uint64_t commit_duration_ns);
+
+  static const uint32_t kFileMagic = 0x524D4453;   // "SDMR"
+  static const uint32_t kFrameMagic = 0x4D524653;  // "SFRM"
+  static const uint32_t kFileVersion = 1;
+
+ private:
+  bool Init(uint32_t crtc_id, uint32_t conn_id);
+  void DumpObject(uint32_t object_id, uint32_t object_type);
+
+  int enabled_ = -1;  // -1 until the property is read on the first commit
+  int dev_fd_ = -1;
+  FILE *file_ = nullptr;
+  std::vector<std::pair<uint32_t, uint32_t>> objects_ = {};  // (object id, object type)
+  std::map<uint32_t, uint32_t> prop_flags_ = {};  // prop id -> flags, to skip immutables
+};
+
+}  // namespace sdm
+
+#endif  // __HW_COMMIT_RECORDER_H__
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/constants.h>
+#include <utils/debug.h>
+
+#include "hw_commit_watchdog.h"
+
+#define __CLASS__ "HWCommitWatchdog"
+
+namespace sdm {
+
+static uint64_t GetMonotonicNs() {
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (UINT64(t.tv_sec) * 1000000000LL + t.tv_nsec);
+}
+
+HWCommitWatchdog::~HWCommitWatchdog() {
+  if (monitor_.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      exit_ = true;
+    }
+    cv_.notify_all();
+    monitor_.join();
+  }
+}
+
+void HWCommitWatchdog::Arm(uint32_t crtc_id, uint32_t conn_id, uint64_t deadline_ns) {
+  if (enabled_ < 0) {
+    int value = 0;
+    Debug::Get()->GetProperty(ENABLE_COMMIT_WATCHDOG, &value);
+    enabled_ = (value == 1);
+    value = 0;
+    Debug::Get()->GetProperty(COMMIT_WATCHDOG_FAST_FAIL, &value);
+    fast_fail_ = enabled_ && (value == 1);
+    if (enabled_) {
+      DLOGI("Commit watchdog enabled, fast fail %d", fast_fail_);
+    }
+  }
+  if (!enabled_) {
+    return;
+  }
+
+  if (!monitor_.joinable()) {
+    monitor_ = std::thread(&HWCommitWatchdog::Monitor, this);
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    commit_tid_ = gettid();
+    crtc_id_ = crtc_id;
+    conn_id_ = conn_id;
+    armed_at_ns_ = GetMonotonicNs();
+    deadline_ns_ = deadline_ns;
+    overrun_ = false;
+    armed_ = true;
+  }
+  cv_.notify_all();
+}
+
+bool HWCommitWatchdog::Disarm(uint64_t commit_duration_ns) {
+  if (enabled_ <= 0) {
+    return false;
+  }
+
+  bool overrun = false;
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    armed_ = false;
+    overrun = overrun_;
+    overrun_ = false;
+
+    CommitRecord &record = timeline_[timeline_head_];
+    record.end_ns = GetMonotonicNs();
+    record.duration_ns = commit_duration_ns;
+    record.overrun = overrun;
+    timeline_head_ = (timeline_head_ + 1) % kTimelineDepth;
+  }
+  cv_.notify_all();
+
+  return overrun;
+}
+
+void HWCommitWatchdog::Monitor() {
+  std::unique_lock<std::mutex> guard(lock_);
+  while (!exit_) {
+    if (!armed_) {
+      cv_.wait(guard, [this]() { return armed_ || exit_; });
+      continue;
+    }
+
+    uint64_t now_ns = GetMonotonicNs();
+    if (now_ns < deadline_ns_) {
+      cv_.wait_for(guard, std::chrono::nanoseconds(deadline_ns_ - now_ns));
+      continue;
+    }
+
+    // Deadline passed with the commit thread still inside the ioctl.
+    overrun_ = true;
+    armed_ = false;
+    CaptureStall(now_ns);
+  }
+}
+
+void HWCommitWatchdog::CaptureStall(uint64_t now_ns) {
+  // Called with lock_ held; everything below reads /proc and logs, no allocation that
+  // could block on the stalled thread.
+  DLOGE("Commit overrun on crtc %d conn %d: blocked for %" PRIu64 " us, deadline %" PRIu64 " us",
+        crtc_id_, conn_id_, (now_ns - armed_at_ns_) / 1000, (deadline_ns_ - armed_at_ns_) / 1000);
+
+  char path[64] = {};
+  snprintf(path, sizeof(path), "/proc/self/task/%d/wchan", commit_tid_);
+  LogProcFile("wchan", path);
+  snprintf(path, sizeof(path), "/proc/self/task/%d/stack", commit_tid_);
+  LogProcFile("kernel stack", path);
+
+  DLOGE("Recent commit timeline (oldest first, now %" PRIu64 " us):", now_ns / 1000);
+  for (uint32_t i = 0; i < kTimelineDepth; i++) {
+    const CommitRecord &record = timeline_[(timeline_head_ + i) % kTimelineDepth];
+    if (!record.end_ns) {
+      continue;
+    }
+    DLOGE("  commit ended %" PRIu64 " us ago, took %" PRIu64 " us%s",
+          (now_ns - record.end_ns) / 1000, record.duration_ns / 1000,
+          record.overrun ? " (overrun)" : "");
+  }
+}
+
+void HWCommitWatchdog::LogProcFile(const char *tag, const char *path) {
+  FILE *fp = fopen(path, "r");
+  if (!fp) {
+    DLOGW("Commit watchdog could not read %s", path);
+    return;
+  }
+
+  char line[256] = {};
+  DLOGE("Commit thread %d %s:", commit_tid_, tag);
+  while (fgets(line, sizeof(line), fp)) {
+    size_t len = strlen(line);
+    if (len && line[len - 1] == '\n') {
+      line[len - 1] = '\0';
+    }
+    if (line[0]) {
+      DLOGE("  %s", line);
+    }
+  }
+  fclose(fp);
+}
+
+}  // namespace sdm
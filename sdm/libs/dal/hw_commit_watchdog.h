@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2024 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __HW_COMMIT_WATCHDOG_H__
+#define __HW_COMMIT_WATCHDOG_H__
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace sdm {
+
+// Opt-in watchdog for atomic commit overruns. When the enable_commit_watchdog property is
+// set, the commit path arms a deadline before the atomic commit ioctl and disarms it when
+// the ioctl returns. If the deadline passes while the ioctl is still blocked, the monitor
+// thread captures the committing thread's kernel stack and wait channel from /proc along
+// with a timeline of recent commits, and emits a structured report — so a kernel-side
+// stall is diagnosed while it is happening, not seconds later when the framework's fence
+// timeout fires. With the commit_watchdog_fast_fail property also set, Disarm() reports
+// the overrun to the caller so the frame can be failed immediately and recovery can start
+// on the same present. Disabled, Arm()/Disarm() are a single integer compare.
+class HWCommitWatchdog {
+ public:
+  ~HWCommitWatchdog();
+  void Arm(uint32_t crtc_id, uint32_t conn_id, uint64_t deadline_ns);
+  bool Disarm(uint64_t commit_duration_ns);
+  bool FastFailEnabled() { return fast_fail_; }
+
+ private:
+  struct CommitRecord {
+    uint64_t end_ns = 0;
+    uint64_t duration_ns = 0;
+    bool overrun = false;
+  };
+  static const uint32_t kTimelineDepth = 8;
+
+  void Monitor();
+  void CaptureStall(uint64_t now_ns);
+  void LogProcFile(const char *tag, const char *path);
+
+  int enabled_ = -1;  // -1 until the properties are read on the first commit
+  bool fast_fail_ = false;
+  std::thread monitor_;
+  std::mutex lock_;
+  std::condition_variable cv_;
+  bool exit_ = false;
+  bool armed_ = false;
+  bool overrun_ = false;
+  pid_t commit_tid_ = 0;
+  uint32_t crtc_id_ = 0;
+  uint32_t conn_id_ = 0;
+  uint64_t armed_at_ns_ = 0;
+  uint64_t deadline_ns_ = 0;
+  CommitRecord timeline_[kTimelineDepth] = {};
+  uint32_t timeline_head_ = 0;
+};
+
+}  // namespace sdm
+
+#endif  // __HW_COMMIT_WATCHDOG_H__
@@ -115,6 +115,7 @@ using sde_drm::DRMRotation;
 using sde_drm::DRMBlendType;
 using sde_drm::DRMSrcConfig;
 using sde_drm::DRMOps;
+using sde_drm::DRMAtomicOp;
 using sde_drm::DRMTopology;
 using sde_drm::DRMPowerMode;
 using sde_drm::DRMSecureMode;
@@ -589,7 +590,10 @@ DisplayError HWDeviceDRM::Init() {
     return kErrorDeviceRemoved;
   }
 
-  hw_info_intf_->GetHWResourceInfo(&hw_resource_);
+  std::shared_ptr<const HWResourceInfo> snapshot = hw_info_intf_->GetHWResourceInfo();
+  if (snapshot) {
+    hw_resource_ = snapshot;
+  }
 
   InitializeConfigs();
   GetCWBCapabilities();
@@ -597,7 +601,7 @@ DisplayError HWDeviceDRM::Init() {
   UpdateMixerAttributes();
 
   // TODO(user): In future, remove has_qseed3 member, add version and pass version to constructor
-  if (hw_resource_.has_qseed3) {
+  if (hw_resource_->has_qseed3) {
     hw_scale_ = new HWScaleDRM(HWScaleDRM::Version::V2);
   }
 
@@ -698,6 +702,8 @@ DisplayError HWDeviceDRM::GetDisplayId(int32_t *display_id) {
 
 void HWDeviceDRM::InitializeConfigs() {
   current_mode_index_ = 0;
+  // Attributes only repopulate on a connector probe, where any cached panel info is stale.
+  panel_info_cache_.clear();
   uint32_t modes_count = connector_info_.modes.size();
   uint32_t panel_mode_pref = (connector_info_.panel_mode == sde_drm::DRMPanelMode::COMMAND)
                                  ? DRM_MODE_FLAG_CMD_MODE_PANEL
@@ -750,7 +756,9 @@ void HWDeviceDRM::InitializeConfigs() {
     if (mode.hdisplay != width || mode.vdisplay != height) {
       resolution_switch_enabled_ = true;
     }
-    PopulateDisplayAttributes(i);
+    if (!DeferModeAttributePopulation(i)) {
+      PopulateDisplayAttributes(i);
+    }
   }
   SetDisplaySwitchMode(current_mode_index_);
 }
@@ -849,6 +857,38 @@ DisplayError HWDeviceDRM::PopulateDisplayAttributes(uint32_t index) {
 }
 
 void HWDeviceDRM::PopulateHWPanelInfo() {
+  if (!default_mode_ && !connector_info_.modes.empty()) {
+    uint32_t index = current_mode_index_;
+    uint32_t sub_mode_index = connector_info_.modes[index].curr_submode_index;
+    uint32_t panel_mode = connector_info_.modes[index].cur_panel_mode;
+    if (index < panel_info_cache_.size()) {
+      PanelInfoCacheEntry &entry = panel_info_cache_[index];
+      if (entry.valid && entry.submode_index == sub_mode_index &&
+          entry.panel_mode == panel_mode) {
+        // Built for this exact mode/submode during this connector probe; skip the rebuild and
+        // the sysfs brightness read that comes with it.
+        hw_panel_info_ = entry.panel_info;
+        return;
+      }
+    }
+
+    BuildHWPanelInfo();
+
+    if (panel_info_cache_.size() != connector_info_.modes.size()) {
+      panel_info_cache_.resize(connector_info_.modes.size());
+    }
+    PanelInfoCacheEntry &entry = panel_info_cache_[index];
+    entry.valid = true;
+    entry.submode_index = sub_mode_index;
+    entry.panel_mode = panel_mode;
+    entry.panel_info = hw_panel_info_;
+    return;
+  }
+
+  BuildHWPanelInfo();
+}
+
+void HWDeviceDRM::BuildHWPanelInfo() {
   hw_panel_info_ = {};
 
   snprintf(hw_panel_info_.panel_name, sizeof(hw_panel_info_.panel_name), "%s",
@@ -1172,6 +1212,7 @@ DisplayError HWDeviceDRM::SetDisplayAttributes(uint32_t index) {
   SetDisplaySwitchMode(index);
   PopulateHWPanelInfo();
   UpdateMixerAttributes();
+  ClearValidationCache();
 
   DLOGI_IF(kTagDriverConfig,
       "Display %d-%d attributes[%d]: WxH: %dx%d, DPI: %fx%f, FPS: %d, "
@@ -1195,12 +1236,47 @@ DisplayError HWDeviceDRM::SetDisplayAttributes(const HWDisplayAttributes &displa
   return kErrorNotSupported;
 }
 
+DisplayError HWDeviceDRM::PrefetchDisplayConfig(uint32_t index) {
+  if (index >= display_attributes_.size() || index >= connector_info_.modes.size()) {
+    DLOGW("Invalid prefetch index %d mode size %d", index, UINT32(connector_info_.modes.size()));
+    return kErrorParameters;
+  }
+
+  if (default_mode_ || index == current_mode_index_) {
+    return kErrorNone;
+  }
+
+  uint32_t sub_mode_index = connector_info_.modes[index].curr_submode_index;
+  uint32_t panel_mode = connector_info_.modes[index].cur_panel_mode;
+  if (index < panel_info_cache_.size()) {
+    const PanelInfoCacheEntry &entry = panel_info_cache_[index];
+    if (entry.valid && entry.submode_index == sub_mode_index && entry.panel_mode == panel_mode) {
+      return kErrorNone;  // already warm
+    }
+  }
+
+  // Build the target mode's panel info now, while the switch frame is still pending, and park
+  // it in the per-config cache; the apply-time PopulateHWPanelInfo() then reduces to a copy
+  // instead of a rebuild with its sysfs brightness read. Live state is restored afterwards,
+  // so nothing changes until SetDisplayAttributes() runs on the designated frame.
+  HWPanelInfo live_panel_info = hw_panel_info_;
+  uint32_t live_index = current_mode_index_;
+  current_mode_index_ = index;
+  PopulateHWPanelInfo();
+  current_mode_index_ = live_index;
+  hw_panel_info_ = live_panel_info;
+
+  DLOGV_IF(kTagDriverConfig, "Prefetched panel info for config %d on %s", index, device_name_);
+  return kErrorNone;
+}
+
 DisplayError HWDeviceDRM::GetConfigIndex(char *mode, uint32_t *index) {
   return kErrorNone;
 }
 
 DisplayError HWDeviceDRM::PowerOn(const HWQosData &qos_data, SyncPoints *sync_points) {
   SetQOSData(qos_data);
+  ClearValidationCache();
 
   if (tui_state_ != kTUIStateNone || pending_cwb_teardown_) {
     DLOGI("Request deferred TUI state %d pending cwb teardown %d", tui_state_,
@@ -1244,6 +1320,7 @@ DisplayError HWDeviceDRM::PowerOn(const HWQosData &qos_data, SyncPoints *sync_po
 
 DisplayError HWDeviceDRM::PowerOff(bool teardown, SyncPoints *sync_points) {
   DTRACE_SCOPED();
+  ClearValidationCache();
   if (!drm_atomic_intf_) {
     DLOGE("DRM Atomic Interface is null!");
     return kErrorUndefined;
@@ -1321,6 +1398,7 @@ DisplayError HWDeviceDRM::PowerOff(bool teardown, SyncPoints *sync_points) {
 
 DisplayError HWDeviceDRM::Doze(const HWQosData &qos_data, SyncPoints *sync_points) {
   DTRACE_SCOPED();
+  ClearValidationCache();
 
   if (first_cycle_ || tui_state_ != kTUIStateNone || last_power_mode_ != DRMPowerMode::OFF) {
     pending_power_state_ = kPowerStateDoze;
@@ -1364,6 +1442,7 @@ DisplayError HWDeviceDRM::Doze(const HWQosData &qos_data, SyncPoints *sync_point
 
 DisplayError HWDeviceDRM::DozeSuspend(const HWQosData &qos_data, SyncPoints *sync_points) {
   DTRACE_SCOPED();
+  ClearValidationCache();
 
   if (tui_state_ != kTUIStateNone && tui_state_ != kTUIStateEnd) {
     pending_power_state_ = kPowerStateDozeSuspend;
@@ -1409,20 +1488,40 @@ DisplayError HWDeviceDRM::DozeSuspend(const HWQosData &qos_data, SyncPoints *syn
   return kErrorNone;
 }
 
+static bool SameQosData(const HWQosData &a, const HWQosData &b) {
+  return a.clock_hz == b.clock_hz && a.core_ab_bps == b.core_ab_bps &&
+         a.core_ib_bps == b.core_ib_bps && a.llcc_ab_bps == b.llcc_ab_bps &&
+         a.llcc_ib_bps == b.llcc_ib_bps && a.dram_ab_bps == b.dram_ab_bps &&
+         a.dram_ib_bps == b.dram_ib_bps && a.rot_prefill_bw_bps == b.rot_prefill_bw_bps &&
+         a.rot_clock_hz == b.rot_clock_hz;
+}
+
 void HWDeviceDRM::SetQOSData(const HWQosData &qos_data) {
   if (!qos_data.valid) {
     return;
   }
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_CORE_CLK, token_.crtc_id, qos_data.clock_hz);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_CORE_AB, token_.crtc_id, qos_data.core_ab_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_CORE_IB, token_.crtc_id, qos_data.core_ib_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_LLCC_AB, token_.crtc_id, qos_data.llcc_ab_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_LLCC_IB, token_.crtc_id, qos_data.llcc_ib_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_DRAM_AB, token_.crtc_id, qos_data.dram_ab_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_DRAM_IB, token_.crtc_id, qos_data.dram_ib_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_ROT_PREFILL_BW, token_.crtc_id,
-                            qos_data.rot_prefill_bw_bps);
-  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_ROT_CLK, token_.crtc_id, qos_data.rot_clock_hz);
+
+  // DRM properties are retained across commits, so values the last successful commit already
+  // applied need not be re-staged. In stable playback this removes the QoS property writes
+  // from every frame.
+  if (applied_qos_data_.valid && SameQosData(qos_data, applied_qos_data_)) {
+    staged_qos_data_.valid = false;
+    return;
+  }
+
+  const DRMAtomicOp qos_ops[] = {
+      {DRMOps::CRTC_SET_CORE_CLK, token_.crtc_id, {qos_data.clock_hz}},
+      {DRMOps::CRTC_SET_CORE_AB, token_.crtc_id, {qos_data.core_ab_bps}},
+      {DRMOps::CRTC_SET_CORE_IB, token_.crtc_id, {qos_data.core_ib_bps}},
+      {DRMOps::CRTC_SET_LLCC_AB, token_.crtc_id, {qos_data.llcc_ab_bps}},
+      {DRMOps::CRTC_SET_LLCC_IB, token_.crtc_id, {qos_data.llcc_ib_bps}},
+      {DRMOps::CRTC_SET_DRAM_AB, token_.crtc_id, {qos_data.dram_ab_bps}},
+      {DRMOps::CRTC_SET_DRAM_IB, token_.crtc_id, {qos_data.dram_ib_bps}},
+      {DRMOps::CRTC_SET_ROT_PREFILL_BW, token_.crtc_id, {qos_data.rot_prefill_bw_bps}},
+      {DRMOps::CRTC_SET_ROT_CLK, token_.crtc_id, {qos_data.rot_clock_hz}},
+  };
+  drm_atomic_intf_->PerformBatch(qos_ops, UINT32(sizeof(qos_ops) / sizeof(qos_ops[0])));
+  staged_qos_data_ = qos_data;
 }
 
 DisplayError HWDeviceDRM::Standby(SyncPoints *sync_points) {
@@ -1461,7 +1560,11 @@ void HWDeviceDRM::SetupAtomic(Fence::ScopedRef &scoped_ref, HWLayersInfo *hw_lay
                                           display_attributes_[index].y_pixels}};
       DRMRect spr_rects[kNumMaxROIs] = {{0, 0, mixer_attributes_.width, mixer_attributes_.height}};
 
-      for (uint32_t i = 0; i < hw_layers_info->left_frame_roi.size(); i++) {
+      // ROI generation is capped to the panel's per-frame rect count upstream
+      // (PUConstraints::max_roi_rects); the clamp only guards a misbehaving extension.
+      uint32_t roi_count = std::min(UINT32(hw_layers_info->left_frame_roi.size()),
+                                    UINT32(kNumMaxROIs));
+      for (uint32_t i = 0; i < roi_count; i++) {
         auto &roi = hw_layers_info->left_frame_roi.at(i);
         // TODO(user): In multi PU, stitch ROIs vertically adjacent and upate plane destination
         crtc_rects[i].left = UINT32(roi.left);
@@ -1478,7 +1581,7 @@ void HWDeviceDRM::SetupAtomic(Fence::ScopedRef &scoped_ref, HWLayersInfo *hw_lay
         spr_rects[i].bottom = UINT32(roi.bottom);
       }
 
-      uint32_t num_rects = std::max(1u, UINT32(hw_layers_info->left_frame_roi.size()));
+      uint32_t num_rects = std::max(1u, roi_count);
       drm_atomic_intf_->Perform(DRMOps::CRTC_SET_ROI, token_.crtc_id, num_rects, crtc_rects,
                                 spr_rects);
       drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_ROI, token_.conn_id, num_rects, conn_rects);
@@ -1647,7 +1750,7 @@ void HWDeviceDRM::SetupAtomic(Fence::ScopedRef &scoped_ref, HWLayersInfo *hw_lay
             SDEScaler scaler_output = {};
             hw_scale_->SetScaler(pipe_info->scale_data, &scaler_output);
             // TODO(user): Remove qseed3 and add version check, then send appropriate scaler object
-            if (hw_resource_.has_qseed3) {
+            if (hw_resource_->has_qseed3) {
               drm_atomic_intf_->Perform(DRMOps::PLANE_SET_SCALER_CONFIG, pipe_id,
                                         reinterpret_cast<uint64_t>(&scaler_output.scaler_v2));
             }
@@ -1717,7 +1820,7 @@ void HWDeviceDRM::SetupAtomic(Fence::ScopedRef &scoped_ref, HWLayersInfo *hw_lay
           if (hw_scale_) {
             SDEScaler scaler_output = {};
             hw_scale_->SetScaler(pipe_info->scale_data, &scaler_output);
-            if (hw_resource_.has_qseed3) {
+            if (hw_resource_->has_qseed3) {
               drm_atomic_intf_->Perform(DRMOps::PLANE_SET_SCALER_CONFIG, pipe_id,
                                         reinterpret_cast<uint64_t>(&scaler_output.scaler_v2));
             }
@@ -1736,7 +1839,7 @@ void HWDeviceDRM::SetupAtomic(Fence::ScopedRef &scoped_ref, HWLayersInfo *hw_lay
   }
 
   if (update_config) {
-    SetSolidfillStages();
+    SetSolidfillStages(validate);
     ApplyNoiseLayerConfig();
     SetQOSData(qos_data);
     drm_atomic_intf_->Perform(DRMOps::CRTC_SET_SECURITY_LEVEL, token_.crtc_id, crtc_security_level);
@@ -1888,7 +1991,7 @@ void HWDeviceDRM::SetNoiseLayerConfig(const NoiseLayerConfig &noise_config) {
 }
 
 void HWDeviceDRM::ApplyNoiseLayerConfig() {
-  if (hw_resource_.has_noise_layer) {
+  if (hw_resource_->has_noise_layer) {
     drm_atomic_intf_->Perform(DRMOps::CRTC_SET_NOISELAYER_CONFIG, token_.crtc_id,
                               reinterpret_cast<uint64_t>(&noise_cfg_));
   }
@@ -1926,21 +2029,146 @@ void HWDeviceDRM::AddSolidfillStage(const HWSolidfillStage &sf, uint32_t plane_a
            solidfill.z_order, solidfill.color, solidfill.plane_alpha);
 }
 
-void HWDeviceDRM::SetSolidfillStages() {
-  if (hw_resource_.num_solidfill_stages) {
-    drm_atomic_intf_->Perform(DRMOps::CRTC_SET_SOLIDFILL_STAGES, token_.crtc_id,
-                              reinterpret_cast<uint64_t> (&solid_fills_));
+static bool SolidfillStagesMatch(const std::vector<sde_drm::DRMSolidfillStage> &l,
+                                 const std::vector<sde_drm::DRMSolidfillStage> &r) {
+  if (l.size() != r.size()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < l.size(); i++) {
+    const sde_drm::DRMSolidfillStage &a = l.at(i);
+    const sde_drm::DRMSolidfillStage &b = r.at(i);
+    if (a.bounding_rect.left != b.bounding_rect.left ||
+        a.bounding_rect.top != b.bounding_rect.top ||
+        a.bounding_rect.right != b.bounding_rect.right ||
+        a.bounding_rect.bottom != b.bounding_rect.bottom ||
+        a.is_exclusion_rect != b.is_exclusion_rect || a.color != b.color || a.red != b.red ||
+        a.blue != b.blue || a.green != b.green || a.alpha != b.alpha ||
+        a.color_bit_depth != b.color_bit_depth || a.z_order != b.z_order ||
+        a.plane_alpha != b.plane_alpha) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void HWDeviceDRM::SetSolidfillStages(bool validate) {
+  if (!hw_resource_->num_solidfill_stages) {
+    return;
+  }
+
+  // Dim layers and solid fills persist across many consecutive frames and the
+  // property retains its last committed value, so skip the update when the
+  // stage list matches what the hardware already has.
+  if (solid_fills_applied_ && SolidfillStagesMatch(solid_fills_, applied_solid_fills_)) {
+    return;
+  }
+
+  drm_atomic_intf_->Perform(DRMOps::CRTC_SET_SOLIDFILL_STAGES, token_.crtc_id,
+                            reinterpret_cast<uint64_t> (&solid_fills_));
+  // A validate-only cycle does not reach the hardware; cache only what a real
+  // commit carries.
+  if (!validate) {
+    applied_solid_fills_ = solid_fills_;
+    solid_fills_applied_ = true;
   }
 }
 
 void HWDeviceDRM::ClearSolidfillStages() {
+  // Power transitions and flushes can reset the CRTC state underneath the
+  // cache, so always push the empty stage list.
   solid_fills_.clear();
-  SetSolidfillStages();
+  applied_solid_fills_.clear();
+  solid_fills_applied_ = false;
+  SetSolidfillStages(false /* validate */);
+}
+
+uint64_t HWDeviceDRM::ComputeTopologyHash(HWLayersInfo *hw_layers_info) {
+  auto fold = [](uint64_t hash, uint64_t value) {
+    return (hash ^ value) * 1099511628211ULL;
+  };
+
+  uint64_t hash = 14695981039346656037ULL;
+  hash = fold(hash, current_mode_index_);
+  hash = fold(hash, vrefresh_);
+  hash = fold(hash, bit_clk_rate_);
+  hash = fold(hash, panel_mode_changed_);
+  hash = fold(hash, hw_layers_info->qos_data.clock_hz);
+  hash = fold(hash, hw_layers_info->qos_data.core_ab_bps);
+  hash = fold(hash, hw_layers_info->qos_data.core_ib_bps);
+  hash = fold(hash, hw_layers_info->hw_layers.size());
+
+  for (uint32_t i = 0; i < hw_layers_info->hw_layers.size(); i++) {
+    const HWLayerConfig &config = hw_layers_info->config[i];
+    hash = fold(hash, UINT64(config.hw_rotator_session.mode));
+    hash = fold(hash, config.use_solidfill_stage);
+
+    // Security modes are part of what the kernel validates: a layer flipping non-secure to
+    // secure with identical geometry must not alias to an already-proven topology.
+    DRMSecureMode fb_secure_mode;
+    DRMSecurityLevel security_level;
+    SetSecureConfig(hw_layers_info->hw_layers.at(i).input_buffer, &fb_secure_mode,
+                    &security_level);
+    hash = fold(hash, UINT64(fb_secure_mode));
+    hash = fold(hash, UINT64(security_level));
+
+    for (const HWPipeInfo *pipe : {&config.left_pipe, &config.right_pipe}) {
+      if (!pipe->valid) {
+        continue;
+      }
+      hash = fold(hash, pipe->pipe_id);
+      hash = fold(hash, pipe->z_order);
+      hash = fold(hash, pipe->flags);
+      hash = fold(hash, UINT64(pipe->format));
+      hash = fold(hash, UINT64(INT(pipe->src_roi.left)) << 32 | UINT64(INT(pipe->src_roi.top)));
+      hash = fold(hash, UINT64(INT(pipe->src_roi.right)) << 32 | UINT64(INT(pipe->src_roi.bottom)));
+      hash = fold(hash, UINT64(INT(pipe->dst_roi.left)) << 32 | UINT64(INT(pipe->dst_roi.top)));
+      hash = fold(hash, UINT64(INT(pipe->dst_roi.right)) << 32 | UINT64(INT(pipe->dst_roi.bottom)));
+      hash = fold(hash, pipe->horizontal_decimation);
+      hash = fold(hash, pipe->vertical_decimation);
+      hash = fold(hash, UINT64(INT(pipe->transform.rotation)) << 2 |
+                            UINT64(pipe->transform.flip_horizontal) << 1 |
+                            UINT64(pipe->transform.flip_vertical));
+      // Tonemap blocks are staged per pipe and validated by the kernel alongside geometry.
+      hash = fold(hash, UINT64(pipe->tonemap));
+      hash = fold(hash, UINT64(pipe->dgm_csc_info.op));
+      hash = fold(hash, UINT64(pipe->inverse_pma_info.op) << 1 |
+                            UINT64(pipe->inverse_pma_info.inverse_pma));
+      for (const HWPipeTonemapLutInfo &lut : pipe->lut_info) {
+        hash = fold(hash, UINT64(lut.type) << 32 | UINT64(lut.op));
+      }
+      for (const auto &ucsc_op : pipe->ucsc_write_op) {
+        hash = fold(hash, UINT64(ucsc_op.first) << 32 | UINT64(ucsc_op.second));
+      }
+    }
+  }
+
+  return hash;
+}
+
+void HWDeviceDRM::ClearValidationCache() {
+  for (uint32_t i = 0; i < kValidateCacheSize; i++) {
+    validated_topology_[i] = 0;
+  }
+  validated_topology_index_ = 0;
+  // Power transitions, mode changes and commit failures can reset kernel QoS state; re-stage
+  // the full set on the next frame.
+  applied_qos_data_.valid = false;
+  staged_qos_data_.valid = false;
 }
 
 DisplayError HWDeviceDRM::Validate(HWLayersInfo *hw_layers_info) {
   DTRACE_SCOPED();
 
+  // A topology already proven by a TEST_ONLY commit needs no kernel round-trip. The test
+  // commit has no lasting state (the property shadow maps are rolled back after it), so a
+  // hit can return before staging anything.
+  uint64_t topology_hash = ComputeTopologyHash(hw_layers_info);
+  for (uint32_t i = 0; i < kValidateCacheSize; i++) {
+    if (validated_topology_[i] && validated_topology_[i] == topology_hash) {
+      return kErrorNone;
+    }
+  }
+
   DisplayError err = kErrorNone;
   int ret = registry_.Register(hw_layers_info);
   if (ret) {
@@ -1958,7 +2186,11 @@ DisplayError HWDeviceDRM::Validate(HWLayersInfo *hw_layers_info) {
     seamless_mode_switch_ = false;
     panel_compression_changed_ = 0;
     transfer_time_updated_ = 0;
+    ClearValidationCache();
     err = kErrorHardware;
+  } else {
+    validated_topology_[validated_topology_index_] = topology_hash;
+    validated_topology_index_ = (validated_topology_index_ + 1) % kValidateCacheSize;
   }
 
   return err;
@@ -2065,7 +2297,19 @@ DisplayError HWDeviceDRM::AtomicCommit(HWLayersInfo *hw_layers_info) {
     usleep(UINT32((elapse_timestamp - current_time) / 1000));
   }
 
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  uint64_t commit_start_ns = (UINT64(t.tv_sec) * 1000000000LL + t.tv_nsec);
+
+  // Watch for the atomic ioctl blocking in the kernel; a synchronous commit legitimately
+  // waits out a frame, so give it two vsync periods before declaring a stall.
+  uint64_t vsync_period_ns = display_attributes_[current_mode_index_].vsync_period_ns;
+  uint64_t watchdog_budget_ns = vsync_period_ns ? (2 * vsync_period_ns) : 50000000;
+  commit_watchdog_.Arm(token_.crtc_id, token_.conn_id, commit_start_ns + watchdog_budget_ns);
+
   int ret = drm_atomic_intf_->Commit(sync_commit, false /* retain_planes*/);
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  bool watchdog_overrun = commit_watchdog_.Disarm(
+      (UINT64(t.tv_sec) * 1000000000LL + t.tv_nsec) - commit_start_ns);
   shared_ptr<Fence> release_fence = Fence::Create(INT(release_fence_fd), "release");
   shared_ptr<Fence> retire_fence = Fence::Create(INT(retire_fence_fd), "retire");
   if (ret) {
@@ -2076,14 +2320,32 @@ DisplayError HWDeviceDRM::AtomicCommit(HWLayersInfo *hw_layers_info) {
     seamless_mode_switch_ = false;
     panel_compression_changed_ = 0;
     transfer_time_updated_ = 0;
+    ClearValidationCache();
     return kErrorHardware;
   }
 
+  if (watchdog_overrun) {
+    // Pair the watchdog's stall report with the property set that was in flight. The ioctl
+    // returned success, so the kernel has latched this frame: all fence publication and
+    // post-commit bookkeeping below must run normally regardless of fast-fail.
+    DumpHWLayers(hw_layers_info);
+  }
+
   DLOGD_IF(kTagDriverConfig, "RELEASE fence: fd: %s", Fence::GetStr(release_fence).c_str());
   DLOGD_IF(kTagDriverConfig, "RETIRE fence: fd: %s", Fence::GetStr(retire_fence).c_str());
 
+  if (staged_qos_data_.valid) {
+    applied_qos_data_ = staged_qos_data_;
+    staged_qos_data_.valid = false;
+  }
+
   hw_layers_info->retire_fence = retire_fence;
 
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  uint64_t commit_end_ns = (UINT64(t.tv_sec) * 1000000000LL + t.tv_nsec);
+  UpdateCommitTiming(retire_fence, commit_end_ns, commit_end_ns - commit_start_ns);
+  commit_recorder_.Record(token_.crtc_id, token_.conn_id, commit_end_ns - commit_start_ns);
+
   for (uint32_t i = 0; i < hw_layers_info->hw_layers.size(); i++) {
     Layer &layer = hw_layers_info->hw_layers.at(i);
     HWRotatorSession *hw_rotator_session = &hw_layers_info->config[i].hw_rotator_session;
@@ -2149,6 +2411,48 @@ DisplayError HWDeviceDRM::AtomicCommit(HWLayersInfo *hw_layers_info) {
                             sde_drm::DRMVMRequestState::NONE);
 #endif
 
+  if (watchdog_overrun && commit_watchdog_.FastFailEnabled()) {
+    // The frame is on the hardware and its fences were handed back above; the error return
+    // only starts the client's existing commit-failure recovery on this present, instead of
+    // after the framework's multi-second fence timeout.
+    DLOGE("Commit on crtc %d overran the watchdog deadline; failing frame for recovery",
+          token_.crtc_id);
+    return kErrorHardware;
+  }
+
+  return kErrorNone;
+}
+
+void HWDeviceDRM::UpdateCommitTiming(const std::shared_ptr<Fence> &retire_fence,
+                                     uint64_t commit_end_ns, uint64_t commit_duration_ns) {
+  // Resolve the previous frame now: its retire fence has normally signaled by the time the
+  // next commit is issued, so this never blocks the commit path. A pending fence returns 0
+  // and that frame's sample is simply dropped.
+  uint64_t flip_ns = Fence::GetSignalTime(timing_retire_fence_);
+  if (flip_ns > timing_commit_end_ns_ && timing_commit_end_ns_ > 0) {
+    uint64_t margin_ns = flip_ns - timing_commit_end_ns_;
+    std::lock_guard<std::mutex> lock(commit_timing_lock_);
+    commit_timing_.last_flip_time_ns = flip_ns;
+    commit_timing_.last_commit_time_ns = timing_commit_end_ns_;
+    commit_timing_.last_commit_duration_ns = timing_commit_duration_ns_;
+    if (!commit_timing_.avg_margin_ns) {
+      commit_timing_.avg_margin_ns = margin_ns;
+    } else {
+      // 1/8 weight: tracks a collapsing margin within a handful of frames without chasing a
+      // single outlier.
+      commit_timing_.avg_margin_ns -= commit_timing_.avg_margin_ns >> 3;
+      commit_timing_.avg_margin_ns += margin_ns >> 3;
+    }
+  }
+
+  timing_retire_fence_ = retire_fence;
+  timing_commit_end_ns_ = commit_end_ns;
+  timing_commit_duration_ns_ = commit_duration_ns;
+}
+
+DisplayError HWDeviceDRM::GetCommitTimingStats(CommitTimingStats *stats) {
+  std::lock_guard<std::mutex> lock(commit_timing_lock_);
+  *stats = commit_timing_;
   return kErrorNone;
 }
 
@@ -2345,6 +2649,45 @@ bool HWDeviceDRM::EnableHotPlugDetection(int enable) {
 
 DisplayError HWDeviceDRM::SetCursorPosition(HWLayersInfo *hw_layers_info, int x, int y) {
   DTRACE_SCOPED();
+  if (!hw_layers_info->async_cursor_updates) {
+    // The position rides the next full commit.
+    return kErrorNone;
+  }
+
+  // Resources has already validated the move and updated the cursor pipe's ROIs, so push just
+  // that plane's rects as a position-only async commit; cursor latency then does not depend on
+  // a prepare/commit cycle of the rest of the stack.
+  for (uint32_t i = 0; i < hw_layers_info->hw_layers.size(); i++) {
+    const Layer &layer = hw_layers_info->hw_layers.at(i);
+    if (layer.composition != kCompositionCursor) {
+      continue;
+    }
+
+    HWLayerConfig &layer_config = hw_layers_info->config[i];
+    for (uint32_t count = 0; count < 2; count++) {
+      HWPipeInfo *pipe_info = (count == 0) ? &layer_config.left_pipe : &layer_config.right_pipe;
+      if (!pipe_info->valid) {
+        continue;
+      }
+      uint32_t pipe_id = pipe_info->pipe_id;
+      DRMRect src = {};
+      SetRect(pipe_info->src_roi, &src);
+      DRMRect dst = {};
+      SetRect(pipe_info->dst_roi, &dst);
+      drm_atomic_intf_->Perform(DRMOps::PLANE_SET_SRC_RECT, pipe_id, src);
+      drm_atomic_intf_->Perform(DRMOps::PLANE_SET_DST_RECT, pipe_id, dst);
+    }
+
+    int ret = drm_atomic_intf_->Commit(false /* synchronous */, true /* retain_planes */);
+    if (ret) {
+      // A failure with an in-flight frame is expected occasionally; the position simply rides
+      // that commit instead.
+      DLOGV_IF(kTagDriverConfig, "Cursor position commit failed with error %d, crtc %d", ret,
+               token_.crtc_id);
+    }
+    break;
+  }
+
   return kErrorNone;
 }
 
@@ -2571,7 +2914,7 @@ DisplayError HWDeviceDRM::SetMixerAttributes(const HWMixerAttributes &mixer_attr
     return kErrorNotSupported;
   }
 
-  uint32_t max_input_width = hw_resource_.hw_dest_scalar_info.max_input_width;
+  uint32_t max_input_width = hw_resource_->hw_dest_scalar_info.max_input_width;
   uint32_t split_max_input_width = max_input_width - DEST_SCALAR_OVERFETCH_SIZE;
   uint32_t lm_split_width = mixer_attributes.width / topology_num_split;
   if (topology_num_split > 1 && lm_split_width > split_max_input_width) {
@@ -2601,7 +2944,7 @@ DisplayError HWDeviceDRM::SetMixerAttributes(const HWMixerAttributes &mixer_attr
 
   float scale_x = FLOAT(display_attributes_[index].x_pixels) / FLOAT(mixer_attributes.width);
   float scale_y = FLOAT(display_attributes_[index].y_pixels) / FLOAT(mixer_attributes.height);
-  float max_scale_up = hw_resource_.hw_dest_scalar_info.max_scale_up;
+  float max_scale_up = hw_resource_->hw_dest_scalar_info.max_scale_up;
   if (scale_x > max_scale_up || scale_y > max_scale_up) {
     DLOGW(
         "Up scaling ratio exceeds for destination scalar upscale limit scale_x %f scale_y %f "
@@ -3000,13 +3343,13 @@ void HWDeviceDRM::SetSsppLutFeatures(HWPipeInfo *pipe_info) {
 }
 
 void HWDeviceDRM::AddDimLayerIfNeeded() {
-  if (secure_display_active_ && hw_resource_.secure_disp_blend_stage >= 0) {
+  if (secure_display_active_ && hw_resource_->secure_disp_blend_stage >= 0) {
     HWSolidfillStage sf = {};
-    sf.z_order = UINT32(hw_resource_.secure_disp_blend_stage);
+    sf.z_order = UINT32(hw_resource_->secure_disp_blend_stage);
     sf.roi = { 0.0, 0.0, FLOAT(mixer_attributes_.width), FLOAT(mixer_attributes_.height) };
     solid_fills_.clear();
     AddSolidfillStage(sf, 0xFF);
-    SetSolidfillStages();
+    SetSolidfillStages(false /* validate */);
   }
 
   if (!secure_display_active_) {
@@ -3026,6 +3369,11 @@ DisplayError HWDeviceDRM::NullCommit(bool synchronous, bool retain_planes) {
   }
   DLOGI("Null commit succeeded crtc=%u", token_.crtc_id);
 
+  if (staged_qos_data_.valid) {
+    applied_qos_data_ = staged_qos_data_;
+    staged_qos_data_.valid = false;
+  }
+
   if (first_null_cycle_)
     first_null_cycle_ = false;
 
@@ -3082,6 +3430,8 @@ DisplayError HWDeviceDRM::GetDynamicDSIClock(uint64_t *bit_clk_rate) {
 
 DisplayError HWDeviceDRM::UpdateTransferTime(uint32_t transfer_time) {
   connector_info_.modes[current_mode_index_].transfer_time_us = transfer_time;
+  // Transfer time feeds the min-scan across same-resolution modes; drop all cached entries.
+  panel_info_cache_.clear();
   PopulateHWPanelInfo();
   transfer_time_updated_ = transfer_time;
   synchronous_commit_ = true;
@@ -3293,7 +3643,7 @@ uint64_t HWDeviceDRM::GetSupportedBitClkRate(uint32_t new_mode_index,
 
 bool HWDeviceDRM::SetupConcurrentWriteback(const HWLayersInfo &hw_layer_info, bool validate,
                                            int64_t *release_fence_fd) {
-  bool enable = hw_resource_.has_concurrent_writeback && hw_layer_info.output_buffer &&
+  bool enable = hw_resource_->has_concurrent_writeback && hw_layer_info.output_buffer &&
                 (hw_layer_info.cwb_id != -1) && !pending_cwb_teardown_;
   if (!(enable || cwb_config_.enabled)) {  // the frame is neither cwb setup nor cwb teardown frame
     return false;
@@ -3416,16 +3766,18 @@ void HWDeviceDRM::ConfigureConcurrentWriteback(const HWLayersInfo &hw_layer_info
       drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_ROI, vitual_conn_id, 0, nullptr);
       DLOGV_IF(kTagDriverConfig, "roi_v1 of virtual connector is set NULL (Full Frame update).");
     } else {
-      const int kNumMaxROIs = 4;
+      const uint32_t kNumMaxROIs = 4;
       sde_drm::DRMRect conn_rects[kNumMaxROIs] = {full_frame};
-      for (uint32_t i = 0; i < hw_layer_info.left_frame_roi.size(); i++) {
+      // Clamp to the fixed property array like the display connector path does.
+      uint32_t roi_count = std::min(UINT32(hw_layer_info.left_frame_roi.size()), kNumMaxROIs);
+      for (uint32_t i = 0; i < roi_count; i++) {
         auto &roi = hw_layer_info.left_frame_roi.at(i);
         conn_rects[i].left = UINT32(roi.left);
         conn_rects[i].right = UINT32(roi.right);
         conn_rects[i].top = UINT32(roi.top);
         conn_rects[i].bottom = UINT32(roi.bottom);
       }
-      uint32_t num_rects = std::max(1u, UINT32(hw_layer_info.left_frame_roi.size()));
+      uint32_t num_rects = std::max(1u, roi_count);
       drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_ROI, vitual_conn_id, num_rects, conn_rects);
     }
 
@@ -3489,7 +3841,7 @@ DisplayError HWDeviceDRM::TeardownConcurrentWriteback(void) {
 }
 
 void HWDeviceDRM::PostCommitConcurrentWriteback(std::shared_ptr<LayerBuffer> output_buffer) {
-  if (hw_resource_.has_concurrent_writeback && output_buffer) {
+  if (hw_resource_->has_concurrent_writeback && output_buffer) {
     return;
   }
 
@@ -81,6 +81,8 @@
 
 #include "hw_scale_drm.h"
 #include "hw_color_manager_drm.h"
+#include "hw_commit_recorder.h"
+#include "hw_commit_watchdog.h"
 
 #define IOCTL_LOGE(ioctl, type) \
   DLOGE("ioctl %s, device = %d errno = %d, desc = %s", #ioctl, type, errno, strerror(errno))
@@ -127,6 +129,7 @@ class HWDeviceDRM : public HWInterface {
                                             HWDisplayAttributes *display_attributes);
   virtual DisplayError GetHWPanelInfo(HWPanelInfo *panel_info);
   virtual DisplayError SetDisplayAttributes(uint32_t index);
+  virtual DisplayError PrefetchDisplayConfig(uint32_t index);
   virtual DisplayError SetDisplayAttributes(const HWDisplayAttributes &display_attributes);
   virtual DisplayError GetConfigIndex(char *mode, uint32_t *index);
   virtual DisplayError PowerOn(const HWQosData &qos_data, SyncPoints *sync_points);
@@ -165,6 +168,9 @@ class HWDeviceDRM : public HWInterface {
   virtual DisplayError SetMixerAttributes(const HWMixerAttributes &mixer_attributes);
   virtual DisplayError GetMixerAttributes(HWMixerAttributes *mixer_attributes);
   virtual void InitializeConfigs();
+  // Lets a device type keep a mode's attribute population off the probe critical path; the
+  // deferring device owns populating it before the mode is consumed. Default is eager.
+  virtual bool DeferModeAttributePopulation(uint32_t mode_index) { return false; }
   virtual DisplayError DumpDebugData();
   virtual void PopulateHWPanelInfo();
   virtual DisplayError SetDppsFeature(void *payload, size_t size) { return kErrorNotSupported; }
@@ -230,10 +236,11 @@ class HWDeviceDRM : public HWInterface {
   DisplayError SetStride(HWDeviceType device_type, LayerBufferFormat format, uint32_t width,
                          uint32_t *target);
   DisplayError PopulateDisplayAttributes(uint32_t index);
+  void BuildHWPanelInfo();
   void GetHWDisplayPortAndMode();
   bool EnableHotPlugDetection(int enable);
   void UpdateMixerAttributes();
-  void SetSolidfillStages();
+  void SetSolidfillStages(bool validate);
   void AddSolidfillStage(const HWSolidfillStage &sf, uint32_t plane_alpha);
   void ClearSolidfillStages();
   void SetNoiseLayerConfig(const NoiseLayerConfig &noise_config);
@@ -274,6 +281,8 @@ class HWDeviceDRM : public HWInterface {
   void ResetROI();
   void SetQOSData(const HWQosData &qos_data);
   void DumpHWLayers(HWLayersInfo *hw_layers_info);
+  uint64_t ComputeTopologyHash(HWLayersInfo *hw_layers_info);
+  void ClearValidationCache();
   bool IsFullFrameUpdate(const HWLayersInfo &hw_layer_info);
   DisplayError GetDRMPowerMode(const HWPowerState &power_state, DRMPowerMode *drm_power_mode);
   void SetTUIState();
@@ -285,6 +294,9 @@ class HWDeviceDRM : public HWInterface {
   DisplayError GetPanelBlMaxLvl(uint32_t *bl_max);
   DisplayError SetPPConfig(void *payload, size_t size);
   DisplayError GetQsyncFps(uint32_t *qsync_fps) { return kErrorNotSupported; }
+  DisplayError GetCommitTimingStats(CommitTimingStats *stats);
+  void UpdateCommitTiming(const std::shared_ptr<Fence> &retire_fence, uint64_t commit_end_ns,
+                          uint64_t commit_duration_ns);
   void SetDestScalarData(const DestScaleInfoMap dest_scale_info_map) { return; };
 
   class Registry {
@@ -327,18 +339,30 @@ class HWDeviceDRM : public HWInterface {
   int dev_fd_ = -1;
   Registry registry_;
   sde_drm::DRMDisplayToken token_ = {};
-  HWResourceInfo hw_resource_ = {};
+  // Shared immutable capability snapshot from HWInfoInterface; one copy serves all devices.
+  std::shared_ptr<const HWResourceInfo> hw_resource_ = std::make_shared<HWResourceInfo>();
   HWPanelInfo hw_panel_info_ = {};
   HWScaleDRM *hw_scale_ = {};
   sde_drm::DRMManagerInterface *drm_mgr_intf_ = {};
   sde_drm::DRMAtomicReqInterface *drm_atomic_intf_ = {};
   std::vector<HWDisplayAttributes> display_attributes_ = {};
+  // Per-mode panel info built once per connector probe; a mode switch only swaps entries in.
+  // Stamped with the inputs that can change between switches so a stale entry rebuilds itself.
+  struct PanelInfoCacheEntry {
+    bool valid = false;
+    uint32_t submode_index = 0;
+    uint32_t panel_mode = 0;
+    HWPanelInfo panel_info = {};
+  };
+  std::vector<PanelInfoCacheEntry> panel_info_cache_ = {};
   uint32_t current_mode_index_ = 0;
   sde_drm::DRMConnectorInfo connector_info_ = {};
   bool first_cycle_ = true;
   bool first_null_cycle_ = true;
   HWMixerAttributes mixer_attributes_ = {};
   std::vector<sde_drm::DRMSolidfillStage> solid_fills_ {};
+  std::vector<sde_drm::DRMSolidfillStage> applied_solid_fills_ {};
+  bool solid_fills_applied_ = false;
   sde_drm::DRMNoiseLayerConfig noise_cfg_ = {};
   bool secure_display_active_ = false;
   TUIState tui_state_ = kTUIStateNone;
@@ -374,6 +398,27 @@ class HWDeviceDRM : public HWInterface {
   HWCwbConfig cwb_config_ = {};
   static std::mutex cwb_state_lock_;  // cwb state lock. Set before accesing or updating cwb_config_
   uint32_t transfer_time_updated_ = 0;
+  // Hashes of pipe topologies that already passed a TEST_ONLY commit. Strategy iteration
+  // re-validates identical configurations; a hit skips the kernel round-trip. Cleared on
+  // power transitions, mode changes and commit failures.
+  static const uint32_t kValidateCacheSize = 8;
+  uint64_t validated_topology_[kValidateCacheSize] = {};
+  uint32_t validated_topology_index_ = 0;
+  // QoS values the kernel already holds: staged_qos_data_ tracks what the open atomic request
+  // carries, applied_qos_data_ what the last successful real commit applied. Unchanged values
+  // skip the nine CRTC property writes. Cleared with the validation cache.
+  HWQosData staged_qos_data_ = {};
+  HWQosData applied_qos_data_ = {};
+  // Commit timing feedback: each commit records when the atomic call returned, and is resolved
+  // against the pageflip timestamp of its retire fence at the next commit, when the fence has
+  // normally signaled. The resulting margin EWMA is read through GetCommitTimingStats().
+  std::shared_ptr<Fence> timing_retire_fence_ = nullptr;
+  uint64_t timing_commit_end_ns_ = 0;
+  uint64_t timing_commit_duration_ns_ = 0;
+  CommitTimingStats commit_timing_ = {};
+  std::mutex commit_timing_lock_;  // guards commit_timing_ against readers off the commit thread
+  HWCommitRecorder commit_recorder_ = {};  // opt-in property stream recorder, see its header
+  HWCommitWatchdog commit_watchdog_ = {};  // opt-in commit overrun diagnosis, see its header
   bool force_tonemapping_ = false;
   bool enable_brightness_drm_prop_ = false;
   int cached_brightness_level_ = -1;
@@ -70,6 +70,7 @@
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <sys/epoll.h>
 #include <sys/prctl.h>
 #include <sys/resource.h>
 #include <sys/types.h>
@@ -114,6 +115,240 @@ namespace sdm {
 
 using drm_utils::DRMMaster;
 
+HWEventsReactor *HWEventsReactor::GetInstance() {
+  static HWEventsReactor reactor;
+  return &reactor;
+}
+
+DisplayError HWEventsReactor::Start(Tier tier) {
+  Lane &lane = lanes_[tier];
+  lane.epoll_fd = epoll_create1(0);
+  if (lane.epoll_fd < 0) {
+    DLOGE("epoll_create1 failed for tier %d. error = %s", tier, strerror(errno));
+    return kErrorResources;
+  }
+
+  lane.wake_fd = Sys::eventfd_(0, 0);
+  if (lane.wake_fd < 0) {
+    DLOGE("eventfd failed for tier %d. error = %s", tier, strerror(errno));
+    Sys::close_(lane.epoll_fd);
+    lane.epoll_fd = -1;
+    return kErrorResources;
+  }
+
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN;
+  ev.data.fd = lane.wake_fd;
+  if (epoll_ctl(lane.epoll_fd, EPOLL_CTL_ADD, lane.wake_fd, &ev) < 0) {
+    DLOGE("epoll_ctl add of wake fd failed for tier %d. error = %s", tier, strerror(errno));
+    Sys::close_(lane.wake_fd);
+    Sys::close_(lane.epoll_fd);
+    lane.wake_fd = -1;
+    lane.epoll_fd = -1;
+    return kErrorResources;
+  }
+
+  lane.exit_thread = false;
+  lane.thread = std::thread(&HWEventsReactor::ReactorThread, this, tier);
+  lane.running = true;
+  DLOGI("Started DRM event reactor thread for tier %d", tier);
+
+  return kErrorNone;
+}
+
+void HWEventsReactor::Stop(Tier tier) {
+  Lane &lane = lanes_[tier];
+  lane.exit_thread = true;
+  uint64_t wake_value = 1;
+  ssize_t write_size = Sys::write_(lane.wake_fd, &wake_value, sizeof(wake_value));
+  if (write_size != sizeof(wake_value)) {
+    DLOGW("Error triggering reactor wake fd (%d). write size = %zu, error = %s", lane.wake_fd,
+          static_cast<size_t>(write_size), strerror(errno));
+  }
+  // The thread closes the epoll and wake fds on its way out.
+  lane.wake_fd = -1;
+  lane.epoll_fd = -1;
+  lane.running = false;
+}
+
+DisplayError HWEventsReactor::Register(int fd, HWEventsDRM *events, uint32_t index, Tier tier) {
+  std::lock_guard<std::mutex> guard(lock_);
+  Lane &lane = lanes_[tier];
+
+  if (!lane.running) {
+    DisplayError error = Start(tier);
+    if (error != kErrorNone) {
+      return error;
+    }
+  }
+
+  struct epoll_event ev = {};
+  ev.events = EPOLLIN | EPOLLPRI;
+  ev.data.fd = fd;
+  if (epoll_ctl(lane.epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+    DLOGE("epoll_ctl add failed for fd %d. error = %s", fd, strerror(errno));
+    return kErrorResources;
+  }
+
+  // Copy-on-write: the reactor dispatches against whichever snapshot it picked up at wakeup.
+  auto updated = std::make_shared<SourceMap>(*lane.sources);
+  (*updated)[fd] = {events, index};
+  lane.sources = std::move(updated);
+
+  return kErrorNone;
+}
+
+void HWEventsReactor::Unregister(int fd) {
+  std::thread defunct;
+  {
+    std::unique_lock<std::mutex> guard(lock_);
+    Lane *lane = nullptr;
+    Tier tier = kTierUrgent;
+    for (uint32_t t = 0; t < kTierMax; t++) {
+      if (lanes_[t].sources->find(fd) != lanes_[t].sources->end()) {
+        lane = &lanes_[t];
+        tier = static_cast<Tier>(t);
+        break;
+      }
+    }
+    if (!lane) {
+      return;
+    }
+
+    epoll_ctl(lane->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    auto updated = std::make_shared<SourceMap>(*lane->sources);
+    updated->erase(fd);
+    lane->sources = std::move(updated);
+
+    // A batch picked up before the snapshot swap may still dispatch this fd; wait for it to
+    // drain so no more callbacks reach the caller once we return.
+    uint64_t seq = lane->dispatch_seq;
+    if (seq & 1) {
+      dispatch_cv_.wait(guard, [lane, seq] { return lane->dispatch_seq != seq; });
+    }
+
+    // Wind the thread down with the tier's last source; it restarts with the next Register().
+    if (!lane->sources->empty()) {
+      return;
+    }
+    defunct = std::move(lane->thread);
+    Stop(tier);
+  }
+  defunct.join();
+}
+
+void HWEventsReactor::ReactorThread(Tier tier) {
+  static const int kMaxEpollEvents = 16;
+  Lane &lane = lanes_[tier];
+
+  if (tier == kTierUrgent) {
+    prctl(PR_SET_NAME, "SDM_EventReactor", 0, 0, 0);
+    setpriority(PRIO_PROCESS, 0, kThreadPriorityUrgent);
+
+    // Real Time task with lowest priority, same as the per-display event threads it replaces.
+    struct sched_param param = {0};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    sched_setscheduler(0, SCHED_FIFO, &param);
+  } else {
+    // Bulk tier stays on the default CFS policy so histogram blob reads and other slow-path
+    // event handling cannot preempt or delay commit-critical dispatch.
+    prctl(PR_SET_NAME, "SDM_EventReactorLo", 0, 0, 0);
+  }
+
+  int epoll_fd = lane.epoll_fd;
+  int wake_fd = lane.wake_fd;
+  struct epoll_event events[kMaxEpollEvents];
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      if (lane.exit_thread) {
+        break;
+      }
+    }
+
+    int count = epoll_wait(epoll_fd, events, kMaxEpollEvents, -1);
+    if (count <= 0) {
+      if (errno != EINTR) {
+        DLOGW("epoll_wait failed. error = %s", strerror(errno));
+      }
+      continue;
+    }
+
+    // One snapshot per wakeup; dispatch runs without the lock so panel-rate sources do not
+    // contend with registration, and a whole batch costs one lock acquisition instead of one
+    // per event.
+    std::shared_ptr<const SourceMap> snapshot;
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      snapshot = lane.sources;
+      lane.dispatch_seq++;  // odd: batch in flight
+    }
+
+    for (int i = 0; i < count; i++) {
+      int fd = events[i].data.fd;
+      if (fd == wake_fd) {
+        char wake_data[8] = {};
+        Sys::read_(wake_fd, wake_data, sizeof(wake_data));
+        continue;
+      }
+
+      auto it = snapshot->find(fd);
+      if (it == snapshot->end()) {
+        // Source was unregistered between wakeup and dispatch.
+        continue;
+      }
+      it->second.events->ProcessPollFd(it->second.index, events[i].events);
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      lane.dispatch_seq++;  // even: idle
+    }
+    dispatch_cv_.notify_all();
+  }
+
+  Sys::close_(wake_fd);
+  Sys::close_(epoll_fd);
+  DLOGI("Exiting the reactor thread for tier %d", tier);
+}
+
+namespace {
+
+// Per-event scheduling tier for the shared reactor. Commit-critical events ride the SCHED_FIFO
+// thread; bursty or slow-path events (histogram blobs, MMRM, panel dead) drain at normal
+// priority so a blob burst cannot delay pageflip handling. Move an event between tiers here.
+HWEventsReactor::Tier GetEventTier(HWEvent event) {
+  switch (event) {
+    case HWEvent::VSYNC:
+    case HWEvent::PINGPONG_TIMEOUT:
+    case HWEvent::HW_RECOVERY:
+      return HWEventsReactor::kTierUrgent;
+    default:
+      return HWEventsReactor::kTierBulk;
+  }
+}
+
+}  // namespace
+
+int HWEventsDRM::OpenDRMEventFd() {
+  // All event fds funnel through DRMMaster's audited open path, so open latency and boot-time
+  // retry churn show up in one place; each event queue still needs a fd of its own because
+  // DRM event delivery is per-fd.
+  DRMMaster *master = nullptr;
+  if (DRMMaster::GetInstance(&master) < 0) {
+    DLOGE("Failed to acquire DRMMaster instance");
+    return -1;
+  }
+
+  int fd = -1;
+  if (master->OpenNonMasterFd(&fd) < 0) {
+    return -1;
+  }
+
+  return fd;
+}
+
 DisplayError HWEventsDRM::InitializePollFd() {
   for (uint32_t i = 0; i < event_data_list_.size(); i++) {
     char data[kMaxStringLength]{};
@@ -133,7 +368,7 @@ DisplayError HWEventsDRM::InitializePollFd() {
           }
           master->GetHandle(&poll_fds_[i].fd);
         } else {
-          poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+          poll_fds_[i].fd = OpenDRMEventFd();
         }
         vsync_index_ = i;
       } break;
@@ -146,36 +381,36 @@ DisplayError HWEventsDRM::InitializePollFd() {
         Sys::pread_(poll_fds_[i].fd, data, kMaxStringLength, 0);
       } break;
       case HWEvent::IDLE_POWER_COLLAPSE: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
         idle_pc_index_ = i;
       } break;
       case HWEvent::PANEL_DEAD: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
         panel_dead_index_ = i;
       } break;
       case HWEvent::HW_RECOVERY: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
         hw_recovery_index_ = i;
       } break;
       case HWEvent::HISTOGRAM: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
@@ -194,27 +429,27 @@ DisplayError HWEventsDRM::InitializePollFd() {
         DLOGI("%s backlight_event_index_ %d", brightness_node_.c_str(), backlight_event_index_);
       } break;
       case HWEvent::MMRM: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
         mmrm_index_ = i;
       } break;
       case HWEvent::POWER_EVENT: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
         power_event_index_ = i;
       } break;
       case HWEvent::VM_RELEASE_EVENT: {
-        poll_fds_[i].fd = drmOpen("msm_drm", nullptr);
+        poll_fds_[i].fd = OpenDRMEventFd();
         if (poll_fds_[i].fd < 0) {
-          DLOGE("drmOpen failed with error %d", poll_fds_[i].fd);
+          DLOGE("Failed to open DRM event fd, error %d", poll_fds_[i].fd);
           return kErrorResources;
         }
         poll_fds_[i].events = POLLIN | POLLPRI | POLLERR;
@@ -315,9 +550,19 @@ DisplayError HWEventsDRM::Init(int display_id, DisplayType display_type,
 
   PopulateHWEventData(event_list);
 
-  if (pthread_create(&event_thread_, NULL, &DisplayEventThread, this) < 0) {
-    DLOGE("Failed to start %s, error = %s", event_thread_name_.c_str(), strerror(errno));
-    return kErrorResources;
+  // Hand all event fds to the shared reactor in place of a per-display poll thread; each fd
+  // lands on the scheduling tier its event type calls for (see GetEventTier()).
+  for (uint32_t i = 0; i < poll_fds_.size(); i++) {
+    if (poll_fds_[i].fd < 0 || event_data_list_[i].event_type == HWEvent::EXIT) {
+      continue;
+    }
+    DisplayError error = HWEventsReactor::GetInstance()->Register(
+        poll_fds_[i].fd, this, i, GetEventTier(event_data_list_[i].event_type));
+    if (error != kErrorNone) {
+      DLOGE("Failed to register fd %d with event reactor for %s", poll_fds_[i].fd,
+            event_thread_name_.c_str());
+      return error;
+    }
   }
 
   int value = 0;
@@ -340,8 +585,6 @@ DisplayError HWEventsDRM::Init(int display_id, DisplayType display_type,
 }
 
 DisplayError HWEventsDRM::Deinit() {
-  exit_threads_ = true;
-
   SetEventState(HWEvent::PANEL_DEAD, false);
   SetEventState(HWEvent::IDLE_POWER_COLLAPSE, false);
   SetEventState(HWEvent::HW_RECOVERY, false);
@@ -350,9 +593,12 @@ DisplayError HWEventsDRM::Deinit() {
   SetEventState(HWEvent::POWER_EVENT, false);
   SetEventState(HWEvent::VM_RELEASE_EVENT, false);
 
-  Sys::pthread_cancel_(event_thread_);
-  WakeUpEventThread();
-  pthread_join(event_thread_, NULL);
+  // Unregister() returns only once no dispatch for these fds is in flight.
+  for (uint32_t i = 0; i < poll_fds_.size(); i++) {
+    if (poll_fds_[i].fd >= 0 && event_data_list_[i].event_type != HWEvent::EXIT) {
+      HWEventsReactor::GetInstance()->Unregister(poll_fds_[i].fd);
+    }
+  }
   CloseFds();
 
   return kErrorNone;
@@ -440,20 +686,6 @@ DisplayError HWEventsDRM::SetEventState(HWEvent event, bool enable, void *arg) {
   return kErrorNone;
 }
 
-void HWEventsDRM::WakeUpEventThread() {
-  for (uint32_t i = 0; i < event_data_list_.size(); i++) {
-    if (event_data_list_[i].event_type == HWEvent::EXIT && poll_fds_[i].fd >= 0) {
-      uint64_t exit_value = 1;
-      ssize_t write_size = Sys::write_(poll_fds_[i].fd, &exit_value, sizeof(uint64_t));
-      if (write_size != sizeof(uint64_t)) {
-        DLOGW("Error triggering exit fd (%d). write size = %zu, error = %s", poll_fds_[i].fd,
-              static_cast<size_t>(write_size), strerror(errno));
-      }
-      break;
-    }
-  }
-}
-
 void HWEventsDRM::CloseFds() {
   for (uint32_t i = 0; i < event_data_list_.size(); i++) {
     switch (event_data_list_[i].event_type) {
@@ -494,96 +726,55 @@ void HWEventsDRM::CloseFds() {
   }
 }
 
-void *HWEventsDRM::DisplayEventThread(void *context) {
-  if (context) {
-    return reinterpret_cast<HWEventsDRM *>(context)->DisplayEventHandler();
-  }
-
-  return NULL;
-}
-
-void *HWEventsDRM::DisplayEventHandler() {
+void HWEventsDRM::ProcessPollFd(uint32_t index, uint32_t revents) {
   char data[kMaxStringLength]{};
-
-  prctl(PR_SET_NAME, event_thread_name_.c_str(), 0, 0, 0);
-  setpriority(PRIO_PROCESS, 0, kThreadPriorityUrgent);
-
-  // Real Time task with lowest priority.
-  struct sched_param param = {0};
-  param.sched_priority = sched_get_priority_min(SCHED_FIFO);
-  sched_setscheduler(0, SCHED_FIFO, &param);
-
-  while (!exit_threads_) {
-    int error = Sys::poll_(poll_fds_.data(), UINT32(poll_fds_.size()), -1);
-    if (error <= 0) {
-      DLOGW("poll failed. error = %s", strerror(errno));
-      continue;
-    }
-
-    for (uint32_t i = 0; i < event_data_list_.size(); i++) {
-      pollfd &poll_fd = poll_fds_[i];
-      if (poll_fd.fd < 0) {
-        continue;
+  pollfd &poll_fd = poll_fds_[index];
+
+  switch (event_data_list_[index].event_type) {
+    case HWEvent::VSYNC:
+    case HWEvent::PANEL_DEAD:
+    case HWEvent::IDLE_POWER_COLLAPSE:
+    case HWEvent::HW_RECOVERY:
+    case HWEvent::HISTOGRAM:
+    case HWEvent::MMRM:
+    case HWEvent::POWER_EVENT:
+    case HWEvent::VM_RELEASE_EVENT:
+      if (revents & (EPOLLIN | EPOLLPRI | EPOLLERR)) {
+        (this->*(event_data_list_[index]).event_parser)(nullptr);
       }
-
-      switch (event_data_list_[i].event_type) {
-        case HWEvent::VSYNC:
-        case HWEvent::PANEL_DEAD:
-        case HWEvent::IDLE_POWER_COLLAPSE:
-        case HWEvent::HW_RECOVERY:
-        case HWEvent::HISTOGRAM:
-        case HWEvent::MMRM:
-        case HWEvent::POWER_EVENT:
-        case HWEvent::VM_RELEASE_EVENT:
-          if (poll_fd.revents & (POLLIN | POLLPRI | POLLERR)) {
-            (this->*(event_data_list_[i]).event_parser)(nullptr);
-          }
-          break;
-        case HWEvent::EXIT:
-          if ((poll_fd.revents & POLLIN) &&
-              (Sys::read_(poll_fd.fd, data, kMaxStringLength) > 0)) {
-            (this->*(event_data_list_[i]).event_parser)(data);
-          }
-          break;
-        case HWEvent::BACKLIGHT_EVENT:
-          if ((poll_fd.revents & POLLIN)) {
-            char buffer[kMaxEventBufferLength] = {};
-            int len = 0;
-            int length = Sys::read_(poll_fd.fd, buffer, kMaxEventBufferLength);
-            while (len < length) {
-              struct inotify_event *event = (struct inotify_event *) &buffer[len];
-              DLOGI("event masks %x in_modify %x", event->mask, IN_MODIFY);
-              if (event->mask & IN_MODIFY) {
-                int brightness_fd = Sys::open_(brightness_node_.c_str(), O_RDONLY);
-                if (brightness_fd > 0) {
-                  if (Sys::read_(brightness_fd, data, kMaxStringLength) > 0) {
-                      (this->*(event_data_list_[i]).event_parser)(data);
-                  }
-                  Sys::close_(brightness_fd);
-                }
+      break;
+    case HWEvent::BACKLIGHT_EVENT:
+      if ((revents & EPOLLIN)) {
+        char buffer[kMaxEventBufferLength] = {};
+        int len = 0;
+        int length = Sys::read_(poll_fd.fd, buffer, kMaxEventBufferLength);
+        while (len < length) {
+          struct inotify_event *event = (struct inotify_event *) &buffer[len];
+          DLOGI("event masks %x in_modify %x", event->mask, IN_MODIFY);
+          if (event->mask & IN_MODIFY) {
+            int brightness_fd = Sys::open_(brightness_node_.c_str(), O_RDONLY);
+            if (brightness_fd > 0) {
+              if (Sys::read_(brightness_fd, data, kMaxStringLength) > 0) {
+                  (this->*(event_data_list_[index]).event_parser)(data);
               }
-              len += sizeof(struct inotify_event) + event->len;
+              Sys::close_(brightness_fd);
             }
-          }  break;
-        case HWEvent::CEC_READ_MESSAGE:
-        case HWEvent::SHOW_BLANK_EVENT:
-        case HWEvent::THERMAL_LEVEL:
-        case HWEvent::PINGPONG_TIMEOUT:
-          if ((poll_fd.revents & POLLPRI) &&
-              (Sys::pread_(poll_fd.fd, data, kMaxStringLength, 0) > 0)) {
-            (this->*(event_data_list_[i]).event_parser)(data);
           }
-          break;
-        default:
-          break;
+          len += sizeof(struct inotify_event) + event->len;
+        }
+      }  break;
+    case HWEvent::CEC_READ_MESSAGE:
+    case HWEvent::SHOW_BLANK_EVENT:
+    case HWEvent::THERMAL_LEVEL:
+    case HWEvent::PINGPONG_TIMEOUT:
+      if ((revents & EPOLLPRI) &&
+          (Sys::pread_(poll_fd.fd, data, kMaxStringLength, 0) > 0)) {
+        (this->*(event_data_list_[index]).event_parser)(data);
       }
-    }
+      break;
+    default:
+      break;
   }
-
-  DLOGI("Exiting the thread");
-  pthread_exit(0);
-
-  return nullptr;
 }
 
 DisplayError HWEventsDRM::RegisterVSync() {
@@ -71,9 +71,13 @@
 #include <sys/inotify.h>
 #include <private/hw_events_interface.h>
 #include <private/hw_interface.h>
+#include <condition_variable>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <climits>
@@ -85,6 +89,61 @@ namespace sdm {
 
 using std::vector;
 
+class HWEventsDRM;
+
+// Epoll-based reactor shared by all HWEventsDRM instances. Two threads demultiplex the DRM
+// event fds of every display instead of one poll() thread per display, cutting idle wakeups
+// and the cross-thread handoff on vsync delivery. Sources are split across two scheduling
+// tiers: commit-critical fds (vsync/pageflip delivery) dispatch on a SCHED_FIFO thread, while
+// bursty slow-path fds (histogram blobs, MMRM, panel events) drain on a normal-priority
+// thread so a blob burst cannot delay pageflip handling. Each tier's thread is started with
+// its first registered fd and wound down when its last one is removed.
+class HWEventsReactor {
+ public:
+  enum Tier {
+    kTierUrgent = 0,  // commit-critical: dispatched on the SCHED_FIFO reactor thread
+    kTierBulk,        // bursty/slow-path: dispatched at normal priority
+    kTierMax,
+  };
+
+  static HWEventsReactor *GetInstance();
+  DisplayError Register(int fd, HWEventsDRM *events, uint32_t index, Tier tier);
+  void Unregister(int fd);
+
+ private:
+  struct Source {
+    HWEventsDRM *events = nullptr;
+    uint32_t index = 0;
+  };
+
+  typedef std::unordered_map<int, Source> SourceMap;
+
+  // Per-tier reactor state; each tier owns its epoll set, wake fd and dispatch thread.
+  struct Lane {
+    int epoll_fd = -1;
+    int wake_fd = -1;
+    std::thread thread;
+    bool running = false;
+    bool exit_thread = false;
+    uint64_t dispatch_seq = 0;  // odd while a dispatch batch is in flight
+    std::shared_ptr<const SourceMap> sources = std::make_shared<const SourceMap>();
+  };
+
+  HWEventsReactor() = default;
+  DisplayError Start(Tier tier);  // called with lock_ held
+  void Stop(Tier tier);           // called with lock_ held
+  void ReactorThread(Tier tier);
+
+  // Source table updates are serialized by lock_, but dispatch runs against an immutable
+  // snapshot taken once per wakeup, so panel-rate events (vsync, DPPS histogram) are not
+  // serialized behind registration churn. Unregister() publishes a snapshot without the fd
+  // and then waits for any in-flight dispatch batch on that tier to drain, preserving the
+  // guarantee that no further callbacks reach the caller once it returns.
+  std::mutex lock_;
+  std::condition_variable dispatch_cv_;
+  Lane lanes_[kTierMax];
+};
+
 class HWEventsDRM : public HWEventsInterface {
  public:
   virtual DisplayError Init(int display_id, DisplayType display_type, HWEventHandler *event_handler,
@@ -103,11 +162,10 @@ class HWEventsDRM : public HWEventsInterface {
     EventParser event_parser {};
   };
 
-  static void *DisplayEventThread(void *context);
   static void VSyncHandlerCallback(int fd, unsigned int sequence, unsigned int tv_sec,
                                    unsigned int tv_usec, void *data);
 
-  void *DisplayEventHandler();
+  void ProcessPollFd(uint32_t index, uint32_t revents);
   void HandleVSync(char *data);
   void HandleCECMessage(char *data);
   void HandleThreadExit(char *data) {}
@@ -123,8 +181,8 @@ class HWEventsDRM : public HWEventsInterface {
   void HandleVmReleaseEvent(char * /*data*/);
   int SetHwRecoveryEvent(const uint32_t hw_event_code, HWRecoveryEvent *sdm_event_code);
   void PopulateHWEventData(const vector<HWEvent> &event_list);
-  void WakeUpEventThread();
   DisplayError SetEventParser();
+  int OpenDRMEventFd();
   DisplayError InitializePollFd();
   void CloseFds();
   DisplayError RegisterVSync();
@@ -139,9 +197,7 @@ class HWEventsDRM : public HWEventsInterface {
   HWEventHandler *event_handler_{};
   vector<HWEventData> event_data_list_{};
   vector<pollfd> poll_fds_{};
-  pthread_t event_thread_{};
   std::string event_thread_name_ = "SDM_EventThread";
-  bool exit_threads_ = false;
   uint32_t vsync_index_ = UINT32_MAX;
   uint32_t histogram_index_ = UINT32_MAX;
   bool vsync_enabled_ = false;
@@ -163,6 +219,8 @@ class HWEventsDRM : public HWEventsInterface {
   uint32_t power_event_index_ = UINT32_MAX;
   uint32_t vm_release_event_index_ = UINT32_MAX;
   std::bitset<HW_EVENT_MAX> registered_hw_events_ = {};
+
+  friend class HWEventsReactor;
 };
 
 }  // namespace sdm
@@ -65,18 +65,23 @@
  * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <display_scanout_caps.h>
 #include <dlfcn.h>
 #include <drm/drm_fourcc.h>
 #include <drm_lib_loader.h>
 #include <drm_master.h>
 #include <drm_res_mgr.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <display/media/msm_sde_rotator.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/utsname.h>
+#include <unistd.h>
 #include <utils/constants.h>
 #include <utils/debug.h>
 #include <utils/sys.h>
@@ -124,6 +129,290 @@ using std::to_string;
 
 namespace sdm {
 
+namespace {
+
+// Capability snapshot cache. Probing every DRM plane, blob and property at composer startup
+// costs tens of milliseconds on the cold-boot critical path, but the result only changes with
+// a new kernel/driver build or different tuning properties. The probed HWResourceInfo is
+// serialized to a versioned binary file keyed on those inputs and mmap-loaded on later boots.
+// Boot-specific state (continuous splash ownership) is always re-probed and overlaid.
+const char *kSnapshotPath = "/data/vendor/display/hw_resource_snapshot.bin";
+const uint32_t kSnapshotMagic = 0x434D4453;  // 'SDMC'
+// Bump whenever the field list visited below changes.
+const uint32_t kSnapshotVersion = 1;
+const uint32_t kMaxSnapshotElements = 65536;
+
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t build_id_size;
+  uint32_t payload_size;
+};
+
+// Writer/reader expose the same method names, so a single templated visitor defines the
+// serialized field list for both directions.
+class SnapshotWriter {
+ public:
+  template <typename T>
+  void Pod(const T *value) {
+    buf_.append(reinterpret_cast<const char *>(value), sizeof(T));
+  }
+  void Str(const std::string *str) {
+    uint32_t count = UINT32(str->size());
+    Pod(&count);
+    buf_.append(*str);
+  }
+  template <typename T>
+  void PodVector(const std::vector<T> *vec) {
+    uint32_t count = UINT32(vec->size());
+    Pod(&count);
+    for (const T &value : *vec) {
+      Pod(&value);
+    }
+  }
+  template <typename K, typename V>
+  void PodMap(const std::map<K, V> *m) {
+    uint32_t count = UINT32(m->size());
+    Pod(&count);
+    for (const auto &it : *m) {
+      Pod(&it.first);
+      Pod(&it.second);
+    }
+  }
+  void Bits(const std::bitset<32> *bits) {
+    uint32_t value = UINT32(bits->to_ulong());
+    Pod(&value);
+  }
+  uint32_t Count(uint32_t count) {
+    Pod(&count);
+    return count;
+  }
+  bool ok() const { return true; }
+  const std::string &data() const { return buf_; }
+
+ private:
+  std::string buf_;
+};
+
+class SnapshotReader {
+ public:
+  SnapshotReader(const uint8_t *data, size_t size) : cur_(data), end_(data + size) {}
+  template <typename T>
+  void Pod(T *value) {
+    if (!Consumable(sizeof(T))) {
+      return;
+    }
+    memcpy(value, cur_, sizeof(T));
+    cur_ += sizeof(T);
+  }
+  void Str(std::string *str) {
+    uint32_t count = 0;
+    Pod(&count);
+    if (!Consumable(count)) {
+      return;
+    }
+    str->assign(reinterpret_cast<const char *>(cur_), count);
+    cur_ += count;
+  }
+  template <typename T>
+  void PodVector(std::vector<T> *vec) {
+    uint32_t count = 0;
+    Pod(&count);
+    if (!Consumable(count * sizeof(T))) {
+      return;
+    }
+    vec->resize(count);
+    for (T &value : *vec) {
+      Pod(&value);
+    }
+  }
+  template <typename K, typename V>
+  void PodMap(std::map<K, V> *m) {
+    uint32_t count = 0;
+    Pod(&count);
+    m->clear();
+    for (uint32_t i = 0; ok_ && i < count; i++) {
+      K key = {};
+      V value = {};
+      Pod(&key);
+      Pod(&value);
+      if (ok_) {
+        (*m)[key] = value;
+      }
+    }
+  }
+  void Bits(std::bitset<32> *bits) {
+    uint32_t value = 0;
+    Pod(&value);
+    *bits = value;
+  }
+  uint32_t Count(uint32_t count) {
+    uint32_t stored = 0;
+    Pod(&stored);
+    if (stored > kMaxSnapshotElements) {
+      ok_ = false;
+      return 0;
+    }
+    return stored;
+  }
+  bool ok() const { return ok_ && cur_ == end_; }
+
+ private:
+  bool Consumable(size_t bytes) {
+    if (!ok_ || static_cast<size_t>(end_ - cur_) < bytes) {
+      ok_ = false;
+    }
+    return ok_;
+  }
+
+  const uint8_t *cur_;
+  const uint8_t *end_;
+  bool ok_ = true;
+};
+
+template <typename Ar>
+void VisitPipeCaps(Ar *ar, HWPipeCaps *pipe) {
+  ar->Pod(&pipe->type);
+  ar->Pod(&pipe->id);
+  ar->Pod(&pipe->master_pipe_id);
+  ar->Pod(&pipe->max_rects);
+  ar->Pod(&pipe->inverse_pma);
+  ar->Pod(&pipe->dgm_csc_version);
+  ar->PodMap(&pipe->tm_lut_version_map);
+  ar->PodMap(&pipe->ucsc_block_version_map);
+  ar->Pod(&pipe->block_sec_ui);
+  ar->Pod(&pipe->cont_splash_disp_id);
+  ar->Pod(&pipe->splash_type);
+  ar->Pod(&pipe->pipe_idx);
+  ar->Pod(&pipe->demura_block_capability);
+}
+
+template <typename Ar>
+void VisitResourceInfo(Ar *ar, HWResourceInfo *hw) {
+  ar->Pod(&hw->hw_version);
+  ar->Pod(&hw->num_dma_pipe);
+  ar->Pod(&hw->num_vig_pipe);
+  ar->Pod(&hw->num_rgb_pipe);
+  ar->Pod(&hw->num_cursor_pipe);
+  ar->Pod(&hw->num_blending_stages);
+  ar->Pod(&hw->num_solidfill_stages);
+  ar->Pod(&hw->max_scale_up);
+  ar->Pod(&hw->max_scale_down);
+  ar->Pod(&hw->max_bandwidth_low);
+  ar->Pod(&hw->max_bandwidth_high);
+  ar->Pod(&hw->max_mixer_width);
+  ar->Pod(&hw->max_pipe_width);
+  ar->Pod(&hw->max_pipe_width_dma);
+  ar->Pod(&hw->max_scaler_pipe_width);
+  ar->Pod(&hw->max_rotation_pipe_width);
+  ar->Pod(&hw->max_cursor_size);
+  ar->Pod(&hw->max_pipe_bw);
+  ar->Pod(&hw->max_pipe_bw_high);
+  ar->Pod(&hw->max_sde_clk);
+  ar->Pod(&hw->clk_fudge_factor);
+  ar->Pod(&hw->macrotile_nv12_factor);
+  ar->Pod(&hw->macrotile_factor);
+  ar->Pod(&hw->linear_factor);
+  ar->Pod(&hw->scale_factor);
+  ar->Pod(&hw->extra_fudge_factor);
+  ar->Pod(&hw->amortizable_threshold);
+  ar->Pod(&hw->system_overhead_lines);
+  ar->Pod(&hw->has_ubwc);
+  ar->Pod(&hw->has_decimation);
+  ar->Pod(&hw->has_non_scalar_rgb);
+  ar->Pod(&hw->is_src_split);
+  ar->Pod(&hw->separate_rotator);
+  ar->Pod(&hw->has_qseed3);
+  ar->Pod(&hw->has_concurrent_writeback);
+  ar->PodVector(&hw->tap_points);
+  ar->Pod(&hw->has_ppp);
+  ar->Pod(&hw->has_excl_rect);
+  ar->Pod(&hw->writeback_index);
+  ar->Pod(&hw->dyn_bw_info);
+  uint32_t pipe_count = ar->Count(UINT32(hw->hw_pipes.size()));
+  if (!ar->ok()) {
+    return;
+  }
+  hw->hw_pipes.resize(pipe_count);
+  for (HWPipeCaps &pipe : hw->hw_pipes) {
+    VisitPipeCaps(ar, &pipe);
+  }
+  uint32_t fmt_blk_count = ar->Count(UINT32(hw->supported_formats_map.size()));
+  if (!ar->ok()) {
+    return;
+  }
+  std::vector<std::pair<HWSubBlockType, std::vector<LayerBufferFormat>>> fmt_blks(
+      hw->supported_formats_map.begin(), hw->supported_formats_map.end());
+  fmt_blks.resize(fmt_blk_count);
+  for (auto &blk : fmt_blks) {
+    ar->Pod(&blk.first);
+    ar->PodVector(&blk.second);
+  }
+  hw->supported_formats_map = FormatsMap(fmt_blks.begin(), fmt_blks.end());
+  ar->Pod(&hw->hw_rot_info.num_rotator);
+  ar->Pod(&hw->hw_rot_info.has_downscale);
+  ar->Str(&hw->hw_rot_info.device_path);
+  ar->Pod(&hw->hw_rot_info.min_downscale);
+  ar->Pod(&hw->hw_rot_info.downscale_compression);
+  ar->Pod(&hw->hw_rot_info.max_line_width);
+  ar->Pod(&hw->hw_dest_scalar_info);
+  ar->Pod(&hw->has_hdr);
+  ar->Pod(&hw->smart_dma_rev);
+  ar->Pod(&hw->ib_fudge_factor);
+  ar->Pod(&hw->undersized_prefill_lines);
+  ar->PodMap(&hw->comp_ratio_rt_map);
+  ar->PodMap(&hw->comp_ratio_nrt_map);
+  ar->Pod(&hw->cache_size);
+  ar->Pod(&hw->pipe_qseed3_version);
+  ar->Pod(&hw->min_prefill_lines);
+  ar->Pod(&hw->inline_rot_info.inrot_version);
+  ar->PodVector(&hw->inline_rot_info.inrot_fmts_supported);
+  ar->Pod(&hw->inline_rot_info.max_downscale_rt);
+  ar->Pod(&hw->inline_rot_info.max_ds_without_pre_downscaler);
+  ar->Bits(&hw->src_tone_map);
+  ar->Pod(&hw->secure_disp_blend_stage);
+  ar->Pod(&hw->line_width_constraints_count);
+  ar->PodVector(&hw->line_width_limits);
+  ar->PodVector(&hw->line_width_constraints);
+  ar->Pod(&hw->num_mnocports);
+  ar->Pod(&hw->mnoc_bus_width);
+  ar->Pod(&hw->use_baselayer_for_stage);
+  ar->Pod(&hw->has_micro_idle);
+  ar->Pod(&hw->ubwc_version);
+  ar->Pod(&hw->rc_total_mem_size);
+  ar->PodMap(&hw->plane_to_connector);
+  ar->PodVector(&hw->initial_demura_planes);
+  ar->Pod(&hw->demura_count);
+  ar->Pod(&hw->dspp_count);
+  ar->Pod(&hw->skip_inline_rot_threshold);
+  ar->Pod(&hw->has_noise_layer);
+  ar->Pod(&hw->dsc_block_count);
+  ar->Pod(&hw->ddr_version);
+}
+
+// Key the snapshot on the kernel/driver build and the tuning inputs that steer probing, so a
+// driver update or changed debug property invalidates it.
+std::string SnapshotBuildId() {
+  struct utsname info = {};
+  if (uname(&info) < 0) {
+    return "";
+  }
+
+  uint32_t max_vig_pipes = 0;
+  uint32_t max_dma_pipes = 0;
+  Debug::GetReducedConfig(&max_vig_pipes, &max_dma_pipes);
+  int disable_src_tonemap = 0;
+  Debug::Get()->GetProperty(DISABLE_SRC_TONEMAP_PROP, &disable_src_tonemap);
+  int disable_dest_scalar = 0;
+  Debug::GetProperty(DISABLE_DESTINATION_SCALER_PROP, &disable_dest_scalar);
+
+  return std::string(info.release) + " " + info.version + " " + to_string(max_vig_pipes) + " " +
+         to_string(max_dma_pipes) + " " + to_string(disable_src_tonemap) + " " +
+         to_string(disable_dest_scalar);
+}
+
+}  // namespace
+
 static HWQseedStepVersion GetQseedStepVersion(sde_drm::QSEEDStepVersion drm_version) {
   HWQseedStepVersion sdm_version;
   switch (drm_version) {
@@ -167,7 +456,7 @@ static InlineRotationVersion GetInRotVersion(sde_drm::InlineRotationVersion drm_
   }
 }
 
-HWResourceInfo *HWInfoDRM::hw_resource_ = nullptr;
+std::shared_ptr<const HWResourceInfo> HWInfoDRM::hw_resource_ = nullptr;
 
 DisplayError HWInfoDRM::Init() {
   default_mode_ = (DRMLibLoader::GetInstance()->IsLoaded() == false);
@@ -200,7 +489,7 @@ DisplayError HWInfoDRM::Init() {
 }
 
 void HWInfoDRM::Deinit() {
-  delete hw_resource_;
+  // Consumers holding the snapshot keep it alive; only the cache reference is dropped.
   hw_resource_ = nullptr;
 
   if (drm_mgr_intf_) {
@@ -234,12 +523,137 @@ DisplayError HWInfoDRM::GetDynamicBWLimits(HWResourceInfo *hw_resource) {
   return kErrorNone;
 }
 
+bool HWInfoDRM::LoadResourceSnapshot(HWResourceInfo *hw_resource) {
+  int disable_snapshot = 0;
+  Debug::GetProperty(DISABLE_HW_CAPS_SNAPSHOT_PROP, &disable_snapshot);
+  if (disable_snapshot) {
+    return false;
+  }
+
+  std::string build_id = SnapshotBuildId();
+  if (build_id.empty()) {
+    return false;
+  }
+
+  int fd = Sys::open_(kSnapshotPath, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat stat_buf = {};
+  if (fstat(fd, &stat_buf) < 0 || stat_buf.st_size < static_cast<off_t>(sizeof(SnapshotHeader))) {
+    Sys::close_(fd);
+    return false;
+  }
+
+  size_t map_size = static_cast<size_t>(stat_buf.st_size);
+  void *base = mmap(nullptr, map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  Sys::close_(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+
+  bool loaded = false;
+  const uint8_t *data = static_cast<const uint8_t *>(base);
+  const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(data);
+  do {
+    if (header->magic != kSnapshotMagic || header->version != kSnapshotVersion) {
+      break;
+    }
+    size_t expected_size = sizeof(SnapshotHeader) + header->build_id_size + header->payload_size;
+    if (map_size != expected_size || header->build_id_size != build_id.size()) {
+      break;
+    }
+    if (memcmp(data + sizeof(SnapshotHeader), build_id.data(), build_id.size())) {
+      break;
+    }
+    SnapshotReader reader(data + sizeof(SnapshotHeader) + header->build_id_size,
+                          header->payload_size);
+    VisitResourceInfo(&reader, hw_resource);
+    loaded = reader.ok();
+  } while (false);
+  munmap(base, map_size);
+
+  if (!loaded) {
+    // Stale or corrupt snapshot. Drop it and fall back to full probing, which rewrites it.
+    unlink(kSnapshotPath);
+    *hw_resource = HWResourceInfo();
+    return false;
+  }
+
+  // Continuous splash ownership is boot-specific state. Re-probe it and overlay onto the
+  // cached capabilities.
+  hw_resource->plane_to_connector.clear();
+  hw_resource->initial_demura_planes.clear();
+  MapPlaneToConnector(hw_resource);
+  GetInitialDemuraInfo(hw_resource);
+  for (HWPipeCaps &pipe_caps : hw_resource->hw_pipes) {
+    pipe_caps.cont_splash_disp_id = -1;
+    pipe_caps.splash_type = kSplashNone;
+    auto it = hw_resource->plane_to_connector.find(pipe_caps.id);
+    if (it != hw_resource->plane_to_connector.end()) {
+      pipe_caps.cont_splash_disp_id = INT32(it->second);
+      auto it2 = std::find(hw_resource->initial_demura_planes.begin(),
+                           hw_resource->initial_demura_planes.end(), pipe_caps.id);
+      pipe_caps.splash_type = (it2 != hw_resource->initial_demura_planes.end()) ? kSplashDemura
+                                                                                : kSplashLayer;
+    }
+  }
+
+  return true;
+}
+
+void HWInfoDRM::StoreResourceSnapshot(const HWResourceInfo &hw_resource) {
+  int disable_snapshot = 0;
+  Debug::GetProperty(DISABLE_HW_CAPS_SNAPSHOT_PROP, &disable_snapshot);
+  if (disable_snapshot) {
+    return;
+  }
+
+  std::string build_id = SnapshotBuildId();
+  if (build_id.empty()) {
+    return;
+  }
+
+  SnapshotWriter writer;
+  HWResourceInfo copy = hw_resource;
+  VisitResourceInfo(&writer, &copy);
+
+  SnapshotHeader header = {kSnapshotMagic, kSnapshotVersion, UINT32(build_id.size()),
+                           UINT32(writer.data().size())};
+
+  std::string tmp_path = std::string(kSnapshotPath) + ".tmp";
+  FILE *file = fopen(tmp_path.c_str(), "wb");
+  if (!file) {
+    return;
+  }
+
+  bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                 fwrite(build_id.data(), build_id.size(), 1, file) == 1 &&
+                 fwrite(writer.data().data(), writer.data().size(), 1, file) == 1;
+  fclose(file);
+
+  if (!written || rename(tmp_path.c_str(), kSnapshotPath) < 0) {
+    unlink(tmp_path.c_str());
+    return;
+  }
+
+  DLOGI("Stored HW capability snapshot (%zu bytes)", sizeof(header) + build_id.size() +
+        writer.data().size());
+}
+
 DisplayError HWInfoDRM::GetHWResourceInfo(HWResourceInfo *hw_resource) {
   if (hw_resource_) {
     *hw_resource = *hw_resource_;
     return kErrorNone;
   }
 
+  if (LoadResourceSnapshot(hw_resource)) {
+    DLOGI("Serving HW capabilities from snapshot, skipping DRM probe");
+    hw_resource_ = std::make_shared<const HWResourceInfo>(*hw_resource);
+    return kErrorNone;
+  }
+
   hw_resource->num_blending_stages = 1;
   hw_resource->max_pipe_width = 5120;
   hw_resource->max_cursor_size = 128;
@@ -339,13 +753,26 @@ DisplayError HWInfoDRM::GetHWResourceInfo(HWResourceInfo *hw_resource) {
   }
 
   if (!hw_resource_) {
-    hw_resource_ = new HWResourceInfo();
-    *hw_resource_ = *hw_resource;
+    hw_resource_ = std::make_shared<const HWResourceInfo>(*hw_resource);
   }
 
+  StoreResourceSnapshot(*hw_resource);
+
   return kErrorNone;
 }
 
+std::shared_ptr<const HWResourceInfo> HWInfoDRM::GetHWResourceInfo() {
+  if (!hw_resource_) {
+    // First query probes (or loads) the capabilities and caches the shared snapshot.
+    HWResourceInfo hw_resource;
+    if (GetHWResourceInfo(&hw_resource) != kErrorNone) {
+      return nullptr;
+    }
+  }
+
+  return hw_resource_;
+}
+
 void HWInfoDRM::GetSystemInfo(HWResourceInfo *hw_resource) {
   DRMCrtcInfo info;
   drm_mgr_intf_->GetCrtcInfo(0 /* system_info */, &info);
@@ -600,6 +1027,68 @@ void HWInfoDRM::GetHWPlanesInfo(HWResourceInfo *hw_resource) {
     hw_resource->hw_pipes.push_back(std::move(pipe_caps));
   }
   hw_resource->has_excl_rect = planes[0].second.has_excl_rect;
+
+  PublishScanoutCaps(planes, hw_resource);
+}
+
+void HWInfoDRM::PublishScanoutCaps(const sde_drm::DRMPlanesInfo &planes,
+                                   const HWResourceInfo *hw_resource) {
+  // Merge the (format, modifier) pairs the scanout pipes advertise; gralloc reads the table
+  // to avoid picking compressed modifiers the display would reject at validate time.
+  std::map<std::pair<uint32_t, uint64_t>, ScanoutCapsEntry> merged;
+  for (auto &pipe_obj : planes) {
+    DRMPlaneType type = pipe_obj.second.type;
+    if (type != DRMPlaneType::VIG && type != DRMPlaneType::DMA) {
+      continue;
+    }
+    uint32_t max_width = (type == DRMPlaneType::VIG) ? hw_resource->max_pipe_width
+                                                     : hw_resource->max_pipe_width_dma;
+    for (auto &fmt : pipe_obj.second.formats_supported) {
+      ScanoutCapsEntry &entry = merged[fmt];
+      entry.drm_format = fmt.first;
+      entry.modifier = fmt.second;
+      entry.max_width = std::max(entry.max_width, max_width);
+      entry.max_height = 0;  // pipes have no height limit of their own
+    }
+    if (type == DRMPlaneType::VIG) {
+      for (auto &fmt : pipe_obj.second.inrot_fmts_supported) {
+        auto it = merged.find(fmt);
+        if (it != merged.end()) {
+          it->second.flags |= SCANOUT_CAP_INLINE_ROTATION;
+        }
+      }
+    }
+  }
+
+  if (merged.empty()) {
+    return;
+  }
+
+  // Write to a temp file and rename so readers never see a partial table.
+  std::string tmp_path = std::string(SCANOUT_CAPS_FILE) + ".tmp";
+  FILE *file = fopen(tmp_path.c_str(), "wb");
+  if (!file) {
+    DLOGW("Failed to open %s, error %d", tmp_path.c_str(), errno);
+    return;
+  }
+
+  ScanoutCapsHeader header = {SCANOUT_CAPS_MAGIC, SCANOUT_CAPS_VERSION, UINT32(merged.size()), 0};
+  bool success = (fwrite(&header, sizeof(header), 1, file) == 1);
+  for (auto &it : merged) {
+    if (!success) {
+      break;
+    }
+    success = (fwrite(&it.second, sizeof(ScanoutCapsEntry), 1, file) == 1);
+  }
+  fclose(file);
+
+  if (!success || rename(tmp_path.c_str(), SCANOUT_CAPS_FILE)) {
+    DLOGW("Failed to publish scanout caps, error %d", errno);
+    unlink(tmp_path.c_str());
+    return;
+  }
+
+  DLOGI("Published %d scanout format/modifier pairs", UINT32(merged.size()));
 }
 
 void HWInfoDRM::MapPlaneToConnector(HWResourceInfo *hw_resource) {
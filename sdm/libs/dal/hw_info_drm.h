@@ -47,6 +47,7 @@
 #include <bitset>
 #include <vector>
 #include <map>
+#include <memory>
 #include <string>
 
 namespace sdm {
@@ -56,6 +57,7 @@ class HWInfoDRM : public HWInfoInterface {
   virtual DisplayError Init();
   virtual ~HWInfoDRM();
   virtual DisplayError GetHWResourceInfo(HWResourceInfo *hw_resource);
+  virtual std::shared_ptr<const HWResourceInfo> GetHWResourceInfo();
   virtual DisplayError GetFirstDisplayInterfaceType(HWDisplayInterfaceInfo *hw_disp_info);
   virtual DisplayError GetDisplaysStatus(HWDisplaysInfo *hw_displays_info);
   virtual DisplayError GetMaxDisplaysSupported(DisplayType type, int32_t *max_displays);
@@ -82,10 +84,13 @@ class HWInfoDRM : public HWInfoInterface {
                              HWResourceInfo *hw_resource);
   void PopulateSupportedInlineFmts(const sde_drm::DRMPlaneTypeInfo &info,
                                    HWResourceInfo *hw_resource);
+  void PublishScanoutCaps(const sde_drm::DRMPlanesInfo &planes, const HWResourceInfo *hw_resource);
   void PopulatePipeCaps(const sde_drm::DRMPlaneTypeInfo &info, HWResourceInfo *hw_resource);
   void PopulatePipeBWCaps(const sde_drm::DRMPlaneTypeInfo &info, HWResourceInfo *hw_resource);
   void MapPlaneToConnector(HWResourceInfo *hw_resource);
   void GetInitialDemuraInfo(HWResourceInfo *hw_resource);
+  bool LoadResourceSnapshot(HWResourceInfo *hw_resource);
+  void StoreResourceSnapshot(const HWResourceInfo &hw_resource);
 
   sde_drm::DRMManagerInterface *drm_mgr_intf_ = {};
   bool default_mode_ = false;
@@ -94,7 +99,8 @@ class HWInfoDRM : public HWInfoInterface {
   static const int kMaxStringLength = 1024;
   static const int kKiloUnit = 1000;
 
-  static HWResourceInfo *hw_resource_;
+  // Immutable probe result shared with consumers; replaced wholesale, never edited in place.
+  static std::shared_ptr<const HWResourceInfo> hw_resource_;
 };
 
 }  // namespace sdm
@@ -113,7 +113,7 @@ DisplayError HWPeripheralDRM::Init() {
 
 void HWPeripheralDRM::InitDestScaler() {
 #ifndef TRUSTED_VM
-  if (hw_resource_.hw_dest_scalar_info.count) {
+  if (hw_resource_->hw_dest_scalar_info.count) {
     // Do all destination scaler block resource allocations here.
     dest_scaler_blocks_used_ = 1;
     if (kQuadSplit == mixer_attributes_.split_type) {
@@ -121,7 +121,7 @@ void HWPeripheralDRM::InitDestScaler() {
     } else if (kDualSplit == mixer_attributes_.split_type) {
       dest_scaler_blocks_used_ = 2;
     }
-    if (hw_resource_.hw_dest_scalar_info.count >=
+    if (hw_resource_->hw_dest_scalar_info.count >=
         (hw_dest_scaler_blocks_used_ + dest_scaler_blocks_used_)) {
       // Enough destination scaler blocks available so update the static counter.
       hw_dest_scaler_blocks_used_ += dest_scaler_blocks_used_;
@@ -281,7 +281,9 @@ DisplayError HWPeripheralDRM::Commit(HWLayersInfo *hw_layers_info) {
   int64_t cwb_fence_fd = -1;
   bool has_fence = SetupConcurrentWriteback(*hw_layers_info, false, &cwb_fence_fd);
 
+  UpdateEarlyWakeState(*hw_layers_info);
   SetIdlePCState();
+  SetEarlyWakeState();
   SetSelfRefreshState();
   SetVMReqState();
 
@@ -325,6 +327,70 @@ DisplayError HWPeripheralDRM::Commit(HWLayersInfo *hw_layers_info) {
   return error;
 }
 
+uint64_t HWPeripheralDRM::EarlyWakeLeadNs() {
+  // Time before the presentation instant by which programming must be done: the hardware
+  // starts fetching at the front porch in video mode, and needs the whole transfer window
+  // in command mode. A fixed margin covers the atomic commit programming itself.
+  uint64_t lead = kEarlyWakeMarginNs;
+  HWDisplayAttributes &attrib = display_attributes_[current_mode_index_];
+  if (hw_panel_info_.mode == kModeCommand) {
+    lead += UINT64(hw_panel_info_.transfer_time_us) * 1000;
+  } else if (attrib.v_total) {
+    lead += (UINT64(attrib.v_front_porch) * attrib.vsync_period_ns) / attrib.v_total;
+  }
+  return lead;
+}
+
+void HWPeripheralDRM::UpdateEarlyWakeState(const HWLayersInfo &hw_layers_info) {
+  uint64_t period = display_attributes_[current_mode_index_].vsync_period_ns;
+  if (!period) {
+    return;
+  }
+
+  struct timespec t = {0, 0};
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  uint64_t now = UINT64(t.tv_sec) * 1000000000ULL + UINT64(t.tv_nsec);
+
+  bool near_deadline = false;
+  uint64_t ept = hw_layers_info.expected_present_time;
+  if (ept && (now + EarlyWakeLeadNs() >= ept)) {
+    // Programming has already entered the fetch window of the requested present instant.
+    near_deadline = true;
+  }
+  if (last_commit_ns_ && (now - last_commit_ns_ > kEarlyWakeIdleFrames * period)) {
+    // First frame after an idle stretch pays idle power collapse wake latency on top of
+    // programming, which is the classic way to miss fetch start.
+    near_deadline = true;
+  }
+  last_commit_ns_ = now;
+
+  if (near_deadline) {
+    early_wake_frames_ = kEarlyWakeFrames;
+  }
+}
+
+void HWPeripheralDRM::SetEarlyWakeState() {
+  if (idle_pc_state_ != sde_drm::DRMIdlePCState::NONE || !idle_pc_enabled_) {
+    // An explicit idle power collapse transition owns the property this frame and
+    // overwrites whatever the timing engine asserted earlier.
+    early_wake_active_ = false;
+    return;
+  }
+
+  if (early_wake_frames_) {
+    early_wake_frames_--;
+    if (!early_wake_active_) {
+      drm_atomic_intf_->Perform(sde_drm::DRMOps::CRTC_SET_IDLE_PC_STATE, token_.crtc_id,
+                                sde_drm::DRMIdlePCState::DISABLE);
+      early_wake_active_ = true;
+    }
+  } else if (early_wake_active_) {
+    drm_atomic_intf_->Perform(sde_drm::DRMOps::CRTC_SET_IDLE_PC_STATE, token_.crtc_id,
+                              sde_drm::DRMIdlePCState::ENABLE);
+    early_wake_active_ = false;
+  }
+}
+
 void HWPeripheralDRM::ResetDestScalarCache() {
   for (uint32_t j = 0; j < scalar_data_.size(); j++) {
     dest_scalar_cache_[j] = {};
@@ -615,6 +681,9 @@ DisplayError HWPeripheralDRM::PowerOn(const HWQosData &qos_data, SyncPoints *syn
   }
   idle_pc_state_ = sde_drm::DRMIdlePCState::NONE;
   idle_pc_enabled_ = true;
+  early_wake_frames_ = 0;
+  early_wake_active_ = false;
+  last_commit_ns_ = 0;
   pending_poms_switch_ = false;
   active_ = true;
   SetTUIState();
@@ -656,6 +725,9 @@ DisplayError HWPeripheralDRM::PowerOff(bool teardown, SyncPoints *sync_points) {
 
   pending_poms_switch_ = false;
   active_ = false;
+  early_wake_frames_ = 0;
+  early_wake_active_ = false;
+  last_commit_ns_ = 0;
   SetTUIState();
 
   return kErrorNone;
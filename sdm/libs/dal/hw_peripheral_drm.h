@@ -128,6 +128,9 @@ class HWPeripheralDRM : public HWDeviceDRM, public PanelFeaturePropertyIntf {
   void SetSelfRefreshState();
   void SetVMReqState();
   void ResetPropertyCache();
+  void UpdateEarlyWakeState(const HWLayersInfo &hw_layers_info);
+  void SetEarlyWakeState();
+  uint64_t EarlyWakeLeadNs();
 
   struct DestScalarCache {
     SDEScaler scalar_data = {};
@@ -147,6 +150,17 @@ class HWPeripheralDRM : public HWDeviceDRM, public PanelFeaturePropertyIntf {
   SelfRefreshState self_refresh_state_ = kSelfRefreshNone;
   bool ltm_hist_en_ = false;
   bool aba_hist_en_ = false;
+
+  // Commit timing engine. Computes the latest-safe programming point from the panel's porch
+  // timing (video mode) or transfer time (command mode) and holds idle power collapse off for
+  // a few frames whenever a commit lands inside that window, so near-deadline frames do not
+  // also pay hardware wake latency and slip a full vsync.
+  static const uint32_t kEarlyWakeFrames = 4;          // frames to hold the early-wake state
+  static const uint32_t kEarlyWakeIdleFrames = 4;      // commit gap (in periods) treated as idle
+  static const uint64_t kEarlyWakeMarginNs = 500000;   // programming margin before fetch start
+  uint64_t last_commit_ns_ = 0;
+  uint32_t early_wake_frames_ = 0;
+  bool early_wake_active_ = false;
   std::map<PanelFeaturePropertyID, sde_drm::DRMPanelFeatureID> panel_feature_property_map_ {};
 };
 
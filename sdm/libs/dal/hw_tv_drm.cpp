@@ -63,6 +63,7 @@
  */
 
 #include "hw_tv_drm.h"
+#include <inttypes.h>
 #include <math.h>
 #include <sys/time.h>
 #include <utils/debug.h>
@@ -77,6 +78,8 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <future>
 #include <utility>
 
 #ifndef HDR_EOTF_SMTPE_ST2084
@@ -109,6 +112,21 @@ using sde_drm::DRMColorspace;
 
 namespace sdm {
 
+// Negotiated link parameters by sink identity. Static so entries outlive the HWTVDRM instance,
+// which is torn down on every unplug; a re-dock of the same monitor hits the cache.
+static std::mutex g_link_cache_lock;
+static std::map<uint64_t, HWTVDRM::NegotiatedLinkParams> g_link_cache;
+
+// Parsed mode attributes by EDID identity. Unlike the link-param cache this is keyed on the
+// EDID alone, so the second stream of an MST dock driving identical monitors reuses the first
+// stream's parse, as does a re-connect of a known sink on any port.
+struct SinkModeAttributes {
+  uint64_t mode_signature = 0;
+  std::vector<HWDisplayAttributes> attributes;
+};
+static std::mutex g_mode_attr_cache_lock;
+static std::map<uint64_t, SinkModeAttributes> g_mode_attr_cache;
+
 static uint64_t timeval_diff(std::chrono::time_point<SteadyClock> &start,
                              std::chrono::time_point<SteadyClock> &end) {
   return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
@@ -147,12 +165,229 @@ HWTVDRM::HWTVDRM(int32_t display_id, BufferAllocator *buffer_allocator,
   display_id_ = display_id;
 }
 
+DisplayError HWTVDRM::Init() {
+  DisplayError error = HWDeviceDRM::Init();
+  if (error != kErrorNone) {
+    return error;
+  }
+
+  sink_identity_ = SinkIdentity();
+  RestoreNegotiatedLinkParams();
+
+  return kErrorNone;
+}
+
+uint64_t HWTVDRM::EdidHash() const {
+  if (connector_info_.edid.empty()) {
+    return 0;
+  }
+
+  // FNV-1a over the EDID. Identifies the panel independent of which port or MST stream it
+  // shows up on.
+  uint64_t hash = 14695981039346656037ULL;
+  for (uint8_t byte : connector_info_.edid) {
+    hash = (hash ^ byte) * 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+uint64_t HWTVDRM::SinkIdentity() const {
+  uint64_t hash = EdidHash();
+  if (!hash) {
+    return 0;
+  }
+
+  // Mix in the physical port so identical monitors on different ports negotiate independently.
+  return (hash ^ token_.hw_port) * 1099511628211ULL;
+}
+
+uint64_t HWTVDRM::ModeListSignature() const {
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint32_t value) {
+    for (uint32_t i = 0; i < sizeof(value); i++) {
+      hash = (hash ^ ((value >> (8 * i)) & 0xFF)) * 1099511628211ULL;
+    }
+  };
+
+  mix(UINT32(connector_info_.modes.size()));
+  for (auto &item : connector_info_.modes) {
+    mix(item.mode.hdisplay);
+    mix(item.mode.vdisplay);
+    mix(item.mode.vrefresh);
+    mix(item.mode.clock);
+  }
+
+  return hash;
+}
+
+void HWTVDRM::InitializeConfigs() {
+  edid_identity_ = EdidHash();
+  deferred_attr_modes_ = 0;
+
+  HWDeviceDRM::InitializeConfigs();
+
+  if (!deferred_attr_modes_) {
+    return;
+  }
+
+  // An identical sink was parsed earlier this boot - either the other stream of an MST dock or
+  // a re-connect. Its attributes apply verbatim, so no enumeration is needed at all.
+  if (RestoreModeAttributesFromCache()) {
+    return;
+  }
+
+  // The preferred mode is populated and exposed already; enumerate the remaining modes off the
+  // bring-up critical path. Each pluggable display owns a worker, so the streams of a
+  // multi-sink dock enumerate in parallel instead of back to back.
+  mode_enum_future_ = std::async(std::launch::async, [this]() {
+    for (uint32_t i = 0; i < UINT32(connector_info_.modes.size()); i++) {
+      EnsureModeAttributes(i);
+    }
+    StoreModeAttributesInCache();
+  });
+}
+
+bool HWTVDRM::DeferModeAttributePopulation(uint32_t mode_index) {
+  if (mode_index == current_mode_index_) {
+    return false;  // The preferred mode must be ready before Init() returns.
+  }
+
+  std::lock_guard<std::mutex> lock(attr_populated_lock_);
+  if (attr_populated_.size() != connector_info_.modes.size()) {
+    attr_populated_.resize(connector_info_.modes.size(), 1);
+  }
+  attr_populated_[mode_index] = 0;
+  deferred_attr_modes_++;
+
+  return true;
+}
+
+void HWTVDRM::EnsureModeAttributes(uint32_t index) {
+  if (index >= connector_info_.modes.size()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(attr_populated_lock_);
+  if (index < attr_populated_.size() && !attr_populated_[index]) {
+    PopulateDisplayAttributes(index);
+    attr_populated_[index] = 1;
+  }
+}
+
+bool HWTVDRM::RestoreModeAttributesFromCache() {
+  if (!edid_identity_) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(g_mode_attr_cache_lock);
+  auto it = g_mode_attr_cache.find(edid_identity_);
+  if (it == g_mode_attr_cache.end() || it->second.mode_signature != ModeListSignature() ||
+      it->second.attributes.size() != display_attributes_.size()) {
+    return false;
+  }
+
+  display_attributes_ = it->second.attributes;
+  {
+    std::lock_guard<std::mutex> flags_lock(attr_populated_lock_);
+    attr_populated_.assign(connector_info_.modes.size(), 1);
+  }
+  DLOGI("Sink %" PRIx64 ": reused %zu parsed modes from shared cache", edid_identity_,
+        display_attributes_.size());
+
+  return true;
+}
+
+void HWTVDRM::StoreModeAttributesInCache() {
+  if (!edid_identity_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_mode_attr_cache_lock);
+  SinkModeAttributes &entry = g_mode_attr_cache[edid_identity_];
+  entry.mode_signature = ModeListSignature();
+  entry.attributes = display_attributes_;
+}
+
+void HWTVDRM::WaitForDeferredModeEnumeration() {
+  if (mode_enum_future_.valid()) {
+    mode_enum_future_.wait();
+  }
+}
+
+DisplayError HWTVDRM::GetDisplayAttributes(uint32_t index,
+                                           HWDisplayAttributes *display_attributes) {
+  EnsureModeAttributes(index);
+  return HWDeviceDRM::GetDisplayAttributes(index, display_attributes);
+}
+
+DisplayError HWTVDRM::PrefetchDisplayConfig(uint32_t index) {
+  // Panel info prefetch reads the target mode's attributes.
+  EnsureModeAttributes(index);
+  return HWDeviceDRM::PrefetchDisplayConfig(index);
+}
+
+DisplayError HWTVDRM::SetRefreshRate(uint32_t refresh_rate) {
+  // The rate switch is resolved against mode attributes in the commit path; make sure
+  // enumeration has finished before it is staged.
+  WaitForDeferredModeEnumeration();
+  return HWDeviceDRM::SetRefreshRate(refresh_rate);
+}
+
+void HWTVDRM::RestoreNegotiatedLinkParams() {
+  if (!sink_identity_) {
+    return;
+  }
+
+  NegotiatedLinkParams params = {};
+  {
+    std::lock_guard<std::mutex> lock(g_link_cache_lock);
+    auto it = g_link_cache.find(sink_identity_);
+    if (it == g_link_cache.end()) {
+      return;
+    }
+    params = it->second;
+  }
+
+  last_colorspace_ = params.colorspace;
+
+  for (uint32_t i = 0; i < UINT32(connector_info_.modes.size()); i++) {
+    auto &mode = connector_info_.modes[i].mode;
+    if (mode.hdisplay == params.mode_width && mode.vdisplay == params.mode_height &&
+        mode.vrefresh == params.mode_fps) {
+      EnsureModeAttributes(i);
+      current_mode_index_ = i;
+      DLOGI("Known sink %" PRIx64 ": restoring negotiated mode %ux%u@%u, colorspace %d",
+            sink_identity_, params.mode_width, params.mode_height, params.mode_fps,
+            params.colorspace);
+      return;
+    }
+  }
+
+  DLOGI("Known sink %" PRIx64 " no longer exposes cached mode %ux%u@%u", sink_identity_,
+        params.mode_width, params.mode_height, params.mode_fps);
+}
+
+void HWTVDRM::StoreNegotiatedMode(uint32_t index) {
+  if (!sink_identity_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_link_cache_lock);
+  NegotiatedLinkParams &params = g_link_cache[sink_identity_];
+  params.mode_width = connector_info_.modes[index].mode.hdisplay;
+  params.mode_height = connector_info_.modes[index].mode.vdisplay;
+  params.mode_fps = connector_info_.modes[index].mode.vrefresh;
+}
+
 DisplayError HWTVDRM::SetDisplayAttributes(uint32_t index) {
   if (index >= connector_info_.modes.size()) {
     DLOGE("Invalid mode index %d mode size %d", index, UINT32(connector_info_.modes.size()));
     return kErrorNotSupported;
   }
 
+  EnsureModeAttributes(index);
+
   seamless_mode_switch_ = false;
   current_mode_index_ = index;
   PopulateHWPanelInfo();
@@ -168,6 +403,8 @@ DisplayError HWTVDRM::SetDisplayAttributes(uint32_t index) {
         display_attributes_[index].h_total, display_attributes_[index].clock_khz,
         display_attributes_[index].topology);
 
+  StoreNegotiatedMode(index);
+
   return kErrorNone;
 }
 
@@ -210,6 +447,9 @@ DisplayError HWTVDRM::Flush(HWLayersInfo *hw_layers_info) {
 }
 
 DisplayError HWTVDRM::Deinit() {
+  // The enumeration worker touches display_attributes_; let it finish before teardown.
+  WaitForDeferredModeEnumeration();
+
   if (hw_panel_info_.hdr_enabled) {
     memset(&hdr_metadata_, 0, sizeof(hdr_metadata_));
     hdr_metadata_.hdr_supported = 1;
@@ -365,8 +605,7 @@ DisplayError HWTVDRM::UpdateHDRMetaData(HWLayersInfo *hw_layers_info) {
     } else if (blend_space_.primaries == ColorPrimaries_BT2020) {
       colorspace = sde_drm::DRMColorspace::BT2020_RGB;
     }
-    DLOGV_IF(kTagDriverConfig, "Set colorspace = %d", colorspace);
-    drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_COLORSPACE, token_.conn_id, colorspace);
+    SetColorspace(colorspace);
   }
 
   if (!hw_panel_info_.hdr_enabled) {
@@ -471,6 +710,23 @@ DisplayError HWTVDRM::UpdateHDRMetaData(HWLayersInfo *hw_layers_info) {
   return error;
 }
 
+void HWTVDRM::SetColorspace(sde_drm::DRMColorspace colorspace) {
+  // The connector property persists across commits; only stage it when the value moves, and
+  // remember the result per sink so the next connect starts from it.
+  if (colorspace == last_colorspace_) {
+    return;
+  }
+
+  DLOGV_IF(kTagDriverConfig, "Set colorspace = %d", colorspace);
+  drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_COLORSPACE, token_.conn_id, colorspace);
+  last_colorspace_ = colorspace;
+
+  if (sink_identity_) {
+    std::lock_guard<std::mutex> lock(g_link_cache_lock);
+    g_link_cache[sink_identity_].colorspace = colorspace;
+  }
+}
+
 void HWTVDRM::DumpHDRMetaData(HWHDRLayerInfo::HDROperation operation) {
   DLOGI("Operation = %d, HDR Metadata: MaxDisplayLuminance = %d MinDisplayLuminance = %d\n"
         "MaxContentLightLevel = %d MaxAverageLightLevel = %d Red_x = %d Red_y = %d Green_x = %d\n"
@@ -525,6 +781,13 @@ DisplayError HWTVDRM::PowerOn(const HWQosData &qos_data, SyncPoints *sync_points
     drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_CRTC, token_.conn_id, token_.crtc_id);
     drmModeModeInfo current_mode = connector_info_.modes[current_mode_index_].mode;
     drm_atomic_intf_->Perform(DRMOps::CRTC_SET_MODE, token_.crtc_id, &current_mode);
+    if (hw_panel_info_.port == kPortDP && hw_panel_info_.supported_colorspaces &&
+        last_colorspace_ != sde_drm::DRMColorspace::DEFAULT) {
+      // Known sink: ride the colorspace negotiated on its previous connect along with the
+      // modeset, so the first frame does not need a follow-up colorspace commit.
+      drm_atomic_intf_->Perform(DRMOps::CONNECTOR_SET_COLORSPACE, token_.conn_id,
+                                last_colorspace_);
+    }
     if (hw_panel_info_.hdr_enabled) {
       hdr_metadata_.hdr_supported = 1;
       hdr_metadata_.hdr_state = HDR_DISABLE;
@@ -28,6 +28,8 @@
 #include <map>
 #include <vector>
 #include <chrono>
+#include <future>
+#include <mutex>
 
 #include "hw_device_drm.h"
 
@@ -43,7 +45,14 @@ class HWTVDRM : public HWDeviceDRM {
                    HWInfoInterface *hw_info_intf);
 
  protected:
+  virtual DisplayError Init();
+  virtual void InitializeConfigs();
+  virtual bool DeferModeAttributePopulation(uint32_t mode_index);
+  virtual DisplayError GetDisplayAttributes(uint32_t index,
+                                            HWDisplayAttributes *display_attributes);
   virtual DisplayError SetDisplayAttributes(uint32_t index);
+  virtual DisplayError PrefetchDisplayConfig(uint32_t index);
+  virtual DisplayError SetRefreshRate(uint32_t refresh_rate);
   virtual DisplayError GetConfigIndex(char *mode, uint32_t *index);
   virtual DisplayError PowerOff(bool teardown, SyncPoints *sync_points);
   virtual DisplayError Doze(const HWQosData &qos_data, SyncPoints *sync_points);
@@ -56,16 +65,47 @@ class HWTVDRM : public HWDeviceDRM {
   virtual DisplayError Deinit();
   virtual DisplayError Flush(HWLayersInfo *hw_layers_info);
 
+ public:
+  // Output configuration negotiated on a previous connect of the same sink. Cached for the
+  // process lifetime keyed by EDID hash + port, so re-docking a known monitor restores the
+  // working mode and colorspace in the first modeset commit.
+  struct NegotiatedLinkParams {
+    uint32_t mode_width = 0;
+    uint32_t mode_height = 0;
+    uint32_t mode_fps = 0;
+    sde_drm::DRMColorspace colorspace = sde_drm::DRMColorspace::DEFAULT;
+  };
+
  private:
   DisplayError UpdateHDRMetaData(HWLayersInfo *hw_layers_info);
   void DumpHDRMetaData(HWHDRLayerInfo::HDROperation operation);
   void InitMaxHDRMetaData();
+  uint64_t EdidHash() const;
+  uint64_t SinkIdentity() const;
+  uint64_t ModeListSignature() const;
+  void RestoreNegotiatedLinkParams();
+  void StoreNegotiatedMode(uint32_t index);
+  void SetColorspace(sde_drm::DRMColorspace colorspace);
+  void EnsureModeAttributes(uint32_t index);
+  bool RestoreModeAttributesFromCache();
+  void StoreModeAttributesInCache();
+  void WaitForDeferredModeEnumeration();
 
   const float kDefaultMinLuminance = 0.02f;
   const float kDefaultMaxLuminance = 500.0f;
   const float kMinPeakLuminance = 300.0f;
   const float kMaxPeakLuminance = 1000.0f;
   drm_msm_ext_hdr_metadata hdr_metadata_ = {};
+  uint64_t sink_identity_ = 0;  // 0 when the sink exposes no EDID
+  uint64_t edid_identity_ = 0;  // EDID-only hash, shared between streams of identical sinks
+  // Bring-up populates attributes for the preferred mode only; the rest are enumerated by a
+  // per-display worker (so the streams of a multi-sink dock enumerate in parallel) or filled
+  // on first access, whichever comes first.
+  uint32_t deferred_attr_modes_ = 0;
+  std::mutex attr_populated_lock_;
+  std::vector<uint8_t> attr_populated_ = {};
+  std::future<void> mode_enum_future_;
+  sde_drm::DRMColorspace last_colorspace_ = sde_drm::DRMColorspace::DEFAULT;
   std::chrono::time_point<SteadyClock> hdr_reset_start_;
   std::chrono::time_point<SteadyClock> hdr_reset_end_;
   bool reset_hdr_flag_ = false;
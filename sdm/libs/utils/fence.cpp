@@ -31,6 +31,10 @@
 #include <core/sdm_types.h>
 #include <debug_handler.h>
 #include <assert.h>
+#include <stdio.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -44,6 +48,111 @@ namespace sdm {
 BufferSyncHandler* Fence::g_buffer_sync_handler_ = nullptr;
 std::vector<std::weak_ptr<Fence>> Fence::wps_;
 
+namespace {
+
+// Node size covers the fence object plus the control block which
+// allocate_shared folds into the same allocation. Oversized or overflow
+// requests fall through to the heap.
+constexpr size_t kPoolNodeSize = 128;
+constexpr uint32_t kPoolMaxFreeNodes = 256;
+
+struct PoolNode {
+  PoolNode *next = nullptr;
+};
+
+std::mutex g_pool_lock;
+PoolNode *g_pool_free_list = nullptr;
+uint32_t g_pool_free_count = 0;
+
+// Gives allocate_shared access to the protected fence constructor.
+struct PooledFence : public Fence {
+  PooledFence(int fd, const string &name) : Fence(fd, name) {}
+};
+
+// Slow-wait attribution ring; see Fence::EnableWaitStats(). Writers claim a
+// slot with a single fetch_add and seqlock the record, so waits on different
+// threads never serialize against each other or against Dump().
+constexpr uint32_t kWaitRingSize = 128;
+constexpr size_t kWaitNameSize = 48;
+
+struct WaitRecord {
+  std::atomic<uint32_t> seq {0};  // odd while a writer owns the slot
+  char name[kWaitNameSize] = {};
+  int32_t wait_ms = 0;
+  int32_t timeout_ms = 0;
+  int32_t status = 0;
+};
+
+WaitRecord g_wait_ring[kWaitRingSize];
+std::atomic<uint32_t> g_wait_ring_head {0};
+std::atomic<int> g_wait_threshold_ms {0};
+std::atomic<uint64_t> g_slow_wait_count {0};
+
+// Frame-scoped merge memoization; see Fence::ResetMergeCache(). Entries hold
+// strong references to their sources so the underlying fds cannot be closed
+// and recycled while the entry is alive, which keeps the key valid.
+constexpr size_t kMergeCacheMaxEntries = 32;
+
+struct MergeCacheEntry {
+  shared_ptr<Fence> src1;
+  shared_ptr<Fence> src2;
+  shared_ptr<Fence> merged;
+};
+
+std::mutex g_merge_cache_lock;
+std::vector<MergeCacheEntry> g_merge_cache;
+std::atomic<uint64_t> g_merge_cache_hits {0};
+std::atomic<uint64_t> g_merge_cache_misses {0};
+
+int64_t WaitClockMs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (static_cast<int64_t>(ts.tv_sec) * 1000) + (ts.tv_nsec / 1000000);
+}
+
+void RecordSlowWait(const char *name, int32_t wait_ms, int32_t timeout_ms, int32_t status) {
+  g_slow_wait_count.fetch_add(1, std::memory_order_relaxed);
+  uint32_t slot = g_wait_ring_head.fetch_add(1, std::memory_order_relaxed) % kWaitRingSize;
+  WaitRecord &record = g_wait_ring[slot];
+  record.seq.fetch_add(1, std::memory_order_acquire);
+  snprintf(record.name, sizeof(record.name), "%s", name);
+  record.wait_ms = wait_ms;
+  record.timeout_ms = timeout_ms;
+  record.status = status;
+  record.seq.fetch_add(1, std::memory_order_release);
+}
+
+}  // namespace
+
+void *Fence::PoolAlloc(size_t size) {
+  if (size <= kPoolNodeSize) {
+    std::lock_guard<std::mutex> guard(g_pool_lock);
+    if (g_pool_free_list) {
+      PoolNode *node = g_pool_free_list;
+      g_pool_free_list = node->next;
+      g_pool_free_count--;
+      return node;
+    }
+  }
+
+  return ::operator new(std::max(size, kPoolNodeSize));
+}
+
+void Fence::PoolFree(void *ptr, size_t size) {
+  if (size <= kPoolNodeSize) {
+    std::lock_guard<std::mutex> guard(g_pool_lock);
+    if (g_pool_free_count < kPoolMaxFreeNodes) {
+      PoolNode *node = reinterpret_cast<PoolNode *>(ptr);
+      node->next = g_pool_free_list;
+      g_pool_free_list = node;
+      g_pool_free_count++;
+      return;
+    }
+  }
+
+  ::operator delete(ptr);
+}
+
 Fence::Fence(int fd, const string &name) : fd_(fd), name_(name) {
 }
 
@@ -68,7 +177,10 @@ shared_ptr<Fence> Fence::Create(int fd, const string &name) {
     return nullptr;
   }
 
-  shared_ptr<Fence> fence(new Fence(fd, name));
+  // allocate_shared keeps the fence object and control block in a single
+  // pooled node, so steady-state fence churn does not allocate.
+  shared_ptr<Fence> fence =
+      std::allocate_shared<PooledFence>(PoolAllocator<PooledFence>(), fd, name);
   if (!fence) {
     close(fd);
   }
@@ -89,42 +201,168 @@ int Fence::Get(const shared_ptr<Fence> &fence) {
 shared_ptr<Fence> Fence::Merge(const shared_ptr<Fence> &fence1, const shared_ptr<Fence> &fence2) {
   ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
 
-  // Sync merge will return a new unique fd if source fds are same.
-  int fd1 = fence1 ? fence1->fd_ : -1;
-  int fd2 = fence2 ? fence2->fd_ : -1;
+  // A merged fence signals with its last source, so a merge against null (or
+  // against itself) is the surviving fence; sharing the object avoids a dup'd fd.
+  if (!fence1 || (fence1 == fence2)) {
+    return fence2;
+  }
+  if (!fence2) {
+    return fence1;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(g_merge_cache_lock);
+    for (auto &entry : g_merge_cache) {
+      if ((entry.src1 == fence1 && entry.src2 == fence2) ||
+          (entry.src1 == fence2 && entry.src2 == fence1)) {
+        g_merge_cache_hits.fetch_add(1, std::memory_order_relaxed);
+        return entry.merged;
+      }
+    }
+  }
+  g_merge_cache_misses.fetch_add(1, std::memory_order_relaxed);
+
+  int fd1 = fence1->fd_;
+  int fd2 = fence2->fd_;
   int merged = -1;
   std::string name = "merged[" + to_string(fd1) + ", " + to_string(fd2) + "]";
 
   g_buffer_sync_handler_->SyncMerge(fd1, fd2, &merged);
 
-  return Create(merged, name);
+  shared_ptr<Fence> merged_fence = Create(merged, name);
+  if (merged_fence) {
+    std::lock_guard<std::mutex> guard(g_merge_cache_lock);
+    if (g_merge_cache.size() < kMergeCacheMaxEntries) {
+      g_merge_cache.push_back({fence1, fence2, merged_fence});
+    }
+  }
+
+  return merged_fence;
 }
 
 shared_ptr<Fence> Fence::Merge(const std::vector<shared_ptr<Fence>> &fences, bool ignore_signaled) {
   ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
 
-  shared_ptr<Fence> merged_fence = nullptr;
+  std::vector<shared_ptr<Fence>> pending;
+  pending.reserve(fences.size());
   for (auto &fence : fences) {
-    if (ignore_signaled && (Fence::Wait(fence, 0) == kErrorNone)) {
+    if (!fence) {
       continue;
     }
+    if (ignore_signaled && Fence::TryWait(fence)) {
+      continue;
+    }
+    pending.push_back(fence);
+  }
 
-    merged_fence = Fence::Merge(fence, merged_fence);
+  if (pending.empty()) {
+    return nullptr;
+  }
+  if (pending.size() == 1) {
+    return pending[0];
   }
 
-  return merged_fence;
+  // Chain raw sync merges and close the intermediates right away, so N inputs
+  // produce a single fence object instead of one per pairwise merge.
+  int merged = -1;
+  g_buffer_sync_handler_->SyncMerge(pending[0]->fd_, pending[1]->fd_, &merged);
+  for (size_t i = 2; i < pending.size(); i++) {
+    int next = -1;
+    g_buffer_sync_handler_->SyncMerge(merged, pending[i]->fd_, &next);
+    if (merged >= 0) {
+      close(merged);
+    }
+    merged = next;
+  }
+
+  std::string name = "merged[" + to_string(pending.size()) + " fences]";
+
+  return Create(merged, name);
+}
+
+void Fence::ResetMergeCache() {
+  std::vector<MergeCacheEntry> retired;
+  {
+    std::lock_guard<std::mutex> guard(g_merge_cache_lock);
+    // Swap so the fence destructors (and their fd closes) run outside the lock.
+    retired.swap(g_merge_cache);
+  }
 }
 
 int Fence::Wait(const shared_ptr<Fence> &fence) {
+  return Fence::Wait(fence, 1000);
+}
+
+int Fence::Wait(const shared_ptr<Fence> &fence, int timeout) {
   ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
 
-  return g_buffer_sync_handler_->SyncWait(Fence::Get(fence), 1000);
+  int threshold_ms = g_wait_threshold_ms.load(std::memory_order_relaxed);
+  if (!threshold_ms) {
+    return g_buffer_sync_handler_->SyncWait(Fence::Get(fence), timeout);
+  }
+
+  int64_t start_ms = WaitClockMs();
+  int error = g_buffer_sync_handler_->SyncWait(Fence::Get(fence), timeout);
+  int64_t wait_ms = WaitClockMs() - start_ms;
+  if (wait_ms >= threshold_ms) {
+    RecordSlowWait(fence ? fence->name_.c_str() : "null", static_cast<int32_t>(wait_ms), timeout,
+                   error);
+  }
+
+  return error;
 }
 
-int Fence::Wait(const shared_ptr<Fence> &fence, int timeout) {
+int Fence::WaitAll(const std::vector<shared_ptr<Fence>> &fences, int timeout) {
+  ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
+
+  std::vector<int> fds;
+  fds.reserve(fences.size());
+  for (auto &fence : fences) {
+    int fd = Fence::Get(fence);
+    if (fd >= 0) {
+      fds.push_back(fd);
+    }
+  }
+
+  if (fds.empty()) {
+    return 0;
+  }
+
+  int threshold_ms = g_wait_threshold_ms.load(std::memory_order_relaxed);
+  if (!threshold_ms) {
+    return g_buffer_sync_handler_->SyncWaitBatch(fds, timeout);
+  }
+
+  int64_t start_ms = WaitClockMs();
+  int error = g_buffer_sync_handler_->SyncWaitBatch(fds, timeout);
+  int64_t wait_ms = WaitClockMs() - start_ms;
+  if (wait_ms >= threshold_ms) {
+    char name[kWaitNameSize];
+    snprintf(name, sizeof(name), "batch[%zu]", fds.size());
+    RecordSlowWait(name, static_cast<int32_t>(wait_ms), timeout, error);
+  }
+
+  return error;
+}
+
+void Fence::EnableWaitStats(int threshold_ms) {
+  g_wait_threshold_ms.store(threshold_ms, std::memory_order_relaxed);
+}
+
+bool Fence::TryWait(const shared_ptr<Fence> &fence) {
+  ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
+
+  return (g_buffer_sync_handler_->SyncTryWait(Fence::Get(fence)) == 0);
+}
+
+uint64_t Fence::GetSignalTime(const shared_ptr<Fence> &fence) {
   ASSERT_IF_NO_BUFFER_SYNC(g_buffer_sync_handler_);
 
-  return g_buffer_sync_handler_->SyncWait(Fence::Get(fence), timeout);
+  if (!fence) {
+    return 0;
+  }
+
+  return g_buffer_sync_handler_->SyncGetSignalTime(Fence::Get(fence));
 }
 
 Fence::Status Fence::GetStatus(const shared_ptr<Fence> &fence) {
@@ -162,6 +400,35 @@ void Fence::Dump(std::ostringstream *os) {
   }
   */
   *os << "\n---------------------------------------\n";
+
+  *os << "Merge cache: hits " << g_merge_cache_hits.load(std::memory_order_relaxed)
+      << ", misses " << g_merge_cache_misses.load(std::memory_order_relaxed) << "\n";
+
+  int threshold_ms = g_wait_threshold_ms.load(std::memory_order_relaxed);
+  if (!threshold_ms) {
+    return;
+  }
+
+  *os << "Slow fence waits (threshold: " << threshold_ms << " ms, total: "
+      << g_slow_wait_count.load(std::memory_order_relaxed) << ", newest first):\n";
+  uint32_t head = g_wait_ring_head.load(std::memory_order_relaxed);
+  for (uint32_t i = 0; i < kWaitRingSize; i++) {
+    WaitRecord &record = g_wait_ring[(head + kWaitRingSize - 1 - i) % kWaitRingSize];
+    uint32_t seq = record.seq.load(std::memory_order_acquire);
+    if (!seq || (seq & 1)) {
+      continue;  // never written, or a writer owns it right now
+    }
+    char name[kWaitNameSize];
+    snprintf(name, sizeof(name), "%s", record.name);
+    int32_t wait_ms = record.wait_ms;
+    int32_t timeout_ms = record.timeout_ms;
+    int32_t status = record.status;
+    if (record.seq.load(std::memory_order_acquire) != seq) {
+      continue;  // overwritten while reading
+    }
+    *os << "  " << name << ": " << wait_ms << " ms (timeout: " << timeout_ms
+        << " ms, status: " << status << ")\n";
+  }
 }
 
 Fence::ScopedRef::~ScopedRef() {
@@ -32,6 +32,10 @@
 #include <utils/constants.h>
 #include <algorithm>
 
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #define __CLASS__ "RectUtils"
 
 namespace sdm {
@@ -185,6 +189,96 @@ LayerRect Union(const LayerRect &rect1, const LayerRect &rect2) {
   return res;
 }
 
+// Batch variants for ROI generation, where rect math runs over whole candidate lists per
+// frame. LayerRect is four contiguous floats and maps to one NEON quad register, so the hot
+// accumulation stays in vector registers; validity semantics match Union()/Intersection().
+LayerRect UnionOfRects(const LayerRect *rects, uint32_t count) {
+  LayerRect res;
+  if (!rects) {
+    return res;
+  }
+
+  bool valid = false;
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  float32x4_t acc_min = vdupq_n_f32(0.0f);
+  float32x4_t acc_max = vdupq_n_f32(0.0f);
+  for (uint32_t i = 0; i < count; i++) {
+    if (!IsValid(rects[i])) {
+      continue;
+    }
+    float32x4_t v = vld1q_f32(&rects[i].left);
+    if (!valid) {
+      acc_min = v;
+      acc_max = v;
+      valid = true;
+      continue;
+    }
+    acc_min = vminq_f32(acc_min, v);
+    acc_max = vmaxq_f32(acc_max, v);
+  }
+  if (!valid) {
+    return res;
+  }
+  res.left = vgetq_lane_f32(acc_min, 0);
+  res.top = vgetq_lane_f32(acc_min, 1);
+  res.right = vgetq_lane_f32(acc_max, 2);
+  res.bottom = vgetq_lane_f32(acc_max, 3);
+#else
+  for (uint32_t i = 0; i < count; i++) {
+    if (!IsValid(rects[i])) {
+      continue;
+    }
+    if (!valid) {
+      res = rects[i];
+      valid = true;
+      continue;
+    }
+    res.left = std::min(res.left, rects[i].left);
+    res.top = std::min(res.top, rects[i].top);
+    res.right = std::max(res.right, rects[i].right);
+    res.bottom = std::max(res.bottom, rects[i].bottom);
+  }
+#endif
+
+  return res;
+}
+
+void IntersectionOfRects(const LayerRect &ref, const LayerRect *rects, uint32_t count,
+                         LayerRect *out_rects) {
+  if (!rects || !out_rects) {
+    return;
+  }
+
+  if (!IsValid(ref)) {
+    for (uint32_t i = 0; i < count; i++) {
+      out_rects[i] = LayerRect();
+    }
+    return;
+  }
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+  float32x4_t ref_v = vld1q_f32(&ref.left);
+  // left/top take the max of the two rects, right/bottom the min.
+  uint32x4_t lo_lanes = vcombine_u32(vdup_n_u32(0xFFFFFFFFu), vdup_n_u32(0));
+  for (uint32_t i = 0; i < count; i++) {
+    if (!IsValid(rects[i])) {
+      out_rects[i] = LayerRect();
+      continue;
+    }
+    float32x4_t v = vld1q_f32(&rects[i].left);
+    float32x4_t res = vbslq_f32(lo_lanes, vmaxq_f32(ref_v, v), vminq_f32(ref_v, v));
+    vst1q_f32(&out_rects[i].left, res);
+    if (!IsValid(out_rects[i])) {
+      out_rects[i] = LayerRect();
+    }
+  }
+#else
+  for (uint32_t i = 0; i < count; i++) {
+    out_rects[i] = Intersection(ref, rects[i]);
+  }
+#endif
+}
+
 void SplitLeftRight(const LayerRect &in_rect, uint32_t split_count, uint32_t align_x,
                     bool flip_horizontal, LayerRect *out_rects) {
   LayerRect rect_temp = in_rect;
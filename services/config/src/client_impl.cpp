@@ -27,6 +27,10 @@
 * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <string>
 #include <vector>
 
@@ -34,6 +38,60 @@
 
 namespace DisplayConfig {
 
+const SharedAttributesPage *ClientImpl::GetSharedAttributes() {
+  std::lock_guard<std::mutex> lock(shared_attrs_lock_);
+  if (!shared_attrs_mapped_) {
+    shared_attrs_mapped_ = true;
+    int fd = open(kSharedAttributesPath, O_RDONLY);
+    if (fd >= 0) {
+      void *base = mmap(nullptr, sizeof(SharedAttributesPage), PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (base != MAP_FAILED) {
+        shared_attrs_ = reinterpret_cast<const SharedAttributesPage *>(base);
+      }
+    }
+  }
+
+  if (!shared_attrs_) {
+    return nullptr;
+  }
+
+  // The service writes the magic last; ignore the page until it is fully initialized.
+  if (__atomic_load_n(&shared_attrs_->magic, __ATOMIC_ACQUIRE) != kSharedAttributesMagic ||
+      shared_attrs_->version != kSharedAttributesVersion) {
+    return nullptr;
+  }
+
+  return shared_attrs_;
+}
+
+bool ClientImpl::ReadSharedActiveConfig(DisplayType dpy, uint32_t *config) {
+  const SharedAttributesPage *page = GetSharedAttributes();
+  uint32_t slot_index = static_cast<uint32_t>(dpy);
+  if (!page || slot_index >= kMaxSharedDisplays) {
+    return false;
+  }
+
+  const SharedDisplayAttributes *slot = &page->displays[slot_index];
+  for (int retry = 0; retry < 3; retry++) {
+    uint32_t seq = SharedSlotReadBegin(slot);
+    uint32_t valid = slot->valid;
+    uint32_t value = slot->active_config;
+    int64_t update_time_ms = slot->update_time_ms;
+    if (SharedSlotReadRetry(slot, seq)) {
+      continue;
+    }
+    if (!(valid & kSharedValidActiveConfig) ||
+        (SharedAttributesTimeMs() - update_time_ms) > kSharedAttributesTtlMs) {
+      return false;
+    }
+    *config = value;
+    return true;
+  }
+
+  return false;
+}
+
 int ClientImpl::Init(std::string client_name, ConfigCallback *callback) {
   display_config_ = IDisplayConfig::getService();
   // Unable to find Display Config 2.0 service. Fail Init.
@@ -47,7 +105,7 @@ int ClientImpl::Init(std::string client_name, ConfigCallback *callback) {
     handle = client_handle;
   };
   int pid = getpid();
-  android::sp<ClientCallback> client_cb(new ClientCallback(callback));
+  android::sp<ClientCallback> client_cb(new ClientCallback(callback, this));
   display_config_->registerClient(client_name + std::to_string(pid), client_cb,
                                   hidl_callback);
   client_handle_ = handle;
@@ -144,6 +202,10 @@ int ClientImpl::GetActiveConfig(DisplayType dpy, uint32_t *config) {
     return -EINVAL;
   }
 
+  if (ReadSharedActiveConfig(dpy, config)) {
+    return 0;
+  }
+
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&dpy), sizeof(DisplayType));
   const uint32_t *output;
@@ -402,6 +464,14 @@ int ClientImpl::ControlIdlePowerCollapse(bool enable, bool synchronous) {
 }
 
 int ClientImpl::GetWriteBackCapabilities(bool *is_wb_ubwc_supported) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    if (wb_caps_cached_) {
+      *is_wb_ubwc_supported = wb_ubwc_supported_;
+      return 0;
+    }
+  }
+
   const bool *output;
   ByteStream output_params;
   int error = 0;
@@ -416,6 +486,9 @@ int ClientImpl::GetWriteBackCapabilities(bool *is_wb_ubwc_supported) {
   output = reinterpret_cast<const bool*>(data);
   if (!error) {
     *is_wb_ubwc_supported = *output;
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    wb_ubwc_supported_ = *output;
+    wb_caps_cached_ = true;
   }
 
   return error;
@@ -619,6 +692,15 @@ int ClientImpl::SetPanelLuminanceAttributes(uint32_t disp_id, float min_lum, flo
 }
 
 int ClientImpl::IsBuiltInDisplay(uint32_t disp_id, bool *is_builtin) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    auto iter = is_builtin_cache_.find(disp_id);
+    if (iter != is_builtin_cache_.end()) {
+      *is_builtin = iter->second;
+      return 0;
+    }
+  }
+
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&disp_id), sizeof(uint32_t));
   const bool *output;
@@ -636,6 +718,8 @@ int ClientImpl::IsBuiltInDisplay(uint32_t disp_id, bool *is_builtin) {
 
   if (!error) {
     *is_builtin = *output;
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    is_builtin_cache_[disp_id] = *output;
   }
 
   return error;
@@ -664,6 +748,15 @@ int ClientImpl::SetCWBOutputBuffer(uint32_t disp_id, const Rect rect, bool post_
 }
 
 int ClientImpl::GetSupportedDSIBitClks(uint32_t disp_id, std::vector<uint64_t> *bit_clks) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    auto iter = bit_clks_cache_.find(disp_id);
+    if (iter != bit_clks_cache_.end()) {
+      bit_clks->insert(bit_clks->end(), iter->second.begin(), iter->second.end());
+      return 0;
+    }
+  }
+
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&disp_id), sizeof(uint32_t));
   ByteStream output_params;
@@ -682,6 +775,8 @@ int ClientImpl::GetSupportedDSIBitClks(uint32_t disp_id, std::vector<uint64_t> *
     for (int i = 0; i < num_bit_clks; i++) {
       bit_clks->push_back(bit_clks_data[i]);
     }
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    bit_clks_cache_[disp_id].assign(bit_clks_data, bit_clks_data + num_bit_clks);
   }
 
   return error;
@@ -764,6 +859,15 @@ int ClientImpl::IsSmartPanelConfig(uint32_t disp_id, uint32_t config_id, bool *i
 }
 
 int ClientImpl::IsAsyncVDSCreationSupported(bool *supported) {
+  const SharedAttributesPage *page = GetSharedAttributes();
+  if (page && supported) {
+    uint32_t caps = __atomic_load_n(&page->caps, __ATOMIC_ACQUIRE);
+    if (caps & kSharedCapAsyncVdsKnown) {
+      *supported = (caps & kSharedCapAsyncVds) != 0;
+      return 0;
+    }
+  }
+
   const bool *output;
   ByteStream output_params;
   int error = 0;
@@ -799,6 +903,15 @@ int ClientImpl::CreateVirtualDisplay(uint32_t width, uint32_t height, int32_t fo
 }
 
 int ClientImpl::IsRotatorSupportedFormat(int hal_format, bool ubwc, bool *supported) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    auto iter = rot_format_cache_.find(std::make_pair(hal_format, ubwc));
+    if (iter != rot_format_cache_.end()) {
+      *supported = iter->second;
+      return 0;
+    }
+  }
+
   struct RotatorFormatParams input = {hal_format, ubwc};
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&input),
@@ -818,6 +931,8 @@ int ClientImpl::IsRotatorSupportedFormat(int hal_format, bool ubwc, bool *suppor
 
   if (!error) {
     *supported = *output;
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    rot_format_cache_[std::make_pair(hal_format, ubwc)] = *output;
   }
 
   return error;
@@ -864,6 +979,15 @@ int ClientImpl::SendTUIEvent(DisplayType dpy, TUIEventType event_type) {
 }
 
 int ClientImpl::GetDisplayHwId(uint32_t disp_id, uint32_t *display_hw_id) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    auto iter = display_hw_id_cache_.find(disp_id);
+    if (iter != display_hw_id_cache_.end()) {
+      *display_hw_id = iter->second;
+      return 0;
+    }
+  }
+
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&disp_id), sizeof(uint32_t));
   ByteStream output_params;
@@ -881,6 +1005,8 @@ int ClientImpl::GetDisplayHwId(uint32_t disp_id, uint32_t *display_hw_id) {
 
   if (!error) {
     *display_hw_id = *output;
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    display_hw_id_cache_[disp_id] = *output;
   }
 
   return error;
@@ -913,6 +1039,15 @@ int ClientImpl::GetSupportedDisplayRefreshRates(DisplayType dpy,
 }
 
 int ClientImpl::IsRCSupported(uint32_t disp_id, bool *supported) {
+  {
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    auto iter = rc_supported_cache_.find(disp_id);
+    if (iter != rc_supported_cache_.end()) {
+      *supported = iter->second;
+      return 0;
+    }
+  }
+
   ByteStream input_params;
   input_params.setToExternal(reinterpret_cast<uint8_t*>(&disp_id), sizeof(uint32_t));
   const bool *output;
@@ -929,6 +1064,8 @@ int ClientImpl::IsRCSupported(uint32_t disp_id, bool *supported) {
     const uint8_t *data = output_params.data();
     output = reinterpret_cast<const bool*>(data);
     *supported = *output;
+    std::lock_guard<std::mutex> lock(attr_cache_lock_);
+    rc_supported_cache_[disp_id] = *output;
   }
 
   return error;
@@ -1057,10 +1194,25 @@ Return<void> ClientCallback::perform(uint32_t op_code, const ByteStream &input_p
       ParseNotifyIdleStatus(input_params);
       break;
     default:
+      // An op this client version does not understand may signal an attribute change; drop
+      // the local invariant cache so the next query goes back to the service.
+      if (owner_) {
+        owner_->InvalidateCachedAttributes();
+      }
       break;
   }
 
   return Void();
 }
 
+void ClientImpl::InvalidateCachedAttributes() {
+  std::lock_guard<std::mutex> lock(attr_cache_lock_);
+  is_builtin_cache_.clear();
+  display_hw_id_cache_.clear();
+  bit_clks_cache_.clear();
+  rc_supported_cache_.clear();
+  rot_format_cache_.clear();
+  wb_caps_cached_ = false;
+}
+
 }  // namespace DisplayConfig
@@ -36,10 +36,14 @@
 #include <hidl/HidlSupport.h>
 #include <log/log.h>
 #include <config/client_interface.h>
+#include <map>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "opcode_types.h"
+#include "shared_attributes.h"
 
 namespace DisplayConfig {
 
@@ -53,10 +57,13 @@ using ::android::hardware::hidl_vec;
 typedef hidl_vec<uint8_t> ByteStream;
 typedef hidl_vec<hidl_handle> HandleStream;
 
+class ClientImpl;
+
 class ClientCallback: public IDisplayConfigCallback {
  public:
-  ClientCallback(ConfigCallback *cb) {
+  ClientCallback(ConfigCallback *cb, ClientImpl *owner) {
     callback_ = cb;
+    owner_ = owner;
   }
 
  private:
@@ -66,6 +73,7 @@ class ClientCallback: public IDisplayConfigCallback {
   void ParseNotifyQsyncChange(const ByteStream &input_params);
   void ParseNotifyIdleStatus(const ByteStream &input_params);
   ConfigCallback *callback_ = nullptr;
+  ClientImpl *owner_ = nullptr;
 };
 
 class ClientImpl : public ClientInterface {
@@ -129,9 +137,34 @@ class ClientImpl : public ClientInterface {
   virtual int AllowIdleFallback();
   virtual int DummyDisplayConfigAPI();
 
+  // Drops locally cached invariant attributes; called from ClientCallback when the service
+  // sends a notification op this client version does not recognize.
+  void InvalidateCachedAttributes();
+
  private:
+  // Shared attribute page fast path; falls back to the binder call when the page is not
+  // available or the mirrored value is stale.
+  const SharedAttributesPage *GetSharedAttributes();
+  bool ReadSharedActiveConfig(DisplayType dpy, uint32_t *config);
+
   android::sp<IDisplayConfig> display_config_ = nullptr;
   uint64_t client_handle_ = 0;
+  const SharedAttributesPage *shared_attrs_ = nullptr;
+  bool shared_attrs_mapped_ = false;
+  std::mutex shared_attrs_lock_;
+
+  // Invariant attribute cache: these answers cannot change for a given display while the
+  // service connection is alive, so each is fetched over binder at most once per client.
+  // The 2.0 notify infrastructure has no topology-change op today; if the service ever
+  // broadcasts one, ClientCallback::perform() treats the unknown op as an invalidation.
+  std::mutex attr_cache_lock_;
+  std::map<uint32_t, bool> is_builtin_cache_;
+  std::map<uint32_t, uint32_t> display_hw_id_cache_;
+  std::map<uint32_t, std::vector<uint64_t>> bit_clks_cache_;
+  std::map<uint32_t, bool> rc_supported_cache_;
+  std::map<std::pair<int, bool>, bool> rot_format_cache_;
+  bool wb_caps_cached_ = false;
+  bool wb_ubwc_supported_ = false;
 };
 
 }  // namespace DisplayConfig
@@ -63,6 +63,12 @@
 * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 #include <string>
 #include <vector>
 
@@ -88,11 +94,80 @@ int DeviceImpl::CreateInstance(ClientContext *intf) {
       return -1;
     }
     device_obj_->intf_ = intf;
+    device_obj_->InitSharedAttributes();
   }
 
   return 0;
 }
 
+void DeviceImpl::InitSharedAttributes() {
+  int fd = open(kSharedAttributesPath, O_CREAT | O_RDWR, 0644);
+  if (fd < 0) {
+    ALOGW("Failed to create shared attributes page at %s, error = %s", kSharedAttributesPath,
+          strerror(errno));
+    return;
+  }
+
+  if (ftruncate(fd, sizeof(SharedAttributesPage)) != 0) {
+    ALOGW("Failed to size shared attributes page, error = %s", strerror(errno));
+    close(fd);
+    return;
+  }
+
+  void *base = mmap(nullptr, sizeof(SharedAttributesPage), PROT_READ | PROT_WRITE, MAP_SHARED,
+                    fd, 0);
+  close(fd);
+  if (base == MAP_FAILED) {
+    ALOGW("Failed to map shared attributes page, error = %s", strerror(errno));
+    return;
+  }
+
+  SharedAttributesPage *page = reinterpret_cast<SharedAttributesPage *>(base);
+  memset(page, 0, sizeof(*page));
+  page->version = kSharedAttributesVersion;
+  // Publish the magic last so readers never observe a partially initialized page.
+  __atomic_store_n(&page->magic, kSharedAttributesMagic, __ATOMIC_RELEASE);
+  shared_attrs_ = page;
+}
+
+void DeviceImpl::PublishActiveConfig(uint32_t dpy, uint32_t config) {
+  std::lock_guard<std::mutex> lock(device_lock_);
+  if (!device_obj_ || !device_obj_->shared_attrs_ || dpy >= kMaxSharedDisplays) {
+    return;
+  }
+
+  SharedDisplayAttributes *slot = &device_obj_->shared_attrs_->displays[dpy];
+  SharedSlotWriteBegin(slot);
+  slot->valid |= kSharedValidActiveConfig;
+  slot->active_config = config;
+  slot->update_time_ms = SharedAttributesTimeMs();
+  SharedSlotWriteEnd(slot);
+}
+
+void DeviceImpl::PublishPowerMode(uint32_t disp_id, uint32_t power_mode) {
+  std::lock_guard<std::mutex> lock(device_lock_);
+  if (!device_obj_ || !device_obj_->shared_attrs_ || disp_id >= kMaxSharedDisplays) {
+    return;
+  }
+
+  SharedDisplayAttributes *slot = &device_obj_->shared_attrs_->displays[disp_id];
+  SharedSlotWriteBegin(slot);
+  slot->valid |= kSharedValidPowerMode;
+  slot->power_mode = power_mode;
+  slot->update_time_ms = SharedAttributesTimeMs();
+  SharedSlotWriteEnd(slot);
+}
+
+void DeviceImpl::PublishAsyncVdsCap(bool supported) {
+  std::lock_guard<std::mutex> lock(device_lock_);
+  if (!device_obj_ || !device_obj_->shared_attrs_) {
+    return;
+  }
+
+  uint32_t caps = kSharedCapAsyncVdsKnown | (supported ? kSharedCapAsyncVds : 0);
+  __atomic_store_n(&device_obj_->shared_attrs_->caps, caps, __ATOMIC_RELEASE);
+}
+
 Return<void> DeviceImpl::registerClient(const hidl_string &client_name,
                                         const sp<IDisplayConfigCallback>& callback,
                                         registerClient_cb _hidl_cb) {
@@ -267,9 +342,17 @@ void DeviceImpl::DeviceClientContext::ParseGetActiveConfig(const ByteStream &inp
   uint32_t config = 0;
   ByteStream output_params;
 
+  if (input_params.size() == 0) {
+    _hidl_cb(-ENODATA, {}, {});
+    return;
+  }
+
   const uint8_t *data = input_params.data();
   dpy = reinterpret_cast<const DisplayType*>(data);
   int32_t error = intf_->GetActiveConfig(*dpy, &config);
+  if (!error) {
+    PublishActiveConfig(static_cast<uint32_t>(*dpy), config);
+  }
   output_params.setToExternal(reinterpret_cast<uint8_t*>(&config),
                               sizeof(uint32_t));
   _hidl_cb(error, output_params, {});
@@ -283,6 +366,10 @@ void DeviceImpl::DeviceClientContext::ParseSetActiveConfig(const ByteStream &inp
   set_active_cfg_data = reinterpret_cast<const ConfigParams*>(data);
   int32_t error = intf_->SetActiveConfig(set_active_cfg_data->dpy,
                                          set_active_cfg_data->config);
+  if (!error) {
+    PublishActiveConfig(static_cast<uint32_t>(set_active_cfg_data->dpy),
+                        set_active_cfg_data->config);
+  }
   _hidl_cb(error, {}, {});
 }
 
@@ -293,6 +380,11 @@ void DeviceImpl::DeviceClientContext::ParseGetDisplayAttributes(const ByteStream
   ByteStream output_params;
   int32_t error = -EINVAL;
 
+  if (input_params.size() == 0) {
+    _hidl_cb(-ENODATA, {}, {});
+    return;
+  }
+
   const uint8_t *data = input_params.data();
   get_disp_attr_data = reinterpret_cast<const AttributesParams*>(data);
   error = intf_->GetDisplayAttributes(get_disp_attr_data->config_index, get_disp_attr_data->dpy,
@@ -502,6 +594,10 @@ void DeviceImpl::DeviceClientContext::ParseSetPowerMode(const ByteStream &input_
   set_power_mode_data = reinterpret_cast<const PowerModeParams*>(data);
   int32_t error = intf_->SetPowerMode(set_power_mode_data->disp_id,
                                       set_power_mode_data->power_mode);
+  if (!error) {
+    PublishPowerMode(set_power_mode_data->disp_id,
+                     static_cast<uint32_t>(set_power_mode_data->power_mode));
+  }
   _hidl_cb(error, {}, {});
 }
 
@@ -711,6 +807,9 @@ void DeviceImpl::DeviceClientContext::ParseIsSmartPanelConfig(const ByteStream &
 void DeviceImpl::DeviceClientContext::ParseIsAsyncVdsSupported(perform_cb _hidl_cb) {
   bool is_supported = false;
   int32_t error = intf_->IsAsyncVDSCreationSupported(&is_supported);
+  if (!error) {
+    PublishAsyncVdsCap(is_supported);
+  }
   ByteStream output_params;
   output_params.setToExternal(reinterpret_cast<uint8_t*>(&is_supported),
                              sizeof(bool));
@@ -896,18 +995,22 @@ Return<void> DeviceImpl::perform(uint64_t client_handle, uint32_t op_code,
 
   {
     std::lock_guard<std::recursive_mutex> lock(death_service_mutex_);
-    for (auto& pending_client_handle : pending_display_config_) {
-      auto itr = display_config_map_.find(pending_client_handle);
-      std::shared_ptr<DeviceClientContext> pending_client = itr->second;
-      if (pending_client != NULL) {
-        ConfigInterface *pending_intf = pending_client->GetDeviceConfigIntf();
-        intf_->UnRegisterClientContext(pending_intf);
-        pending_client.reset();
-        ALOGI("clear old client id:%lu ", pending_client_handle);
+    // Dead-client cleanup is the rare case; keep the per-call lock section down to the
+    // map lookup so high-frequency opcodes don't pay for the scan.
+    if (!pending_display_config_.empty()) {
+      for (auto& pending_client_handle : pending_display_config_) {
+        auto itr = display_config_map_.find(pending_client_handle);
+        std::shared_ptr<DeviceClientContext> pending_client = itr->second;
+        if (pending_client != NULL) {
+          ConfigInterface *pending_intf = pending_client->GetDeviceConfigIntf();
+          intf_->UnRegisterClientContext(pending_intf);
+          pending_client.reset();
+          ALOGI("clear old client id:%lu ", pending_client_handle);
+        }
+        display_config_map_.erase(itr);
       }
-      display_config_map_.erase(itr);
+      pending_display_config_.clear();
     }
-    pending_display_config_.clear();
 
     auto itr = display_config_map_.find(client_handle);
     if (itr == display_config_map_.end()) {
@@ -924,6 +1027,18 @@ Return<void> DeviceImpl::perform(uint64_t client_handle, uint32_t op_code,
      return Void();
   }
   switch (op_code) {
+    // Hottest opcodes first: system services poll these continuously, so they get the
+    // shortest dispatch path. Their handlers parse the payload in place and reply from
+    // fixed-size stack buffers via setToExternal - no intermediate vector is allocated.
+    case kGetActiveConfig:
+      client->ParseGetActiveConfig(input_params, _hidl_cb);
+      break;
+    case kGetDisplayAttributes:
+      client->ParseGetDisplayAttributes(input_params, _hidl_cb);
+      break;
+    case kIsAsyncVdsSupported:
+      client->ParseIsAsyncVdsSupported(_hidl_cb);
+      break;
     case kIsDisplayConnected:
       client->ParseIsDisplayConnected(input_params, _hidl_cb);
       break;
@@ -936,15 +1051,9 @@ Return<void> DeviceImpl::perform(uint64_t client_handle, uint32_t op_code,
     case kGetConfigCount:
       client->ParseGetConfigCount(input_params, _hidl_cb);
       break;
-    case kGetActiveConfig:
-      client->ParseGetActiveConfig(input_params, _hidl_cb);
-      break;
     case kSetActiveConfig:
       client->ParseSetActiveConfig(input_params, _hidl_cb);
       break;
-    case kGetDisplayAttributes:
-      client->ParseGetDisplayAttributes(input_params, _hidl_cb);
-      break;
     case kSetPanelBrightness:
       client->ParseSetPanelBrightness(input_params, _hidl_cb);
       break;
@@ -1038,9 +1147,6 @@ Return<void> DeviceImpl::perform(uint64_t client_handle, uint32_t op_code,
     case kIsSmartPanelConfig:
       client->ParseIsSmartPanelConfig(input_params, _hidl_cb);
       break;
-    case kIsAsyncVdsSupported:
-      client->ParseIsAsyncVdsSupported(_hidl_cb);
-      break;
     case kCreateVirtualDisplay:
       client->ParseCreateVirtualDisplay(input_params, _hidl_cb);
       break;
@@ -77,6 +77,7 @@
 #include <shared_mutex>
 
 #include "opcode_types.h"
+#include "shared_attributes.h"
 
 namespace DisplayConfig {
 
@@ -177,7 +178,15 @@ class DeviceImpl : public IDisplayConfig, public android::hardware::hidl_death_r
                    const android::wp<::android::hidl::base::V1_0::IBase>& callback);
   void ParseDestroy(uint64_t client_handle, perform_cb _hidl_cb);
 
+  // Publishers for the shared attribute page. Called from the parse handlers whenever a
+  // mirrored attribute is served or changed through this service.
+  void InitSharedAttributes();
+  static void PublishActiveConfig(uint32_t dpy, uint32_t config);
+  static void PublishPowerMode(uint32_t disp_id, uint32_t power_mode);
+  static void PublishAsyncVdsCap(bool supported);
+
   ClientContext *intf_ = nullptr;
+  SharedAttributesPage *shared_attrs_ = nullptr;
   std::map<uint64_t, std::shared_ptr<DeviceClientContext>> display_config_map_;
   std::vector<uint64_t> pending_display_config_;
   uint64_t client_id_ = 0;
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ * SPDX-License-Identifier: BSD-3-Clause-Clear
+ */
+
+#ifndef __SHARED_ATTRIBUTES_H__
+#define __SHARED_ATTRIBUTES_H__
+
+#include <stdint.h>
+#include <time.h>
+
+namespace DisplayConfig {
+
+// Read-mostly attribute page shared between the config service and its clients. The service
+// mirrors frequently read display attributes here so client queries can be served with a local
+// read instead of a binder transaction. The service serializes its writers internally; readers
+// synchronize with the per-slot seqlock below.
+
+static const char kSharedAttributesPath[] = "/data/vendor/display/display_config_attributes";
+static const uint32_t kSharedAttributesMagic = 0x44434641;  // 'DCFA'
+static const uint32_t kSharedAttributesVersion = 1;
+
+// Slots are indexed by the DisplayType of the display being queried.
+static const uint32_t kMaxSharedDisplays = 4;
+
+// Mirrored values older than this are treated as stale and the reader falls back to the
+// service, which refreshes the slot. This bounds the staleness a client can observe when an
+// attribute changes through a path that does not go through the config service.
+static const int64_t kSharedAttributesTtlMs = 1000;
+
+// Per-slot valid bits.
+static const uint32_t kSharedValidActiveConfig = 1 << 0;
+static const uint32_t kSharedValidPowerMode = 1 << 1;
+
+// Static capability bits, published once the service has answered the query.
+static const uint32_t kSharedCapAsyncVdsKnown = 1 << 0;
+static const uint32_t kSharedCapAsyncVds = 1 << 1;
+
+struct SharedDisplayAttributes {
+  uint32_t seq;            // Seqlock sequence; odd while a writer is mid-update.
+  uint32_t valid;          // kSharedValid* bits.
+  uint32_t active_config;
+  uint32_t power_mode;
+  int64_t update_time_ms;  // CLOCK_MONOTONIC time of the last write to this slot.
+};
+
+struct SharedAttributesPage {
+  uint32_t magic;  // Written last by the publisher; the page is valid only once it matches.
+  uint32_t version;
+  uint32_t caps;   // kSharedCap* bits.
+  uint32_t reserved;
+  SharedDisplayAttributes displays[kMaxSharedDisplays];
+};
+
+static inline int64_t SharedAttributesTimeMs() {
+  struct timespec ts = {};
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static inline void SharedSlotWriteBegin(SharedDisplayAttributes *slot) {
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static inline void SharedSlotWriteEnd(SharedDisplayAttributes *slot) {
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+}
+
+static inline uint32_t SharedSlotReadBegin(const SharedDisplayAttributes *slot) {
+  return __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+}
+
+// Returns true if the snapshot read since SharedSlotReadBegin() may be torn and must be retried.
+static inline bool SharedSlotReadRetry(const SharedDisplayAttributes *slot, uint32_t seq) {
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  return (seq & 1) || (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq);
+}
+
+}  // namespace DisplayConfig
+
+#endif  // __SHARED_ATTRIBUTES_H__